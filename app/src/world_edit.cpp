@@ -38,7 +38,6 @@
 #include "world/blocks/utility/accessors.hpp"
 #include "world/blocks/utility/bounding_box.hpp"
 #include "world/blocks/utility/find.hpp"
-#include "world/blocks/utility/grounding.hpp"
 #include "world/blocks/utility/raycast.hpp"
 #include "world/io/export_selection.hpp"
 #include "world/io/export_terrain_map.hpp"
@@ -62,6 +61,7 @@
 #include "world/utility/terrain_sample.hpp"
 #include "world/utility/world_utilities.hpp"
 
+#include <algorithm>
 #include <bit>
 #include <stdexcept>
 #include <type_traits>
@@ -231,6 +231,7 @@ void world_edit::update()
 
    // Input!
    update_input();
+   update_entity_spatial_index();
    update_hovered_entity();
 
    // UI!
@@ -239,7 +240,7 @@ void world_edit::update()
 
    // Logic!
    _asset_libraries.update_loaded();
-   _object_classes.update(delta_time);
+   if (_object_classes.update(delta_time)) _world.dirty_entities.objects = true;
 
    if (_asset_libraries.gather_errors(_world_asset_errors)) {
       if (not _load_errors_open) _new_load_error_open = true;
@@ -297,10 +298,13 @@ void world_edit::update()
       }
 
       _world_blocks_bvh_library.update(_world.blocks.custom_meshes, *_thread_pool);
+      _world_terrain_height_pyramid.update(_world.terrain);
+      update_entity_spatial_index();
 
       _world.terrain.untracked_clear_dirty_rects();
       _world.blocks.untracked_clear_dirty_ranges();
       _world.blocks.custom_meshes.clear_events();
+      _world.dirty_entities.untracked_clear();
    }
    catch (graphics::gpu::exception& e) {
       handle_gpu_error(e);
@@ -416,6 +420,22 @@ void world_edit::update_input() noexcept
    _mouse_movement_y = std::exchange(_queued_mouse_movement_y, 0);
 }
 
+void world_edit::update_entity_spatial_index() noexcept
+{
+   _world_entity_index.update(
+      _world, _object_classes,
+      {
+         .light_proxy_radius = std::max({_settings.graphics.directional_light_icon_size,
+                                         _settings.graphics.point_light_icon_size,
+                                         _settings.graphics.spot_light_icon_size}) *
+                               0.5f,
+         .path_node_radius = 0.707f * (_settings.graphics.path_node_size / 0.5f),
+         .barrier_height = _settings.graphics.barrier_height,
+         .hub_height = _settings.graphics.planning_hub_height,
+         .boundary_height = _settings.graphics.boundary_height,
+      });
+}
+
 void world_edit::update_hovered_entity() noexcept
 {
    graphics::camera_ray ray =
@@ -479,7 +499,7 @@ void world_edit::update_hovered_entity() noexcept
    if (raycast_mask.objects) {
       if (std::optional<world::raycast_result<world::object>> hit =
              world::raycast(ray.origin, ray.direction, _world_layers_hit_mask,
-                            _world.objects, _object_classes);
+                            _world.objects, _object_classes, _world_entity_index);
           hit) {
          if (hit->distance < hovered_entity_distance) {
             _interaction_targets.hovered_entity = hit->id;
@@ -501,7 +521,8 @@ void world_edit::update_hovered_entity() noexcept
                 .directional = _settings.graphics.directional_light_icon_size * 0.5f,
                 .point = _settings.graphics.point_light_icon_size * 0.5f,
                 .spot = _settings.graphics.spot_light_icon_size * 0.5f,
-             });
+             },
+             _world_entity_index);
           hit) {
          if (hit->distance < hovered_entity_distance) {
             _interaction_targets.hovered_entity = hit->id;
@@ -514,7 +535,8 @@ void world_edit::update_hovered_entity() noexcept
    if (raycast_mask.paths) {
       if (std::optional<world::raycast_result<world::path>> hit =
              world::raycast(ray.origin, ray.direction, _world_layers_hit_mask,
-                            _world.paths, _settings.graphics.path_node_size);
+                            _world.paths, _settings.graphics.path_node_size,
+                            _world_entity_index);
           hit) {
          if (hit->distance < hovered_entity_distance) {
             _interaction_targets.hovered_entity =
@@ -528,7 +550,7 @@ void world_edit::update_hovered_entity() noexcept
    if (raycast_mask.regions) {
       if (std::optional<world::raycast_result<world::region>> hit =
              world::raycast(ray.origin, ray.direction, _world_layers_hit_mask,
-                            _world.regions);
+                            _world.regions, _world_entity_index);
           hit) {
          if (hit->distance < hovered_entity_distance) {
             _interaction_targets.hovered_entity = hit->id;
@@ -540,7 +562,8 @@ void world_edit::update_hovered_entity() noexcept
 
    if (raycast_mask.sectors) {
       if (std::optional<world::raycast_result<world::sector>> hit =
-             world::raycast(ray.origin, ray.direction, _world.sectors);
+             world::raycast(ray.origin, ray.direction, _world.sectors,
+                            _world_entity_index);
           hit) {
          if (hit->distance < hovered_entity_distance) {
             _interaction_targets.hovered_entity = hit->id;
@@ -558,7 +581,8 @@ void world_edit::update_hovered_entity() noexcept
 
    if (raycast_mask.portals) {
       if (std::optional<world::raycast_result<world::portal>> hit =
-             world::raycast(ray.origin, ray.direction, _world.portals);
+             world::raycast(ray.origin, ray.direction, _world.portals,
+                            _world_entity_index);
           hit) {
          if (hit->distance < hovered_entity_distance) {
             _interaction_targets.hovered_entity = hit->id;
@@ -571,7 +595,7 @@ void world_edit::update_hovered_entity() noexcept
    if (raycast_mask.hintnodes) {
       if (std::optional<world::raycast_result<world::hintnode>> hit =
              world::raycast(ray.origin, ray.direction, _world_layers_hit_mask,
-                            _world.hintnodes);
+                            _world.hintnodes, _world_entity_index);
           hit) {
          if (hit->distance < hovered_entity_distance) {
             _interaction_targets.hovered_entity = hit->id;
@@ -584,7 +608,7 @@ void world_edit::update_hovered_entity() noexcept
    if (raycast_mask.barriers) {
       if (std::optional<world::raycast_result<world::barrier>> hit =
              world::raycast(ray.origin, ray.direction, _world.barriers,
-                            _settings.graphics.barrier_height);
+                            _settings.graphics.barrier_height, _world_entity_index);
           hit) {
          if (hit->distance < hovered_entity_distance) {
             _interaction_targets.hovered_entity = hit->id;
@@ -597,7 +621,7 @@ void world_edit::update_hovered_entity() noexcept
    if (raycast_mask.planning_hubs) {
       if (std::optional<world::raycast_result<world::planning_hub>> hit =
              world::raycast(ray.origin, ray.direction, _world.planning_hubs,
-                            _settings.graphics.planning_hub_height);
+                            _settings.graphics.planning_hub_height, _world_entity_index);
           hit) {
          if (hit->distance < hovered_entity_distance) {
             _interaction_targets.hovered_entity = hit->id;
@@ -624,7 +648,7 @@ void world_edit::update_hovered_entity() noexcept
    if (raycast_mask.boundaries) {
       if (std::optional<world::raycast_result<world::boundary>> hit =
              world::raycast(ray.origin, ray.direction, _world.boundaries,
-                            _settings.graphics.boundary_height);
+                            _settings.graphics.boundary_height, _world_entity_index);
           hit) {
          if (hit->distance < hovered_entity_distance) {
             _interaction_targets.hovered_entity = hit->id;
@@ -646,7 +670,8 @@ void world_edit::update_hovered_entity() noexcept
    }
 
    if (raycast_mask.terrain and _world.terrain.active_flags.terrain) {
-      if (auto hit = world::raycast(ray.origin, ray.direction, _world.terrain); hit) {
+      if (auto hit = world::raycast(ray.origin, ray.direction, _world.terrain,
+                                    _world_terrain_height_pyramid); hit) {
          if (*hit < hovered_entity_distance or *hit < cursor_distance) {
             if (not world::point_inside_terrain_cut(ray.origin + ray.direction * *hit,
                                                     ray.direction, _world_layers_hit_mask,
@@ -678,7 +703,8 @@ void world_edit::update_hovered_entity() noexcept
    if (raycast_mask.blocks) {
       if (std::optional<world::raycast_block_result> hit =
              world::raycast(ray.origin, ray.direction, _world_layers_hit_mask,
-                            _world.blocks, _world_blocks_bvh_library);
+                            _world.blocks, _world_blocks_bvh_library,
+                            _world_entity_index.blocks());
           hit) {
          if (hit->distance < hovered_entity_distance) {
             _interaction_targets.hovered_entity = hit->id;
@@ -1498,7 +1524,7 @@ void world_edit::finish_entity_select(const select_method method) noexcept
 
       world::drag_select(
          _world, _world_hit_mask, _world_layers_hit_mask, _object_classes,
-         _world_blocks_bvh_library, frustumWS,
+         _world_blocks_bvh_library, _world_entity_index, frustumWS,
          method == select_method::remove ? world::select_op::remove
                                          : world::select_op::add,
          _interaction_targets.selection,
@@ -1524,7 +1550,7 @@ void world_edit::finish_entity_select(const select_method method) noexcept
 
          world::double_click_select(
             _interaction_targets.hovered_entity, _world, _object_classes,
-            _world_blocks_bvh_library, frustumWS,
+            _world_blocks_bvh_library, _world_entity_index, frustumWS,
             method == select_method::remove ? world::select_op::remove
                                             : world::select_op::add,
             _interaction_targets.selection,
@@ -2328,6 +2354,20 @@ void world_edit::place_entity_group(const world::entity_group& group,
    const uint32 planning_connection_base_index =
       static_cast<uint32>(_world.planning_connections.size());
 
+   // The world's names are registered once up front so naming each placed entity doesn't scan
+   // every entity of it's type. Regions are named against the lights as well and are left to
+   // create_unique_name.
+   world::unique_name_registry object_names{_world.objects};
+   world::unique_name_registry light_names{_world.lights};
+   world::unique_name_registry path_names{_world.paths};
+   world::unique_name_registry sector_names{_world.sectors};
+   world::unique_name_registry portal_names{_world.portals};
+   world::unique_name_registry hintnode_names{_world.hintnodes};
+   world::unique_name_registry barrier_names{_world.barriers};
+   world::unique_name_registry planning_hub_names{_world.planning_hubs};
+   world::unique_name_registry planning_connection_names{_world.planning_connections};
+   world::unique_name_registry boundary_names{_world.boundaries};
+
    bool is_transparent_edit = false;
 
    for (const world::object& object : group.objects) {
@@ -2338,7 +2378,7 @@ void world_edit::place_entity_group(const world::entity_group& group,
       new_object.layer = group.layer;
       new_object.rotation = group.rotation * new_object.rotation;
       new_object.position = group.rotation * new_object.position + group.position;
-      new_object.name = world::create_unique_name(_world.objects, new_object.name);
+      new_object.name = object_names.create_unique_name(new_object.name);
       new_object.id = new_object_id;
 
       _edit_stack_world.apply(edits::make_insert_entity(std::move(new_object),
@@ -2358,7 +2398,7 @@ void world_edit::place_entity_group(const world::entity_group& group,
       new_light.rotation = group.rotation * new_light.rotation;
       new_light.position = group.rotation * new_light.position + group.position;
       new_light.region_rotation = group.rotation * new_light.region_rotation;
-      new_light.name = world::create_unique_name(_world.lights, new_light.name);
+      new_light.name = light_names.create_unique_name(new_light.name);
       new_light.id = new_light_id;
 
       _edit_stack_world.apply(edits::make_insert_entity(std::move(new_light)),
@@ -2379,7 +2419,7 @@ void world_edit::place_entity_group(const world::entity_group& group,
       }
 
       new_path.layer = group.layer;
-      new_path.name = world::create_unique_name(_world.paths, new_path.name);
+      new_path.name = path_names.create_unique_name(new_path.name);
       new_path.id = new_path_id;
 
       _edit_stack_world.apply(edits::make_insert_entity(std::move(new_path)),
@@ -2465,7 +2505,7 @@ void world_edit::place_entity_group(const world::entity_group& group,
       }
 
       new_sector.base += group.position.y;
-      new_sector.name = world::create_unique_name(_world.sectors, new_sector.name);
+      new_sector.name = sector_names.create_unique_name(new_sector.name);
       new_sector.id = new_sector_id;
 
       _edit_stack_world.apply(edits::make_insert_entity(std::move(new_sector)),
@@ -2506,7 +2546,7 @@ void world_edit::place_entity_group(const world::entity_group& group,
 
       new_portal.rotation = group.rotation * new_portal.rotation;
       new_portal.position = group.rotation * new_portal.position + group.position;
-      new_portal.name = world::create_unique_name(_world.portals, new_portal.name);
+      new_portal.name = portal_names.create_unique_name(new_portal.name);
       new_portal.id = new_portal_id;
 
       _edit_stack_world.apply(edits::make_insert_entity(std::move(new_portal)),
@@ -2538,8 +2578,7 @@ void world_edit::place_entity_group(const world::entity_group& group,
       new_hintnode.layer = group.layer;
       new_hintnode.rotation = group.rotation * new_hintnode.rotation;
       new_hintnode.position = group.rotation * new_hintnode.position + group.position;
-      new_hintnode.name =
-         world::create_unique_name(_world.hintnodes, new_hintnode.name);
+      new_hintnode.name = hintnode_names.create_unique_name(new_hintnode.name);
       new_hintnode.id = new_hintnode_id;
 
       _edit_stack_world.apply(edits::make_insert_entity(std::move(new_hintnode)),
@@ -2556,7 +2595,7 @@ void world_edit::place_entity_group(const world::entity_group& group,
 
       new_barrier.rotation_angle = group.rotation_angle + new_barrier.rotation_angle;
       new_barrier.position = group.rotation * new_barrier.position + group.position;
-      new_barrier.name = world::create_unique_name(_world.barriers, new_barrier.name);
+      new_barrier.name = barrier_names.create_unique_name(new_barrier.name);
       new_barrier.id = new_barrier_id;
 
       _edit_stack_world.apply(edits::make_insert_entity(std::move(new_barrier)),
@@ -2577,7 +2616,7 @@ void world_edit::place_entity_group(const world::entity_group& group,
       }
 
       new_hub.position = group.rotation * new_hub.position + group.position;
-      new_hub.name = world::create_unique_name(_world.planning_hubs, new_hub.name);
+      new_hub.name = planning_hub_names.create_unique_name(new_hub.name);
       new_hub.id = new_hub_id;
 
       _edit_stack_world.apply(edits::make_insert_entity(std::move(new_hub)),
@@ -2596,7 +2635,7 @@ void world_edit::place_entity_group(const world::entity_group& group,
       new_connection.start_hub_index += planning_hub_base_index;
       new_connection.end_hub_index += planning_hub_base_index;
       new_connection.name =
-         world::create_unique_name(_world.planning_connections, new_connection.name);
+         planning_connection_names.create_unique_name(new_connection.name);
       new_connection.id = new_connection_id;
 
       _edit_stack_world.apply(edits::make_insert_entity(std::move(new_connection)),
@@ -2615,8 +2654,7 @@ void world_edit::place_entity_group(const world::entity_group& group,
          point = group.rotation * point + group.position;
       }
 
-      new_boundary.name =
-         world::create_unique_name(_world.boundaries, new_boundary.name);
+      new_boundary.name = boundary_names.create_unique_name(new_boundary.name);
       new_boundary.id = new_boundary_id;
 
       _edit_stack_world.apply(edits::make_insert_entity(std::move(new_boundary)),
@@ -2869,6 +2907,9 @@ void world_edit::place_entity_group(const world::entity_group& group,
       }
    }
 
+   const world::entity_name_index group_object_names{group.objects};
+   const world::entity_name_index group_path_names{group.paths};
+
    for (uint32 object_index = object_base_index;
         object_index < _world.objects.size(); ++object_index) {
       world::object& object = _world.objects[object_index];
@@ -2883,11 +2924,11 @@ void world_edit::place_entity_group(const world::entity_group& group,
 
          if (string::iequals("ControlZone", prop.key)) {
             new_value = world::get_placed_entity_name(prop.value, _world.objects,
-                                                      group, object_base_index);
+                                                      group_object_names, object_base_index);
          }
          else if (string::icontains(prop.key, "Path")) {
             new_value = world::get_placed_entity_name(prop.value, _world.paths,
-                                                      group, path_base_index);
+                                                      group_path_names, path_base_index);
          }
          else if (string::icontains(prop.key, "Region")) {
             for (uint32 i = 0; i < group.regions.size(); ++i) {
@@ -3696,172 +3737,60 @@ void world_edit::toggle_hide_selection() noexcept
 
 void world_edit::ground_selection() noexcept
 {
+   const std::vector<world::grounded_entity> grounded =
+      world::ground_selection(_interaction_targets.selection.view(), _world,
+                              _object_classes, _world_blocks_bvh_library,
+                              _world_layers_hit_mask, *_thread_pool);
+
    edits::bundle_vector bundle;
-   bundle.reserve(_interaction_targets.selection.size());
+   bundle.reserve(grounded.size());
 
-   for (const auto& selected : _interaction_targets.selection) {
+   for (const auto& [selected, index, grounded_position] : grounded) {
       if (selected.is<world::object_id>()) {
-         world::object* object =
-            world::find_entity(_world.objects, selected.get<world::object_id>());
-
-         if (object) {
-            if (const std::optional<float3> grounded_position =
-                   world::ground_object(*object, _world, _object_classes,
-                                        _world_blocks_bvh_library, _world_layers_hit_mask);
-                grounded_position) {
-               bundle.push_back(
-                  edits::make_set_value(&object->position, *grounded_position));
-            }
-         }
+         bundle.push_back(
+            edits::make_set_value(&_world.objects[index].position, grounded_position));
       }
       else if (selected.is<world::light_id>()) {
-         world::light* light =
-            world::find_entity(_world.lights, selected.get<world::light_id>());
-
-         if (light) {
-            if (const std::optional<float3> grounded_position =
-                   world::ground_light(*light, _world, _object_classes,
-                                       _world_blocks_bvh_library, _world_layers_hit_mask);
-                grounded_position) {
-               bundle.push_back(
-                  edits::make_set_value(&light->position, *grounded_position));
-            }
-         }
+         bundle.push_back(
+            edits::make_set_value(&_world.lights[index].position, grounded_position));
       }
       else if (selected.is<world::path_id_node_mask>()) {
-         const auto& [id, node_mask] = selected.get<world::path_id_node_mask>();
+         const world::path_id_node_mask& node_mask = selected.get<world::path_id_node_mask>();
+         world::path& path = _world.paths[index];
 
-         world::path* path = world::find_entity(_world.paths, id);
+         const std::size_t node_count = std::min(path.nodes.size(), world::max_path_nodes);
 
-         if (path) {
-            const std::size_t node_count =
-               std::min(path->nodes.size(), world::max_path_nodes);
-
-            for (uint32 node_index = 0; node_index < node_count; ++node_index) {
-               if (not node_mask[node_index]) continue;
+         for (uint32 node_index = 0; node_index < node_count; ++node_index) {
+            if (not node_mask.nodes[node_index]) continue;
 
-               if (const std::optional<float3> grounded_position =
-                      world::ground_point(path->nodes[node_index].position, _world,
-                                          _object_classes, _world_blocks_bvh_library,
-                                          _world_layers_hit_mask);
-                   grounded_position) {
-                  bundle.push_back(
-                     edits::make_set_vector_value(&path->nodes, node_index,
-                                                  &world::path::node::position,
-                                                  *grounded_position));
-               }
-            }
+            bundle.push_back(edits::make_set_vector_value(&path.nodes, node_index,
+                                                          &world::path::node::position,
+                                                          grounded_position));
          }
       }
       else if (selected.is<world::region_id>()) {
-         world::region* region =
-            world::find_entity(_world.regions, selected.get<world::region_id>());
-
-         if (region) {
-            if (const std::optional<float3> grounded_position =
-                   world::ground_region(*region, _world, _object_classes,
-                                        _world_blocks_bvh_library, _world_layers_hit_mask);
-                grounded_position) {
-               bundle.push_back(
-                  edits::make_set_value(&region->position, *grounded_position));
-            }
-         }
+         bundle.push_back(
+            edits::make_set_value(&_world.regions[index].position, grounded_position));
       }
       else if (selected.is<world::sector_id>()) {
-         world::sector* sector =
-            world::find_entity(_world.sectors, selected.get<world::sector_id>());
-
-         if (sector) {
-            if (const std::optional<float> grounded_base =
-                   world::ground_sector(*sector, _world, _object_classes,
-                                        _world_blocks_bvh_library, _world_layers_hit_mask);
-                grounded_base) {
-               bundle.push_back(edits::make_set_value(&sector->base, *grounded_base));
-            }
-         }
+         bundle.push_back(
+            edits::make_set_value(&_world.sectors[index].base, grounded_position.y));
       }
       else if (selected.is<world::portal_id>()) {
-         world::portal* portal =
-            world::find_entity(_world.portals, selected.get<world::portal_id>());
-
-         if (portal) {
-            if (const std::optional<float3> grounded_position =
-                   world::ground_portal(*portal, _world, _object_classes,
-                                        _world_blocks_bvh_library, _world_layers_hit_mask);
-                grounded_position) {
-               bundle.push_back(
-                  edits::make_set_value(&portal->position, *grounded_position));
-            }
-         }
+         bundle.push_back(
+            edits::make_set_value(&_world.portals[index].position, grounded_position));
       }
       else if (selected.is<world::hintnode_id>()) {
-         world::hintnode* hintnode =
-            world::find_entity(_world.hintnodes, selected.get<world::hintnode_id>());
-
-         if (hintnode) {
-            if (const std::optional<float3> grounded_position =
-                   world::ground_point(hintnode->position, _world, _object_classes,
-                                       _world_blocks_bvh_library, _world_layers_hit_mask);
-                grounded_position) {
-               bundle.push_back(edits::make_set_value(&hintnode->position,
-                                                      *grounded_position));
-            }
-         }
+         bundle.push_back(
+            edits::make_set_value(&_world.hintnodes[index].position, grounded_position));
       }
       else if (selected.is<world::barrier_id>()) {
-         world::barrier* barrier =
-            world::find_entity(_world.barriers, selected.get<world::barrier_id>());
-
-         if (barrier) {
-            if (const std::optional<float3> grounded_position =
-                   world::ground_point(barrier->position, _world, _object_classes,
-                                       _world_blocks_bvh_library, _world_layers_hit_mask);
-                grounded_position) {
-               bundle.push_back(
-                  edits::make_set_value(&barrier->position, *grounded_position));
-            }
-         }
+         bundle.push_back(
+            edits::make_set_value(&_world.barriers[index].position, grounded_position));
       }
       else if (selected.is<world::planning_hub_id>()) {
-         world::planning_hub* hub =
-            world::find_entity(_world.planning_hubs,
-                               selected.get<world::planning_hub_id>());
-
-         if (hub) {
-            if (const std::optional<float3> grounded_position =
-                   world::ground_point(hub->position, _world, _object_classes,
-                                       _world_blocks_bvh_library, _world_layers_hit_mask);
-                grounded_position) {
-               bundle.push_back(
-                  edits::make_set_value(&hub->position, *grounded_position));
-            }
-         }
-      }
-      else if (selected.is<world::boundary_id>()) {
-         world::boundary* boundary =
-            world::find_entity(_world.boundaries, selected.get<world::boundary_id>());
-
-         if (boundary) {
-            bool point_grounded = false;
-
-            std::vector<float3> grounded_points = boundary->points;
-
-            for (float3& point : grounded_points) {
-               if (const std::optional<float3> grounded_point =
-                      world::ground_point(point, _world, _object_classes,
-                                          _world_blocks_bvh_library,
-                                          _world_layers_hit_mask);
-                   grounded_point) {
-                  point = *grounded_point;
-                  point_grounded = true;
-               }
-            }
-
-            if (point_grounded) {
-               bundle.push_back(edits::make_set_value(&boundary->points,
-                                                      std::move(grounded_points)));
-            }
-         }
+         bundle.push_back(edits::make_set_value(&_world.planning_hubs[index].position,
+                                                grounded_position));
       }
       else if (selected.is<world::block_id>()) {
          _Pragma("warning(push)");
@@ -3869,93 +3798,128 @@ void world_edit::ground_selection() noexcept
          _Pragma("warning(default : 4062)"); // enumerator 'identifier' in switch of enum 'enumeration' is not handled
 
          const world::block_id block_id = selected.get<world::block_id>();
-         const std::optional<uint32> block_index =
-            world::find_block(_world.blocks, block_id);
 
-         if (block_index) {
-            if (const std::optional<float3> grounded_position =
-                   world::ground_block(block_id, *block_index, _world,
-                                       _object_classes, _world_blocks_bvh_library,
-                                       _world_layers_hit_mask);
-                grounded_position) {
-               switch (block_id.type()) {
-               case world::block_type::box: {
-                  const world::block_description_box& box =
-                     _world.blocks.boxes.description[*block_index];
-
-                  bundle.push_back(
-                     edits::make_set_block_box_metrics(*block_index, box.rotation,
-                                                       *grounded_position, box.size));
-               } break;
-               case world::block_type::ramp: {
-                  const world::block_description_ramp& ramp =
-                     _world.blocks.ramps.description[*block_index];
-
-                  bundle.push_back(
-                     edits::make_set_block_ramp_metrics(*block_index, ramp.rotation,
-                                                        *grounded_position, ramp.size));
-               } break;
-               case world::block_type::quad: {
-                  const world::block_description_quad& quad =
-                     _world.blocks.quads.description[*block_index];
-
-                  const math::bounding_box bbox = world::get_bounding_box(quad);
-
-                  const float3 quad_centreWS = (bbox.min + bbox.max) / 2.0f;
-
-                  bundle.push_back(edits::make_set_block_quad_metrics(
-                     *block_index,
-                     {
-                        quad.vertices[0] - quad_centreWS + *grounded_position,
-                        quad.vertices[1] - quad_centreWS + *grounded_position,
-                        quad.vertices[2] - quad_centreWS + *grounded_position,
-                        quad.vertices[3] - quad_centreWS + *grounded_position,
-                     }));
-               } break;
-               case world::block_type::custom: {
-                  const world::block_description_custom& block =
-                     _world.blocks.custom.description[*block_index];
-
-                  bundle.push_back(
-                     edits::make_set_block_custom_metrics(*block_index, block.rotation,
-                                                          *grounded_position,
-                                                          block.mesh_description));
-               } break;
-               case world::block_type::hemisphere: {
-                  const world::block_description_hemisphere& hemisphere =
-                     _world.blocks.hemispheres.description[*block_index];
-
-                  bundle.push_back(
-                     edits::make_set_block_hemisphere_metrics(*block_index,
-                                                              hemisphere.rotation,
-                                                              *grounded_position,
-                                                              hemisphere.size));
-               } break;
-               case world::block_type::pyramid: {
-                  const world::block_description_pyramid& pyramid =
-                     _world.blocks.pyramids.description[*block_index];
-
-                  bundle.push_back(
-                     edits::make_set_block_pyramid_metrics(*block_index, pyramid.rotation,
-                                                           *grounded_position,
-                                                           pyramid.size));
-               } break;
-               case world::block_type::terrain_cut_box: {
-                  const world::block_description_terrain_cut_box& terrain_cut_box =
-                     _world.blocks.terrain_cut_boxes.description[*block_index];
-
-                  bundle.push_back(edits::make_set_block_terrain_cut_box_metrics(
-                     *block_index, terrain_cut_box.rotation, *grounded_position,
-                     terrain_cut_box.size));
-               } break;
-               }
-            }
+         switch (block_id.type()) {
+         case world::block_type::box: {
+            const world::block_description_box& box =
+               _world.blocks.boxes.description[index];
+
+            bundle.push_back(
+               edits::make_set_block_box_metrics(index, box.rotation,
+                                                 grounded_position, box.size));
+         } break;
+         case world::block_type::ramp: {
+            const world::block_description_ramp& ramp =
+               _world.blocks.ramps.description[index];
+
+            bundle.push_back(
+               edits::make_set_block_ramp_metrics(index, ramp.rotation,
+                                                  grounded_position, ramp.size));
+         } break;
+         case world::block_type::quad: {
+            const world::block_description_quad& quad =
+               _world.blocks.quads.description[index];
+
+            const math::bounding_box bbox = world::get_bounding_box(quad);
+
+            const float3 quad_centreWS = (bbox.min + bbox.max) / 2.0f;
+
+            bundle.push_back(edits::make_set_block_quad_metrics(
+               index,
+               {
+                  quad.vertices[0] - quad_centreWS + grounded_position,
+                  quad.vertices[1] - quad_centreWS + grounded_position,
+                  quad.vertices[2] - quad_centreWS + grounded_position,
+                  quad.vertices[3] - quad_centreWS + grounded_position,
+               }));
+         } break;
+         case world::block_type::custom: {
+            const world::block_description_custom& block =
+               _world.blocks.custom.description[index];
+
+            bundle.push_back(
+               edits::make_set_block_custom_metrics(index, block.rotation,
+                                                    grounded_position,
+                                                    block.mesh_description));
+         } break;
+         case world::block_type::hemisphere: {
+            const world::block_description_hemisphere& hemisphere =
+               _world.blocks.hemispheres.description[index];
+
+            bundle.push_back(
+               edits::make_set_block_hemisphere_metrics(index,
+                                                        hemisphere.rotation,
+                                                        grounded_position,
+                                                        hemisphere.size));
+         } break;
+         case world::block_type::pyramid: {
+            const world::block_description_pyramid& pyramid =
+               _world.blocks.pyramids.description[index];
+
+            bundle.push_back(
+               edits::make_set_block_pyramid_metrics(index, pyramid.rotation,
+                                                     grounded_position,
+                                                     pyramid.size));
+         } break;
+         case world::block_type::terrain_cut_box: {
+            const world::block_description_terrain_cut_box& terrain_cut_box =
+               _world.blocks.terrain_cut_boxes.description[index];
+
+            bundle.push_back(edits::make_set_block_terrain_cut_box_metrics(
+               index, terrain_cut_box.rotation, grounded_position,
+               terrain_cut_box.size));
+         } break;
          }
 
          _Pragma("warning(pop)");
       }
    }
 
+   // Boundaries are grounded point by point, all of them are gathered into one batch.
+   std::vector<world::boundary*> boundaries;
+   std::vector<float3> boundary_points;
+
+   for (const auto& selected : _interaction_targets.selection) {
+      if (not selected.is<world::boundary_id>()) continue;
+
+      world::boundary* boundary =
+         world::find_entity(_world.boundaries, selected.get<world::boundary_id>());
+
+      if (not boundary) continue;
+
+      boundaries.push_back(boundary);
+      boundary_points.insert(boundary_points.end(), boundary->points.begin(),
+                             boundary->points.end());
+   }
+
+   std::vector<std::optional<float3>> grounded_boundary_points(boundary_points.size());
+
+   world::ground_points(boundary_points, grounded_boundary_points, _world,
+                        _object_classes, _world_blocks_bvh_library,
+                        _world_layers_hit_mask, *_thread_pool);
+
+   std::size_t boundary_point_offset = 0;
+
+   for (world::boundary* boundary : boundaries) {
+      bool point_grounded = false;
+
+      std::vector<float3> grounded_points = boundary->points;
+
+      for (float3& point : grounded_points) {
+         if (const std::optional<float3>& grounded_point =
+                grounded_boundary_points[boundary_point_offset++];
+             grounded_point) {
+            point = *grounded_point;
+            point_grounded = true;
+         }
+      }
+
+      if (point_grounded) {
+         bundle.push_back(
+            edits::make_set_value(&boundary->points, std::move(grounded_points)));
+      }
+   }
+
    if (bundle.size() == 1) {
       _edit_stack_world.apply(std::move(bundle.back()), _edit_context,
                               {.closed = true});
@@ -4426,7 +4390,8 @@ void world_edit::load_world(const io::path& path) noexcept
                               .save_blocks_into_layer =
                                  _settings.preferences.save_blocks_into_layer,
                            },
-                           *_stream);
+                           *_stream, *_thread_pool,
+                           {.use_cache = _settings.preferences.use_world_cache});
       _world_path = path;
 
       for (world::object& object : _world.objects) {
@@ -4480,12 +4445,16 @@ void world_edit::load_world_with_picker() noexcept
    load_world(*path);
 }
 
-void world_edit::save_world(const io::path& path) noexcept
+void world_edit::save_world(const io::path& path,
+                            const world::save_world_options& options) noexcept
 {
    try {
-      world::save_world(path, _world,
-                        world::gather_terrain_cuts(_world, _object_classes));
+      const std::vector<world::terrain_cut> terrain_cuts =
+         world::gather_terrain_cuts(_world, _object_classes);
+
+      world::save_world(path, _world, terrain_cuts, options);
 
+      _world.dirty_files.mark_saved(path, terrain_cuts);
       _edit_stack_world.clear_modified_flag();
    }
    catch (std::exception& e) {
@@ -4529,6 +4498,8 @@ void world_edit::close_world() noexcept
    _object_classes.clear();
    _temporary_object_classes.clear();
    _world = {};
+   _world_terrain_height_pyramid.clear();
+   _world_entity_index.clear();
    _interaction_targets = {};
    _last_clicked_entity = {};
    _entity_creation_context = {};
@@ -29,11 +29,14 @@
 #include "utility/stopwatch.hpp"
 
 #include "world/blocks/custom_mesh_bvh_library.hpp"
+#include "world/io/save.hpp"
 #include "world/object_class.hpp"
 #include "world/object_class_library.hpp"
 #include "world/tool_visualizers.hpp"
 #include "world/utility/animation.hpp"
+#include "world/utility/entity_spatial_index.hpp"
 #include "world/utility/temporary_object_classes.hpp"
+#include "world/utility/terrain_height_pyramid.hpp"
 #include "world/utility/terrain_light_map_baker.hpp"
 #include "world/world.hpp"
 
@@ -327,6 +330,8 @@ private:
 
    void update_input() noexcept;
 
+   void update_entity_spatial_index() noexcept;
+
    void update_hovered_entity() noexcept;
 
    void update_camera(const float delta_time);
@@ -526,7 +531,8 @@ private:
 
    void load_world_with_picker() noexcept;
 
-   void save_world(const io::path& path) noexcept;
+   void save_world(const io::path& path,
+                   const world::save_world_options& options = {}) noexcept;
 
    void close_world() noexcept;
 
@@ -616,6 +622,8 @@ private:
    world::active_layers _world_layers_hit_mask{true};
    world::tool_visualizers _tool_visualizers;
    world::blocks_custom_mesh_bvh_library _world_blocks_bvh_library;
+   world::terrain_height_pyramid _world_terrain_height_pyramid;
+   world::entity_spatial_index _world_entity_index;
 
    edits::stack<world::edit_context> _edit_stack_world;
    world::edit_context _edit_context{.world = _world,
@@ -202,6 +202,9 @@ void world_edit::initialize_commands() noexcept
    _commands.add("show.terrain_grid"s, _draw_terrain_grid);
 
    _commands.add("save"s, [this]() { save_world(_world_path); });
+   _commands.add("save.full"s, [this]() {
+      save_world(_world_path, {.force_full_save = true});
+   });
 
    _commands.add("entity_edit.move_selection"s,
                  [this] { _selection_edit_tool = selection_edit_tool::move; });
@@ -203,7 +203,8 @@ void world_edit::ui_show_foliage_editor() noexcept
 
    float hit_distance = -1.0f;
 
-   if (auto hit = world::raycast(ray.origin, ray.direction, _world.terrain); hit) {
+   if (auto hit = world::raycast(ray.origin, ray.direction, _world.terrain,
+                                 _world_terrain_height_pyramid); hit) {
       hit_distance = *hit;
    }
 
@@ -62,6 +62,16 @@ void world_edit::ui_show_main_menu_bar() noexcept
             save_world_with_picker();
          }
 
+         if (ImGui::MenuItem("Save World (Rewrite All Files)", nullptr, nullptr,
+                             loaded_world)) {
+            save_world(_world_path, {.force_full_save = true});
+         }
+
+         if (ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled)) {
+            ImGui::SetTooltip("Saving normally only rewrites the files that have "
+                              "changed since the world was last saved.");
+         }
+
          ImGui::Separator();
 
          if (ImGui::MenuItem("Close World", nullptr, nullptr, loaded_world)) {
@@ -531,6 +541,10 @@ void world_edit::ui_show_main_menu_bar() noexcept
             try_start_clean();
          }
 
+         if (ImGui::MenuItem("Cancel", nullptr, nullptr, _munge_manager.is_busy())) {
+            _munge_manager.cancel();
+         }
+
          ImGui::Separator();
 
          ImGui::MenuItem("Show Munge Manager",
@@ -176,6 +176,18 @@ void world_edit::ui_show_munge_manager() noexcept
 
       ImGui::SameLine();
 
+      ImGui::EndDisabled();
+      ImGui::BeginDisabled(not _munge_manager.is_busy());
+
+      if (ImGui::Button("Cancel", {header_button_width, 0.0f})) {
+         _munge_manager.cancel();
+      }
+
+      ImGui::EndDisabled();
+      ImGui::BeginDisabled(_munge_manager.is_busy());
+
+      ImGui::SameLine();
+
       ImGui::Checkbox("Deploy", &_munge_manager.get_project().deploy);
 
       ImGui::SeparatorText("Active");
@@ -953,7 +953,8 @@ void world_edit::ui_show_terrain_editor() noexcept
       }
    }
    else {
-      if (auto hit = world::raycast(ray.origin, ray.direction, _world.terrain); hit) {
+      if (auto hit = world::raycast(ray.origin, ray.direction, _world.terrain,
+                                    _world_terrain_height_pyramid); hit) {
          hit_distance = *hit;
       }
    }
@@ -3598,7 +3598,8 @@ void world_edit::ui_show_block_editor() noexcept
 
       if (std::optional<world::raycast_block_result> hit =
              world::raycast(rayWS.origin, rayWS.direction, _world_layers_hit_mask,
-                            _world.blocks, _world_blocks_bvh_library);
+                            _world.blocks, _world_blocks_bvh_library,
+                            _world_entity_index.blocks());
           hit) {
          if (click) {
             world::block_texture_rotation new_rotation =
@@ -3648,7 +3649,8 @@ void world_edit::ui_show_block_editor() noexcept
 
       if (std::optional<world::raycast_block_result> hit =
              world::raycast(rayWS.origin, rayWS.direction, _world_layers_hit_mask,
-                            _world.blocks, _world_blocks_bvh_library);
+                            _world.blocks, _world_blocks_bvh_library,
+                            _world_entity_index.blocks());
           hit) {
          if (click_enlarge or click_shrink) {
             std::array<int8, 2> new_scale =
@@ -3694,7 +3696,8 @@ void world_edit::ui_show_block_editor() noexcept
 
       if (std::optional<world::raycast_block_result> hit =
              world::raycast(rayWS.origin, rayWS.direction, _world_layers_hit_mask,
-                            _world.blocks, _world_blocks_bvh_library);
+                            _world.blocks, _world_blocks_bvh_library,
+                            _world_entity_index.blocks());
           hit) {
          if (click) {
             _edit_stack_world.apply(
@@ -3720,7 +3723,8 @@ void world_edit::ui_show_block_editor() noexcept
 
       if (std::optional<world::raycast_block_result> hit =
              world::raycast(rayWS.origin, rayWS.direction, _world_layers_hit_mask,
-                            _world.blocks, _world_blocks_bvh_library);
+                            _world.blocks, _world_blocks_bvh_library,
+                            _world_entity_index.blocks());
           hit) {
          if (click) {
             _edit_stack_world.apply(
@@ -3748,7 +3752,8 @@ void world_edit::ui_show_block_editor() noexcept
 
          if (std::optional<world::raycast_block_result> hit =
                 world::raycast(rayWS.origin, rayWS.direction, _world_layers_hit_mask,
-                               _world.blocks, _world_blocks_bvh_library);
+                               _world.blocks, _world_blocks_bvh_library,
+                               _world_entity_index.blocks());
              hit) {
             if (click) {
                _block_editor_context.offset_texture.block_id = hit->id;
@@ -3824,7 +3829,8 @@ void world_edit::ui_show_block_editor() noexcept
       if (not _gizmos.want_capture_mouse()) {
          if (std::optional<world::raycast_block_result> hit =
                 world::raycast(rayWS.origin, rayWS.direction, _world_layers_hit_mask,
-                               _world.blocks, _world_blocks_bvh_library);
+                               _world.blocks, _world_blocks_bvh_library,
+                               _world_entity_index.blocks());
              hit) {
             if (click) _block_editor_context.resize_block.block_id = hit->id;
 
@@ -24,6 +24,7 @@ namespace {
 auto ground_painted_object(const quaternion& rotation, float3 positionWS,
                            const lowercase_string& object_class_name,
                            const world::world& world,
+                           const world::terrain_height_pyramid& terrain_height_pyramid,
                            world::object_class_library& object_classes) -> float3
 {
    const world::object_class_handle class_handle =
@@ -40,7 +41,8 @@ auto ground_painted_object(const quaternion& rotation, float3 positionWS,
 
    for (const float3& pointLS : model->ground_points) {
       const std::optional<float> hit =
-         world::raycast(rotation * pointLS + positionWS, -object_dirWS, world.terrain);
+         world::raycast(rotation * pointLS + positionWS, -object_dirWS, world.terrain,
+                        terrain_height_pyramid);
 
       if (hit and *hit > terrain_distance) {
          terrain_distance = *hit;
@@ -372,7 +374,8 @@ void world_edit::ui_show_world_object_painter() noexcept
 
    float hit_distance = FLT_MAX;
 
-   if (auto hit = world::raycast(rayWS.origin, rayWS.direction, _world.terrain); hit) {
+   if (auto hit = world::raycast(rayWS.origin, rayWS.direction, _world.terrain,
+                                 _world_terrain_height_pyramid); hit) {
       hit_distance = *hit;
    }
    else {
@@ -423,12 +426,18 @@ void world_edit::ui_show_world_object_painter() noexcept
                      _object_paint_context.painted_objects,
                   0);
 
+      std::vector<const lowercase_string*> object_class_names;
+      std::vector<float3> positionsWS;
+
+      object_class_names.reserve(static_cast<std::size_t>(objects_to_paint));
+      positionsWS.reserve(static_cast<std::size_t>(objects_to_paint));
+
       for (int i = 0; i < objects_to_paint; ++i) {
          const int32 index = i + _object_paint_context.painted_objects;
 
-         const lowercase_string& object_class_name =
-            _object_paint_config.object_pool[_object_paint_context.random.generate_bounded(
-               static_cast<uint32>(_object_paint_config.object_pool.size()))];
+         object_class_names.push_back(
+            &_object_paint_config.object_pool[_object_paint_context.random.generate_bounded(
+               static_cast<uint32>(_object_paint_config.object_pool.size()))]);
 
          const float2 sample =
             _object_paint_config.quasirandom
@@ -445,13 +454,27 @@ void world_edit::ui_show_world_object_painter() noexcept
                 world::raycast(float3{positionWS.x,
                                       _world.terrain.height_scale * (INT16_MAX + 1),
                                       positionWS.z},
-                               {0.0f, -1.0f, 0.0f}, _world.terrain);
+                               {0.0f, -1.0f, 0.0f}, _world.terrain,
+                               _world_terrain_height_pyramid);
              hit) {
             positionWS.y = _world.terrain.height_scale * (INT16_MAX + 1) - *hit;
          }
 
-         const float3 terrain_normalWS =
-            world::sample_terrain_normal(_world.terrain, positionWS);
+         positionsWS.push_back(positionWS);
+      }
+
+      std::vector<float3> terrain_normalsWS(positionsWS.size());
+
+      world::sample_terrain_normals(_world.terrain, positionsWS, terrain_normalsWS,
+                                    *_thread_pool);
+
+      for (int i = 0; i < objects_to_paint; ++i) {
+         const int32 index = i + _object_paint_context.painted_objects;
+
+         const lowercase_string& object_class_name = *object_class_names[i];
+         float3 positionWS = positionsWS[i];
+
+         const float3 terrain_normalWS = terrain_normalsWS[i];
          quaternion rotation =
             _object_paint_config.align_to_terrain
                ? rotation_between({0.0f, 1.0f, 0.0f}, terrain_normalWS)
@@ -466,7 +489,8 @@ void world_edit::ui_show_world_object_painter() noexcept
          }
 
          positionWS = ground_painted_object(rotation, positionWS, object_class_name,
-                                            _world, _object_classes);
+                                            _world, _world_terrain_height_pyramid,
+                                            _object_classes);
 
          world::object object = {.rotation = rotation,
                                  .position = positionWS,
@@ -528,6 +552,8 @@ void world_edit::ui_show_world_object_painter() noexcept
             _world.configuration.untracked_paint_object_pool_history.erase(
                _world.configuration.untracked_paint_object_pool_history.begin());
          }
+
+         _world.dirty_files.mark(world::world_file::configuration);
       }
 
       _object_paint_context.painted_objects += objects_to_paint;
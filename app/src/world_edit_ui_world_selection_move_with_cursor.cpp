@@ -177,7 +177,8 @@ void world_edit::ui_show_world_selection_move_with_cursor() noexcept
       }
 
       if (raycast_mask.terrain and _world.terrain.active_flags.terrain) {
-         if (auto hit = world::raycast(ray.origin, ray.direction, _world.terrain); hit) {
+         if (auto hit = world::raycast(ray.origin, ray.direction, _world.terrain,
+                                       _world_terrain_height_pyramid); hit) {
             if (*hit < cursor_distance) {
                if (not raycast_mask.objects or
                    not world::point_inside_terrain_cut(ray.origin + ray.direction * *hit,
@@ -193,7 +194,8 @@ void world_edit::ui_show_world_selection_move_with_cursor() noexcept
       if (raycast_mask.blocks) {
          if (std::optional<world::raycast_block_result> hit =
                 world::raycast(ray.origin, ray.direction, _world_layers_hit_mask,
-                               _world.blocks, _world_blocks_bvh_library, filter_block);
+                               _world.blocks, _world_blocks_bvh_library,
+                               _world_entity_index.blocks(), filter_block);
              hit) {
             cursor_distance = std::min(cursor_distance, hit->distance);
          }
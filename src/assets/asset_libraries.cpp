@@ -25,6 +25,7 @@
 #include <atomic>
 #include <mutex>
 #include <shared_mutex>
+#include <stop_token>
 #include <string_view>
 
 #include <absl/container/btree_set.h>
@@ -366,6 +367,13 @@ struct library<T>::impl {
    {
    }
 
+   ~impl()
+   {
+      // Loads reference the library, they must finish before any of it's members are destroyed.
+      _load_tasks.clear();
+      _stopping_load_tasks.clear();
+   }
+
    void add(const io::path& asset_path, uint64 last_write_time,
             const category category) noexcept
    {
@@ -481,7 +489,11 @@ struct library<T>::impl {
             asset_state->start_load = [this] {};
             asset_state->last_write_time.store(0, std::memory_order_relaxed);
 
-            _load_tasks.erase(name);
+            if (auto load_task = _load_tasks.find(name); load_task != _load_tasks.end()) {
+               stop_load_task(std::move(load_task->second));
+
+               _load_tasks.erase(load_task);
+            }
 
             std::erase_if(_existing_assets, [&](const stable_string& asset) {
                return asset == name;
@@ -589,6 +601,13 @@ struct library<T>::impl {
 
    void update_loaded() noexcept
    {
+      {
+         std::scoped_lock lock{_load_tasks_mutex};
+
+         std::erase_if(_stopping_load_tasks,
+                       [](const async::task<asset_data<T>>& task) { return task.ready(); });
+      }
+
    restart_loop:
       std::unique_lock lock{_load_tasks_mutex};
 
@@ -637,6 +656,7 @@ struct library<T>::impl {
                             _existing_assets_mutex, _assets_tree_mutex};
 
       _load_tasks.clear();
+      _stopping_load_tasks.clear();
       _assets.clear();
       _asset_category_sets = {};
       _existing_assets.clear();
@@ -706,6 +726,13 @@ struct library<T>::impl {
       return current_errors;
    }
 
+   void set_cache_directory(const io::path& path) noexcept
+   {
+      std::scoped_lock lock{_load_tasks_mutex};
+
+      _cache_directory = path;
+   }
+
    void show_imgui_child() noexcept
    {
       std::scoped_lock lock{_assets_mutex, _load_tasks_mutex, _existing_assets_mutex,
@@ -1027,12 +1054,12 @@ private:
 
       std::scoped_lock tasks_lock{_load_tasks_mutex};
 
+      io::path cache_directory = _cache_directory;
+
       if (preempt_current_load) {
          if (auto inprogress_load = _load_tasks.find(name);
              inprogress_load != _load_tasks.end()) {
-            auto& [_, load_task] = *inprogress_load;
-
-            load_task.cancel();
+            stop_load_task(std::move(inprogress_load->second));
 
             _load_tasks.erase(inprogress_load);
          }
@@ -1043,14 +1070,27 @@ private:
 
       _load_tasks[name] = _thread_pool->exec(
          async::task_priority::low,
-         [this, asset_path = std::move(asset_path), asset, name]() -> asset_data<T> {
+         [this, asset_path = std::move(asset_path),
+          cache_directory = std::move(cache_directory), asset,
+          name](const std::stop_token stop_token) -> asset_data<T> {
             try {
                for (int load_attempt = 0;; ++load_attempt) {
+                  // The load has been preempted or the asset removed, the result would be discarded.
+                  if (stop_token.stop_requested()) return nullptr;
+
                   try {
                      utility::stopwatch load_timer;
 
-                     auto asset_data =
-                        std::make_shared<const T>(asset_traits<T>::load(asset_path));
+                     auto asset_data = std::make_shared<const T>([&] {
+                        if constexpr (requires {
+                                         asset_traits<T>::load(asset_path, cache_directory);
+                                      }) {
+                           return asset_traits<T>::load(asset_path, cache_directory);
+                        }
+                        else {
+                           return asset_traits<T>::load(asset_path);
+                        }
+                     }());
 
                      _output_stream.write("Loaded asset '{}'\n   Time Taken: {:f}ms\n"sv,
                                           asset_path.string_view(),
@@ -1071,6 +1111,10 @@ private:
                }
             }
             catch (std::exception& e) {
+               // A preempted load can fail because the file is being rewritten, the load that
+               // preempted it will report any real error.
+               if (stop_token.stop_requested()) return nullptr;
+
                _output_stream.write("Error while loading asset:\n   File: {}\n   Message: \n{}\n"sv,
                                     asset_path.string_view(),
                                     string::indent(2, e.what()));
@@ -1089,6 +1133,17 @@ private:
          });
    }
 
+   /// @brief Request a load stops without waiting for it to do so. The task is kept until it is
+   /// ready, it references the library. _load_tasks_mutex must be held.
+   void stop_load_task(async::task<asset_data<T>> load_task) noexcept
+   {
+      if (load_task.ready()) return;
+
+      load_task.request_stop();
+
+      _stopping_load_tasks.push_back(std::move(load_task));
+   }
+
    struct asset_category_state {
       bool in_use = false;
       io::path path;
@@ -1103,6 +1158,8 @@ private:
 
    std::shared_mutex _load_tasks_mutex;
    absl::flat_hash_map<lowercase_string, async::task<asset_data<T>>> _load_tasks; // guarded by _load_tasks_mutex
+   std::vector<async::task<asset_data<T>>> _stopping_load_tasks; // guarded by _load_tasks_mutex
+   io::path _cache_directory; // guarded by _load_tasks_mutex
 
    std::shared_mutex _existing_assets_mutex;
    std::vector<stable_string> _existing_assets;
@@ -1227,6 +1284,12 @@ void library<T>::show_imgui_child() noexcept
    return self->show_imgui_child();
 }
 
+template<typename T>
+void library<T>::set_cache_directory(const io::path& path) noexcept
+{
+   return self->set_cache_directory(path);
+}
+
 template struct library<odf::definition>;
 template struct library<msh::flat_model>;
 template struct library<texture::texture>;
@@ -1451,6 +1514,12 @@ void libraries_manager::set_source_directory(const io::path& source_directory,
 
    if (not io::exists(_source_directory)) return;
 
+   if (const io::path cache_directory =
+          io::compose_path(_source_directory, R"(.WorldEdit\bvh_cache)");
+       io::is_directory(cache_directory) or io::create_directories(cache_directory)) {
+      models.set_cache_directory(cache_directory);
+   }
+
    _category_relative_paths = container::make_enum_array<std::string, category>({
       {category::world, fmt::format("\\Worlds\\{}\\", world_name)},
       {category::common_world, "\\Worlds\\Common\\"},
@@ -1538,6 +1607,7 @@ void libraries_manager::clear() noexcept
 
    odfs.clear();
    models.clear();
+   models.set_cache_directory({});
    textures.clear();
    skies.clear();
    entity_groups.clear();
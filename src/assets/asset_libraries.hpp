@@ -184,10 +184,14 @@ struct library {
    /// @brief Show internal asset debugger child window.
    void show_imgui_child() noexcept;
 
+   /// @brief Set the directory assets can cache data derived from them in. Only used by asset types whose asset_traits support a cache.
+   /// @param path The cache directory. Empty disables the cache.
+   void set_cache_directory(const io::path& path) noexcept;
+
 private:
    struct impl;
 
-   implementation_storage<impl, 488> self;
+   implementation_storage<impl, 552> self;
 };
 
 /// @brief Tracks assets like library but does no loading or lifetime management.
@@ -1,6 +1,7 @@
 
 #include "asset_traits.hpp"
 #include "io/read_file.hpp"
+#include "msh/flat_model_bvh_cache.hpp"
 #include "msh/scene_io.hpp"
 #include "odf/definition_io.hpp"
 #include "sky/io.hpp"
@@ -18,6 +19,26 @@ auto asset_traits<msh::flat_model>::load(const io::path& path) -> msh::flat_mode
    return msh::flat_model{msh::load_scene(path, {})};
 }
 
+auto asset_traits<msh::flat_model>::load(const io::path& path,
+                                         const io::path& cache_directory)
+   -> msh::flat_model
+{
+   if (cache_directory.empty()) return load(path);
+
+   const uint64 source_hash = msh::hash_model_source(path);
+   const io::path cache_path = msh::get_bvh_cache_path(cache_directory, path);
+
+   msh::flat_model model{msh::load_scene(path, {}), {.build_bvhs = false}};
+
+   if (not msh::read_bvh_cache(cache_path, source_hash, model)) {
+      model.build_bvhs();
+
+      msh::write_bvh_cache(cache_path, source_hash, model);
+   }
+
+   return model;
+}
+
 auto asset_traits<texture::texture>::load(const io::path& path) -> texture::texture
 {
    return texture::load_texture(path);
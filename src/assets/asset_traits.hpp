@@ -25,6 +25,11 @@ struct asset_traits<msh::flat_model> {
    static constexpr std::string_view error_type_name = "model";
 
    static auto load(const io::path& path) -> msh::flat_model;
+
+   /// @brief Load a model, reading it's BVHs from the cache in cache_directory if they're
+   /// current and building and caching them if not.
+   static auto load(const io::path& path, const io::path& cache_directory)
+      -> msh::flat_model;
 };
 
 template<>
@@ -173,7 +173,7 @@ void patch_materials_with_options(std::vector<mesh>& meshes, const scene_options
 
 }
 
-flat_model::flat_model(const scene& scene)
+flat_model::flat_model(const scene& scene, const flat_model_flags flags)
 {
    const std::vector<float4x4> node_to_object_transforms =
       build_node_to_object_transforms(scene);
@@ -208,6 +208,11 @@ flat_model::flat_model(const scene& scene)
    regenerate_bounding_boxes();
    build_ground_points();
 
+   if (flags.build_bvhs) build_bvhs();
+}
+
+void flat_model::build_bvhs() noexcept
+{
    bvh = flat_model_bvh{meshes};
    terrain_cut_bvh = flat_model_terrain_cut_bvh{terrain_cuts};
 }
@@ -74,8 +74,13 @@ struct flat_model_collision {
    void regenerate_bounding_box() noexcept;
 };
 
+struct flat_model_flags {
+   /// @brief Build the BVHs for the meshes and terrain cuts. Can be skipped when the BVHs will be read from a cache instead.
+   bool build_bvhs = true;
+};
+
 struct flat_model {
-   explicit flat_model(const scene& scene);
+   explicit flat_model(const scene& scene, const flat_model_flags flags = {});
 
    math::bounding_box bounding_box;
    math::bounding_box terrain_cuts_bounding_box;
@@ -93,6 +98,9 @@ struct flat_model {
 
    void regenerate_bounding_boxes() noexcept;
 
+   /// @brief Build the BVHs for the meshes and terrain cuts.
+   void build_bvhs() noexcept;
+
 private:
    void flatten_segments_to_meshes(const std::vector<geometry_segment>& segments,
                                    const float4x4& node_to_object,
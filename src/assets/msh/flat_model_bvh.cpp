@@ -5,18 +5,26 @@
 
 namespace we::assets::msh {
 
+auto get_bvh_flags(const mesh& mesh) noexcept -> bvh_flags
+{
+   return {.backface_cull = not are_flags_set(mesh.material.flags,
+                                              material_flags::transparent_doublesided)};
+}
+
 flat_model_bvh::flat_model_bvh(std::span<mesh> meshes) noexcept
 {
    _bvhs.reserve(meshes.size());
 
    for (mesh& mesh : meshes) {
-      _bvhs.emplace_back(mesh.triangles, mesh.positions,
-                         bvh_flags{.backface_cull =
-                                      not are_flags_set(mesh.material.flags,
-                                                        material_flags::transparent_doublesided)});
+      _bvhs.emplace_back(mesh.triangles, mesh.positions, get_bvh_flags(mesh));
    }
 }
 
+flat_model_bvh::flat_model_bvh(std::vector<bvh> bvhs) noexcept
+   : _bvhs{std::move(bvhs)}
+{
+}
+
 auto flat_model_bvh::query(const float3 ray_origin, const float3 ray_direction) const noexcept
    -> std::optional<ray_hit>
 {
@@ -44,6 +52,56 @@ bool flat_model_bvh::intersects(const frustum& frustum) const noexcept
    return false;
 }
 
+auto flat_model_bvh::closest_point(const float3& point, const float max_distance) const noexcept
+   -> std::optional<point_hit>
+{
+   std::optional<point_hit> closest_hit = std::nullopt;
+   float closest_distance = max_distance;
+
+   for (uint32 mesh_index = 0; mesh_index < _bvhs.size(); ++mesh_index) {
+      if (auto hit = _bvhs[mesh_index].closest_point(point, closest_distance); hit) {
+         closest_hit = point_hit{.point = hit->point,
+                                 .distance = hit->distance,
+                                 .mesh_index = mesh_index,
+                                 .tri_index = hit->tri_index};
+         closest_distance = hit->distance;
+      }
+   }
+
+   return closest_hit;
+}
+
+auto flat_model_bvh::overlaps_sphere(const float3& position, const float radius) const noexcept
+   -> std::vector<mesh_tri>
+{
+   std::vector<mesh_tri> tris;
+
+   for (uint32 mesh_index = 0; mesh_index < _bvhs.size(); ++mesh_index) {
+      for (const uint32 tri_index :
+           _bvhs[mesh_index].overlaps(bvh::sphere{.position = position, .radius = radius})) {
+         tris.push_back({.mesh_index = mesh_index, .tri_index = tri_index});
+      }
+   }
+
+   return tris;
+}
+
+auto flat_model_bvh::overlaps_box(const quaternion& rotation, const float3& position,
+                                  const math::bounding_box& bbox) const noexcept
+   -> std::vector<mesh_tri>
+{
+   std::vector<mesh_tri> tris;
+
+   for (uint32 mesh_index = 0; mesh_index < _bvhs.size(); ++mesh_index) {
+      for (const uint32 tri_index : _bvhs[mesh_index].overlaps(
+              bvh::oriented_box{.rotation = rotation, .position = position, .bbox = bbox})) {
+         tris.push_back({.mesh_index = mesh_index, .tri_index = tri_index});
+      }
+   }
+
+   return tris;
+}
+
 auto flat_model_bvh::get_child_bvhs() const noexcept -> std::span<const bvh>
 {
    return _bvhs;
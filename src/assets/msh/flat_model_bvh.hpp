@@ -3,6 +3,7 @@
 #include "math/bounding_box.hpp"
 #include "types.hpp"
 
+#include <float.h>
 #include <optional>
 #include <span>
 #include <vector>
@@ -10,6 +11,7 @@
 namespace we {
 
 struct bvh;
+struct bvh_flags;
 struct frustum;
 
 }
@@ -23,12 +25,30 @@ struct ray_hit {
    float3 unnormalized_normal;
 };
 
+struct point_hit {
+   float3 point;
+   float distance;
+   uint32 mesh_index = 0;
+   uint32 tri_index = 0;
+};
+
+struct mesh_tri {
+   uint32 mesh_index = 0;
+   uint32 tri_index = 0;
+};
+
+/// @brief Get the flags the BVH for a mesh is built with.
+auto get_bvh_flags(const mesh& mesh) noexcept -> bvh_flags;
+
 class flat_model_bvh {
 public:
    flat_model_bvh() noexcept;
 
    explicit flat_model_bvh(std::span<mesh> meshes) noexcept;
 
+   /// @brief Construct from already built BVHs, one for each mesh.
+   explicit flat_model_bvh(std::vector<bvh> bvhs) noexcept;
+
    flat_model_bvh(flat_model_bvh&&) noexcept;
    auto operator=(flat_model_bvh&&) noexcept -> flat_model_bvh&;
 
@@ -42,6 +62,22 @@ public:
 
    [[nodiscard]] bool intersects(const frustum& frustum) const noexcept;
 
+   /// @brief Find the point on the model closest to a point.
+   /// @return The closest point or nullopt if the model has no points within max_distance.
+   [[nodiscard]] auto closest_point(const float3& point,
+                                    const float max_distance = FLT_MAX) const noexcept
+      -> std::optional<point_hit>;
+
+   /// @brief Find the triangles that overlap a sphere.
+   [[nodiscard]] auto overlaps_sphere(const float3& position, const float radius) const noexcept
+      -> std::vector<mesh_tri>;
+
+   /// @brief Find the triangles that overlap a box. bbox is rotated by rotation and then moved by
+   /// position.
+   [[nodiscard]] auto overlaps_box(const quaternion& rotation, const float3& position,
+                                   const math::bounding_box& bbox) const noexcept
+      -> std::vector<mesh_tri>;
+
    [[nodiscard]] auto get_child_bvhs() const noexcept -> std::span<const bvh>;
 
    [[nodiscard]] auto get_debug_boxes() const noexcept
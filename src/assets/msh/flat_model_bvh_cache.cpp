@@ -0,0 +1,185 @@
+#include "flat_model_bvh_cache.hpp"
+#include "flat_model.hpp"
+
+#include "io/error.hpp"
+#include "io/memory_mapped_file.hpp"
+#include "io/read_file.hpp"
+
+#include "math/bvh.hpp"
+
+#include "utility/binary_reader.hpp"
+
+#include <cctype>
+#include <cstring>
+#include <optional>
+#include <vector>
+
+#include <fmt/core.h>
+
+namespace we::assets::msh {
+
+namespace {
+
+constexpr uint32 cache_magic = 0x43485642; // "BVHC"
+constexpr uint32 cache_version = 1;
+
+struct cache_header {
+   uint32 magic = cache_magic;
+   uint32 version = cache_version;
+   uint64 source_hash = 0;
+   uint32 mesh_count = 0;
+   uint32 terrain_cut_count = 0;
+};
+
+constexpr uint64 fnv_1a_offset_basis = 0xcbf29ce484222325;
+constexpr uint64 fnv_1a_prime = 0x100000001b3;
+
+auto fnv_1a_hash(const std::span<const std::byte> bytes,
+                 uint64 hash = fnv_1a_offset_basis) noexcept -> uint64
+{
+   for (const std::byte byte : bytes) {
+      hash ^= static_cast<uint64>(byte);
+      hash *= fnv_1a_prime;
+   }
+
+   return hash;
+}
+
+}
+
+auto hash_model_source(const io::path& path) -> uint64
+{
+   uint64 hash = fnv_1a_hash(io::read_file_to_bytes(path));
+
+   try {
+      hash = fnv_1a_hash(io::read_file_to_bytes(io::path{path} += ".option"), hash);
+   }
+   catch (io::open_error& e) {
+      if (e.code() != io::open_error_code::file_not_found) throw;
+   }
+
+   return hash;
+}
+
+auto get_bvh_cache_path(const io::path& cache_directory, const io::path& path) noexcept
+   -> io::path
+{
+   // Paths are case insensitive so they're hashed lowercased. Different models with the same
+   // name from different folders still get different cache files.
+   uint64 path_hash = fnv_1a_offset_basis;
+
+   for (const char c : path.string_view()) {
+      path_hash ^= static_cast<uint64>(std::tolower(static_cast<unsigned char>(c)));
+      path_hash *= fnv_1a_prime;
+   }
+
+   return io::compose_path(cache_directory,
+                           fmt::format("{}_{:016x}.bvh", path.stem(), path_hash));
+}
+
+bool read_bvh_cache(const io::path& cache_path, const uint64 source_hash,
+                    flat_model& model) noexcept
+{
+   try {
+      if (not io::exists(cache_path)) return false;
+
+      const io::memory_mapped_file file{
+         io::memory_mapped_file_params{.path = cache_path, .map_mode = io::map_mode::read}};
+
+      utility::binary_reader reader{std::span{file.data(), file.size()}};
+
+      const cache_header header = reader.read<cache_header>();
+
+      if (header.magic != cache_magic) return false;
+      if (header.version != cache_version) return false;
+      if (header.source_hash != source_hash) return false;
+      if (header.mesh_count != model.meshes.size()) return false;
+      if (header.terrain_cut_count != model.terrain_cuts.size()) return false;
+
+      std::vector<bvh> mesh_bvhs;
+      mesh_bvhs.reserve(model.meshes.size());
+
+      for (const mesh& mesh : model.meshes) {
+         std::optional<bvh> mesh_bvh =
+            bvh::deserialize(reader.read_bytes(reader.read<uint64>()), mesh.triangles,
+                             mesh.positions, get_bvh_flags(mesh));
+
+         if (not mesh_bvh) return false;
+
+         mesh_bvhs.push_back(std::move(*mesh_bvh));
+      }
+
+      std::vector<bvh> terrain_cut_bvhs;
+      terrain_cut_bvhs.reserve(model.terrain_cuts.size());
+
+      for (const flat_model_terrain_cut& cut : model.terrain_cuts) {
+         std::optional<bvh> cut_bvh =
+            bvh::deserialize(reader.read_bytes(reader.read<uint64>()), cut.triangles,
+                             cut.positions, get_bvh_flags(cut));
+
+         if (not cut_bvh) return false;
+
+         terrain_cut_bvhs.push_back(std::move(*cut_bvh));
+      }
+
+      if (reader) return false;
+
+      model.bvh = flat_model_bvh{std::move(mesh_bvhs)};
+      model.terrain_cut_bvh = flat_model_terrain_cut_bvh{std::move(terrain_cut_bvhs)};
+
+      return true;
+   }
+   catch (io::error&) {
+      return false;
+   }
+   catch (utility::binary_reader_overflow&) {
+      return false;
+   }
+}
+
+void write_bvh_cache(const io::path& cache_path, const uint64 source_hash,
+                     const flat_model& model) noexcept
+{
+   try {
+      const std::span<const bvh> mesh_bvhs = model.bvh.get_child_bvhs();
+      const std::span<const bvh> terrain_cut_bvhs =
+         model.terrain_cut_bvh.get_child_bvhs();
+
+      std::size_t size = sizeof(cache_header);
+
+      for (const std::span<const bvh> bvhs : {mesh_bvhs, terrain_cut_bvhs}) {
+         for (const bvh& child : bvhs) size += sizeof(uint64) + child.serialized_size();
+      }
+
+      io::memory_mapped_file file{
+         io::memory_mapped_file_params{.path = cache_path,
+                                       .size = size,
+                                       .truncate_to_size = true}};
+
+      std::byte* write_head = file.data() + sizeof(cache_header);
+
+      for (const std::span<const bvh> bvhs : {mesh_bvhs, terrain_cut_bvhs}) {
+         for (const bvh& child : bvhs) {
+            const uint64 bvh_size = child.serialized_size();
+
+            std::memcpy(write_head, &bvh_size, sizeof(bvh_size));
+            write_head += sizeof(bvh_size);
+
+            child.serialize(std::span{write_head, bvh_size});
+            write_head += bvh_size;
+         }
+      }
+
+      // The header is written last so an interrupted write is never mistaken for a valid cache.
+      const cache_header header{.source_hash = source_hash,
+                                .mesh_count = static_cast<uint32>(mesh_bvhs.size()),
+                                .terrain_cut_count =
+                                   static_cast<uint32>(terrain_cut_bvhs.size())};
+
+      std::memcpy(file.data(), &header, sizeof(header));
+   }
+   catch (io::error&) {
+   }
+}
+
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "io/path.hpp"
+#include "types.hpp"
+
+namespace we::assets::msh {
+
+struct flat_model;
+
+/// @brief Hash a model's source, the .msh file and it's .option file, to check cached data for it is still current.
+/// @param path The path to the .msh file.
+/// @return The hash of the model's source.
+auto hash_model_source(const io::path& path) -> uint64;
+
+/// @brief Get the path a model's BVHs are cached at.
+/// @param cache_directory The directory for the cache.
+/// @param path The path to the .msh file.
+/// @return The path to the cache file.
+auto get_bvh_cache_path(const io::path& cache_directory, const io::path& path) noexcept
+   -> io::path;
+
+/// @brief Read a model's BVHs from the cache. The BVHs are mapped in and copied straight into the nodes of each BVH without being rebuilt.
+/// @param cache_path The path to the cache file.
+/// @param source_hash The hash of the model's source from hash_model_source.
+/// @param model The model to read the BVHs for. It's BVHs are only replaced if the read succeeds.
+/// @return True if the BVHs were read, false if there was no cache file or it was stale or invalid.
+bool read_bvh_cache(const io::path& cache_path, const uint64 source_hash,
+                    flat_model& model) noexcept;
+
+/// @brief Write a model's BVHs to the cache. Failures are ignored, the model will just be rebuilt next time.
+/// @param cache_path The path to the cache file.
+/// @param source_hash The hash of the model's source from hash_model_source.
+/// @param model The model to write the BVHs of.
+void write_bvh_cache(const io::path& cache_path, const uint64 source_hash,
+                     const flat_model& model) noexcept;
+
+}
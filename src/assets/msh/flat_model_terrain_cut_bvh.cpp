@@ -8,17 +8,26 @@
 
 namespace we::assets::msh {
 
+auto get_bvh_flags(const flat_model_terrain_cut&) noexcept -> bvh_flags
+{
+   return {.backface_cull = false};
+}
+
 flat_model_terrain_cut_bvh::flat_model_terrain_cut_bvh(
    std::span<flat_model_terrain_cut> cut_meshes) noexcept
 {
    _bvhs.reserve(cut_meshes.size());
 
    for (flat_model_terrain_cut& cut : cut_meshes) {
-      _bvhs.emplace_back(cut.triangles, cut.positions,
-                         bvh_flags{.backface_cull = false});
+      _bvhs.emplace_back(cut.triangles, cut.positions, get_bvh_flags(cut));
    }
 }
 
+flat_model_terrain_cut_bvh::flat_model_terrain_cut_bvh(std::vector<bvh> bvhs) noexcept
+   : _bvhs{std::move(bvhs)}
+{
+}
+
 auto flat_model_terrain_cut_bvh::count_intersections(const float3 ray_origin_start,
                                                      const float3 ray_direction) const noexcept
    -> uint32
@@ -44,6 +53,11 @@ auto flat_model_terrain_cut_bvh::count_intersections(const float3 ray_origin_sta
    return intersections;
 }
 
+auto flat_model_terrain_cut_bvh::get_child_bvhs() const noexcept -> std::span<const bvh>
+{
+   return _bvhs;
+}
+
 flat_model_terrain_cut_bvh::flat_model_terrain_cut_bvh() noexcept = default;
 
 flat_model_terrain_cut_bvh::flat_model_terrain_cut_bvh(
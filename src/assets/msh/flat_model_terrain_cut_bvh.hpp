@@ -10,6 +10,7 @@
 namespace we {
 
 struct bvh;
+struct bvh_flags;
 
 }
 
@@ -17,11 +18,17 @@ namespace we::assets::msh {
 
 struct flat_model_terrain_cut;
 
+/// @brief Get the flags the BVH for a terrain cut is built with.
+auto get_bvh_flags(const flat_model_terrain_cut& cut) noexcept -> bvh_flags;
+
 struct flat_model_terrain_cut_bvh {
    flat_model_terrain_cut_bvh() noexcept;
 
    explicit flat_model_terrain_cut_bvh(std::span<flat_model_terrain_cut> cut) noexcept;
 
+   /// @brief Construct from already built BVHs, one for each terrain cut.
+   explicit flat_model_terrain_cut_bvh(std::vector<bvh> bvhs) noexcept;
+
    flat_model_terrain_cut_bvh(flat_model_terrain_cut_bvh&&) noexcept;
    auto operator=(flat_model_terrain_cut_bvh&&) noexcept
       -> flat_model_terrain_cut_bvh&;
@@ -36,6 +43,8 @@ struct flat_model_terrain_cut_bvh {
                                           const float3 ray_direction) const noexcept
       -> uint32;
 
+   [[nodiscard]] auto get_child_bvhs() const noexcept -> std::span<const bvh>;
+
 private:
    std::vector<bvh> _bvhs;
 };
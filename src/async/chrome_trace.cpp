@@ -0,0 +1,87 @@
+#include "chrome_trace.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <vector>
+
+#include <fmt/format.h>
+
+namespace we::async {
+
+namespace {
+
+constexpr std::size_t low_priority_thread_id_offset = 1000;
+
+auto thread_id(const task_priority priority, const std::size_t worker_index) noexcept
+   -> std::size_t
+{
+   return priority == task_priority::low ? low_priority_thread_id_offset + worker_index
+                                         : worker_index;
+}
+
+auto to_microseconds(const std::chrono::steady_clock::duration duration) noexcept -> double
+{
+   return std::chrono::duration<double, std::micro>{duration}.count();
+}
+
+}
+
+auto make_chrome_trace(std::span<const task_trace_event> events) noexcept -> std::string
+{
+   std::string json;
+   json.reserve(64 + events.size() * 128);
+
+   const auto out = std::back_inserter(json);
+
+   fmt::format_to(out, R"({{"displayTimeUnit":"ms","traceEvents":[)");
+
+   if (events.empty()) {
+      fmt::format_to(out, "]}}");
+
+      return json;
+   }
+
+   const std::chrono::steady_clock::time_point trace_start =
+      std::ranges::min(events, {}, &task_trace_event::start_time).start_time;
+
+   std::vector<std::size_t> named_threads;
+
+   for (const task_trace_event& event : events) {
+      const std::size_t tid = thread_id(event.priority, event.worker_index);
+
+      // Every task is preceded by the metadata for it's worker, so only the first metadata event goes without a separator.
+      if (std::ranges::find(named_threads, tid) == named_threads.end()) {
+         fmt::format_to(out,
+                        R"({}{{"name":"thread_name","ph":"M","pid":0,"tid":{},"args":{{"name":"{} Worker #{}"}}}})",
+                        named_threads.empty() ? "" : ",", tid,
+                        event.priority == task_priority::low ? "Low Priority" : "Normal Priority",
+                        event.worker_index);
+
+         named_threads.push_back(tid);
+
+         fmt::format_to(out,
+                        R"(,{{"name":"thread_sort_index","ph":"M","pid":0,"tid":{},"args":{{"sort_index":{}}}}})",
+                        tid, tid);
+      }
+
+      fmt::format_to(out,
+                     R"(,{{"name":"Task","cat":"{}","ph":"X","pid":0,"tid":{},"ts":{:.3f},"dur":{:.3f})",
+                     event.priority == task_priority::low ? "low" : "normal", tid,
+                     to_microseconds(event.start_time - trace_start),
+                     to_microseconds(event.end_time - event.start_time));
+
+      if (event.queued_time != std::chrono::steady_clock::time_point{}) {
+         fmt::format_to(out, R"(,"args":{{"queued_us":{:.3f}}})",
+                        to_microseconds(event.start_time - event.queued_time));
+      }
+
+      fmt::format_to(out, "}}");
+   }
+
+   fmt::format_to(out, "]}}");
+
+   return json;
+}
+
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "thread_pool.hpp"
+
+#include <span>
+#include <string>
+
+namespace we::async {
+
+/// @brief Convert a trace from thread_pool::end_trace into Chrome's trace event JSON format. The result
+/// can be opened in chrome://tracing or ui.perfetto.dev, each worker gets it's own track.
+/// @param events The trace events.
+/// @return The JSON.
+[[nodiscard]] auto make_chrome_trace(std::span<const task_trace_event> events) noexcept
+   -> std::string;
+
+}
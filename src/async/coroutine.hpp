@@ -0,0 +1,260 @@
+#pragma once
+
+#include "thread_pool.hpp"
+
+#include <coroutine>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+// Support for writing tasks as coroutines. A function returning async::task<T> becomes a coroutine
+// when it uses co_await or co_return, for example:
+//
+//    auto load_model(async::thread_pool& thread_pool, io::path path) -> async::task<model>
+//    {
+//       scene scene = co_await thread_pool.exec(async::task_priority::low, [&] { return load_scene(path); });
+//
+//       co_return model{std::move(scene)};
+//    }
+//
+// The first parameter of the coroutine must be the thread_pool it is to run on, optionally followed by
+// the task_priority to run it at (task_priority::normal otherwise). Member functions and lambdas are
+// supported as well, the thread_pool is then the first parameter after the object. The coroutine
+// starts on one of the thread_pool's workers and resumes on one after each co_await, no thread blocks
+// while it is suspended. Coroutines still waiting to be resumed when the thread_pool is destroyed are
+// resumed inline by the destroying thread.
+//
+// Because a coroutine task is always already executing canceling or abandoning it waits for the
+// coroutine to finish.
+
+namespace we::async {
+
+namespace detail {
+
+/// @brief Starts a coroutine task on one of it's thread_pool's workers.
+struct initial_awaiter {
+   bool await_ready() const noexcept
+   {
+      return false;
+   }
+
+   template<typename Promise>
+   void await_suspend(std::coroutine_handle<Promise> coroutine) const noexcept
+   {
+      coroutine.promise().resume_on_thread_pool(coroutine);
+   }
+
+   void await_resume() const noexcept {}
+};
+
+/// @brief Destroys a coroutine and then completes it's task, so nothing in the coroutine frame outlives the task.
+struct final_awaiter {
+   bool await_ready() const noexcept
+   {
+      return false;
+   }
+
+   template<typename Promise>
+   void await_suspend(std::coroutine_handle<Promise> coroutine) const noexcept
+   {
+      auto context = std::move(coroutine.promise().context);
+
+      coroutine.destroy();
+
+      context->executed_latch.count_down();
+      context->run_continuations();
+   }
+
+   void await_resume() const noexcept {}
+};
+
+/// @brief State shared by task_promise<T> and task_promise<void>.
+template<typename T>
+struct task_promise_base {
+   task_promise_base(async::thread_pool& thread_pool, const task_priority priority) noexcept
+      : pool{thread_pool.weak_from_this()}, priority{priority}
+   {
+      // Nothing can execute a coroutine's task directly, make sure waiting on it just blocks.
+      context->execution_started.store(true);
+   }
+
+   template<typename... Args>
+   task_promise_base(thread_pool& thread_pool, const task_priority priority,
+                     Args&&...) noexcept
+      : task_promise_base{thread_pool, priority}
+   {
+   }
+
+   template<typename... Args>
+   task_promise_base(thread_pool& thread_pool, Args&&...) noexcept
+      : task_promise_base{thread_pool, task_priority::normal}
+   {
+   }
+
+   template<typename Object, typename... Args>
+   task_promise_base(Object&, thread_pool& thread_pool, const task_priority priority,
+                     Args&&...) noexcept
+      requires(not std::same_as<Object, async::thread_pool>)
+      : task_promise_base{thread_pool, priority}
+   {
+   }
+
+   template<typename Object, typename... Args>
+   task_promise_base(Object&, thread_pool& thread_pool, Args&&...) noexcept
+      requires(not std::same_as<Object, async::thread_pool>)
+      : task_promise_base{thread_pool, task_priority::normal}
+   {
+   }
+
+   /// @brief Coroutine frames are recycled the same way task contexts are.
+   static auto operator new(const std::size_t size) -> void*
+   {
+      return recycling_allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+   }
+
+   static void operator delete(void* block, const std::size_t size) noexcept
+   {
+      recycling_deallocate(block, size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+   }
+
+   auto get_return_object() noexcept -> task<T>
+   {
+      return {context};
+   }
+
+   auto initial_suspend() noexcept -> initial_awaiter
+   {
+      return {};
+   }
+
+   auto final_suspend() noexcept -> final_awaiter
+   {
+      return {};
+   }
+
+   void unhandled_exception() noexcept
+   {
+      context->task_exception_ptr = std::current_exception();
+   }
+
+   /// @brief Queue the coroutine to be resumed on the thread_pool, resuming it inline if the thread_pool is gone.
+   void resume_on_thread_pool(std::coroutine_handle<> coroutine) const noexcept
+   {
+      if (std::shared_ptr<async::thread_pool> thread_pool = pool.lock(); thread_pool) {
+         thread_pool->resume(priority, coroutine);
+      }
+      else {
+         coroutine.resume();
+      }
+   }
+
+   std::weak_ptr<async::thread_pool> pool;
+   task_priority priority = task_priority::normal;
+   std::shared_ptr<task_context<T>> context =
+      std::allocate_shared<task_context<T>>(recycling_allocator<task_context<T>>{});
+};
+
+template<typename T>
+struct task_promise : task_promise_base<T> {
+   using task_promise_base<T>::task_promise_base;
+
+   void return_value(T value) noexcept(std::is_nothrow_move_assignable_v<T>)
+   {
+      this->context->result = std::move(value);
+   }
+};
+
+template<>
+struct task_promise<void> : task_promise_base<void> {
+   using task_promise_base<void>::task_promise_base;
+
+   void return_void() noexcept {}
+};
+
+/// @brief Awaiter for a task. Coroutine tasks are resumed on their thread_pool once the task completes,
+/// any other coroutine is resumed on the thread that completed the task.
+template<typename T>
+struct task_awaiter {
+   task<T>& awaited;
+
+   bool await_ready() const noexcept
+   {
+      return awaited.ready();
+   }
+
+   template<typename Promise>
+   void await_suspend(std::coroutine_handle<Promise> coroutine) const noexcept
+   {
+      if constexpr (requires { coroutine.promise().resume_on_thread_pool(coroutine); }) {
+         awaited.context()->add_continuation([coroutine]() noexcept {
+            coroutine.promise().resume_on_thread_pool(coroutine);
+         });
+      }
+      else {
+         awaited.context()->add_continuation([coroutine] { coroutine.resume(); });
+      }
+   }
+
+   auto await_resume() const -> T
+   {
+      if (not awaited.ready()) {
+         throw canceled_task_error{"Task was canceled while being awaited."};
+      }
+
+      return awaited.get();
+   }
+};
+
+/// @brief Awaiter for resume_on.
+struct resume_on_awaiter {
+   async::thread_pool& pool;
+   task_priority priority;
+
+   bool await_ready() const noexcept
+   {
+      return false;
+   }
+
+   template<typename Promise>
+   void await_suspend(std::coroutine_handle<Promise> coroutine) const noexcept
+   {
+      if constexpr (requires { coroutine.promise().priority; }) {
+         coroutine.promise().priority = priority;
+      }
+
+      pool.resume(priority, coroutine);
+   }
+
+   void await_resume() const noexcept {}
+};
+
+}
+
+/// @brief Await a task, getting it's result. Throws any exception thrown by the task or canceled_task_error if the task was canceled.
+/// @param task The task to await.
+template<typename T>
+inline auto operator co_await(task<T>& task) noexcept -> detail::task_awaiter<T>
+{
+   return {task};
+}
+
+/// @brief Await a task, getting it's result. Throws any exception thrown by the task or canceled_task_error if the task was canceled.
+/// @param task The task to await.
+template<typename T>
+inline auto operator co_await(task<T>&& task) noexcept -> detail::task_awaiter<T>
+{
+   return {task};
+}
+
+/// @brief Move the calling coroutine onto a thread_pool at a priority. For coroutine tasks the coroutine keeps resuming at
+/// that priority after later co_awaits. Useful for moving between I/O bound and CPU bound stages of a coroutine.
+/// @param thread_pool The thread_pool to resume on.
+/// @param priority The priority to resume at.
+[[nodiscard]] inline auto resume_on(thread_pool& thread_pool, const task_priority priority) noexcept
+   -> detail::resume_on_awaiter
+{
+   return {thread_pool, priority};
+}
+
+}
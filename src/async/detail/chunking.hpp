@@ -0,0 +1,49 @@
+#pragma once
+
+#include "../thread_pool.hpp"
+
+#include <algorithm>
+#include <cstddef>
+
+namespace we::async::detail {
+
+/// @brief Smallest number of elements worth handing to a task in the parallel algorithms.
+constexpr std::size_t min_parallel_chunk_size = 1024;
+
+/// @brief How a range is split up into contiguous chunks for the parallel algorithms.
+struct chunking {
+   std::size_t size = 0;
+   std::size_t count = 0;
+   std::size_t chunk_size = 0;
+
+   [[nodiscard]] auto begin(const std::size_t chunk) const noexcept -> std::size_t
+   {
+      return std::min(chunk * chunk_size, size);
+   }
+
+   [[nodiscard]] auto end(const std::size_t chunk) const noexcept -> std::size_t
+   {
+      return std::min((chunk + 1) * chunk_size, size);
+   }
+};
+
+/// @brief Split a range into chunks. There are a few chunks per thread so the guided for_each_n can balance them.
+/// A range too small to be worth splitting has a single chunk (or none if it is empty).
+/// @param thread_pool The thread_pool the chunks will be processed on.
+/// @param priority The priority the chunks will be processed at.
+/// @param size The size of the range.
+/// @return The chunking.
+inline auto make_chunking(const thread_pool& thread_pool, const task_priority priority,
+                          const std::size_t size) noexcept -> chunking
+{
+   if (size == 0) return {};
+
+   const std::size_t max_count = (thread_pool.thread_count(priority) + 1) * 4;
+   const std::size_t count =
+      std::clamp(size / min_parallel_chunk_size, std::size_t{1}, max_count);
+   const std::size_t chunk_size = (size + count - 1) / count;
+
+   return {.size = size, .count = (size + chunk_size - 1) / chunk_size, .chunk_size = chunk_size};
+}
+
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+namespace we::async::detail {
+
+/// @brief Multi-producer multi-consumer FIFO queue used to get tasks from outside of a thread_pool into it's workers.
+///
+/// The fast path is a bounded lock-free ring (Dmitry Vyukov's bounded MPMC queue). If the ring fills up items spill
+/// into a mutex protected overflow queue, once the ring is full strict FIFO ordering between items is not guaranteed.
+/// @tparam T The type of the items in the queue. The queue stores pointers to T.
+template<typename T>
+struct injection_queue {
+   /// @brief Construct the queue.
+   /// @param capacity The capacity of the lock-free ring. Must be a power of two.
+   explicit injection_queue(const std::size_t capacity)
+      : _mask{capacity - 1}, _cells{std::make_unique<cell[]>(capacity)}
+   {
+      for (std::size_t i = 0; i < capacity; ++i) {
+         _cells[i].sequence.store(i, std::memory_order_relaxed);
+      }
+   }
+
+   injection_queue(const injection_queue&) = delete;
+   injection_queue(injection_queue&&) = delete;
+   auto operator=(const injection_queue&) -> injection_queue& = delete;
+   auto operator=(injection_queue&&) -> injection_queue& = delete;
+
+   /// @brief Push an item onto the queue. Can be called from any thread.
+   /// @param item The item to push.
+   void push(T* item) noexcept
+   {
+      if (try_push_ring(item)) return;
+
+      std::scoped_lock lock{_overflow_mutex};
+
+      _overflow.push_back(item);
+      _overflow_size.fetch_add(1, std::memory_order_release);
+   }
+
+   /// @brief Pop an item from the queue. Can be called from any thread.
+   /// @return The item or nullptr if the queue was empty.
+   [[nodiscard]] auto pop() noexcept -> T*
+   {
+      if (T* item = try_pop_ring(); item) return item;
+
+      if (_overflow_size.load(std::memory_order_acquire) == 0) return nullptr;
+
+      std::scoped_lock lock{_overflow_mutex};
+
+      if (_overflow.empty()) return nullptr;
+
+      T* item = _overflow.front();
+
+      _overflow.pop_front();
+      _overflow_size.fetch_sub(1, std::memory_order_release);
+
+      return item;
+   }
+
+private:
+   bool try_push_ring(T* item) noexcept
+   {
+      std::size_t position = _enqueue_position.load(std::memory_order_relaxed);
+
+      while (true) {
+         cell& cell = _cells[position & _mask];
+
+         const std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+         const std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence) -
+                                           static_cast<std::ptrdiff_t>(position);
+
+         if (difference == 0) {
+            if (_enqueue_position.compare_exchange_weak(position, position + 1,
+                                                        std::memory_order_relaxed)) {
+               cell.item = item;
+               cell.sequence.store(position + 1, std::memory_order_release);
+
+               return true;
+            }
+         }
+         else if (difference < 0) {
+            return false;
+         }
+         else {
+            position = _enqueue_position.load(std::memory_order_relaxed);
+         }
+      }
+   }
+
+   auto try_pop_ring() noexcept -> T*
+   {
+      std::size_t position = _dequeue_position.load(std::memory_order_relaxed);
+
+      while (true) {
+         cell& cell = _cells[position & _mask];
+
+         const std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+         const std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence) -
+                                           static_cast<std::ptrdiff_t>(position + 1);
+
+         if (difference == 0) {
+            if (_dequeue_position.compare_exchange_weak(position, position + 1,
+                                                        std::memory_order_relaxed)) {
+               T* item = cell.item;
+
+               cell.sequence.store(position + _mask + 1, std::memory_order_release);
+
+               return item;
+            }
+         }
+         else if (difference < 0) {
+            return nullptr;
+         }
+         else {
+            position = _dequeue_position.load(std::memory_order_relaxed);
+         }
+      }
+   }
+
+   struct cell {
+      std::atomic_size_t sequence = 0;
+      T* item = nullptr;
+   };
+
+   alignas(64) std::atomic_size_t _enqueue_position = 0;
+   alignas(64) std::atomic_size_t _dequeue_position = 0;
+
+   alignas(64) const std::size_t _mask;
+   const std::unique_ptr<cell[]> _cells;
+
+   std::atomic_size_t _overflow_size = 0;
+   std::mutex _overflow_mutex;
+   std::deque<T*> _overflow;
+};
+
+}
@@ -0,0 +1,316 @@
+#include "recycling_allocator.hpp"
+#include "async/thread_pool.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <mutex>
+#include <new>
+#include <shared_mutex>
+#include <utility>
+#include <vector>
+
+namespace we::async {
+
+namespace detail {
+
+namespace {
+
+constexpr std::size_t min_size_class_size = 64;
+constexpr std::size_t size_class_count = 8; // 64 bytes to 8 KiB
+constexpr std::size_t max_depot_batches = 64;
+
+constexpr std::size_t block_alignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+struct free_block {
+   free_block* next;
+};
+
+auto class_size(const std::size_t size_class) noexcept -> std::size_t
+{
+   return min_size_class_size << size_class;
+}
+
+/// @brief Tasks are often allocated on one thread and freed on another, so
+/// threads move blocks between each other through a shared depot in batches.
+struct depot {
+   std::mutex mutex;
+   std::vector<free_block*> batches;
+};
+
+struct depot_set {
+   depot_set()
+   {
+      for (depot& depot : depots) depot.batches.reserve(max_depot_batches);
+   }
+
+   ~depot_set()
+   {
+      for (std::size_t size_class = 0; size_class < size_class_count; ++size_class) {
+         for (free_block* block : depots[size_class].batches) {
+            while (block) {
+               ::operator delete(std::exchange(block, block->next),
+                                 class_size(size_class));
+            }
+         }
+      }
+   }
+
+   depot_set(const depot_set&) = delete;
+   depot_set(depot_set&&) = delete;
+   auto operator=(const depot_set&) -> depot_set& = delete;
+   auto operator=(depot_set&&) -> depot_set& = delete;
+
+   std::array<depot, size_class_count> depots;
+};
+
+auto get_depot(const std::size_t size_class) noexcept -> depot&
+{
+   static depot_set depot_set;
+
+   return depot_set.depots[size_class];
+}
+
+/// @brief The number of blocks moved to and from the depot at once.
+auto batch_size(const std::size_t size_class) noexcept -> std::size_t
+{
+   return std::max(std::size_t{4096} / class_size(size_class), std::size_t{4});
+}
+
+struct thread_counters {
+   std::atomic_size_t submitted_tasks = 0;
+   std::atomic_size_t recycled_allocations = 0;
+   std::atomic_size_t heap_allocations = 0;
+};
+
+/// @brief Registry of every live thread's counters, so they can be summed.
+struct counters_registry {
+   std::shared_mutex mutex;
+   std::vector<const thread_counters*> live_counters;
+
+   /// @brief Totals from threads that have exited.
+   task_allocation_stats retired_stats;
+};
+
+auto get_counters_registry() noexcept -> counters_registry&
+{
+   static counters_registry registry;
+
+   return registry;
+}
+
+/// @brief Only the owning thread writes to the counters so a load and store
+/// is enough, other threads only ever read them.
+void increment(std::atomic_size_t& counter) noexcept
+{
+   counter.store(counter.load(std::memory_order_relaxed) + 1,
+                 std::memory_order_relaxed);
+}
+
+struct thread_cache {
+   thread_cache()
+   {
+      counters_registry& registry = get_counters_registry();
+
+      std::scoped_lock lock{registry.mutex};
+
+      registry.live_counters.push_back(&counters);
+   }
+
+   ~thread_cache();
+
+   thread_cache(const thread_cache&) = delete;
+   thread_cache(thread_cache&&) = delete;
+   auto operator=(const thread_cache&) -> thread_cache& = delete;
+   auto operator=(thread_cache&&) -> thread_cache& = delete;
+
+   std::array<free_block*, size_class_count> free_lists{};
+   std::array<std::size_t, size_class_count> free_counts{};
+
+   thread_counters counters;
+};
+
+/// @brief Set once the calling thread's cache has been destroyed, any blocks
+/// freed after this (from thread_local or static destructors) go straight back to the heap.
+constinit thread_local bool thread_cache_destroyed = false;
+
+thread_local thread_cache cache;
+
+thread_cache::~thread_cache()
+{
+   thread_cache_destroyed = true;
+
+   for (std::size_t size_class = 0; size_class < size_class_count; ++size_class) {
+      while (free_block* block = free_lists[size_class]) {
+         free_lists[size_class] = block->next;
+
+         ::operator delete(block, class_size(size_class));
+      }
+   }
+
+   counters_registry& registry = get_counters_registry();
+
+   std::scoped_lock lock{registry.mutex};
+
+   std::erase(registry.live_counters, &counters);
+
+   registry.retired_stats.submitted_tasks += counters.submitted_tasks.load();
+   registry.retired_stats.recycled_allocations += counters.recycled_allocations.load();
+   registry.retired_stats.heap_allocations += counters.heap_allocations.load();
+}
+
+/// @brief Get the size class for a block. Returns size_class_count if the block is not cacheable.
+auto select_size_class(const std::size_t size, const std::size_t alignment) noexcept
+   -> std::size_t
+{
+   if (alignment > block_alignment) return size_class_count;
+
+   const std::size_t rounded_size = std::bit_ceil(std::max(size, min_size_class_size));
+
+   return static_cast<std::size_t>(std::countr_zero(rounded_size) -
+                                   std::countr_zero(min_size_class_size));
+}
+
+/// @brief Move a batch of blocks from the depot into the calling thread's cache.
+bool refill_from_depot(const std::size_t size_class) noexcept
+{
+   depot& depot = get_depot(size_class);
+
+   free_block* batch = nullptr;
+
+   {
+      std::scoped_lock lock{depot.mutex};
+
+      if (depot.batches.empty()) return false;
+
+      batch = depot.batches.back();
+      depot.batches.pop_back();
+   }
+
+   cache.free_lists[size_class] = batch;
+   cache.free_counts[size_class] = batch_size(size_class);
+
+   return true;
+}
+
+/// @brief Move a batch of blocks from the calling thread's cache into the depot, freeing them if the depot is full.
+void flush_to_depot(const std::size_t size_class) noexcept
+{
+   free_block* const batch = cache.free_lists[size_class];
+   free_block* batch_tail = batch;
+
+   for (std::size_t i = 1; i < batch_size(size_class); ++i) {
+      batch_tail = batch_tail->next;
+   }
+
+   cache.free_lists[size_class] = std::exchange(batch_tail->next, nullptr);
+   cache.free_counts[size_class] -= batch_size(size_class);
+
+   depot& depot = get_depot(size_class);
+
+   {
+      std::scoped_lock lock{depot.mutex};
+
+      if (depot.batches.size() < max_depot_batches) {
+         depot.batches.push_back(batch);
+
+         return;
+      }
+   }
+
+   for (free_block* block = batch; block;) {
+      ::operator delete(std::exchange(block, block->next), class_size(size_class));
+   }
+}
+
+}
+
+auto recycling_allocate(const std::size_t size, const std::size_t alignment) -> void*
+{
+   const std::size_t size_class = select_size_class(size, alignment);
+
+   if (size_class >= size_class_count) {
+      if (not thread_cache_destroyed) increment(cache.counters.heap_allocations);
+
+      if (alignment > block_alignment) {
+         return ::operator new(size, std::align_val_t{alignment});
+      }
+
+      return ::operator new(size);
+   }
+
+   // Cacheable blocks are always class sized, a block allocated here may be freed on a thread
+   // with a live cache and be handed out again for any size in its class.
+   if (thread_cache_destroyed) return ::operator new(class_size(size_class));
+
+   if (cache.free_lists[size_class] or refill_from_depot(size_class)) {
+      free_block* block = cache.free_lists[size_class];
+
+      cache.free_lists[size_class] = block->next;
+      cache.free_counts[size_class] -= 1;
+
+      increment(cache.counters.recycled_allocations);
+
+      return block;
+   }
+
+   increment(cache.counters.heap_allocations);
+
+   return ::operator new(class_size(size_class));
+}
+
+void recycling_deallocate(void* block, const std::size_t size,
+                          const std::size_t alignment) noexcept
+{
+   const std::size_t size_class = select_size_class(size, alignment);
+
+   if (size_class >= size_class_count) {
+      if (alignment > block_alignment) {
+         return ::operator delete(block, size, std::align_val_t{alignment});
+      }
+
+      return ::operator delete(block, size);
+   }
+
+   if (thread_cache_destroyed) {
+      return ::operator delete(block, class_size(size_class));
+   }
+
+   cache.free_lists[size_class] = new (block) free_block{cache.free_lists[size_class]};
+   cache.free_counts[size_class] += 1;
+
+   if (cache.free_counts[size_class] >= batch_size(size_class) * 2) {
+      flush_to_depot(size_class);
+   }
+}
+
+void count_submitted_task() noexcept
+{
+   if (thread_cache_destroyed) return;
+
+   increment(cache.counters.submitted_tasks);
+}
+
+}
+
+auto get_task_allocation_stats() noexcept -> task_allocation_stats
+{
+   detail::counters_registry& registry = detail::get_counters_registry();
+
+   std::shared_lock lock{registry.mutex};
+
+   task_allocation_stats stats = registry.retired_stats;
+
+   for (const detail::thread_counters* counters : registry.live_counters) {
+      stats.submitted_tasks += counters->submitted_tasks.load(std::memory_order_relaxed);
+      stats.recycled_allocations +=
+         counters->recycled_allocations.load(std::memory_order_relaxed);
+      stats.heap_allocations +=
+         counters->heap_allocations.load(std::memory_order_relaxed);
+   }
+
+   return stats;
+}
+
+}
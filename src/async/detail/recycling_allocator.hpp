@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+
+namespace we::async::detail {
+
+/// @brief Allocate a block from the calling thread's cache of recycled blocks, going to the heap if there is no suitable block cached.
+/// @param size The size of the block.
+/// @param alignment The alignment of the block.
+/// @return The block.
+[[nodiscard]] auto recycling_allocate(const std::size_t size,
+                                      const std::size_t alignment) -> void*;
+
+/// @brief Return a block from recycling_allocate to the calling thread's cache. Blocks can be returned from any thread.
+/// @param block The block.
+/// @param size The size the block was allocated with.
+/// @param alignment The alignment the block was allocated with.
+void recycling_deallocate(void* block, const std::size_t size,
+                          const std::size_t alignment) noexcept;
+
+/// @brief Record a task being submitted to a thread_pool in the calling thread's allocation counters.
+void count_submitted_task() noexcept;
+
+/// @brief Allocator for task contexts and spilled task functions. Blocks are cached per thread and reused
+/// so that in the steady state submitting a task does not touch the heap.
+/// @tparam T The type to allocate.
+template<typename T>
+struct recycling_allocator {
+   using value_type = T;
+
+   recycling_allocator() noexcept = default;
+
+   template<typename U>
+   recycling_allocator(const recycling_allocator<U>&) noexcept
+   {
+   }
+
+   [[nodiscard]] auto allocate(const std::size_t n) -> T*
+   {
+      return static_cast<T*>(recycling_allocate(n * sizeof(T), alignof(T)));
+   }
+
+   void deallocate(T* block, const std::size_t n) noexcept
+   {
+      recycling_deallocate(block, n * sizeof(T), alignof(T));
+   }
+
+   template<typename U>
+   bool operator==(const recycling_allocator<U>&) const noexcept
+   {
+      return true;
+   }
+};
+
+}
@@ -0,0 +1,175 @@
+#pragma once
+
+#include "recycling_allocator.hpp"
+
+#include <concepts>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace we::async::detail {
+
+/// @brief Move only void() callable used to execute tasks. Callables up to inline_capacity bytes are stored
+/// inline, larger ones are stored in a block from recycling_allocate. Any result from the callable is discarded.
+class task_function {
+public:
+   /// @brief The size of the callables that can be stored without allocating.
+   constexpr static std::size_t inline_capacity = 7 * sizeof(void*);
+
+   /// @brief Construct an empty task_function. Calling an empty task_function results in std::terminate being called.
+   task_function() noexcept = default;
+
+   /// @brief Construct an empty task_function.
+   task_function(std::nullptr_t) noexcept {}
+
+   /// @brief Construct a task_function from a callable.
+   /// @tparam Fn The type of the callable.
+   /// @param function The callable.
+   template<typename Fn>
+      requires(not std::same_as<std::remove_cvref_t<Fn>, task_function> and
+               std::invocable<std::decay_t<Fn>&>)
+   task_function(Fn&& function)
+   {
+      using T = std::decay_t<Fn>;
+
+      if constexpr (stored_inline<T>) {
+         new (&_storage) T(std::forward<Fn>(function));
+      }
+      else {
+         void* block = recycling_allocate(sizeof(T), alignof(T));
+
+         try {
+            _heap_function = new (block) T(std::forward<Fn>(function));
+         }
+         catch (...) {
+            recycling_deallocate(block, sizeof(T), alignof(T));
+
+            throw;
+         }
+      }
+
+      _vtable = &vtable_for<T>;
+   }
+
+   task_function(task_function&& other) noexcept
+   {
+      move_from(other);
+   }
+
+   auto operator=(task_function&& other) noexcept -> task_function&
+   {
+      if (this != &other) {
+         reset();
+         move_from(other);
+      }
+
+      return *this;
+   }
+
+   task_function(const task_function&) = delete;
+   auto operator=(const task_function&) -> task_function& = delete;
+
+   ~task_function()
+   {
+      reset();
+   }
+
+   /// @brief Invoke the callable.
+   void operator()()
+   {
+      if (not _vtable) std::terminate();
+
+      _vtable->invoke(*this);
+   }
+
+   /// @brief Check if the task_function is holding a callable.
+   explicit operator bool() const noexcept
+   {
+      return _vtable != nullptr;
+   }
+
+private:
+   template<typename T>
+   constexpr static bool stored_inline =
+      sizeof(T) <= inline_capacity and alignof(T) <= alignof(void*) and
+      std::is_nothrow_move_constructible_v<T>;
+
+   struct vtable {
+      void (*invoke)(task_function& self);
+      void (*move)(task_function& from, task_function& to) noexcept;
+      void (*destroy)(task_function& self) noexcept;
+   };
+
+   template<typename T>
+   static auto get(task_function& self) noexcept -> T&
+   {
+      if constexpr (stored_inline<T>) {
+         return *std::launder(reinterpret_cast<T*>(&self._storage));
+      }
+      else {
+         return *static_cast<T*>(self._heap_function);
+      }
+   }
+
+   template<typename T>
+   static void invoke(task_function& self)
+   {
+      std::invoke(get<T>(self));
+   }
+
+   template<typename T>
+   static void move(task_function& from, task_function& to) noexcept
+   {
+      if constexpr (stored_inline<T>) {
+         new (&to._storage) T(std::move(get<T>(from)));
+
+         get<T>(from).~T();
+      }
+      else {
+         to._heap_function = std::exchange(from._heap_function, nullptr);
+      }
+   }
+
+   template<typename T>
+   static void destroy(task_function& self) noexcept
+   {
+      get<T>(self).~T();
+
+      if constexpr (not stored_inline<T>) {
+         recycling_deallocate(self._heap_function, sizeof(T), alignof(T));
+      }
+   }
+
+   template<typename T>
+   constexpr static vtable vtable_for = {.invoke = &invoke<T>,
+                                         .move = &move<T>,
+                                         .destroy = &destroy<T>};
+
+   void move_from(task_function& other) noexcept
+   {
+      if (not other._vtable) return;
+
+      other._vtable->move(other, *this);
+
+      _vtable = std::exchange(other._vtable, nullptr);
+   }
+
+   void reset() noexcept
+   {
+      if (not _vtable) return;
+
+      std::exchange(_vtable, nullptr)->destroy(*this);
+   }
+
+   const vtable* _vtable = nullptr;
+
+   union {
+      alignas(void*) std::byte _storage[inline_capacity];
+      void* _heap_function;
+   };
+};
+
+}
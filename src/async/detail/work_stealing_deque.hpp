@@ -0,0 +1,120 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace we::async::detail {
+
+/// @brief Fixed capacity Chase-Lev work stealing deque. The owning thread pushes and pops from the bottom, any other thread can steal from the top.
+///
+/// Implementation follows "Correct and Efficient Work-Stealing for Weak Memory Models" (Lê et al. 2013), without the buffer growth.
+/// When the deque is full push fails and the caller is expected to fallback to another queue.
+/// @tparam T The type of the items in the deque. The deque stores pointers to T.
+template<typename T>
+struct work_stealing_deque {
+   /// @brief Construct the deque.
+   /// @param capacity The capacity of the deque. Must be a power of two.
+   explicit work_stealing_deque(const std::size_t capacity)
+      : _mask{static_cast<std::ptrdiff_t>(capacity - 1)},
+        _items{std::make_unique<std::atomic<T*>[]>(capacity)}
+   {
+   }
+
+   work_stealing_deque(const work_stealing_deque&) = delete;
+   work_stealing_deque(work_stealing_deque&&) = delete;
+   auto operator=(const work_stealing_deque&) -> work_stealing_deque& = delete;
+   auto operator=(work_stealing_deque&&) -> work_stealing_deque& = delete;
+
+   /// @brief Push an item onto the bottom of the deque. Must only be called by the owning thread.
+   /// @param item The item to push.
+   /// @return True if the item was pushed, false if the deque was full.
+   [[nodiscard]] bool push(T* item) noexcept
+   {
+      const std::ptrdiff_t bottom = _bottom.load(std::memory_order_relaxed);
+      const std::ptrdiff_t top = _top.load(std::memory_order_acquire);
+
+      if (bottom - top > _mask) return false;
+
+      _items[bottom & _mask].store(item, std::memory_order_relaxed);
+
+      std::atomic_thread_fence(std::memory_order_release);
+
+      _bottom.store(bottom + 1, std::memory_order_relaxed);
+
+      return true;
+   }
+
+   /// @brief Pop an item from the bottom of the deque. Must only be called by the owning thread.
+   /// @return The item or nullptr if the deque was empty.
+   [[nodiscard]] auto pop() noexcept -> T*
+   {
+      const std::ptrdiff_t bottom = _bottom.load(std::memory_order_relaxed) - 1;
+
+      _bottom.store(bottom, std::memory_order_relaxed);
+
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+
+      std::ptrdiff_t top = _top.load(std::memory_order_relaxed);
+
+      if (top > bottom) {
+         _bottom.store(bottom + 1, std::memory_order_relaxed);
+
+         return nullptr;
+      }
+
+      T* item = _items[bottom & _mask].load(std::memory_order_relaxed);
+
+      // Last item in the deque, race any thieves for it.
+      if (top == bottom) {
+         if (not _top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                              std::memory_order_relaxed)) {
+            item = nullptr;
+         }
+
+         _bottom.store(bottom + 1, std::memory_order_relaxed);
+      }
+
+      return item;
+   }
+
+   /// @brief Steal an item from the top of the deque. Can be called from any thread.
+   /// @return The item or nullptr if the deque was empty or the steal lost a race with another thread.
+   [[nodiscard]] auto steal() noexcept -> T*
+   {
+      std::ptrdiff_t top = _top.load(std::memory_order_acquire);
+
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+
+      const std::ptrdiff_t bottom = _bottom.load(std::memory_order_acquire);
+
+      if (top >= bottom) return nullptr;
+
+      T* item = _items[top & _mask].load(std::memory_order_relaxed);
+
+      if (not _top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                           std::memory_order_relaxed)) {
+         return nullptr;
+      }
+
+      return item;
+   }
+
+   /// @brief Approximate count of the items in the deque. Only exact when called by the owning thread with no concurrent thieves.
+   [[nodiscard]] auto size() const noexcept -> std::size_t
+   {
+      const std::ptrdiff_t bottom = _bottom.load(std::memory_order_relaxed);
+      const std::ptrdiff_t top = _top.load(std::memory_order_relaxed);
+
+      return bottom > top ? static_cast<std::size_t>(bottom - top) : 0;
+   }
+
+private:
+   alignas(64) std::atomic_ptrdiff_t _top = 0;
+   alignas(64) std::atomic_ptrdiff_t _bottom = 0;
+
+   alignas(64) const std::ptrdiff_t _mask;
+   const std::unique_ptr<std::atomic<T*>[]> _items;
+};
+
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "thread_pool.hpp"
+#include "when_all.hpp"
 
 #include <ranges>
 #include <tuple>
@@ -14,11 +15,14 @@ namespace we::async {
 template<typename... Ts>
 inline auto get_all(task<Ts>&... tasks) -> std::tuple<Ts...>
 {
+   when_all(tasks...).wait();
+
    return {tasks.get()...};
 }
 
 template<typename T>
 concept result_producing_task_range = std::ranges::forward_range<T> and
+   dependable_task_range<T> and
    requires(std::ranges::range_reference_t<T> task)
 {
    {task.get()};
@@ -35,6 +39,8 @@ inline auto get_all(task_range& tasks)
 
    results.reserve(std::ranges::size(tasks));
 
+   when_all(tasks).wait();
+
    for (auto& task : tasks) results.emplace_back(task.get());
 
    return results;
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "detail/chunking.hpp"
+#include "thread_pool.hpp"
+
+#include <optional>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace we::async {
+
+/// @brief Compute the inclusive prefix scan of a range in parallel using a thread_pool. scan must be associative.
+/// The range is scanned in three passes, each chunk is reduced, the chunk totals are scanned and then each chunk is
+/// scanned again starting from the total before it.
+/// @param thread_pool The thread_pool.
+/// @param priority The priority for the scan on the thread_pool.
+/// @param input The random access range to scan.
+/// @param output The random access range to write the scan to. Must be at least as large as input and can be input itself.
+/// @param scan The function combining two values. Must not throw.
+template<std::ranges::random_access_range input_range,
+         std::ranges::random_access_range output_range, typename scan_t,
+         typename T = std::ranges::range_value_t<input_range>>
+inline void parallel_inclusive_scan(thread_pool& thread_pool, const task_priority priority,
+                                    input_range& input, output_range& output,
+                                    const scan_t& scan) noexcept
+   requires(std::ranges::sized_range<input_range> and
+            std::ranges::sized_range<output_range> and
+            std::is_invocable_r_v<T, const scan_t&, T, T> and
+            std::is_assignable_v<std::ranges::range_reference_t<output_range>, T&>)
+{
+   const detail::chunking chunks =
+      detail::make_chunking(thread_pool, priority, std::ranges::size(input));
+
+   if (std::ranges::size(output) < chunks.size) std::terminate();
+
+   const auto input_iter = std::ranges::begin(input);
+   const auto output_iter = std::ranges::begin(output);
+
+   const auto scan_chunk = [&](const std::size_t begin, const std::size_t end,
+                               std::optional<T> total) noexcept {
+      for (std::size_t i = begin; i < end; ++i) {
+         total = total ? scan(std::move(*total), input_iter[i]) : T(input_iter[i]);
+
+         output_iter[i] = *total;
+      }
+   };
+
+   if (chunks.count <= 1) return scan_chunk(0, chunks.size, std::nullopt);
+
+   // The last chunk's total is never needed.
+   std::vector<std::optional<T>> totals(chunks.count - 1);
+
+   thread_pool.for_each_n(priority, totals.size(), [&](const std::size_t chunk) noexcept {
+      const std::size_t end = chunks.end(chunk);
+
+      T total = input_iter[chunks.begin(chunk)];
+
+      for (std::size_t i = chunks.begin(chunk) + 1; i < end; ++i) {
+         total = scan(std::move(total), input_iter[i]);
+      }
+
+      totals[chunk].emplace(std::move(total));
+   });
+
+   // Turn the totals into the value before each chunk (after the first).
+   for (std::size_t i = 1; i < totals.size(); ++i) {
+      totals[i] = scan(*totals[i - 1], std::move(*totals[i]));
+   }
+
+   thread_pool.for_each_n(priority, chunks.count, [&](const std::size_t chunk) noexcept {
+      scan_chunk(chunks.begin(chunk), chunks.end(chunk),
+                 chunk == 0 ? std::nullopt : totals[chunk - 1]);
+   });
+}
+
+/// @brief Compute the inclusive prefix sum of a range in parallel using a thread_pool.
+/// @param thread_pool The thread_pool.
+/// @param priority The priority for the scan on the thread_pool.
+/// @param input The random access range to scan.
+/// @param output The random access range to write the scan to. Must be at least as large as input and can be input itself.
+template<std::ranges::random_access_range input_range, std::ranges::random_access_range output_range>
+inline void parallel_inclusive_scan(thread_pool& thread_pool, const task_priority priority,
+                                    input_range& input, output_range& output) noexcept
+   requires(std::ranges::sized_range<input_range> and std::ranges::sized_range<output_range>)
+{
+   parallel_inclusive_scan(thread_pool, priority, input, output, std::plus<>{});
+}
+
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "detail/chunking.hpp"
+#include "thread_pool.hpp"
+
+#include <optional>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace we::async {
+
+/// @brief Transform every item in a range and reduce the results in parallel using a thread_pool. Like std::transform_reduce
+/// reduce must be associative, unlike std::transform_reduce it need not be commutative as the order of the items is kept.
+/// @param thread_pool The thread_pool.
+/// @param priority The priority for the reduction on the thread_pool.
+/// @param range The random access range to reduce.
+/// @param init The initial value, reduced with the result of the first item.
+/// @param reduce The function combining two values. Must not throw.
+/// @param transform The function transforming each item. Must not throw.
+/// @return The reduced value.
+template<std::ranges::random_access_range random_access_range, typename T,
+         typename reduce_t, typename transform_t>
+inline auto parallel_transform_reduce(thread_pool& thread_pool, const task_priority priority,
+                                      random_access_range& range, T init,
+                                      const reduce_t& reduce,
+                                      const transform_t& transform) noexcept -> T
+   requires(std::ranges::sized_range<random_access_range> and
+            std::is_invocable_r_v<T, const transform_t&,
+                                          std::ranges::range_reference_t<random_access_range>> and
+            std::is_invocable_r_v<T, const reduce_t&, T, T>)
+{
+   const detail::chunking chunks =
+      detail::make_chunking(thread_pool, priority, std::ranges::size(range));
+   const auto iter = std::ranges::begin(range);
+
+   if (chunks.count <= 1) {
+      for (std::size_t i = 0; i < chunks.size; ++i) {
+         init = reduce(std::move(init), transform(iter[i]));
+      }
+
+      return init;
+   }
+
+   std::vector<std::optional<T>> partials(chunks.count);
+
+   thread_pool.for_each_n(priority, chunks.count, [&](const std::size_t chunk) noexcept {
+      const std::size_t end = chunks.end(chunk);
+
+      T partial = transform(iter[chunks.begin(chunk)]);
+
+      for (std::size_t i = chunks.begin(chunk) + 1; i < end; ++i) {
+         partial = reduce(std::move(partial), transform(iter[i]));
+      }
+
+      partials[chunk].emplace(std::move(partial));
+   });
+
+   for (std::optional<T>& partial : partials) {
+      init = reduce(std::move(init), std::move(*partial));
+   }
+
+   return init;
+}
+
+/// @brief Reduce a range in parallel using a thread_pool. Like std::reduce reduce must be associative, unlike std::reduce
+/// it need not be commutative as the order of the items is kept.
+/// @param thread_pool The thread_pool.
+/// @param priority The priority for the reduction on the thread_pool.
+/// @param range The random access range to reduce.
+/// @param init The initial value, reduced with the first item.
+/// @param reduce The function combining two values. Must not throw.
+/// @return The reduced value.
+template<std::ranges::random_access_range random_access_range, typename T, typename reduce_t>
+inline auto parallel_reduce(thread_pool& thread_pool, const task_priority priority,
+                            random_access_range& range, T init,
+                            const reduce_t& reduce) noexcept -> T
+   requires(std::ranges::sized_range<random_access_range> and
+            std::is_convertible_v<std::ranges::range_reference_t<random_access_range>, T> and
+            std::is_invocable_r_v<T, const reduce_t&, T, T>)
+{
+   return parallel_transform_reduce(
+      thread_pool, priority, range, std::move(init), reduce,
+      [](std::ranges::range_reference_t<random_access_range> item) noexcept -> T {
+         return item;
+      });
+}
+
+}
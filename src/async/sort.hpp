@@ -0,0 +1,53 @@
+#pragma once
+
+#include "detail/chunking.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <ranges>
+
+namespace we::async {
+
+/// @brief Sort a range in parallel using a thread_pool. The range is split into chunks that are sorted in parallel
+/// and then merged together in pairs, with the merges of each round also running in parallel. Like std::sort the sort is not stable.
+/// @param thread_pool The thread_pool.
+/// @param priority The priority for the sort on the thread_pool.
+/// @param range The random access range to sort.
+/// @param compare The comparison function. Must not throw.
+template<std::ranges::random_access_range random_access_range,
+         typename compare_t = std::ranges::less>
+inline void parallel_sort(thread_pool& thread_pool, const task_priority priority,
+                          random_access_range& range, const compare_t& compare = {}) noexcept
+   requires(std::ranges::sized_range<random_access_range> and
+            std::sortable<std::ranges::iterator_t<random_access_range>, compare_t>)
+{
+   const detail::chunking chunks =
+      detail::make_chunking(thread_pool, priority, std::ranges::size(range));
+   const auto iter = std::ranges::begin(range);
+
+   if (chunks.count <= 1) {
+      return std::sort(iter, iter + chunks.size, std::ref(compare));
+   }
+
+   thread_pool.for_each_n(priority, chunks.count, [&](const std::size_t chunk) noexcept {
+      std::sort(iter + chunks.begin(chunk), iter + chunks.end(chunk), std::ref(compare));
+   });
+
+   // Each round merges pairs of sorted runs width chunks long.
+   for (std::size_t width = 1; width < chunks.count; width *= 2) {
+      const std::size_t merge_count = (chunks.count + width * 2 - 1) / (width * 2);
+
+      thread_pool.for_each_n(priority, merge_count, [&](const std::size_t merge) noexcept {
+         const std::size_t first = chunks.begin(merge * width * 2);
+         const std::size_t middle = chunks.begin(merge * width * 2 + width);
+         const std::size_t last = chunks.begin(merge * width * 2 + width * 2);
+
+         if (middle >= last) return;
+
+         std::inplace_merge(iter + first, iter + middle, iter + last, std::ref(compare));
+      });
+   }
+}
+
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "thread_pool.hpp"
+
+#include <array>
+#include <type_traits>
+
+namespace we::async {
+
+namespace detail {
+
+template<typename T, typename Fn>
+struct then_result {
+   using type = std::invoke_result_t<const Fn&, T>;
+};
+
+template<typename Fn>
+struct then_result<void, Fn> {
+   using type = std::invoke_result_t<const Fn&>;
+};
+
+}
+
+/// @brief Schedules a function on a thread_pool to run once a task has completed. No thread blocks while the task is pending.
+/// The function is passed the result of the task (or nothing if it returns void). If the task threw an exception the function
+/// is skipped and the exception is stored in the returned task instead.
+/// @tparam T The return type of the task being continued.
+/// @tparam Fn The function to invoke with the task's result.
+/// @param thread_pool The thread_pool to run the function on.
+/// @param priority The priority of the continuation.
+/// @param antecedent The task to continue. The returned task takes ownership of it.
+/// @param func The function.
+/// @return The task for the continuation.
+template<typename T, typename Fn, typename U = typename detail::then_result<T, Fn>::type>
+[[nodiscard]] inline auto then(thread_pool& thread_pool, const task_priority priority,
+                               task<T>&& antecedent, Fn func) noexcept -> task<U>
+{
+   std::shared_ptr<detail::task_context<T>> antecedent_context =
+      antecedent.release_context();
+
+   const std::array<std::shared_ptr<detail::task_context_base>, 1> dependencies{
+      antecedent_context};
+
+   return thread_pool.exec_after(
+      priority, dependencies, 1,
+      [antecedent_context = std::move(antecedent_context),
+       func = std::move(func)]() -> U {
+         if (not antecedent_context->ready()) {
+            throw canceled_task_error{"Task was canceled before it's continuation could run."};
+         }
+
+         if (antecedent_context->task_exception_ptr != nullptr) {
+            std::rethrow_exception(
+               std::exchange(antecedent_context->task_exception_ptr, nullptr));
+         }
+
+         if constexpr (std::is_void_v<T>) {
+            return func();
+         }
+         else {
+            return func(std::move(antecedent_context->result));
+         }
+      });
+}
+
+}
@@ -1,7 +1,13 @@
 
 #include "thread_pool.hpp"
-
-#include <shared_mutex>
+#include "detail/injection_queue.hpp"
+#include "detail/work_stealing_deque.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
 #include <thread>
 
 #include <Windows.h>
@@ -12,38 +18,126 @@ namespace we::async {
 
 namespace detail {
 
-void task_context_base::cancel() noexcept
+namespace {
+
+/// @brief Value of continuation_list::head once the continuations have been called.
+auto completed_continuations() noexcept -> continuation*
+{
+   return reinterpret_cast<continuation*>(std::uintptr_t{1});
+}
+
+void destroy_continuation(continuation* node) noexcept
+{
+   std::destroy_at(node);
+
+   recycling_allocator<continuation>{}.deallocate(node, 1);
+}
+
+}
+
+continuation_list::~continuation_list()
+{
+   // Continuations that never ran only hold weak references, just free them.
+   continuation* head = this->head.load(std::memory_order_acquire);
+
+   if (head == completed_continuations()) return;
+
+   while (head) destroy_continuation(std::exchange(head, head->next));
+}
+
+void task_context_base::add_continuation(task_function function) noexcept
+{
+   continuation* const node = std::construct_at(
+      recycling_allocator<continuation>{}.allocate(1), std::move(function));
+
+   continuation* head = continuations.head.load(std::memory_order_acquire);
+
+   do {
+      if (head == completed_continuations()) {
+         node->function();
+
+         return destroy_continuation(node);
+      }
+
+      node->next = head;
+   } while (not continuations.head.compare_exchange_weak(head, node,
+                                                         std::memory_order_acq_rel,
+                                                         std::memory_order_acquire));
+}
+
+void task_context_base::run_continuations() noexcept
 {
-   if (auto thread_pool = owning_thread_pool.lock(); thread_pool) {
-      thread_pool->cancel_task(*this);
+   continuation* head = continuations.head.exchange(completed_continuations(),
+                                                    std::memory_order_acq_rel);
+
+   // The list is newest first, reverse it so continuations run in the order they were added.
+   continuation* ordered = nullptr;
+
+   while (head) {
+      continuation* const next = std::exchange(head->next, ordered);
+
+      ordered = std::exchange(head, next);
    }
 
+   while (ordered) {
+      continuation* const next = ordered->next;
+
+      ordered->function();
+
+      destroy_continuation(std::exchange(ordered, next));
+   }
+}
+
+bool task_context_base::completed() const noexcept
+{
+   return continuations.head.load(std::memory_order_acquire) ==
+          completed_continuations();
+}
+
+void task_context_base::cancel() noexcept
+{
+   stop_source.request_stop();
+
+   // Claiming the task stops any worker from executing it. The thread_pool's
+   // reference to it is released whenever a worker pops it. Anything depending
+   // on the task is released now rather than left waiting on it forever.
+   if (not execution_started.exchange(true)) return run_continuations();
+
+   // A task canceled by the thread_pool being destroyed has already run it's
+   // continuations and will never execute, there is nothing to wait for.
+   if (completed()) return;
+
    // If execution has started on the task then we must wait for it to finish
    // before returning as a task may be being canceled because objects it's
    // callback references are about to be destroyed.
-   if (execution_started.load()) wait();
+   wait_no_execute();
 }
 
 void task_context_base::cancel_no_wait() noexcept
 {
-   if (auto thread_pool = owning_thread_pool.lock(); thread_pool) {
-      thread_pool->cancel_task(*this);
-   }
+   stop_source.request_stop();
+
+   if (not execution_started.exchange(true)) run_continuations();
 }
 
 }
 
 struct thread_pool::impl {
    impl(const thread_pool_init& init)
+      : _lowp_context{std::make_unique<priority_level_context>(
+           task_priority::low, std::max(init.low_priority_thread_count, std::size_t{1}))},
+        _normalp_context{std::make_unique<priority_level_context>(
+           task_priority::normal, std::max(init.thread_count, std::size_t{1}))}
    {
-      const auto init_threads = [](priority_level_context& context,
-                                   std::size_t count, int priority,
+      const auto init_threads = [](priority_level_context& context, int priority,
                                    std::wstring_view description_suffix) {
+         const std::size_t count = context.worker_queues.size();
+
          context.threads.reserve(count);
 
          for (std::size_t i = 0; i < count; ++i) {
             auto& thread = context.threads.emplace_back(
-               [&]() { worker_thread_main(context); });
+               [&context, i]() { worker_thread_main(context, i); });
 
             SetThreadPriority(thread.native_handle(), priority);
             SetThreadDescription(
@@ -53,11 +147,8 @@ struct thread_pool::impl {
          }
       };
 
-      init_threads(_lowp_context,
-                   std::max(init.low_priority_thread_count, std::size_t{1}),
-                   THREAD_PRIORITY_BELOW_NORMAL, L" (Low Priority)");
-      init_threads(_normalp_context, std::max(init.thread_count, std::size_t{1}),
-                   THREAD_PRIORITY_NORMAL, L"");
+      init_threads(*_lowp_context, THREAD_PRIORITY_BELOW_NORMAL, L" (Low Priority)");
+      init_threads(*_normalp_context, THREAD_PRIORITY_NORMAL, L"");
    }
 
    ~impl()
@@ -67,33 +158,60 @@ struct thread_pool::impl {
          context.pending_tasks.notify_all();
       };
 
-      stop_threads(_lowp_context);
-      stop_threads(_normalp_context);
-   }
+      stop_threads(*_lowp_context);
+      stop_threads(*_normalp_context);
 
-   impl(const impl&) = delete;
-   impl(impl&&) = delete;
-   auto operator=(const impl&) -> impl& = delete;
-   auto operator=(impl&&) -> impl& = delete;
+      _lowp_context->threads.clear();
+      _normalp_context->threads.clear();
 
-   void cancel_task(detail::task_context_base& task_context) noexcept
-   {
-      const auto cancel_task = [&](priority_level_context& level_context) noexcept {
-         std::scoped_lock lock{level_context.tasks_mutex};
+      // Release the references held by any tasks that never got popped.
+      const auto drain_tasks = [](priority_level_context& context) noexcept -> bool {
+         bool drained_any = false;
 
-         const std::size_t erased =
-            std::erase_if(level_context.tasks,
-                          [&](std::shared_ptr<detail::task_context_base>& queued_context) noexcept {
-                             return &task_context == queued_context.get();
-                          });
+         const auto release = [](detail::task_context_base* task) noexcept {
+            std::shared_ptr<detail::task_context_base> task_reference =
+               std::move(task->queued_reference);
 
-         level_context.pending_tasks.fetch_sub(erased);
+            // Tasks that never ran are canceled so anything depending on them isn't left waiting. Their result
+            // is made ready with a canceled_task_error so waiting on a task that outlived it's thread_pool
+            // throws instead of blocking forever.
+            if (not task->execution_started.exchange(true)) {
+               task->task_exception_ptr = std::make_exception_ptr(
+                  canceled_task_error{"Task was canceled by it's thread_pool being destroyed."});
+               task->executed_latch.count_down();
+
+               task->run_continuations();
+            }
+         };
+
+         while (detail::task_context_base* task = context.injected_tasks.pop()) {
+            release(task);
+
+            drained_any = true;
+         }
+
+         for (auto& queue : context.worker_queues) {
+            while (detail::task_context_base* task = queue->steal()) {
+               release(task);
+
+               drained_any = true;
+            }
+         }
+
+         return drained_any;
       };
 
-      cancel_task(_lowp_context);
-      cancel_task(_normalp_context);
+      // Canceling a coroutine's resumption resumes it inline, which can queue more work on either priority
+      // level. Keep draining until neither has anything left.
+      while (drain_tasks(*_lowp_context) | drain_tasks(*_normalp_context)) {
+      }
    }
 
+   impl(const impl&) = delete;
+   impl(impl&&) = delete;
+   auto operator=(const impl&) -> impl& = delete;
+   auto operator=(impl&&) -> impl& = delete;
+
    [[nodiscard]] auto thread_count(const task_priority priority) const noexcept
       -> std::size_t
    {
@@ -106,13 +224,28 @@ struct thread_pool::impl {
       priority_level_context& priority_context =
          select_priority_level_context(priority);
 
-      {
-         std::scoped_lock lock{priority_context.tasks_mutex};
+      detail::count_submitted_task();
+
+      detail::task_context_base* const task_ptr = task.get();
 
-         priority_context.tasks.emplace_back(std::move(task));
+      task_ptr->queued_reference = std::move(task);
+      task_ptr->direct_executions_counter = &priority_context.direct_executions;
+
+      if (priority_context.timing_enabled.load(std::memory_order_relaxed)) {
+         task_ptr->queued_time = std::chrono::steady_clock::now();
       }
 
+      // Count the task before it's visible to the workers so that pending_tasks
+      // can never drop below the number of queued tasks.
       priority_context.pending_tasks.fetch_add(1);
+
+      // Workers submitting to their own priority level push onto their own
+      // deque, everyone else goes through the injection queue.
+      if (current_worker_context != &priority_context or
+          not priority_context.worker_queues[current_worker_index]->push(task_ptr)) {
+         priority_context.injected_tasks.push(task_ptr);
+      }
+
       priority_context.pending_tasks.notify_one();
    }
 
@@ -121,26 +254,181 @@ struct thread_pool::impl {
       return std::this_thread::get_id() == _creating_thread_id;
    }
 
+   [[nodiscard]] auto stats(const task_priority priority) const noexcept
+      -> thread_pool_stats
+   {
+      const priority_level_context& priority_context =
+         select_priority_level_context(priority);
+
+      thread_pool_stats stats{
+         .thread_count = priority_context.threads.size(),
+         .queued_tasks = static_cast<std::size_t>(
+            std::max(priority_context.pending_tasks.load(std::memory_order_relaxed),
+                     std::ptrdiff_t{0})),
+         .direct_executions =
+            priority_context.direct_executions.load(std::memory_order_relaxed),
+      };
+
+      for (const auto& counters : priority_context.worker_counters) {
+         stats.executed_tasks += counters->executed_tasks.load(std::memory_order_relaxed);
+         stats.skipped_tasks += counters->skipped_tasks.load(std::memory_order_relaxed);
+         stats.stolen_tasks += counters->stolen_tasks.load(std::memory_order_relaxed);
+         stats.timed_tasks += counters->timed_tasks.load(std::memory_order_relaxed);
+         stats.queued_time += std::chrono::nanoseconds{
+            counters->queued_nanoseconds.load(std::memory_order_relaxed)};
+         stats.busy_time += std::chrono::nanoseconds{
+            counters->busy_nanoseconds.load(std::memory_order_relaxed)};
+      }
+
+      std::scoped_lock lock{_instrumentation_mutex};
+
+      stats.timed_duration = _timed_duration;
+
+      if (_timing_enabled or _tracing) {
+         stats.timed_duration += std::chrono::steady_clock::now() - _timing_start;
+      }
+
+      return stats;
+   }
+
+   void set_timing_enabled(const bool enabled) noexcept
+   {
+      std::scoped_lock lock{_instrumentation_mutex};
+
+      const bool was_timing = _timing_enabled or _tracing;
+
+      _timing_enabled = enabled;
+
+      update_timing(was_timing);
+   }
+
+   void begin_trace() noexcept
+   {
+      std::scoped_lock lock{_instrumentation_mutex};
+
+      if (_tracing) return;
+
+      const bool was_timing = _timing_enabled or _tracing;
+
+      _tracing = true;
+
+      update_timing(was_timing);
+
+      // Clear out any events recorded by tasks that were finishing as the last trace ended.
+      for (priority_level_context* priority_context :
+           {_lowp_context.get(), _normalp_context.get()}) {
+         for (auto& counters : priority_context->worker_counters) {
+            std::scoped_lock trace_lock{counters->trace_mutex};
+
+            counters->trace_events.clear();
+         }
+      }
+
+      _lowp_context->trace_enabled.store(true, std::memory_order_relaxed);
+      _normalp_context->trace_enabled.store(true, std::memory_order_relaxed);
+   }
+
+   [[nodiscard]] auto end_trace() noexcept -> std::vector<task_trace_event>
+   {
+      std::scoped_lock lock{_instrumentation_mutex};
+
+      if (not _tracing) return {};
+
+      const bool was_timing = _timing_enabled or _tracing;
+
+      _tracing = false;
+
+      _lowp_context->trace_enabled.store(false, std::memory_order_relaxed);
+      _normalp_context->trace_enabled.store(false, std::memory_order_relaxed);
+
+      update_timing(was_timing);
+
+      std::vector<task_trace_event> events;
+
+      for (priority_level_context* priority_context :
+           {_lowp_context.get(), _normalp_context.get()}) {
+         for (auto& counters : priority_context->worker_counters) {
+            std::scoped_lock trace_lock{counters->trace_mutex};
+
+            events.insert(events.end(), counters->trace_events.begin(),
+                          counters->trace_events.end());
+
+            counters->trace_events = {};
+         }
+      }
+
+      std::ranges::sort(events, {}, &task_trace_event::start_time);
+
+      return events;
+   }
+
 private:
-   static constexpr std::ptrdiff_t pending_tasks_end_value = -1;
+   static constexpr std::ptrdiff_t pending_tasks_end_value =
+      std::numeric_limits<std::ptrdiff_t>::min() / 2;
+
+   static constexpr std::size_t worker_queue_capacity = 1024;
+   static constexpr std::size_t injection_queue_capacity = 4096;
+
+   /// @brief Instrumentation for a worker. Only written to by the worker, so a load and store is enough to update a counter.
+   struct alignas(64) worker_stats {
+      std::atomic_size_t executed_tasks = 0;
+      std::atomic_size_t skipped_tasks = 0;
+      std::atomic_size_t stolen_tasks = 0;
+      std::atomic_size_t timed_tasks = 0;
+      std::atomic_int64_t queued_nanoseconds = 0;
+      std::atomic_int64_t busy_nanoseconds = 0;
+
+      std::mutex trace_mutex;
+      std::vector<task_trace_event> trace_events; // guarded by trace_mutex
+   };
 
    struct priority_level_context {
-      std::vector<std::jthread> threads;
+      priority_level_context(const task_priority priority, const std::size_t worker_count)
+         : priority{priority}, injected_tasks{injection_queue_capacity}
+      {
+         worker_queues.reserve(worker_count);
+         worker_counters.reserve(worker_count);
+
+         for (std::size_t i = 0; i < worker_count; ++i) {
+            worker_queues.emplace_back(
+               std::make_unique<detail::work_stealing_deque<detail::task_context_base>>(
+                  worker_queue_capacity));
+            worker_counters.emplace_back(std::make_unique<worker_stats>());
+         }
+      }
+
+      const task_priority priority;
 
-      std::shared_mutex tasks_mutex;
-      std::vector<std::shared_ptr<detail::task_context_base>> tasks;
+      std::vector<std::unique_ptr<detail::work_stealing_deque<detail::task_context_base>>> worker_queues;
+      detail::injection_queue<detail::task_context_base> injected_tasks;
 
       std::atomic_ptrdiff_t pending_tasks = 0;
+
+      std::vector<std::unique_ptr<worker_stats>> worker_counters;
+
+      /// @brief Written to by any thread that waits on a task, unlike the worker_stats.
+      std::atomic_size_t direct_executions = 0;
+
+      std::atomic_bool timing_enabled = false;
+      std::atomic_bool trace_enabled = false;
+
+      // Last so that the threads are joined before the queues are destroyed.
+      std::vector<std::jthread> threads;
    };
 
+   /// @brief The priority level the current thread is a worker for, nullptr if it is not a worker thread.
+   static thread_local const priority_level_context* current_worker_context;
+   /// @brief The index of the current worker thread's deque in worker_queues.
+   static thread_local std::size_t current_worker_index;
+
    auto select_priority_level_context(const task_priority priority) noexcept
       -> priority_level_context&
    {
       switch (priority) {
       case task_priority::low:
-         return _lowp_context;
+         return *_lowp_context;
       case task_priority::normal:
-         return _normalp_context;
+         return *_normalp_context;
       }
 
       __assume(0);
@@ -151,54 +439,170 @@ private:
    {
       switch (priority) {
       case task_priority::low:
-         return _lowp_context;
+         return *_lowp_context;
       case task_priority::normal:
-         return _normalp_context;
+         return *_normalp_context;
       }
 
       __assume(0);
    }
 
-   static void worker_thread_main(priority_level_context& context) noexcept
+   static auto find_task(priority_level_context& context,
+                         const std::size_t worker_index) noexcept
+      -> detail::task_context_base*
    {
+      // Our own work first, newest first for cache locality.
+      if (auto* task = context.worker_queues[worker_index]->pop(); task) {
+         return task;
+      }
+
+      if (auto* task = context.injected_tasks.pop(); task) return task;
+
+      // Nothing local, try stealing the oldest work from the other workers.
+      const std::size_t worker_count = context.worker_queues.size();
+
+      for (std::size_t i = 1; i < worker_count; ++i) {
+         const std::size_t victim_index = (worker_index + i) % worker_count;
+
+         if (auto* task = context.worker_queues[victim_index]->steal(); task) {
+            increment(context.worker_counters[worker_index]->stolen_tasks);
+
+            return task;
+         }
+      }
+
+      return nullptr;
+   }
+
+   static void worker_thread_main(priority_level_context& context,
+                                  const std::size_t worker_index) noexcept
+   {
+      current_worker_context = &context;
+      current_worker_index = worker_index;
+
+      worker_stats& counters = *context.worker_counters[worker_index];
+
       while (true) {
          context.pending_tasks.wait(0);
 
-         // <= is used here in case another thread is executing a task
-         // and drops pending_tasks below pending_tasks_end_value
+         // <= is used here in case a task is submitted or popped after the pool
+         // started shutting down.
          if (context.pending_tasks.load() <= pending_tasks_end_value) break;
 
-         std::shared_ptr<detail::task_context_base> task;
+         detail::task_context_base* task = find_task(context, worker_index);
 
-         // Try to grab a task off the queue.
-         {
-            std::scoped_lock lock{context.tasks_mutex};
+         // No task for us? Another worker beat us to it or it is still being
+         // pushed. Skip back to the start of the loop.
+         if (not task) {
+            std::this_thread::yield();
 
-            // No task for us? Skip back to the start of the loop.
-            if (context.tasks.empty()) continue;
-
-            // Yay! A task, grab it and then erase it from the queue.
-            task = std::move(context.tasks.front());
-            context.tasks.erase(context.tasks.begin());
+            continue;
          }
 
          // We got a task! Decrement pending_tasks.
          context.pending_tasks.fetch_sub(1);
 
+         // Take over the queue's reference to the task, keeping it alive until we're done with it.
+         std::shared_ptr<detail::task_context_base> task_reference =
+            std::move(task->queued_reference);
+
          // Mark the task as beginning execution, if the task owning has already asked for the result and
-         // directly executed the task themselves we skip calling execute_function.
-         if (task->execution_started.exchange(true)) continue;
+         // directly executed the task themselves (or canceled it) we skip calling execute_function.
+         if (task->execution_started.exchange(true)) {
+            increment(counters.skipped_tasks);
+
+            continue;
+         }
+
+         increment(counters.executed_tasks);
+
+         if (not context.timing_enabled.load(std::memory_order_relaxed)) {
+            task->execute_function();
+
+            task->run_continuations();
+
+            continue;
+         }
+
+         const std::chrono::steady_clock::time_point start_time =
+            std::chrono::steady_clock::now();
 
          task->execute_function();
+
+         task->run_continuations();
+
+         const std::chrono::steady_clock::time_point end_time =
+            std::chrono::steady_clock::now();
+
+         increment(counters.timed_tasks);
+         add(counters.busy_nanoseconds, end_time - start_time);
+
+         if (task->queued_time != std::chrono::steady_clock::time_point{}) {
+            add(counters.queued_nanoseconds, start_time - task->queued_time);
+         }
+
+         if (context.trace_enabled.load(std::memory_order_relaxed)) {
+            std::scoped_lock lock{counters.trace_mutex};
+
+            counters.trace_events.push_back({.priority = context.priority,
+                                             .worker_index = worker_index,
+                                             .queued_time = task->queued_time,
+                                             .start_time = start_time,
+                                             .end_time = end_time});
+         }
       }
    }
 
-   priority_level_context _lowp_context;
-   priority_level_context _normalp_context;
+   /// @brief Only the owning worker writes to it's counters so a load and store is enough.
+   static void increment(std::atomic_size_t& counter) noexcept
+   {
+      counter.store(counter.load(std::memory_order_relaxed) + 1,
+                    std::memory_order_relaxed);
+   }
+
+   static void add(std::atomic_int64_t& counter,
+                   const std::chrono::steady_clock::duration duration) noexcept
+   {
+      counter.store(counter.load(std::memory_order_relaxed) +
+                       std::chrono::duration_cast<std::chrono::nanoseconds>(duration)
+                          .count(),
+                    std::memory_order_relaxed);
+   }
+
+   /// @brief Apply a change to _timing_enabled or _tracing. _instrumentation_mutex must be held.
+   void update_timing(const bool was_timing) noexcept
+   {
+      const bool timing = _timing_enabled or _tracing;
+
+      if (timing == was_timing) return;
+
+      if (timing) {
+         _timing_start = std::chrono::steady_clock::now();
+      }
+      else {
+         _timed_duration += std::chrono::steady_clock::now() - _timing_start;
+      }
+
+      _lowp_context->timing_enabled.store(timing, std::memory_order_relaxed);
+      _normalp_context->timing_enabled.store(timing, std::memory_order_relaxed);
+   }
+
+   std::unique_ptr<priority_level_context> _lowp_context;
+   std::unique_ptr<priority_level_context> _normalp_context;
 
    const std::thread::id _creating_thread_id = std::this_thread::get_id();
+
+   mutable std::mutex _instrumentation_mutex;
+   bool _timing_enabled = false;                       // guarded by _instrumentation_mutex
+   bool _tracing = false;                              // guarded by _instrumentation_mutex
+   std::chrono::steady_clock::time_point _timing_start; // guarded by _instrumentation_mutex
+   std::chrono::nanoseconds _timed_duration{};         // guarded by _instrumentation_mutex
 };
 
+thread_local const thread_pool::impl::priority_level_context* thread_pool::impl::current_worker_context =
+   nullptr;
+thread_local std::size_t thread_pool::impl::current_worker_index = 0;
+
 auto thread_pool::make() noexcept -> std::shared_ptr<thread_pool>
 {
    return make(thread_pool_init{.thread_count = std::thread::hardware_concurrency() - 1,
@@ -216,14 +620,52 @@ thread_pool::thread_pool(const thread_pool_init& init) : impl{init} {}
 
 thread_pool::~thread_pool() = default;
 
-void thread_pool::cancel_task(detail::task_context_base& task_context) noexcept
+auto thread_pool::thread_count(const task_priority priority) const noexcept -> std::size_t
 {
-   return impl->cancel_task(task_context);
+   return impl->thread_count(priority);
 }
 
-auto thread_pool::thread_count(const task_priority priority) const noexcept -> std::size_t
+auto thread_pool::stats(const task_priority priority) const noexcept
+   -> thread_pool_stats
 {
-   return impl->thread_count(priority);
+   return impl->stats(priority);
+}
+
+void thread_pool::set_timing_enabled(const bool enabled) noexcept
+{
+   return impl->set_timing_enabled(enabled);
+}
+
+void thread_pool::begin_trace() noexcept
+{
+   return impl->begin_trace();
+}
+
+auto thread_pool::end_trace() noexcept -> std::vector<task_trace_event>
+{
+   return impl->end_trace();
+}
+
+void thread_pool::resume(const task_priority priority,
+                         std::coroutine_handle<> coroutine) noexcept
+{
+   auto task_context = std::allocate_shared<detail::task_context_base>(
+      detail::recycling_allocator<detail::task_context_base>{});
+
+   task_context->execute_function = [task = task_context.get(), coroutine] {
+      task->executed_latch.count_down();
+
+      coroutine.resume();
+   };
+
+   // A resumption still queued when the thread_pool is destroyed is canceled instead of executed, leaving a
+   // canceled_task_error in it's context. Resume the coroutine inline then so it runs to completion and it's
+   // frame is freed rather than leaked. execute_function never stores an exception.
+   task_context->add_continuation([task = task_context.get(), coroutine] {
+      if (task->task_exception_ptr != nullptr) coroutine.resume();
+   });
+
+   submit_task(priority, std::move(task_context));
 }
 
 void thread_pool::submit_task(const task_priority priority,
@@ -1,26 +1,64 @@
 #pragma once
 
+#include "detail/recycling_allocator.hpp"
+#include "detail/task_function.hpp"
 #include "utility/implementation_storage.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <concepts>
+#include <coroutine>
 #include <exception>
 #include <functional>
 #include <latch>
 #include <memory>
+#include <span>
+#include <stdexcept>
+#include <stop_token>
 #include <vector>
 
 namespace we::async {
 
 class thread_pool;
 
+/// @brief Exception used when a task that was being waited on by a continuation or coroutine was canceled before it ran.
+struct canceled_task_error : std::runtime_error {
+   using std::runtime_error::runtime_error;
+};
+
 namespace detail {
 
+template<typename T>
+struct task_promise;
+
+/// @brief A function to run once a task has completed, see task_context_base::add_continuation.
+struct continuation {
+   task_function function;
+   continuation* next = nullptr;
+};
+
+/// @brief Lock-free list of continuations, newest first. Set to a sentinel once the continuations have been called.
+/// Continuations that never get called are freed with the list.
+struct continuation_list {
+   continuation_list() = default;
+
+   ~continuation_list();
+
+   continuation_list(const continuation_list&) = delete;
+   continuation_list(continuation_list&&) = delete;
+   auto operator=(const continuation_list&) -> continuation_list& = delete;
+   auto operator=(continuation_list&&) -> continuation_list& = delete;
+
+   std::atomic<continuation*> head = nullptr;
+};
+
 struct task_context_base {
    /// @brief Flag for if the task has started being executed or not.
    std::atomic_bool execution_started = false;
 
    /// @brief Contains the function that executes the task.
-   std::move_only_function<void()> execute_function;
+   task_function execute_function;
 
    /// @brief Latch that will be counted down upon completion of the task. Once at 0 task_exception_ptr and result can be safely used.
    std::latch executed_latch{1};
@@ -28,13 +66,45 @@ struct task_context_base {
    /// @brief execute_function will catch and store any exception from the task into this.
    std::exception_ptr task_exception_ptr = nullptr;
 
-   /// @brief The thread_pool that owns the task.
-   std::weak_ptr<thread_pool> owning_thread_pool;
+   /// @brief Reference to the task held by the thread_pool while it is queued. Released by the worker that pops the task.
+   std::shared_ptr<task_context_base> queued_reference;
+
+   /// @brief Direct execution counter of the thread_pool priority level the task was submitted to. Set when the task is submitted.
+   std::atomic_size_t* direct_executions_counter = nullptr;
+
+   /// @brief Stop source for tasks whose function takes a std::stop_token. Stop is requested when the task is canceled.
+   std::stop_source stop_source{std::nostopstate};
+
+   /// @brief Time the task was submitted to the thread_pool at. Only recorded while the thread_pool's timing is enabled.
+   std::chrono::steady_clock::time_point queued_time;
 
-   /// @brief Use owning_thread_pool to cancel the task.
+   /// @brief Number of dependencies that must still complete before the task can be executed. Tasks with pending
+   /// dependencies are never executed directly.
+   std::atomic_ptrdiff_t pending_dependencies = 0;
+
+   /// @brief Dependencies to directly execute when waiting on the task, so waiting on a continuation helps with the
+   /// work it is waiting on instead of blocking behind it.
+   std::span<const std::shared_ptr<task_context_base>> wait_dependencies;
+
+   /// @brief Continuations to call once the task completes.
+   continuation_list continuations;
+
+   /// @brief Add a function to be called once the task has completed or been canceled. If that has already happened
+   /// the function is called immediately. Continuations are called on the thread that completes the task so they should be cheap.
+   /// @param function The function to call.
+   void add_continuation(task_function function) noexcept;
+
+   /// @brief Call the task's continuations, marking the task as completed. Called once by whoever executes or cancels the task.
+   void run_continuations() noexcept;
+
+   /// @brief Check if the task has completed or been canceled and it's continuations have been called.
+   [[nodiscard]] bool completed() const noexcept;
+
+   /// @brief Cancel the task. A task that has not started executing will be discarded by the thread_pool when it is popped.
+   /// A task that is executing has stop requested through it's stop_source.
    void cancel() noexcept;
 
-   /// @brief Use owning_thread_pool to cancel the task without waiting for it to complete if it's execution has started.
+   /// @brief Cancel the task without waiting for it to complete if it's execution has started.
    void cancel_no_wait() noexcept;
 
    /// @brief Check if the task's result is ready.
@@ -44,12 +114,12 @@ struct task_context_base {
       return executed_latch.try_wait();
    }
 
-   /// @brief Wait for a task to be ready, executing it directly if needed.
+   /// @brief Wait for a task to be ready, executing it (and any dependencies it has) directly if needed.
    void wait() noexcept
    {
       if (ready()) return;
 
-      if (try_direct_execute()) return;
+      if (try_direct_execute_with_dependencies()) return;
 
       executed_latch.wait();
    }
@@ -64,13 +134,32 @@ struct task_context_base {
    /// @return True if the task was executed directly, false if it is being executed by the thread_pool.
    bool try_direct_execute() noexcept
    {
+      if (pending_dependencies.load() > 0) return false;
+
       if (execution_started.exchange(true)) return false;
 
+      if (direct_executions_counter) {
+         direct_executions_counter->fetch_add(1, std::memory_order_relaxed);
+      }
+
+      // The thread_pool will discard the task when it is popped from the queue, no need to remove it here.
       execute_function();
-      cancel();
+
+      run_continuations();
 
       return true;
    }
+
+   /// @brief Directly executes any of the task's dependencies that have not started yet and then tries to execute the task.
+   /// @return True if the task was executed directly, false otherwise.
+   bool try_direct_execute_with_dependencies() noexcept
+   {
+      for (const auto& dependency : wait_dependencies) {
+         dependency->try_direct_execute_with_dependencies();
+      }
+
+      return try_direct_execute();
+   }
 };
 
 template<typename T>
@@ -87,6 +176,92 @@ struct task_context<void> : task_context_base {
    bool result_obtained = false;
 };
 
+/// @brief Context for a task that is only executed once it's dependencies have completed.
+template<typename T>
+struct dependent_task_context : task_context<T> {
+   /// @brief The tasks this task depends on. Kept alive until this task is destroyed.
+   std::vector<std::shared_ptr<task_context_base>,
+               recycling_allocator<std::shared_ptr<task_context_base>>>
+      dependencies;
+};
+
+/// @brief Make a task context that calls func when executed, storing it's result or the exception it throws.
+/// @tparam T The return type of func.
+/// @tparam Context The type of the context.
+/// @param func The task's function.
+/// @return The context.
+template<typename T, typename Context = task_context<T>, typename Fn>
+auto make_task_context(Fn func) -> std::shared_ptr<Context>
+{
+   // The context and the shared_ptr control block share one recycled block.
+   auto task_context = std::allocate_shared<Context>(recycling_allocator<Context>{});
+
+   task_context->execute_function = [task_context = task_context.get(),
+                                     func = std::move(func)]() noexcept {
+      try {
+         if constexpr (std::is_void_v<T>) {
+            func();
+         }
+         else {
+            task_context->result = func();
+         }
+      }
+      catch (...) {
+         task_context->task_exception_ptr = std::current_exception();
+      }
+
+      task_context->executed_latch.count_down();
+   };
+
+   return task_context;
+}
+
+/// @brief Link a task to the dependencies stored in it's context. Once required_count of them have completed
+/// (or been canceled) on_ready is called with the task, by the thread that completed the final one.
+/// @param task The task. It's dependencies must already be filled in.
+/// @param required_count The number of dependencies that must complete, clamped to the number of dependencies.
+/// @param on_ready Called with the task once it is ready to execute.
+template<typename T, typename OnReady>
+void link_dependencies(const std::shared_ptr<dependent_task_context<T>>& task,
+                       const std::size_t required_count, const OnReady& on_ready) noexcept
+{
+   const std::size_t dependency_count = task->dependencies.size();
+   const std::size_t clamped_required_count = std::min(required_count, dependency_count);
+
+   // Only help with the dependencies when every one of them is needed, otherwise
+   // we could end up executing one long after another had already completed.
+   if (clamped_required_count == dependency_count) {
+      task->wait_dependencies = task->dependencies;
+   }
+
+   task->pending_dependencies.store(static_cast<std::ptrdiff_t>(clamped_required_count));
+
+   if (clamped_required_count == 0) {
+      return on_ready(std::shared_ptr<task_context_base>{task});
+   }
+
+   for (const auto& dependency : task->dependencies) {
+      // The continuation only holds a weak reference so an abandoned task isn't kept alive by it's dependencies.
+      dependency->add_continuation(
+         [weak_task = std::weak_ptr<task_context_base>{task}, on_ready]() noexcept {
+            std::shared_ptr<task_context_base> task = weak_task.lock();
+
+            if (not task) return;
+            if (task->pending_dependencies.fetch_sub(1) != 1) return;
+
+            on_ready(std::move(task));
+         });
+   }
+}
+
+/// @brief on_ready for link_dependencies that executes the task on the thread that completed it's final dependency.
+struct execute_inline {
+   void operator()(std::shared_ptr<task_context_base> task) const noexcept
+   {
+      task->try_direct_execute();
+   }
+};
+
 }
 
 /// @brief A simple async task class.
@@ -105,6 +280,9 @@ public:
    /// @brief The type of the result of the task. Can be void.
    using result_type = T;
 
+   /// @brief Allows functions returning a task to be coroutines, see coroutine.hpp.
+   using promise_type = detail::task_promise<T>;
+
    /// @brief Construct an empty task. Calling any method but valid() on an empty task results in std::terminate being called.
    task() noexcept = default;
 
@@ -137,7 +315,8 @@ public:
       return _context->executed_latch.try_wait();
    }
 
-   /// @brief Cancels a task, removing it from the owning thread_pool's queue.
+   /// @brief Cancels a task, stopping the owning thread_pool from executing it if it has not started yet. If it has started
+   /// and was created with a function taking a std::stop_token then stop is requested and it is waited on.
    /// After this calls to methods other than valid on this task object will result in std::terminate being called.
    void cancel() noexcept
    {
@@ -147,7 +326,7 @@ public:
       _context = nullptr;
    }
 
-   /// @brief Cancels a task, removing it from the owning thread_pool's queue. If the task had started execution this method will not
+   /// @brief Cancels a task, stopping the owning thread_pool from executing it if it has not started yet. If the task had started execution this method will not
    /// wait for it to complete before returning.
    ///
    /// This makes this method unsafe if the task was referencing objects that will be destroyed after the cancel call.
@@ -161,6 +340,15 @@ public:
       _context = nullptr;
    }
 
+   /// @brief Requests that a task created with a function taking a std::stop_token stops early. Unlike cancel the task
+   /// stays valid and can still be waited on. Does nothing for other tasks.
+   void request_stop() noexcept
+   {
+      if (!_context) std::terminate();
+
+      _context->stop_source.request_stop();
+   }
+
    /// @brief Gets the result of the task, waiting or executing the task directly if needed. Throws any exception thrown by the task. Calling this twice results in std::terminate being called.
    /// @return The result of the task.
    [[nodiscard]] auto get() -> T
@@ -217,6 +405,26 @@ public:
       return _context != nullptr;
    }
 
+   /// @brief Gets the task's context. Intended to be used by when_all and when_any.
+   /// @return The task's context.
+   [[nodiscard]] auto context() const noexcept
+      -> const std::shared_ptr<detail::task_context<T>>&
+   {
+      if (!_context) std::terminate();
+
+      return _context;
+   }
+
+   /// @brief Releases the task's context without canceling the task. Intended to be used by then to take over a task.
+   /// After this calls to methods other than valid on this task object will result in std::terminate being called.
+   /// @return The task's context.
+   [[nodiscard]] auto release_context() noexcept -> std::shared_ptr<detail::task_context<T>>
+   {
+      if (!_context) std::terminate();
+
+      return std::move(_context);
+   }
+
 private:
    std::shared_ptr<detail::task_context<T>> _context;
 };
@@ -224,6 +432,22 @@ private:
 /// @brief Priority for tasks scheduled on a thread_pool.
 enum class task_priority { low, normal };
 
+/// @brief How thread_pool::for_each_n splits a range between it's tasks.
+enum class for_each_schedule {
+   /// @brief Tasks repeatedly take chunks from a shared cursor, with the chunks shrinking as the range runs out. Keeps every thread busy when the cost of each index varies.
+   guided,
+   /// @brief The range is split up front into one equal slice per task. Lowest overhead when every index costs about the same.
+   static_split
+};
+
+/// @brief Options for thread_pool::for_each_n.
+struct for_each_options {
+   /// @brief How the range is split between tasks.
+   for_each_schedule schedule = for_each_schedule::guided;
+   /// @brief Smallest number of indices a task will take from the range at once for for_each_schedule::guided. Raise this when the cost per index is tiny.
+   std::size_t grain_size = 1;
+};
+
 /// @brief Initialization parameters for the thread_pool.
 struct thread_pool_init {
    /// @brief Number of threads to create for the thread_pool. Must be >= 1.
@@ -232,9 +456,65 @@ struct thread_pool_init {
    const std::size_t low_priority_thread_count;
 };
 
+/// @brief Counters for submitted tasks and the allocations made while submitting them. Summed over every thread and thread_pool in the process.
+struct task_allocation_stats {
+   /// @brief Number of tasks submitted to a thread_pool. Each for_each_n task counts as one.
+   std::size_t submitted_tasks = 0;
+   /// @brief Number of task allocations served from a thread's recycled blocks.
+   std::size_t recycled_allocations = 0;
+   /// @brief Number of task allocations that had to go to the heap.
+   std::size_t heap_allocations = 0;
+};
+
+/// @brief Get the current task allocation counters.
+[[nodiscard]] auto get_task_allocation_stats() noexcept -> task_allocation_stats;
+
+/// @brief Counters for one priority level of a thread_pool. Counts are always kept, times are only
+/// recorded while timing is enabled (see thread_pool::set_timing_enabled).
+struct thread_pool_stats {
+   /// @brief Number of worker threads for the priority level.
+   std::size_t thread_count = 0;
+   /// @brief Number of tasks currently queued.
+   std::size_t queued_tasks = 0;
+   /// @brief Number of tasks executed by the workers.
+   std::size_t executed_tasks = 0;
+   /// @brief Number of tasks popped by a worker after they had already been executed directly or canceled.
+   std::size_t skipped_tasks = 0;
+   /// @brief Number of tasks executed directly by a thread waiting on them instead of by a worker.
+   std::size_t direct_executions = 0;
+   /// @brief Number of tasks a worker took from another worker's queue.
+   std::size_t stolen_tasks = 0;
+   /// @brief Number of tasks executed while timing was enabled.
+   std::size_t timed_tasks = 0;
+   /// @brief Total time timed tasks spent queued before a worker started them.
+   std::chrono::nanoseconds queued_time{};
+   /// @brief Total time workers spent executing timed tasks.
+   std::chrono::nanoseconds busy_time{};
+   /// @brief Total time timing has been enabled for. busy_time / (timed_duration * thread_count) is how busy the workers were.
+   std::chrono::nanoseconds timed_duration{};
+};
+
+/// @brief A task executed by a thread_pool worker while a trace was being recorded.
+struct task_trace_event {
+   /// @brief Priority level of the worker that executed the task.
+   task_priority priority = task_priority::normal;
+   /// @brief Index of the worker in it's priority level.
+   std::size_t worker_index = 0;
+   /// @brief Time the task was submitted at. Can be a default time_point if the task was submitted before the trace started.
+   std::chrono::steady_clock::time_point queued_time;
+   /// @brief Time the worker started executing the task at.
+   std::chrono::steady_clock::time_point start_time;
+   /// @brief Time the worker finished executing the task (and it's continuations) at.
+   std::chrono::steady_clock::time_point end_time;
+};
+
 /// @brief thread_pool implementation focusing on simplicity, support for priorities and predictability.
 /// This is not intended to have the most features or the best raw throughput, rather it is focused on
 /// being "good enough" for WorldEdit's specific use case.
+///
+/// Each worker has it's own work stealing deque that tasks submitted from that worker are pushed onto,
+/// tasks submitted from other threads go through a lock-free injection queue. Idle workers steal from
+/// each other so no single lock is contended by every submit and pop.
 class thread_pool : public std::enable_shared_from_this<thread_pool> {
 public:
    /// @brief Initialize the thread_pool with a default number of threads.
@@ -261,25 +541,7 @@ public:
    [[nodiscard]] auto exec(const task_priority priority, Fn func) noexcept
       -> task<T>
    {
-      auto task_context = std::make_shared<detail::task_context<T>>();
-
-      task_context->execute_function = [task_context = task_context.get(),
-                                        func = std::move(func)]() noexcept {
-         try {
-            if constexpr (std::is_void_v<T>) {
-               func();
-            }
-            else {
-               task_context->result = func();
-            }
-         }
-         catch (...) {
-            task_context->task_exception_ptr = std::current_exception();
-         }
-
-         task_context->executed_latch.count_down();
-      };
-      task_context->owning_thread_pool = shared_from_this();
+      auto task_context = detail::make_task_context<T>(std::move(func));
 
       submit_task(priority, task_context);
 
@@ -297,6 +559,87 @@ public:
       return exec(task_priority::normal, std::forward<Fn>(func));
    }
 
+   /// @brief Adds a cancellable task to the thread_pool's work queue. The function is passed a std::stop_token that has stop
+   /// requested when the task is canceled (or abandoned) or task::request_stop is called. Long running functions should
+   /// check it regularly and return early once stop has been requested.
+   /// @tparam Fn The function to invoke for the task.
+   /// @tparam T The return type of the task.
+   /// @param priority The priority of the task.
+   /// @param func The task's function.
+   /// @return The task.
+   template<std::invocable<std::stop_token> Fn,
+            typename T = std::invoke_result_t<Fn, std::stop_token>>
+   [[nodiscard]] auto exec(const task_priority priority, Fn func) noexcept -> task<T>
+      requires(not std::invocable<Fn>)
+   {
+      std::stop_source stop_source;
+
+      auto task_context = detail::make_task_context<T>(
+         [stop_token = stop_source.get_token(), func = std::move(func)]() -> T {
+            return func(stop_token);
+         });
+
+      task_context->stop_source = std::move(stop_source);
+
+      submit_task(priority, task_context);
+
+      return {task_context};
+   }
+
+   /// @brief Adds a cancellable task to the thread_pool's work queue with task_priority::normal.
+   /// @tparam Fn The function to invoke for the task.
+   /// @tparam T The return type of the task.
+   /// @param func The task's function.
+   /// @return The task.
+   template<std::invocable<std::stop_token> Fn,
+            typename T = std::invoke_result_t<Fn, std::stop_token>>
+   [[nodiscard]] auto exec(Fn&& func) noexcept -> task<T>
+      requires(not std::invocable<Fn>)
+   {
+      return exec(task_priority::normal, std::forward<Fn>(func));
+   }
+
+   /// @brief Adds a task to the thread_pool's work queue once some of it's dependencies have completed (or been canceled).
+   /// No thread blocks while the dependencies are pending, the task is queued by whichever thread completes the final one.
+   /// This is the building block for then, see then.hpp.
+   /// @tparam Fn The function to invoke for the task.
+   /// @tparam T The return type of the task.
+   /// @param priority The priority of the task.
+   /// @param dependencies The tasks this task depends on.
+   /// @param required_count The number of dependencies that must complete before the task is queued.
+   /// @param func The task's function.
+   /// @return The task.
+   template<std::invocable Fn, typename T = std::invoke_result_t<Fn>>
+   [[nodiscard]] auto exec_after(
+      const task_priority priority,
+      std::span<const std::shared_ptr<detail::task_context_base>> dependencies,
+      const std::size_t required_count, Fn func) noexcept -> task<T>
+   {
+      auto task_context =
+         detail::make_task_context<T, detail::dependent_task_context<T>>(std::move(func));
+
+      task_context->dependencies.assign(dependencies.begin(), dependencies.end());
+
+      detail::link_dependencies(
+         task_context, required_count,
+         [weak_pool = weak_from_this(),
+          priority](std::shared_ptr<detail::task_context_base> task) noexcept {
+            if (std::shared_ptr<thread_pool> pool = weak_pool.lock(); pool) {
+               pool->submit_task(priority, std::move(task));
+            }
+            else {
+               task->try_direct_execute();
+            }
+         });
+
+      return {task_context};
+   }
+
+   /// @brief Resumes a suspended coroutine on one of the thread_pool's workers.
+   /// @param priority The priority to resume the coroutine at.
+   /// @param coroutine The coroutine.
+   void resume(const task_priority priority, std::coroutine_handle<> coroutine) noexcept;
+
    /// @brief Executes a function over a range of indices.
    /// @tparam Fn The function to invoke for each index. Must be nothrow invocable.
    /// @param priority The return type of the task.
@@ -306,6 +649,158 @@ public:
    void for_each_n(const task_priority priority, const std::size_t size,
                    const Fn& func) noexcept
       requires(std::is_nothrow_invocable_v<Fn, std::size_t>)
+   {
+      for_each_n(priority, size, for_each_options{}, func);
+   }
+
+   /// @brief Executes a function over a range of indices.
+   /// @tparam Fn The function to invoke for each index. Must be nothrow invocable.
+   /// @param priority The return type of the task.
+   /// @param size The size of the range, exclusive. Used as if for (std::size_t i = 0; i < size; ++i) { ... }.
+   /// @param options The options controlling how the range is split between tasks.
+   /// @param func The function processes the index.
+   template<std::invocable<std::size_t> Fn>
+   void for_each_n(const task_priority priority, const std::size_t size,
+                   const for_each_options& options, const Fn& func) noexcept
+      requires(std::is_nothrow_invocable_v<Fn, std::size_t>)
+   {
+      switch (options.schedule) {
+      case for_each_schedule::guided:
+         return for_each_n_guided(priority, size,
+                                  std::max(options.grain_size, std::size_t{1}), func);
+      case for_each_schedule::static_split:
+         return for_each_n_static(priority, size, func);
+      }
+   }
+
+   /// @brief Executes a function over a range of indices, stopping early once stop is requested on a std::stop_token.
+   /// Indices that have not been processed when stop is requested are skipped.
+   /// @tparam Fn The function to invoke for each index. Must be nothrow invocable.
+   /// @param priority The return type of the task.
+   /// @param size The size of the range, exclusive. Used as if for (std::size_t i = 0; i < size; ++i) { ... }.
+   /// @param stop_token The stop token to check before each index.
+   /// @param func The function processes the index.
+   template<std::invocable<std::size_t> Fn>
+   void for_each_n(const task_priority priority, const std::size_t size,
+                   const std::stop_token& stop_token, const Fn& func) noexcept
+      requires(std::is_nothrow_invocable_v<Fn, std::size_t>)
+   {
+      for_each_n(priority, size, for_each_options{}, stop_token, func);
+   }
+
+   /// @brief Executes a function over a range of indices, stopping early once stop is requested on a std::stop_token.
+   /// Indices that have not been processed when stop is requested are skipped.
+   /// @tparam Fn The function to invoke for each index. Must be nothrow invocable.
+   /// @param priority The return type of the task.
+   /// @param size The size of the range, exclusive. Used as if for (std::size_t i = 0; i < size; ++i) { ... }.
+   /// @param options The options controlling how the range is split between tasks.
+   /// @param stop_token The stop token to check before each index.
+   /// @param func The function processes the index.
+   template<std::invocable<std::size_t> Fn>
+   void for_each_n(const task_priority priority, const std::size_t size,
+                   const for_each_options& options, const std::stop_token& stop_token,
+                   const Fn& func) noexcept
+      requires(std::is_nothrow_invocable_v<Fn, std::size_t>)
+   {
+      if (stop_token.stop_requested()) return;
+
+      for_each_n(priority, size, options, [&](const std::size_t i) noexcept {
+         if (stop_token.stop_requested()) return;
+
+         func(i);
+      });
+   }
+
+   /// @brief Get the counters for a priority level.
+   /// @param priority The priority level.
+   /// @return The counters.
+   [[nodiscard]] auto stats(const task_priority priority) const noexcept
+      -> thread_pool_stats;
+
+   /// @brief Enable or disable timing tasks. While enabled submitting a task reads the clock once and executing it twice.
+   /// @param enabled If timing should be enabled.
+   void set_timing_enabled(const bool enabled) noexcept;
+
+   /// @brief Start recording a trace of the tasks executed by the workers. Timing is enabled while the trace is being
+   /// recorded. The trace is kept in memory until end_trace is called so this is intended for short captures.
+   void begin_trace() noexcept;
+
+   /// @brief Stop recording a trace.
+   /// @return The tasks executed since begin_trace was called, sorted by start time.
+   [[nodiscard]] auto end_trace() noexcept -> std::vector<task_trace_event>;
+
+   /// @brief Gets the thread count for a priority level.
+   /// @param priority The priority level to get the thread count for.
+   /// @return The thread count.
+   [[nodiscard]] auto thread_count(const task_priority priority) const noexcept
+      -> std::size_t;
+
+private:
+   thread_pool(const thread_pool_init& init);
+
+   static auto make_task_context_array(const std::size_t count)
+      -> std::shared_ptr<detail::task_context_base[]>
+   {
+      return std::allocate_shared<detail::task_context_base[]>(
+         detail::recycling_allocator<detail::task_context_base>{}, count);
+   }
+
+   template<typename Fn>
+   void for_each_n_guided(const task_priority priority, const std::size_t size,
+                          const std::size_t grain_size, const Fn& func) noexcept
+   {
+      if (size == 0) return;
+
+      // If we're being called from the "main" thread add an extra task for it to process.
+      const std::size_t desired_task_count =
+         std::max(is_main_thread() ? thread_count(priority) + 1 : thread_count(priority),
+                  std::size_t{1});
+      const std::size_t task_count =
+         std::min(desired_task_count, (size + grain_size - 1) / grain_size);
+
+      std::atomic_size_t cursor = 0;
+
+      auto tasks = make_task_context_array(task_count);
+
+      for (std::size_t i = 0; i < task_count; ++i) {
+         auto& task = tasks[i];
+
+         task.execute_function = [&task, &func, &cursor, size, grain_size,
+                                  task_count]() noexcept {
+            while (true) {
+               // Take half of the remaining range divided evenly between the tasks,
+               // this starts with big chunks and shrinks as the range runs out.
+               const std::size_t remaining =
+                  size - std::min(cursor.load(std::memory_order_relaxed), size);
+               const std::size_t chunk_size =
+                  std::max(remaining / (task_count * 2), grain_size);
+
+               const std::size_t start =
+                  cursor.fetch_add(chunk_size, std::memory_order_relaxed);
+
+               if (start >= size) break;
+
+               const std::size_t end = std::min(start + chunk_size, size);
+
+               for (std::size_t i = start; i < end; ++i) {
+                  func(i);
+               }
+            }
+
+            task.executed_latch.count_down();
+         };
+
+         submit_task(priority, std::shared_ptr<detail::task_context_base>{tasks, &task});
+      }
+
+      for (std::ptrdiff_t i = static_cast<std::ptrdiff_t>(task_count) - 1; i >= 0; --i) {
+         tasks[i].wait();
+      }
+   }
+
+   template<typename Fn>
+   void for_each_n_static(const task_priority priority, const std::size_t size,
+                          const Fn& func) noexcept
    {
       // If we're being called from the "main" thread add an extra task for it to process.
       const std::size_t desired_task_count =
@@ -313,7 +808,7 @@ public:
                   std::size_t{1});
 
       if (size <= desired_task_count) {
-         auto tasks = std::make_shared<detail::task_context_base[]>(size);
+         auto tasks = make_task_context_array(size);
 
          // Schedule the tasks!
          for (std::size_t i = 0; i < size; ++i) {
@@ -324,7 +819,6 @@ public:
 
                task.executed_latch.count_down();
             };
-            task.owning_thread_pool = shared_from_this();
 
             submit_task(priority,
                         std::shared_ptr<detail::task_context_base>{tasks, &task});
@@ -342,7 +836,7 @@ public:
                                                  ? desired_task_count + 1
                                                  : desired_task_count;
 
-         auto tasks = std::make_shared<detail::task_context_base[]>(final_task_count);
+         auto tasks = make_task_context_array(final_task_count);
 
          for (std::size_t i = 0; i < desired_task_count; ++i) {
             auto& task = tasks[i];
@@ -355,7 +849,6 @@ public:
 
                task.executed_latch.count_down();
             };
-            task.owning_thread_pool = shared_from_this();
 
             submit_task(priority,
                         std::shared_ptr<detail::task_context_base>{tasks, &task});
@@ -373,7 +866,6 @@ public:
 
                task.executed_latch.count_down();
             };
-            task.owning_thread_pool = shared_from_this();
 
             submit_task(priority,
                         std::shared_ptr<detail::task_context_base>{tasks, &task});
@@ -386,19 +878,6 @@ public:
       }
    }
 
-   /// @brief Cancel a task. Directly calling is not needed (it is called from inside task).
-   /// @param task_context The context of the task to cancel.
-   void cancel_task(detail::task_context_base& task_context) noexcept;
-
-   /// @brief Gets the thread count for a priority level.
-   /// @param priority The priority level to get the thread count for.
-   /// @return The thread count.
-   [[nodiscard]] auto thread_count(const task_priority priority) const noexcept
-      -> std::size_t;
-
-private:
-   thread_pool(const thread_pool_init& init);
-
    void submit_task(const task_priority priority,
                     std::shared_ptr<detail::task_context_base> task) noexcept;
 
@@ -1,33 +1,34 @@
 #pragma once
 
 #include "thread_pool.hpp"
+#include "when_all.hpp"
 
 #include <ranges>
 
 namespace we::async {
 
-/// @brief Wait on a group of tasks, only returning once all the tasks are ready.
+/// @brief Wait on a group of tasks, only returning once all the tasks are ready. Equivalent to when_all(tasks...).wait(),
+/// tasks that have not started yet are executed directly.
 /// @param ...tasks The tasks to wait on.
 template<typename... Ts>
 inline void wait_all(task<Ts>&... tasks) noexcept
 {
-   (tasks.wait(), ...);
+   when_all(tasks...).wait();
 }
 
 template<typename T>
-concept waitable_task_range = std::ranges::input_range<T> and
+concept waitable_task_range = dependable_task_range<T> and
    requires(std::ranges::range_reference_t<T> task)
 {
    {task.wait()};
 };
 
-/// @brief Wait on a range of tasks, only returning once all the tasks are ready.
+/// @brief Wait on a range of tasks, only returning once all the tasks are ready. Equivalent to when_all(tasks).wait(),
+/// tasks that have not started yet are executed directly.
 /// @param ...tasks The tasks to wait on.
 inline void wait_all(waitable_task_range auto& tasks) noexcept
 {
-   for (auto& task : tasks) {
-      task.wait();
-   }
+   when_all(tasks).wait();
 }
 
 }
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "thread_pool.hpp"
+
+#include <ranges>
+
+namespace we::async {
+
+/// @brief Creates a task that becomes ready once all of a group of tasks have completed (or been canceled).
+/// No thread blocks waiting on the group, the returned task is completed by whichever thread finishes the last task in it.
+/// The tasks are not consumed and exceptions are not propagated, use get on each task once the returned task is ready.
+/// @param ...tasks The tasks to wait on.
+/// @return The task.
+template<typename... Ts>
+[[nodiscard]] inline auto when_all(task<Ts>&... tasks) noexcept -> task<void>
+{
+   auto context =
+      detail::make_task_context<void, detail::dependent_task_context<void>>([] {});
+
+   context->dependencies.reserve(sizeof...(Ts));
+
+   (context->dependencies.emplace_back(tasks.context()), ...);
+
+   detail::link_dependencies(context, sizeof...(Ts), detail::execute_inline{});
+
+   return {context};
+}
+
+template<typename T>
+concept dependable_task_range = std::ranges::input_range<T> and
+   requires(std::ranges::range_reference_t<T> task)
+{
+   {task.context()};
+};
+
+/// @brief Creates a task that becomes ready once all of a range of tasks have completed (or been canceled).
+/// No thread blocks waiting on the range, the returned task is completed by whichever thread finishes the last task in it.
+/// The tasks are not consumed and exceptions are not propagated, use get on each task once the returned task is ready.
+/// @param tasks The tasks to wait on.
+/// @return The task.
+[[nodiscard]] inline auto when_all(dependable_task_range auto& tasks) noexcept
+   -> task<void>
+{
+   auto context =
+      detail::make_task_context<void, detail::dependent_task_context<void>>([] {});
+
+   for (auto& task : tasks) context->dependencies.emplace_back(task.context());
+
+   detail::link_dependencies(context, context->dependencies.size(),
+                             detail::execute_inline{});
+
+   return {context};
+}
+
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "when_all.hpp"
+
+#include <cstddef>
+
+namespace we::async {
+
+namespace detail {
+
+/// @brief Make a task that completes as soon as any one of the dependencies in it's context has, returning it's index.
+inline auto make_when_any_task(
+   std::shared_ptr<dependent_task_context<std::size_t>> context) noexcept
+   -> task<std::size_t>
+{
+   context->execute_function = [context = context.get()]() noexcept {
+      context->result = context->dependencies.size();
+
+      // If several dependencies have completed by the time we run the lowest index wins.
+      for (std::size_t i = 0; i < context->dependencies.size(); ++i) {
+         if (context->dependencies[i]->completed()) {
+            context->result = i;
+
+            break;
+         }
+      }
+
+      context->executed_latch.count_down();
+   };
+
+   link_dependencies(context, 1, execute_inline{});
+
+   return {context};
+}
+
+}
+
+/// @brief Creates a task that becomes ready once any one of a group of tasks has completed (or been canceled).
+/// No thread blocks waiting on the group, the returned task is completed by the thread that finishes the first task.
+/// The tasks are not consumed and exceptions are not propagated.
+/// @param ...tasks The tasks to wait on.
+/// @return The task, which returns the index of a task that completed.
+template<typename... Ts>
+[[nodiscard]] inline auto when_any(task<Ts>&... tasks) noexcept -> task<std::size_t>
+{
+   static_assert(sizeof...(Ts) != 0, "when_any requires at least one task.");
+
+   auto context = std::allocate_shared<detail::dependent_task_context<std::size_t>>(
+      detail::recycling_allocator<detail::dependent_task_context<std::size_t>>{});
+
+   context->dependencies.reserve(sizeof...(Ts));
+
+   (context->dependencies.emplace_back(tasks.context()), ...);
+
+   return detail::make_when_any_task(std::move(context));
+}
+
+/// @brief Creates a task that becomes ready once any one of a range of tasks has completed (or been canceled).
+/// No thread blocks waiting on the range, the returned task is completed by the thread that finishes the first task.
+/// The tasks are not consumed and exceptions are not propagated. An empty range produces a task that is ready immediately and returns 0.
+/// @param tasks The tasks to wait on.
+/// @return The task, which returns the index of a task that completed.
+[[nodiscard]] inline auto when_any(dependable_task_range auto& tasks) noexcept
+   -> task<std::size_t>
+{
+   auto context = std::allocate_shared<detail::dependent_task_context<std::size_t>>(
+      detail::recycling_allocator<detail::dependent_task_context<std::size_t>>{});
+
+   for (auto& task : tasks) context->dependencies.emplace_back(task.context());
+
+   return detail::make_when_any_task(std::move(context));
+}
+
+}
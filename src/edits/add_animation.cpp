@@ -12,6 +12,8 @@ struct add_animation final : edit<world::edit_context> {
    void apply(world::edit_context& context) noexcept override
    {
       context.world.animations.push_back(std::move(animation));
+
+      context.mark_dirty(&context.world.animations);
    }
 
    void revert(world::edit_context& context) noexcept override
@@ -19,6 +21,8 @@ struct add_animation final : edit<world::edit_context> {
       std::swap(animation, context.world.animations.back());
 
       context.world.animations.pop_back();
+
+      context.mark_dirty(&context.world.animations);
    }
 
    bool is_coalescable([[maybe_unused]] const edit& other) const noexcept override
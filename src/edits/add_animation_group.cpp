@@ -12,6 +12,8 @@ struct add_animation_group final : edit<world::edit_context> {
    void apply(world::edit_context& context) noexcept override
    {
       context.world.animation_groups.push_back(std::move(group));
+
+      context.mark_dirty(&context.world.animation_groups);
    }
 
    void revert(world::edit_context& context) noexcept override
@@ -19,6 +21,8 @@ struct add_animation_group final : edit<world::edit_context> {
       std::swap(group, context.world.animation_groups.back());
 
       context.world.animation_groups.pop_back();
+
+      context.mark_dirty(&context.world.animation_groups);
    }
 
    bool is_coalescable([[maybe_unused]] const edit& other) const noexcept override
@@ -11,20 +11,24 @@ struct add_animation_group_entry final : edit<world::edit_context> {
    {
    }
 
-   void apply([[maybe_unused]] world::edit_context& context) noexcept override
+   void apply(world::edit_context& context) noexcept override
    {
       assert(context.is_memory_valid(entries));
 
       entries->push_back(std::move(new_entry));
+
+      context.mark_dirty(entries);
    }
 
-   void revert([[maybe_unused]] world::edit_context& context) noexcept override
+   void revert(world::edit_context& context) noexcept override
    {
       assert(context.is_memory_valid(entries));
 
       std::swap(new_entry, entries->back());
 
       entries->pop_back();
+
+      context.mark_dirty(entries);
    }
 
    bool is_coalescable([[maybe_unused]] const edit& other) const noexcept override
@@ -13,6 +13,8 @@ struct add_animation_hierarchy final : edit<world::edit_context> {
    void apply(world::edit_context& context) noexcept override
    {
       context.world.animation_hierarchies.push_back(std::move(hierarchy));
+
+      context.mark_dirty(&context.world.animation_hierarchies);
    }
 
    void revert(world::edit_context& context) noexcept override
@@ -20,6 +22,8 @@ struct add_animation_hierarchy final : edit<world::edit_context> {
       std::swap(hierarchy, context.world.animation_hierarchies.back());
 
       context.world.animation_hierarchies.pop_back();
+
+      context.mark_dirty(&context.world.animation_hierarchies);
    }
 
    bool is_coalescable([[maybe_unused]] const edit& other) const noexcept override
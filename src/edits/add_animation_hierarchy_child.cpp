@@ -11,20 +11,24 @@ struct add_animation_hierarchy_child final : edit<world::edit_context> {
    {
    }
 
-   void apply([[maybe_unused]] world::edit_context& context) noexcept override
+   void apply(world::edit_context& context) noexcept override
    {
       assert(context.is_memory_valid(children));
 
       children->push_back(std::move(new_child));
+
+      context.mark_dirty(children);
    }
 
-   void revert([[maybe_unused]] world::edit_context& context) noexcept override
+   void revert(world::edit_context& context) noexcept override
    {
       assert(context.is_memory_valid(children));
 
       std::swap(new_child, children->back());
 
       children->pop_back();
+
+      context.mark_dirty(children);
    }
 
    bool is_coalescable([[maybe_unused]] const edit& other) const noexcept override
@@ -42,6 +42,8 @@ struct add_block final : edit<world::edit_context> {
       blocks.dirty.add({block_index, block_index + 1});
 
       assert(blocks.is_balanced());
+
+      context.mark_dirty(&context.world.blocks);
    }
 
    void revert(world::edit_context& context) noexcept override
@@ -66,6 +68,8 @@ struct add_block final : edit<world::edit_context> {
       blocks.dirty.remove_index(block_index);
 
       assert(blocks.is_balanced());
+
+      context.mark_dirty(&context.world.blocks);
    }
 
    bool is_coalescable([[maybe_unused]] const edit& other) const noexcept override
@@ -114,6 +118,8 @@ struct add_block_custom_mesh final : edit<world::edit_context> {
       blocks.dirty.add({block_index, block_index + 1});
 
       assert(blocks.is_balanced());
+
+      context.mark_dirty(&context.world.blocks);
    }
 
    void revert(world::edit_context& context) noexcept override
@@ -141,6 +147,8 @@ struct add_block_custom_mesh final : edit<world::edit_context> {
       blocks.dirty.remove_index(block_index);
 
       assert(blocks.is_balanced());
+
+      context.mark_dirty(&context.world.blocks);
    }
 
    bool is_coalescable([[maybe_unused]] const edit& other) const noexcept override
@@ -11,18 +11,22 @@ struct add_branch_weight final : edit<world::edit_context> {
    {
    }
 
-   void apply([[maybe_unused]] world::edit_context& context) noexcept override
+   void apply(world::edit_context& context) noexcept override
    {
       assert(context.is_memory_valid(branch_weights));
 
       branch_weights->push_back(weights);
+
+      context.mark_dirty(branch_weights);
    }
 
-   void revert([[maybe_unused]] world::edit_context& context) noexcept override
+   void revert(world::edit_context& context) noexcept override
    {
       assert(context.is_memory_valid(branch_weights));
 
       branch_weights->pop_back();
+
+      context.mark_dirty(branch_weights);
    }
 
    bool is_coalescable([[maybe_unused]] const edit& other) const noexcept override
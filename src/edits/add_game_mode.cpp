@@ -85,6 +85,8 @@ struct add_game_mode final : edit<world::edit_context> {
          world.deleted_game_modes.erase(world.deleted_game_modes.begin() +
                                         _previously_deleted->index);
       }
+
+      context.mark_dirty(&world.game_modes);
    }
 
    void revert(world::edit_context& context) noexcept override
@@ -105,6 +107,8 @@ struct add_game_mode final : edit<world::edit_context> {
                                             _previously_deleted->index,
                                          _previously_deleted->name);
       }
+
+      context.mark_dirty(&world.game_modes);
    }
 
    bool is_coalescable([[maybe_unused]] const edit& other) const noexcept override
@@ -52,6 +52,8 @@ struct add_layer final : edit<world::edit_context> {
          context.world.deleted_layers.erase(context.world.deleted_layers.begin() +
                                             _previously_deleted->index);
       }
+
+      context.mark_dirty(&context.world.layer_descriptions);
    }
 
    void revert(world::edit_context& context) noexcept override
@@ -73,6 +75,8 @@ struct add_layer final : edit<world::edit_context> {
                                                 _previously_deleted->index,
                                              _previously_deleted->name);
       }
+
+      context.mark_dirty(&context.world.layer_descriptions);
    }
 
    bool is_coalescable([[maybe_unused]] const edit& other) const noexcept override
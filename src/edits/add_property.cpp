@@ -13,12 +13,20 @@ struct add_property_path final : edit<world::edit_context> {
 
    void apply(world::edit_context& context) noexcept override
    {
-      world::find_entity(context.world.paths, _id)->properties.emplace_back(_property, "");
+      world::path* path = world::find_entity(context.world.paths, _id);
+
+      path->properties.emplace_back(_property, "");
+
+      context.mark_dirty(path);
    }
 
    void revert(world::edit_context& context) noexcept override
    {
-      world::find_entity(context.world.paths, _id)->properties.pop_back();
+      world::path* path = world::find_entity(context.world.paths, _id);
+
+      path->properties.pop_back();
+
+      context.mark_dirty(path);
    }
 
    bool is_coalescable([[maybe_unused]] const edit& other) const noexcept override
@@ -41,18 +49,20 @@ struct add_property_path_node final : edit<world::edit_context> {
 
    void apply(world::edit_context& context) noexcept override
    {
-      world::path::node& node =
-         world::find_entity(context.world.paths, _id)->nodes[_node];
+      world::path* path = world::find_entity(context.world.paths, _id);
+
+      path->nodes[_node].properties.emplace_back(_property, "");
 
-      node.properties.emplace_back(_property, "");
+      context.mark_dirty(path);
    }
 
    void revert(world::edit_context& context) noexcept override
    {
-      world::path::node& node =
-         world::find_entity(context.world.paths, _id)->nodes[_node];
+      world::path* path = world::find_entity(context.world.paths, _id);
+
+      path->nodes[_node].properties.pop_back();
 
-      node.properties.pop_back();
+      context.mark_dirty(path);
    }
 
    bool is_coalescable([[maybe_unused]] const edit& other) const noexcept override
@@ -10,18 +10,22 @@ struct add_sector_object final : edit<world::edit_context> {
    {
    }
 
-   void apply([[maybe_unused]] world::edit_context& context) noexcept override
+   void apply(world::edit_context& context) noexcept override
    {
       assert(context.is_memory_valid(_objects));
 
       _objects->push_back(_object_index);
+
+      context.mark_dirty(_objects);
    }
 
-   void revert([[maybe_unused]] world::edit_context& context) noexcept override
+   void revert(world::edit_context& context) noexcept override
    {
       assert(context.is_memory_valid(_objects));
 
       _objects->pop_back();
+
+      context.mark_dirty(_objects);
    }
 
    bool is_coalescable([[maybe_unused]] const edit& other) const noexcept override
@@ -10,11 +10,15 @@ struct add_sun_flare final : edit<world::edit_context> {
    void apply(world::edit_context& context) noexcept override
    {
       context.world.effects.sun_flares.push_back(_sun_flare);
+
+      context.mark_dirty(&context.world.effects.sun_flares);
    }
 
    void revert(world::edit_context& context) noexcept override
    {
       context.world.effects.sun_flares.pop_back();
+
+      context.mark_dirty(&context.world.effects.sun_flares);
    }
 
    bool is_coalescable([[maybe_unused]] const edit& other) const noexcept override
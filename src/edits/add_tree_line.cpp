@@ -20,6 +20,8 @@ struct add_tree_line final : edit<world::edit_context> {
       for (world::tree_line_odf& odf : context.world.tree_lines.back().border_odfs) {
          odf.handle = _object_class_library.acquire(lowercase_string{odf.name});
       }
+
+      context.mark_dirty(&context.world.tree_lines);
    }
 
    void revert(world::edit_context& context) noexcept override
@@ -31,6 +33,8 @@ struct add_tree_line final : edit<world::edit_context> {
       _tree_line = std::move(context.world.tree_lines.back());
 
       context.world.tree_lines.pop_back();
+
+      context.mark_dirty(&context.world.tree_lines);
    }
 
    bool is_coalescable([[maybe_unused]] const edit& other) const noexcept override
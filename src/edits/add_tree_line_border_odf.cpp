@@ -16,22 +16,26 @@ struct add_tree_line_border_odf final : edit<world::edit_context> {
    {
    }
 
-   void apply([[maybe_unused]] world::edit_context& context) noexcept override
+   void apply(world::edit_context& context) noexcept override
    {
       assert(context.is_memory_valid(_odfs));
 
       _odfs->push_back(std::move(_new_odf));
       _odfs->back().handle =
          _object_class_library.acquire(lowercase_string{_odfs->back().name});
+
+      context.mark_dirty(_odfs);
    }
 
-   void revert([[maybe_unused]] world::edit_context& context) noexcept override
+   void revert(world::edit_context& context) noexcept override
    {
       assert(context.is_memory_valid(_odfs));
 
       _object_class_library.free(_odfs->back().handle);
       _new_odf = std::move(_odfs->back());
       _odfs->pop_back();
+
+      context.mark_dirty(_odfs);
    }
 
    bool is_coalescable([[maybe_unused]] const edit& other) const noexcept override
@@ -13,11 +13,15 @@ struct add_world_req_entry final : edit<world::edit_context> {
    void apply(world::edit_context& context) noexcept override
    {
       context.world.requirements[_list_index].entries.push_back(_name);
+
+      context.mark_dirty(&context.world.requirements);
    }
 
    void revert(world::edit_context& context) noexcept override
    {
       context.world.requirements[_list_index].entries.pop_back();
+
+      context.mark_dirty(&context.world.requirements);
    }
 
    bool is_coalescable([[maybe_unused]] const edit& other) const noexcept override
@@ -12,11 +12,15 @@ struct add_world_req_list final : edit<world::edit_context> {
    void apply(world::edit_context& context) noexcept override
    {
       context.world.requirements.push_back({.file_type = _file_type});
+
+      context.mark_dirty(&context.world.requirements);
    }
 
    void revert(world::edit_context& context) noexcept override
    {
       context.world.requirements.pop_back();
+
+      context.mark_dirty(&context.world.requirements);
    }
 
    bool is_coalescable([[maybe_unused]] const edit& other) const noexcept override
@@ -47,6 +47,8 @@ struct delete_animation final : edit<world::edit_context> {
             }
          }
       }
+
+      context.mark_dirty(&context.world.animations);
    }
 
    void revert(world::edit_context& context) noexcept override
@@ -75,6 +77,8 @@ struct delete_animation final : edit<world::edit_context> {
 
       context.world.animations.insert(context.world.animations.begin() + index,
                                       std::move(animation));
+
+      context.mark_dirty(&context.world.animations);
    }
 
    bool is_coalescable([[maybe_unused]] const edit& other) const noexcept override
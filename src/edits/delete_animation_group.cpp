@@ -14,6 +14,8 @@ struct delete_animation_group final : edit<world::edit_context> {
       std::swap(context.world.animation_groups[index], group);
 
       context.world.animation_groups.erase(context.world.animation_groups.begin() + index);
+
+      context.mark_dirty(&context.world.animation_groups);
    }
 
    void revert(world::edit_context& context) noexcept override
@@ -22,6 +24,8 @@ struct delete_animation_group final : edit<world::edit_context> {
 
       context.world.animation_groups.insert(context.world.animation_groups.begin() + index,
                                             std::move(group));
+
+      context.mark_dirty(&context.world.animation_groups);
    }
 
    bool is_coalescable([[maybe_unused]] const edit& other) const noexcept override
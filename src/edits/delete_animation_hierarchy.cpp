@@ -15,6 +15,8 @@ struct delete_animation_hierarchy final : edit<world::edit_context> {
 
       context.world.animation_hierarchies.erase(
          context.world.animation_hierarchies.begin() + index);
+
+      context.mark_dirty(&context.world.animation_hierarchies);
    }
 
    void revert(world::edit_context& context) noexcept override
@@ -24,6 +26,8 @@ struct delete_animation_hierarchy final : edit<world::edit_context> {
       context.world.animation_hierarchies
          .insert(context.world.animation_hierarchies.begin() + index,
                  std::move(hierarchy));
+
+      context.mark_dirty(&context.world.animation_hierarchies);
    }
 
    bool is_coalescable([[maybe_unused]] const edit& other) const noexcept override
@@ -12,20 +12,24 @@ struct delete_animation_key final : edit<world::edit_context> {
       assert(index < keys->size());
    }
 
-   void apply([[maybe_unused]] world::edit_context& context) noexcept override
+   void apply(world::edit_context& context) noexcept override
    {
       assert(context.is_memory_valid(keys));
       assert(index < keys->size());
 
       keys->erase(keys->begin() + index);
+
+      context.mark_dirty(keys);
    }
 
-   void revert([[maybe_unused]] world::edit_context& context) noexcept override
+   void revert(world::edit_context& context) noexcept override
    {
       assert(context.is_memory_valid(keys));
       assert(index <= keys->size());
 
       keys->insert(keys->begin() + index, key);
+
+      context.mark_dirty(keys);
    }
 
    bool is_coalescable([[maybe_unused]] const edit& other) const noexcept override
@@ -44,6 +44,8 @@ struct delete_block final : edit<world::edit_context> {
       blocks.dirty.add({block_index, static_cast<uint32>(blocks.size())});
 
       assert(blocks.is_balanced());
+
+      context.mark_dirty(&context.world.blocks);
    }
 
    void revert(world::edit_context& context) noexcept override
@@ -68,6 +70,8 @@ struct delete_block final : edit<world::edit_context> {
       blocks.dirty.add({block_index, static_cast<uint32>(blocks.size())});
 
       assert(blocks.is_balanced());
+
+      context.mark_dirty(&context.world.blocks);
    }
 
    bool is_coalescable([[maybe_unused]] const edit& other) const noexcept override
@@ -125,6 +129,8 @@ struct delete_block_custom_mesh final : edit<world::edit_context> {
       blocks.dirty.add({block_index, static_cast<uint32>(blocks.size())});
 
       assert(blocks.is_balanced());
+
+      context.mark_dirty(&context.world.blocks);
    }
 
    void revert(world::edit_context& context) noexcept override
@@ -151,6 +157,8 @@ struct delete_block_custom_mesh final : edit<world::edit_context> {
       blocks.dirty.add({block_index, static_cast<uint32>(blocks.size())});
 
       assert(blocks.is_balanced());
+
+      context.mark_dirty(&context.world.blocks);
    }
 
    bool is_coalescable([[maybe_unused]] const edit& other) const noexcept override
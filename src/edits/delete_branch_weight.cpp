@@ -11,20 +11,24 @@ struct delete_branch_weight final : edit<world::edit_context> {
       assert(index < weights->size());
    }
 
-   void apply([[maybe_unused]] world::edit_context& context) noexcept override
+   void apply(world::edit_context& context) noexcept override
    {
       assert(context.is_memory_valid(weights));
       assert(index < weights->size());
 
       weights->erase(weights->begin() + index);
+
+      context.mark_dirty(weights);
    }
 
-   void revert([[maybe_unused]] world::edit_context& context) noexcept override
+   void revert(world::edit_context& context) noexcept override
    {
       assert(context.is_memory_valid(weights));
       assert(index <= weights->size());
 
       weights->insert(weights->begin() + index, weight);
+
+      context.mark_dirty(weights);
    }
 
    bool is_coalescable([[maybe_unused]] const edit& other) const noexcept override
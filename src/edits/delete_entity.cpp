@@ -98,6 +98,8 @@ struct delete_object final : edit<world::edit_context> {
                       .instance_properties[unlinked.property_index]
                       .value,
                    unlinked.value);
+
+         context.mark_dirty(&context.world.objects[unlinked.object_index]);
       }
 
       for (std::ptrdiff_t i = (std::ssize(_unlinked_path_properties) - 1);
@@ -109,6 +111,8 @@ struct delete_object final : edit<world::edit_context> {
          std::swap(properties[unlinked.property_index], unlinked.value);
 
          properties.erase(properties.begin() + unlinked.property_index);
+
+         context.mark_dirty(&context.world.paths[unlinked.path_index]);
       }
 
       for (std::ptrdiff_t i = (std::ssize(_unlinked_sector_entries) - 1); i >= 0; --i) {
@@ -198,6 +202,8 @@ struct delete_object final : edit<world::edit_context> {
       _object_class_library.free(context.world.objects[_object_index].class_handle);
 
       context.world.objects.erase(context.world.objects.begin() + _object_index);
+
+      context.mark_dirty(&context.world.objects);
    }
 
    void revert(world::edit_context& context) noexcept override
@@ -246,6 +252,8 @@ struct delete_object final : edit<world::edit_context> {
                       .instance_properties[unlinked.property_index]
                       .value,
                    unlinked.value);
+
+         context.mark_dirty(&context.world.objects[unlinked.object_index]);
       }
 
       for (unlinked_path_property& unlinked : _unlinked_path_properties) {
@@ -254,6 +262,8 @@ struct delete_object final : edit<world::edit_context> {
 
          properties.emplace(properties.begin() + unlinked.property_index,
                             std::move(unlinked.value));
+
+         context.mark_dirty(&context.world.paths[unlinked.path_index]);
       }
 
       for (unlinked_sector_entry& unlinked : _unlinked_sector_entries) {
@@ -293,6 +303,8 @@ struct delete_object final : edit<world::edit_context> {
 
       context.world.objects[_object_index].class_handle =
          _object_class_library.acquire(context.world.objects[_object_index].class_name);
+
+      context.mark_dirty(&context.world.objects);
    }
 
    bool is_coalescable([[maybe_unused]] const edit& other) const noexcept override
@@ -327,6 +339,8 @@ struct delete_entity final : edit<world::edit_context> {
       pinned_vector<T>& entities = world::select_entities<T>(context.world);
 
       entities.erase(entities.begin() + _entity_index);
+
+      context.mark_dirty(&entities);
    }
 
    void revert(world::edit_context& context) noexcept override
@@ -334,6 +348,8 @@ struct delete_entity final : edit<world::edit_context> {
       pinned_vector<T>& entities = world::select_entities<T>(context.world);
 
       entities.insert(entities.begin() + _entity_index, _entity);
+
+      context.mark_dirty(&entities);
    }
 
    bool is_coalescable([[maybe_unused]] const edit& other) const noexcept override
@@ -385,6 +401,9 @@ struct delete_light final : edit<world::edit_context> {
       }
 
       world.lights.erase(world.lights.begin() + _light_index);
+
+      context.mark_dirty(&world.lights);
+      context.mark_dirty(&world.global_lights);
    }
 
    void revert(world::edit_context& context) noexcept override
@@ -410,6 +429,9 @@ struct delete_light final : edit<world::edit_context> {
          world.global_lights.global_light_2 =
             world.global_lights.global_light_2.index() + 1;
       }
+
+      context.mark_dirty(&world.lights);
+      context.mark_dirty(&world.global_lights);
    }
 
    bool is_coalescable([[maybe_unused]] const edit& other) const noexcept override
@@ -438,6 +460,8 @@ struct delete_path_node final : edit<world::edit_context> {
       std::vector<world::path::node>& nodes = context.world.paths[_path_index].nodes;
 
       nodes.erase(nodes.begin() + _node_index);
+
+      context.mark_dirty(&nodes);
    }
 
    void revert(world::edit_context& context) noexcept override
@@ -445,6 +469,8 @@ struct delete_path_node final : edit<world::edit_context> {
       std::vector<world::path::node>& nodes = context.world.paths[_path_index].nodes;
 
       nodes.insert(nodes.begin() + _node_index, _node);
+
+      context.mark_dirty(&nodes);
    }
 
    bool is_coalescable([[maybe_unused]] const edit& other) const noexcept override
@@ -487,6 +513,8 @@ struct delete_path final : edit<world::edit_context> {
                       .instance_properties[unlinked.property_index]
                       .value,
                    unlinked.value);
+
+         context.mark_dirty(&context.world.objects[unlinked.object_index]);
       }
 
       for (std::ptrdiff_t i = std::ssize(_unlinked_tree_lines) - 1; i >= 0; --i) {
@@ -506,6 +534,9 @@ struct delete_path final : edit<world::edit_context> {
       for (world::tree_line& tree_line : context.world.tree_lines) {
          if (tree_line.path_index > _path_index) tree_line.path_index -= 1;
       }
+
+      context.mark_dirty(&context.world.paths);
+      context.mark_dirty(&context.world.tree_lines);
    }
 
    void revert(world::edit_context& context) noexcept override
@@ -521,6 +552,8 @@ struct delete_path final : edit<world::edit_context> {
                       .instance_properties[unlinked.property_index]
                       .value,
                    unlinked.value);
+
+         context.mark_dirty(&context.world.objects[unlinked.object_index]);
       }
 
       for (unlinked_tree_line& unlinked : _unlinked_tree_lines) {
@@ -533,6 +566,9 @@ struct delete_path final : edit<world::edit_context> {
             odf.handle = _object_class_library.acquire(lowercase_string{odf.name});
          }
       }
+
+      context.mark_dirty(&context.world.paths);
+      context.mark_dirty(&context.world.tree_lines);
    }
 
    bool is_coalescable([[maybe_unused]] const edit& other) const noexcept override
@@ -563,11 +599,15 @@ struct delete_region final : edit<world::edit_context> {
    {
       context.world.regions.erase(context.world.regions.begin() + _region_index);
 
+      context.mark_dirty(&context.world.regions);
+
       for (unlinked_object_property& unlinked : _unlinked_object_properties) {
          std::swap(context.world.objects[unlinked.object_index]
                       .instance_properties[unlinked.property_index]
                       .value,
                    unlinked.value);
+
+         context.mark_dirty(&context.world.objects[unlinked.object_index]);
       }
    }
 
@@ -576,11 +616,15 @@ struct delete_region final : edit<world::edit_context> {
       context.world.regions.insert(context.world.regions.begin() + _region_index,
                                    _region);
 
+      context.mark_dirty(&context.world.regions);
+
       for (unlinked_object_property& unlinked : _unlinked_object_properties) {
          std::swap(context.world.objects[unlinked.object_index]
                       .instance_properties[unlinked.property_index]
                       .value,
                    unlinked.value);
+
+         context.mark_dirty(&context.world.objects[unlinked.object_index]);
       }
    }
 
@@ -616,6 +660,8 @@ struct delete_sector final : edit<world::edit_context> {
    {
       context.world.sectors.erase(context.world.sectors.begin() + _sector_index);
 
+      context.mark_dirty(&context.world.sectors);
+
       for (const auto& unlinked : _unlinked_portals) {
          world::portal& portal = context.world.portals[unlinked.portal_index];
 
@@ -639,6 +685,8 @@ struct delete_sector final : edit<world::edit_context> {
       context.world.sectors.insert(context.world.sectors.begin() + _sector_index,
                                    _sector);
 
+      context.mark_dirty(&context.world.sectors);
+
       for (world::portal& portal : context.world.portals) {
          if (portal.sector1.has_index() and portal.sector1.index() >= _sector_index) {
             portal.sector1 = portal.sector1.index() + 1;
@@ -730,6 +778,8 @@ struct delete_planning_hub final : edit<world::edit_context> {
       _hub = std::move(context.world.planning_hubs[_hub_index]);
 
       context.world.planning_hubs.erase(context.world.planning_hubs.begin() + _hub_index);
+
+      context.mark_dirty(&context.world.planning_hubs);
    }
 
    void revert(world::edit_context& context) noexcept override
@@ -779,6 +829,8 @@ struct delete_planning_hub final : edit<world::edit_context> {
                broken.weight_index,
             broken.weights);
       }
+
+      context.mark_dirty(&context.world.planning_hubs);
    }
 
    bool is_coalescable([[maybe_unused]] const edit& other) const noexcept override
@@ -823,6 +875,8 @@ struct delete_planning_connection final : edit<world::edit_context> {
 
       context.world.planning_connections.erase(
          context.world.planning_connections.begin() + _connection_index);
+
+      context.mark_dirty(&context.world.planning_connections);
    }
 
    void revert(world::edit_context& context) noexcept override
@@ -847,6 +901,8 @@ struct delete_planning_connection final : edit<world::edit_context> {
                broken.weight_index,
             broken.weights);
       }
+
+      context.mark_dirty(&context.world.planning_hubs);
    }
 
    bool is_coalescable([[maybe_unused]] const edit& other) const noexcept override
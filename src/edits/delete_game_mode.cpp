@@ -70,6 +70,8 @@ struct delete_game_mode final : edit<world::edit_context> {
 
          list.entries.erase(list.entries.begin() + entry_index);
       }
+
+      context.mark_dirty(&world.game_modes);
    }
 
    void revert(world::edit_context& context) noexcept override
@@ -85,6 +87,8 @@ struct delete_game_mode final : edit<world::edit_context> {
 
          list.entries.emplace(list.entries.begin() + entry_index, entry);
       }
+
+      context.mark_dirty(&world.game_modes);
    }
 
    bool is_coalescable([[maybe_unused]] const edit& other) const noexcept override
@@ -1452,6 +1452,8 @@ struct delete_layer final : edit<world::edit_context> {
       apply_delete_entries(world.blocks.pyramids, _data.delete_blocks_pyramids);
       apply_delete_entries(world.blocks.terrain_cut_boxes,
                            _data.delete_blocks_terrain_cut_boxes);
+
+      context.mark_dirty(&world.layer_descriptions);
    }
 
    void revert(world::edit_context& context) noexcept override
@@ -1512,6 +1514,8 @@ struct delete_layer final : edit<world::edit_context> {
                                      _animation_hierarchy_object_link_adjustments);
 
       revert_unlinked_entities(world, _data.unlinked_properties);
+
+      context.mark_dirty(&world.layer_descriptions);
    }
 
    bool is_coalescable([[maybe_unused]] const edit& other) const noexcept override
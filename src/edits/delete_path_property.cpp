@@ -14,16 +14,22 @@ struct delete_path_property final : edit<world::edit_context> {
 
    void apply(world::edit_context& context) noexcept override
    {
-      auto& properties = world::find_entity(context.world.paths, _id)->properties;
+      world::path* path = world::find_entity(context.world.paths, _id);
+      auto& properties = path->properties;
 
       properties.erase(properties.begin() + _property_index);
+
+      context.mark_dirty(path);
    }
 
    void revert(world::edit_context& context) noexcept override
    {
-      auto& properties = world::find_entity(context.world.paths, _id)->properties;
+      world::path* path = world::find_entity(context.world.paths, _id);
+      auto& properties = path->properties;
 
       properties.insert(properties.begin() + _property_index, _property);
+
+      context.mark_dirty(path);
    }
 
    bool is_coalescable([[maybe_unused]] const edit& other) const noexcept override
@@ -51,18 +57,22 @@ struct delete_path_node_property final : edit<world::edit_context> {
 
    void apply(world::edit_context& context) noexcept override
    {
-      auto& properties =
-         world::find_entity(context.world.paths, _id)->nodes[_node_index].properties;
+      world::path* path = world::find_entity(context.world.paths, _id);
+      auto& properties = path->nodes[_node_index].properties;
 
       properties.erase(properties.begin() + _property_index);
+
+      context.mark_dirty(path);
    }
 
    void revert(world::edit_context& context) noexcept override
    {
-      auto& properties =
-         world::find_entity(context.world.paths, _id)->nodes[_node_index].properties;
+      world::path* path = world::find_entity(context.world.paths, _id);
+      auto& properties = path->nodes[_node_index].properties;
 
       properties.insert(properties.begin() + _property_index, _property);
+
+      context.mark_dirty(path);
    }
 
    bool is_coalescable([[maybe_unused]] const edit& other) const noexcept override
@@ -15,6 +15,8 @@ struct delete_sun_flare final : edit<world::edit_context> {
 
       context.world.effects.sun_flares.erase(
          context.world.effects.sun_flares.begin() + index);
+
+      context.mark_dirty(&context.world.effects.sun_flares);
    }
 
    void revert(world::edit_context& context) noexcept override
@@ -23,6 +25,8 @@ struct delete_sun_flare final : edit<world::edit_context> {
 
       context.world.effects.sun_flares.insert(context.world.effects.sun_flares.begin() + index,
                                               sun_flare);
+
+      context.mark_dirty(&context.world.effects.sun_flares);
    }
 
    bool is_coalescable([[maybe_unused]] const edit& other) const noexcept override
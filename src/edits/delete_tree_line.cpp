@@ -23,6 +23,8 @@ struct delete_tree_line final : edit<world::edit_context> {
       _tree_line = std::move(context.world.tree_lines[_index]);
 
       context.world.tree_lines.erase(context.world.tree_lines.begin() + _index);
+
+      context.mark_dirty(&context.world.tree_lines);
    }
 
    void revert(world::edit_context& context) noexcept override
@@ -35,6 +37,8 @@ struct delete_tree_line final : edit<world::edit_context> {
       for (world::tree_line_odf& odf : context.world.tree_lines[_index].border_odfs) {
          odf.handle = _object_class_library.acquire(lowercase_string{odf.name});
       }
+
+      context.mark_dirty(&context.world.tree_lines);
    }
 
    bool is_coalescable([[maybe_unused]] const edit& other) const noexcept override
@@ -13,7 +13,7 @@ struct delete_tree_line_border_odf final : edit<world::edit_context> {
    {
    }
 
-   void apply([[maybe_unused]] world::edit_context& context) noexcept override
+   void apply(world::edit_context& context) noexcept override
    {
       assert(context.is_memory_valid(_odfs));
       assert(_index < _odfs->size());
@@ -21,9 +21,11 @@ struct delete_tree_line_border_odf final : edit<world::edit_context> {
       _object_class_library.free((*_odfs)[_index].handle);
       _odf = std::move((*_odfs)[_index]);
       _odfs->erase(_odfs->begin() + _index);
+
+      context.mark_dirty(_odfs);
    }
 
-   void revert([[maybe_unused]] world::edit_context& context) noexcept override
+   void revert(world::edit_context& context) noexcept override
    {
       assert(context.is_memory_valid(_odfs));
       assert(_index <= _odfs->size());
@@ -32,6 +34,8 @@ struct delete_tree_line_border_odf final : edit<world::edit_context> {
 
       (*_odfs)[_index].handle =
          _object_class_library.acquire(lowercase_string{(*_odfs)[_index].name});
+
+      context.mark_dirty(_odfs);
    }
 
    bool is_coalescable([[maybe_unused]] const edit& other) const noexcept override
@@ -16,7 +16,7 @@ struct delete_vector_entry final : edit<world::edit_context> {
    {
    }
 
-   void apply([[maybe_unused]] world::edit_context& context) noexcept override
+   void apply(world::edit_context& context) noexcept override
    {
       assert(context.is_memory_valid(vector));
       assert(index < vector->size());
@@ -24,14 +24,18 @@ struct delete_vector_entry final : edit<world::edit_context> {
       std::swap((*vector)[index], value);
 
       vector->erase(vector->begin() + index);
+
+      context.mark_dirty(vector);
    }
 
-   void revert([[maybe_unused]] world::edit_context& context) noexcept override
+   void revert(world::edit_context& context) noexcept override
    {
       assert(context.is_memory_valid(vector));
       assert(index <= vector->size());
 
       vector->insert(vector->begin() + index, std::move(value));
+
+      context.mark_dirty(vector);
    }
 
    bool is_coalescable([[maybe_unused]] const edit& other) const noexcept override
@@ -15,6 +15,8 @@ struct delete_world_req_entry final : edit<world::edit_context> {
       auto& entries = context.world.requirements[_list_index].entries;
 
       entries.erase(entries.begin() + _entry_index);
+
+      context.mark_dirty(&context.world.requirements);
    }
 
    void revert(world::edit_context& context) noexcept override
@@ -22,6 +24,8 @@ struct delete_world_req_entry final : edit<world::edit_context> {
       auto& entries = context.world.requirements[_list_index].entries;
 
       entries.insert(entries.begin() + _entry_index, _name);
+
+      context.mark_dirty(&context.world.requirements);
    }
 
    bool is_coalescable([[maybe_unused]] const edit& other) const noexcept override
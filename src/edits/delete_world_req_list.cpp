@@ -15,6 +15,8 @@ struct delete_world_req_list final : edit<world::edit_context> {
       auto& requirements = context.world.requirements;
 
       requirements.erase(requirements.begin() + _list_index);
+
+      context.mark_dirty(&requirements);
    }
 
    void revert(world::edit_context& context) noexcept override
@@ -22,6 +24,8 @@ struct delete_world_req_list final : edit<world::edit_context> {
       auto& requirements = context.world.requirements;
 
       requirements.insert(requirements.begin() + _list_index, _list);
+
+      context.mark_dirty(&requirements);
    }
 
    bool is_coalescable([[maybe_unused]] const edit& other) const noexcept override
@@ -51,6 +51,8 @@ struct link_layer final : edit<world::edit_context> {
 
       game_mode.layers.push_back(_layer_index);
 
+      context.mark_dirty(&world.game_modes);
+
       if (_req_edit_type == req_edit_type::none) return;
 
       const std::string req_entry_name =
@@ -73,6 +75,8 @@ struct link_layer final : edit<world::edit_context> {
 
       game_mode.layers.pop_back();
 
+      context.mark_dirty(&context.world.game_modes);
+
       if (_req_edit_type == req_edit_type::append) {
          game_mode.requirements[_req_edit_append.list_index].entries.pop_back();
       }
@@ -110,6 +114,9 @@ struct link_common_layer final : edit<world::edit_context> {
 
       world.common_layers.push_back(_layer_index);
 
+      context.mark_dirty(&world.common_layers);
+      context.mark_dirty(&world.requirements);
+
       if (_req_edit_type == req_edit_type::none) return;
 
       const std::string req_entry_name =
@@ -130,6 +137,9 @@ struct link_common_layer final : edit<world::edit_context> {
 
       world.common_layers.pop_back();
 
+      context.mark_dirty(&world.common_layers);
+      context.mark_dirty(&world.requirements);
+
       if (_req_edit_type == req_edit_type::append) {
          world.requirements[_req_edit_append.list_index].entries.pop_back();
       }
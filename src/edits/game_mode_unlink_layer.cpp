@@ -71,6 +71,8 @@ struct unlink_layer final : edit<world::edit_context> {
 
       game_mode.layers.erase(game_mode.layers.begin() + _game_mode_layers_index);
 
+      context.mark_dirty(&world.game_modes);
+
       for (const auto& [list_index, entry_index, entry] : _delete_requirements) {
          auto& list = game_mode.requirements[list_index];
 
@@ -86,6 +88,8 @@ struct unlink_layer final : edit<world::edit_context> {
       game_mode.layers.insert(game_mode.layers.begin() + _game_mode_layers_index,
                               _layer_index);
 
+      context.mark_dirty(&context.world.game_modes);
+
       for (std::ptrdiff_t i = (std::ssize(_delete_requirements) - 1); i >= 0; --i) {
          const auto& [list_index, entry_index, entry] = _delete_requirements[i];
          auto& list = game_mode.requirements[list_index];
@@ -123,6 +127,9 @@ struct unlink_layer_from_common final : edit<world::edit_context> {
 
       world.common_layers.erase(world.common_layers.begin() + _common_layers_index);
 
+      context.mark_dirty(&world.common_layers);
+      context.mark_dirty(&world.requirements);
+
       for (const auto& [list_index, entry_index, entry] : _delete_requirements) {
          auto& list = world.requirements[list_index];
 
@@ -137,6 +144,9 @@ struct unlink_layer_from_common final : edit<world::edit_context> {
       world.common_layers.insert(world.common_layers.begin() + _common_layers_index,
                                  _layer_index);
 
+      context.mark_dirty(&world.common_layers);
+      context.mark_dirty(&world.requirements);
+
       for (std::ptrdiff_t i = (std::ssize(_delete_requirements) - 1); i >= 0; --i) {
          const auto& [list_index, entry_index, entry] = _delete_requirements[i];
          auto& list = world.requirements[list_index];
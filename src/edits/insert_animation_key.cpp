@@ -11,20 +11,24 @@ struct insert_animation_key final : edit<world::edit_context> {
    {
    }
 
-   void apply([[maybe_unused]] world::edit_context& context) noexcept override
+   void apply(world::edit_context& context) noexcept override
    {
       assert(context.is_memory_valid(keys));
       assert(insert_before_index <= keys->size());
 
       keys->insert(keys->begin() + insert_before_index, key);
+
+      context.mark_dirty(keys);
    }
 
-   void revert([[maybe_unused]] world::edit_context& context) noexcept override
+   void revert(world::edit_context& context) noexcept override
    {
       assert(context.is_memory_valid(keys));
       assert(insert_before_index < keys->size());
 
       keys->erase(keys->begin() + insert_before_index);
+
+      context.mark_dirty(keys);
    }
 
    bool is_coalescable([[maybe_unused]] const edit& other) const noexcept override
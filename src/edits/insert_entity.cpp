@@ -21,6 +21,8 @@ struct add_object final : edit<world::edit_context> {
       objects.push_back(std::move(object));
       objects.back().class_handle =
          object_class_library.acquire(objects.back().class_name);
+
+      context.mark_dirty(&objects);
    }
 
    void revert(world::edit_context& context) noexcept override
@@ -31,6 +33,8 @@ struct add_object final : edit<world::edit_context> {
 
       object = std::move(objects.back());
       objects.pop_back();
+
+      context.mark_dirty(&objects);
    }
 
    bool is_coalescable([[maybe_unused]] const edit& other) const noexcept override
@@ -56,6 +60,8 @@ struct insert_entity final : edit<world::edit_context> {
       auto& entities = world::select_entities<T>(context.world);
 
       entities.push_back(_entity);
+
+      context.mark_dirty(&entities);
    }
 
    void revert(world::edit_context& context) noexcept override
@@ -63,6 +69,8 @@ struct insert_entity final : edit<world::edit_context> {
       auto& entities = world::select_entities<T>(context.world);
 
       entities.pop_back();
+
+      context.mark_dirty(&entities);
    }
 
    bool is_coalescable([[maybe_unused]] const edit& other) const noexcept override
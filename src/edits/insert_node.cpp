@@ -17,6 +17,8 @@ struct insert_path_node final : edit<world::edit_context> {
       auto& nodes = world::find_entity(context.world.paths, _id)->nodes;
 
       nodes.insert(nodes.begin() + _insert_before_index, _node);
+
+      context.mark_dirty(&nodes);
    }
 
    void revert(world::edit_context& context) noexcept override
@@ -24,6 +26,8 @@ struct insert_path_node final : edit<world::edit_context> {
       auto& nodes = world::find_entity(context.world.paths, _id)->nodes;
 
       nodes.erase(nodes.begin() + _insert_before_index);
+
+      context.mark_dirty(&nodes);
    }
 
    bool is_coalescable([[maybe_unused]] const edit& other) const noexcept override
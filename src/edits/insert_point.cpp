@@ -17,6 +17,8 @@ struct insert_sector_point final : edit<world::edit_context> {
       auto& points = world::find_entity(context.world.sectors, _id)->points;
 
       points.insert(points.begin() + _insert_before_index, _point);
+
+      context.mark_dirty(&points);
    }
 
    void revert(world::edit_context& context) noexcept override
@@ -24,6 +26,8 @@ struct insert_sector_point final : edit<world::edit_context> {
       auto& points = world::find_entity(context.world.sectors, _id)->points;
 
       points.erase(points.begin() + _insert_before_index);
+
+      context.mark_dirty(&points);
    }
 
    bool is_coalescable([[maybe_unused]] const edit& other) const noexcept override
@@ -98,6 +98,8 @@ private:
 
       std::swap(world.game_modes[index].name, name);
 
+      context.mark_dirty(&world.game_modes);
+
       if (req_entry) {
          assert(req_entry->list_index < world.requirements.size());
          assert(req_entry->entry_index <
@@ -105,6 +107,8 @@ private:
 
          std::swap(world.requirements[req_entry->list_index].entries[req_entry->entry_index],
                    req_entry->value);
+
+         context.mark_dirty(&world.requirements);
       }
    }
 
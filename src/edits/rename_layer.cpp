@@ -182,6 +182,8 @@ private:
 
       std::swap(world.layer_descriptions[index].name, name);
 
+      context.mark_dirty(&world.layer_descriptions);
+
       if (req_entry) {
          assert(req_entry->list_index < world.requirements.size());
          assert(req_entry->entry_index <
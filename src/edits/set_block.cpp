@@ -37,6 +37,8 @@ struct set_block_metrics final : edit<world::edit_context> {
       blocks.bbox.max_z[index] = bbox.max.z;
 
       blocks.dirty.add({index, index + 1});
+
+      context.mark_dirty(&context.world.blocks);
    }
 
    void revert(world::edit_context& context) noexcept override
@@ -95,6 +97,8 @@ struct set_block_quad_metrics final : edit<world::edit_context> {
       blocks.bbox.max_z[index] = bbox.max.z;
 
       blocks.dirty.add({index, index + 1});
+
+      context.mark_dirty(&context.world.blocks);
    }
 
    void revert(world::edit_context& context) noexcept override
@@ -166,6 +170,8 @@ struct set_block_custom_metrics final : edit<world::edit_context> {
       }
 
       blocks.dirty.add({index, index + 1});
+
+      context.mark_dirty(&context.world.blocks);
    }
 
    void revert(world::edit_context& context) noexcept override
@@ -212,7 +218,7 @@ struct set_block_box_surface final : edit<world::edit_context> {
    {
    }
 
-   void apply([[maybe_unused]] world::edit_context& context) noexcept override
+   void apply(world::edit_context& context) noexcept override
    {
       assert(context.is_memory_valid(dirt_tracker));
       assert(context.is_memory_valid(value_address));
@@ -220,6 +226,8 @@ struct set_block_box_surface final : edit<world::edit_context> {
       std::swap(*value_address, value);
 
       dirt_tracker->add({index, index + 1});
+
+      context.mark_dirty(&context.world.blocks);
    }
 
    void revert(world::edit_context& context) noexcept override
@@ -14,7 +14,7 @@ struct set_class_name final : edit<world::edit_context> {
    {
    }
 
-   void apply([[maybe_unused]] world::edit_context& context) noexcept override
+   void apply(world::edit_context& context) noexcept override
    {
       assert(context.is_memory_valid(object));
 
@@ -23,6 +23,8 @@ struct set_class_name final : edit<world::edit_context> {
       std::swap(object->class_name, class_name);
 
       object->class_handle = object_class_library.acquire(object->class_name);
+
+      context.mark_dirty(object);
    }
 
    void revert([[maybe_unused]] world::edit_context& context) noexcept override
@@ -32,6 +32,8 @@ struct set_terrain final : edit<world::edit_context> {
 
       context.world.terrain.water_map_dirty.add(
          {0, 0, test_terrain_length / 4, test_terrain_length / 4});
+
+      context.mark_dirty(&context.world.terrain);
    }
 
    void revert(world::edit_context& context) noexcept override
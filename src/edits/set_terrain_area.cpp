@@ -212,6 +212,8 @@ struct set_terrain_area : edit<world::edit_context>, Access {
 
          Access::mark_dirty(terrain, area.rect);
       }
+
+      context.mark_dirty(&terrain);
    }
 
    void revert(world::edit_context& context) noexcept override
@@ -17,7 +17,7 @@ struct set_tree_line_border_odf final : edit<world::edit_context> {
    {
    }
 
-   void apply([[maybe_unused]] world::edit_context& context) noexcept override
+   void apply(world::edit_context& context) noexcept override
    {
       assert(context.is_memory_valid(_odfs));
       assert(_index < _odfs->size());
@@ -28,6 +28,8 @@ struct set_tree_line_border_odf final : edit<world::edit_context> {
 
       (*_odfs)[_index].handle =
          _object_class_library.acquire(lowercase_string{(*_odfs)[_index].name});
+
+      context.mark_dirty(_odfs);
    }
 
    void revert(world::edit_context& context) noexcept override
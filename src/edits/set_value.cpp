@@ -58,20 +58,24 @@ struct set_path_node_property_value final : edit<world::edit_context> {
    {
    }
 
-   void apply([[maybe_unused]] world::edit_context& context) noexcept override
+   void apply(world::edit_context& context) noexcept override
    {
       assert(context.is_memory_valid(nodes));
       assert(node_index < nodes->size());
 
       std::swap((*nodes)[node_index].properties[property_index].value, value);
+
+      context.mark_dirty(nodes);
    }
 
-   void revert([[maybe_unused]] world::edit_context& context) noexcept override
+   void revert(world::edit_context& context) noexcept override
    {
       assert(context.is_memory_valid(nodes));
       assert(node_index < nodes->size());
 
       std::swap((*nodes)[node_index].properties[property_index].value, value);
+
+      context.mark_dirty(nodes);
    }
 
    bool is_coalescable(const edit& other_unknown) const noexcept override
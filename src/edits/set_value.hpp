@@ -8,6 +8,22 @@
 
 namespace we::edits {
 
+namespace detail {
+
+/// @brief Swap a value in the world and mark the files it is saved into as dirty. The files are marked both before
+/// and after the swap as the value may move its entity to another layer.
+template<typename T>
+inline void swap_value(world::edit_context& context, T* value_ptr, T& value) noexcept
+{
+   context.mark_dirty(value_ptr);
+
+   std::swap(*value_ptr, value);
+
+   context.mark_dirty(value_ptr);
+}
+
+}
+
 template<typename T>
 struct set_memory_value final : edit<world::edit_context> {
    set_memory_value(T* value_address, T new_value)
@@ -15,18 +31,18 @@ struct set_memory_value final : edit<world::edit_context> {
    {
    }
 
-   void apply([[maybe_unused]] world::edit_context& context) noexcept override
+   void apply(world::edit_context& context) noexcept override
    {
       assert(context.is_memory_valid(value_ptr));
 
-      std::swap(*value_ptr, value);
+      detail::swap_value(context, value_ptr, value);
    }
 
-   void revert([[maybe_unused]] world::edit_context& context) noexcept override
+   void revert(world::edit_context& context) noexcept override
    {
       assert(context.is_memory_valid(value_ptr));
 
-      std::swap(*value_ptr, value);
+      detail::swap_value(context, value_ptr, value);
    }
 
    bool is_coalescable(const edit& other_unknown) const noexcept override
@@ -80,18 +96,22 @@ struct set_vector_value final : edit<world::edit_context> {
    {
    }
 
-   void apply([[maybe_unused]] world::edit_context& context) noexcept override
+   void apply(world::edit_context& context) noexcept override
    {
       assert(context.is_memory_valid(vector_ptr));
 
       std::swap(*value_ptr(), value);
+
+      context.mark_dirty(vector_ptr);
    }
 
-   void revert([[maybe_unused]] world::edit_context& context) noexcept override
+   void revert(world::edit_context& context) noexcept override
    {
       assert(context.is_memory_valid(vector_ptr));
 
       std::swap(*value_ptr(), value);
+
+      context.mark_dirty(vector_ptr);
    }
 
    bool is_coalescable(const edit& other_unknown) const noexcept override
@@ -168,22 +188,22 @@ struct set_multi_value2 final : edit<world::edit_context> {
    {
    }
 
-   void apply([[maybe_unused]] world::edit_context& context) noexcept override
+   void apply(world::edit_context& context) noexcept override
    {
       assert(context.is_memory_valid(value1_ptr));
       assert(context.is_memory_valid(value2_ptr));
 
-      std::swap(*value1_ptr, value1);
-      std::swap(*value2_ptr, value2);
+      detail::swap_value(context, value1_ptr, value1);
+      detail::swap_value(context, value2_ptr, value2);
    }
 
-   void revert([[maybe_unused]] world::edit_context& context) noexcept override
+   void revert(world::edit_context& context) noexcept override
    {
       assert(context.is_memory_valid(value1_ptr));
       assert(context.is_memory_valid(value2_ptr));
 
-      std::swap(*value1_ptr, value1);
-      std::swap(*value2_ptr, value2);
+      detail::swap_value(context, value1_ptr, value1);
+      detail::swap_value(context, value2_ptr, value2);
    }
 
    bool is_coalescable(const edit& other_unknown) const noexcept override
@@ -227,26 +247,26 @@ struct set_multi_value3 final : edit<world::edit_context> {
    {
    }
 
-   void apply([[maybe_unused]] world::edit_context& context) noexcept override
+   void apply(world::edit_context& context) noexcept override
    {
       assert(context.is_memory_valid(value1_ptr));
       assert(context.is_memory_valid(value2_ptr));
       assert(context.is_memory_valid(value3_ptr));
 
-      std::swap(*value1_ptr, value1);
-      std::swap(*value2_ptr, value2);
-      std::swap(*value3_ptr, value3);
+      detail::swap_value(context, value1_ptr, value1);
+      detail::swap_value(context, value2_ptr, value2);
+      detail::swap_value(context, value3_ptr, value3);
    }
 
-   void revert([[maybe_unused]] world::edit_context& context) noexcept override
+   void revert(world::edit_context& context) noexcept override
    {
       assert(context.is_memory_valid(value1_ptr));
       assert(context.is_memory_valid(value2_ptr));
       assert(context.is_memory_valid(value3_ptr));
 
-      std::swap(*value1_ptr, value1);
-      std::swap(*value2_ptr, value2);
-      std::swap(*value3_ptr, value3);
+      detail::swap_value(context, value1_ptr, value1);
+      detail::swap_value(context, value2_ptr, value2);
+      detail::swap_value(context, value3_ptr, value3);
    }
 
    bool is_coalescable(const edit& other_unknown) const noexcept override
@@ -297,20 +317,20 @@ struct set_multi_value4 final : edit<world::edit_context> {
    {
    }
 
-   void apply([[maybe_unused]] world::edit_context& context) noexcept override
+   void apply(world::edit_context& context) noexcept override
    {
       assert(context.is_memory_valid(value1_ptr));
       assert(context.is_memory_valid(value2_ptr));
       assert(context.is_memory_valid(value3_ptr));
       assert(context.is_memory_valid(value4_ptr));
 
-      std::swap(*value1_ptr, value1);
-      std::swap(*value2_ptr, value2);
-      std::swap(*value3_ptr, value3);
-      std::swap(*value4_ptr, value4);
+      detail::swap_value(context, value1_ptr, value1);
+      detail::swap_value(context, value2_ptr, value2);
+      detail::swap_value(context, value3_ptr, value3);
+      detail::swap_value(context, value4_ptr, value4);
    }
 
-   void revert([[maybe_unused]] world::edit_context& context) noexcept override
+   void revert(world::edit_context& context) noexcept override
    {
       apply(context);
    }
@@ -370,7 +390,7 @@ struct set_multi_value5 final : edit<world::edit_context> {
    {
    }
 
-   void apply([[maybe_unused]] world::edit_context& context) noexcept override
+   void apply(world::edit_context& context) noexcept override
    {
       assert(context.is_memory_valid(value1_ptr));
       assert(context.is_memory_valid(value2_ptr));
@@ -378,14 +398,14 @@ struct set_multi_value5 final : edit<world::edit_context> {
       assert(context.is_memory_valid(value4_ptr));
       assert(context.is_memory_valid(value5_ptr));
 
-      std::swap(*value1_ptr, value1);
-      std::swap(*value2_ptr, value2);
-      std::swap(*value3_ptr, value3);
-      std::swap(*value4_ptr, value4);
-      std::swap(*value5_ptr, value5);
+      detail::swap_value(context, value1_ptr, value1);
+      detail::swap_value(context, value2_ptr, value2);
+      detail::swap_value(context, value3_ptr, value3);
+      detail::swap_value(context, value4_ptr, value4);
+      detail::swap_value(context, value5_ptr, value5);
    }
 
-   void revert([[maybe_unused]] world::edit_context& context) noexcept override
+   void revert(world::edit_context& context) noexcept override
    {
       apply(context);
    }
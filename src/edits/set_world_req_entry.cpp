@@ -16,6 +16,8 @@ struct set_world_req_entry final : edit<world::edit_context> {
       assert(entry_index < context.world.requirements[list_index].entries.size());
 
       std::swap(context.world.requirements[list_index].entries[entry_index], value);
+
+      context.mark_dirty(&context.world.requirements);
    }
 
    void revert(world::edit_context& context) noexcept override
@@ -24,6 +26,8 @@ struct set_world_req_entry final : edit<world::edit_context> {
       assert(entry_index < context.world.requirements[list_index].entries.size());
 
       std::swap(context.world.requirements[list_index].entries[entry_index], value);
+
+      context.mark_dirty(&context.world.requirements);
    }
 
    bool is_coalescable(const edit& other_unknown) const noexcept override
@@ -118,8 +118,21 @@ memory_mapped_file::memory_mapped_file(const memory_mapped_file_params& params)
          map_os_open_error_code(system_error)};
    }
 
+   LARGE_INTEGER mapped_size = file_size;
+
+   if (params.size == 0 and not GetFileSizeEx(file.get(), &mapped_size)) {
+      const DWORD system_error = GetLastError();
+
+      throw open_error{
+         fmt::format(
+            "Failed to get size of file '{}'.\n   Reason: {}",
+            params.path.string_view(),
+            std::system_category().default_error_condition(system_error).message()),
+         map_os_open_error_code(system_error)};
+   }
+
    _bytes = static_cast<std::byte*>(mapped_view.release());
-   _size = file_size.QuadPart;
+   _size = mapped_size.QuadPart;
    _mapping_handle = file_mapping.release();
    _file_handle = file.release();
    _map_mode = params.map_mode;
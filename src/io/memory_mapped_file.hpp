@@ -19,7 +19,7 @@ struct memory_mapped_file_params {
    const path& path;
    /// @brief Map mode/page protection for the file.
    const map_mode map_mode = map_mode::read_write;
-   /// @brief Size to map in, if the file is smaller than this it will be extended.
+   /// @brief Size to map in, if the file is smaller than this it will be extended. 0 maps in the whole file.
    const std::size_t size = 0;
    /// @brief Truncate the file to size if it is bigger than size.
    bool truncate_to_size = false;
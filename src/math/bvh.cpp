@@ -1,37 +1,35 @@
 #include "bvh.hpp"
 #include "bounding_box.hpp"
+#include "dynamic_aabb_tree.hpp"
 #include "frustum.hpp"
 #include "intersectors.hpp"
 #include "quaternion_funcs.hpp"
+#include "simd_intersectors.hpp"
 #include "vector_funcs.hpp"
 
+#include "async/thread_pool.hpp"
+
+#include <algorithm>
 #include <bit>
 #include <cassert>
+#include <cmath>
+#include <cstring>
+#include <optional>
+#include <utility>
 #include <vector>
 
-#ifdef _M_X64
-#define WE_BVH_X64
-
-#ifdef __AVX__
-#define WE_BVH_AVX
-#else
-#define WE_BVH_SSE2
-#endif
-
-#else
-#define WE_BVH_SCALAR
-#endif
-
-#ifdef WE_BVH_X64
-#include <immintrin.h>
-#endif
-
 namespace we {
 
 namespace {
 
 constexpr int32 simd_alignment = 16;
 constexpr int32 split_bin_count = 8;
+constexpr int32 parallel_build_min_tris = 16384;
+constexpr int32 parallel_build_min_instances = 1024;
+constexpr uint32 serialized_bvh_version = 2;
+constexpr float refit_max_cost_growth = 2.0f;
+
+using float_x4 = math::simd::native_float4;
 
 bool check_indices_in_range(std::span<const std::array<uint16, 3>> indices,
                             std::span<const float3> positions) noexcept
@@ -61,170 +59,181 @@ auto area(const math::bounding_box& bbox) noexcept -> float
    return extents.x * extents.y + extents.y * extents.z + extents.z * extents.x;
 }
 
-#ifdef WE_BVH_X64
-
-#ifdef WE_BVH_SSE2
-#define _mm_broadcast_ss _mm_load1_ps
-#endif
-
-[[msvc::forceinline]] auto __vectorcall intersect_aabb(
-   const __m128 ray_origin_x,        //
-   const __m128 ray_origin_y,        //
-   const __m128 ray_origin_z,        //
-   const __m128 inv_ray_direction_x, //
-   const __m128 inv_ray_direction_y, //
-   const __m128 inv_ray_direction_z, //
-   const __m128 bbox_min_x,          //
-   const __m128 bbox_min_y,          //
-   const __m128 bbox_min_z,          //
-   const __m128 bbox_max_x,          //
-   const __m128 bbox_max_y,          //
-   const __m128 bbox_max_z,          //
-   const __m128 t_limit,             //
-   __m128& t) noexcept -> int
-{
-   const __m128 ts0_x =
-      _mm_mul_ps(_mm_sub_ps(bbox_min_x, ray_origin_x), inv_ray_direction_x);
-   const __m128 ts0_y =
-      _mm_mul_ps(_mm_sub_ps(bbox_min_y, ray_origin_y), inv_ray_direction_y);
-   const __m128 ts0_z =
-      _mm_mul_ps(_mm_sub_ps(bbox_min_z, ray_origin_z), inv_ray_direction_z);
+struct serialized_bvh_header {
+   uint32 version = serialized_bvh_version;
+   uint32 node_layout = 0;
+   uint32 node_size = 0;
+   uint32 node_count = 0;
+   uint32 triangle_count = 0;
+};
 
-   const __m128 ts1_x =
-      _mm_mul_ps(_mm_sub_ps(bbox_max_x, ray_origin_x), inv_ray_direction_x);
-   const __m128 ts1_y =
-      _mm_mul_ps(_mm_sub_ps(bbox_max_y, ray_origin_y), inv_ray_direction_y);
-   const __m128 ts1_z =
-      _mm_mul_ps(_mm_sub_ps(bbox_max_z, ray_origin_z), inv_ray_direction_z);
+/// @brief A child of a packed node which has been left for a parallel build to subdivide.
+struct deferred_child {
+   int32 packed_index = 0;
+   int32 lane = 0;
+};
+
+/// @brief Get how many nodes to build serially before a parallel build splits off the subtrees below them.
+auto parallel_build_top_node_count(const async::thread_pool& thread_pool,
+                                   const async::task_priority priority) noexcept
+   -> std::size_t
+{
+   // Each node deferring 4 children gives several subtrees per thread to balance between them.
+   return std::max(thread_pool.thread_count(priority) * 2, std::size_t{1});
+}
 
-   const __m128 ts_min_x = _mm_min_ps(ts0_x, ts1_x);
-   const __m128 ts_min_y = _mm_min_ps(ts0_y, ts1_y);
-   const __m128 ts_min_z = _mm_min_ps(ts0_z, ts1_z);
+using float_xn = math::simd::native_float;
+
+/// @brief The bounds of a SIMD vector's worth of boxes.
+template<typename V>
+struct simd_bounding_box {
+   V min_x;
+   V min_y;
+   V min_z;
+   V max_x;
+   V max_y;
+   V max_z;
+};
 
-   const __m128 ts_max_x = _mm_max_ps(ts0_x, ts1_x);
-   const __m128 ts_max_y = _mm_max_ps(ts0_y, ts1_y);
-   const __m128 ts_max_z = _mm_max_ps(ts0_z, ts1_z);
+/// @brief Get the squared distance from a point to each box, 0 for boxes containing the point.
+template<typename V>
+auto distance_sq(const simd_bounding_box<V>& bbox, const float3& point) noexcept -> V
+{
+   using namespace math::simd;
 
-   const __m128 t_min = _mm_max_ps(_mm_max_ps(ts_min_x, ts_min_y), ts_min_z);
-   const __m128 t_max =
-      _mm_min_ps(_mm_min_ps(_mm_min_ps(ts_max_x, ts_max_y), ts_max_z), t_limit);
+   const V point_x = V::broadcast(point.x);
+   const V point_y = V::broadcast(point.y);
+   const V point_z = V::broadcast(point.z);
 
-   const __m128 hit_mask = _mm_cmple_ps(t_min, t_max);
+   const V zero = V::zero();
 
-   t = t_min;
+   const V distance_x = max(max(sub(bbox.min_x, point_x), sub(point_x, bbox.max_x)), zero);
+   const V distance_y = max(max(sub(bbox.min_y, point_y), sub(point_y, bbox.max_y)), zero);
+   const V distance_z = max(max(sub(bbox.min_z, point_z), sub(point_z, bbox.max_z)), zero);
 
-   return _mm_movemask_ps(hit_mask);
+   return add(add(mul(distance_x, distance_x), mul(distance_y, distance_y)),
+              mul(distance_z, distance_z));
 }
 
-[[msvc::forceinline]] auto __vectorcall inside_plane(const __m128 plane_x, //
-                                                     const __m128 plane_y, //
-                                                     const __m128 plane_z, //
-                                                     const __m128 plane_w, //
-                                                     const __m128 point_x, //
-                                                     const __m128 point_y, //
-                                                     const __m128 point_z) noexcept -> __m128
+/// @brief Test each box for overlap with another box.
+/// @return A mask of the boxes that overlap other.
+template<typename V>
+auto overlaps_bbox(const simd_bounding_box<V>& bbox, const math::bounding_box& other) noexcept
+   -> int
 {
-   const __m128 x = _mm_mul_ps(plane_x, point_x);
-   const __m128 y = _mm_mul_ps(plane_y, point_y);
-   const __m128 z = _mm_mul_ps(plane_z, point_z);
+   using namespace math::simd;
+
+   const V overlaps_x = mask_and(cmp_le(bbox.min_x, V::broadcast(other.max.x)),
+                                 cmp_ge(bbox.max_x, V::broadcast(other.min.x)));
+   const V overlaps_y = mask_and(cmp_le(bbox.min_y, V::broadcast(other.max.y)),
+                                 cmp_ge(bbox.max_y, V::broadcast(other.min.y)));
+   const V overlaps_z = mask_and(cmp_le(bbox.min_z, V::broadcast(other.max.z)),
+                                 cmp_ge(bbox.max_z, V::broadcast(other.min.z)));
+
+   return movemask(mask_and(mask_and(overlaps_x, overlaps_y), overlaps_z));
+}
 
-   const __m128 xy_sum = _mm_add_ps(x, y);
-   const __m128 zw_sum = _mm_add_ps(z, plane_w);
+/// @brief Get the squared distance from a point to a box, 0 if the box contains the point.
+auto distance_sq(const math::bounding_box& bbox, const float3& point) noexcept -> float
+{
+   const float3 distance = max(max(bbox.min - point, point - bbox.max), float3{});
 
-   const __m128 plane_distance = _mm_add_ps(xy_sum, zw_sum);
+   return dot(distance, distance);
+}
 
-   return _mm_cmpge_ps(plane_distance, _mm_setzero_ps());
+bool overlaps_bbox(const math::bounding_box& bbox, const math::bounding_box& other) noexcept
+{
+   return bbox.min.x <= other.max.x and bbox.max.x >= other.min.x and
+          bbox.min.y <= other.max.y and bbox.max.y >= other.min.y and
+          bbox.min.z <= other.max.z and bbox.max.z >= other.min.z;
 }
 
-[[msvc::forceinline]] auto __vectorcall inside_corners(
-   const frustum& frustum, const float float3::* axis,
-   const __m128 bbox_corner_min, const __m128 bbox_corner_max) noexcept -> __m128
+/// @brief Test if a triangle overlaps an oriented box.
+bool intersects_oriented_box_tri(const bvh::oriented_box& box, const quaternion& inverse_rotation,
+                                 const float3& v0, const float3& v1, const float3& v2) noexcept
 {
-   __m128 inside_min_mask = _mm_setzero_ps();
-   __m128 inside_max_mask = inside_min_mask;
+   return intersects_aabb_tri(box.bbox, inverse_rotation * (v0 - box.position),
+                              inverse_rotation * (v1 - box.position),
+                              inverse_rotation * (v2 - box.position));
+}
+
+constexpr int32 packet_width = float_xn::width;
+
+/// @brief Rays traced together through a BVH, one ray per SIMD lane.
+struct ray_packet {
+   alignas(32) std::array<float, packet_width> origin_x;
+   alignas(32) std::array<float, packet_width> origin_y;
+   alignas(32) std::array<float, packet_width> origin_z;
+
+   alignas(32) std::array<float, packet_width> direction_x;
+   alignas(32) std::array<float, packet_width> direction_y;
+   alignas(32) std::array<float, packet_width> direction_z;
 
-   for (const float3& frustum_corner : frustum.corners) {
-      const __m128 corner = _mm_broadcast_ss(&(frustum_corner.*axis));
+   alignas(32) std::array<float, packet_width> inv_direction_x;
+   alignas(32) std::array<float, packet_width> inv_direction_y;
+   alignas(32) std::array<float, packet_width> inv_direction_z;
 
-      const __m128 min_inside = _mm_cmpge_ps(corner, bbox_corner_min);
-      const __m128 max_inside = _mm_cmple_ps(corner, bbox_corner_max);
+   /// @brief Distance to the closest hit found so far for each ray.
+   alignas(32) std::array<float, packet_width> closest_hit;
 
-      inside_min_mask = _mm_or_ps(inside_min_mask, min_inside);
-      inside_max_mask = _mm_or_ps(inside_max_mask, max_inside);
+   /// @brief Mask of the rays still being traced.
+   int active_mask = 0;
+
+   void set_ray(const int32 index, const float3& origin, const float3& direction,
+                const float max_distance) noexcept
+   {
+      const float3 inv_direction = 1.0f / direction;
+
+      origin_x[index] = origin.x;
+      origin_y[index] = origin.y;
+      origin_z[index] = origin.z;
+
+      direction_x[index] = direction.x;
+      direction_y[index] = direction.y;
+      direction_z[index] = direction.z;
+
+      inv_direction_x[index] = inv_direction.x;
+      inv_direction_y[index] = inv_direction.y;
+      inv_direction_z[index] = inv_direction.z;
+
+      closest_hit[index] = max_distance;
    }
 
-   return _mm_and_ps(inside_min_mask, inside_max_mask);
-}
+   auto origin(const int32 index) const noexcept -> float3
+   {
+      return {origin_x[index], origin_y[index], origin_z[index]};
+   }
+
+   auto direction(const int32 index) const noexcept -> float3
+   {
+      return {direction_x[index], direction_y[index], direction_z[index]};
+   }
+};
 
-[[msvc::forceinline]] auto __vectorcall intersects_frustum(
-   const frustum& frustum,  //
-   const __m128 bbox_min_x, //
-   const __m128 bbox_min_y, //
-   const __m128 bbox_min_z, //
-   const __m128 bbox_max_x, //
-   const __m128 bbox_max_y, //
-   const __m128 bbox_max_z) noexcept -> int
+/// @brief Make a packet from up to packet_width rays. Unused lanes repeat the first ray and are left inactive.
+auto make_ray_packet(std::span<const bvh::ray> rays) noexcept -> ray_packet
 {
-   int intersects = 0b1111;
-
-   for (const auto& plane : frustum.planes) {
-      const __m128 plane_x = _mm_broadcast_ss(&plane.x);
-      const __m128 plane_y = _mm_broadcast_ss(&plane.y);
-      const __m128 plane_z = _mm_broadcast_ss(&plane.z);
-      const __m128 plane_w = _mm_broadcast_ss(&plane.w);
-
-      __m128 inside_mask = inside_plane(plane_x, plane_y, plane_z, plane_w,
-                                        bbox_min_x, bbox_min_y, bbox_min_z);
-      inside_mask = _mm_or_ps(inside_plane(plane_x, plane_y, plane_z, plane_w,
-                                           bbox_max_x, bbox_min_y, bbox_min_z),
-                              inside_mask);
-      inside_mask = _mm_or_ps(inside_plane(plane_x, plane_y, plane_z, plane_w,
-                                           bbox_min_x, bbox_max_y, bbox_min_z),
-                              inside_mask);
-      inside_mask = _mm_or_ps(inside_plane(plane_x, plane_y, plane_z, plane_w,
-                                           bbox_max_x, bbox_max_y, bbox_min_z),
-                              inside_mask);
-      inside_mask = _mm_or_ps(inside_plane(plane_x, plane_y, plane_z, plane_w,
-                                           bbox_min_x, bbox_min_y, bbox_max_z),
-                              inside_mask);
-      inside_mask = _mm_or_ps(inside_plane(plane_x, plane_y, plane_z, plane_w,
-                                           bbox_max_x, bbox_min_y, bbox_max_z),
-                              inside_mask);
-      inside_mask = _mm_or_ps(inside_plane(plane_x, plane_y, plane_z, plane_w,
-                                           bbox_min_x, bbox_max_y, bbox_max_z),
-                              inside_mask);
-      inside_mask = _mm_or_ps(inside_plane(plane_x, plane_y, plane_z, plane_w,
-                                           bbox_max_x, bbox_max_y, bbox_max_z),
-                              inside_mask);
-
-      intersects &= _mm_movemask_ps(inside_mask);
-
-      if (intersects == 0) return 0;
-   }
-
-   intersects &=
-      _mm_movemask_ps(inside_corners(frustum, &float3::x, bbox_min_x, bbox_max_x));
-
-   if (intersects == 0) return 0;
-
-   intersects &=
-      _mm_movemask_ps(inside_corners(frustum, &float3::y, bbox_min_y, bbox_max_y));
-
-   if (intersects == 0) return 0;
-
-   intersects &=
-      _mm_movemask_ps(inside_corners(frustum, &float3::z, bbox_min_z, bbox_max_z));
-
-   return intersects;
-}
+   assert(not rays.empty() and rays.size() <= packet_width);
+
+   ray_packet packet;
+
+   for (int32 i = 0; i < packet_width; ++i) {
+      const bvh::ray& ray = i < std::ssize(rays) ? rays[i] : rays[0];
 
-#endif
+      packet.set_ray(i, ray.origin, ray.direction, ray.max_distance);
+   }
+
+   packet.active_mask = (1 << rays.size()) - 1;
+
+   return packet;
+}
 
 }
 
 struct detail::bvh_impl {
    bvh_impl(std::span<const std::array<uint16, 3>> indices,
-            std::span<const float3> positions, bvh_flags flags) noexcept
+            std::span<const float3> positions, bvh_flags flags,
+            async::thread_pool* thread_pool, const async::task_priority priority) noexcept
       : _indices{indices},
         _positions{positions},
         _no_backface_cull{not flags.backface_cull}
@@ -251,45 +260,14 @@ struct detail::bvh_impl {
 
       update_node_bounds(root_node);
 
-      if (std::optional<node_packed_x4> subdivided_root = subdivide(root_node, centroids);
-          subdivided_root) {
-         _nodes.push_back(*subdivided_root);
-
-         int32 nodes_used = 1;
-
-         for (int32 packed_index = 0; packed_index < nodes_used; ++packed_index) {
-            for (int32 i = 0; i < 4; ++i) {
-               node_packed_x4& packed = _nodes[packed_index];
-
-               leaf_node child_node = {
-                  .bbox = {.min = {packed.bbox.min_x[i], packed.bbox.min_y[i],
-                                   packed.bbox.min_z[i]},
-
-                           .max = {packed.bbox.max_x[i], packed.bbox.max_y[i],
-                                   packed.bbox.max_z[i]}},
-
-                  .first_tri = packed.children_or_first_tri[i],
-                  .tri_count = packed.tri_count[i],
-               };
-
-               update_node_bounds(child_node);
-
-               if (std::optional<node_packed_x4> subdivided =
-                      subdivide(child_node, centroids);
-                   subdivided) {
-                  const int32 child_index = nodes_used;
-
-                  _nodes.push_back(*subdivided);
-
-                  packed.children_or_first_tri[i] = child_index;
-                  packed.tri_count[i] = 0;
-
-                  nodes_used += 1;
-               }
-            }
-         }
+      if (thread_pool and root_node.tri_count >= parallel_build_min_tris) {
+         build_nodes_parallel(root_node, centroids, *thread_pool, priority);
       }
       else {
+         build_nodes(root_node, centroids, _nodes);
+      }
+
+      if (_nodes.empty()) {
          _nodes.push_back(
             {.bbox =
                 {
@@ -300,10 +278,20 @@ struct detail::bvh_impl {
                    .max_y = {root_node.bbox.max.y},
                    .max_z = {root_node.bbox.max.z},
                 },
-             .tri_count = {static_cast<int32>(indices.size()), -1, -1, -1}});
+             .tri_count = {indices.empty() ? -1 : static_cast<int32>(indices.size()), -1,
+                           -1, -1}});
       }
 
-      _nodes.shrink_to_fit();
+      if (flags.compressed) {
+         _compressed_nodes = compress_nodes(_nodes);
+         _compressed_nodes.shrink_to_fit();
+         _nodes = std::vector<node_packed_x4>{};
+      }
+      else {
+         _nodes.shrink_to_fit();
+      }
+
+      _build_cost = calculate_tree_cost();
    }
 
    bvh_impl(const bvh_impl&) = delete;
@@ -312,59 +300,58 @@ struct detail::bvh_impl {
    bvh_impl(bvh_impl&&) noexcept = delete;
    auto operator=(bvh_impl&&) -> bvh_impl& = delete;
 
-#ifdef WE_BVH_X64
+   /// @brief Call fn with a span of whichever node layout the BVH was built with.
+   template<typename Fn>
+   auto visit_nodes(Fn&& fn) const noexcept -> decltype(auto)
+   {
+      if (not _compressed_nodes.empty()) {
+         return fn(std::span<const node_compressed_x8>{_compressed_nodes});
+      }
+
+      return fn(std::span<const node_packed_x4>{_nodes});
+   }
+
    [[nodiscard]] auto raycast(const float3& ray_origin,
                               const float3& ray_direction, const float max_distance,
                               const bvh_ray_flags flags) const noexcept
       -> std::optional<bvh::ray_hit>
    {
-      const float3 inv_ray_direction = 1.0f / ray_direction;
-
-      const __m128 ray_origin_x = _mm_broadcast_ss(&ray_origin.x);
-      const __m128 ray_origin_y = _mm_broadcast_ss(&ray_origin.y);
-      const __m128 ray_origin_z = _mm_broadcast_ss(&ray_origin.z);
+      return visit_nodes([&](const auto nodes) {
+         return raycast_nodes(nodes, ray_origin, ray_direction, max_distance, flags);
+      });
+   }
 
-      const __m128 inv_ray_direction_x = _mm_broadcast_ss(&inv_ray_direction.x);
-      const __m128 inv_ray_direction_y = _mm_broadcast_ss(&inv_ray_direction.y);
-      const __m128 inv_ray_direction_z = _mm_broadcast_ss(&inv_ray_direction.z);
+   template<typename Node>
+   [[nodiscard]] auto raycast_nodes(std::span<const Node> nodes, const float3& ray_origin,
+                                    const float3& ray_direction, const float max_distance,
+                                    const bvh_ray_flags flags) const noexcept
+      -> std::optional<bvh::ray_hit>
+   {
+      const float3 inv_ray_direction = 1.0f / ray_direction;
 
-      std::array<int32, 64> stack = {
+      std::array<int32, traversal_stack_size> stack = {
          _root_node_index,
       };
       int32 stack_ptr = 0;
 
-      __m128 closest_hit = _mm_broadcast_ss(&max_distance);
+      float closest_hit = max_distance;
       float3 hit_normal = {};
       uint32 hit_mesh_tri_index = 0;
 
       while (stack_ptr >= 0) {
-         const node_packed_x4& node = _nodes[stack[stack_ptr]];
+         const Node& node = nodes[stack[stack_ptr]];
 
          stack_ptr -= 1;
 
-         __m128 hit_distance;
-
          const int hit_mask =
-            intersect_aabb(ray_origin_x, ray_origin_y, ray_origin_z,
-                           inv_ray_direction_x, inv_ray_direction_y,
-                           inv_ray_direction_z, _mm_load_ps(node.bbox.min_x.data()),
-                           _mm_load_ps(node.bbox.min_y.data()),
-                           _mm_load_ps(node.bbox.min_z.data()),
-                           _mm_load_ps(node.bbox.max_x.data()),
-                           _mm_load_ps(node.bbox.max_y.data()),
-                           _mm_load_ps(node.bbox.max_z.data()), closest_hit,
-                           hit_distance);
+            intersect_node(ray_origin, inv_ray_direction, node, closest_hit);
 
          if (hit_mask) {
-            alignas(__m128) std::array<float, 4> hits;
-
-            _mm_store_ps(hits.data(), hit_distance);
-
             // TODO: Sort by hit distance.
 
-            for (int lane_index = 0; lane_index < std::ssize(node.tri_count);
-                 ++lane_index) {
-               if (not(hit_mask & (1 << lane_index))) continue;
+            for (uint32 lanes = static_cast<uint32>(hit_mask); lanes != 0;
+                 lanes &= lanes - 1) {
+               const int lane_index = std::countr_zero(lanes);
 
                const bool is_leaf = node.tri_count[lane_index] != 0;
 
@@ -381,14 +368,10 @@ struct detail::bvh_impl {
                      const float3& v1 = _positions[tri[1]];
                      const float3& v2 = _positions[tri[2]];
 
-                     float closest_hit_scalar;
-
-                     _mm_store_ss(&closest_hit_scalar, closest_hit);
-
                      [[msvc::forceinline_calls]] //
                      if (float hit = 0.0f;
                          intersect_tri(ray_origin, ray_direction, v0, v1, v2, hit) and
-                         hit < closest_hit_scalar) {
+                         hit < closest_hit) {
 
                         const float3 normal = cross(v1 - v0, v2 - v0);
 
@@ -398,7 +381,7 @@ struct detail::bvh_impl {
                            continue;
                         }
 
-                        closest_hit = _mm_broadcast_ss(&hit);
+                        closest_hit = hit;
                         hit_normal = normal;
                         hit_mesh_tri_index = _triangles[tri_index];
 
@@ -420,41 +403,185 @@ struct detail::bvh_impl {
          }
       }
 
-      float closest_hit_scalar;
-
-      _mm_store_ss(&closest_hit_scalar, closest_hit);
-
-      return closest_hit_scalar < max_distance
-                ? std::optional{bvh::ray_hit{.distance = closest_hit_scalar,
+      return closest_hit < max_distance
+                ? std::optional{bvh::ray_hit{.distance = closest_hit,
                                              .unnormalized_normal = hit_normal,
                                              .tri_index = hit_mesh_tri_index}}
                 : std::nullopt;
    }
 
+   /// @brief Trace a packet of rays. For each ray that hits closest_hit is updated and the hit's
+   /// normal and triangle are written out.
+   /// @return A mask of the rays that hit.
+   auto raycast_packet(ray_packet& packet, const bvh_ray_flags flags,
+                       std::array<float3, packet_width>& hit_normals,
+                       std::array<uint32, packet_width>& hit_mesh_tri_indices) const noexcept
+      -> int
+   {
+      return visit_nodes([&](const auto nodes) {
+         return raycast_packet_nodes(nodes, packet, flags, hit_normals,
+                                     hit_mesh_tri_indices);
+      });
+   }
+
+   template<typename Node>
+   auto raycast_packet_nodes(std::span<const Node> nodes, ray_packet& packet,
+                             const bvh_ray_flags flags,
+                             std::array<float3, packet_width>& hit_normals,
+                             std::array<uint32, packet_width>& hit_mesh_tri_indices)
+      const noexcept -> int
+   {
+      const float_xn ray_origin_x = float_xn::load(packet.origin_x.data());
+      const float_xn ray_origin_y = float_xn::load(packet.origin_y.data());
+      const float_xn ray_origin_z = float_xn::load(packet.origin_z.data());
+
+      const float_xn inv_ray_direction_x = float_xn::load(packet.inv_direction_x.data());
+      const float_xn inv_ray_direction_y = float_xn::load(packet.inv_direction_y.data());
+      const float_xn inv_ray_direction_z = float_xn::load(packet.inv_direction_z.data());
+
+      std::array<int32, traversal_stack_size> stack = {
+         _root_node_index,
+      };
+      int32 stack_ptr = 0;
+
+      int hit_rays = 0;
+
+      while (stack_ptr >= 0 and packet.active_mask != 0) {
+         const auto& node = decode_node(nodes[stack[stack_ptr]]);
+
+         stack_ptr -= 1;
+
+         for (int lane_index = 0; lane_index < std::ssize(node.tri_count);
+              ++lane_index) {
+            float_xn hit_distance;
+
+            const int hit_mask =
+               math::simd::intersect_aabb(
+                  ray_origin_x, ray_origin_y, ray_origin_z, inv_ray_direction_x,
+                  inv_ray_direction_y, inv_ray_direction_z,
+                  float_xn::broadcast(node.bbox.min_x[lane_index]),
+                  float_xn::broadcast(node.bbox.min_y[lane_index]),
+                  float_xn::broadcast(node.bbox.min_z[lane_index]),
+                  float_xn::broadcast(node.bbox.max_x[lane_index]),
+                  float_xn::broadcast(node.bbox.max_y[lane_index]),
+                  float_xn::broadcast(node.bbox.max_z[lane_index]),
+                  float_xn::load(packet.closest_hit.data()), hit_distance) &
+               packet.active_mask;
+
+            if (not hit_mask) continue;
+
+            const bool is_leaf = node.tri_count[lane_index] != 0;
+
+            if (is_leaf) {
+               const int32 last_tri =
+                  node.children_or_first_tri[lane_index] + node.tri_count[lane_index];
+
+               for (int32 tri_index = node.children_or_first_tri[lane_index];
+                    tri_index < last_tri; ++tri_index) {
+                  const std::array<uint16, 3>& tri = _indices[_triangles[tri_index]];
+
+                  const float3& v0 = _positions[tri[0]];
+                  const float3& v1 = _positions[tri[1]];
+                  const float3& v2 = _positions[tri[2]];
+
+                  for (unsigned int ray_mask = hit_mask & packet.active_mask;
+                       ray_mask != 0; ray_mask &= ray_mask - 1) {
+                     const int32 ray_index = std::countr_zero(ray_mask);
+
+                     const float3 ray_direction = packet.direction(ray_index);
+
+                     if (float hit = 0.0f;
+                         intersect_tri(packet.origin(ray_index), ray_direction, v0,
+                                       v1, v2, hit) and
+                         hit < packet.closest_hit[ray_index]) {
+                        const float3 normal = cross(v1 - v0, v2 - v0);
+
+                        if (flags.allow_backface_cull and
+                            dot(-ray_direction, normal) < 0.0f and not _no_backface_cull) {
+                           continue;
+                        }
+
+                        packet.closest_hit[ray_index] = hit;
+                        hit_normals[ray_index] = normal;
+                        hit_mesh_tri_indices[ray_index] = _triangles[tri_index];
+
+                        hit_rays |= 1 << ray_index;
+
+                        if (flags.accept_first_hit) {
+                           packet.active_mask &= ~(1 << ray_index);
+                        }
+                     }
+                  }
+               }
+            }
+            else {
+               stack_ptr += 1;
+
+               stack[stack_ptr] = node.children_or_first_tri[lane_index];
+            }
+         }
+      }
+
+      return hit_rays;
+   }
+
+   void raycast_batch(std::span<const bvh::ray> rays,
+                      std::span<std::optional<bvh::ray_hit>> out_hits,
+                      const bvh_ray_flags flags) const noexcept
+   {
+      for (std::size_t first_ray = 0; first_ray < rays.size();
+           first_ray += packet_width) {
+         const std::span<const bvh::ray> packet_rays =
+            rays.subspan(first_ray, std::min(rays.size() - first_ray,
+                                             std::size_t{packet_width}));
+
+         ray_packet packet = make_ray_packet(packet_rays);
+         std::array<float3, packet_width> hit_normals;
+         std::array<uint32, packet_width> hit_mesh_tri_indices;
+
+         const int hit_rays =
+            raycast_packet(packet, flags, hit_normals, hit_mesh_tri_indices);
+
+         for (int32 i = 0; i < std::ssize(packet_rays); ++i) {
+            if (hit_rays & (1 << i)) {
+               out_hits[first_ray + i] =
+                  bvh::ray_hit{.distance = packet.closest_hit[i],
+                               .unnormalized_normal = hit_normals[i],
+                               .tri_index = hit_mesh_tri_indices[i]};
+            }
+            else {
+               out_hits[first_ray + i] = std::nullopt;
+            }
+         }
+      }
+   }
+
    [[nodiscard]] bool intersects(const frustum& frustum) const noexcept
    {
-      std::array<int32, 64> stack = {
+      return visit_nodes(
+         [&](const auto nodes) { return intersects_nodes(nodes, frustum); });
+   }
+
+   template<typename Node>
+   [[nodiscard]] bool intersects_nodes(std::span<const Node> nodes,
+                                       const frustum& frustum) const noexcept
+   {
+      std::array<int32, traversal_stack_size> stack = {
          _root_node_index,
       };
       int32 stack_ptr = 0;
 
       while (stack_ptr >= 0) {
-         const node_packed_x4& node = _nodes[stack[stack_ptr]];
+         const Node& node = nodes[stack[stack_ptr]];
 
          stack_ptr -= 1;
 
-         const int intersects_mask =
-            intersects_frustum(frustum, _mm_load_ps(node.bbox.min_x.data()),
-                               _mm_load_ps(node.bbox.min_y.data()),
-                               _mm_load_ps(node.bbox.min_z.data()),
-                               _mm_load_ps(node.bbox.max_x.data()),
-                               _mm_load_ps(node.bbox.max_y.data()),
-                               _mm_load_ps(node.bbox.max_z.data()));
+         const int intersects_mask = intersects_node(frustum, node);
 
          if (intersects_mask) {
-            for (int lane_index = 0; lane_index < std::ssize(node.tri_count);
-                 ++lane_index) {
-               if (not(intersects_mask & (1 << lane_index))) continue;
+            for (uint32 lanes = static_cast<uint32>(intersects_mask); lanes != 0;
+                 lanes &= lanes - 1) {
+               const int lane_index = std::countr_zero(lanes);
 
                const bool is_leaf = node.tri_count[lane_index] != 0;
 
@@ -624,337 +751,1108 @@ struct detail::bvh_impl {
 
       return false;
    }
-#elifdef WE_BVH_SCALAR
-   [[nodiscard]] auto raycast(const float3& ray_origin,
-                              const float3& ray_direction, const float max_distance,
-                              const bvh_ray_flags flags) const noexcept
-      -> std::optional<bvh::ray_hit>
+
+   [[nodiscard]] auto closest_point(const float3& point, const float max_distance) const noexcept
+      -> std::optional<bvh::point_hit>
    {
-      const float3 inv_ray_direction = 1.0f / ray_direction;
+      return visit_nodes([&](const auto nodes) {
+         return closest_point_nodes(nodes, point, max_distance);
+      });
+   }
 
-      std::array<int32, 64> stack = {
-         _root_node_index,
+   template<typename Node>
+   [[nodiscard]] auto closest_point_nodes(std::span<const Node> nodes, const float3& point,
+                                          const float max_distance) const noexcept
+      -> std::optional<bvh::point_hit>
+   {
+      struct stack_entry {
+         int32 node_index = 0;
+         float distance_sq = 0.0f;
+      };
+
+      std::array<stack_entry, traversal_stack_size> stack = {
+         stack_entry{.node_index = _root_node_index},
       };
       int32 stack_ptr = 0;
 
-      float closest_hit = max_distance;
-      float3 hit_normal = {};
-      uint32 hit_mesh_tri_index = 0;
+      float closest_distance_sq = max_distance * max_distance;
+      float3 closest_point = {};
+      uint32 closest_tri_index = 0;
 
       while (stack_ptr >= 0) {
-         const node_packed_x4& node = _nodes[stack[stack_ptr]];
+         const stack_entry entry = stack[stack_ptr];
 
          stack_ptr -= 1;
 
-         for (std::size_t lane_index = 0; lane_index < node.bbox.min_x.size();
-              ++lane_index) {
-            float hit_distance = 0.0f;
-
-            if (not intersect_aabb(
-                   ray_origin, inv_ray_direction,
-                   math::bounding_box{.min = {node.bbox.min_x[lane_index],
-                                              node.bbox.min_y[lane_index],
-                                              node.bbox.min_z[lane_index]},
-
-                                      .max = {node.bbox.max_x[lane_index],
-                                              node.bbox.max_y[lane_index],
-                                              node.bbox.max_z[lane_index]}},
-                   closest_hit, hit_distance)) {
-               continue;
-            }
+         if (entry.distance_sq >= closest_distance_sq) continue;
 
-            const bool is_leaf = node.tri_count[lane_index] != 0;
+         const Node& node = nodes[entry.node_index];
 
-            if (is_leaf) {
-               const int32 last_tri = node.children_or_first_tri[lane_index] +
-                                      node.tri_count[lane_index];
+         const std::array<float, node_width<Node>> distances_sq =
+            child_distances_sq(point, node);
 
-               for (int32 tri_index = node.children_or_first_tri[lane_index];
-                    tri_index < last_tri; ++tri_index) {
-                  const std::array<uint16, 3>& tri = _indices[_triangles[tri_index]];
+         // Children are visited nearest first so the closest point found so far can cull the
+         // children further away.
+         std::array<int32, node_width<Node>> lanes;
+         int32 lane_count = 0;
 
-                  const float3& v0 = _positions[tri[0]];
-                  const float3& v1 = _positions[tri[1]];
-                  const float3& v2 = _positions[tri[2]];
+         for (int32 lane = 0; lane < node_width<Node>; ++lane) {
+            if (node.tri_count[lane] < 0) continue;
+            if (distances_sq[lane] >= closest_distance_sq) continue;
+
+            int32 insert_index = lane_count++;
 
-                  [[msvc::forceinline_calls]] //
-                  if (float hit = 0.0f;
-                      intersect_tri(ray_origin, ray_direction, v0, v1, v2, hit) and
-                      hit < closest_hit) {
+            for (; insert_index > 0 and distances_sq[lanes[insert_index - 1]] >
+                                           distances_sq[lane];
+                 --insert_index) {
+               lanes[insert_index] = lanes[insert_index - 1];
+            }
 
-                     const float3 normal = cross(v1 - v0, v2 - v0);
+            lanes[insert_index] = lane;
+         }
 
-                     if (flags.allow_backface_cull and
-                         dot(-ray_direction, normal) < 0.0f and not _no_backface_cull) {
-                        continue;
-                     }
+         for (const int32 lane : std::span{lanes}.first(lane_count)) {
+            if (node.tri_count[lane] == 0 or distances_sq[lane] >= closest_distance_sq) {
+               continue;
+            }
 
-                     closest_hit = hit;
-                     hit_normal = normal;
-                     hit_mesh_tri_index = _triangles[tri_index];
+            const int32 last_tri = node.children_or_first_tri[lane] + node.tri_count[lane];
 
-                     if (flags.accept_first_hit) {
-                        return std::optional{
-                           bvh::ray_hit{.distance = hit,
-                                        .unnormalized_normal = hit_normal,
-                                        .tri_index = hit_mesh_tri_index}};
-                     }
-                  }
+            for (int32 tri_index = node.children_or_first_tri[lane]; tri_index < last_tri;
+                 ++tri_index) {
+               const std::array<uint16, 3>& tri = _indices[_triangles[tri_index]];
+
+               const float3 tri_point =
+                  closest_point_on_tri(point, _positions[tri[0]], _positions[tri[1]],
+                                       _positions[tri[2]]);
+               const float3 offset = tri_point - point;
+               const float tri_distance_sq = dot(offset, offset);
+
+               if (tri_distance_sq < closest_distance_sq) {
+                  closest_distance_sq = tri_distance_sq;
+                  closest_point = tri_point;
+                  closest_tri_index = _triangles[tri_index];
                }
             }
-            else {
-               stack_ptr += 1;
+         }
 
-               stack[stack_ptr] = node.children_or_first_tri[lane_index];
-            }
+         // Pushed furthest first so the nearest child is visited next.
+         for (int32 i = lane_count - 1; i >= 0; --i) {
+            const int32 lane = lanes[i];
+
+            if (node.tri_count[lane] != 0) continue;
+
+            stack_ptr += 1;
+
+            stack[stack_ptr] = {.node_index = node.children_or_first_tri[lane],
+                                .distance_sq = distances_sq[lane]};
          }
       }
 
-      return closest_hit < max_distance
-                ? std::optional{bvh::ray_hit{.distance = closest_hit,
-                                             .unnormalized_normal = hit_normal,
-                                             .tri_index = hit_mesh_tri_index}}
-                : std::nullopt;
+      if (closest_distance_sq >= max_distance * max_distance) return std::nullopt;
+
+      return bvh::point_hit{.point = closest_point,
+                            .distance = std::sqrt(closest_distance_sq),
+                            .tri_index = closest_tri_index};
    }
 
-   [[nodiscard]] bool intersects(const frustum& frustum) const noexcept
+   void overlaps(const bvh::sphere& sphere, std::vector<uint32>& out_tris) const noexcept
    {
-      std::array<int32, 64> stack = {
+      const float radius_sq = sphere.radius * sphere.radius;
+
+      visit_nodes([&](const auto nodes) {
+         for_each_overlapping_tri(
+            nodes,
+            [&](const auto& node) {
+               const auto distances_sq = child_distances_sq(sphere.position, node);
+
+               int mask = 0;
+
+               for (int32 lane = 0; lane < std::ssize(distances_sq); ++lane) {
+                  if (distances_sq[lane] <= radius_sq) mask |= 1 << lane;
+               }
+
+               return mask;
+            },
+            [&](const float3& v0, const float3& v1, const float3& v2) {
+               const float3 offset = closest_point_on_tri(sphere.position, v0, v1, v2) -
+                                     sphere.position;
+
+               return dot(offset, offset) <= radius_sq;
+            },
+            out_tris);
+      });
+   }
+
+   void overlaps(const bvh::oriented_box& box, std::vector<uint32>& out_tris) const noexcept
+   {
+      const math::bounding_box bbox = box.rotation * box.bbox + box.position;
+      const quaternion inverse_rotation = conjugate(box.rotation);
+
+      visit_nodes([&](const auto nodes) {
+         for_each_overlapping_tri(
+            nodes, [&](const auto& node) { return child_overlaps(bbox, node); },
+            [&](const float3& v0, const float3& v1, const float3& v2) {
+               return intersects_oriented_box_tri(box, inverse_rotation, v0, v1, v2);
+            },
+            out_tris);
+      });
+   }
+
+   /// @brief Traverse the BVH and append the index of every triangle that passes tri_test to
+   /// out_tris.
+   /// @param node_test Returns a mask of the children of a node to visit.
+   /// @param tri_test Returns if a triangle overlaps.
+   template<typename Node, typename Node_test, typename Tri_test>
+   void for_each_overlapping_tri(std::span<const Node> nodes, const Node_test& node_test,
+                                 const Tri_test& tri_test,
+                                 std::vector<uint32>& out_tris) const noexcept
+   {
+      std::array<int32, traversal_stack_size> stack = {
          _root_node_index,
       };
       int32 stack_ptr = 0;
 
       while (stack_ptr >= 0) {
-         const node_packed_x4& node = _nodes[stack[stack_ptr]];
+         const Node& node = nodes[stack[stack_ptr]];
 
          stack_ptr -= 1;
 
-         for (std::size_t lane_index = 0; lane_index < node.bbox.min_x.size();
-              ++lane_index) {
-            if (not we::intersects(
-                   frustum,
-                   math::bounding_box{.min = {node.bbox.min_x[lane_index],
-                                              node.bbox.min_y[lane_index],
-                                              node.bbox.min_z[lane_index]},
-
-                                      .max = {node.bbox.max_x[lane_index],
-                                              node.bbox.max_y[lane_index],
-                                              node.bbox.max_z[lane_index]}})) {
+         for (uint32 lanes = static_cast<uint32>(node_test(node)); lanes != 0;
+              lanes &= lanes - 1) {
+            const int lane_index = std::countr_zero(lanes);
+
+            if (node.tri_count[lane_index] < 0) continue;
+
+            if (node.tri_count[lane_index] == 0) {
+               stack_ptr += 1;
+
+               stack[stack_ptr] = node.children_or_first_tri[lane_index];
+
                continue;
             }
 
-            const bool is_leaf = node.tri_count[lane_index] != 0;
+            const int32 last_tri =
+               node.children_or_first_tri[lane_index] + node.tri_count[lane_index];
 
-            if (is_leaf) {
-               const int32 last_tri = node.children_or_first_tri[lane_index] +
-                                      node.tri_count[lane_index];
+            for (int32 tri_index = node.children_or_first_tri[lane_index];
+                 tri_index < last_tri; ++tri_index) {
+               const std::array<uint16, 3>& tri = _indices[_triangles[tri_index]];
 
-               for (int32 tri_index = node.children_or_first_tri[lane_index];
-                    tri_index < last_tri; ++tri_index) {
-                  const std::array<uint16, 3>& tri_indices =
-                     _indices[_triangles[tri_index]];
+               if (tri_test(_positions[tri[0]], _positions[tri[1]], _positions[tri[2]])) {
+                  out_tris.push_back(_triangles[tri_index]);
+               }
+            }
+         }
+      }
+   }
 
-                  // See comment under WE_BVH_X64 for an explaination of this code.
+   [[nodiscard]] auto get_debug_boxes() const noexcept -> std::vector<math::bounding_box>
+   {
+      return visit_nodes([&](const auto nodes) {
+         std::vector<math::bounding_box> boxes;
+         boxes.reserve(nodes.size() * 4);
 
-                  const float3& v0 = _positions[tri_indices[0]];
-                  const float3& v1 = _positions[tri_indices[1]];
-                  const float3& v2 = _positions[tri_indices[2]];
+         for (const auto& packed_node : nodes) {
+            const auto& node = decode_node(packed_node);
 
-                  if (we::intersects(frustum, v0, 0.0f) or
-                      we::intersects(frustum, v1, 0.0f) or
-                      we::intersects(frustum, v2, 0.0f)) {
-                     return true;
-                  }
+            for (int32 lane = 0; lane < std::ssize(node.tri_count); ++lane) {
+               if (node.tri_count[lane] < 0) continue;
 
-                  const std::array<float3, 3> tri_edge_vectors = {
-                     v1 - v0, // origin 0
-                     v2 - v1, // origin 1
-                     v0 - v2, // origin 2
-                  };
+               boxes.push_back(get_child_leaf(node, lane).bbox);
+            }
+         }
 
-                  const std::array<float, 3> tri_edge_lengths = {
-                     length(tri_edge_vectors[0]), // origin 0
-                     length(tri_edge_vectors[1]), // origin 1
-                     length(tri_edge_vectors[2]), // origin 2
-                  };
+         return boxes;
+      });
+   }
 
-                  const std::array<float3, 3> tri_edge_directions = {
-                     tri_edge_vectors[0] / tri_edge_lengths[0], // origin 0
-                     tri_edge_vectors[1] / tri_edge_lengths[1], // origin 1
-                     tri_edge_vectors[2] / tri_edge_lengths[2], // origin 2
-                  };
+   [[nodiscard]] auto get_bbox() const noexcept -> math::bounding_box
+   {
+      return visit_nodes([&](const auto nodes) {
+         return get_node_bbox(decode_node(nodes[_root_node_index]));
+      });
+   }
 
-                  // These don't all face out. But it doesn't matter for our use.
-                  constexpr static std::array<std::array<frustum_corner, 4>, 6> frustum_faces = {{
-                     // Near Face
-                     {frustum_corner::bottom_left_near, frustum_corner::top_left_near,
-                      frustum_corner::top_right_near, frustum_corner::bottom_right_near},
+   [[nodiscard]] auto get_tri_count() const noexcept -> std::size_t
+   {
+      return _triangles.size();
+   }
 
-                     // Far Face
-                     {frustum_corner::bottom_left_far, frustum_corner::top_left_far,
-                      frustum_corner::top_right_far, frustum_corner::bottom_right_far},
+   /// @brief Update the bounds of every node for new vertex positions. Nodes are visited in
+   /// reverse so children, which always come after their parents, are updated first. Which
+   /// triangles each leaf holds is left unchanged.
+   /// @return The cost of the refit tree relative to the cost of the tree when it was built.
+   [[nodiscard]] auto refit(std::span<const float3> positions) noexcept -> float
+   {
+      assert(check_indices_in_range(_indices, positions));
 
-                     // Left Face
-                     {frustum_corner::bottom_left_near, frustum_corner::top_left_near,
-                      frustum_corner::top_left_far, frustum_corner::bottom_left_far},
+      _positions = positions;
 
-                     // Right Face
-                     {frustum_corner::bottom_right_near, frustum_corner::top_right_near,
-                      frustum_corner::top_right_far, frustum_corner::bottom_right_far},
+      if (_compressed_nodes.empty()) {
+         refit_nodes(_nodes);
+      }
+      else {
+         refit_nodes(_compressed_nodes);
+      }
 
-                     // Top Face
-                     {frustum_corner::top_left_near, frustum_corner::top_left_far,
-                      frustum_corner::top_right_far, frustum_corner::top_right_near},
+      const float cost = calculate_tree_cost();
 
-                     // Bottom Face
-                     {frustum_corner::bottom_left_near, frustum_corner::bottom_left_far,
-                      frustum_corner::bottom_right_far, frustum_corner::bottom_right_near},
-                  }};
+      if (_build_cost == 0.0f) return cost == 0.0f ? 1.0f : FLT_MAX;
 
-                  const std::array<float3, 3> tri = {v0, v1, v2};
+      return cost / _build_cost;
+   }
 
-                  for (int32 edge_index = 0; edge_index < 3; ++edge_index) {
-                     for (const auto& [i0, i1, i2, i3] : frustum_faces) {
+   /// @brief Copy the BVH for a copy of the mesh it was built from.
+   [[nodiscard]] auto clone(std::span<const std::array<uint16, 3>> indices,
+                            std::span<const float3> positions) const noexcept
+      -> std::unique_ptr<bvh_impl>
+   {
+      assert(indices.size() == _indices.size());
+      assert(check_indices_in_range(indices, positions));
 
-                        if (float distance = FLT_MAX;
-                            intersect_tri(tri[edge_index], tri_edge_directions[edge_index],
-                                          frustum.corners[i0], frustum.corners[i1],
-                                          frustum.corners[i2], distance) and
-                            distance <= tri_edge_lengths[edge_index]) {
-                           return true;
-                        }
+      return std::unique_ptr<bvh_impl>{
+         new bvh_impl{indices, positions, {.backface_cull = not _no_backface_cull},
+                      _nodes, _compressed_nodes, _triangles}};
+   }
 
-                        if (float distance = FLT_MAX;
-                            intersect_tri(tri[edge_index], tri_edge_directions[edge_index],
-                                          frustum.corners[i2], frustum.corners[i3],
-                                          frustum.corners[i0], distance) and
-                            distance <= tri_edge_lengths[edge_index]) {
-                           return true;
-                        }
-                     }
+   /// @brief Get the memory used by the BVH's nodes and triangle list.
+   [[nodiscard]] auto memory_usage() const noexcept -> std::size_t
+   {
+      return sizeof(bvh_impl) + _nodes.capacity() * sizeof(node_packed_x4) +
+             _compressed_nodes.capacity() * sizeof(node_compressed_x8) +
+             _triangles.capacity() * sizeof(uint32);
+   }
+
+   [[nodiscard]] auto serialized_size() const noexcept -> std::size_t
+   {
+      return sizeof(serialized_bvh_header) +
+             visit_nodes([](const auto nodes) { return nodes.size_bytes(); }) +
+             std::span{_triangles}.size_bytes();
+   }
+
+   void serialize(std::span<std::byte> out) const noexcept
+   {
+      assert(out.size() == serialized_size());
+
+      std::byte* write_head = out.data() + sizeof(serialized_bvh_header);
+
+      const serialized_bvh_header header = visit_nodes([&](const auto nodes) {
+         using node_type = decltype(nodes)::value_type;
+
+         std::memcpy(write_head, nodes.data(), nodes.size_bytes());
+         write_head += nodes.size_bytes();
+
+         return serialized_bvh_header{
+            .node_layout = node_layout_of<node_type>,
+            .node_size = sizeof(node_type),
+            .node_count = static_cast<uint32>(nodes.size()),
+            .triangle_count = static_cast<uint32>(_triangles.size()),
+         };
+      });
+
+      std::memcpy(out.data(), &header, sizeof(header));
+
+      std::memcpy(write_head, _triangles.data(), std::span{_triangles}.size_bytes());
+   }
+
+   /// @brief Recreate a BVH from serialize's output. The nodes are checked to reference only
+   /// valid triangles and to only link forward to children, so a corrupt input can not be
+   /// traversed out of bounds or forever.
+   [[nodiscard]] static auto deserialize(std::span<const std::byte> bytes,
+                                         std::span<const std::array<uint16, 3>> indices,
+                                         std::span<const float3> positions,
+                                         bvh_flags flags) noexcept
+      -> std::unique_ptr<bvh_impl>
+   {
+      if (bytes.size() < sizeof(serialized_bvh_header)) return nullptr;
+
+      serialized_bvh_header header;
+
+      std::memcpy(&header, bytes.data(), sizeof(header));
+
+      if (header.version != serialized_bvh_version) return nullptr;
+      if (header.node_count == 0) return nullptr;
+      if (header.triangle_count != indices.size()) return nullptr;
+
+      const std::size_t nodes_size = std::size_t{header.node_count} * header.node_size;
+      const std::size_t triangles_size = header.triangle_count * sizeof(uint32);
+
+      if (bytes.size() != sizeof(header) + nodes_size + triangles_size) return nullptr;
+
+      std::vector<node_packed_x4> nodes;
+      std::vector<node_compressed_x8> compressed_nodes;
+
+      const std::span<const std::byte> nodes_bytes =
+         bytes.subspan(sizeof(header), nodes_size);
+
+      if (header.node_layout == node_layout_of<node_packed_x4>) {
+         if (not deserialize_nodes(nodes_bytes, header, nodes)) return nullptr;
+      }
+      else if (header.node_layout == node_layout_of<node_compressed_x8>) {
+         if (not deserialize_nodes(nodes_bytes, header, compressed_nodes)) return nullptr;
+      }
+      else {
+         return nullptr;
+      }
+
+      std::vector<uint32> triangles;
+      triangles.resize(header.triangle_count);
+
+      std::memcpy(triangles.data(), bytes.data() + sizeof(header) + nodes_size,
+                  triangles_size);
+
+      for (const uint32 tri_index : triangles) {
+         if (tri_index >= indices.size()) return nullptr;
+      }
+
+      if (not check_indices_in_range(indices, positions)) return nullptr;
+
+      return std::unique_ptr<bvh_impl>{
+         new bvh_impl{indices, positions, flags, std::move(nodes),
+                      std::move(compressed_nodes), std::move(triangles)}};
+   }
+
+private:
+   struct leaf_node {
+      math::bounding_box bbox;
+      int32 first_tri = 0;
+      int32 tri_count = 0;
+   };
+
+   template<int32 width>
+   struct bounding_box_xn {
+      alignas(width * sizeof(float)) std::array<float, width> min_x;
+      alignas(width * sizeof(float)) std::array<float, width> min_y;
+      alignas(width * sizeof(float)) std::array<float, width> min_z;
+      alignas(width * sizeof(float)) std::array<float, width> max_x;
+      alignas(width * sizeof(float)) std::array<float, width> max_y;
+      alignas(width * sizeof(float)) std::array<float, width> max_z;
+   };
+
+   /// @brief A node with full precision bounds for each of it's children. A child with a
+   /// tri_count of 0 is another node, a tri_count of -1 marks an unused child and anything else
+   /// is a leaf.
+   template<int32 width>
+   struct node_packed {
+      bounding_box_xn<width> bbox;
+      std::array<int32, width> children_or_first_tri = {};
+      std::array<int32, width> tri_count = {};
+   };
+
+   using bounding_box_x4 = bounding_box_xn<4>;
+   using node_packed_x4 = node_packed<4>;
+   using node_packed_x8 = node_packed<8>;
+
+   /// @brief An 8 wide node with it's children's bounds quantized to 8 bits relative to the
+   /// node's own bounds. Each axis has a power of two scale, stored as it's exponent, so the
+   /// quantized bounds can be decoded exactly and always contain the original bounds.
+   struct node_compressed_x8 {
+      float3 origin;
+      std::array<int8, 3> scale_exponent;
+      uint8 padding = 0;
+
+      std::array<uint8, 8> min_x;
+      std::array<uint8, 8> min_y;
+      std::array<uint8, 8> min_z;
+      std::array<uint8, 8> max_x;
+      std::array<uint8, 8> max_y;
+      std::array<uint8, 8> max_z;
+
+      std::array<int32, 8> children_or_first_tri = {};
+      std::array<int32, 8> tri_count = {};
+   };
+
+   static_assert(sizeof(node_packed_x4) == 128);
+   static_assert(sizeof(node_compressed_x8) == 128);
+
+   template<typename Node>
+   constexpr static int32 node_width = std::tuple_size_v<decltype(Node::tri_count)>;
+
+   template<typename Node>
+   constexpr static uint32 node_layout_of = std::same_as<Node, node_compressed_x8> ? 1 : 0;
+
+   constexpr static int32 traversal_stack_size = 128;
+
+   std::vector<node_packed_x4> _nodes;
+   std::vector<node_compressed_x8> _compressed_nodes;
+   std::vector<uint32> _triangles;
+   constexpr static int32 _root_node_index = 0;
+
+   std::span<const std::array<uint16, 3>> _indices;
+   std::span<const float3> _positions;
+
+   bool _no_backface_cull = false;
+
+   float _build_cost = 0.0f;
+
+   using float3_axis = float float3::*;
+
+   bvh_impl(std::span<const std::array<uint16, 3>> indices,
+            std::span<const float3> positions, bvh_flags flags,
+            std::vector<node_packed_x4> nodes,
+            std::vector<node_compressed_x8> compressed_nodes,
+            std::vector<uint32> triangles) noexcept
+      : _nodes{std::move(nodes)},
+        _compressed_nodes{std::move(compressed_nodes)},
+        _triangles{std::move(triangles)},
+        _indices{indices},
+        _positions{positions},
+        _no_backface_cull{not flags.backface_cull}
+   {
+      _build_cost = calculate_tree_cost();
+   }
+
+   static auto decode_node(const node_packed_x4& node) noexcept -> const node_packed_x4&
+   {
+      return node;
+   }
+
+   static auto get_scale(const int8 exponent) noexcept -> float
+   {
+      return std::bit_cast<float>(static_cast<uint32>(exponent + 127) << 23);
+   }
+
+   static auto dequantize(const float origin, const uint8 value, const float scale) noexcept
+      -> float
+   {
+      // value * scale is exact so this rounds the same with or without FMA contraction.
+      return origin + static_cast<float>(value) * scale;
+   }
+
+   static auto decode_node(const node_compressed_x8& node) noexcept -> node_packed_x8
+   {
+      const float scale_x = get_scale(node.scale_exponent[0]);
+      const float scale_y = get_scale(node.scale_exponent[1]);
+      const float scale_z = get_scale(node.scale_exponent[2]);
+
+      node_packed_x8 decoded{.children_or_first_tri = node.children_or_first_tri,
+                             .tri_count = node.tri_count};
+
+      for (int32 i = 0; i < 8; ++i) {
+         decoded.bbox.min_x[i] = dequantize(node.origin.x, node.min_x[i], scale_x);
+         decoded.bbox.min_y[i] = dequantize(node.origin.y, node.min_y[i], scale_y);
+         decoded.bbox.min_z[i] = dequantize(node.origin.z, node.min_z[i], scale_z);
+         decoded.bbox.max_x[i] = dequantize(node.origin.x, node.max_x[i], scale_x);
+         decoded.bbox.max_y[i] = dequantize(node.origin.y, node.max_y[i], scale_y);
+         decoded.bbox.max_z[i] = dequantize(node.origin.z, node.max_z[i], scale_z);
+      }
+
+      return decoded;
+   }
+
+   static auto encode_node(const node_packed_x4& node) noexcept -> node_packed_x4
+   {
+      return node;
+   }
+
+   /// @brief Pick the smallest power of two scale that lets 255 steps from origin reach max.
+   static auto choose_scale_exponent(const float origin, const float max) noexcept -> int8
+   {
+      int32 exponent = -126;
+
+      if (const float extent = max - origin; extent > 0.0f) {
+         std::frexp(extent / 255.0f, &exponent);
+
+         exponent = std::clamp(exponent, -126, 127);
+      }
+
+      while (exponent < 127 and
+             dequantize(origin, 255, get_scale(static_cast<int8>(exponent))) < max) {
+         exponent += 1;
+      }
+
+      return static_cast<int8>(exponent);
+   }
+
+   static auto quantize_min(const float origin, const float value, const float scale) noexcept
+      -> uint8
+   {
+      uint8 quantized =
+         static_cast<uint8>(std::clamp(std::floor((value - origin) / scale), 0.0f, 255.0f));
+
+      while (quantized > 0 and dequantize(origin, quantized, scale) > value) {
+         quantized -= 1;
+      }
+
+      return quantized;
+   }
+
+   static auto quantize_max(const float origin, const float value, const float scale) noexcept
+      -> uint8
+   {
+      uint8 quantized =
+         static_cast<uint8>(std::clamp(std::ceil((value - origin) / scale), 0.0f, 255.0f));
+
+      while (quantized < 255 and dequantize(origin, quantized, scale) < value) {
+         quantized += 1;
+      }
+
+      return quantized;
+   }
+
+   /// @brief Quantize a node's bounds. The decoded bounds of each child are rounded outwards so
+   /// they always contain the original bounds.
+   static auto encode_node(const node_packed_x8& node) noexcept -> node_compressed_x8
+   {
+      const math::bounding_box bbox = get_node_bbox(node);
+
+      node_compressed_x8 encoded{.origin = bbox.min,
+                                 .scale_exponent = {choose_scale_exponent(bbox.min.x,
+                                                                          bbox.max.x),
+                                                    choose_scale_exponent(bbox.min.y,
+                                                                          bbox.max.y),
+                                                    choose_scale_exponent(bbox.min.z,
+                                                                          bbox.max.z)},
+                                 .children_or_first_tri = node.children_or_first_tri,
+                                 .tri_count = node.tri_count};
+
+      const float scale_x = get_scale(encoded.scale_exponent[0]);
+      const float scale_y = get_scale(encoded.scale_exponent[1]);
+      const float scale_z = get_scale(encoded.scale_exponent[2]);
+
+      for (int32 i = 0; i < 8; ++i) {
+         if (node.tri_count[i] < 0) {
+            encoded.min_x[i] = encoded.min_y[i] = encoded.min_z[i] = 0;
+            encoded.max_x[i] = encoded.max_y[i] = encoded.max_z[i] = 0;
+
+            continue;
+         }
+
+         encoded.min_x[i] = quantize_min(encoded.origin.x, node.bbox.min_x[i], scale_x);
+         encoded.min_y[i] = quantize_min(encoded.origin.y, node.bbox.min_y[i], scale_y);
+         encoded.min_z[i] = quantize_min(encoded.origin.z, node.bbox.min_z[i], scale_z);
+         encoded.max_x[i] = quantize_max(encoded.origin.x, node.bbox.max_x[i], scale_x);
+         encoded.max_y[i] = quantize_max(encoded.origin.y, node.bbox.max_y[i], scale_y);
+         encoded.max_z[i] = quantize_max(encoded.origin.z, node.bbox.max_z[i], scale_z);
+      }
+
+      return encoded;
+   }
+
+   /// @brief Collapse a 4 wide tree into an 8 wide one. Each 8 wide node first pulls up the
+   /// children of it's largest inner children while they fit. The inner children left over are
+   /// then packed together so nearby subtrees share a node instead of each half filling one.
+   /// Nodes are emitted breadth first so children still come after their parents.
+   static auto compress_nodes(std::span<const node_packed_x4> nodes) noexcept
+      -> std::vector<node_compressed_x8>
+   {
+      // A lane with a tri_count of 0 refers to a node in nodes.
+      struct pending_node {
+         std::array<leaf_node, 8> lanes;
+         int32 lane_count = 0;
+         int32 compressed_index = 0;
+      };
+
+      const auto push_children = [&](pending_node& pending_node, const int32 node_index) {
+         const node_packed_x4& node = nodes[node_index];
+
+         for (int32 lane = 0; lane < 4; ++lane) {
+            if (node.tri_count[lane] < 0) continue;
+
+            pending_node.lanes[pending_node.lane_count++] = get_child_leaf(node, lane);
+         }
+      };
+
+      const auto child_count = [&](const int32 node_index) {
+         return static_cast<int32>(std::ranges::count_if(nodes[node_index].tri_count,
+                                                         [](const int32 count) {
+                                                            return count >= 0;
+                                                         }));
+      };
+
+      std::vector<node_compressed_x8> compressed_nodes;
+      compressed_nodes.reserve(nodes.size() / 2 + 1);
+      compressed_nodes.emplace_back();
+
+      std::vector<pending_node> pending(1);
+
+      push_children(pending[0], _root_node_index);
+
+      for (std::size_t pending_index = 0; pending_index < pending.size(); ++pending_index) {
+         pending_node current = pending[pending_index];
+
+         while (true) {
+            int32 expand_lane = -1;
+            float expand_area = -1.0f;
+
+            for (int32 lane = 0; lane < current.lane_count; ++lane) {
+               const leaf_node& child = current.lanes[lane];
+
+               if (child.tri_count != 0) continue;
+               if (current.lane_count - 1 + child_count(child.first_tri) > 8) continue;
+
+               if (const float child_area = area(child.bbox); child_area > expand_area) {
+                  expand_lane = lane;
+                  expand_area = child_area;
+               }
+            }
+
+            if (expand_lane < 0) break;
+
+            pending_node expanded{.compressed_index = current.compressed_index};
+
+            for (int32 lane = 0; lane < current.lane_count; ++lane) {
+               if (lane == expand_lane) {
+                  push_children(expanded, current.lanes[lane].first_tri);
+               }
+               else {
+                  expanded.lanes[expanded.lane_count++] = current.lanes[lane];
+               }
+            }
+
+            current = expanded;
+         }
+
+         node_packed_x8 node;
+         int32 node_lane_count = 0;
+
+         const auto push_lane = [&](const math::bounding_box& bbox, const int32 first,
+                                    const int32 count) {
+            const int32 lane = node_lane_count++;
+
+            node.bbox.min_x[lane] = bbox.min.x;
+            node.bbox.min_y[lane] = bbox.min.y;
+            node.bbox.min_z[lane] = bbox.min.z;
+            node.bbox.max_x[lane] = bbox.max.x;
+            node.bbox.max_y[lane] = bbox.max.y;
+            node.bbox.max_z[lane] = bbox.max.z;
+            node.children_or_first_tri[lane] = first;
+            node.tri_count[lane] = count;
+         };
+
+         // Inner children start in a group of their own. The pair of groups with the smallest
+         // combined area is then merged while their children fit in a single node.
+         struct group {
+            pending_node children;
+            math::bounding_box bbox;
+         };
+
+         std::array<group, 8> groups;
+         int32 group_count = 0;
+
+         for (int32 lane = 0; lane < current.lane_count; ++lane) {
+            const leaf_node& child = current.lanes[lane];
+
+            if (child.tri_count != 0) {
+               push_lane(child.bbox, child.first_tri, child.tri_count);
+
+               continue;
+            }
+
+            group& new_group = groups[group_count++];
+
+            new_group = {.bbox = child.bbox};
+
+            push_children(new_group.children, child.first_tri);
+         }
+
+         while (true) {
+            int32 merge_left = -1;
+            int32 merge_right = -1;
+            float merge_area = FLT_MAX;
+
+            for (int32 left = 0; left < group_count; ++left) {
+               for (int32 right = left + 1; right < group_count; ++right) {
+                  if (groups[left].children.lane_count + groups[right].children.lane_count >
+                      8) {
+                     continue;
                   }
 
-                  constexpr static std::array<std::array<frustum_corner, 2>, 12> frustum_edges = {{
-                     {frustum_corner::top_left_near, frustum_corner::top_left_far},
-                     {frustum_corner::top_left_far, frustum_corner::top_right_far},
-                     {frustum_corner::top_right_far, frustum_corner::top_right_near},
-                     {frustum_corner::top_right_near, frustum_corner::top_left_near},
-
-                     {frustum_corner::bottom_left_near, frustum_corner::bottom_left_far},
-                     {frustum_corner::bottom_left_far, frustum_corner::bottom_right_far},
-                     {frustum_corner::bottom_right_far, frustum_corner::bottom_right_near},
-                     {frustum_corner::bottom_right_near, frustum_corner::bottom_left_near},
-
-                     {frustum_corner::bottom_left_near, frustum_corner::top_left_near},
-                     {frustum_corner::bottom_left_far, frustum_corner::top_left_far},
-                     {frustum_corner::bottom_right_far, frustum_corner::top_right_far},
-                     {frustum_corner::bottom_right_near, frustum_corner::top_right_near},
-                  }};
-
-                  for (const auto& [i0, i1] : frustum_edges) {
-                     const float3 edge_vector =
-                        frustum.corners[i1] - frustum.corners[i0];
-                     const float edge_length = length(edge_vector);
-                     const float3 edge_direction = edge_vector / edge_length;
-
-                     if (float distance = FLT_MAX;
-                         intersect_tri(frustum.corners[i0], edge_direction, v0,
-                                       v1, v2, distance) and
-                         distance <= edge_length) {
-                        return true;
-                     }
+                  if (const float merged_area =
+                         area(combine(groups[left].bbox, groups[right].bbox));
+                      merged_area < merge_area) {
+                     merge_left = left;
+                     merge_right = right;
+                     merge_area = merged_area;
                   }
                }
             }
-            else {
-               stack_ptr += 1;
 
-               stack[stack_ptr] = node.children_or_first_tri[lane_index];
+            if (merge_left < 0) break;
+
+            group& left = groups[merge_left];
+            const group& right = groups[merge_right];
+
+            for (int32 i = 0; i < right.children.lane_count; ++i) {
+               left.children.lanes[left.children.lane_count++] = right.children.lanes[i];
             }
+
+            left.bbox = combine(left.bbox, right.bbox);
+
+            groups[merge_right] = groups[group_count - 1];
+            group_count -= 1;
          }
+
+         for (group& group : std::span{groups}.first(group_count)) {
+            group.children.compressed_index = static_cast<int32>(compressed_nodes.size());
+
+            compressed_nodes.emplace_back();
+            pending.push_back(group.children);
+
+            push_lane(group.bbox, group.children.compressed_index, 0);
+         }
+
+         for (int32 lane = node_lane_count; lane < 8; ++lane) {
+            node.bbox.min_x[lane] = node.bbox.min_y[lane] = node.bbox.min_z[lane] = 0.0f;
+            node.bbox.max_x[lane] = node.bbox.max_y[lane] = node.bbox.max_z[lane] = 0.0f;
+            node.children_or_first_tri[lane] = 0;
+            node.tri_count[lane] = -1;
+         }
+
+         compressed_nodes[current.compressed_index] = encode_node(node);
       }
 
-      return false;
+      return compressed_nodes;
    }
-#else
-#error Unknown BVH mode.
-#endif
 
-   [[nodiscard]] auto get_debug_boxes() const noexcept -> std::vector<math::bounding_box>
+   /// @brief Update the bounds of every node for the current positions. Nodes are visited in
+   /// reverse so children, which always come after their parents, are updated first.
+   template<typename Node>
+   void refit_nodes(std::vector<Node>& nodes) noexcept
    {
-      std::vector<math::bounding_box> boxes;
-      boxes.reserve(_nodes.size() * 4);
+      for (int32 node_index = static_cast<int32>(nodes.size()) - 1; node_index >= 0;
+           --node_index) {
+         auto node = decode_node(nodes[node_index]);
 
-      for (const node_packed_x4& node : _nodes) {
-         const bounding_box_x4& bbox = node.bbox;
+         for (int32 lane = 0; lane < std::ssize(node.tri_count); ++lane) {
+            math::bounding_box lane_bbox;
+
+            if (node.tri_count[lane] > 0) {
+               leaf_node leaf = get_child_leaf(node, lane);
+
+               update_node_bounds(leaf);
 
-         for (int32 i = 0; i < std::ssize(bbox.min_x); ++i) {
-            boxes.push_back({.min = {bbox.min_x[i], bbox.min_y[i], bbox.min_z[i]},
-                             .max = {bbox.max_x[i], bbox.max_y[i], bbox.max_z[i]}});
+               lane_bbox = leaf.bbox;
+            }
+            else if (node.tri_count[lane] == 0) {
+               lane_bbox =
+                  get_node_bbox(decode_node(nodes[node.children_or_first_tri[lane]]));
+            }
+            else {
+               continue;
+            }
+
+            node.bbox.min_x[lane] = lane_bbox.min.x;
+            node.bbox.min_y[lane] = lane_bbox.min.y;
+            node.bbox.min_z[lane] = lane_bbox.min.z;
+            node.bbox.max_x[lane] = lane_bbox.max.x;
+            node.bbox.max_y[lane] = lane_bbox.max.y;
+            node.bbox.max_z[lane] = lane_bbox.max.z;
          }
+
+         nodes[node_index] = encode_node(node);
       }
+   }
 
-      return boxes;
+   /// @brief Copy nodes out of serialized bytes and check they reference only valid triangles
+   /// and only link forward to children.
+   template<typename Node>
+   static bool deserialize_nodes(std::span<const std::byte> bytes,
+                                 const serialized_bvh_header& header,
+                                 std::vector<Node>& nodes) noexcept
+   {
+      if (header.node_size != sizeof(Node)) return false;
+
+      nodes.resize(header.node_count);
+
+      std::memcpy(nodes.data(), bytes.data(), std::span{nodes}.size_bytes());
+
+      const int32 triangle_count = static_cast<int32>(header.triangle_count);
+
+      for (int32 node_index = 0; node_index < std::ssize(nodes); ++node_index) {
+         const Node& node = nodes[node_index];
+
+         if constexpr (std::same_as<Node, node_compressed_x8>) {
+            for (const int8 exponent : node.scale_exponent) {
+               if (exponent < -126) return false;
+            }
+         }
+
+         for (int32 lane = 0; lane < std::ssize(node.tri_count); ++lane) {
+            const int32 first = node.children_or_first_tri[lane];
+            const int32 count = node.tri_count[lane];
+
+            if (count == 0) {
+               if (first <= node_index or first >= std::ssize(nodes)) return false;
+            }
+            else if (count > 0) {
+               if (first < 0 or first > triangle_count - count) return false;
+            }
+         }
+      }
+
+      return true;
    }
 
-   [[nodiscard]] auto get_bbox() const noexcept -> math::bounding_box
+   /// @brief Load the bounds of the children [first, first + float_v::width) of a node.
+   template<typename float_v, int32 width>
+   static auto load_child_bounds(const node_packed<width>& node, const int32 first) noexcept
+      -> simd_bounding_box<float_v>
    {
-      const bounding_box_x4& bbox = _nodes[_root_node_index].bbox;
+      return {.min_x = float_v::load(node.bbox.min_x.data() + first),
+              .min_y = float_v::load(node.bbox.min_y.data() + first),
+              .min_z = float_v::load(node.bbox.min_z.data() + first),
+              .max_x = float_v::load(node.bbox.max_x.data() + first),
+              .max_y = float_v::load(node.bbox.max_y.data() + first),
+              .max_z = float_v::load(node.bbox.max_z.data() + first)};
+   }
+
+   /// @brief Load and decode the bounds of the children [first, first + float_v::width) of a
+   /// node. Gives the same bounds as decode_node.
+   template<typename float_v>
+   static auto load_child_bounds(const node_compressed_x8& node, const int32 first) noexcept
+      -> simd_bounding_box<float_v>
+   {
+      using namespace math::simd;
+
+      const float_v origin_x = float_v::broadcast(node.origin.x);
+      const float_v origin_y = float_v::broadcast(node.origin.y);
+      const float_v origin_z = float_v::broadcast(node.origin.z);
+
+      const float_v scale_x = float_v::broadcast(get_scale(node.scale_exponent[0]));
+      const float_v scale_y = float_v::broadcast(get_scale(node.scale_exponent[1]));
+      const float_v scale_z = float_v::broadcast(get_scale(node.scale_exponent[2]));
+
+      const auto load_dequantized = [first](const std::array<uint8, 8>& values,
+                                            const float_v origin, const float_v scale) {
+         return add(origin, mul(float_v::load_uint8(values.data() + first), scale));
+      };
+
+      return {.min_x = load_dequantized(node.min_x, origin_x, scale_x),
+              .min_y = load_dequantized(node.min_y, origin_y, scale_y),
+              .min_z = load_dequantized(node.min_z, origin_z, scale_z),
+              .max_x = load_dequantized(node.max_x, origin_x, scale_x),
+              .max_y = load_dequantized(node.max_y, origin_y, scale_y),
+              .max_z = load_dequantized(node.max_z, origin_z, scale_z)};
+   }
+
+   /// @brief Get the squared distance from a point to each child's bounds.
+   template<typename Node>
+   static auto child_distances_sq(const float3& point, const Node& node) noexcept
+      -> std::array<float, node_width<Node>>
+   {
+      constexpr int32 width = node_width<Node>;
+
+      using float_v = std::conditional_t<width >= float_xn::width, float_xn, float_x4>;
+
+      alignas(float_v) std::array<float, width> distances_sq;
+
+      for (int32 i = 0; i < width; i += float_v::width) {
+         store(distances_sq.data() + i, distance_sq(load_child_bounds<float_v>(node, i), point));
+      }
+
+      return distances_sq;
+   }
+
+   /// @brief Test each child's bounds for overlap with a box.
+   /// @return A mask of the children that overlap the box.
+   template<typename Node>
+   static auto child_overlaps(const math::bounding_box& bbox, const Node& node) noexcept -> int
+   {
+      constexpr int32 width = node_width<Node>;
+
+      using float_v = std::conditional_t<width >= float_xn::width, float_xn, float_x4>;
+
+      int overlaps_mask = 0;
+
+      for (int32 i = 0; i < width; i += float_v::width) {
+         overlaps_mask |= overlaps_bbox(load_child_bounds<float_v>(node, i), bbox) << i;
+      }
+
+      return overlaps_mask;
+   }
+
+   /// @brief Intersect a ray against each child's bounds.
+   /// @return A mask of the children hit before t_limit.
+   template<typename Node>
+   static auto intersect_node(const float3& ray_origin, const float3& inv_ray_direction,
+                              const Node& node, const float t_limit) noexcept -> int
+   {
+      constexpr int32 width = node_width<Node>;
+
+      using float_v = std::conditional_t<width >= float_xn::width, float_xn, float_x4>;
+
+      const float_v ray_origin_x = float_v::broadcast(ray_origin.x);
+      const float_v ray_origin_y = float_v::broadcast(ray_origin.y);
+      const float_v ray_origin_z = float_v::broadcast(ray_origin.z);
+
+      const float_v inv_ray_direction_x = float_v::broadcast(inv_ray_direction.x);
+      const float_v inv_ray_direction_y = float_v::broadcast(inv_ray_direction.y);
+      const float_v inv_ray_direction_z = float_v::broadcast(inv_ray_direction.z);
+
+      const float_v t_limit_v = float_v::broadcast(t_limit);
+
+      int hit_mask = 0;
+
+      for (int32 i = 0; i < width; i += float_v::width) {
+         const simd_bounding_box<float_v> bbox = load_child_bounds<float_v>(node, i);
+
+         float_v hit_distance;
+
+         hit_mask |= math::simd::intersect_aabb(ray_origin_x, ray_origin_y, ray_origin_z,
+                                                inv_ray_direction_x, inv_ray_direction_y,
+                                                inv_ray_direction_z, bbox.min_x, bbox.min_y,
+                                                bbox.min_z, bbox.max_x, bbox.max_y,
+                                                bbox.max_z, t_limit_v, hit_distance)
+                     << i;
+      }
+
+      return hit_mask;
+   }
+
+   /// @brief Test each child's bounds against a frustum.
+   /// @return A mask of the children that intersect the frustum.
+   template<typename Node>
+   static auto intersects_node(const frustum& frustum, const Node& node) noexcept -> int
+   {
+      constexpr int32 width = node_width<Node>;
+
+      using float_v = std::conditional_t<width >= float_xn::width, float_xn, float_x4>;
+
+      int intersects_mask = 0;
+
+      for (int32 i = 0; i < width; i += float_v::width) {
+         const simd_bounding_box<float_v> bbox = load_child_bounds<float_v>(node, i);
+
+         intersects_mask |=
+            math::simd::intersects_frustum(frustum, bbox.min_x, bbox.min_y, bbox.min_z,
+                                           bbox.max_x, bbox.max_y, bbox.max_z)
+            << i;
+      }
+
+      return intersects_mask;
+   }
+
+   /// @brief Build the nodes for the subtree under root breadth first, appending them to nodes
+   /// with child indices relative to the start of nodes. Once nodes holds max_nodes the remaining
+   /// children are left as leaves and added to deferred_children instead of being subdivided.
+   void build_nodes(const leaf_node& root, std::span<const float3> centroids,
+                    std::vector<node_packed_x4>& nodes,
+                    const std::size_t max_nodes = SIZE_MAX,
+                    std::vector<deferred_child>* deferred_children = nullptr) noexcept
+   {
+      assert(nodes.empty());
+
+      std::optional<node_packed_x4> subdivided_root = subdivide(root, centroids);
+
+      if (not subdivided_root) return;
+
+      nodes.push_back(*subdivided_root);
+
+      for (int32 packed_index = 0; packed_index < std::ssize(nodes); ++packed_index) {
+         for (int32 i = 0; i < 4; ++i) {
+            if (nodes.size() >= max_nodes) {
+               assert(deferred_children);
+
+               deferred_children->push_back({.packed_index = packed_index, .lane = i});
+
+               continue;
+            }
+
+            leaf_node child_node = get_child_leaf(nodes[packed_index], i);
+
+            update_node_bounds(child_node);
+
+            if (std::optional<node_packed_x4> subdivided =
+                   subdivide(child_node, centroids);
+                subdivided) {
+               const int32 child_index = static_cast<int32>(nodes.size());
+
+               nodes.push_back(*subdivided);
+
+               nodes[packed_index].children_or_first_tri[i] = child_index;
+               nodes[packed_index].tri_count[i] = 0;
+            }
+         }
+      }
+   }
+
+   /// @brief Build the top of the tree serially and then the subtrees under it in parallel. Each
+   /// subtree owns a separate range of _triangles so they can be partitioned independently.
+   void build_nodes_parallel(const leaf_node& root, std::span<const float3> centroids,
+                             async::thread_pool& thread_pool,
+                             const async::task_priority priority) noexcept
+   {
+      std::vector<deferred_child> deferred_children;
+
+      build_nodes(root, centroids, _nodes,
+                  parallel_build_top_node_count(thread_pool, priority),
+                  &deferred_children);
+
+      std::vector<std::vector<node_packed_x4>> subtrees;
+      subtrees.resize(deferred_children.size());
+
+      thread_pool.for_each_n(priority, deferred_children.size(),
+                             [&](const std::size_t i) noexcept {
+                                const auto [packed_index, lane] = deferred_children[i];
+
+                                leaf_node child_node =
+                                   get_child_leaf(_nodes[packed_index], lane);
+
+                                update_node_bounds(child_node);
+
+                                build_nodes(child_node, centroids, subtrees[i]);
+                             });
+
+      for (std::size_t i = 0; i < deferred_children.size(); ++i) {
+         const auto [packed_index, lane] = deferred_children[i];
+         std::vector<node_packed_x4>& subtree = subtrees[i];
+
+         if (subtree.empty()) continue;
+
+         const int32 subtree_index = static_cast<int32>(_nodes.size());
 
-      const std::array<float, 4>& min_x = bbox.min_x;
-      const std::array<float, 4>& min_y = bbox.min_y;
-      const std::array<float, 4>& min_z = bbox.min_z;
-      const std::array<float, 4>& max_x = bbox.max_x;
-      const std::array<float, 4>& max_y = bbox.max_y;
-      const std::array<float, 4>& max_z = bbox.max_z;
+         for (node_packed_x4& node : subtree) {
+            for (int32 subtree_lane = 0; subtree_lane < 4; ++subtree_lane) {
+               if (node.tri_count[subtree_lane] != 0) continue;
 
-      return {
-         .min = {std::min(std::min(std::min(min_x[0], min_x[1]), min_x[2]), min_x[3]),
-                 std::min(std::min(std::min(min_y[0], min_y[1]), min_y[2]), min_y[3]),
-                 std::min(std::min(std::min(min_z[0], min_z[1]), min_z[2]), min_z[3])},
+               node.children_or_first_tri[subtree_lane] += subtree_index;
+            }
+         }
 
-         .max = {std::max(std::max(std::max(max_x[0], max_x[1]), max_x[2]), max_x[3]),
-                 std::max(std::max(std::max(max_y[0], max_y[1]), max_y[2]), max_y[3]),
-                 std::max(std::max(std::max(max_z[0], max_z[1]), max_z[2]), max_z[3])}};
-   }
+         _nodes[packed_index].children_or_first_tri[lane] = subtree_index;
+         _nodes[packed_index].tri_count[lane] = 0;
 
-   [[nodiscard]] auto get_tri_count() const noexcept -> std::size_t
-   {
-      return _triangles.size();
+         _nodes.append_range(subtree);
+      }
    }
 
-private:
-   struct leaf_node {
-      math::bounding_box bbox;
-      int32 first_tri = 0;
-      int32 tri_count = 0;
-   };
+   template<int32 width>
+   static auto get_child_leaf(const node_packed<width>& packed, const int32 lane) noexcept
+      -> leaf_node
+   {
+      return {
+         .bbox = {.min = {packed.bbox.min_x[lane], packed.bbox.min_y[lane],
+                          packed.bbox.min_z[lane]},
 
-   struct bounding_box_x4 {
-      alignas(simd_alignment) std::array<float, 4> min_x;
-      alignas(simd_alignment) std::array<float, 4> min_y;
-      alignas(simd_alignment) std::array<float, 4> min_z;
-      alignas(simd_alignment) std::array<float, 4> max_x;
-      alignas(simd_alignment) std::array<float, 4> max_y;
-      alignas(simd_alignment) std::array<float, 4> max_z;
-   };
+                  .max = {packed.bbox.max_x[lane], packed.bbox.max_y[lane],
+                          packed.bbox.max_z[lane]}},
 
-   struct node_packed_x4 {
-      bounding_box_x4 bbox;
-      std::array<int32, 4> children_or_first_tri = {};
-      std::array<int32, 4> tri_count = {};
-   };
+         .first_tri = packed.children_or_first_tri[lane],
+         .tri_count = packed.tri_count[lane],
+      };
+   }
 
-   std::vector<node_packed_x4> _nodes;
-   std::vector<uint32> _triangles;
-   constexpr static int32 _root_node_index = 0;
+   /// @brief Get the union of the bounds of a node's children.
+   template<int32 width>
+   [[nodiscard]] static auto get_node_bbox(const node_packed<width>& node) noexcept
+      -> math::bounding_box
+   {
+      math::bounding_box bbox = {.min = {FLT_MAX, FLT_MAX, FLT_MAX},
+                                 .max = {-FLT_MAX, -FLT_MAX, -FLT_MAX}};
 
-   std::span<const std::array<uint16, 3>> _indices;
-   std::span<const float3> _positions;
+      for (int32 lane = 0; lane < width; ++lane) {
+         if (node.tri_count[lane] < 0) continue;
 
-   bool _no_backface_cull = false;
+         bbox.min = min(bbox.min, float3{node.bbox.min_x[lane], node.bbox.min_y[lane],
+                                         node.bbox.min_z[lane]});
+         bbox.max = max(bbox.max, float3{node.bbox.max_x[lane], node.bbox.max_y[lane],
+                                         node.bbox.max_z[lane]});
+      }
 
-   using float3_axis = float float3::*;
+      return bbox;
+   }
 
    void update_node_bounds(leaf_node& node) noexcept
    {
@@ -1184,6 +2082,34 @@ private:
       return static_cast<float>(node.tri_count) * node_area;
    }
 
+   /// @brief Calculate the surface area cost of the whole tree, relative to the area of the root
+   /// so that uniformly scaling the mesh leaves the cost unchanged.
+   auto calculate_tree_cost() const noexcept -> float
+   {
+      const float root_area = area(get_bbox());
+
+      if (root_area <= 0.0f) return 0.0f;
+
+      return visit_nodes([&](const auto nodes) {
+         float cost = 0.0f;
+
+         for (const auto& packed_node : nodes) {
+            const auto& node = decode_node(packed_node);
+
+            for (int32 lane = 0; lane < std::ssize(node.tri_count); ++lane) {
+               if (node.tri_count[lane] < 0) continue;
+
+               const float lane_area = area(get_child_leaf(node, lane).bbox);
+
+               cost += node.tri_count[lane] > 0 ? lane_area * node.tri_count[lane]
+                                                : lane_area;
+            }
+         }
+
+         return cost / root_area;
+      });
+   }
+
    auto partition_split(const leaf_node& node, float3_axis split_axis,
                         float split_position,
                         std::span<const float3> centroids) noexcept -> int
@@ -1211,7 +2137,18 @@ bvh::bvh() noexcept {}
 bvh::bvh(std::span<const std::array<uint16, 3>> indices,
          std::span<const float3> positions, bvh_flags flags) noexcept
    : _impl{not indices.empty()
-              ? std::make_unique<detail::bvh_impl>(indices, positions, flags)
+              ? std::make_unique<detail::bvh_impl>(indices, positions, flags, nullptr,
+                                                   async::task_priority::normal)
+              : nullptr}
+{
+}
+
+bvh::bvh(std::span<const std::array<uint16, 3>> indices,
+         std::span<const float3> positions, bvh_flags flags,
+         async::thread_pool& thread_pool, const async::task_priority priority) noexcept
+   : _impl{not indices.empty()
+              ? std::make_unique<detail::bvh_impl>(indices, positions, flags,
+                                                   &thread_pool, priority)
               : nullptr}
 {
 }
@@ -1230,20 +2167,135 @@ auto bvh::raycast(const float3& ray_origin, const float3& ray_direction,
                 : std::nullopt;
 }
 
+void bvh::raycast_batch(std::span<const ray> rays,
+                        std::span<std::optional<ray_hit>> out_hits,
+                        const bvh_ray_flags flags) const noexcept
+{
+   assert(rays.size() == out_hits.size());
+
+   if (not _impl) {
+      std::ranges::fill(out_hits, std::nullopt);
+
+      return;
+   }
+
+   _impl->raycast_batch(rays, out_hits, flags);
+}
+
 bool bvh::intersects(const frustum& frustum) const noexcept
 {
    return _impl ? _impl->intersects(frustum) : false;
 }
 
+auto bvh::closest_point(const float3& point, const float max_distance) const noexcept
+   -> std::optional<point_hit>
+{
+   return _impl ? _impl->closest_point(point, max_distance) : std::nullopt;
+}
+
+auto bvh::overlaps(const sphere& sphere) const noexcept -> std::vector<uint32>
+{
+   std::vector<uint32> tris;
+
+   if (_impl) _impl->overlaps(sphere, tris);
+
+   return tris;
+}
+
+auto bvh::overlaps(const oriented_box& box) const noexcept -> std::vector<uint32>
+{
+   std::vector<uint32> tris;
+
+   if (_impl) _impl->overlaps(box, tris);
+
+   return tris;
+}
+
 auto bvh::get_debug_boxes() const noexcept -> std::vector<math::bounding_box>
 {
    return _impl ? _impl->get_debug_boxes() : std::vector<math::bounding_box>{};
 }
 
+bool bvh::refit(std::span<const float3> positions) noexcept
+{
+   if (not _impl) return true;
+
+   return _impl->refit(positions) <= refit_max_cost_growth;
+}
+
+auto bvh::copy(std::span<const std::array<uint16, 3>> indices,
+               std::span<const float3> positions) const noexcept -> bvh
+{
+   bvh bvh;
+
+   if (_impl) bvh._impl = _impl->clone(indices, positions);
+
+   return bvh;
+}
+
+auto bvh::memory_usage() const noexcept -> std::size_t
+{
+   return _impl ? _impl->memory_usage() : 0;
+}
+
+auto bvh::serialized_size() const noexcept -> std::size_t
+{
+   return _impl ? _impl->serialized_size() : sizeof(serialized_bvh_header);
+}
+
+void bvh::serialize(std::span<std::byte> out) const noexcept
+{
+   if (not _impl) {
+      assert(out.size() == sizeof(serialized_bvh_header));
+
+      const serialized_bvh_header header{};
+
+      std::memcpy(out.data(), &header, sizeof(header));
+
+      return;
+   }
+
+   _impl->serialize(out);
+}
+
+auto bvh::deserialize(std::span<const std::byte> bytes,
+                      std::span<const std::array<uint16, 3>> indices,
+                      std::span<const float3> positions, bvh_flags flags) noexcept
+   -> std::optional<bvh>
+{
+   if (indices.empty()) {
+      if (bytes.size() != sizeof(serialized_bvh_header)) return std::nullopt;
+
+      serialized_bvh_header header;
+
+      std::memcpy(&header, bytes.data(), sizeof(header));
+
+      if (header.version != serialized_bvh_version or header.node_count != 0 or
+          header.triangle_count != 0) {
+         return std::nullopt;
+      }
+
+      return bvh{};
+   }
+
+   std::unique_ptr<detail::bvh_impl> impl =
+      detail::bvh_impl::deserialize(bytes, indices, positions, flags);
+
+   if (not impl) return std::nullopt;
+
+   bvh bvh;
+
+   bvh._impl = std::move(impl);
+
+   return bvh;
+}
+
 struct detail::top_level_bvh_impl {
    using instance = top_level_bvh::instance;
 
-   explicit top_level_bvh_impl(std::span<const instance> instances) noexcept
+   top_level_bvh_impl(std::span<const instance> instances,
+                      async::thread_pool* thread_pool,
+                      const async::task_priority priority) noexcept
       : _instances{instances}
    {
       assert(check_instances(instances));
@@ -1271,45 +2323,14 @@ struct detail::top_level_bvh_impl {
 
       update_node_bounds(root_node);
 
-      if (std::optional<node_packed_x4> subdivided_root = subdivide(root_node, centroids);
-          subdivided_root) {
-         _nodes.push_back(*subdivided_root);
-
-         int32 nodes_used = 1;
-
-         for (int32 packed_index = 0; packed_index < nodes_used; ++packed_index) {
-            for (int32 i = 0; i < 4; ++i) {
-               node_packed_x4& packed = _nodes[packed_index];
-
-               leaf_node child_node = {
-                  .bbox = {.min = {packed.bbox.min_x[i], packed.bbox.min_y[i],
-                                   packed.bbox.min_z[i]},
-
-                           .max = {packed.bbox.max_x[i], packed.bbox.max_y[i],
-                                   packed.bbox.max_z[i]}},
-
-                  .first_instance = packed.children_or_first_instance[i],
-                  .instance_count = packed.instance_count[i],
-               };
-
-               update_node_bounds(child_node);
-
-               if (std::optional<node_packed_x4> subdivided =
-                      subdivide(child_node, centroids);
-                   subdivided) {
-                  const int32 child_index = nodes_used;
-
-                  _nodes.push_back(*subdivided);
-
-                  packed.children_or_first_instance[i] = child_index;
-                  packed.instance_count[i] = 0;
-
-                  nodes_used += 1;
-               }
-            }
-         }
+      if (thread_pool and root_node.instance_count >= parallel_build_min_instances) {
+         build_nodes_parallel(root_node, centroids, *thread_pool, priority);
       }
       else {
+         build_nodes(root_node, centroids, _nodes);
+      }
+
+      if (_nodes.empty()) {
          _nodes.push_back(
             {.bbox =
                 {
@@ -1332,7 +2353,6 @@ struct detail::top_level_bvh_impl {
    top_level_bvh_impl(top_level_bvh_impl&&) noexcept = delete;
    auto operator=(top_level_bvh_impl&&) -> top_level_bvh_impl& = delete;
 
-#ifdef WE_BVH_X64
    [[nodiscard]] auto raycast(const float3& ray_originWS,
                               const float3& ray_directionWS, const float max_distance,
                               const bvh_ray_flags flags) const noexcept
@@ -1340,44 +2360,39 @@ struct detail::top_level_bvh_impl {
    {
       const float3 inv_ray_directionWS = 1.0f / ray_directionWS;
 
-      const __m128 ray_originWS_x = _mm_broadcast_ss(&ray_originWS.x);
-      const __m128 ray_originWS_y = _mm_broadcast_ss(&ray_originWS.y);
-      const __m128 ray_originWS_z = _mm_broadcast_ss(&ray_originWS.z);
+      const float_x4 ray_originWS_x = float_x4::broadcast(ray_originWS.x);
+      const float_x4 ray_originWS_y = float_x4::broadcast(ray_originWS.y);
+      const float_x4 ray_originWS_z = float_x4::broadcast(ray_originWS.z);
 
-      const __m128 inv_ray_directionWS_x = _mm_broadcast_ss(&inv_ray_directionWS.x);
-      const __m128 inv_ray_directionWS_y = _mm_broadcast_ss(&inv_ray_directionWS.y);
-      const __m128 inv_ray_directionWS_z = _mm_broadcast_ss(&inv_ray_directionWS.z);
+      const float_x4 inv_ray_directionWS_x = float_x4::broadcast(inv_ray_directionWS.x);
+      const float_x4 inv_ray_directionWS_y = float_x4::broadcast(inv_ray_directionWS.y);
+      const float_x4 inv_ray_directionWS_z = float_x4::broadcast(inv_ray_directionWS.z);
 
       std::array<int32, 64> stack = {
          _root_node_index,
       };
       int32 stack_ptr = 0;
 
-      __m128 closest_hit = _mm_broadcast_ss(&max_distance);
+      float_x4 closest_hit = float_x4::broadcast(max_distance);
 
       while (stack_ptr >= 0) {
          const node_packed_x4& node = _nodes[stack[stack_ptr]];
 
          stack_ptr -= 1;
 
-         __m128 hit_distance;
+         float_x4 hit_distance;
 
-         const int hit_mask =
-            intersect_aabb(ray_originWS_x, ray_originWS_y, ray_originWS_z,
-                           inv_ray_directionWS_x, inv_ray_directionWS_y,
-                           inv_ray_directionWS_z, _mm_load_ps(node.bbox.min_x.data()),
-                           _mm_load_ps(node.bbox.min_y.data()),
-                           _mm_load_ps(node.bbox.min_z.data()),
-                           _mm_load_ps(node.bbox.max_x.data()),
-                           _mm_load_ps(node.bbox.max_y.data()),
-                           _mm_load_ps(node.bbox.max_z.data()), closest_hit,
-                           hit_distance);
+         const int hit_mask = math::simd::intersect_aabb(
+            ray_originWS_x, ray_originWS_y, ray_originWS_z, inv_ray_directionWS_x,
+            inv_ray_directionWS_y, inv_ray_directionWS_z,
+            float_x4::load(node.bbox.min_x.data()),
+            float_x4::load(node.bbox.min_y.data()),
+            float_x4::load(node.bbox.min_z.data()),
+            float_x4::load(node.bbox.max_x.data()),
+            float_x4::load(node.bbox.max_y.data()),
+            float_x4::load(node.bbox.max_z.data()), closest_hit, hit_distance);
 
          if (hit_mask) {
-            alignas(__m128) std::array<float, 4> hits;
-
-            _mm_store_ps(hits.data(), hit_distance);
-
             // TODO: Sort by hit distance.
 
             for (int lane_index = 0;
@@ -1401,15 +2416,13 @@ struct detail::top_level_bvh_impl {
                      const float3 ray_directionIS =
                         normalize(instance.inverse_rotation * ray_directionWS);
 
-                     float closest_hit_scalar;
-
-                     _mm_store_ss(&closest_hit_scalar, closest_hit);
+                     const float closest_hit_scalar = math::simd::first_lane(closest_hit);
 
                      if (std::optional<bvh::ray_hit> hit =
                             instance.bvh->raycast(ray_originIS, ray_directionIS,
                                                   closest_hit_scalar, flags);
                          hit) {
-                        closest_hit = _mm_broadcast_ss(&hit->distance);
+                        closest_hit = float_x4::broadcast(hit->distance);
 
                         if (flags.accept_first_hit) {
                            return std::optional{hit->distance};
@@ -1426,110 +2439,332 @@ struct detail::top_level_bvh_impl {
          }
       }
 
-      float closest_hit_scalar;
-
-      _mm_store_ss(&closest_hit_scalar, closest_hit);
+      const float closest_hit_scalar = math::simd::first_lane(closest_hit);
 
       return closest_hit_scalar < max_distance ? std::optional{closest_hit_scalar}
                                                : std::nullopt;
    }
-#elifdef WE_BVH_SCALAR
-   [[nodiscard]] auto raycast(const float3& ray_originWS,
-                              const float3& ray_directionWS, const float max_distance,
-                              const bvh_ray_flags flags) const noexcept
-      -> std::optional<float>
+
+   void raycast_batch(std::span<const bvh::ray> raysWS,
+                      std::span<std::optional<float>> out_hits,
+                      const bvh_ray_flags flags) const noexcept
    {
-      const float3 inv_ray_directionWS = 1.0f / ray_directionWS;
+      for (std::size_t first_ray = 0; first_ray < raysWS.size();
+           first_ray += packet_width) {
+         const std::span<const bvh::ray> packet_raysWS =
+            raysWS.subspan(first_ray, std::min(raysWS.size() - first_ray,
+                                               std::size_t{packet_width}));
+
+         ray_packet packetWS = make_ray_packet(packet_raysWS);
+
+         const int hit_rays = raycast_packet(packetWS, flags);
+
+         for (int32 i = 0; i < std::ssize(packet_raysWS); ++i) {
+            out_hits[first_ray + i] = (hit_rays & (1 << i))
+                                         ? std::optional{packetWS.closest_hit[i]}
+                                         : std::nullopt;
+         }
+      }
+   }
+
+   [[nodiscard]] auto closest_point(const float3& pointWS, const float max_distance) const noexcept
+      -> std::optional<top_level_bvh::point_hit>
+   {
+      if (_instances.empty()) return std::nullopt;
+
+      struct stack_entry {
+         int32 node_index = 0;
+         float distance_sq = 0.0f;
+      };
+
+      std::array<stack_entry, 64> stack = {
+         stack_entry{.node_index = _root_node_index},
+      };
+      int32 stack_ptr = 0;
+
+      std::optional<top_level_bvh::point_hit> closest_hit;
+      float closest_distance = max_distance;
+
+      while (stack_ptr >= 0) {
+         const stack_entry entry = stack[stack_ptr];
+
+         stack_ptr -= 1;
+
+         if (entry.distance_sq >= closest_distance * closest_distance) continue;
+
+         const node_packed_x4& node = _nodes[entry.node_index];
+
+         alignas(float_x4) std::array<float, 4> distances_sq;
+
+         store(distances_sq.data(), distance_sq(load_child_bounds(node), pointWS));
+
+         for (int32 lane = 0; lane < 4; ++lane) {
+            if (node.instance_count[lane] < 0) continue;
+            if (distances_sq[lane] >= closest_distance * closest_distance) continue;
+
+            if (node.instance_count[lane] == 0) {
+               stack_ptr += 1;
+
+               stack[stack_ptr] = {.node_index = node.children_or_first_instance[lane],
+                                   .distance_sq = distances_sq[lane]};
+
+               continue;
+            }
+
+            const int32 last_instance =
+               node.children_or_first_instance[lane] + node.instance_count[lane];
+
+            for (int32 instance_index = node.children_or_first_instance[lane];
+                 instance_index < last_instance; ++instance_index) {
+               const instance& instance = _instances[_index[instance_index]];
+
+               if (not instance.bvh->_impl) continue;
+
+               const float3 pointIS =
+                  instance.inverse_rotation * pointWS + instance.inverse_position;
+
+               if (std::optional<bvh::point_hit> hit =
+                      instance.bvh->_impl->closest_point(pointIS, closest_distance);
+                   hit) {
+                  closest_distance = hit->distance;
+                  closest_hit = top_level_bvh::point_hit{
+                     .pointWS = instance.rotation * hit->point + instance.position,
+                     .distance = hit->distance,
+                     .instance_index = _index[instance_index],
+                     .tri_index = hit->tri_index};
+               }
+            }
+         }
+      }
+
+      return closest_hit;
+   }
+
+   [[nodiscard]] auto overlaps(const bvh::sphere& sphereWS) const noexcept
+      -> std::vector<top_level_bvh::instance_tri>
+   {
+      const float radius_sq = sphereWS.radius * sphereWS.radius;
+
+      return for_each_overlapping_instance(
+         [&](const node_packed_x4& node) {
+            return movemask(cmp_le(distance_sq(load_child_bounds(node), sphereWS.position),
+                                   float_x4::broadcast(radius_sq)));
+         },
+         [&](const instance& instance, std::vector<uint32>& out_tris) {
+            instance.bvh->_impl->overlaps(
+               bvh::sphere{.position = instance.inverse_rotation * sphereWS.position +
+                                       instance.inverse_position,
+                           .radius = sphereWS.radius},
+               out_tris);
+         });
+   }
+
+   [[nodiscard]] auto overlaps(const bvh::oriented_box& boxWS) const noexcept
+      -> std::vector<top_level_bvh::instance_tri>
+   {
+      const math::bounding_box bboxWS = boxWS.rotation * boxWS.bbox + boxWS.position;
+
+      return for_each_overlapping_instance(
+         [&](const node_packed_x4& node) {
+            return overlaps_bbox(load_child_bounds(node), bboxWS);
+         },
+         [&](const instance& instance, std::vector<uint32>& out_tris) {
+            instance.bvh->_impl->overlaps(
+               bvh::oriented_box{.rotation = instance.inverse_rotation * boxWS.rotation,
+                                 .position = instance.inverse_rotation * boxWS.position +
+                                             instance.inverse_position,
+                                 .bbox = boxWS.bbox},
+               out_tris);
+         });
+   }
+
+   [[nodiscard]] auto get_debug_boxes() const noexcept -> std::vector<math::bounding_box>
+   {
+      std::vector<math::bounding_box> boxes;
+      boxes.reserve(_nodes.size() * 4);
+
+      for (const node_packed_x4& node : _nodes) {
+         const bounding_box_x4& bbox = node.bbox;
+
+         for (int32 i = 0; i < 4; ++i) {
+            boxes.push_back({
+               .min = {bbox.min_x[i], bbox.min_y[i], bbox.min_z[i]},
+               .max = {bbox.max_x[i], bbox.max_y[i], bbox.max_z[i]},
+            });
+         }
+      }
+
+      return boxes;
+   }
+
+private:
+   /// @brief Trace a packet of world space rays.
+   /// @return A mask of the rays that hit.
+   auto raycast_packet(ray_packet& packetWS, const bvh_ray_flags flags) const noexcept
+      -> int
+   {
+      const float_xn ray_originWS_x = float_xn::load(packetWS.origin_x.data());
+      const float_xn ray_originWS_y = float_xn::load(packetWS.origin_y.data());
+      const float_xn ray_originWS_z = float_xn::load(packetWS.origin_z.data());
+
+      const float_xn inv_ray_directionWS_x =
+         float_xn::load(packetWS.inv_direction_x.data());
+      const float_xn inv_ray_directionWS_y =
+         float_xn::load(packetWS.inv_direction_y.data());
+      const float_xn inv_ray_directionWS_z =
+         float_xn::load(packetWS.inv_direction_z.data());
+
+      std::array<int32, 64> stack = {
+         _root_node_index,
+      };
+      int32 stack_ptr = 0;
+
+      int hit_rays = 0;
+
+      ray_packet packetIS;
+      std::array<float3, packet_width> hit_normals;
+      std::array<uint32, packet_width> hit_mesh_tri_indices;
+
+      while (stack_ptr >= 0 and packetWS.active_mask != 0) {
+         const node_packed_x4& node = _nodes[stack[stack_ptr]];
+
+         stack_ptr -= 1;
+
+         for (int lane_index = 0; lane_index < std::ssize(node.instance_count);
+              ++lane_index) {
+            float_xn hit_distance;
+
+            const int hit_mask =
+               math::simd::intersect_aabb(
+                  ray_originWS_x, ray_originWS_y, ray_originWS_z,
+                  inv_ray_directionWS_x, inv_ray_directionWS_y, inv_ray_directionWS_z,
+                  float_xn::broadcast(node.bbox.min_x[lane_index]),
+                  float_xn::broadcast(node.bbox.min_y[lane_index]),
+                  float_xn::broadcast(node.bbox.min_z[lane_index]),
+                  float_xn::broadcast(node.bbox.max_x[lane_index]),
+                  float_xn::broadcast(node.bbox.max_y[lane_index]),
+                  float_xn::broadcast(node.bbox.max_z[lane_index]),
+                  float_xn::load(packetWS.closest_hit.data()), hit_distance) &
+               packetWS.active_mask;
+
+            if (not hit_mask) continue;
+
+            const bool is_leaf = node.instance_count[lane_index] != 0;
+
+            if (is_leaf) {
+               const int32 last_instance = node.children_or_first_instance[lane_index] +
+                                           node.instance_count[lane_index];
+
+               for (int32 instance_index = node.children_or_first_instance[lane_index];
+                    instance_index < last_instance; ++instance_index) {
+                  const instance& instance = _instances[_index[instance_index]];
+
+                  packetIS.active_mask = hit_mask & packetWS.active_mask;
+
+                  if (not packetIS.active_mask) break;
+                  if (not instance.bvh->_impl) continue;
+
+                  for (int32 i = 0; i < packet_width; ++i) {
+                     packetIS.set_ray(i,
+                                      instance.inverse_rotation * packetWS.origin(i) +
+                                         instance.inverse_position,
+                                      normalize(instance.inverse_rotation *
+                                                packetWS.direction(i)),
+                                      packetWS.closest_hit[i]);
+                  }
+
+                  const int instance_hit_rays =
+                     instance.bvh->_impl->raycast_packet(packetIS, flags, hit_normals,
+                                                         hit_mesh_tri_indices);
+
+                  for (unsigned int ray_mask = instance_hit_rays; ray_mask != 0;
+                       ray_mask &= ray_mask - 1) {
+                     const int32 ray_index = std::countr_zero(ray_mask);
+
+                     packetWS.closest_hit[ray_index] = packetIS.closest_hit[ray_index];
+                  }
+
+                  hit_rays |= instance_hit_rays;
+
+                  if (flags.accept_first_hit) {
+                     packetWS.active_mask &= ~instance_hit_rays;
+                  }
+               }
+            }
+            else {
+               stack_ptr += 1;
+
+               stack[stack_ptr] = node.children_or_first_instance[lane_index];
+            }
+         }
+      }
+
+      return hit_rays;
+   }
+
+   /// @brief Traverse the BVH and collect the triangles of the instances under every leaf
+   /// node_test accepts.
+   /// @param node_test Returns a mask of the children of a node to visit.
+   /// @param instance_overlaps Appends the overlapping triangles of an instance to a vector.
+   template<typename Node_test, typename Instance_overlaps>
+   auto for_each_overlapping_instance(const Node_test& node_test,
+                                      const Instance_overlaps& instance_overlaps) const noexcept
+      -> std::vector<top_level_bvh::instance_tri>
+   {
+      std::vector<top_level_bvh::instance_tri> overlapping_tris;
+
+      if (_instances.empty()) return overlapping_tris;
+
+      std::vector<uint32> instance_tris;
 
       std::array<int32, 64> stack = {
          _root_node_index,
       };
       int32 stack_ptr = 0;
 
-      float closest_hit = max_distance;
-
       while (stack_ptr >= 0) {
          const node_packed_x4& node = _nodes[stack[stack_ptr]];
 
          stack_ptr -= 1;
 
-         for (std::size_t lane_index = 0; lane_index < node.bbox.min_x.size();
-              ++lane_index) {
-            float hit_distance = 0.0f;
-
-            if (not intersect_aabb(
-                   ray_originWS, inv_ray_directionWS,
-                   math::bounding_box{.min = {node.bbox.min_x[lane_index],
-                                              node.bbox.min_y[lane_index],
-                                              node.bbox.min_z[lane_index]},
-
-                                      .max = {node.bbox.max_x[lane_index],
-                                              node.bbox.max_y[lane_index],
-                                              node.bbox.max_z[lane_index]}},
-                   closest_hit, hit_distance)) {
-               continue;
-            }
-
-            const bool is_leaf = node.instance_count[lane_index] != 0;
-
-            if (is_leaf) {
-               const int32 last_instance =
-                  node.children_or_first_instance[lane_index] +
-                  node.instance_count[lane_index];
+         for (uint32 lanes = static_cast<uint32>(node_test(node)); lanes != 0;
+              lanes &= lanes - 1) {
+            const int lane_index = std::countr_zero(lanes);
 
-               for (int32 instance_index = node.children_or_first_instance[lane_index];
-                    instance_index < last_instance; ++instance_index) {
-                  const instance& instance = _instances[_index[instance_index]];
+            if (node.instance_count[lane_index] < 0) continue;
 
-                  const float3 ray_originIS =
-                     instance.inverse_rotation * ray_originWS + instance.inverse_position;
-                  const float3 ray_directionIS =
-                     normalize(instance.inverse_rotation * ray_directionWS);
-
-                  if (std::optional<bvh::ray_hit> hit =
-                         instance.bvh->raycast(ray_originIS, ray_directionIS,
-                                               closest_hit, flags);
-                      hit) {
-                     if (flags.accept_first_hit) {
-                        return std::optional{hit->distance};
-                     }
-                  }
-               }
-            }
-            else {
+            if (node.instance_count[lane_index] == 0) {
                stack_ptr += 1;
 
                stack[stack_ptr] = node.children_or_first_instance[lane_index];
+
+               continue;
             }
-         }
-      }
 
-      return closest_hit < max_distance ? std::optional{closest_hit} : std::nullopt;
-   }
-#else
-#error Unknown BVH mode.
-#endif
+            const int32 last_instance = node.children_or_first_instance[lane_index] +
+                                        node.instance_count[lane_index];
 
-   [[nodiscard]] auto get_debug_boxes() const noexcept -> std::vector<math::bounding_box>
-   {
-      std::vector<math::bounding_box> boxes;
-      boxes.reserve(_nodes.size() * 4);
+            for (int32 instance_index = node.children_or_first_instance[lane_index];
+                 instance_index < last_instance; ++instance_index) {
+               const instance& instance = _instances[_index[instance_index]];
 
-      for (const node_packed_x4& node : _nodes) {
-         const bounding_box_x4& bbox = node.bbox;
+               if (not instance.bvh->_impl) continue;
 
-         for (int32 i = 0; i < 4; ++i) {
-            boxes.push_back({
-               .min = {bbox.min_x[i], bbox.min_y[i], bbox.min_z[i]},
-               .max = {bbox.max_x[i], bbox.max_y[i], bbox.max_z[i]},
-            });
+               instance_tris.clear();
+
+               instance_overlaps(instance, instance_tris);
+
+               for (const uint32 tri_index : instance_tris) {
+                  overlapping_tris.push_back({.instance_index = _index[instance_index],
+                                              .tri_index = tri_index});
+               }
+            }
          }
       }
 
-      return boxes;
+      return overlapping_tris;
    }
 
-private:
    struct leaf_node {
       math::bounding_box bbox;
       int32 first_instance = 0;
@@ -1551,6 +2786,17 @@ private:
       std::array<int32, 4> instance_count = {};
    };
 
+   static auto load_child_bounds(const node_packed_x4& node) noexcept
+      -> simd_bounding_box<float_x4>
+   {
+      return {.min_x = float_x4::load(node.bbox.min_x.data()),
+              .min_y = float_x4::load(node.bbox.min_y.data()),
+              .min_z = float_x4::load(node.bbox.min_z.data()),
+              .max_x = float_x4::load(node.bbox.max_x.data()),
+              .max_y = float_x4::load(node.bbox.max_y.data()),
+              .max_z = float_x4::load(node.bbox.max_z.data())};
+   }
+
    std::vector<node_packed_x4> _nodes;
    std::vector<uint32> _index;
    constexpr static int32 _root_node_index = 0;
@@ -1559,6 +2805,115 @@ private:
 
    using float3_axis = float float3::*;
 
+   /// @brief Build the nodes for the subtree under root breadth first, appending them to nodes
+   /// with child indices relative to the start of nodes. Once nodes holds max_nodes the remaining
+   /// children are left as leaves and added to deferred_children instead of being subdivided.
+   void build_nodes(const leaf_node& root, std::span<const float3> centroids,
+                    std::vector<node_packed_x4>& nodes,
+                    const std::size_t max_nodes = SIZE_MAX,
+                    std::vector<deferred_child>* deferred_children = nullptr) noexcept
+   {
+      assert(nodes.empty());
+
+      std::optional<node_packed_x4> subdivided_root = subdivide(root, centroids);
+
+      if (not subdivided_root) return;
+
+      nodes.push_back(*subdivided_root);
+
+      for (int32 packed_index = 0; packed_index < std::ssize(nodes); ++packed_index) {
+         for (int32 i = 0; i < 4; ++i) {
+            if (nodes.size() >= max_nodes) {
+               assert(deferred_children);
+
+               deferred_children->push_back({.packed_index = packed_index, .lane = i});
+
+               continue;
+            }
+
+            leaf_node child_node = get_child_leaf(nodes[packed_index], i);
+
+            update_node_bounds(child_node);
+
+            if (std::optional<node_packed_x4> subdivided =
+                   subdivide(child_node, centroids);
+                subdivided) {
+               const int32 child_index = static_cast<int32>(nodes.size());
+
+               nodes.push_back(*subdivided);
+
+               nodes[packed_index].children_or_first_instance[i] = child_index;
+               nodes[packed_index].instance_count[i] = 0;
+            }
+         }
+      }
+   }
+
+   /// @brief Build the top of the tree serially and then the subtrees under it in parallel. Each
+   /// subtree owns a separate range of _index so they can be partitioned independently.
+   void build_nodes_parallel(const leaf_node& root, std::span<const float3> centroids,
+                             async::thread_pool& thread_pool,
+                             const async::task_priority priority) noexcept
+   {
+      std::vector<deferred_child> deferred_children;
+
+      build_nodes(root, centroids, _nodes,
+                  parallel_build_top_node_count(thread_pool, priority),
+                  &deferred_children);
+
+      std::vector<std::vector<node_packed_x4>> subtrees;
+      subtrees.resize(deferred_children.size());
+
+      thread_pool.for_each_n(priority, deferred_children.size(),
+                             [&](const std::size_t i) noexcept {
+                                const auto [packed_index, lane] = deferred_children[i];
+
+                                leaf_node child_node =
+                                   get_child_leaf(_nodes[packed_index], lane);
+
+                                update_node_bounds(child_node);
+
+                                build_nodes(child_node, centroids, subtrees[i]);
+                             });
+
+      for (std::size_t i = 0; i < deferred_children.size(); ++i) {
+         const auto [packed_index, lane] = deferred_children[i];
+         std::vector<node_packed_x4>& subtree = subtrees[i];
+
+         if (subtree.empty()) continue;
+
+         const int32 subtree_index = static_cast<int32>(_nodes.size());
+
+         for (node_packed_x4& node : subtree) {
+            for (int32 subtree_lane = 0; subtree_lane < 4; ++subtree_lane) {
+               if (node.instance_count[subtree_lane] != 0) continue;
+
+               node.children_or_first_instance[subtree_lane] += subtree_index;
+            }
+         }
+
+         _nodes[packed_index].children_or_first_instance[lane] = subtree_index;
+         _nodes[packed_index].instance_count[lane] = 0;
+
+         _nodes.append_range(subtree);
+      }
+   }
+
+   auto get_child_leaf(const node_packed_x4& packed, const int32 lane) const noexcept
+      -> leaf_node
+   {
+      return {
+         .bbox = {.min = {packed.bbox.min_x[lane], packed.bbox.min_y[lane],
+                          packed.bbox.min_z[lane]},
+
+                  .max = {packed.bbox.max_x[lane], packed.bbox.max_y[lane],
+                          packed.bbox.max_z[lane]}},
+
+         .first_instance = packed.children_or_first_instance[lane],
+         .instance_count = packed.instance_count[lane],
+      };
+   }
+
    void update_node_bounds(leaf_node& node) noexcept
    {
       node.bbox = {.min = {FLT_MAX, FLT_MAX, FLT_MAX},
@@ -1821,7 +3176,16 @@ private:
 top_level_bvh::top_level_bvh() noexcept {}
 
 top_level_bvh::top_level_bvh(std::span<const instance> instances) noexcept
-   : _impl{std::make_unique<detail::top_level_bvh_impl>(instances)}
+   : _impl{std::make_unique<detail::top_level_bvh_impl>(instances, nullptr,
+                                                        async::task_priority::normal)}
+{
+}
+
+top_level_bvh::top_level_bvh(std::span<const instance> instances,
+                             async::thread_pool& thread_pool,
+                             const async::task_priority priority) noexcept
+   : _impl{std::make_unique<detail::top_level_bvh_impl>(instances, &thread_pool,
+                                                        priority)}
 {
 }
 
@@ -1840,9 +3204,384 @@ auto top_level_bvh::raycast(const float3& ray_origin,
                 : std::nullopt;
 }
 
+void top_level_bvh::raycast_batch(std::span<const bvh::ray> raysWS,
+                                  std::span<std::optional<float>> out_hits,
+                                  const bvh_ray_flags flags) const noexcept
+{
+   assert(raysWS.size() == out_hits.size());
+
+   if (not _impl) {
+      std::ranges::fill(out_hits, std::nullopt);
+
+      return;
+   }
+
+   _impl->raycast_batch(raysWS, out_hits, flags);
+}
+
+auto top_level_bvh::closest_point(const float3& pointWS, const float max_distance) const noexcept
+   -> std::optional<point_hit>
+{
+   return _impl ? _impl->closest_point(pointWS, max_distance) : std::nullopt;
+}
+
+auto top_level_bvh::overlaps(const bvh::sphere& sphereWS) const noexcept
+   -> std::vector<instance_tri>
+{
+   return _impl ? _impl->overlaps(sphereWS) : std::vector<instance_tri>{};
+}
+
+auto top_level_bvh::overlaps(const bvh::oriented_box& boxWS) const noexcept
+   -> std::vector<instance_tri>
+{
+   return _impl ? _impl->overlaps(boxWS) : std::vector<instance_tri>{};
+}
+
 auto top_level_bvh::get_debug_boxes() const noexcept -> std::vector<math::bounding_box>
 {
    return _impl ? _impl->get_debug_boxes() : std::vector<math::bounding_box>{};
 }
 
+
+struct detail::dynamic_top_level_bvh_impl {
+   using instance = top_level_bvh::instance;
+   using handle = dynamic_top_level_bvh::handle;
+
+   [[nodiscard]] auto insert(const instance& instance) noexcept -> handle
+   {
+      assert(instance.bvh);
+
+      uint32 instance_index = 0;
+
+      if (_free_instances.empty()) {
+         instance_index = static_cast<uint32>(_instances.size());
+
+         _instances.emplace_back();
+      }
+      else {
+         instance_index = _free_instances.back();
+
+         _free_instances.pop_back();
+      }
+
+      _instances[instance_index] = {.instance = instance, .live = true};
+      _instance_count += 1;
+
+      insert_instance_leaf(instance_index);
+
+      return handle{instance_index};
+   }
+
+   void remove(const handle handle) noexcept
+   {
+      const uint32 instance_index = std::to_underlying(handle);
+
+      assert(instance_index < _instances.size() and _instances[instance_index].live);
+
+      remove_instance_leaf(instance_index);
+
+      _instances[instance_index] = {};
+      _free_instances.push_back(instance_index);
+      _instance_count -= 1;
+   }
+
+   void update(const handle handle, const instance& instance) noexcept
+   {
+      assert(instance.bvh);
+
+      const uint32 instance_index = std::to_underlying(handle);
+
+      assert(instance_index < _instances.size() and _instances[instance_index].live);
+
+      instance_entry& entry = _instances[instance_index];
+
+      const bool same_bvh = entry.instance.bvh == instance.bvh;
+
+      entry.instance = instance;
+
+      if (entry.leaf != dynamic_aabb_tree::null_leaf and same_bvh) {
+         if (const std::optional<math::bounding_box> bbox = get_instance_bbox(instance); bbox) {
+            _tree.move(entry.leaf, *bbox);
+
+            return;
+         }
+      }
+
+      remove_instance_leaf(instance_index);
+      insert_instance_leaf(instance_index);
+   }
+
+   [[nodiscard]] auto size() const noexcept -> std::size_t
+   {
+      return _instance_count;
+   }
+
+   /// @param filter Returns false for instances to skip.
+   template<typename Filter>
+   [[nodiscard]] auto raycast(const float3& ray_originWS,
+                              const float3& ray_directionWS, const float max_distance,
+                              const Filter& filter, const bvh_ray_flags flags) const noexcept
+      -> std::optional<dynamic_top_level_bvh::ray_hit>
+   {
+      std::optional<dynamic_top_level_bvh::ray_hit> closest_hit;
+
+      _tree.raycast(ray_originWS, ray_directionWS, max_distance,
+                    [&](const uint32 instance_index, float& closest_distance) {
+                       if (not filter(handle{instance_index})) return true;
+
+                       const instance& instance = _instances[instance_index].instance;
+
+                       const float3 ray_originIS =
+                          instance.inverse_rotation * ray_originWS + instance.inverse_position;
+                       const float3 ray_directionIS =
+                          normalize(instance.inverse_rotation * ray_directionWS);
+
+                       const std::optional<bvh::ray_hit> hit =
+                          instance.bvh->raycast(ray_originIS, ray_directionIS,
+                                                closest_distance, flags);
+
+                       if (not hit) return true;
+
+                       closest_distance = hit->distance;
+                       closest_hit = {.distance = hit->distance,
+                                      .unnormalized_normalWS =
+                                         instance.rotation * hit->unnormalized_normal,
+                                      .instance = handle{instance_index},
+                                      .tri_index = hit->tri_index};
+
+                       return not flags.accept_first_hit;
+                    });
+
+      return closest_hit;
+   }
+
+   [[nodiscard]] auto closest_point(const float3& pointWS, const float max_distance) const noexcept
+      -> std::optional<dynamic_top_level_bvh::point_hit>
+   {
+      std::optional<dynamic_top_level_bvh::point_hit> closest_hit;
+
+      _tree.closest(pointWS, max_distance,
+                    [&](const uint32 instance_index, float& closest_distance) {
+                       const instance& instance = _instances[instance_index].instance;
+
+                       const float3 pointIS =
+                          instance.inverse_rotation * pointWS + instance.inverse_position;
+
+                       const std::optional<bvh::point_hit> hit =
+                          instance.bvh->_impl->closest_point(pointIS, closest_distance);
+
+                       if (not hit) return true;
+
+                       closest_distance = hit->distance;
+                       closest_hit = {.pointWS =
+                                         instance.rotation * hit->point + instance.position,
+                                      .distance = hit->distance,
+                                      .instance = handle{instance_index},
+                                      .tri_index = hit->tri_index};
+
+                       return true;
+                    });
+
+      return closest_hit;
+   }
+
+   [[nodiscard]] auto overlaps(const bvh::sphere& sphereWS) const noexcept
+      -> std::vector<dynamic_top_level_bvh::instance_tri>
+   {
+      const float radius_sq = sphereWS.radius * sphereWS.radius;
+
+      return for_each_overlapping_instance(
+         [&](const math::bounding_box& bbox) {
+            return distance_sq(bbox, sphereWS.position) <= radius_sq;
+         },
+         [&](const instance& instance, std::vector<uint32>& out_tris) {
+            instance.bvh->_impl->overlaps(
+               bvh::sphere{.position = instance.inverse_rotation * sphereWS.position +
+                                       instance.inverse_position,
+                           .radius = sphereWS.radius},
+               out_tris);
+         });
+   }
+
+   [[nodiscard]] auto overlaps(const bvh::oriented_box& boxWS) const noexcept
+      -> std::vector<dynamic_top_level_bvh::instance_tri>
+   {
+      const math::bounding_box bboxWS = boxWS.rotation * boxWS.bbox + boxWS.position;
+
+      return for_each_overlapping_instance(
+         [&](const math::bounding_box& bbox) { return overlaps_bbox(bbox, bboxWS); },
+         [&](const instance& instance, std::vector<uint32>& out_tris) {
+            instance.bvh->_impl->overlaps(
+               bvh::oriented_box{.rotation = instance.inverse_rotation * boxWS.rotation,
+                                 .position = instance.inverse_rotation * boxWS.position +
+                                             instance.inverse_position,
+                                 .bbox = boxWS.bbox},
+               out_tris);
+         });
+   }
+
+   [[nodiscard]] auto get_debug_boxes() const noexcept -> std::vector<math::bounding_box>
+   {
+      return _tree.get_debug_boxes();
+   }
+
+private:
+   struct instance_entry {
+      instance instance;
+      /// @brief The instance's leaf in the tree. Instances with empty BVHs have no leaf.
+      int32 leaf = dynamic_aabb_tree::null_leaf;
+      bool live = false;
+   };
+
+   dynamic_aabb_tree _tree;
+
+   std::vector<instance_entry> _instances;
+   std::vector<uint32> _free_instances;
+   std::size_t _instance_count = 0;
+
+   [[nodiscard]] static auto get_instance_bbox(const instance& instance) noexcept
+      -> std::optional<math::bounding_box>
+   {
+      if (not instance.bvh->_impl or instance.bvh->_impl->get_tri_count() == 0) {
+         return std::nullopt;
+      }
+
+      return instance.rotation * instance.bvh->_impl->get_bbox() + instance.position;
+   }
+
+   /// @brief Traverse the tree and collect the triangles of the instances whose bounds
+   /// bbox_test accepts.
+   /// @param bbox_test Returns true if a box should be visited.
+   /// @param instance_overlaps Appends the overlapping triangles of an instance to a vector.
+   template<typename Bbox_test, typename Instance_overlaps>
+   auto for_each_overlapping_instance(const Bbox_test& bbox_test,
+                                      const Instance_overlaps& instance_overlaps) const noexcept
+      -> std::vector<dynamic_top_level_bvh::instance_tri>
+   {
+      std::vector<dynamic_top_level_bvh::instance_tri> overlapping_tris;
+      std::vector<uint32> instance_tris;
+
+      _tree.query(bbox_test, [&](const uint32 instance_index) {
+         instance_tris.clear();
+
+         instance_overlaps(_instances[instance_index].instance, instance_tris);
+
+         for (const uint32 tri_index : instance_tris) {
+            overlapping_tris.push_back(
+               {.instance = handle{instance_index}, .tri_index = tri_index});
+         }
+      });
+
+      return overlapping_tris;
+   }
+
+   void insert_instance_leaf(const uint32 instance_index) noexcept
+   {
+      instance_entry& entry = _instances[instance_index];
+
+      assert(entry.leaf == dynamic_aabb_tree::null_leaf);
+
+      if (const std::optional<math::bounding_box> bbox = get_instance_bbox(entry.instance);
+          bbox) {
+         entry.leaf = _tree.insert(*bbox, instance_index);
+      }
+   }
+
+   void remove_instance_leaf(const uint32 instance_index) noexcept
+   {
+      instance_entry& entry = _instances[instance_index];
+
+      if (entry.leaf == dynamic_aabb_tree::null_leaf) return;
+
+      _tree.remove(entry.leaf);
+
+      entry.leaf = dynamic_aabb_tree::null_leaf;
+   }
+};
+
+dynamic_top_level_bvh::dynamic_top_level_bvh() noexcept = default;
+
+dynamic_top_level_bvh::dynamic_top_level_bvh(dynamic_top_level_bvh&&) noexcept = default;
+
+auto dynamic_top_level_bvh::operator=(dynamic_top_level_bvh&&) noexcept
+   -> dynamic_top_level_bvh& = default;
+
+dynamic_top_level_bvh::~dynamic_top_level_bvh() = default;
+
+auto dynamic_top_level_bvh::insert(const instance& instance) noexcept -> handle
+{
+   if (not _impl) _impl = std::make_unique<detail::dynamic_top_level_bvh_impl>();
+
+   return _impl->insert(instance);
+}
+
+void dynamic_top_level_bvh::remove(const handle handle) noexcept
+{
+   assert(_impl);
+
+   _impl->remove(handle);
+}
+
+void dynamic_top_level_bvh::update(const handle handle, const instance& instance) noexcept
+{
+   assert(_impl);
+
+   _impl->update(handle, instance);
+}
+
+void dynamic_top_level_bvh::clear() noexcept
+{
+   _impl = nullptr;
+}
+
+auto dynamic_top_level_bvh::size() const noexcept -> std::size_t
+{
+   return _impl ? _impl->size() : 0;
+}
+
+auto dynamic_top_level_bvh::raycast(const float3& ray_originWS,
+                                    const float3& ray_directionWS, const float max_distance,
+                                    const bvh_ray_flags flags) const noexcept
+   -> std::optional<ray_hit>
+{
+   return _impl ? _impl->raycast(
+                     ray_originWS, ray_directionWS, max_distance,
+                     [](const handle) noexcept { return true; }, flags)
+                : std::nullopt;
+}
+
+auto dynamic_top_level_bvh::raycast(const float3& ray_originWS,
+                                    const float3& ray_directionWS, const float max_distance,
+                                    function_ptr<bool(const handle) noexcept> filter,
+                                    const bvh_ray_flags flags) const noexcept
+   -> std::optional<ray_hit>
+{
+   return _impl ? _impl->raycast(ray_originWS, ray_directionWS, max_distance, filter, flags)
+                : std::nullopt;
+}
+
+auto dynamic_top_level_bvh::closest_point(const float3& pointWS,
+                                          const float max_distance) const noexcept
+   -> std::optional<point_hit>
+{
+   return _impl ? _impl->closest_point(pointWS, max_distance) : std::nullopt;
+}
+
+auto dynamic_top_level_bvh::overlaps(const bvh::sphere& sphereWS) const noexcept
+   -> std::vector<instance_tri>
+{
+   return _impl ? _impl->overlaps(sphereWS) : std::vector<instance_tri>{};
+}
+
+auto dynamic_top_level_bvh::overlaps(const bvh::oriented_box& boxWS) const noexcept
+   -> std::vector<instance_tri>
+{
+   return _impl ? _impl->overlaps(boxWS) : std::vector<instance_tri>{};
+}
+
+auto dynamic_top_level_bvh::get_debug_boxes() const noexcept -> std::vector<math::bounding_box>
+{
+   return _impl ? _impl->get_debug_boxes() : std::vector<math::bounding_box>{};
+}
+
 }
@@ -3,11 +3,23 @@
 #include "math/bounding_box.hpp"
 #include "types.hpp"
 
+#include "utility/function_ptr.hpp"
+
+#include <cstddef>
+#include <float.h>
 #include <memory>
 #include <optional>
 #include <span>
 #include <vector>
 
+namespace we::async {
+
+class thread_pool;
+
+enum class task_priority;
+
+}
+
 namespace we {
 
 struct frustum;
@@ -15,10 +27,14 @@ struct frustum;
 namespace detail {
 struct bvh_impl;
 struct top_level_bvh_impl;
+struct dynamic_top_level_bvh_impl;
 }
 
 struct bvh_flags {
    bool backface_cull = true;
+   /// @brief Collapse the BVH into 8 wide nodes with quantized bounds. Halves the memory used by
+   /// the nodes at the cost of decoding them while traversing.
+   bool compressed = true;
 };
 
 struct bvh_ray_flags {
@@ -27,17 +43,48 @@ struct bvh_ray_flags {
 };
 
 struct bvh {
+   struct ray {
+      float3 origin;
+      float3 direction;
+      float max_distance = FLT_MAX;
+   };
+
    struct ray_hit {
       float distance;
       float3 unnormalized_normal;
       uint32 tri_index = 0;
    };
 
+   struct sphere {
+      float3 position;
+      float radius = 0.0f;
+   };
+
+   /// @brief A box in the BVH's space. bbox is in the box's own space and is rotated by rotation
+   /// and then moved by position.
+   struct oriented_box {
+      quaternion rotation;
+      float3 position;
+      math::bounding_box bbox;
+   };
+
+   struct point_hit {
+      float3 point;
+      float distance;
+      uint32 tri_index = 0;
+   };
+
    bvh() noexcept;
 
    bvh(std::span<const std::array<uint16, 3>> indices,
        std::span<const float3> positions, bvh_flags flags) noexcept;
 
+   /// @brief Build the BVH using a thread pool. The top of the tree is built first and then the
+   /// subtrees under it are built in parallel, giving the same tree as the serial build.
+   bvh(std::span<const std::array<uint16, 3>> indices,
+       std::span<const float3> positions, bvh_flags flags,
+       async::thread_pool& thread_pool, const async::task_priority priority) noexcept;
+
    bvh(bvh&&) noexcept;
    auto operator=(bvh&&) -> bvh&;
 
@@ -51,15 +98,68 @@ struct bvh {
                               const bvh_ray_flags flags = {}) const noexcept
       -> std::optional<ray_hit>;
 
+   /// @brief Trace a batch of rays, writing the hit for each ray to out_hits. Rays are traced
+   /// together in packets so batches of coherent rays are cheaper than calling raycast for each.
+   void raycast_batch(std::span<const ray> rays, std::span<std::optional<ray_hit>> out_hits,
+                      const bvh_ray_flags flags = {}) const noexcept;
+
    [[nodiscard]] bool intersects(const frustum& frustum) const noexcept;
 
+   /// @brief Find the point on the mesh closest to a point.
+   /// @param point The point to search from.
+   /// @param max_distance The distance to search out to. Points this far away or further are ignored.
+   /// @return The closest point or nullopt if the mesh has no points within max_distance.
+   [[nodiscard]] auto closest_point(const float3& point,
+                                    const float max_distance = FLT_MAX) const noexcept
+      -> std::optional<point_hit>;
+
+   /// @brief Find the triangles that overlap a sphere.
+   /// @return The indices of the triangles, in no particular order.
+   [[nodiscard]] auto overlaps(const sphere& sphere) const noexcept -> std::vector<uint32>;
+
+   /// @brief Find the triangles that overlap a box.
+   /// @return The indices of the triangles, in no particular order.
+   [[nodiscard]] auto overlaps(const oriented_box& box) const noexcept -> std::vector<uint32>;
+
    [[nodiscard]] auto get_debug_boxes() const noexcept
       -> std::vector<math::bounding_box>;
 
+   /// @brief Update the BVH's bounds after the mesh's vertices have moved without it's triangles
+   /// changing, in O(n) time. Any top_level_bvh using this BVH must be rebuilt afterwards.
+   /// @param positions The new vertex positions. Must be the same size as the ones the BVH was built with.
+   /// @return False if refitting has degraded the BVH enough that it should be rebuilt. The BVH
+   /// is still correct to use but traversing it will be slower than a rebuilt one.
+   [[nodiscard]] bool refit(std::span<const float3> positions) noexcept;
+
+   /// @brief Copy the BVH for a copy of the mesh it was built from, without rebuilding it.
+   /// @param indices The copy of the indices the BVH was built from.
+   /// @param positions The copy of the positions the BVH was built from.
+   /// @return The copy of the BVH.
+   [[nodiscard]] auto copy(std::span<const std::array<uint16, 3>> indices,
+                           std::span<const float3> positions) const noexcept -> bvh;
+
+   /// @brief Get the memory used by the BVH's nodes and triangle list.
+   [[nodiscard]] auto memory_usage() const noexcept -> std::size_t;
+
+   /// @brief Get the size of the BVH when serialized.
+   [[nodiscard]] auto serialized_size() const noexcept -> std::size_t;
+
+   /// @brief Write the BVH's nodes into out, which must be serialized_size() bytes. The mesh is
+   /// not included and must be passed to deserialize along with the bytes.
+   void serialize(std::span<std::byte> out) const noexcept;
+
+   /// @brief Recreate a BVH from the output of serialize and the mesh it was built from.
+   /// @return The BVH or nullopt if the bytes are not a valid BVH for the mesh.
+   [[nodiscard]] static auto deserialize(std::span<const std::byte> bytes,
+                                         std::span<const std::array<uint16, 3>> indices,
+                                         std::span<const float3> positions,
+                                         bvh_flags flags) noexcept -> std::optional<bvh>;
+
 private:
    std::unique_ptr<detail::bvh_impl> _impl;
 
    friend struct detail::top_level_bvh_impl;
+   friend struct detail::dynamic_top_level_bvh_impl;
 };
 
 struct top_level_bvh {
@@ -73,10 +173,29 @@ struct top_level_bvh {
       float3 position;
    };
 
+   struct point_hit {
+      float3 pointWS;
+      float distance;
+      uint32 instance_index = 0;
+      uint32 tri_index = 0;
+   };
+
+   /// @brief A triangle of one of the instances. instance_index is the instance's index in the
+   /// instances the BVH was built from.
+   struct instance_tri {
+      uint32 instance_index = 0;
+      uint32 tri_index = 0;
+   };
+
    top_level_bvh() noexcept;
 
    explicit top_level_bvh(std::span<const instance> instances) noexcept;
 
+   /// @brief Build the BVH using a thread pool. The top of the tree is built first and then the
+   /// subtrees under it are built in parallel, giving the same tree as the serial build.
+   top_level_bvh(std::span<const instance> instances, async::thread_pool& thread_pool,
+                 const async::task_priority priority) noexcept;
+
    top_level_bvh(top_level_bvh&&) noexcept;
    auto operator=(top_level_bvh&&) -> top_level_bvh&;
 
@@ -90,6 +209,30 @@ struct top_level_bvh {
                               const bvh_ray_flags flags = {}) const noexcept
       -> std::optional<float>;
 
+   /// @brief Trace a batch of rays, writing the hit distance for each ray to out_hits. Rays are
+   /// traced together in packets so batches of coherent rays are cheaper than calling raycast for each.
+   void raycast_batch(std::span<const bvh::ray> raysWS,
+                      std::span<std::optional<float>> out_hits,
+                      const bvh_ray_flags flags = {}) const noexcept;
+
+   /// @brief Find the point on any of the instances closest to a point.
+   /// @param pointWS The point to search from.
+   /// @param max_distance The distance to search out to. Points this far away or further are ignored.
+   /// @return The closest point or nullopt if no instance has a point within max_distance.
+   [[nodiscard]] auto closest_point(const float3& pointWS,
+                                    const float max_distance = FLT_MAX) const noexcept
+      -> std::optional<point_hit>;
+
+   /// @brief Find the triangles of every instance that overlap a sphere.
+   /// @return The triangles, in no particular order.
+   [[nodiscard]] auto overlaps(const bvh::sphere& sphereWS) const noexcept
+      -> std::vector<instance_tri>;
+
+   /// @brief Find the triangles of every instance that overlap a box.
+   /// @return The triangles, in no particular order.
+   [[nodiscard]] auto overlaps(const bvh::oriented_box& boxWS) const noexcept
+      -> std::vector<instance_tri>;
+
    [[nodiscard]] auto get_debug_boxes() const noexcept
       -> std::vector<math::bounding_box>;
 
@@ -97,4 +240,96 @@ private:
    std::unique_ptr<detail::top_level_bvh_impl> _impl;
 };
 
+
+/// @brief A top level BVH that instances can be inserted into, removed from and moved without
+/// rebuilding it. Suited to keeping in sync with a scene that changes every frame.
+///
+/// Instances are kept in a binary tree that is updated incrementally. Each instance's bounds are
+/// slightly enlarged when inserted so small moves don't need to touch the tree at all.
+struct dynamic_top_level_bvh {
+   using instance = top_level_bvh::instance;
+
+   enum class handle : uint32 {};
+
+   struct ray_hit {
+      float distance;
+      float3 unnormalized_normalWS;
+      handle instance;
+      uint32 tri_index = 0;
+   };
+
+   struct point_hit {
+      float3 pointWS;
+      float distance;
+      handle instance;
+      uint32 tri_index = 0;
+   };
+
+   struct instance_tri {
+      handle instance;
+      uint32 tri_index = 0;
+   };
+
+   dynamic_top_level_bvh() noexcept;
+
+   dynamic_top_level_bvh(dynamic_top_level_bvh&&) noexcept;
+   auto operator=(dynamic_top_level_bvh&&) noexcept -> dynamic_top_level_bvh&;
+
+   ~dynamic_top_level_bvh();
+
+   dynamic_top_level_bvh(const dynamic_top_level_bvh&) = delete;
+   auto operator=(const dynamic_top_level_bvh&) -> dynamic_top_level_bvh& = delete;
+
+   /// @brief Add an instance. The instance's BVH must outlive the instance.
+   /// @return The handle to update or remove the instance with. Handles of removed instances are
+   /// reused.
+   [[nodiscard]] auto insert(const instance& instance) noexcept -> handle;
+
+   /// @brief Remove an instance.
+   void remove(const handle handle) noexcept;
+
+   /// @brief Replace an instance's transform and BVH.
+   void update(const handle handle, const instance& instance) noexcept;
+
+   /// @brief Remove all instances.
+   void clear() noexcept;
+
+   /// @brief Get the number of instances.
+   [[nodiscard]] auto size() const noexcept -> std::size_t;
+
+   [[nodiscard]] auto raycast(const float3& ray_originWS,
+                              const float3& ray_directionWS, const float max_distance,
+                              const bvh_ray_flags flags = {}) const noexcept
+      -> std::optional<ray_hit>;
+
+   /// @brief Raycast against the instances accepted by a filter.
+   /// @param filter Called with the handle of each instance the ray could hit. Returns false to
+   /// skip the instance.
+   [[nodiscard]] auto raycast(const float3& ray_originWS,
+                              const float3& ray_directionWS, const float max_distance,
+                              function_ptr<bool(const handle) noexcept> filter,
+                              const bvh_ray_flags flags = {}) const noexcept
+      -> std::optional<ray_hit>;
+
+   /// @brief Find the point on any of the instances closest to a point.
+   /// @return The closest point or nullopt if no instance has a point within max_distance.
+   [[nodiscard]] auto closest_point(const float3& pointWS,
+                                    const float max_distance = FLT_MAX) const noexcept
+      -> std::optional<point_hit>;
+
+   /// @brief Find the triangles of every instance that overlap a sphere.
+   [[nodiscard]] auto overlaps(const bvh::sphere& sphereWS) const noexcept
+      -> std::vector<instance_tri>;
+
+   /// @brief Find the triangles of every instance that overlap a box.
+   [[nodiscard]] auto overlaps(const bvh::oriented_box& boxWS) const noexcept
+      -> std::vector<instance_tri>;
+
+   [[nodiscard]] auto get_debug_boxes() const noexcept
+      -> std::vector<math::bounding_box>;
+
+private:
+   std::unique_ptr<detail::dynamic_top_level_bvh_impl> _impl;
+};
+
 }
@@ -0,0 +1,334 @@
+#include "dynamic_aabb_tree.hpp"
+#include "intersectors.hpp"
+#include "vector_funcs.hpp"
+
+#include <algorithm>
+
+namespace we {
+
+namespace {
+
+/// @brief How much each side of a box is pushed out by, relative to the size of the box, when
+/// inserting it into the tree.
+constexpr float bbox_margin = 0.1f;
+
+auto area(const math::bounding_box& bbox) noexcept -> float
+{
+   const float3 extents = bbox.max - bbox.min;
+
+   return extents.x * extents.y + extents.y * extents.z + extents.z * extents.x;
+}
+
+bool contains(const math::bounding_box& outer, const math::bounding_box& inner) noexcept
+{
+   return outer.min.x <= inner.min.x and outer.min.y <= inner.min.y and
+          outer.min.z <= inner.min.z and outer.max.x >= inner.max.x and
+          outer.max.y >= inner.max.y and outer.max.z >= inner.max.z;
+}
+
+auto enlarge(const math::bounding_box& bbox) noexcept -> math::bounding_box
+{
+   const float3 margin = (bbox.max - bbox.min) * bbox_margin;
+
+   return {.min = bbox.min - margin, .max = bbox.max + margin};
+}
+
+}
+
+auto dynamic_aabb_tree::insert(const math::bounding_box& bbox, const uint32 value) noexcept
+   -> int32
+{
+   const int32 leaf = allocate_node();
+
+   _nodes[leaf] = {.bbox = enlarge(bbox), .value = value};
+   _leaf_count += 1;
+
+   insert_leaf(leaf);
+
+   return leaf;
+}
+
+void dynamic_aabb_tree::remove(const int32 leaf) noexcept
+{
+   assert(leaf >= 0 and leaf < std::ssize(_nodes) and _nodes[leaf].is_leaf() and
+          _nodes[leaf].height != free_node_height);
+
+   remove_leaf(leaf);
+   free_node(leaf);
+
+   _leaf_count -= 1;
+}
+
+bool dynamic_aabb_tree::move(const int32 leaf, const math::bounding_box& bbox) noexcept
+{
+   assert(leaf >= 0 and leaf < std::ssize(_nodes) and _nodes[leaf].is_leaf() and
+          _nodes[leaf].height != free_node_height);
+
+   if (contains(_nodes[leaf].bbox, bbox)) return false;
+
+   remove_leaf(leaf);
+
+   _nodes[leaf].bbox = enlarge(bbox);
+
+   insert_leaf(leaf);
+
+   return true;
+}
+
+void dynamic_aabb_tree::clear() noexcept
+{
+   _nodes.clear();
+   _root = null_node;
+   _free_node = null_node;
+   _leaf_count = 0;
+}
+
+auto dynamic_aabb_tree::size() const noexcept -> std::size_t
+{
+   return _leaf_count;
+}
+
+auto dynamic_aabb_tree::get_debug_boxes() const noexcept -> std::vector<math::bounding_box>
+{
+   std::vector<math::bounding_box> boxes;
+   boxes.reserve(_nodes.size());
+
+   for (const node& node : _nodes) {
+      if (node.height != free_node_height) boxes.push_back(node.bbox);
+   }
+
+   return boxes;
+}
+
+auto dynamic_aabb_tree::ray_distance(const float3& ray_origin, const float3& inv_ray_direction,
+                                     const math::bounding_box& bbox,
+                                     const float max_distance) noexcept -> std::optional<float>
+{
+   float distance = 0.0f;
+
+   if (not intersect_aabb(ray_origin, inv_ray_direction, bbox, max_distance, distance)) {
+      return std::nullopt;
+   }
+
+   return distance;
+}
+
+auto dynamic_aabb_tree::distance_sq(const math::bounding_box& bbox, const float3& point) noexcept
+   -> float
+{
+   const float3 distance = max(max(bbox.min - point, point - bbox.max), float3{});
+
+   return dot(distance, distance);
+}
+
+auto dynamic_aabb_tree::allocate_node() noexcept -> int32
+{
+   if (_free_node == null_node) {
+      _nodes.emplace_back();
+
+      return static_cast<int32>(_nodes.size() - 1);
+   }
+
+   const int32 node_index = _free_node;
+
+   _free_node = _nodes[node_index].parent;
+   _nodes[node_index] = {};
+
+   return node_index;
+}
+
+void dynamic_aabb_tree::free_node(const int32 node_index) noexcept
+{
+   _nodes[node_index] = {.parent = _free_node, .height = free_node_height};
+   _free_node = node_index;
+}
+
+/// @brief Insert a leaf into the tree. The leaf's sibling is picked by walking down from the root
+/// towards whichever child grows the least by taking the leaf, stopping once pairing the leaf with
+/// the current node is cheaper than going further.
+void dynamic_aabb_tree::insert_leaf(const int32 leaf) noexcept
+{
+   if (_root == null_node) {
+      _root = leaf;
+      _nodes[leaf].parent = null_node;
+
+      return;
+   }
+
+   const math::bounding_box leaf_bbox = _nodes[leaf].bbox;
+
+   int32 sibling = _root;
+
+   while (not _nodes[sibling].is_leaf()) {
+      const node& node = _nodes[sibling];
+
+      const float node_area = area(node.bbox);
+      const float combined_area = area(combine(node.bbox, leaf_bbox));
+
+      // The cost of making a new parent for this node and the leaf.
+      const float sibling_cost = 2.0f * combined_area;
+
+      // The cost the leaf adds to this node's bounds if it goes further down.
+      const float inheritance_cost = 2.0f * (combined_area - node_area);
+
+      std::array<float, 2> child_costs;
+
+      for (int32 i = 0; i < 2; ++i) {
+         const dynamic_aabb_tree::node& child = _nodes[node.children[i]];
+
+         const float enlarged_area = area(combine(child.bbox, leaf_bbox));
+
+         child_costs[i] =
+            (child.is_leaf() ? enlarged_area : enlarged_area - area(child.bbox)) +
+            inheritance_cost;
+      }
+
+      if (sibling_cost < child_costs[0] and sibling_cost < child_costs[1]) break;
+
+      sibling = child_costs[0] < child_costs[1] ? node.children[0] : node.children[1];
+   }
+
+   const int32 old_parent = _nodes[sibling].parent;
+   const int32 new_parent = allocate_node();
+
+   _nodes[new_parent] = {.bbox = combine(leaf_bbox, _nodes[sibling].bbox),
+                         .parent = old_parent,
+                         .children = {sibling, leaf},
+                         .height = _nodes[sibling].height + 1};
+
+   if (old_parent == null_node) {
+      _root = new_parent;
+   }
+   else {
+      replace_child(old_parent, sibling, new_parent);
+   }
+
+   _nodes[sibling].parent = new_parent;
+   _nodes[leaf].parent = new_parent;
+
+   refit_ancestors(old_parent);
+}
+
+void dynamic_aabb_tree::remove_leaf(const int32 leaf) noexcept
+{
+   if (leaf == _root) {
+      _root = null_node;
+
+      return;
+   }
+
+   const int32 parent = _nodes[leaf].parent;
+   const int32 grandparent = _nodes[parent].parent;
+   const int32 sibling = _nodes[parent].children[0] == leaf ? _nodes[parent].children[1]
+                                                            : _nodes[parent].children[0];
+
+   _nodes[sibling].parent = grandparent;
+
+   if (grandparent == null_node) {
+      _root = sibling;
+   }
+   else {
+      replace_child(grandparent, parent, sibling);
+   }
+
+   free_node(parent);
+
+   refit_ancestors(grandparent);
+}
+
+void dynamic_aabb_tree::replace_child(const int32 parent, const int32 old_child,
+                                      const int32 new_child) noexcept
+{
+   std::array<int32, 2>& children = _nodes[parent].children;
+
+   if (children[0] == old_child) {
+      children[0] = new_child;
+   }
+   else {
+      assert(children[1] == old_child);
+
+      children[1] = new_child;
+   }
+}
+
+/// @brief Walk up from a node to the root, rebalancing and updating the bounds and height of
+/// each node along the way.
+void dynamic_aabb_tree::refit_ancestors(int32 node_index) noexcept
+{
+   while (node_index != null_node) {
+      node_index = balance(node_index);
+
+      update_node(node_index);
+
+      node_index = _nodes[node_index].parent;
+   }
+}
+
+void dynamic_aabb_tree::update_node(const int32 node_index) noexcept
+{
+   node& node = _nodes[node_index];
+
+   const dynamic_aabb_tree::node& left = _nodes[node.children[0]];
+   const dynamic_aabb_tree::node& right = _nodes[node.children[1]];
+
+   node.bbox = combine(left.bbox, right.bbox);
+   node.height = 1 + std::max(left.height, right.height);
+}
+
+/// @brief If one child of a node is more than one level taller than the other rotate the taller
+/// child up to take the node's place.
+/// @return The node now in the place of node_index.
+auto dynamic_aabb_tree::balance(const int32 node_index) noexcept -> int32
+{
+   const node& node = _nodes[node_index];
+
+   if (node.is_leaf() or node.height < 2) return node_index;
+
+   const int32 height_difference =
+      _nodes[node.children[1]].height - _nodes[node.children[0]].height;
+
+   if (height_difference > 1) return rotate_up(node_index, 1);
+   if (height_difference < -1) return rotate_up(node_index, 0);
+
+   return node_index;
+}
+
+/// @brief Swap a node with one of its children. The child's shorter child is given to the node
+/// in exchange.
+/// @return The index of the child, which is now the parent.
+auto dynamic_aabb_tree::rotate_up(const int32 node_index, const int32 child_side) noexcept
+   -> int32
+{
+   const int32 child_index = _nodes[node_index].children[child_side];
+
+   const int32 grandchild_0 = _nodes[child_index].children[0];
+   const int32 grandchild_1 = _nodes[child_index].children[1];
+
+   const bool keep_0 = _nodes[grandchild_0].height > _nodes[grandchild_1].height;
+
+   const int32 kept_grandchild = keep_0 ? grandchild_0 : grandchild_1;
+   const int32 given_grandchild = keep_0 ? grandchild_1 : grandchild_0;
+
+   const int32 parent = _nodes[node_index].parent;
+
+   _nodes[child_index].children = {node_index, kept_grandchild};
+   _nodes[child_index].parent = parent;
+
+   if (parent == null_node) {
+      _root = child_index;
+   }
+   else {
+      replace_child(parent, node_index, child_index);
+   }
+
+   _nodes[node_index].children[child_side] = given_grandchild;
+   _nodes[node_index].parent = child_index;
+   _nodes[given_grandchild].parent = node_index;
+
+   update_node(node_index);
+   update_node(child_index);
+
+   return child_index;
+}
+
+}
@@ -0,0 +1,260 @@
+#pragma once
+
+#include "math/bounding_box.hpp"
+#include "math/vector_funcs.hpp"
+#include "types.hpp"
+
+#include <array>
+#include <cassert>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace we {
+
+/// @brief A binary tree of boxes that can be inserted, removed and moved without rebuilding it.
+///
+/// Inserting walks down from the root towards the sibling that adds the least surface area to
+/// the tree and each ancestor is rebalanced with tree rotations on the way back up. Boxes are
+/// enlarged slightly when inserted so small moves don't need to touch the tree.
+struct dynamic_aabb_tree {
+   constexpr static int32 null_leaf = -1;
+
+   /// @brief Insert a box.
+   /// @param bbox The box.
+   /// @param value The value to pass to query callbacks for the box.
+   /// @return The box's leaf, used to move or remove it. Leaves of removed boxes are reused.
+   [[nodiscard]] auto insert(const math::bounding_box& bbox, const uint32 value) noexcept
+      -> int32;
+
+   /// @brief Remove a box.
+   void remove(const int32 leaf) noexcept;
+
+   /// @brief Move a box. The leaf stays the same.
+   /// @return True if the tree was updated, false if the box still fits in its enlarged bounds.
+   bool move(const int32 leaf, const math::bounding_box& bbox) noexcept;
+
+   /// @brief Remove all boxes.
+   void clear() noexcept;
+
+   /// @brief Get the number of boxes in the tree.
+   [[nodiscard]] auto size() const noexcept -> std::size_t;
+
+   /// @brief Visit the boxes a ray hits, nearest box first.
+   /// @param visit Called as visit(value, max_distance) for each box hit closer than
+   /// max_distance. max_distance can be lowered to cull further boxes. Returns false to stop.
+   template<typename Visitor>
+   void raycast(const float3& ray_origin, const float3& ray_direction, float max_distance,
+                const Visitor& visit) const noexcept;
+
+   /// @brief Visit the boxes closer to a point than max_distance, nearest box first.
+   /// @param visit Called as visit(value, max_distance). max_distance can be lowered to cull
+   /// further boxes. Returns false to stop.
+   template<typename Visitor>
+   void closest(const float3& point, float max_distance, const Visitor& visit) const noexcept;
+
+   /// @brief Visit the boxes that bbox_test accepts.
+   /// @param bbox_test Returns true if a box, or a box containing other boxes, should be visited.
+   /// @param visit Called as visit(value) for each accepted box.
+   template<typename Bbox_test, typename Visitor>
+   void query(const Bbox_test& bbox_test, const Visitor& visit) const noexcept;
+
+   [[nodiscard]] auto get_debug_boxes() const noexcept -> std::vector<math::bounding_box>;
+
+private:
+   constexpr static int32 null_node = -1;
+   constexpr static int32 free_node_height = -1;
+   constexpr static int32 stack_size = 64;
+
+   struct node {
+      math::bounding_box bbox;
+      /// @brief The parent node or, for nodes in the free list, the next free node.
+      int32 parent = null_node;
+      std::array<int32, 2> children = {null_node, null_node};
+      /// @brief 0 for leaves, 1 + the height of the tallest child for inner nodes.
+      int32 height = 0;
+      uint32 value = 0;
+
+      [[nodiscard]] bool is_leaf() const noexcept
+      {
+         return children[0] == null_node;
+      }
+   };
+
+   std::vector<node> _nodes;
+   int32 _root = null_node;
+   int32 _free_node = null_node;
+   std::size_t _leaf_count = 0;
+
+   [[nodiscard]] static auto ray_distance(const float3& ray_origin,
+                                          const float3& inv_ray_direction,
+                                          const math::bounding_box& bbox,
+                                          const float max_distance) noexcept
+      -> std::optional<float>;
+
+   [[nodiscard]] static auto distance_sq(const math::bounding_box& bbox,
+                                         const float3& point) noexcept -> float;
+
+   [[nodiscard]] auto allocate_node() noexcept -> int32;
+
+   void free_node(const int32 node_index) noexcept;
+
+   void insert_leaf(const int32 leaf) noexcept;
+
+   void remove_leaf(const int32 leaf) noexcept;
+
+   void replace_child(const int32 parent, const int32 old_child,
+                      const int32 new_child) noexcept;
+
+   void refit_ancestors(int32 node_index) noexcept;
+
+   void update_node(const int32 node_index) noexcept;
+
+   [[nodiscard]] auto balance(const int32 node_index) noexcept -> int32;
+
+   [[nodiscard]] auto rotate_up(const int32 node_index, const int32 child_side) noexcept
+      -> int32;
+};
+
+template<typename Visitor>
+void dynamic_aabb_tree::raycast(const float3& ray_origin, const float3& ray_direction,
+                                float max_distance, const Visitor& visit) const noexcept
+{
+   if (_root == null_node) return;
+
+   const float3 inv_ray_direction = 1.0f / ray_direction;
+
+   struct stack_entry {
+      int32 node_index = 0;
+      float distance = 0.0f;
+   };
+
+   std::array<stack_entry, stack_size> stack;
+   int32 stack_ptr = -1;
+
+   if (const std::optional<float> distance =
+          ray_distance(ray_origin, inv_ray_direction, _nodes[_root].bbox, max_distance);
+       distance) {
+      stack_ptr += 1;
+      stack[stack_ptr] = {.node_index = _root, .distance = *distance};
+   }
+
+   while (stack_ptr >= 0) {
+      const stack_entry entry = stack[stack_ptr];
+
+      stack_ptr -= 1;
+
+      if (entry.distance > max_distance) continue;
+
+      const node& node = _nodes[entry.node_index];
+
+      if (node.is_leaf()) {
+         if (not visit(node.value, max_distance)) return;
+
+         continue;
+      }
+
+      std::array<stack_entry, 2> children;
+      int32 hit_count = 0;
+
+      for (const int32 child : node.children) {
+         if (const std::optional<float> distance =
+                ray_distance(ray_origin, inv_ray_direction, _nodes[child].bbox, max_distance);
+             distance) {
+            children[hit_count] = {.node_index = child, .distance = *distance};
+            hit_count += 1;
+         }
+      }
+
+      // Push the further child first so the nearer one is visited first.
+      if (hit_count == 2 and children[0].distance < children[1].distance) {
+         std::swap(children[0], children[1]);
+      }
+
+      assert(stack_ptr + hit_count < stack_size);
+
+      for (int32 i = 0; i < hit_count; ++i) {
+         stack_ptr += 1;
+         stack[stack_ptr] = children[i];
+      }
+   }
+}
+
+template<typename Visitor>
+void dynamic_aabb_tree::closest(const float3& point, float max_distance,
+                                const Visitor& visit) const noexcept
+{
+   if (_root == null_node) return;
+
+   struct stack_entry {
+      int32 node_index = 0;
+      float distance_sq = 0.0f;
+   };
+
+   std::array<stack_entry, stack_size> stack = {
+      stack_entry{.node_index = _root, .distance_sq = distance_sq(_nodes[_root].bbox, point)},
+   };
+   int32 stack_ptr = 0;
+
+   while (stack_ptr >= 0) {
+      const stack_entry entry = stack[stack_ptr];
+
+      stack_ptr -= 1;
+
+      if (entry.distance_sq >= max_distance * max_distance) continue;
+
+      const node& node = _nodes[entry.node_index];
+
+      if (node.is_leaf()) {
+         if (not visit(node.value, max_distance)) return;
+
+         continue;
+      }
+
+      std::array<stack_entry, 2> children = {
+         stack_entry{.node_index = node.children[0],
+                     .distance_sq = distance_sq(_nodes[node.children[0]].bbox, point)},
+         stack_entry{.node_index = node.children[1],
+                     .distance_sq = distance_sq(_nodes[node.children[1]].bbox, point)},
+      };
+
+      if (children[0].distance_sq < children[1].distance_sq) {
+         std::swap(children[0], children[1]);
+      }
+
+      assert(stack_ptr + 2 < stack_size);
+
+      stack[++stack_ptr] = children[0];
+      stack[++stack_ptr] = children[1];
+   }
+}
+
+template<typename Bbox_test, typename Visitor>
+void dynamic_aabb_tree::query(const Bbox_test& bbox_test, const Visitor& visit) const noexcept
+{
+   if (_root == null_node) return;
+
+   std::array<int32, stack_size> stack = {_root};
+   int32 stack_ptr = 0;
+
+   while (stack_ptr >= 0) {
+      const node& node = _nodes[stack[stack_ptr]];
+
+      stack_ptr -= 1;
+
+      if (not bbox_test(node.bbox)) continue;
+
+      if (node.is_leaf()) {
+         visit(node.value);
+
+         continue;
+      }
+
+      assert(stack_ptr + 2 < stack_size);
+
+      stack[++stack_ptr] = node.children[0];
+      stack[++stack_ptr] = node.children[1];
+   }
+}
+
+}
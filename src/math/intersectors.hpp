@@ -3,6 +3,8 @@
 
 #include <float.h> // FLT_EPSILON
 
+#include <array>
+
 #include <utility> // std::min, std::max (could replace)
 
 namespace we {
@@ -69,4 +71,97 @@ inline bool intersect_aabb(const float3& ray_origin, const float3& inv_ray_direc
    return false;
 }
 
+/// @brief Find the point on a triangle closest to a point. From Christer Ericson's "Real-Time
+/// Collision Detection".
+inline auto closest_point_on_tri(const float3& point, const float3& v0, const float3& v1,
+                                 const float3& v2) noexcept -> float3
+{
+   const float3 edge01 = v1 - v0;
+   const float3 edge02 = v2 - v0;
+   const float3 v0_to_point = point - v0;
+
+   const float d1 = dot(edge01, v0_to_point);
+   const float d2 = dot(edge02, v0_to_point);
+
+   if (d1 <= 0.0f and d2 <= 0.0f) return v0;
+
+   const float3 v1_to_point = point - v1;
+
+   const float d3 = dot(edge01, v1_to_point);
+   const float d4 = dot(edge02, v1_to_point);
+
+   if (d3 >= 0.0f and d4 <= d3) return v1;
+
+   const float vc = d1 * d4 - d3 * d2;
+
+   if (vc <= 0.0f and d1 >= 0.0f and d3 <= 0.0f) {
+      return v0 + edge01 * (d1 / (d1 - d3));
+   }
+
+   const float3 v2_to_point = point - v2;
+
+   const float d5 = dot(edge01, v2_to_point);
+   const float d6 = dot(edge02, v2_to_point);
+
+   if (d6 >= 0.0f and d5 <= d6) return v2;
+
+   const float vb = d5 * d2 - d1 * d6;
+
+   if (vb <= 0.0f and d2 >= 0.0f and d6 <= 0.0f) {
+      return v0 + edge02 * (d2 / (d2 - d6));
+   }
+
+   const float va = d3 * d6 - d5 * d4;
+
+   if (va <= 0.0f and (d4 - d3) >= 0.0f and (d5 - d6) >= 0.0f) {
+      return v1 + (v2 - v1) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+   }
+
+   const float denom = 1.0f / (va + vb + vc);
+
+   return v0 + edge01 * (vb * denom) + edge02 * (vc * denom);
+}
+
+/// @brief Test if a triangle overlaps an axis aligned box, using the separating axis test from
+/// Tomas Akenine-Möller's "Fast 3D Triangle-Box Overlap Testing".
+inline bool intersects_aabb_tri(const math::bounding_box& bbox, const float3& v0,
+                                const float3& v1, const float3& v2) noexcept
+{
+   const float3 center = (bbox.min + bbox.max) * 0.5f;
+   const float3 half_extents = (bbox.max - bbox.min) * 0.5f;
+
+   const std::array<float3, 3> verts = {v0 - center, v1 - center, v2 - center};
+
+   const auto separated = [&](const float3& axis) {
+      const float p0 = dot(axis, verts[0]);
+      const float p1 = dot(axis, verts[1]);
+      const float p2 = dot(axis, verts[2]);
+
+      const float radius = dot(half_extents, abs(axis));
+
+      return std::min(std::min(p0, p1), p2) > radius or
+             std::max(std::max(p0, p1), p2) < -radius;
+   };
+
+   // The box's axes.
+   if (separated({1.0f, 0.0f, 0.0f})) return false;
+   if (separated({0.0f, 1.0f, 0.0f})) return false;
+   if (separated({0.0f, 0.0f, 1.0f})) return false;
+
+   const std::array<float3, 3> edges = {verts[1] - verts[0], verts[2] - verts[1],
+                                        verts[0] - verts[2]};
+
+   // The triangle's normal.
+   if (separated(cross(edges[0], edges[1]))) return false;
+
+   // The cross products of the box's axes and the triangle's edges.
+   for (const float3& edge : edges) {
+      if (separated(cross(float3{1.0f, 0.0f, 0.0f}, edge))) return false;
+      if (separated(cross(float3{0.0f, 1.0f, 0.0f}, edge))) return false;
+      if (separated(cross(float3{0.0f, 0.0f, 1.0f}, edge))) return false;
+   }
+
+   return true;
+}
+
 }
\ No newline at end of file
@@ -1,8 +1,7 @@
 #include "scalar_funcs.hpp"
+#include "simd.hpp"
 
-#ifdef _M_X64
-#include <immintrin.h>
-#else
+#ifndef WE_SIMD_SSE2
 #include <math.h>
 #endif
 
@@ -10,7 +9,7 @@ namespace we {
 
 float sqrt(float v) noexcept
 {
-#ifdef _M_X64
+#ifdef WE_SIMD_SSE2
    _mm_store_ss(&v, _mm_sqrt_ss(_mm_load_ss(&v)));
 
    return v;
@@ -26,7 +25,7 @@ float rsqrt(float v) noexcept
 
 float fast_rsqrt(float v) noexcept
 {
-#ifdef _M_X64
+#ifdef WE_SIMD_SSE2
    _mm_store_ss(&v, _mm_rsqrt_ss(_mm_load_ss(&v)));
 
    return v;
@@ -0,0 +1,452 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define WE_SIMD_SSE2
+
+#if defined(__AVX__) || defined(__AVX2__)
+#define WE_SIMD_AVX
+#endif
+
+#else
+#define WE_SIMD_SCALAR
+#endif
+
+#ifdef WE_SIMD_SSE2
+#include <immintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#define WE_SIMD_INLINE [[msvc::forceinline]]
+#else
+#define WE_SIMD_INLINE [[gnu::always_inline]]
+#endif
+
+// A small layer over the handful of SIMD instructions used by the BVH and culling kernels. Every vector
+// type has the same interface so kernels are written once as templates and instantiated with
+// native_float4 or native_float. The scalar types are always available and give bit identical results
+// to the SSE and AVX types, which lets the tests check each path against the others.
+//
+// Masks returned by the comparisons are vectors with every bit of a lane set or clear, like the
+// instructions they wrap. movemask packs the top bit of each lane into an int.
+
+namespace we::math::simd {
+
+/// @brief Scalar fallback for an N wide vector. min and max follow SSE's (a < b ? a : b) rule so NaNs
+/// are handled the same on every path.
+template<int N>
+struct scalar_float {
+   constexpr static int width = N;
+
+   std::array<float, N> lanes;
+
+   static auto load(const float* values) noexcept -> scalar_float
+   {
+      scalar_float result;
+
+      for (int i = 0; i < N; ++i) result.lanes[i] = values[i];
+
+      return result;
+   }
+
+   static auto load_uint8(const std::uint8_t* values) noexcept -> scalar_float
+   {
+      scalar_float result;
+
+      for (int i = 0; i < N; ++i) result.lanes[i] = static_cast<float>(values[i]);
+
+      return result;
+   }
+
+   static auto broadcast(const float value) noexcept -> scalar_float
+   {
+      scalar_float result;
+
+      result.lanes.fill(value);
+
+      return result;
+   }
+
+   static auto zero() noexcept -> scalar_float
+   {
+      return broadcast(0.0f);
+   }
+
+   static auto all_true() noexcept -> scalar_float
+   {
+      return broadcast(std::bit_cast<float>(0xff'ff'ff'ffu));
+   }
+};
+
+namespace detail {
+
+template<int N, typename Op>
+WE_SIMD_INLINE inline auto lanewise(const scalar_float<N>& a, const scalar_float<N>& b,
+                                    Op op) noexcept -> scalar_float<N>
+{
+   scalar_float<N> result;
+
+   for (int i = 0; i < N; ++i) result.lanes[i] = op(a.lanes[i], b.lanes[i]);
+
+   return result;
+}
+
+WE_SIMD_INLINE inline auto to_mask(const bool value) noexcept -> float
+{
+   return std::bit_cast<float>(value ? 0xff'ff'ff'ffu : 0u);
+}
+
+}
+
+template<int N>
+WE_SIMD_INLINE inline auto add(const scalar_float<N>& a, const scalar_float<N>& b) noexcept
+   -> scalar_float<N>
+{
+   return detail::lanewise(a, b, [](float l, float r) { return l + r; });
+}
+
+template<int N>
+WE_SIMD_INLINE inline auto sub(const scalar_float<N>& a, const scalar_float<N>& b) noexcept
+   -> scalar_float<N>
+{
+   return detail::lanewise(a, b, [](float l, float r) { return l - r; });
+}
+
+template<int N>
+WE_SIMD_INLINE inline auto mul(const scalar_float<N>& a, const scalar_float<N>& b) noexcept
+   -> scalar_float<N>
+{
+   return detail::lanewise(a, b, [](float l, float r) { return l * r; });
+}
+
+template<int N>
+WE_SIMD_INLINE inline auto min(const scalar_float<N>& a, const scalar_float<N>& b) noexcept
+   -> scalar_float<N>
+{
+   return detail::lanewise(a, b, [](float l, float r) { return l < r ? l : r; });
+}
+
+template<int N>
+WE_SIMD_INLINE inline auto max(const scalar_float<N>& a, const scalar_float<N>& b) noexcept
+   -> scalar_float<N>
+{
+   return detail::lanewise(a, b, [](float l, float r) { return l > r ? l : r; });
+}
+
+template<int N>
+WE_SIMD_INLINE inline auto cmp_lt(const scalar_float<N>& a, const scalar_float<N>& b) noexcept
+   -> scalar_float<N>
+{
+   return detail::lanewise(a, b, [](float l, float r) { return detail::to_mask(l < r); });
+}
+
+template<int N>
+WE_SIMD_INLINE inline auto cmp_le(const scalar_float<N>& a, const scalar_float<N>& b) noexcept
+   -> scalar_float<N>
+{
+   return detail::lanewise(a, b, [](float l, float r) { return detail::to_mask(l <= r); });
+}
+
+template<int N>
+WE_SIMD_INLINE inline auto cmp_gt(const scalar_float<N>& a, const scalar_float<N>& b) noexcept
+   -> scalar_float<N>
+{
+   return detail::lanewise(a, b, [](float l, float r) { return detail::to_mask(l > r); });
+}
+
+template<int N>
+WE_SIMD_INLINE inline auto cmp_ge(const scalar_float<N>& a, const scalar_float<N>& b) noexcept
+   -> scalar_float<N>
+{
+   return detail::lanewise(a, b, [](float l, float r) { return detail::to_mask(l >= r); });
+}
+
+template<int N>
+WE_SIMD_INLINE inline auto mask_and(const scalar_float<N>& a, const scalar_float<N>& b) noexcept
+   -> scalar_float<N>
+{
+   return detail::lanewise(a, b, [](float l, float r) {
+      return std::bit_cast<float>(std::bit_cast<std::uint32_t>(l) &
+                                  std::bit_cast<std::uint32_t>(r));
+   });
+}
+
+template<int N>
+WE_SIMD_INLINE inline auto mask_or(const scalar_float<N>& a, const scalar_float<N>& b) noexcept
+   -> scalar_float<N>
+{
+   return detail::lanewise(a, b, [](float l, float r) {
+      return std::bit_cast<float>(std::bit_cast<std::uint32_t>(l) |
+                                  std::bit_cast<std::uint32_t>(r));
+   });
+}
+
+template<int N>
+WE_SIMD_INLINE inline auto movemask(const scalar_float<N>& v) noexcept -> int
+{
+   int mask = 0;
+
+   for (int i = 0; i < N; ++i) {
+      mask |= static_cast<int>(std::bit_cast<std::uint32_t>(v.lanes[i]) >> 31) << i;
+   }
+
+   return mask;
+}
+
+template<int N>
+WE_SIMD_INLINE inline void store(float* out, const scalar_float<N>& v) noexcept
+{
+   for (int i = 0; i < N; ++i) out[i] = v.lanes[i];
+}
+
+template<int N>
+WE_SIMD_INLINE inline auto first_lane(const scalar_float<N>& v) noexcept -> float
+{
+   return v.lanes[0];
+}
+
+#ifdef WE_SIMD_SSE2
+
+/// @brief Four floats in an SSE register. load expects 16 byte aligned memory.
+struct sse_float4 {
+   constexpr static int width = 4;
+
+   __m128 value;
+
+   WE_SIMD_INLINE static auto load(const float* values) noexcept -> sse_float4
+   {
+      return {_mm_load_ps(values)};
+   }
+
+   /// @brief Load four unsigned bytes, which need no alignment, and convert them to floats.
+   WE_SIMD_INLINE static auto load_uint8(const std::uint8_t* values) noexcept -> sse_float4
+   {
+      const __m128i zero = _mm_setzero_si128();
+      const __m128i bytes = _mm_cvtsi32_si128(std::bit_cast<int>(
+         std::array<std::uint8_t, 4>{values[0], values[1], values[2], values[3]}));
+
+      return {_mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(bytes, zero), zero))};
+   }
+
+   WE_SIMD_INLINE static auto broadcast(const float value) noexcept -> sse_float4
+   {
+      return {_mm_set1_ps(value)};
+   }
+
+   WE_SIMD_INLINE static auto zero() noexcept -> sse_float4
+   {
+      return {_mm_setzero_ps()};
+   }
+
+   WE_SIMD_INLINE static auto all_true() noexcept -> sse_float4
+   {
+      return {_mm_castsi128_ps(_mm_set1_epi32(-1))};
+   }
+};
+
+WE_SIMD_INLINE inline auto add(const sse_float4 a, const sse_float4 b) noexcept -> sse_float4
+{
+   return {_mm_add_ps(a.value, b.value)};
+}
+
+WE_SIMD_INLINE inline auto sub(const sse_float4 a, const sse_float4 b) noexcept -> sse_float4
+{
+   return {_mm_sub_ps(a.value, b.value)};
+}
+
+WE_SIMD_INLINE inline auto mul(const sse_float4 a, const sse_float4 b) noexcept -> sse_float4
+{
+   return {_mm_mul_ps(a.value, b.value)};
+}
+
+WE_SIMD_INLINE inline auto min(const sse_float4 a, const sse_float4 b) noexcept -> sse_float4
+{
+   return {_mm_min_ps(a.value, b.value)};
+}
+
+WE_SIMD_INLINE inline auto max(const sse_float4 a, const sse_float4 b) noexcept -> sse_float4
+{
+   return {_mm_max_ps(a.value, b.value)};
+}
+
+WE_SIMD_INLINE inline auto cmp_lt(const sse_float4 a, const sse_float4 b) noexcept -> sse_float4
+{
+   return {_mm_cmplt_ps(a.value, b.value)};
+}
+
+WE_SIMD_INLINE inline auto cmp_le(const sse_float4 a, const sse_float4 b) noexcept -> sse_float4
+{
+   return {_mm_cmple_ps(a.value, b.value)};
+}
+
+WE_SIMD_INLINE inline auto cmp_gt(const sse_float4 a, const sse_float4 b) noexcept -> sse_float4
+{
+   return {_mm_cmpgt_ps(a.value, b.value)};
+}
+
+WE_SIMD_INLINE inline auto cmp_ge(const sse_float4 a, const sse_float4 b) noexcept -> sse_float4
+{
+   return {_mm_cmpge_ps(a.value, b.value)};
+}
+
+WE_SIMD_INLINE inline auto mask_and(const sse_float4 a, const sse_float4 b) noexcept
+   -> sse_float4
+{
+   return {_mm_and_ps(a.value, b.value)};
+}
+
+WE_SIMD_INLINE inline auto mask_or(const sse_float4 a, const sse_float4 b) noexcept
+   -> sse_float4
+{
+   return {_mm_or_ps(a.value, b.value)};
+}
+
+WE_SIMD_INLINE inline auto movemask(const sse_float4 v) noexcept -> int
+{
+   return _mm_movemask_ps(v.value);
+}
+
+WE_SIMD_INLINE inline void store(float* out, const sse_float4 v) noexcept
+{
+   _mm_store_ps(out, v.value);
+}
+
+WE_SIMD_INLINE inline auto first_lane(const sse_float4 v) noexcept -> float
+{
+   return _mm_cvtss_f32(v.value);
+}
+
+#endif
+
+#ifdef WE_SIMD_AVX
+
+/// @brief Eight floats in an AVX register. load expects 32 byte aligned memory.
+struct avx_float8 {
+   constexpr static int width = 8;
+
+   __m256 value;
+
+   WE_SIMD_INLINE static auto load(const float* values) noexcept -> avx_float8
+   {
+      return {_mm256_load_ps(values)};
+   }
+
+   /// @brief Load eight unsigned bytes, which need no alignment, and convert them to floats.
+   WE_SIMD_INLINE static auto load_uint8(const std::uint8_t* values) noexcept -> avx_float8
+   {
+      const __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(values));
+      const __m128i low = _mm_cvtepu8_epi32(bytes);
+      const __m128i high = _mm_cvtepu8_epi32(_mm_srli_si128(bytes, 4));
+
+      return {_mm256_cvtepi32_ps(
+         _mm256_insertf128_si256(_mm256_castsi128_si256(low), high, 1))};
+   }
+
+   WE_SIMD_INLINE static auto broadcast(const float value) noexcept -> avx_float8
+   {
+      return {_mm256_set1_ps(value)};
+   }
+
+   WE_SIMD_INLINE static auto zero() noexcept -> avx_float8
+   {
+      return {_mm256_setzero_ps()};
+   }
+
+   WE_SIMD_INLINE static auto all_true() noexcept -> avx_float8
+   {
+      return {_mm256_castsi256_ps(_mm256_set1_epi32(-1))};
+   }
+};
+
+WE_SIMD_INLINE inline auto add(const avx_float8 a, const avx_float8 b) noexcept -> avx_float8
+{
+   return {_mm256_add_ps(a.value, b.value)};
+}
+
+WE_SIMD_INLINE inline auto sub(const avx_float8 a, const avx_float8 b) noexcept -> avx_float8
+{
+   return {_mm256_sub_ps(a.value, b.value)};
+}
+
+WE_SIMD_INLINE inline auto mul(const avx_float8 a, const avx_float8 b) noexcept -> avx_float8
+{
+   return {_mm256_mul_ps(a.value, b.value)};
+}
+
+WE_SIMD_INLINE inline auto min(const avx_float8 a, const avx_float8 b) noexcept -> avx_float8
+{
+   return {_mm256_min_ps(a.value, b.value)};
+}
+
+WE_SIMD_INLINE inline auto max(const avx_float8 a, const avx_float8 b) noexcept -> avx_float8
+{
+   return {_mm256_max_ps(a.value, b.value)};
+}
+
+WE_SIMD_INLINE inline auto cmp_lt(const avx_float8 a, const avx_float8 b) noexcept -> avx_float8
+{
+   return {_mm256_cmp_ps(a.value, b.value, _CMP_LT_OQ)};
+}
+
+WE_SIMD_INLINE inline auto cmp_le(const avx_float8 a, const avx_float8 b) noexcept -> avx_float8
+{
+   return {_mm256_cmp_ps(a.value, b.value, _CMP_LE_OQ)};
+}
+
+WE_SIMD_INLINE inline auto cmp_gt(const avx_float8 a, const avx_float8 b) noexcept -> avx_float8
+{
+   return {_mm256_cmp_ps(a.value, b.value, _CMP_GT_OQ)};
+}
+
+WE_SIMD_INLINE inline auto cmp_ge(const avx_float8 a, const avx_float8 b) noexcept -> avx_float8
+{
+   return {_mm256_cmp_ps(a.value, b.value, _CMP_GE_OQ)};
+}
+
+WE_SIMD_INLINE inline auto mask_and(const avx_float8 a, const avx_float8 b) noexcept
+   -> avx_float8
+{
+   return {_mm256_and_ps(a.value, b.value)};
+}
+
+WE_SIMD_INLINE inline auto mask_or(const avx_float8 a, const avx_float8 b) noexcept
+   -> avx_float8
+{
+   return {_mm256_or_ps(a.value, b.value)};
+}
+
+WE_SIMD_INLINE inline auto movemask(const avx_float8 v) noexcept -> int
+{
+   return _mm256_movemask_ps(v.value);
+}
+
+WE_SIMD_INLINE inline void store(float* out, const avx_float8 v) noexcept
+{
+   _mm256_store_ps(out, v.value);
+}
+
+WE_SIMD_INLINE inline auto first_lane(const avx_float8 v) noexcept -> float
+{
+   return _mm256_cvtss_f32(v.value);
+}
+
+#endif
+
+#ifdef WE_SIMD_SSE2
+using native_float4 = sse_float4;
+#else
+using native_float4 = scalar_float<4>;
+#endif
+
+#if defined(WE_SIMD_AVX)
+using native_float = avx_float8;
+#elif defined(WE_SIMD_SSE2)
+using native_float = sse_float4;
+#else
+using native_float = scalar_float<4>;
+#endif
+
+}
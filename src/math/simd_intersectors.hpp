@@ -0,0 +1,185 @@
+#pragma once
+
+#include "frustum.hpp"
+#include "simd.hpp"
+
+// Intersection kernels testing V::width boxes at once, V being any of the vector types from simd.hpp.
+// Boxes are passed as structure of arrays, one vector per component.
+
+namespace we::math::simd {
+
+/// @brief Intersect a ray against V::width boxes.
+/// @return A mask of the boxes hit before t_limit. The entry distance for each box is written to t.
+template<typename V>
+WE_SIMD_INLINE inline auto intersect_aabb(const V ray_origin_x,        //
+                                          const V ray_origin_y,        //
+                                          const V ray_origin_z,        //
+                                          const V inv_ray_direction_x, //
+                                          const V inv_ray_direction_y, //
+                                          const V inv_ray_direction_z, //
+                                          const V bbox_min_x,          //
+                                          const V bbox_min_y,          //
+                                          const V bbox_min_z,          //
+                                          const V bbox_max_x,          //
+                                          const V bbox_max_y,          //
+                                          const V bbox_max_z,          //
+                                          const V t_limit,             //
+                                          V& t) noexcept -> int
+{
+   const V ts0_x = mul(sub(bbox_min_x, ray_origin_x), inv_ray_direction_x);
+   const V ts0_y = mul(sub(bbox_min_y, ray_origin_y), inv_ray_direction_y);
+   const V ts0_z = mul(sub(bbox_min_z, ray_origin_z), inv_ray_direction_z);
+
+   const V ts1_x = mul(sub(bbox_max_x, ray_origin_x), inv_ray_direction_x);
+   const V ts1_y = mul(sub(bbox_max_y, ray_origin_y), inv_ray_direction_y);
+   const V ts1_z = mul(sub(bbox_max_z, ray_origin_z), inv_ray_direction_z);
+
+   const V ts_min_x = min(ts0_x, ts1_x);
+   const V ts_min_y = min(ts0_y, ts1_y);
+   const V ts_min_z = min(ts0_z, ts1_z);
+
+   const V ts_max_x = max(ts0_x, ts1_x);
+   const V ts_max_y = max(ts0_y, ts1_y);
+   const V ts_max_z = max(ts0_z, ts1_z);
+
+   const V t_min = max(max(ts_min_x, ts_min_y), ts_min_z);
+   const V t_max = min(min(min(ts_max_x, ts_max_y), ts_max_z), t_limit);
+
+   t = t_min;
+
+   return movemask(cmp_le(t_min, t_max));
+}
+
+/// @brief Get a mask of the lanes where a point is behind a plane.
+template<typename V>
+WE_SIMD_INLINE inline auto outside_plane(const V plane_x, const V plane_y,
+                                         const V plane_z, const V plane_w,
+                                         const V point_x, const V point_y,
+                                         const V point_z) noexcept -> V
+{
+   const V xy_sum = add(mul(plane_x, point_x), mul(plane_y, point_y));
+   const V zw_sum = add(mul(plane_z, point_z), plane_w);
+
+   return cmp_lt(add(xy_sum, zw_sum), V::zero());
+}
+
+/// @brief Get a mask of the lanes where every corner of a box is behind a plane.
+template<typename V>
+WE_SIMD_INLINE inline auto outside_plane(const float4& plane, const V bbox_min_x,
+                                         const V bbox_min_y, const V bbox_min_z,
+                                         const V bbox_max_x, const V bbox_max_y,
+                                         const V bbox_max_z) noexcept -> V
+{
+   const V plane_x = V::broadcast(plane.x);
+   const V plane_y = V::broadcast(plane.y);
+   const V plane_z = V::broadcast(plane.z);
+   const V plane_w = V::broadcast(plane.w);
+
+   const V corner01_outside =
+      mask_and(outside_plane(plane_x, plane_y, plane_z, plane_w, bbox_min_x,
+                             bbox_min_y, bbox_min_z),
+               outside_plane(plane_x, plane_y, plane_z, plane_w, bbox_max_x,
+                             bbox_min_y, bbox_min_z));
+   const V corner23_outside =
+      mask_and(outside_plane(plane_x, plane_y, plane_z, plane_w, bbox_min_x,
+                             bbox_max_y, bbox_min_z),
+               outside_plane(plane_x, plane_y, plane_z, plane_w, bbox_max_x,
+                             bbox_max_y, bbox_min_z));
+   const V corner45_outside =
+      mask_and(outside_plane(plane_x, plane_y, plane_z, plane_w, bbox_min_x,
+                             bbox_min_y, bbox_max_z),
+               outside_plane(plane_x, plane_y, plane_z, plane_w, bbox_max_x,
+                             bbox_min_y, bbox_max_z));
+   const V corner67_outside =
+      mask_and(outside_plane(plane_x, plane_y, plane_z, plane_w, bbox_min_x,
+                             bbox_max_y, bbox_max_z),
+               outside_plane(plane_x, plane_y, plane_z, plane_w, bbox_max_x,
+                             bbox_max_y, bbox_max_z));
+
+   return mask_and(mask_and(corner01_outside, corner23_outside),
+                   mask_and(corner45_outside, corner67_outside));
+}
+
+/// @brief Get a mask of the lanes where every corner of the frustum is on one side of a box along an axis.
+template<typename V>
+WE_SIMD_INLINE inline auto outside_corners(const frustum& frustum,
+                                           const float float3::* axis,
+                                           const V bbox_corner_min,
+                                           const V bbox_corner_max) noexcept -> V
+{
+   V outside_min_mask = V::all_true();
+   V outside_max_mask = outside_min_mask;
+
+   for (const float3& frustum_corner : frustum.corners) {
+      const V corner = V::broadcast(frustum_corner.*axis);
+
+      outside_min_mask = mask_and(outside_min_mask, cmp_lt(corner, bbox_corner_min));
+      outside_max_mask = mask_and(outside_max_mask, cmp_gt(corner, bbox_corner_max));
+   }
+
+   return mask_or(outside_min_mask, outside_max_mask);
+}
+
+/// @brief Test V::width boxes against a frustum, the same test as we::intersects(frustum, bbox) for each box.
+/// @return A mask of the boxes that intersect the frustum.
+template<typename V>
+WE_SIMD_INLINE inline auto intersects_frustum(const frustum& frustum, //
+                                              const V bbox_min_x,     //
+                                              const V bbox_min_y,     //
+                                              const V bbox_min_z,     //
+                                              const V bbox_max_x,     //
+                                              const V bbox_max_y,     //
+                                              const V bbox_max_z) noexcept -> int
+{
+   int intersects = (1 << V::width) - 1;
+
+   for (const float4& plane : frustum.planes) {
+      intersects &= ~movemask(outside_plane(plane, bbox_min_x, bbox_min_y, bbox_min_z,
+                                            bbox_max_x, bbox_max_y, bbox_max_z));
+
+      if (intersects == 0) return 0;
+   }
+
+   intersects &=
+      ~movemask(outside_corners(frustum, &float3::x, bbox_min_x, bbox_max_x));
+
+   if (intersects == 0) return 0;
+
+   intersects &=
+      ~movemask(outside_corners(frustum, &float3::y, bbox_min_y, bbox_max_y));
+
+   if (intersects == 0) return 0;
+
+   intersects &=
+      ~movemask(outside_corners(frustum, &float3::z, bbox_min_z, bbox_max_z));
+
+   return intersects;
+}
+
+/// @brief Test V::width boxes against a shadow cascade's frustum, the same test as
+/// we::intersects_shadow_cascade(frustum, bbox) for each box. The near plane is skipped.
+/// @return A mask of the boxes that intersect the frustum.
+template<typename V>
+WE_SIMD_INLINE inline auto intersects_frustum_shadow_cascade(
+   const frustum& frustum, //
+   const V bbox_min_x,     //
+   const V bbox_min_y,     //
+   const V bbox_min_z,     //
+   const V bbox_max_x,     //
+   const V bbox_max_y,     //
+   const V bbox_max_z) noexcept -> int
+{
+   int intersects = (1 << V::width) - 1;
+
+   for (std::size_t plane_index = 1; plane_index < frustum.planes.size(); ++plane_index) {
+      intersects &= ~movemask(outside_plane(frustum.planes[plane_index], bbox_min_x,
+                                            bbox_min_y, bbox_min_z, bbox_max_x,
+                                            bbox_max_y, bbox_max_z));
+
+      if (intersects == 0) return 0;
+   }
+
+   return intersects;
+}
+
+}
@@ -58,6 +58,8 @@ void execute_builtin_munge(const execute_builtin_context& context,
 
       for (io::directory_iterator it = io::directory_iterator{tool_context.source_path};
            it != it.end(); ++it) {
+         if (tool_context.stop_token.stop_requested()) break;
+
          const io::directory_entry& entry = *it;
 
          if (entry.is_file and iequals(entry.path.extension(), input_extension)) {
@@ -84,6 +86,8 @@ void execute_builtin_munge(const execute_builtin_context& context,
                   .exec(async::task_priority::low, [input_file_path = entry.path,
                                                     folder_options = folder_options,
                                                     &context, &tool_context] {
+                     if (tool_context.stop_token.stop_requested()) return;
+
                      context.execute_munge(input_file_path,
                                            folder_options
                                               ? *folder_options
@@ -123,6 +127,13 @@ void execute_builtin_munge(const execute_builtin_context& context,
    }
 
    for (std::ptrdiff_t i = std::ssize(munge_tasks) - 1; i >= 0; --i) {
+      // Queued munges are discarded once stop has been requested instead of waited on.
+      if (tool_context.stop_token.stop_requested()) {
+         munge_tasks[i].task.cancel();
+
+         continue;
+      }
+
       try {
          munge_tasks[i].task.get();
       }
@@ -70,6 +70,7 @@ struct munge_context {
 
    munge_feedback feedback;
    async::thread_pool& thread_pool;
+   std::stop_token stop_token = {};
 };
 
 struct deploy_target {
@@ -1117,6 +1118,8 @@ void execute_sound_common_bank_munge(const tool_context& context)
 
 void execute_tool(const tool& tool, const tool_context& context)
 {
+   if (context.stop_token.stop_requested()) return;
+
    switch (tool.type) {
    case tool_type::animation_munge:
       std::terminate();
@@ -1331,7 +1334,7 @@ void execute_tool(const tool& tool, const tool_context& context)
 void execute_custom_commands(const std::span<const project_custom_command> commands,
                              const tool_context& context)
 {
-   if (commands.empty()) return;
+   if (commands.empty() or context.stop_token.stop_requested()) return;
 
    using string::template_string_var;
 
@@ -1427,7 +1430,10 @@ auto execute_async_task(munge_context& context, std::invocable auto func) noexce
 {
    return context.thread_pool
       .exec(async::task_priority::low, [&feedback = context.feedback,
+                                        stop_token = context.stop_token,
                                         func = std::move(func)]() noexcept {
+         if (stop_token.stop_requested()) return;
+
          try {
             func();
          }
@@ -1906,6 +1912,7 @@ auto run_munge(munge_context& context) -> report
       .platform = context.platform,
       .feedback = context.feedback,
       .thread_pool = context.thread_pool,
+      .stop_token = context.stop_token,
 
       .use_builtin_model_munge = context.project.config.use_builtin_model_munge,
       .use_builtin_odf_munge = context.project.config.use_builtin_odf_munge,
@@ -2393,6 +2400,16 @@ auto run_munge(munge_context& context) -> report
       tasks[i].wait();
    }
 
+   if (context.stop_token.stop_requested()) {
+      context.feedback.print_output("Munge Canceled");
+      context.feedback.print_output(fmt::format("Time Taken: {:.3f}s", timer.elapsed()));
+
+      return {
+         .warnings = context.feedback.take_warnings(),
+         .errors = context.feedback.take_errors(),
+      };
+   }
+
    context.feedback.print_output("Munge Finished");
    context.feedback.print_output(fmt::format("Time Taken: {:.3f}s", timer.elapsed()));
 
@@ -2785,7 +2802,8 @@ struct manager::impl {
          async::task_priority::low,
          [platform = get_platform(), project = _project,
           deploy_directory = deploy_directory, &standard_output = _standard_output,
-          &standard_error = _standard_error, &thread_pool = _thread_pool] {
+          &standard_error = _standard_error,
+          &thread_pool = _thread_pool](const std::stop_token stop_token) {
             try {
                munge_context context = {
                   .platform = platform,
@@ -2793,6 +2811,7 @@ struct manager::impl {
                   .deploy_directory = deploy_directory,
                   .feedback = munge_feedback{standard_output, standard_error},
                   .thread_pool = thread_pool,
+                  .stop_token = stop_token,
                };
 
                return run_munge(context);
@@ -2844,12 +2863,13 @@ struct manager::impl {
                            [platform = get_platform(), project = _project,
                             &standard_output = _standard_output,
                             &standard_error = _standard_error,
-                            &thread_pool = _thread_pool] {
+                            &thread_pool = _thread_pool](const std::stop_token stop_token) {
                               munge_context context = {
                                  .platform = platform,
                                  .project = project,
                                  .feedback = munge_feedback{standard_output, standard_error},
                                  .thread_pool = thread_pool,
+                                 .stop_token = stop_token,
                               };
 
                               return run_clean(context);
@@ -2871,6 +2891,13 @@ struct manager::impl {
       return _munge_task.valid() and not _munge_task.ready();
    }
 
+   void cancel() noexcept
+   {
+      if (not _munge_task.valid()) return;
+
+      _munge_task.request_stop();
+   }
+
    void wait_for_idle() const noexcept
    {
       if (not _munge_task.valid()) return;
@@ -2953,6 +2980,11 @@ bool manager::is_busy() const noexcept
    return impl->is_busy();
 }
 
+void manager::cancel() noexcept
+{
+   impl->cancel();
+}
+
 void manager::wait_for_idle() const noexcept
 {
    return impl->wait_for_idle();
@@ -41,6 +41,10 @@ struct manager {
 
    bool is_busy() const noexcept;
 
+   /// @brief Request the running munge stops. External tools that are already running are left to finish but builtin
+   /// munges stop queueing files and no further tools are started.
+   void cancel() noexcept;
+
    /// @brief Wait for the munge manager to be idle.
    void wait_for_idle() const noexcept;
 
@@ -9,6 +9,7 @@
 
 #include "os/process.hpp"
 
+#include <stop_token>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -26,6 +27,8 @@ struct tool_context {
    std::vector<std::string> sound_languages;
    munge_feedback& feedback;
    async::thread_pool& thread_pool;
+   /// @brief Stop is requested on this when the munge is canceled. Tools should stop queueing work once it has been.
+   std::stop_token stop_token = {};
 
    bool use_builtin_model_munge = true;
    bool use_builtin_odf_munge = true;
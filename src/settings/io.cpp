@@ -194,6 +194,7 @@ auto load(const std::string_view path) -> settings
             setting_entry(save_world_bf1_format);
             setting_entry(dont_save_world_effects);
             setting_entry(save_blocks_into_layer);
+            setting_entry(use_world_cache);
             setting_entry(dont_ask_to_add_animation_to_group);
             setting_entry(dont_extrapolate_new_animation_keys);
             setting_entry(ask_confirmation_before_clean);
@@ -330,6 +331,7 @@ void save(const std::string_view path, const settings& settings) noexcept
       write(file, name_value(save_world_bf1_format));
       write(file, name_value(dont_save_world_effects));
       write(file, name_value(save_blocks_into_layer));
+      write(file, name_value(use_world_cache));
       write(file, name_value(dont_ask_to_add_animation_to_group));
       write(file, name_value(dont_extrapolate_new_animation_keys));
       write(file, name_value(ask_confirmation_before_clean));
@@ -18,6 +18,7 @@ struct preferences {
    bool dont_save_world_effects = false;
    bool save_world_bf1_format = false;
    bool save_blocks_into_layer = true;
+   bool use_world_cache = false;
    bool dont_ask_to_add_animation_to_group = false;
    bool dont_extrapolate_new_animation_keys = false;
    bool ask_confirmation_before_clean = false;
@@ -165,6 +165,13 @@ void show_imgui_editor(settings& settings, bool& open,
             ImGui::Checkbox("Ask for Confirmation Before Clean",
                             &preferences.ask_confirmation_before_clean);
 
+            ImGui::Checkbox("Cache Loaded Worlds", &preferences.use_world_cache);
+
+            ImGui::SetItemTooltip(
+               "Save a .wecache file next to worlds when they're loaded and load "
+               "their layers from it the next time if none of the layer files have "
+               "changed.");
+
             ImGui::SeparatorText("World Configuration Defaults");
 
             ImGui::SetItemTooltip(
@@ -1,5 +1,8 @@
 #include "bvh.hpp"
 
+#include <algorithm>
+#include <cassert>
+
 namespace we::world {
 
 block_bvh::block_bvh() noexcept = default;
@@ -16,14 +19,16 @@ block_bvh::block_bvh(const block_bvh& other)
 {
    _vertices = other._vertices;
    _triangles = other._triangles;
-   _bvh = bvh{_triangles, _vertices, bvh_flags{}};
+   _bvh = other._bvh.copy(_triangles, _vertices);
 }
 
 auto block_bvh::operator=(const block_bvh& other) noexcept -> block_bvh&
 {
+   if (this == &other) return *this;
+
    _vertices = other._vertices;
    _triangles = other._triangles;
-   _bvh = bvh{_triangles, _vertices, bvh_flags{}};
+   _bvh = other._bvh.copy(_triangles, _vertices);
 
    return *this;
 }
@@ -40,4 +45,19 @@ bool block_bvh::intersects(const frustum& frustum) const noexcept
    return _bvh.intersects(frustum);
 }
 
+bool block_bvh::same_topology(std::span<const std::array<uint16, 3>> triangles,
+                              const std::size_t vertex_count) const noexcept
+{
+   return vertex_count == _vertices.size() and std::ranges::equal(triangles, _triangles);
+}
+
+void block_bvh::refit(std::span<const float3> vertices) noexcept
+{
+   assert(vertices.size() == _vertices.size());
+
+   std::ranges::copy(vertices, _vertices.begin());
+
+   if (not _bvh.refit(_vertices)) _bvh = bvh{_triangles, _vertices, bvh_flags{}};
+}
+
 }
\ No newline at end of file
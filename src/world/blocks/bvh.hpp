@@ -31,6 +31,17 @@ struct block_bvh {
 
    [[nodiscard]] bool intersects(const frustum& frustum) const noexcept;
 
+   /// @brief Check if a mesh has the same triangles as the one the BVH was built for, so the BVH can be refit for it.
+   /// @param triangles The triangles of the mesh.
+   /// @param vertex_count The vertex count of the mesh.
+   /// @return True if the BVH can be refit for the mesh.
+   [[nodiscard]] bool same_topology(std::span<const std::array<uint16, 3>> triangles,
+                                    const std::size_t vertex_count) const noexcept;
+
+   /// @brief Refit the BVH for new vertices, rebuilding it instead if refitting would degrade it too much.
+   /// @param vertices The new vertices. Must pass same_topology.
+   void refit(std::span<const float3> vertices) noexcept;
+
 private:
    std::vector<std::array<uint16, 3>> _triangles;
    std::vector<float3> _vertices;
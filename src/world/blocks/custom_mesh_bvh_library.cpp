@@ -5,6 +5,10 @@
 #include "async/thread_pool.hpp"
 #include "container/pinned_vector.hpp"
 
+#include <algorithm>
+#include <memory>
+#include <vector>
+
 namespace we::world {
 
 namespace {
@@ -21,6 +25,10 @@ struct blocks_custom_mesh_bvh_library::impl {
          _bvh_pool.resize(library.pool_size());
       }
 
+      // BVHs of meshes removed this update. Editing a block's mesh removes the old mesh and adds
+      // the new one, when only the vertices have moved the old BVH is refit instead of rebuilt.
+      std::vector<block_bvh> removed_bvhs;
+
       for (const world::blocks_custom_mesh_library::event event : library.events()) {
          using event_type = blocks_custom_mesh_library::event_type;
 
@@ -41,7 +49,6 @@ struct blocks_custom_mesh_bvh_library::impl {
             const world::block_custom_mesh& mesh = library[event.handle];
 
             std::vector<float3> vertices;
-            std::vector<std::array<uint16, 3>> triangles = mesh.triangles;
 
             vertices.resize(mesh.vertices.size());
 
@@ -49,12 +56,33 @@ struct blocks_custom_mesh_bvh_library::impl {
                vertices[i] = mesh.vertices[i].position;
             }
 
-            _bvh_pool[mesh_index] =
-               entry{.build_task = thread_pool.exec(
-                        [vertices = std::move(vertices),
-                         triangles = std::move(triangles)]() -> block_bvh {
-                           return {std::move(triangles), std::move(vertices)};
-                        })};
+            if (auto refittable =
+                   std::ranges::find_if(removed_bvhs,
+                                        [&](const block_bvh& bvh) {
+                                           return bvh.same_topology(mesh.triangles,
+                                                                    mesh.vertices.size());
+                                        });
+                refittable != removed_bvhs.end()) {
+               _bvh_pool[mesh_index] =
+                  entry{.build_task = thread_pool.exec(
+                           [bvh = std::make_unique<block_bvh>(std::move(*refittable)),
+                            vertices = std::move(vertices)]() -> block_bvh {
+                              bvh->refit(vertices);
+
+                              return std::move(*bvh);
+                           })};
+
+               removed_bvhs.erase(refittable);
+            }
+            else {
+               _bvh_pool[mesh_index] =
+                  entry{.build_task = thread_pool.exec(
+                           [vertices = std::move(vertices),
+                            triangles = mesh.triangles]() -> block_bvh {
+                              return {std::move(triangles), std::move(vertices)};
+                           })};
+            }
+
             _build_list.push_back(mesh_index);
          } break;
          case event_type::mesh_removed: {
@@ -70,6 +98,9 @@ struct blocks_custom_mesh_bvh_library::impl {
 
                erase(_build_list, mesh_index);
             }
+            else {
+               removed_bvhs.push_back(std::move(entry.bvh));
+            }
 
             entry = {};
          } break;
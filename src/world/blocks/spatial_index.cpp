@@ -0,0 +1,77 @@
+#include "spatial_index.hpp"
+
+#include <algorithm>
+
+namespace we::world {
+
+namespace {
+
+auto get_bbox(const blocks_bbox_soa& bbox, const uint32 block_index) noexcept
+   -> math::bounding_box
+{
+   return {.min = {bbox.min_x[block_index], bbox.min_y[block_index], bbox.min_z[block_index]},
+           .max = {bbox.max_x[block_index], bbox.max_y[block_index], bbox.max_z[block_index]}};
+}
+
+}
+
+void blocks_spatial_index::update(const blocks& blocks) noexcept
+{
+   const auto update_tree = [this](const block_type type, const auto& blocks_of_type) {
+      _trees[static_cast<std::size_t>(type)].update(blocks_of_type.bbox, blocks_of_type.size(),
+                                                    blocks_of_type.dirty);
+   };
+
+   update_tree(block_type::box, blocks.boxes);
+   update_tree(block_type::ramp, blocks.ramps);
+   update_tree(block_type::quad, blocks.quads);
+   update_tree(block_type::custom, blocks.custom);
+   update_tree(block_type::hemisphere, blocks.hemispheres);
+   update_tree(block_type::pyramid, blocks.pyramids);
+   update_tree(block_type::terrain_cut_box, blocks.terrain_cut_boxes);
+}
+
+void blocks_spatial_index::clear() noexcept
+{
+   for (block_tree& tree : _trees) {
+      tree.tree.clear();
+      tree.leaves.clear();
+   }
+}
+
+auto blocks_spatial_index::get_debug_boxes(const block_type type) const noexcept
+   -> std::vector<math::bounding_box>
+{
+   return _trees[static_cast<std::size_t>(type)].tree.get_debug_boxes();
+}
+
+/// @brief Blocks are only ever added to the end of their arrays. Removing a block from the
+/// middle marks every block after it as dirty, so leaves never need to be renumbered. Only the
+/// leaves past the end need removing and the dirty leaves need moving.
+void blocks_spatial_index::block_tree::update(const blocks_bbox_soa& bbox,
+                                              const std::size_t block_count,
+                                              const blocks_dirty_range_tracker& dirty) noexcept
+{
+   while (leaves.size() > block_count) {
+      tree.remove(leaves.back());
+      leaves.pop_back();
+   }
+
+   const uint32 existing_count = static_cast<uint32>(leaves.size());
+
+   for (const blocks_dirty_range& range : dirty) {
+      const uint32 end = std::min(range.end, existing_count);
+
+      for (uint32 block_index = range.begin; block_index < end; ++block_index) {
+         tree.move(leaves[block_index], get_bbox(bbox, block_index));
+      }
+   }
+
+   leaves.reserve(block_count);
+
+   for (uint32 block_index = existing_count; block_index < block_count; ++block_index) {
+      leaves.push_back(tree.insert(get_bbox(bbox, block_index), block_index));
+   }
+}
+
+}
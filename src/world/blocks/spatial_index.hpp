@@ -0,0 +1,61 @@
+#pragma once
+
+#include "../blocks.hpp"
+
+#include "math/bounding_box.hpp"
+#include "math/dynamic_aabb_tree.hpp"
+
+#include <array>
+#include <vector>
+
+namespace we::world {
+
+/// @brief Bounding box trees over the blocks in a world, one tree per block type, used to find
+/// the blocks a ray or frustum could touch without testing every block.
+struct blocks_spatial_index {
+   /// @brief Update the index from the blocks' dirty ranges. The blocks' dirty ranges mustn't have
+   /// been cleared since the last call to update.
+   /// @param blocks The blocks to mirror.
+   void update(const blocks& blocks) noexcept;
+
+   /// @brief Remove everything from the index.
+   void clear() noexcept;
+
+   /// @brief Visit the blocks of a type whose bounds a ray hits, nearest first.
+   /// @param visit Called as visit(block_index, max_distance) for each block. max_distance can
+   /// be lowered to cull further blocks. Returns false to stop.
+   template<typename Visitor>
+   void raycast(const block_type type, const float3& ray_origin, const float3& ray_direction,
+                const float max_distance, const Visitor& visit) const noexcept
+   {
+      _trees[static_cast<std::size_t>(type)].tree.raycast(ray_origin, ray_direction,
+                                                          max_distance, visit);
+   }
+
+   /// @brief Visit the blocks of a type whose bounds bbox_test accepts.
+   /// @param bbox_test Returns true if a box, or a box containing other boxes, should be visited.
+   /// @param visit Called as visit(block_index) for each block.
+   template<typename Bbox_test, typename Visitor>
+   void query(const block_type type, const Bbox_test& bbox_test,
+              const Visitor& visit) const noexcept
+   {
+      _trees[static_cast<std::size_t>(type)].tree.query(bbox_test, visit);
+   }
+
+   [[nodiscard]] auto get_debug_boxes(const block_type type) const noexcept
+      -> std::vector<math::bounding_box>;
+
+private:
+   struct block_tree {
+      dynamic_aabb_tree tree;
+      /// @brief The leaf of each block, indexed by the block's index.
+      std::vector<int32> leaves;
+
+      void update(const blocks_bbox_soa& bbox, const std::size_t block_count,
+                  const blocks_dirty_range_tracker& dirty) noexcept;
+   };
+
+   std::array<block_tree, static_cast<std::size_t>(block_type::terrain_cut_box) + 1> _trees;
+};
+
+}
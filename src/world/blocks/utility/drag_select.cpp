@@ -2,20 +2,44 @@
 
 #include "../bvh.hpp"
 #include "../custom_mesh_bvh_library.hpp"
+#include "../spatial_index.hpp"
 
 #include "math/quaternion_funcs.hpp"
 #include "math/vector_funcs.hpp"
 
 namespace we::world {
 
-void drag_select(const blocks& blocks, const active_layers active_layers,
-                 const blocks_custom_mesh_bvh_library& bvh_library,
-                 const frustum& frustumWS, block_drag_select_op op,
-                 selection& selection) noexcept
+namespace {
+
+/// @brief Call visit(block_index) for each block whose bounds could intersect the frustum, or
+/// for every block if there is no index.
+template<typename Visitor>
+void for_each_candidate(const blocks_spatial_index* index, const block_type type,
+                        const std::size_t block_count, const frustum& frustumWS,
+                        const Visitor& visit) noexcept
+{
+   if (index) {
+      index->query(
+         type, [&](const math::bounding_box& bbox) { return intersects(frustumWS, bbox); },
+         [&](const uint32 block_index) {
+            if (block_index < block_count) visit(block_index);
+         });
+   }
+   else {
+      for (uint32 block_index = 0; block_index < block_count; ++block_index) {
+         visit(block_index);
+      }
+   }
+}
+
+void drag_select_impl(const blocks& blocks, const active_layers active_layers,
+                      const blocks_custom_mesh_bvh_library& bvh_library,
+                      const blocks_spatial_index* index, const frustum& frustumWS,
+                      block_drag_select_op op, selection& selection) noexcept
 {
-   for (uint32 block_index = 0; block_index < blocks.boxes.size(); ++block_index) {
-      if (blocks.boxes.hidden[block_index]) continue;
-      if (not active_layers[blocks.boxes.layer[block_index]]) continue;
+   const auto select_box = [&](const uint32 block_index) {
+      if (blocks.boxes.hidden[block_index]) return;
+      if (not active_layers[blocks.boxes.layer[block_index]]) return;
 
       if (intersects(frustumWS, {.min =
                                     {
@@ -35,11 +59,13 @@ void drag_select(const blocks& blocks, const active_layers active_layers,
             selection.remove(block_id{blocks.boxes.ids[block_index]});
          }
       }
-   }
+   };
+
+   for_each_candidate(index, block_type::box, blocks.boxes.size(), frustumWS, select_box);
 
-   for (uint32 block_index = 0; block_index < blocks.ramps.size(); ++block_index) {
-      if (blocks.ramps.hidden[block_index]) continue;
-      if (not active_layers[blocks.ramps.layer[block_index]]) continue;
+   const auto select_ramp = [&](const uint32 block_index) {
+      if (blocks.ramps.hidden[block_index]) return;
+      if (not active_layers[blocks.ramps.layer[block_index]]) return;
 
       if (intersects(frustumWS, {.min =
                                     {
@@ -59,11 +85,13 @@ void drag_select(const blocks& blocks, const active_layers active_layers,
             selection.remove(block_id{blocks.ramps.ids[block_index]});
          }
       }
-   }
+   };
+
+   for_each_candidate(index, block_type::ramp, blocks.ramps.size(), frustumWS, select_ramp);
 
-   for (uint32 block_index = 0; block_index < blocks.quads.size(); ++block_index) {
-      if (blocks.quads.hidden[block_index]) continue;
-      if (not active_layers[blocks.quads.layer[block_index]]) continue;
+   const auto select_quad = [&](const uint32 block_index) {
+      if (blocks.quads.hidden[block_index]) return;
+      if (not active_layers[blocks.quads.layer[block_index]]) return;
 
       if (intersects(frustumWS, {.min =
                                     {
@@ -83,11 +111,13 @@ void drag_select(const blocks& blocks, const active_layers active_layers,
             selection.remove(block_id{blocks.quads.ids[block_index]});
          }
       }
-   }
+   };
+
+   for_each_candidate(index, block_type::quad, blocks.quads.size(), frustumWS, select_quad);
 
-   for (uint32 block_index = 0; block_index < blocks.custom.size(); ++block_index) {
-      if (blocks.custom.hidden[block_index]) continue;
-      if (not active_layers[blocks.custom.layer[block_index]]) continue;
+   const auto select_custom = [&](const uint32 block_index) {
+      if (blocks.custom.hidden[block_index]) return;
+      if (not active_layers[blocks.custom.layer[block_index]]) return;
 
       if (intersects(frustumWS, {.min =
                                     {
@@ -116,11 +146,14 @@ void drag_select(const blocks& blocks, const active_layers active_layers,
             }
          }
       }
-   }
+   };
 
-   for (uint32 block_index = 0; block_index < blocks.hemispheres.size(); ++block_index) {
-      if (blocks.hemispheres.hidden[block_index]) continue;
-      if (not active_layers[blocks.hemispheres.layer[block_index]]) continue;
+   for_each_candidate(index, block_type::custom, blocks.custom.size(),
+                      frustumWS, select_custom);
+
+   const auto select_hemisphere = [&](const uint32 block_index) {
+      if (blocks.hemispheres.hidden[block_index]) return;
+      if (not active_layers[blocks.hemispheres.layer[block_index]]) return;
 
       if (intersects(frustumWS, {.min =
                                     {
@@ -140,11 +173,14 @@ void drag_select(const blocks& blocks, const active_layers active_layers,
             selection.remove(block_id{blocks.hemispheres.ids[block_index]});
          }
       }
-   }
+   };
 
-   for (uint32 block_index = 0; block_index < blocks.pyramids.size(); ++block_index) {
-      if (blocks.pyramids.hidden[block_index]) continue;
-      if (not active_layers[blocks.pyramids.layer[block_index]]) continue;
+   for_each_candidate(index, block_type::hemisphere, blocks.hemispheres.size(),
+                      frustumWS, select_hemisphere);
+
+   const auto select_pyramid = [&](const uint32 block_index) {
+      if (blocks.pyramids.hidden[block_index]) return;
+      if (not active_layers[blocks.pyramids.layer[block_index]]) return;
 
       if (intersects(frustumWS, {.min =
                                     {
@@ -164,13 +200,15 @@ void drag_select(const blocks& blocks, const active_layers active_layers,
             selection.remove(block_id{blocks.pyramids.ids[block_index]});
          }
       }
-   }
+   };
+
+   for_each_candidate(index, block_type::pyramid, blocks.pyramids.size(),
+                      frustumWS, select_pyramid);
 
-   for (uint32 block_index = 0; block_index < blocks.terrain_cut_boxes.size();
-        ++block_index) {
+   const auto select_terrain_cut_box = [&](const uint32 block_index) {
       if (blocks.terrain_cut_boxes.hidden[block_index] or
           not active_layers[blocks.terrain_cut_boxes.layer[block_index]]) {
-         continue;
+         return;
       }
 
       if (intersects(frustumWS,
@@ -192,7 +230,28 @@ void drag_select(const blocks& blocks, const active_layers active_layers,
             selection.remove(block_id{blocks.terrain_cut_boxes.ids[block_index]});
          }
       }
-   }
+   };
+
+   for_each_candidate(index, block_type::terrain_cut_box, blocks.terrain_cut_boxes.size(),
+                      frustumWS, select_terrain_cut_box);
+}
+
+}
+
+void drag_select(const blocks& blocks, const active_layers active_layers,
+                 const blocks_custom_mesh_bvh_library& bvh_library,
+                 const frustum& frustumWS, block_drag_select_op op,
+                 selection& selection) noexcept
+{
+   drag_select_impl(blocks, active_layers, bvh_library, nullptr, frustumWS, op, selection);
+}
+
+void drag_select(const blocks& blocks, const active_layers active_layers,
+                 const blocks_custom_mesh_bvh_library& bvh_library,
+                 const blocks_spatial_index& index, const frustum& frustumWS,
+                 block_drag_select_op op, selection& selection) noexcept
+{
+   drag_select_impl(blocks, active_layers, bvh_library, &index, frustumWS, op, selection);
 }
 
-}
\ No newline at end of file
+}
@@ -9,6 +9,7 @@
 namespace we::world {
 
 struct blocks_custom_mesh_bvh_library;
+struct blocks_spatial_index;
 
 enum class block_drag_select_op { add, remove };
 
@@ -24,4 +25,17 @@ void drag_select(const blocks& blocks, const active_layers active_layers,
                  const frustum& frustumWS, block_drag_select_op op,
                  selection& selection) noexcept;
 
+/// @brief Add (or remove) blocks that intersect the frustum to (or from) the selection.
+/// @param blocks The world blocks.
+/// @param active_layers The layers to select from.
+/// @param bvh_library The the BVH library for custom blocks.
+/// @param index The spatial index for the blocks, used to skip blocks outside the frustum.
+/// @param frustumWS The frustum.
+/// @param op The operation to do (add or remove).
+/// @param selection The selection to edit.
+void drag_select(const blocks& blocks, const active_layers active_layers,
+                 const blocks_custom_mesh_bvh_library& bvh_library,
+                 const blocks_spatial_index& index, const frustum& frustumWS,
+                 block_drag_select_op op, selection& selection) noexcept;
+
 }
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "../custom_mesh.hpp"
 #include "../custom_mesh_bvh_library.hpp"
 #include "../mesh_geometry.hpp"
+#include "../spatial_index.hpp"
 
 #include "math/intersectors.hpp"
 #include "math/iq_intersectors.hpp"
@@ -23,18 +24,44 @@ struct raycast_block_result_local {
    uint32 surface_index = 0;
 };
 
+/// @brief Call test(block_index) for each block whose bounds the ray hits closer than closest,
+/// or for every block if there is no index. closest is reread after each call.
+template<typename Test>
+void for_each_candidate(const blocks_spatial_index* index, const block_type type,
+                        const std::size_t block_count, const float3& ray_originWS,
+                        const float3& ray_directionWS, const float& closest,
+                        const Test& test) noexcept
+{
+   if (index) {
+      index->raycast(type, ray_originWS, ray_directionWS, closest,
+                     [&](const uint32 block_index, float& max_distance) {
+                        if (block_index < block_count) test(block_index);
+
+                        max_distance = closest;
+
+                        return true;
+                     });
+   }
+   else {
+      for (uint32 block_index = 0; block_index < block_count; ++block_index) {
+         test(block_index);
+      }
+   }
+}
+
 auto raycast(const float3 ray_originWS, const float3 ray_directionWS,
              const active_layers active_layers, const blocks_boxes& boxes,
              const float max_distance,
+             const blocks_spatial_index* index,
              function_ptr<bool(const block_id id) noexcept> filter) noexcept
    -> std::optional<raycast_block_result_local>
 {
    float closest = max_distance;
    uint32 closest_index = UINT32_MAX;
 
-   for (uint32 box_index = 0; box_index < boxes.size(); ++box_index) {
-      if (not active_layers[boxes.layer[box_index]]) continue;
-      if (boxes.hidden[box_index]) continue;
+   const auto test_box = [&](const uint32 box_index) {
+      if (not active_layers[boxes.layer[box_index]]) return;
+      if (boxes.hidden[box_index]) return;
 
       const block_description_box& box = boxes.description[box_index];
 
@@ -46,12 +73,15 @@ auto raycast(const float3 ray_originWS, const float3 ray_directionWS,
       if (float hit; intersect_aabb(ray_originLS, 1.0f / ray_directionLS,
                                     {-box.size, box.size}, closest, hit) and
                      hit >= 0.0f) {
-         if (filter and not filter(boxes.ids[box_index])) continue;
+         if (filter and not filter(boxes.ids[box_index])) return;
 
          closest = hit;
          closest_index = box_index;
       }
-   }
+   };
+
+   for_each_candidate(index, block_type::box, boxes.size(), ray_originWS, ray_directionWS,
+                      closest, test_box);
 
    if (closest_index != UINT32_MAX) {
       const block_description_box& box = boxes.description[closest_index];
@@ -96,15 +126,16 @@ auto raycast(const float3 ray_originWS, const float3 ray_directionWS,
 auto raycast(const float3 ray_originWS, const float3 ray_directionWS,
              const active_layers active_layers, const blocks_ramps& ramps,
              const float max_distance,
+             const blocks_spatial_index* index,
              function_ptr<bool(const block_id id) noexcept> filter) noexcept
    -> std::optional<raycast_block_result_local>
 {
    float closest = max_distance;
    uint32 closest_index = UINT32_MAX;
 
-   for (uint32 box_index = 0; box_index < ramps.size(); ++box_index) {
-      if (not active_layers[ramps.layer[box_index]]) continue;
-      if (ramps.hidden[box_index]) continue;
+   const auto test_ramp = [&](const uint32 box_index) {
+      if (not active_layers[ramps.layer[box_index]]) return;
+      if (ramps.hidden[box_index]) return;
 
       const block_description_ramp& ramp = ramps.description[box_index];
 
@@ -119,7 +150,7 @@ auto raycast(const float3 ray_originWS, const float3 ray_directionWS,
                     float3{ramp.size.z, ramp.size.y, ramp.size.x})
                 .x;
           hit >= 0.0f and hit < closest) {
-         if (filter and not filter(ramps.ids[box_index])) continue;
+         if (filter and not filter(ramps.ids[box_index])) return;
 
          math::bounding_box bbox = {-ramp.size, ramp.size};
          std::array<float3, 8> corners = to_corners(bbox);
@@ -131,7 +162,10 @@ auto raycast(const float3 ray_originWS, const float3 ray_directionWS,
          closest = hit;
          closest_index = box_index;
       }
-   }
+   };
+
+   for_each_candidate(index, block_type::ramp, ramps.size(), ray_originWS, ray_directionWS,
+                      closest, test_ramp);
 
    if (closest_index != UINT32_MAX) {
       const block_description_ramp& ramp = ramps.description[closest_index];
@@ -176,15 +210,16 @@ auto raycast(const float3 ray_originWS, const float3 ray_directionWS,
 auto raycast(const float3 ray_originWS, const float3 ray_directionWS,
              const active_layers active_layers, const blocks_quads& quads,
              const float max_distance,
+             const blocks_spatial_index* index,
              function_ptr<bool(const block_id id) noexcept> filter) noexcept
    -> std::optional<raycast_block_result_local>
 {
    float closest = max_distance;
    uint32 closest_index = UINT32_MAX;
 
-   for (uint32 box_index = 0; box_index < quads.size(); ++box_index) {
-      if (not active_layers[quads.layer[box_index]]) continue;
-      if (quads.hidden[box_index]) continue;
+   const auto test_quad = [&](const uint32 box_index) {
+      if (not active_layers[quads.layer[box_index]]) return;
+      if (quads.hidden[box_index]) return;
 
       const block_description_quad& quad = quads.description[box_index];
 
@@ -195,13 +230,16 @@ auto raycast(const float3 ray_originWS, const float3 ray_directionWS,
              intersect_tri(ray_originWS, ray_directionWS, quad.vertices[tri[0]],
                            quad.vertices[tri[1]], quad.vertices[tri[2]], hit) and
              hit < closest) {
-            if (filter and not filter(quads.ids[box_index])) continue;
+            if (filter and not filter(quads.ids[box_index])) return;
 
             closest = hit;
             closest_index = box_index;
          }
       }
-   }
+   };
+
+   for_each_candidate(index, block_type::quad, quads.size(), ray_originWS, ray_directionWS,
+                      closest, test_quad);
 
    if (closest_index != UINT32_MAX) {
       return raycast_block_result_local{.distance = closest,
@@ -216,6 +254,7 @@ auto raycast(const float3 ray_originWS, const float3 ray_directionWS,
              const active_layers active_layers, const blocks_custom& blocks,
              const blocks_custom_mesh_library& custom_meshes,
              const blocks_custom_mesh_bvh_library& bvh_library, const float max_distance,
+             const blocks_spatial_index* index,
              function_ptr<bool(const block_id id) noexcept> filter) noexcept
    -> std::optional<raycast_block_result_local>
 {
@@ -225,9 +264,9 @@ auto raycast(const float3 ray_originWS, const float3 ray_directionWS,
 
    const float3 inv_ray_directionWS = 1.0f / ray_directionWS;
 
-   for (uint32 block_index = 0; block_index < blocks.size(); ++block_index) {
-      if (not active_layers[blocks.layer[block_index]]) continue;
-      if (blocks.hidden[block_index]) continue;
+   const auto test_block = [&](const uint32 block_index) {
+      if (not active_layers[blocks.layer[block_index]]) return;
+      if (blocks.hidden[block_index]) return;
 
       if (float hit; not intersect_aabb(ray_originWS, inv_ray_directionWS,
                                         {{blocks.bbox.min_x[block_index],
@@ -237,7 +276,7 @@ auto raycast(const float3 ray_originWS, const float3 ray_directionWS,
                                           blocks.bbox.max_y[block_index],
                                           blocks.bbox.max_z[block_index]}},
                                         closest, hit)) {
-         continue;
+         return;
       }
 
       const block_description_custom& block = blocks.description[block_index];
@@ -252,7 +291,7 @@ auto raycast(const float3 ray_originWS, const float3 ray_directionWS,
       if (const std::optional<bvh::ray_hit> hit =
              bvh.raycast(ray_originLS, ray_directionLS, closest);
           hit) {
-         if (filter and not filter(blocks.ids[block_index])) continue;
+         if (filter and not filter(blocks.ids[block_index])) return;
 
          const block_custom_mesh& mesh = custom_meshes[blocks.mesh[block_index]];
 
@@ -260,7 +299,10 @@ auto raycast(const float3 ray_originWS, const float3 ray_directionWS,
          closest_index = block_index;
          surface_index = mesh.vertices[mesh.triangles[hit->tri_index][0]].surface_index;
       }
-   }
+   };
+
+   for_each_candidate(index, block_type::custom, blocks.size(), ray_originWS,
+                      ray_directionWS, closest, test_block);
 
    if (closest_index != UINT32_MAX) {
       return raycast_block_result_local{.distance = closest,
@@ -274,16 +316,16 @@ auto raycast(const float3 ray_originWS, const float3 ray_directionWS,
 auto raycast(const float3 ray_originWS, const float3 ray_directionWS,
              const active_layers active_layers,
              const blocks_hemispheres& hemispheres, const float max_distance,
+             const blocks_spatial_index* index,
              function_ptr<bool(const block_id id) noexcept> filter) noexcept
    -> std::optional<raycast_block_result_local>
 {
    float closest = max_distance;
    uint32 closest_index = UINT32_MAX;
 
-   for (uint32 hemisphere_index = 0; hemisphere_index < hemispheres.size();
-        ++hemisphere_index) {
-      if (not active_layers[hemispheres.layer[hemisphere_index]]) continue;
-      if (hemispheres.hidden[hemisphere_index]) continue;
+   const auto test_hemisphere = [&](const uint32 hemisphere_index) {
+      if (not active_layers[hemispheres.layer[hemisphere_index]]) return;
+      if (hemispheres.hidden[hemisphere_index]) return;
 
       const block_description_hemisphere& hemisphere =
          hemispheres.description[hemisphere_index];
@@ -308,16 +350,19 @@ auto raycast(const float3 ray_originWS, const float3 ray_directionWS,
                hit = disk_hit;
             }
             else {
-               continue;
+               return;
             }
          }
 
-         if (filter and not filter(hemispheres.ids[hemisphere_index])) continue;
+         if (filter and not filter(hemispheres.ids[hemisphere_index])) return;
 
          closest = hit;
          closest_index = hemisphere_index;
       }
-   }
+   };
+
+   for_each_candidate(index, block_type::hemisphere, hemispheres.size(), ray_originWS,
+                      ray_directionWS, closest, test_hemisphere);
 
    if (closest_index != UINT32_MAX) {
       const block_description_hemisphere& hemisphere =
@@ -366,15 +411,16 @@ auto raycast(const float3 ray_originWS, const float3 ray_directionWS,
 auto raycast(const float3 ray_originWS, const float3 ray_directionWS,
              const active_layers active_layers, const blocks_pyramids& pyramids,
              const float max_distance,
+             const blocks_spatial_index* index,
              function_ptr<bool(const block_id id) noexcept> filter) noexcept
    -> std::optional<raycast_block_result_local>
 {
    float closest = max_distance;
    uint32 closest_index = UINT32_MAX;
 
-   for (uint32 pyramid_index = 0; pyramid_index < pyramids.size(); ++pyramid_index) {
-      if (not active_layers[pyramids.layer[pyramid_index]]) continue;
-      if (pyramids.hidden[pyramid_index]) continue;
+   const auto test_pyramid = [&](const uint32 pyramid_index) {
+      if (not active_layers[pyramids.layer[pyramid_index]]) return;
+      if (pyramids.hidden[pyramid_index]) return;
 
       const block_description_pyramid& pyramid = pyramids.description[pyramid_index];
 
@@ -386,12 +432,15 @@ auto raycast(const float3 ray_originWS, const float3 ray_directionWS,
       if (float hit; intersect_aabb(ray_originLS, 1.0f / ray_directionLS,
                                     {-pyramid.size, pyramid.size}, closest, hit) and
                      hit >= 0.0f) {
-         if (filter and not filter(pyramids.ids[pyramid_index])) continue;
+         if (filter and not filter(pyramids.ids[pyramid_index])) return;
 
          closest = hit;
          closest_index = pyramid_index;
       }
-   }
+   };
+
+   for_each_candidate(index, block_type::pyramid, pyramids.size(), ray_originWS,
+                      ray_directionWS, closest, test_pyramid);
 
    if (closest_index != UINT32_MAX) {
       const block_description_pyramid& pyramid = pyramids.description[closest_index];
@@ -439,15 +488,16 @@ auto raycast(const float3 ray_originWS, const float3 ray_directionWS,
 auto raycast(const float3 ray_originWS, const float3 ray_directionWS,
              const active_layers active_layers,
              const blocks_terrain_cut_boxes& boxes, const float max_distance,
+             const blocks_spatial_index* index,
              function_ptr<bool(const block_id id) noexcept> filter) noexcept
    -> std::optional<raycast_block_result_local>
 {
    float closest = max_distance;
    uint32 closest_index = UINT32_MAX;
 
-   for (uint32 box_index = 0; box_index < boxes.size(); ++box_index) {
-      if (not active_layers[boxes.layer[box_index]]) continue;
-      if (boxes.hidden[box_index]) continue;
+   const auto test_box = [&](const uint32 box_index) {
+      if (not active_layers[boxes.layer[box_index]]) return;
+      if (boxes.hidden[box_index]) return;
 
       const block_description_terrain_cut_box& box = boxes.description[box_index];
 
@@ -459,12 +509,15 @@ auto raycast(const float3 ray_originWS, const float3 ray_directionWS,
       if (float hit; intersect_aabb(ray_originLS, 1.0f / ray_directionLS,
                                     {-box.size, box.size}, closest, hit) and
                      hit >= 0.0f) {
-         if (filter and not filter(boxes.ids[box_index])) continue;
+         if (filter and not filter(boxes.ids[box_index])) return;
 
          closest = hit;
          closest_index = box_index;
       }
-   }
+   };
+
+   for_each_candidate(index, block_type::terrain_cut_box, boxes.size(), ray_originWS,
+                      ray_directionWS, closest, test_box);
 
    if (closest_index != UINT32_MAX) {
       return raycast_block_result_local{
@@ -477,12 +530,11 @@ auto raycast(const float3 ray_originWS, const float3 ray_directionWS,
    return std::nullopt;
 }
 
-}
-
-auto raycast(const float3 ray_originWS, const float3 ray_directionWS,
-             const active_layers active_layers, const blocks& blocks,
-             const blocks_custom_mesh_bvh_library& bvh_library,
-             function_ptr<bool(const block_id id) noexcept> filter) noexcept
+auto raycast_impl(const float3 ray_originWS, const float3 ray_directionWS,
+                  const active_layers active_layers, const blocks& blocks,
+                  const blocks_custom_mesh_bvh_library& bvh_library,
+                  const blocks_spatial_index* index,
+                  function_ptr<bool(const block_id id) noexcept> filter) noexcept
    -> std::optional<raycast_block_result>
 {
    float closest = FLT_MAX;
@@ -492,7 +544,7 @@ auto raycast(const float3 ray_originWS, const float3 ray_directionWS,
 
    if (std::optional<raycast_block_result_local> hit =
           raycast(ray_originWS, ray_directionWS, active_layers, blocks.boxes,
-                  closest, filter);
+                  closest, index, filter);
        hit) {
       closest = hit->distance;
       closest_id = blocks.boxes.ids[hit->index];
@@ -502,7 +554,7 @@ auto raycast(const float3 ray_originWS, const float3 ray_directionWS,
 
    if (std::optional<raycast_block_result_local> hit =
           raycast(ray_originWS, ray_directionWS, active_layers, blocks.ramps,
-                  closest, filter);
+                  closest, index, filter);
        hit) {
       closest = hit->distance;
       closest_id = blocks.ramps.ids[hit->index];
@@ -512,7 +564,7 @@ auto raycast(const float3 ray_originWS, const float3 ray_directionWS,
 
    if (std::optional<raycast_block_result_local> hit =
           raycast(ray_originWS, ray_directionWS, active_layers, blocks.quads,
-                  closest, filter);
+                  closest, index, filter);
        hit) {
       closest = hit->distance;
       closest_id = blocks.quads.ids[hit->index];
@@ -522,7 +574,7 @@ auto raycast(const float3 ray_originWS, const float3 ray_directionWS,
 
    if (std::optional<raycast_block_result_local> hit =
           raycast(ray_originWS, ray_directionWS, active_layers, blocks.custom,
-                  blocks.custom_meshes, bvh_library, closest, filter);
+                  blocks.custom_meshes, bvh_library, closest, index, filter);
        hit) {
       closest = hit->distance;
       closest_id = blocks.custom.ids[hit->index];
@@ -532,7 +584,7 @@ auto raycast(const float3 ray_originWS, const float3 ray_directionWS,
 
    if (std::optional<raycast_block_result_local> hit =
           raycast(ray_originWS, ray_directionWS, active_layers,
-                  blocks.hemispheres, closest, filter);
+                  blocks.hemispheres, closest, index, filter);
        hit) {
       closest = hit->distance;
       closest_id = blocks.hemispheres.ids[hit->index];
@@ -542,7 +594,7 @@ auto raycast(const float3 ray_originWS, const float3 ray_directionWS,
 
    if (std::optional<raycast_block_result_local> hit =
           raycast(ray_originWS, ray_directionWS, active_layers, blocks.pyramids,
-                  closest, filter);
+                  closest, index, filter);
        hit) {
       closest = hit->distance;
       closest_id = blocks.pyramids.ids[hit->index];
@@ -552,7 +604,7 @@ auto raycast(const float3 ray_originWS, const float3 ray_directionWS,
 
    if (std::optional<raycast_block_result_local> hit =
           raycast(ray_originWS, ray_directionWS, active_layers,
-                  blocks.terrain_cut_boxes, closest, filter);
+                  blocks.terrain_cut_boxes, closest, index, filter);
        hit) {
       closest = hit->distance;
       closest_id = blocks.terrain_cut_boxes.ids[hit->index];
@@ -573,3 +625,26 @@ auto raycast(const float3 ray_originWS, const float3 ray_directionWS,
 }
 
 }
+
+auto raycast(const float3 ray_originWS, const float3 ray_directionWS,
+             const active_layers active_layers, const blocks& blocks,
+             const blocks_custom_mesh_bvh_library& bvh_library,
+             function_ptr<bool(const block_id id) noexcept> filter) noexcept
+   -> std::optional<raycast_block_result>
+{
+   return raycast_impl(ray_originWS, ray_directionWS, active_layers, blocks, bvh_library,
+                       nullptr, filter);
+}
+
+auto raycast(const float3 ray_originWS, const float3 ray_directionWS,
+             const active_layers active_layers, const blocks& blocks,
+             const blocks_custom_mesh_bvh_library& bvh_library,
+             const blocks_spatial_index& index,
+             function_ptr<bool(const block_id id) noexcept> filter) noexcept
+   -> std::optional<raycast_block_result>
+{
+   return raycast_impl(ray_originWS, ray_directionWS, active_layers, blocks, bvh_library,
+                       &index, filter);
+}
+
+}
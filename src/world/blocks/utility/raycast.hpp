@@ -10,6 +10,7 @@
 namespace we::world {
 
 struct blocks_custom_mesh_bvh_library;
+struct blocks_spatial_index;
 
 struct raycast_block_result {
    float distance = 0.0f;
@@ -23,4 +24,13 @@ auto raycast(const float3 ray_originWS, const float3 ray_directionWS,
              const blocks_custom_mesh_bvh_library& bvh_library,
              function_ptr<bool(const block_id id) noexcept> filter = nullptr) noexcept
    -> std::optional<raycast_block_result>;
+
+/// @brief Raycast against the blocks, using a blocks_spatial_index to find the blocks to test.
+/// The index must be up to date with the blocks.
+auto raycast(const float3 ray_originWS, const float3 ray_directionWS,
+             const active_layers active_layers, const blocks& blocks,
+             const blocks_custom_mesh_bvh_library& bvh_library,
+             const blocks_spatial_index& index,
+             function_ptr<bool(const block_id id) noexcept> filter = nullptr) noexcept
+   -> std::optional<raycast_block_result>;
 }
\ No newline at end of file
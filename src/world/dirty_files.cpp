@@ -0,0 +1,104 @@
+#include "dirty_files.hpp"
+#include "layer_description.hpp"
+
+#include <bit>
+
+namespace we::world {
+
+namespace {
+
+static_assert(static_cast<std::size_t>(world_file::count) <= 32);
+static_assert(static_cast<std::size_t>(layer_file::count) == 5,
+              "Update dirty_files::_layer_files's initializer.");
+static_assert(max_layers <= 64);
+
+constexpr uint64 fnv_1a_offset_basis = 0xcbf29ce484222325;
+constexpr uint64 fnv_1a_prime = 0x100000001b3;
+
+template<typename T>
+void hash_append(uint64& hash, const T& value) noexcept
+{
+   for (const std::byte byte : std::bit_cast<std::array<std::byte, sizeof(T)>>(value)) {
+      hash ^= static_cast<uint64>(byte);
+      hash *= fnv_1a_prime;
+   }
+}
+
+auto hash_terrain_cuts(const std::span<const terrain_cut> terrain_cuts) noexcept -> uint64
+{
+   uint64 hash = fnv_1a_offset_basis;
+
+   hash_append(hash, terrain_cuts.size());
+
+   for (const terrain_cut& cut : terrain_cuts) {
+      hash_append(hash, cut.bbox.min);
+      hash_append(hash, cut.bbox.max);
+      hash_append(hash, cut.planes.size());
+
+      for (const float4& plane : cut.planes) hash_append(hash, plane);
+   }
+
+   return hash;
+}
+
+auto layer_bit(const int layer) noexcept -> uint64
+{
+   if (layer < 0 or layer >= static_cast<int>(max_layers)) return ~uint64{0};
+
+   return uint64{1} << layer;
+}
+
+}
+
+void dirty_files::mark(const world_file file) noexcept
+{
+   _world_files |= uint32{1} << static_cast<uint32>(file);
+}
+
+void dirty_files::mark(const layer_file file, const int layer) noexcept
+{
+   _layer_files[static_cast<std::size_t>(file)] |= layer_bit(layer);
+}
+
+void dirty_files::mark_all_layers(const layer_file file) noexcept
+{
+   _layer_files[static_cast<std::size_t>(file)] = ~uint64{0};
+}
+
+void dirty_files::mark_all() noexcept
+{
+   _world_files = ~uint32{0};
+   _layer_files.fill(~uint64{0});
+}
+
+void dirty_files::mark_saved(const io::path& path,
+                             const std::span<const terrain_cut> terrain_cuts) noexcept
+{
+   _world_files = 0;
+   _layer_files.fill(0);
+
+   _saved_path = path;
+   _saved_terrain_cuts_hash = hash_terrain_cuts(terrain_cuts);
+}
+
+bool dirty_files::is_dirty(const world_file file) const noexcept
+{
+   return ((_world_files >> static_cast<uint32>(file)) & 1u) != 0;
+}
+
+bool dirty_files::is_dirty(const layer_file file, const int layer) const noexcept
+{
+   return (_layer_files[static_cast<std::size_t>(file)] & layer_bit(layer)) != 0;
+}
+
+bool dirty_files::is_dirty(const std::span<const terrain_cut> terrain_cuts) const noexcept
+{
+   return hash_terrain_cuts(terrain_cuts) != _saved_terrain_cuts_hash;
+}
+
+bool dirty_files::is_saved_to(const io::path& path) const noexcept
+{
+   return not _saved_path.empty() and _saved_path == path;
+}
+
+}
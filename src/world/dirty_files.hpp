@@ -0,0 +1,95 @@
+#pragma once
+
+#include "terrain.hpp"
+
+#include "io/path.hpp"
+#include "types.hpp"
+
+#include <array>
+#include <span>
+
+namespace we::world {
+
+/// @brief The files of a world that are not part of a layer.
+enum class world_file : uint8 {
+   layer_index,
+   boundaries,
+   barriers,
+   planning,
+   portals_sectors,
+   measurements,
+   animations,
+   foliage_props,
+   terrain,
+   requirements,
+   effects,
+   blocks,
+   configuration,
+
+   count
+};
+
+/// @brief The files saved for each layer of a world.
+enum class layer_file : uint8 {
+   objects,
+   paths,
+   regions,
+   lights,
+   hintnodes,
+
+   count
+};
+
+/// @brief Tracks which of a world's files are out of date with the world since it was last saved. Edits mark the files
+/// they touch as dirty and save_world only rewrites the dirty files.
+///
+/// Every file starts out dirty, a world that has never been saved has no files that are up to date with it.
+struct dirty_files {
+   /// @brief Mark a file as dirty.
+   /// @param file The file to mark.
+   void mark(const world_file file) noexcept;
+
+   /// @brief Mark a layer's file as dirty.
+   /// @param file The file to mark.
+   /// @param layer The layer the file belongs to. If it is outside the range [0, max_layers) the file is marked for every layer.
+   void mark(const layer_file file, const int layer) noexcept;
+
+   /// @brief Mark a file as dirty for every layer.
+   /// @param file The file to mark.
+   void mark_all_layers(const layer_file file) noexcept;
+
+   /// @brief Mark every file as dirty.
+   void mark_all() noexcept;
+
+   /// @brief Record that the world has been saved, leaving every file clean.
+   /// @param path The path the world was saved to. Saving to any other path will need every file to be rewritten.
+   /// @param terrain_cuts The terrain cuts that were saved into the terrain.
+   void mark_saved(const io::path& path, const std::span<const terrain_cut> terrain_cuts) noexcept;
+
+   /// @brief Check if a file is dirty.
+   /// @param file The file to check.
+   [[nodiscard]] bool is_dirty(const world_file file) const noexcept;
+
+   /// @brief Check if a layer's file is dirty.
+   /// @param file The file to check.
+   /// @param layer The layer the file belongs to.
+   [[nodiscard]] bool is_dirty(const layer_file file, const int layer) const noexcept;
+
+   /// @brief Check if the terrain cuts are different to the ones that were last saved.
+   /// @param terrain_cuts The terrain cuts to check.
+   [[nodiscard]] bool is_dirty(const std::span<const terrain_cut> terrain_cuts) const noexcept;
+
+   /// @brief Check if the files were last saved to a path.
+   /// @param path The path to check.
+   [[nodiscard]] bool is_saved_to(const io::path& path) const noexcept;
+
+private:
+   uint32 _world_files = ~uint32{0};
+   std::array<uint64, static_cast<std::size_t>(layer_file::count)> _layer_files = {
+      ~uint64{0}, ~uint64{0}, ~uint64{0}, ~uint64{0}, ~uint64{0}};
+
+   io::path _saved_path;
+   uint64 _saved_terrain_cuts_hash = 0;
+};
+
+}
@@ -34,6 +34,15 @@ class id_generator {
 public:
    using id_type = id<T>;
 
+   id_generator() = default;
+
+   /// @brief Create an id_generator that carries on from where another one left off.
+   /// @param aquired_count The number of IDs the other id_generator had aquired.
+   explicit id_generator(const uint32 aquired_count) noexcept
+      : _next_id{aquired_count}
+   {
+   }
+
    /// @brief Aquire a new unique ID.
    /// @return The ID. It is only unique relative to other IDs returned from this id_generator instance.
    [[nodiscard]] auto aquire() noexcept -> id_type
@@ -41,6 +50,13 @@ public:
       return id_type{_next_id++};
    }
 
+   /// @brief Get the number of IDs that have been aquired from this id_generator.
+   /// @return The number of IDs.
+   [[nodiscard]] auto aquired_count() const noexcept -> uint32
+   {
+      return _next_id;
+   }
+
 private:
    uint32 _next_id = 0;
 };
@@ -4,6 +4,7 @@
 
 #include "utility/world_utilities.hpp"
 
+#include <algorithm>
 #include <bit>
 
 namespace we::world {
@@ -26,10 +27,174 @@ struct address_range {
                                                       container.size())};
    }
 
+   bool contains(const std::uintptr_t memory_begin,
+                 const std::uintptr_t memory_end) const noexcept
+   {
+      return memory_begin >= begin and //
+             memory_begin < end and    //
+             memory_end > begin and    //
+             memory_end <= end;
+   }
+
+   bool overlaps(const std::uintptr_t memory_begin,
+                 const std::uintptr_t memory_end) const noexcept
+   {
+      return memory_begin < end and memory_end > begin;
+   }
+
    std::uintptr_t begin = 0;
    std::uintptr_t end = 0;
 };
 
+auto blocks_address_ranges(const blocks& blocks) -> std::array<address_range, 22>
+{
+   return {
+      address_range::container(blocks.boxes.hidden),
+      address_range::container(blocks.boxes.layer),
+      address_range::container(blocks.boxes.description),
+      address_range::container(blocks.ramps.hidden),
+      address_range::container(blocks.ramps.layer),
+      address_range::container(blocks.ramps.description),
+      address_range::container(blocks.quads.hidden),
+      address_range::container(blocks.quads.layer),
+      address_range::container(blocks.quads.description),
+      address_range::container(blocks.custom.hidden),
+      address_range::container(blocks.custom.layer),
+      address_range::container(blocks.custom.description),
+      address_range::container(blocks.hemispheres.hidden),
+      address_range::container(blocks.hemispheres.layer),
+      address_range::container(blocks.hemispheres.description),
+      address_range::container(blocks.pyramids.hidden),
+      address_range::container(blocks.pyramids.layer),
+      address_range::container(blocks.pyramids.description),
+      address_range::container(blocks.terrain_cut_boxes.hidden),
+      address_range::container(blocks.terrain_cut_boxes.layer),
+      address_range::container(blocks.terrain_cut_boxes.description),
+      address_range::container(blocks.materials),
+   };
+}
+
+template<typename T>
+auto find_entity(const pinned_vector<T>& entities, const std::uintptr_t address) noexcept
+   -> const T*
+{
+   const std::uintptr_t begin = reinterpret_cast<std::uintptr_t>(entities.data());
+   const std::uintptr_t end = begin + entities.size() * sizeof(T);
+
+   if (address < begin or address >= end) return nullptr;
+
+   return &entities[(address - begin) / sizeof(T)];
+}
+
+void mark_dirty_world_member(world& world, const std::uintptr_t memory_begin,
+                             const std::uintptr_t memory_end) noexcept
+{
+   const auto overlaps = [&](const auto& member) {
+      return address_range::object(member).overlaps(memory_begin, memory_end);
+   };
+
+   dirty_files& dirty_files = world.dirty_files;
+   dirty_entity_types& dirty_entities = world.dirty_entities;
+
+   if (overlaps(world.requirements)) {
+      dirty_files.mark(world_file::requirements);
+   }
+   else if (overlaps(world.game_modes)) {
+      dirty_files.mark(world_file::layer_index);
+      dirty_files.mark(world_file::requirements);
+   }
+   else if (overlaps(world.common_layers)) {
+      dirty_files.mark(world_file::layer_index);
+   }
+   else if (overlaps(world.terrain)) {
+      dirty_files.mark(world_file::terrain);
+   }
+   else if (overlaps(world.global_lights)) {
+      dirty_files.mark(layer_file::lights, 0);
+   }
+   else if (overlaps(world.objects)) {
+      // Adding or removing an object changes the sequence number of every object after
+      // it, including the blocks layer's objects. Other files also reference objects.
+      dirty_files.mark_all_layers(layer_file::objects);
+      dirty_files.mark_all_layers(layer_file::hintnodes);
+      dirty_files.mark(world_file::portals_sectors);
+      dirty_files.mark(world_file::animations);
+      dirty_files.mark(world_file::blocks);
+
+      dirty_entities.objects = true;
+   }
+   else if (overlaps(world.lights)) {
+      dirty_files.mark_all_layers(layer_file::lights);
+      dirty_files.mark_all_layers(layer_file::regions);
+
+      dirty_entities.lights = true;
+   }
+   else if (overlaps(world.paths)) {
+      dirty_files.mark_all_layers(layer_file::paths);
+      dirty_files.mark(world_file::foliage_props);
+
+      dirty_entities.paths = true;
+   }
+   else if (overlaps(world.regions)) {
+      dirty_files.mark_all_layers(layer_file::regions);
+
+      dirty_entities.regions = true;
+   }
+   else if (overlaps(world.hintnodes)) {
+      dirty_files.mark_all_layers(layer_file::hintnodes);
+
+      dirty_entities.hintnodes = true;
+   }
+   else if (overlaps(world.sectors) or overlaps(world.portals)) {
+      dirty_files.mark(world_file::portals_sectors);
+
+      dirty_entities.sectors = true;
+      dirty_entities.portals = true;
+   }
+   else if (overlaps(world.barriers)) {
+      dirty_files.mark(world_file::barriers);
+
+      dirty_entities.barriers = true;
+   }
+   else if (overlaps(world.planning_hubs) or overlaps(world.planning_connections)) {
+      dirty_files.mark(world_file::planning);
+
+      dirty_entities.planning_hubs = true;
+   }
+   else if (overlaps(world.boundaries)) {
+      dirty_files.mark(world_file::boundaries);
+      dirty_files.mark(layer_file::paths, 0);
+
+      dirty_entities.boundaries = true;
+   }
+   else if (overlaps(world.measurements)) {
+      dirty_files.mark(world_file::measurements);
+   }
+   else if (overlaps(world.animations) or overlaps(world.animation_groups) or
+            overlaps(world.animation_hierarchies)) {
+      dirty_files.mark(world_file::animations);
+   }
+   else if (overlaps(world.blocks)) {
+      dirty_files.mark(world_file::blocks);
+      dirty_files.mark(world_file::requirements);
+   }
+   else if (overlaps(world.effects)) {
+      dirty_files.mark(world_file::effects);
+   }
+   else if (overlaps(world.foliage_layers) or overlaps(world.tree_lines)) {
+      dirty_files.mark(world_file::foliage_props);
+   }
+   else if (overlaps(world.deleted_layers) or overlaps(world.deleted_game_modes) or
+            overlaps(world.next_id) or overlaps(world.dirty_files) or
+            overlaps(world.dirty_entities)) {
+      // Not saved into any file.
+   }
+   else {
+      // The world's name, configuration and layers affect almost every file.
+      dirty_files.mark_all();
+   }
+}
+
 }
 
 creation_entity::creation_entity(creation_entity_none_t) {}
@@ -247,49 +412,132 @@ bool edit_context::is_memory_valid(const void* ptr, std::size_t size) const noex
       address_range::container(world.animation_groups),
       address_range::container(world.animation_hierarchies),
 
-      address_range::container(world.blocks.boxes.hidden),
-      address_range::container(world.blocks.boxes.layer),
-      address_range::container(world.blocks.boxes.description),
-      address_range::container(world.blocks.ramps.hidden),
-      address_range::container(world.blocks.ramps.layer),
-      address_range::container(world.blocks.ramps.description),
-      address_range::container(world.blocks.quads.hidden),
-      address_range::container(world.blocks.quads.layer),
-      address_range::container(world.blocks.quads.description),
-      address_range::container(world.blocks.custom.hidden),
-      address_range::container(world.blocks.custom.layer),
-      address_range::container(world.blocks.custom.description),
-      address_range::container(world.blocks.hemispheres.hidden),
-      address_range::container(world.blocks.hemispheres.layer),
-      address_range::container(world.blocks.hemispheres.description),
-      address_range::container(world.blocks.pyramids.hidden),
-      address_range::container(world.blocks.pyramids.layer),
-      address_range::container(world.blocks.pyramids.description),
-      address_range::container(world.blocks.terrain_cut_boxes.hidden),
-      address_range::container(world.blocks.terrain_cut_boxes.layer),
-      address_range::container(world.blocks.terrain_cut_boxes.description),
-      address_range::container(world.blocks.materials),
-
       address_range::container(world.effects.sun_flares),
 
       address_range::container(world.tree_lines),
    };
 
-   std::uintptr_t memory_begin = reinterpret_cast<std::uintptr_t>(ptr);
-   std::uintptr_t memory_end = memory_begin + size;
+   const std::uintptr_t memory_begin = reinterpret_cast<std::uintptr_t>(ptr);
+   const std::uintptr_t memory_end = memory_begin + size;
 
-   for (const auto& [range_begin, range_end] : ranges) {
-      if (memory_begin >= range_begin and //
-          memory_begin < range_end and    //
-          memory_end > range_begin and    //
-          memory_end <= range_end) {
-         return true;
-      }
+   for (const address_range& range : ranges) {
+      if (range.contains(memory_begin, memory_end)) return true;
+   }
+
+   for (const address_range& range : blocks_address_ranges(world.blocks)) {
+      if (range.contains(memory_begin, memory_end)) return true;
    }
 
    return false;
 }
 
+void edit_context::mark_dirty(const void* ptr, std::size_t size) noexcept
+{
+   const std::uintptr_t memory_begin = reinterpret_cast<std::uintptr_t>(ptr);
+   const std::uintptr_t memory_end = memory_begin + size;
+
+   const auto overlaps = [&](const address_range range) {
+      return range.overlaps(memory_begin, memory_end);
+   };
+
+   if (overlaps(address_range::object(creation_entity)) or
+       overlaps(address_range::object(euler_rotation)) or
+       overlaps(address_range::object(light_region_euler_rotation))) {
+      return;
+   }
+
+   dirty_files& dirty_files = world.dirty_files;
+   dirty_entity_types& dirty_entities = world.dirty_entities;
+
+   if (const object* object = find_entity(world.objects, memory_begin); object) {
+      dirty_files.mark(layer_file::objects, object->layer);
+      dirty_entities.objects = true;
+
+      if (overlaps(address_range::object(object->name))) {
+         dirty_files.mark(world_file::portals_sectors);
+         dirty_files.mark(world_file::animations);
+         dirty_files.mark_all_layers(layer_file::hintnodes);
+      }
+   }
+   else if (const light* light = find_entity(world.lights, memory_begin); light) {
+      dirty_files.mark(layer_file::lights, light->layer);
+      dirty_files.mark(layer_file::regions, light->layer);
+      dirty_entities.lights = true;
+
+      // The base layer's lights file references the global lights by name and light
+      // sequence numbers continue on from the lights in earlier layers.
+      if (overlaps(address_range::object(light->name))) {
+         dirty_files.mark(layer_file::lights, 0);
+      }
+
+      if (overlaps(address_range::object(light->layer))) {
+         dirty_files.mark_all_layers(layer_file::lights);
+      }
+   }
+   else if (const path* path = find_entity(world.paths, memory_begin); path) {
+      dirty_files.mark(layer_file::paths, path->layer);
+      dirty_entities.paths = true;
+
+      if (overlaps(address_range::object(path->name))) {
+         dirty_files.mark(world_file::foliage_props);
+      }
+   }
+   else if (const region* region = find_entity(world.regions, memory_begin); region) {
+      dirty_files.mark(layer_file::regions, region->layer);
+      dirty_entities.regions = true;
+   }
+   else if (const hintnode* hintnode = find_entity(world.hintnodes, memory_begin); hintnode) {
+      dirty_files.mark(layer_file::hintnodes, hintnode->layer);
+      dirty_entities.hintnodes = true;
+   }
+   else if (overlaps(address_range::container(world.sectors)) or
+            overlaps(address_range::container(world.portals))) {
+      dirty_files.mark(world_file::portals_sectors);
+      dirty_entities.sectors = true;
+      dirty_entities.portals = true;
+   }
+   else if (overlaps(address_range::container(world.barriers))) {
+      dirty_files.mark(world_file::barriers);
+      dirty_entities.barriers = true;
+   }
+   else if (overlaps(address_range::container(world.planning_hubs)) or
+            overlaps(address_range::container(world.planning_connections))) {
+      dirty_files.mark(world_file::planning);
+      dirty_entities.planning_hubs = true;
+   }
+   else if (overlaps(address_range::container(world.boundaries))) {
+      dirty_files.mark(world_file::boundaries);
+      dirty_files.mark(layer_file::paths, 0);
+      dirty_entities.boundaries = true;
+   }
+   else if (overlaps(address_range::container(world.measurements))) {
+      dirty_files.mark(world_file::measurements);
+   }
+   else if (overlaps(address_range::container(world.animations)) or
+            overlaps(address_range::container(world.animation_groups)) or
+            overlaps(address_range::container(world.animation_hierarchies))) {
+      dirty_files.mark(world_file::animations);
+   }
+   else if (overlaps(address_range::container(world.effects.sun_flares))) {
+      dirty_files.mark(world_file::effects);
+   }
+   else if (overlaps(address_range::container(world.tree_lines))) {
+      dirty_files.mark(world_file::foliage_props);
+   }
+   else if (std::ranges::any_of(blocks_address_ranges(world.blocks), overlaps)) {
+      dirty_files.mark(world_file::blocks);
+      dirty_files.mark(world_file::requirements);
+   }
+   else if (overlaps(address_range::object(world))) {
+      mark_dirty_world_member(world, memory_begin, memory_end);
+   }
+   else {
+      // Memory outside of the world's containers, like a path's nodes.
+      dirty_files.mark_all();
+      dirty_entities.mark_all();
+   }
+}
+
 auto make_path_id_node_mask(path_id id, uint32 node_index) noexcept -> path_id_node_mask
 {
    assert(node_index < max_path_nodes);
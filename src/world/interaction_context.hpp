@@ -486,6 +486,16 @@ struct edit_context {
    {
       return is_memory_valid(ptr, sizeof(T));
    }
+
+   /// @brief Mark the world's files that the memory at an address is saved into as dirty. Memory that isn't saved into
+   /// any file is ignored, memory that can't be placed marks every file as dirty.
+   void mark_dirty(const void* ptr, std::size_t size) noexcept;
+
+   template<typename T>
+   void mark_dirty(const T* ptr) noexcept
+   {
+      mark_dirty(ptr, sizeof(T));
+   }
 };
 
 auto make_path_id_node_mask(path_id id, uint32 node_index) noexcept -> path_id_node_mask;
@@ -4,13 +4,17 @@
 #include "load_blocks.hpp"
 #include "load_effects.hpp"
 #include "load_failure.hpp"
+#include "world_cache.hpp"
 
+#include "../utility/entity_name_index.hpp"
 #include "../utility/world_utilities.hpp"
 
 #include "assets/config/io.hpp"
 #include "assets/req/io.hpp"
 #include "assets/terrain/terrain_io.hpp"
 
+#include "async/thread_pool.hpp"
+
 #include "io/read_file.hpp"
 
 #include "math/vector_funcs.hpp"
@@ -21,6 +25,12 @@
 
 #include <algorithm>
 #include <cmath>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
 
 #include <absl/container/flat_hash_map.h>
 #include <absl/container/flat_hash_set.h>
@@ -38,6 +48,35 @@ namespace {
 // This can provide more clues as to when something went wrong with loading but also makes it 50x to 100x slower.
 constexpr bool verbose_output = false;
 
+/// @brief Index the names of a list of the world's entities. The index is only valid until the
+/// list is changed, it must not be kept past connect_object_refs.
+template<typename Type>
+auto make_entity_name_index(const pinned_vector<Type>& entities) noexcept -> entity_name_index
+{
+   entity_name_index index;
+
+   for (uint32 i = 0; i < entities.size(); ++i) index.insert(entities[i].name, i);
+
+   return index;
+}
+
+/// @brief Find an entity by name using an index made from the entities.
+/// @param entities The entities the index was made from.
+/// @param index The index.
+/// @param name The name of the entity.
+/// @return The entity or nullptr if no entity has the name.
+template<typename Type>
+auto find_entity(pinned_vector<Type>& entities, const entity_name_index& index,
+                 const std::string_view name) -> Type*
+{
+   if (const std::optional<uint32> entity_index = index.find(name);
+       entity_index and *entity_index < entities.size()) {
+      return &entities[*entity_index];
+   }
+
+   return nullptr;
+}
+
 void throw_layer_load_failure(std::string_view type, const io::path& filepath,
                               std::exception& e)
 {
@@ -335,8 +374,16 @@ void load_objects(const io::path& path, const std::string_view layer_name,
                 load_timer.elapsed_ms());
 }
 
+/// @brief What was read from a layer's GlobalLights block. A layer loaded into it's own world
+/// only applies it's block over the world's global lights when it is merged, in layer order.
+struct global_lights_block_read {
+   bool block = false;
+   bool env_map = false;
+};
+
 void load_lights(const io::path& path, const std::string_view layer_name,
-                 output_stream& output, world& world_out, const int8 layer)
+                 output_stream& output, world& world_out, const int8 layer,
+                 global_lights_block_read* global_lights_read_out)
 {
    using namespace assets;
 
@@ -472,7 +519,11 @@ void load_lights(const io::path& path, const std::string_view layer_name,
             if (auto env_map = key_node.find("EnvMap"sv); env_map != key_node.cend()) {
                world_out.global_lights.env_map_texture =
                   env_map->values.get<std::string>(0);
+
+               if (global_lights_read_out) global_lights_read_out->env_map = true;
             }
+
+            if (global_lights_read_out) global_lights_read_out->block = true;
          }
       }
    }
@@ -1265,7 +1316,8 @@ void load_measurements(const io::path& filepath, output_stream& output, world& w
 
 void load_layer(const io::path& world_dir, const std::string_view layer_name,
                 const std::string_view world_ext, output_stream& output,
-                world& world_out, const layer_remap& layer_remap, const int8 layer)
+                world& world_out, const layer_remap& layer_remap, const int8 layer,
+                global_lights_block_read* global_lights_read_out)
 {
    load_objects(io::compose_path(world_dir, layer_name, world_ext), layer_name,
                 output, world_out, layer_remap);
@@ -1282,7 +1334,8 @@ void load_layer(const io::path& world_dir, const std::string_view layer_name,
 
    if (const auto lights_path = io::compose_path(world_dir, layer_name, ".lgt"sv);
        io::exists(lights_path)) {
-      load_lights(lights_path, layer_name, output, world_out, layer);
+      load_lights(lights_path, layer_name, output, world_out, layer,
+                  global_lights_read_out);
    }
 
    if (const auto hnt_path = io::compose_path(world_dir, layer_name, ".hnt"sv);
@@ -1693,6 +1746,11 @@ void strip_blocks_layer_reference(world& world) noexcept
 
 void connect_object_refs(world& world)
 {
+   const entity_name_index object_names = make_entity_name_index(world.objects);
+   const entity_name_index sector_names = make_entity_name_index(world.sectors);
+   const entity_name_index light_names = make_entity_name_index(world.lights);
+   const entity_name_index animation_names = make_entity_name_index(world.animations);
+
    for (sector& sector : world.sectors) {
       sector.objects.reserve(sector.objects_broken_links.size());
 
@@ -1702,7 +1760,7 @@ void connect_object_refs(world& world)
       sector.objects_broken_links.clear();
 
       for (std::string& object_name : objects_broken_links) {
-         const object* object = find_entity(world.objects, object_name);
+         const object* object = find_entity(world.objects, object_names, object_name);
 
          if (object) {
             sector.objects.push_back(
@@ -1719,7 +1777,8 @@ void connect_object_refs(world& world)
       assert(portal.sector2.has_name());
 
       if (not portal.sector1.name().empty()) {
-         const sector* sector = find_entity(world.sectors, portal.sector1.name());
+         const sector* sector =
+            find_entity(world.sectors, sector_names, portal.sector1.name());
 
          if (sector) {
             portal.sector1 = static_cast<uint32>((sector - world.sectors.data()));
@@ -1727,7 +1786,8 @@ void connect_object_refs(world& world)
       }
 
       if (not portal.sector2.name().empty()) {
-         const sector* sector = find_entity(world.sectors, portal.sector2.name());
+         const sector* sector =
+            find_entity(world.sectors, sector_names, portal.sector2.name());
 
          if (sector) {
             portal.sector2 = static_cast<uint32>((sector - world.sectors.data()));
@@ -1741,7 +1801,7 @@ void connect_object_refs(world& world)
       if (hintnode.command_post.name().empty()) continue;
 
       const object* object =
-         find_entity(world.objects, hintnode.command_post.name());
+         find_entity(world.objects, object_names, hintnode.command_post.name());
 
       if (object) {
          hintnode.command_post =
@@ -1758,8 +1818,9 @@ void connect_object_refs(world& world)
       group.entries_broken_links.clear();
 
       for (animation_group::entry_broken& entry : entries_broken_links) {
-         const animation* animation = find_entity(world.animations, entry.animation);
-         const object* object = find_entity(world.objects, entry.object);
+         const animation* animation =
+            find_entity(world.animations, animation_names, entry.animation);
+         const object* object = find_entity(world.objects, object_names, entry.object);
 
          if (animation and object) {
             group.entries.push_back(
@@ -1782,7 +1843,7 @@ void connect_object_refs(world& world)
       hierarchy.objects_broken_links.clear();
 
       for (std::string& object_name : objects_broken_links) {
-         const object* object = find_entity(world.objects, object_name);
+         const object* object = find_entity(world.objects, object_names, object_name);
 
          if (object) {
             hierarchy.objects.push_back(
@@ -1796,7 +1857,7 @@ void connect_object_refs(world& world)
       assert(hierarchy.root_object.has_name());
 
       if (const object* object =
-             find_entity(world.objects, hierarchy.root_object.name());
+             find_entity(world.objects, object_names, hierarchy.root_object.name());
           object) {
          hierarchy.root_object =
             static_cast<uint32>((object - world.objects.data()));
@@ -1808,7 +1869,7 @@ void connect_object_refs(world& world)
 
    if (not world.global_lights.global_light_1.name().empty()) {
       const light* light =
-         find_entity(world.lights, world.global_lights.global_light_1.name());
+         find_entity(world.lights, light_names, world.global_lights.global_light_1.name());
 
       if (light) {
          world.global_lights.global_light_1 =
@@ -1818,7 +1879,7 @@ void connect_object_refs(world& world)
 
    if (not world.global_lights.global_light_2.name().empty()) {
       const light* light =
-         find_entity(world.lights, world.global_lights.global_light_2.name());
+         find_entity(world.lights, light_names, world.global_lights.global_light_2.name());
 
       if (light) {
          world.global_lights.global_light_2 =
@@ -1827,10 +1888,148 @@ void connect_object_refs(world& world)
    }
 }
 
+/// @brief Holds the output of a load_task so it can be written out in the same order a serial load would write it.
+class buffered_output_stream final : public output_stream {
+public:
+   using output_stream::write;
+
+   void write(std::string string) noexcept override
+   {
+      _messages.push_back(std::move(string));
+   }
+
+   void flush(output_stream& output) noexcept
+   {
+      for (std::string& message : _messages) output.write(std::move(message));
+
+      _messages.clear();
+   }
+
+private:
+   std::vector<std::string> _messages;
+};
+
+/// @brief Writes output through to another output_stream while keeping a copy of it.
+class recording_output_stream final : public output_stream {
+public:
+   using output_stream::write;
+
+   explicit recording_output_stream(output_stream& output) noexcept : _output{output} {}
+
+   void write(std::string string) noexcept override
+   {
+      _messages.push_back(string);
+      _output.write(std::move(string));
+   }
+
+   auto messages() const noexcept -> std::span<const std::string>
+   {
+      return _messages;
+   }
+
+private:
+   output_stream& _output;
+   std::vector<std::string> _messages;
+};
+
+/// @brief A part of a world being loaded. Runs on the thread_pool when there is one and immediately otherwise.
+struct load_task {
+   template<typename Fn>
+   void start(async::thread_pool* thread_pool, Fn fn) noexcept
+   {
+      auto run = [this, fn = std::move(fn)]() noexcept {
+         try {
+            fn(_output);
+         }
+         catch (...) {
+            _exception = std::current_exception();
+         }
+      };
+
+      if (thread_pool) {
+         _task = thread_pool->exec(async::task_priority::normal, std::move(run));
+      }
+      else {
+         run();
+      }
+   }
+
+   void wait() noexcept
+   {
+      if (_task.valid()) _task.wait();
+   }
+
+   /// @brief Write out the task's output and rethrow any exception from it. Must be called after wait().
+   void finish(output_stream& output)
+   {
+      _output.flush(output);
+
+      if (_exception) std::rethrow_exception(std::exchange(_exception, nullptr));
+   }
+
+private:
+   buffered_output_stream _output;
+   std::exception_ptr _exception;
+   async::task<void> _task;
+};
+
+/// @brief A layer being loaded into its own world so it can be loaded alongside the other layers.
+struct layer_load {
+   world layer_world;
+   global_lights_block_read global_lights_read;
+   load_task task;
+};
+
+template<typename T>
+void merge_entities(std::string_view name, pinned_vector<T>& entities,
+                    pinned_vector<T>& entities_out, id_generator<T>& next_id_out)
+{
+   for (T& entity : entities) {
+      check_space(name, entities_out);
+
+      entity.id = next_id_out.aquire();
+
+      entities_out.push_back(std::move(entity));
+   }
+
+   entities.clear();
+}
+
+/// @brief Move the entities of a layer loaded into its own world into the world. They're given the IDs they would have
+/// had if the layer had been loaded straight into the world. The layer's GlobalLights block is applied over the
+/// world's global lights the same way.
+void merge_layer(world& layer_world, const global_lights_block_read& global_lights_read,
+                 world& world_out)
+{
+   merge_entities("objects", layer_world.objects, world_out.objects,
+                  world_out.next_id.objects);
+   merge_entities("paths", layer_world.paths, world_out.paths, world_out.next_id.paths);
+   merge_entities("regions", layer_world.regions, world_out.regions,
+                  world_out.next_id.regions);
+   merge_entities("lights", layer_world.lights, world_out.lights,
+                  world_out.next_id.lights);
+   merge_entities("hint nodes", layer_world.hintnodes, world_out.hintnodes,
+                  world_out.next_id.hintnodes);
+
+   if (global_lights_read.block) {
+      world_out.global_lights.global_light_1 =
+         std::move(layer_world.global_lights.global_light_1);
+      world_out.global_lights.global_light_2 =
+         std::move(layer_world.global_lights.global_light_2);
+      world_out.global_lights.ambient_sky_color = layer_world.global_lights.ambient_sky_color;
+      world_out.global_lights.ambient_ground_color =
+         layer_world.global_lights.ambient_ground_color;
+   }
+
+   if (global_lights_read.env_map) {
+      world_out.global_lights.env_map_texture =
+         std::move(layer_world.global_lights.env_map_texture);
+   }
 }
 
-auto load_world(const io::path& path, const configuration& default_configuration,
-                output_stream& output) -> world
+auto load_world_impl(const io::path& path, const configuration& default_configuration,
+                     output_stream& output, async::thread_pool* thread_pool,
+                     const load_world_options& options) -> world
 {
    world world = {.name = std::string{path.stem()},
                   .configuration = default_configuration};
@@ -1838,87 +2037,178 @@ auto load_world(const io::path& path, const configuration& default_configuration
    const io::path world_dir = path.parent_path();
 
    try {
-      const layer_remap layer_remap =
-         load_layer_index(io::compose_path(world_dir, world.name, ".ldx"sv),
-                          output, world);
+      utility::stopwatch cache_load_timer;
+
+      layer_remap layer_remap;
+      std::vector<std::string> cached_messages;
+
+      const bool loaded_from_cache =
+         options.use_cache and read_world_cache(path, world, layer_remap, cached_messages);
 
-      load_layer(world_dir, world.name, ".wld"sv, output, world, layer_remap, 0);
+      // The output of loading the layers is kept so it can be stored in the cache.
+      recording_output_stream layers_output{output};
 
-      for (std::size_t i = 1; i < world.layer_descriptions.size(); ++i) {
-         auto layer = world.layer_descriptions[i];
+      if (loaded_from_cache) {
+         output.write("Loaded world layers from {}.wecache (time taken {:f}ms). Output "
+                      "from when the layers were loaded from their files:\n",
+                      world.name, cache_load_timer.elapsed_ms());
 
-         load_layer(world_dir, fmt::format("{}_{}", world.name, layer.name),
-                    ".lyr"sv, output, world, layer_remap, static_cast<int8>(i));
+         for (const std::string& message : cached_messages) {
+            output.write(string::indent(1, message));
+         }
+      }
+      else {
+         layer_remap = load_layer_index(io::compose_path(world_dir, world.name, ".ldx"sv),
+                                        layers_output, world);
       }
 
-      convert_light_regions(world);
-      convert_boundaries(world, output);
-      ensure_common_game_mode(world);
-      connect_object_refs(world);
+      // Layer 0 is loaded straight into the world, the other layers are loaded into
+      // their own worlds and merged in afterwards. Nothing else touches the entities
+      // of layer 0 or the world's terrain, effects or blocks until every task is done.
+      const std::size_t layer_load_count =
+         loaded_from_cache ? 0 : world.layer_descriptions.size();
+
+      load_task base_layer_task;
+      std::unique_ptr<layer_load[]> layer_loads =
+         std::make_unique<layer_load[]>(layer_load_count);
+      load_task terrain_task;
+      load_task effects_task;
+      load_task blocks_task;
+      load_task configuration_task;
+      std::optional<configuration> loaded_configuration;
+
+      if (not loaded_from_cache) {
+         base_layer_task.start(thread_pool, [&](output_stream& output) {
+            load_layer(world_dir, world.name, ".wld"sv, output, world, layer_remap, 0,
+                       nullptr);
+         });
+      }
 
-      if (const auto ter_path = io::compose_path(world_dir, world.name, ".ter"sv);
-          io::exists(ter_path)) {
-         try {
-            utility::stopwatch load_timer;
+      for (std::size_t i = 1; i < layer_load_count; ++i) {
+         layer_load& load = layer_loads[i];
 
-            world.terrain = read_terrain(io::read_file_to_bytes(ter_path));
+         load.task.start(thread_pool, [&, i, &load](output_stream& output) {
+            load_layer(world_dir,
+                       fmt::format("{}_{}", world.name, world.layer_descriptions[i].name),
+                       ".lyr"sv, output, load.layer_world, layer_remap, static_cast<int8>(i),
+                       &load.global_lights_read);
+         });
+      }
 
-            output.write("Loaded world terrain (time taken {:f}ms)\n",
-                         load_timer.elapsed_ms());
+      terrain_task.start(thread_pool, [&](output_stream& output) {
+         if (const auto ter_path = io::compose_path(world_dir, world.name, ".ter"sv);
+             io::exists(ter_path)) {
+            try {
+               utility::stopwatch load_timer;
+
+               world.terrain = read_terrain(io::read_file_to_bytes(ter_path));
+
+               output.write("Loaded world terrain (time taken {:f}ms)\n",
+                            load_timer.elapsed_ms());
+            }
+            catch (std::exception& e) {
+               auto message =
+                  fmt::format("Error while loading terrain:\n   Message: \n{}\n",
+                              string::indent(2, e.what()));
+
+               output.write(message);
+
+               throw load_failure{message};
+            }
          }
-         catch (std::exception& e) {
-            auto message =
-               fmt::format("Error while loading terrain:\n   Message: \n{}\n",
-                           string::indent(2, e.what()));
+         else {
+            output.write(
+               "World terrain file is missing. World will have default terrain.");
+         }
+      });
 
-            output.write(message);
+      effects_task.start(thread_pool, [&](output_stream& output) {
+         if (const auto fx_path = io::compose_path(world_dir, world.name, ".fx"sv);
+             io::exists(fx_path)) {
+            try {
+               utility::stopwatch load_timer;
 
-            throw load_failure{message};
+               world.effects = load_effects(io::read_file_to_string(fx_path), output);
+
+               output.write("Loaded {}.fx (time taken {:f}ms)\n", world.name,
+                            load_timer.elapsed_ms());
+            }
+            catch (std::exception& e) {
+               auto message =
+                  fmt::format("Error while loading {}.fx:\n   Message: \n{}\n",
+                              world.name, string::indent(2, e.what()));
+
+               output.write(message);
+
+               throw load_failure{message};
+            }
          }
-      }
-      else {
-         output.write(
-            "World terrain file is missing. World will have default terrain.");
+      });
+
+      blocks_task.start(thread_pool, [&](output_stream& output) {
+         if (const auto blk_path = io::compose_path(world_dir, world.name, ".blk"sv);
+             io::exists(blk_path)) {
+            world.blocks = load_blocks(blk_path, layer_remap, output);
+         }
+      });
+
+      configuration_task.start(thread_pool, [&](output_stream& output) {
+         if (const auto configuration_path =
+                io::compose_path(world_dir, world.name, ".WorldEdit"sv);
+             io::exists(configuration_path)) {
+            loaded_configuration = load_configuration(configuration_path, output);
+         }
+      });
+
+      base_layer_task.wait();
+
+      for (std::size_t i = 1; i < layer_load_count; ++i) {
+         layer_loads[i].task.wait();
       }
 
-      load_requirements_files(world_dir, world, output);
+      terrain_task.wait();
+      effects_task.wait();
+      blocks_task.wait();
+      configuration_task.wait();
 
-      if (const auto fx_path = io::compose_path(world_dir, world.name, ".fx"sv);
-          io::exists(fx_path)) {
-         try {
-            utility::stopwatch load_timer;
+      // Output and failures are handled in the same order as the files would be loaded in
+      // serially.
+      if (not loaded_from_cache) {
+         base_layer_task.finish(layers_output);
 
-            world.effects = load_effects(io::read_file_to_string(fx_path), output);
+         for (std::size_t i = 1; i < layer_load_count; ++i) {
+            layer_loads[i].task.finish(layers_output);
 
-            output.write("Loaded {}.fx (time taken {:f}ms)\n", world.name,
-                         load_timer.elapsed_ms());
+            merge_layer(layer_loads[i].layer_world, layer_loads[i].global_lights_read, world);
          }
-         catch (std::exception& e) {
-            auto message =
-               fmt::format("Error while loading {}.fx:\n   Message: \n{}\n",
-                           world.name, string::indent(2, e.what()));
 
-            output.write(message);
+         layer_loads = nullptr;
 
-            throw load_failure{message};
+         convert_light_regions(world);
+         convert_boundaries(world, layers_output);
+         ensure_common_game_mode(world);
+         connect_object_refs(world);
+
+         if (options.use_cache) {
+            write_world_cache(path, world, layer_remap, layers_output.messages());
          }
       }
 
-      if (const auto blk_path = io::compose_path(world_dir, world.name, ".blk"sv);
-          io::exists(blk_path)) {
-         world.blocks = load_blocks(blk_path, layer_remap, output);
-      }
+      terrain_task.finish(output);
+
+      load_requirements_files(world_dir, world, output);
+
+      effects_task.finish(output);
+      blocks_task.finish(output);
 
       if (const auto prp_path = io::compose_path(world_dir, world.name, ".prp"sv);
           io::exists(prp_path)) {
          load_foliage_props(prp_path, world, output);
       }
 
-      if (const auto configuration_path =
-             io::compose_path(world_dir, world.name, ".WorldEdit"sv);
-          io::exists(configuration_path)) {
-         world.configuration = load_configuration(configuration_path, output);
-      }
+      configuration_task.finish(output);
+
+      if (loaded_configuration) world.configuration = std::move(*loaded_configuration);
 
       strip_blocks_layer_reference(world);
    }
@@ -1932,4 +2222,20 @@ auto load_world(const io::path& path, const configuration& default_configuration
 
    return world;
 }
+
+}
+
+auto load_world(const io::path& path, const configuration& default_configuration,
+                output_stream& output, const load_world_options& options) -> world
+{
+   return load_world_impl(path, default_configuration, output, nullptr, options);
+}
+
+auto load_world(const io::path& path, const configuration& default_configuration,
+                output_stream& output, async::thread_pool& thread_pool,
+                const load_world_options& options) -> world
+{
+   return load_world_impl(path, default_configuration, output, &thread_pool, options);
+}
+
 }
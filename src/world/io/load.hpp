@@ -4,14 +4,40 @@
 #include "io/path.hpp"
 #include "output_stream.hpp"
 
+namespace we::async {
+
+class thread_pool;
+
+}
+
 namespace we::world {
 
+struct load_world_options {
+   /// @brief Load the world's layers from it's .wecache file when the cache is up to date with the layer files. When
+   /// it isn't the layers are loaded from their files and the cache is rewritten. The cache only covers the layer
+   /// index and the layer files, everything else is always loaded from it's own file.
+   bool use_cache = false;
+};
+
 /// @brief Loads a world.
 /// @param path The path to the world.
 /// @param default_configuration The default configuration for the world.
 /// @param output The output stream for warnings and errors.
+/// @param options The options for loading the world.
+/// @return The loaded world.
+auto load_world(const io::path& path, const configuration& default_configuration,
+                output_stream& output, const load_world_options& options = {}) -> world;
+
+/// @brief Loads a world, loading its layers, terrain, effects and blocks in parallel on a thread_pool. The loaded world
+/// and the output written are the same as from a serial load.
+/// @param path The path to the world.
+/// @param default_configuration The default configuration for the world.
+/// @param output The output stream for warnings and errors.
+/// @param thread_pool The thread_pool to load the world on.
+/// @param options The options for loading the world.
 /// @return The loaded world.
 auto load_world(const io::path& path, const configuration& default_configuration,
-                output_stream& output) -> world;
+                output_stream& output, async::thread_pool& thread_pool,
+                const load_world_options& options = {}) -> world;
 
 }
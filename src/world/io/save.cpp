@@ -133,6 +133,24 @@ struct sequence_numbers {
    int lights = 0;
 };
 
+/// @brief Check if a file needs to be saved.
+/// @param dirty_files The world's dirty files or nullptr if every file is being saved.
+/// @param file The file to check.
+bool should_save(const dirty_files* dirty_files, const world_file file) noexcept
+{
+   return not dirty_files or dirty_files->is_dirty(file);
+}
+
+/// @brief Check if a layer's file needs to be saved.
+/// @param dirty_files The world's dirty files or nullptr if every file is being saved.
+/// @param file The file to check.
+/// @param layer_index The index of the layer.
+bool should_save(const dirty_files* dirty_files, const layer_file file,
+                 const int layer_index) noexcept
+{
+   return not dirty_files or dirty_files->is_dirty(file, layer_index);
+}
+
 void save_objects(const io::path& path, const std::string_view layer_name,
                   const int layer_index, const world& world,
                   sequence_numbers& sequence_numbers)
@@ -997,19 +1015,47 @@ void save_foliage_props(const io::path& path, const world& world)
 /// @param layer_name The name of the layer ie `test` or `test_conquest`.
 /// @param layer_index The index of the layer, 0 is special and indicates the base layer.
 /// @param world The world that is being saved.
+/// @param dirty_files The world's dirty files or nullptr if every file is being saved.
 void save_layer(const io::path& world_dir, const std::string_view layer_name,
                 const int layer_index, const world& world,
-                sequence_numbers& sequence_numbers)
+                const dirty_files* dirty_files, sequence_numbers& sequence_numbers)
 {
-   save_objects(io::compose_path(world_dir, layer_name,
-                                 (layer_index == 0 ? ".wld"sv : ".lyr"sv)),
-                layer_name, layer_index, world, sequence_numbers);
-
-   save_paths(io::compose_path(world_dir, layer_name, ".pth"sv), layer_index, world);
-   save_regions(io::compose_path(world_dir, layer_name, ".rgn"sv), layer_index, world);
-   save_lights(io::compose_path(world_dir, layer_name, ".lgt"sv), layer_index,
-               world, sequence_numbers);
-   save_hintnodes(io::compose_path(world_dir, layer_name, ".hnt"sv), layer_index, world);
+   // Sequence numbers carry on between layers so skipped files still need to advance them.
+
+   if (should_save(dirty_files, layer_file::objects, layer_index)) {
+      save_objects(io::compose_path(world_dir, layer_name,
+                                    (layer_index == 0 ? ".wld"sv : ".lyr"sv)),
+                   layer_name, layer_index, world, sequence_numbers);
+   }
+   else {
+      sequence_numbers.objects += static_cast<int>(world.objects.size());
+   }
+
+   if (should_save(dirty_files, layer_file::paths, layer_index)) {
+      save_paths(io::compose_path(world_dir, layer_name, ".pth"sv), layer_index, world);
+   }
+
+   if (should_save(dirty_files, layer_file::regions, layer_index)) {
+      save_regions(io::compose_path(world_dir, layer_name, ".rgn"sv), layer_index,
+                   world);
+   }
+
+   if (should_save(dirty_files, layer_file::lights, layer_index)) {
+      save_lights(io::compose_path(world_dir, layer_name, ".lgt"sv), layer_index,
+                  world, sequence_numbers);
+   }
+   else {
+      sequence_numbers.lights +=
+         std::accumulate(world.lights.begin(), world.lights.end(), 0,
+                         [=](int total, const light& light) {
+                            return layer_index == light.layer ? total + 1 : total;
+                         });
+   }
+
+   if (should_save(dirty_files, layer_file::hintnodes, layer_index)) {
+      save_hintnodes(io::compose_path(world_dir, layer_name, ".hnt"sv), layer_index,
+                     world);
+   }
 }
 
 void save_layer_index(const io::path& path, const world& world)
@@ -1202,62 +1248,93 @@ void garbage_collect_files(const io::path& world_dir,
 }
 
 void save_world(const io::path& path, const world& world,
-                const std::span<const terrain_cut> terrain_cuts)
+                const std::span<const terrain_cut> terrain_cuts,
+                const save_world_options& options)
 {
    const std::string_view world_dir = path.parent_path();
    const std::string_view world_name = path.stem();
 
+   const dirty_files* dirty_files =
+      options.force_full_save or not world.dirty_files.is_saved_to(path)
+         ? nullptr
+         : &world.dirty_files;
+
    sequence_numbers sequence_numbers;
 
    garbage_collect_files(world_dir, world_name, world);
 
-   save_layer_index(make_path_with_new_extension(path, ".ldx"sv), world);
+   if (should_save(dirty_files, world_file::layer_index)) {
+      save_layer_index(make_path_with_new_extension(path, ".ldx"sv), world);
+   }
 
-   save_layer(world_dir, world_name, 0, world, sequence_numbers);
+   save_layer(world_dir, world_name, 0, world, dirty_files, sequence_numbers);
 
-   save_boundaries(io::compose_path(world_dir, world_name, ".bnd"sv), world);
+   if (should_save(dirty_files, world_file::boundaries)) {
+      save_boundaries(io::compose_path(world_dir, world_name, ".bnd"sv), world);
+   }
 
-   save_barriers(io::compose_path(world_dir, world_name, ".bar"sv), world);
+   if (should_save(dirty_files, world_file::barriers)) {
+      save_barriers(io::compose_path(world_dir, world_name, ".bar"sv), world);
+   }
 
-   save_planning(io::compose_path(world_dir, world_name, ".pln"sv), world);
+   if (should_save(dirty_files, world_file::planning)) {
+      save_planning(io::compose_path(world_dir, world_name, ".pln"sv), world);
+   }
 
-   save_portals_sectors(io::compose_path(world_dir, world_name, ".pvs"sv), world);
+   if (should_save(dirty_files, world_file::portals_sectors)) {
+      save_portals_sectors(io::compose_path(world_dir, world_name, ".pvs"sv), world);
+   }
 
-   save_measurements(io::compose_path(world_dir, world_name, ".msr"sv), world);
+   if (should_save(dirty_files, world_file::measurements)) {
+      save_measurements(io::compose_path(world_dir, world_name, ".msr"sv), world);
+   }
 
-   save_animations(io::compose_path(world_dir, world_name, ".anm"sv), world);
+   if (should_save(dirty_files, world_file::animations)) {
+      save_animations(io::compose_path(world_dir, world_name, ".anm"sv), world);
+   }
 
-   save_foliage_props(io::compose_path(world_dir, world_name, ".prp"sv), world);
+   if (should_save(dirty_files, world_file::foliage_props)) {
+      save_foliage_props(io::compose_path(world_dir, world_name, ".prp"sv), world);
+   }
 
    for (std::size_t i = 1; i < world.layer_descriptions.size(); ++i) {
       auto& layer = world.layer_descriptions[i];
 
       save_layer(world_dir, fmt::format("{}_{}", world_name, layer.name),
-                 static_cast<uint32>(i), world, sequence_numbers);
+                 static_cast<uint32>(i), world, dirty_files, sequence_numbers);
    }
 
-   save_terrain(make_path_with_new_extension(path, ".ter"sv), world.terrain,
-                terrain_cuts);
+   if (should_save(dirty_files, world_file::terrain) or
+       dirty_files->is_dirty(terrain_cuts)) {
+      save_terrain(make_path_with_new_extension(path, ".ter"sv), world.terrain,
+                   terrain_cuts);
+   }
 
-   save_requirements(world_dir, world_name, world);
+   if (should_save(dirty_files, world_file::requirements)) {
+      save_requirements(world_dir, world_name, world);
+   }
 
-   if (world.configuration.save_effects) {
+   if (world.configuration.save_effects and should_save(dirty_files, world_file::effects)) {
       save_effects(make_path_with_new_extension(path, ".fx"sv), world.effects);
    }
 
-   save_blocks(io::compose_path(world_dir, world_name, ".blk"sv), world.blocks);
+   if (should_save(dirty_files, world_file::blocks)) {
+      save_blocks(io::compose_path(world_dir, world_name, ".blk"sv), world.blocks);
 
-   if (const io::path blocks_layer_path =
-          io::compose_path(world_dir,
-                           fmt::format("{}_{}", world_name, "WE_blocks"), ".lyr"sv);
-       world.configuration.save_blocks_into_layer) {
-      save_blocks_layer(blocks_layer_path, world_dir, world_name, world,
-                        sequence_numbers);
-   }
-   else {
-      (void)io::remove(blocks_layer_path);
+      if (const io::path blocks_layer_path =
+             io::compose_path(world_dir,
+                              fmt::format("{}_{}", world_name, "WE_blocks"), ".lyr"sv);
+          world.configuration.save_blocks_into_layer) {
+         save_blocks_layer(blocks_layer_path, world_dir, world_name, world,
+                           sequence_numbers);
+      }
+      else {
+         (void)io::remove(blocks_layer_path);
+      }
    }
 
-   save_configuration(io::compose_path(world_dir, world_name, ".WorldEdit"sv), world);
+   if (should_save(dirty_files, world_file::configuration)) {
+      save_configuration(io::compose_path(world_dir, world_name, ".WorldEdit"sv), world);
+   }
 }
 }
\ No newline at end of file
@@ -8,7 +8,20 @@
 
 namespace we::world {
 
+struct save_world_options {
+   /// @brief Rewrite every file of the world, even the ones that haven't changed since it was last saved.
+   bool force_full_save = false;
+};
+
+/// @brief Save a world. Only the files marked dirty in the world's dirty_files are rewritten, unless the world was last
+/// saved to a different path or a full save is forced. Once the world has been saved the caller should call
+/// world.dirty_files.mark_saved with the same path and terrain cuts.
+/// @param path The path to save the world to.
+/// @param world The world to save.
+/// @param terrain_cuts The terrain cuts to save into the terrain.
+/// @param options The options for saving the world.
 void save_world(const io::path& path, const world& world,
-                const std::span<const terrain_cut> terrain_cuts);
+                const std::span<const terrain_cut> terrain_cuts,
+                const save_world_options& options = {});
 
 }
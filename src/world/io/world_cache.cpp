@@ -0,0 +1,966 @@
+#include "world_cache.hpp"
+
+#include "io/error.hpp"
+#include "io/memory_mapped_file.hpp"
+#include "io/read_file.hpp"
+
+#include "utility/binary_reader.hpp"
+
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+#include <fmt/core.h>
+
+using namespace std::literals;
+
+namespace we::world {
+
+namespace {
+
+constexpr uint32 cache_magic = 0x43574557; // "WEWC"
+
+// Bump this whenever the layout of the cache or of any of the cached world types changes.
+constexpr uint32 cache_version = 1;
+
+// A cached type changing size means it's members changed. When one of these fires update
+// write_entity and read_entity for the type, bump cache_version and then update the size here.
+
+// Written and read as raw bytes.
+static_assert(sizeof(planning_branch_weights) == 32);
+static_assert(sizeof(position_key) == 44);
+static_assert(sizeof(rotation_key) == 44);
+static_assert(sizeof(animation_group::entry) == 8);
+
+// Sizes for 64-bit builds. Checked iterators change the size of the standard containers.
+#if !defined(_ITERATOR_DEBUG_LEVEL) || _ITERATOR_DEBUG_LEVEL == 0
+static_assert(sizeof(layer_description) == 40);
+static_assert(sizeof(game_mode_description) == 80);
+static_assert(sizeof(global_lights) == 136);
+static_assert(sizeof(object) == 136);
+static_assert(sizeof(instance_property) == 64);
+static_assert(sizeof(light) == 208);
+static_assert(sizeof(path) == 96);
+static_assert(sizeof(path::node) == 56);
+static_assert(sizeof(path::property) == 64);
+static_assert(sizeof(region) == 120);
+static_assert(sizeof(sector) == 128);
+static_assert(sizeof(portal) == 160);
+static_assert(sizeof(hintnode) == 136);
+static_assert(sizeof(barrier) == 72);
+static_assert(sizeof(planning_hub) == 88);
+static_assert(sizeof(planning_connection) == 56);
+static_assert(sizeof(boundary) == 72);
+static_assert(sizeof(measurement) == 72);
+static_assert(sizeof(animation) == 96);
+static_assert(sizeof(animation_group) == 96);
+static_assert(sizeof(animation_group::entry_broken) == 64);
+static_assert(sizeof(animation_hierarchy) == 96);
+#endif
+
+struct cache_header {
+   uint32 magic = cache_magic;
+   uint32 version = cache_version;
+   uint64 body_size = 0;
+};
+
+constexpr uint64 fnv_1a_offset_basis = 0xcbf29ce484222325;
+constexpr uint64 fnv_1a_prime = 0x100000001b3;
+
+auto fnv_1a_hash(const std::span<const std::byte> bytes) noexcept -> uint64
+{
+   uint64 hash = fnv_1a_offset_basis;
+
+   for (const std::byte byte : bytes) {
+      hash ^= static_cast<uint64>(byte);
+      hash *= fnv_1a_prime;
+   }
+
+   return hash;
+}
+
+/// @brief A file a world's layers are loaded from and what it was like when the cache was written.
+struct cache_source {
+   std::string file_name;
+   bool exists = false;
+   uint64 last_write_time = 0;
+   uint64 hash = 0;
+};
+
+/// @brief Get the names of the files the layers of a world could have been loaded from. Files that don't exist are
+/// included so that creating one invalidates the cache. This must be kept in sync with load_layer.
+auto get_layer_file_names(const world& world) -> std::vector<std::string>
+{
+   std::vector<std::string> file_names;
+   file_names.reserve(12 + world.layer_descriptions.size() * 5);
+
+   file_names.push_back(fmt::format("{}.ldx", world.name));
+
+   for (const std::string_view extension : {".wld"sv, ".pth"sv, ".rgn"sv, ".lgt"sv, ".hnt"sv,
+                                            ".pvs"sv, ".bar"sv, ".pln"sv, ".bnd"sv, ".anm"sv,
+                                            ".msr"sv}) {
+      file_names.push_back(fmt::format("{}{}", world.name, extension));
+   }
+
+   for (std::size_t i = 1; i < world.layer_descriptions.size(); ++i) {
+      for (const std::string_view extension :
+           {".lyr"sv, ".pth"sv, ".rgn"sv, ".lgt"sv, ".hnt"sv}) {
+         file_names.push_back(fmt::format("{}_{}{}", world.name,
+                                          world.layer_descriptions[i].name, extension));
+      }
+   }
+
+   return file_names;
+}
+
+auto make_cache_source(const io::path& world_dir, std::string file_name) -> cache_source
+{
+   const io::path path = io::compose_path(world_dir, file_name);
+
+   if (not io::exists(path)) return {.file_name = std::move(file_name)};
+
+   return {.file_name = std::move(file_name),
+           .exists = true,
+           .last_write_time = io::get_last_write_time(path),
+           .hash = fnv_1a_hash(io::read_file_to_bytes(path))};
+}
+
+bool is_cache_source_unchanged(const io::path& world_dir, const cache_source& source)
+{
+   const io::path path = io::compose_path(world_dir, source.file_name);
+
+   const bool exists = io::exists(path);
+
+   if (exists != source.exists) return false;
+   if (not exists) return true;
+
+   if (io::get_last_write_time(path) == source.last_write_time) return true;
+
+   // The file has been written to but may still be the same, for instance after being
+   // checked out again from source control.
+   return fnv_1a_hash(io::read_file_to_bytes(path)) == source.hash;
+}
+
+/// @brief Appends values to the body of a cache.
+class cache_writer {
+public:
+   template<typename T>
+   void write(const T& value) noexcept
+      requires(std::is_trivially_copyable_v<T> and not std::is_pointer_v<T>)
+   {
+      write_bytes(std::as_bytes(std::span{&value, 1}));
+   }
+
+   void write_string(const std::string_view string) noexcept
+   {
+      write(static_cast<uint32>(string.size()));
+      write_bytes(std::as_bytes(std::span{string}));
+   }
+
+   template<typename T>
+   void write_array(const std::span<const T> values) noexcept
+      requires(std::is_trivially_copyable_v<T> and not std::is_pointer_v<T>)
+   {
+      write(static_cast<uint64>(values.size()));
+      write_bytes(std::as_bytes(values));
+   }
+
+   void write_bytes(const std::span<const std::byte> bytes) noexcept
+   {
+      _bytes.insert(_bytes.end(), bytes.begin(), bytes.end());
+   }
+
+   [[nodiscard]] auto bytes() const noexcept -> std::span<const std::byte>
+   {
+      return _bytes;
+   }
+
+private:
+   std::vector<std::byte> _bytes;
+};
+
+/// @brief Reads values from the body of a cache. Throws utility::binary_reader_overflow when the body is too short.
+class cache_reader {
+public:
+   explicit cache_reader(const std::span<const std::byte> bytes) noexcept
+      : _reader{bytes}
+   {
+   }
+
+   template<typename T>
+   auto read() -> T
+   {
+      return _reader.read<T>();
+   }
+
+   auto read_string() -> std::string
+   {
+      const std::span<const std::byte> bytes = _reader.read_bytes(_reader.read<uint32>());
+
+      return std::string{reinterpret_cast<const char*>(bytes.data()), bytes.size()};
+   }
+
+   template<typename T>
+   auto read_array() -> std::vector<T>
+   {
+      const std::size_t count = read_count(SIZE_MAX / sizeof(T));
+      const std::span<const std::byte> bytes = _reader.read_bytes(count * sizeof(T));
+
+      std::vector<T> values(count);
+
+      if (count != 0) std::memcpy(values.data(), bytes.data(), bytes.size());
+
+      return values;
+   }
+
+   /// @brief Read the number of items in a container.
+   /// @param max_count The max number of items the container can hold.
+   /// @return The number of items.
+   auto read_count(const std::size_t max_count) -> std::size_t
+   {
+      const uint64 count = _reader.read<uint64>();
+
+      if (count > max_count) {
+         throw utility::binary_reader_overflow{"world cache count is too large!"};
+      }
+
+      return static_cast<std::size_t>(count);
+   }
+
+   explicit operator bool() const noexcept
+   {
+      return static_cast<bool>(_reader);
+   }
+
+private:
+   utility::binary_reader _reader;
+};
+
+template<typename T>
+void write_link(cache_writer& writer, const entity_optional_link<T>& link) noexcept
+{
+   writer.write(link.has_index());
+
+   if (link.has_index()) {
+      writer.write(link.index());
+   }
+   else {
+      writer.write_string(link.name());
+   }
+}
+
+template<typename T>
+auto read_link(cache_reader& reader) -> entity_optional_link<T>
+{
+   if (reader.read<bool>()) return entity_optional_link<T>{reader.read<uint32>()};
+
+   return entity_optional_link<T>{reader.read_string()};
+}
+
+void write_strings(cache_writer& writer, const std::span<const std::string> strings) noexcept
+{
+   writer.write(static_cast<uint64>(strings.size()));
+
+   for (const std::string& string : strings) writer.write_string(string);
+}
+
+auto read_strings(cache_reader& reader) -> std::vector<std::string>
+{
+   std::vector<std::string> strings(reader.read_count(max_entities));
+
+   for (std::string& string : strings) string = reader.read_string();
+
+   return strings;
+}
+
+void write_entity(cache_writer& writer, const object& object) noexcept
+{
+   // The class handle isn't written, it's assigned after the world is loaded.
+   writer.write_string(object.name);
+   writer.write(object.layer);
+   writer.write(object.hidden);
+   writer.write(object.rotation);
+   writer.write(object.position);
+   writer.write(object.team);
+   writer.write_string(object.class_name);
+   writer.write(static_cast<uint64>(object.instance_properties.size()));
+
+   for (const instance_property& property : object.instance_properties) {
+      writer.write_string(property.key);
+      writer.write_string(property.value);
+   }
+
+   writer.write(object.id);
+}
+
+void read_entity(cache_reader& reader, object& object)
+{
+   object.name = reader.read_string();
+   object.layer = reader.read<int8>();
+   object.hidden = reader.read<bool>();
+   object.rotation = reader.read<quaternion>();
+   object.position = reader.read<float3>();
+   object.team = reader.read<int>();
+   object.class_name = lowercase_string{reader.read_string()};
+   object.instance_properties.resize(reader.read_count(max_entities));
+
+   for (instance_property& property : object.instance_properties) {
+      property.key = reader.read_string();
+      property.value = reader.read_string();
+   }
+
+   object.id = reader.read<object_id>();
+}
+
+void write_entity(cache_writer& writer, const light& light) noexcept
+{
+   writer.write_string(light.name);
+   writer.write(light.layer);
+   writer.write(light.hidden);
+   writer.write(light.rotation);
+   writer.write(light.position);
+   writer.write(light.color);
+   writer.write(light.static_);
+   writer.write(light.shadow_caster);
+   writer.write(light.specular_caster);
+   writer.write(light.light_type);
+   writer.write(light.texture_addressing);
+   writer.write(light.bidirectional);
+   writer.write(light.ps2_blend_mode);
+   writer.write(light.range);
+   writer.write(light.inner_cone_angle);
+   writer.write(light.outer_cone_angle);
+   writer.write(light.directional_texture_tiling);
+   writer.write(light.directional_texture_offset);
+   writer.write_string(light.texture);
+   writer.write_string(light.region_name);
+   writer.write(light.region_size);
+   writer.write(light.region_rotation);
+   writer.write(light.id);
+}
+
+void read_entity(cache_reader& reader, light& light)
+{
+   light.name = reader.read_string();
+   light.layer = reader.read<int8>();
+   light.hidden = reader.read<bool>();
+   light.rotation = reader.read<quaternion>();
+   light.position = reader.read<float3>();
+   light.color = reader.read<float3>();
+   light.static_ = reader.read<bool>();
+   light.shadow_caster = reader.read<bool>();
+   light.specular_caster = reader.read<bool>();
+   light.light_type = reader.read<light_type>();
+   light.texture_addressing = reader.read<texture_addressing>();
+   light.bidirectional = reader.read<bool>();
+   light.ps2_blend_mode = reader.read<ps2_blend_mode>();
+   light.range = reader.read<float>();
+   light.inner_cone_angle = reader.read<float>();
+   light.outer_cone_angle = reader.read<float>();
+   light.directional_texture_tiling = reader.read<float2>();
+   light.directional_texture_offset = reader.read<float2>();
+   light.texture = reader.read_string();
+   light.region_name = reader.read_string();
+   light.region_size = reader.read<float3>();
+   light.region_rotation = reader.read<quaternion>();
+   light.id = reader.read<light_id>();
+}
+
+void write_path_properties(cache_writer& writer,
+                           const std::span<const path::property> properties) noexcept
+{
+   writer.write(static_cast<uint64>(properties.size()));
+
+   for (const path::property& property : properties) {
+      writer.write_string(property.key);
+      writer.write_string(property.value);
+   }
+}
+
+auto read_path_properties(cache_reader& reader) -> std::vector<path::property>
+{
+   std::vector<path::property> properties(reader.read_count(max_entities));
+
+   for (path::property& property : properties) {
+      property.key = reader.read_string();
+      property.value = reader.read_string();
+   }
+
+   return properties;
+}
+
+void write_entity(cache_writer& writer, const path& path) noexcept
+{
+   writer.write_string(path.name);
+   writer.write(path.layer);
+   writer.write(path.hidden);
+   writer.write(path.type);
+   writer.write(path.spline_type);
+   write_path_properties(writer, path.properties);
+   writer.write(static_cast<uint64>(path.nodes.size()));
+
+   for (const path::node& node : path.nodes) {
+      writer.write(node.rotation);
+      writer.write(node.position);
+      write_path_properties(writer, node.properties);
+   }
+
+   writer.write(path.id);
+}
+
+void read_entity(cache_reader& reader, path& path)
+{
+   path.name = reader.read_string();
+   path.layer = reader.read<int8>();
+   path.hidden = reader.read<bool>();
+   path.type = reader.read<path_type>();
+   path.spline_type = reader.read<path_spline_type>();
+   path.properties = read_path_properties(reader);
+   path.nodes.resize(reader.read_count(max_entities));
+
+   for (path::node& node : path.nodes) {
+      node.rotation = reader.read<quaternion>();
+      node.position = reader.read<float3>();
+      node.properties = read_path_properties(reader);
+   }
+
+   path.id = reader.read<path_id>();
+}
+
+void write_entity(cache_writer& writer, const region& region) noexcept
+{
+   writer.write_string(region.name);
+   writer.write(region.layer);
+   writer.write(region.hidden);
+   writer.write(region.rotation);
+   writer.write(region.position);
+   writer.write(region.size);
+   writer.write(region.shape);
+   writer.write_string(region.description);
+   writer.write(region.id);
+}
+
+void read_entity(cache_reader& reader, region& region)
+{
+   region.name = reader.read_string();
+   region.layer = reader.read<int8>();
+   region.hidden = reader.read<bool>();
+   region.rotation = reader.read<quaternion>();
+   region.position = reader.read<float3>();
+   region.size = reader.read<float3>();
+   region.shape = reader.read<region_shape>();
+   region.description = reader.read_string();
+   region.id = reader.read<region_id>();
+}
+
+void write_entity(cache_writer& writer, const sector& sector) noexcept
+{
+   writer.write_string(sector.name);
+   writer.write(sector.hidden);
+   writer.write(sector.base);
+   writer.write(sector.height);
+   writer.write_array<float2>(sector.points);
+   writer.write_array<uint32>(sector.objects);
+   write_strings(writer, sector.objects_broken_links);
+   writer.write(sector.id);
+}
+
+void read_entity(cache_reader& reader, sector& sector)
+{
+   sector.name = reader.read_string();
+   sector.hidden = reader.read<bool>();
+   sector.base = reader.read<float>();
+   sector.height = reader.read<float>();
+   sector.points = reader.read_array<float2>();
+   sector.objects = reader.read_array<uint32>();
+   sector.objects_broken_links = read_strings(reader);
+   sector.id = reader.read<sector_id>();
+}
+
+void write_entity(cache_writer& writer, const portal& portal) noexcept
+{
+   writer.write_string(portal.name);
+   writer.write(portal.hidden);
+   writer.write(portal.rotation);
+   writer.write(portal.position);
+   writer.write(portal.width);
+   writer.write(portal.height);
+   write_link(writer, portal.sector1);
+   write_link(writer, portal.sector2);
+   writer.write(portal.id);
+}
+
+void read_entity(cache_reader& reader, portal& portal)
+{
+   portal.name = reader.read_string();
+   portal.hidden = reader.read<bool>();
+   portal.rotation = reader.read<quaternion>();
+   portal.position = reader.read<float3>();
+   portal.width = reader.read<float>();
+   portal.height = reader.read<float>();
+   portal.sector1 = read_link<sector>(reader);
+   portal.sector2 = read_link<sector>(reader);
+   portal.id = reader.read<portal_id>();
+}
+
+void write_entity(cache_writer& writer, const hintnode& hintnode) noexcept
+{
+   writer.write_string(hintnode.name);
+   writer.write(hintnode.layer);
+   writer.write(hintnode.hidden);
+   writer.write(hintnode.rotation);
+   writer.write(hintnode.position);
+   writer.write(hintnode.type);
+   writer.write(hintnode.mode);
+   writer.write(hintnode.radius);
+   writer.write(hintnode.primary_stance);
+   writer.write(hintnode.secondary_stance);
+   write_link(writer, hintnode.command_post);
+   writer.write(hintnode.id);
+}
+
+void read_entity(cache_reader& reader, hintnode& hintnode)
+{
+   hintnode.name = reader.read_string();
+   hintnode.layer = reader.read<int8>();
+   hintnode.hidden = reader.read<bool>();
+   hintnode.rotation = reader.read<quaternion>();
+   hintnode.position = reader.read<float3>();
+   hintnode.type = reader.read<hintnode_type>();
+   hintnode.mode = reader.read<hintnode_mode>();
+   hintnode.radius = reader.read<float>();
+   hintnode.primary_stance = reader.read<stance_flags>();
+   hintnode.secondary_stance = reader.read<stance_flags>();
+   hintnode.command_post = read_link<object>(reader);
+   hintnode.id = reader.read<hintnode_id>();
+}
+
+void write_entity(cache_writer& writer, const barrier& barrier) noexcept
+{
+   writer.write_string(barrier.name);
+   writer.write(barrier.hidden);
+   writer.write(barrier.position);
+   writer.write(barrier.size);
+   writer.write(barrier.rotation_angle);
+   writer.write(barrier.flags);
+   writer.write(barrier.id);
+}
+
+void read_entity(cache_reader& reader, barrier& barrier)
+{
+   barrier.name = reader.read_string();
+   barrier.hidden = reader.read<bool>();
+   barrier.position = reader.read<float3>();
+   barrier.size = reader.read<float2>();
+   barrier.rotation_angle = reader.read<float>();
+   barrier.flags = reader.read<ai_path_flags>();
+   barrier.id = reader.read<barrier_id>();
+}
+
+void write_entity(cache_writer& writer, const planning_hub& hub) noexcept
+{
+   writer.write_string(hub.name);
+   writer.write(hub.hidden);
+   writer.write(hub.position);
+   writer.write(hub.radius);
+   writer.write_array<planning_branch_weights>(hub.weights);
+   writer.write(hub.id);
+}
+
+void read_entity(cache_reader& reader, planning_hub& hub)
+{
+   hub.name = reader.read_string();
+   hub.hidden = reader.read<bool>();
+   hub.position = reader.read<float3>();
+   hub.radius = reader.read<float>();
+   hub.weights = reader.read_array<planning_branch_weights>();
+   hub.id = reader.read<planning_hub_id>();
+}
+
+void write_entity(cache_writer& writer, const planning_connection& connection) noexcept
+{
+   writer.write_string(connection.name);
+   writer.write(connection.hidden);
+   writer.write(connection.start_hub_index);
+   writer.write(connection.end_hub_index);
+   writer.write(connection.flags);
+   writer.write(connection.jump);
+   writer.write(connection.jet_jump);
+   writer.write(connection.one_way);
+   writer.write(connection.dynamic_group);
+   writer.write(connection.id);
+}
+
+void read_entity(cache_reader& reader, planning_connection& connection)
+{
+   connection.name = reader.read_string();
+   connection.hidden = reader.read<bool>();
+   connection.start_hub_index = reader.read<uint32>();
+   connection.end_hub_index = reader.read<uint32>();
+   connection.flags = reader.read<ai_path_flags>();
+   connection.jump = reader.read<bool>();
+   connection.jet_jump = reader.read<bool>();
+   connection.one_way = reader.read<bool>();
+   connection.dynamic_group = reader.read<int8>();
+   connection.id = reader.read<planning_connection_id>();
+}
+
+void write_entity(cache_writer& writer, const boundary& boundary) noexcept
+{
+   writer.write_string(boundary.name);
+   writer.write(boundary.hidden);
+   writer.write_array<float3>(boundary.points);
+   writer.write(boundary.id);
+}
+
+void read_entity(cache_reader& reader, boundary& boundary)
+{
+   boundary.name = reader.read_string();
+   boundary.hidden = reader.read<bool>();
+   boundary.points = reader.read_array<float3>();
+   boundary.id = reader.read<boundary_id>();
+}
+
+void write_entity(cache_writer& writer, const measurement& measurement) noexcept
+{
+   writer.write(measurement.hidden);
+   writer.write(measurement.start);
+   writer.write(measurement.end);
+   writer.write_string(measurement.name);
+   writer.write(measurement.id);
+}
+
+void read_entity(cache_reader& reader, measurement& measurement)
+{
+   measurement.hidden = reader.read<bool>();
+   measurement.start = reader.read<float3>();
+   measurement.end = reader.read<float3>();
+   measurement.name = reader.read_string();
+   measurement.id = reader.read<measurement_id>();
+}
+
+void write_entity(cache_writer& writer, const animation& animation) noexcept
+{
+   writer.write_string(animation.name);
+   writer.write(animation.runtime);
+   writer.write(animation.loop);
+   writer.write(animation.local_translation);
+   writer.write_array<position_key>(animation.position_keys);
+   writer.write_array<rotation_key>(animation.rotation_keys);
+   writer.write(animation.id);
+}
+
+void read_entity(cache_reader& reader, animation& animation)
+{
+   animation.name = reader.read_string();
+   animation.runtime = reader.read<float>();
+   animation.loop = reader.read<bool>();
+   animation.local_translation = reader.read<bool>();
+   animation.position_keys = reader.read_array<position_key>();
+   animation.rotation_keys = reader.read_array<rotation_key>();
+   animation.id = reader.read<animation_id>();
+}
+
+void write_entity(cache_writer& writer, const animation_group& group) noexcept
+{
+   writer.write_string(group.name);
+   writer.write(group.play_when_level_begins);
+   writer.write(group.stops_when_object_is_controlled);
+   writer.write(group.disable_hierarchies);
+   writer.write_array<animation_group::entry>(group.entries);
+   writer.write(static_cast<uint64>(group.entries_broken_links.size()));
+
+   for (const animation_group::entry_broken& entry : group.entries_broken_links) {
+      writer.write_string(entry.animation);
+      writer.write_string(entry.object);
+   }
+
+   writer.write(group.id);
+}
+
+void read_entity(cache_reader& reader, animation_group& group)
+{
+   group.name = reader.read_string();
+   group.play_when_level_begins = reader.read<bool>();
+   group.stops_when_object_is_controlled = reader.read<bool>();
+   group.disable_hierarchies = reader.read<bool>();
+   group.entries = reader.read_array<animation_group::entry>();
+   group.entries_broken_links.resize(reader.read_count(max_entities));
+
+   for (animation_group::entry_broken& entry : group.entries_broken_links) {
+      entry.animation = reader.read_string();
+      entry.object = reader.read_string();
+   }
+
+   group.id = reader.read<animation_group_id>();
+}
+
+void write_entity(cache_writer& writer, const animation_hierarchy& hierarchy) noexcept
+{
+   write_link(writer, hierarchy.root_object);
+   writer.write_array<uint32>(hierarchy.objects);
+   write_strings(writer, hierarchy.objects_broken_links);
+   writer.write(hierarchy.id);
+}
+
+void read_entity(cache_reader& reader, animation_hierarchy& hierarchy)
+{
+   hierarchy.root_object = read_link<object>(reader);
+   hierarchy.objects = reader.read_array<uint32>();
+   hierarchy.objects_broken_links = read_strings(reader);
+   hierarchy.id = reader.read<animation_hierarchy_id>();
+}
+
+template<typename T>
+void write_entities(cache_writer& writer, const pinned_vector<T>& entities,
+                    const id_generator<T>& next_id) noexcept
+{
+   writer.write(static_cast<uint64>(entities.size()));
+
+   for (const T& entity : entities) write_entity(writer, entity);
+
+   writer.write(next_id.aquired_count());
+}
+
+template<typename T>
+void read_entities(cache_reader& reader, pinned_vector<T>& entities,
+                   id_generator<T>& next_id)
+{
+   const std::size_t count = reader.read_count(entities.max_size());
+
+   entities.reserve(count);
+
+   for (std::size_t i = 0; i < count; ++i) read_entity(reader, entities.emplace_back());
+
+   next_id = id_generator<T>{reader.read<uint32>()};
+}
+
+void write_cache_body(cache_writer& writer, const std::span<const cache_source> sources,
+                      const world& world, const layer_remap& layer_remap,
+                      const std::span<const std::string> messages) noexcept
+{
+   writer.write(static_cast<uint64>(sources.size()));
+
+   for (const cache_source& source : sources) {
+      writer.write_string(source.file_name);
+      writer.write(source.exists);
+      writer.write(source.last_write_time);
+      writer.write(source.hash);
+   }
+
+   writer.write(layer_remap);
+   write_strings(writer, messages);
+
+   writer.write(static_cast<uint64>(world.layer_descriptions.size()));
+
+   for (const layer_description& layer : world.layer_descriptions) {
+      writer.write_string(layer.name);
+      writer.write(layer.flags);
+   }
+
+   // The game modes' requirements are loaded from their own files so aren't cached.
+   writer.write(static_cast<uint64>(world.game_modes.size()));
+
+   for (const game_mode_description& game_mode : world.game_modes) {
+      writer.write_string(game_mode.name);
+      writer.write_array<int>(game_mode.layers);
+   }
+
+   writer.write_array<int>(world.common_layers);
+
+   write_link(writer, world.global_lights.global_light_1);
+   write_link(writer, world.global_lights.global_light_2);
+   writer.write(world.global_lights.ambient_sky_color);
+   writer.write(world.global_lights.ambient_ground_color);
+   writer.write_string(world.global_lights.env_map_texture);
+
+   write_entities(writer, world.objects, world.next_id.objects);
+   write_entities(writer, world.lights, world.next_id.lights);
+   write_entities(writer, world.paths, world.next_id.paths);
+   write_entities(writer, world.regions, world.next_id.regions);
+   write_entities(writer, world.sectors, world.next_id.sectors);
+   write_entities(writer, world.portals, world.next_id.portals);
+   write_entities(writer, world.hintnodes, world.next_id.hintnodes);
+   write_entities(writer, world.barriers, world.next_id.barriers);
+   write_entities(writer, world.planning_hubs, world.next_id.planning_hubs);
+   write_entities(writer, world.planning_connections, world.next_id.planning_connections);
+   write_entities(writer, world.boundaries, world.next_id.boundaries);
+   write_entities(writer, world.measurements, world.next_id.measurements);
+   write_entities(writer, world.animations, world.next_id.animations);
+   write_entities(writer, world.animation_groups, world.next_id.animation_groups);
+   write_entities(writer, world.animation_hierarchies,
+                  world.next_id.animation_hierarchies);
+}
+
+/// @brief Read the source files from a cache and check them against the world's files.
+/// @return True if all of the files are unchanged.
+bool read_cache_sources(cache_reader& reader, const io::path& world_dir)
+{
+   const std::size_t source_count = reader.read_count(max_entities);
+
+   for (std::size_t i = 0; i < source_count; ++i) {
+      cache_source source;
+
+      source.file_name = reader.read_string();
+      source.exists = reader.read<bool>();
+      source.last_write_time = reader.read<uint64>();
+      source.hash = reader.read<uint64>();
+
+      if (not is_cache_source_unchanged(world_dir, source)) return false;
+   }
+
+   return true;
+}
+
+void read_cache_world(cache_reader& reader, world& world)
+{
+   world.layer_descriptions.resize(reader.read_count(max_layers));
+
+   for (layer_description& layer : world.layer_descriptions) {
+      layer.name = reader.read_string();
+      layer.flags = reader.read<layer_flags>();
+   }
+
+   world.game_modes.resize(reader.read_count(max_entities));
+
+   for (game_mode_description& game_mode : world.game_modes) {
+      game_mode.name = reader.read_string();
+      game_mode.layers = reader.read_array<int>();
+   }
+
+   world.common_layers = reader.read_array<int>();
+
+   world.global_lights.global_light_1 = read_link<light>(reader);
+   world.global_lights.global_light_2 = read_link<light>(reader);
+   world.global_lights.ambient_sky_color = reader.read<float3>();
+   world.global_lights.ambient_ground_color = reader.read<float3>();
+   world.global_lights.env_map_texture = reader.read_string();
+
+   read_entities(reader, world.objects, world.next_id.objects);
+   read_entities(reader, world.lights, world.next_id.lights);
+   read_entities(reader, world.paths, world.next_id.paths);
+   read_entities(reader, world.regions, world.next_id.regions);
+   read_entities(reader, world.sectors, world.next_id.sectors);
+   read_entities(reader, world.portals, world.next_id.portals);
+   read_entities(reader, world.hintnodes, world.next_id.hintnodes);
+   read_entities(reader, world.barriers, world.next_id.barriers);
+   read_entities(reader, world.planning_hubs, world.next_id.planning_hubs);
+   read_entities(reader, world.planning_connections, world.next_id.planning_connections);
+   read_entities(reader, world.boundaries, world.next_id.boundaries);
+   read_entities(reader, world.measurements, world.next_id.measurements);
+   read_entities(reader, world.animations, world.next_id.animations);
+   read_entities(reader, world.animation_groups, world.next_id.animation_groups);
+   read_entities(reader, world.animation_hierarchies, world.next_id.animation_hierarchies);
+}
+
+}
+
+auto get_world_cache_path(const io::path& world_path) noexcept -> io::path
+{
+   return io::compose_path(world_path.parent_path(), world_path.stem(), ".wecache"sv);
+}
+
+bool read_world_cache(const io::path& world_path, world& world_out,
+                      layer_remap& layer_remap_out,
+                      std::vector<std::string>& messages_out) noexcept
+{
+   try {
+      const io::path cache_path = get_world_cache_path(world_path);
+
+      if (not io::exists(cache_path)) return false;
+
+      const io::memory_mapped_file file{
+         io::memory_mapped_file_params{.path = cache_path, .map_mode = io::map_mode::read}};
+
+      utility::binary_reader header_reader{std::span{file.data(), file.size()}};
+
+      const cache_header header = header_reader.read<cache_header>();
+
+      if (header.magic != cache_magic) return false;
+      if (header.version != cache_version) return false;
+
+      cache_reader reader{header_reader.read_bytes(header.body_size)};
+
+      if (header_reader) return false;
+
+      if (not read_cache_sources(reader, world_path.parent_path())) return false;
+
+      const layer_remap cached_layer_remap = reader.read<layer_remap>();
+      std::vector<std::string> messages = read_strings(reader);
+
+      world cached_world;
+
+      read_cache_world(reader, cached_world);
+
+      if (reader) return false;
+
+      world_out.layer_descriptions = std::move(cached_world.layer_descriptions);
+      world_out.game_modes = std::move(cached_world.game_modes);
+      world_out.common_layers = std::move(cached_world.common_layers);
+      world_out.global_lights = std::move(cached_world.global_lights);
+      world_out.objects = std::move(cached_world.objects);
+      world_out.lights = std::move(cached_world.lights);
+      world_out.paths = std::move(cached_world.paths);
+      world_out.regions = std::move(cached_world.regions);
+      world_out.sectors = std::move(cached_world.sectors);
+      world_out.portals = std::move(cached_world.portals);
+      world_out.hintnodes = std::move(cached_world.hintnodes);
+      world_out.barriers = std::move(cached_world.barriers);
+      world_out.planning_hubs = std::move(cached_world.planning_hubs);
+      world_out.planning_connections = std::move(cached_world.planning_connections);
+      world_out.boundaries = std::move(cached_world.boundaries);
+      world_out.measurements = std::move(cached_world.measurements);
+      world_out.animations = std::move(cached_world.animations);
+      world_out.animation_groups = std::move(cached_world.animation_groups);
+      world_out.animation_hierarchies = std::move(cached_world.animation_hierarchies);
+      world_out.next_id = cached_world.next_id;
+
+      layer_remap_out = cached_layer_remap;
+      messages_out = std::move(messages);
+
+      return true;
+   }
+   catch (io::error&) {
+      return false;
+   }
+   catch (utility::binary_reader_overflow&) {
+      return false;
+   }
+}
+
+void write_world_cache(const io::path& world_path, const world& world,
+                       const layer_remap& layer_remap,
+                       const std::span<const std::string> messages) noexcept
+{
+   try {
+      const io::path world_dir = world_path.parent_path();
+
+      std::vector<cache_source> sources;
+
+      for (std::string& file_name : get_layer_file_names(world)) {
+         sources.push_back(make_cache_source(world_dir, std::move(file_name)));
+      }
+
+      cache_writer writer;
+
+      write_cache_body(writer, sources, world, layer_remap, messages);
+
+      const std::span<const std::byte> body = writer.bytes();
+
+      io::memory_mapped_file file{
+         io::memory_mapped_file_params{.path = get_world_cache_path(world_path),
+                                       .size = sizeof(cache_header) + body.size(),
+                                       .truncate_to_size = true}};
+
+      std::memcpy(file.data() + sizeof(cache_header), body.data(), body.size());
+
+      // The header is written last so an interrupted write is never mistaken for a valid cache.
+      const cache_header header{.body_size = body.size()};
+
+      std::memcpy(file.data(), &header, sizeof(header));
+   }
+   catch (io::error&) {
+   }
+}
+
+}
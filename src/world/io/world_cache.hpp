@@ -0,0 +1,43 @@
+#pragma once
+
+#include "../world.hpp"
+#include "layer_remap.hpp"
+
+#include "io/path.hpp"
+
+#include <span>
+#include <string>
+#include <vector>
+
+namespace we::world {
+
+/// @brief Get the path to the cache for a world. The cache sits next to the world's files.
+/// @param world_path The path to the world.
+/// @return The path to the cache.
+auto get_world_cache_path(const io::path& world_path) noexcept -> io::path;
+
+/// @brief Read a world's layers from its cache. The cache holds what is loaded from the world's layer index and layer
+/// files, the world's other files (terrain, effects, blocks, requirements, etc) are not part of it.
+///
+/// The cache is only used if every layer file is unchanged since the cache was written. A file is unchanged if it's
+/// last write time matches or, failing that, if the hash of it's contents matches.
+/// @param world_path The path to the world.
+/// @param world_out The world to read the layers into. Left untouched if the cache can't be used.
+/// @param layer_remap_out The layer remap from the world's layer index.
+/// @param messages_out The output written when the layers were loaded from their files.
+/// @return True if the cache was read, false if it is missing, out of date or invalid.
+bool read_world_cache(const io::path& world_path, world& world_out,
+                      layer_remap& layer_remap_out,
+                      std::vector<std::string>& messages_out) noexcept;
+
+/// @brief Write the cache for a world's layers. Must be called right after the layers have been loaded from their files,
+/// before anything else has modified them. Failures are ignored, the cache is only there to speed up loading.
+/// @param world_path The path to the world.
+/// @param world The world to cache the layers of.
+/// @param layer_remap The layer remap from the world's layer index.
+/// @param messages The output written when the layers were loaded.
+void write_world_cache(const io::path& world_path, const world& world,
+                       const layer_remap& layer_remap,
+                       const std::span<const std::string> messages) noexcept;
+
+}
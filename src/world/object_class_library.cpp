@@ -65,11 +65,15 @@ struct object_class_library::impl {
    impl(const impl&) noexcept = delete;
    auto operator=(const impl&) noexcept -> impl& = delete;
 
-   void update(const float delta_time) noexcept
+   auto update(const float delta_time) noexcept -> bool
    {
+      bool classes_changed = false;
+
       {
          std::scoped_lock lock{_definition_load_queue_mutex, _model_load_queue_mutex};
 
+         classes_changed |= not _definition_load_queue.empty();
+
          for (const auto& loaded : _definition_load_queue) {
             object_definition_loaded(loaded);
          }
@@ -80,6 +84,8 @@ struct object_class_library::impl {
       {
          std::scoped_lock lock{_model_load_queue_mutex};
 
+         classes_changed |= not _model_load_queue.empty();
+
          for (const auto& loaded : _model_load_queue) {
             model_loaded(loaded);
          }
@@ -90,6 +96,8 @@ struct object_class_library::impl {
       for (const uint32 class_index : _leaf_patch_class_index) {
          _billboard_patch_class_pool[class_index]->update(delta_time);
       }
+
+      return classes_changed;
    }
 
    void clear() noexcept
@@ -380,9 +388,9 @@ object_class_library::object_class_library(assets::libraries_manager& asset_libr
 
 object_class_library::~object_class_library() = default;
 
-void object_class_library::update(const float delta_time) noexcept
+auto object_class_library::update(const float delta_time) noexcept -> bool
 {
-   _impl->update(delta_time);
+   return _impl->update(delta_time);
 }
 
 void object_class_library::clear() noexcept
@@ -25,7 +25,8 @@ struct object_class_library {
       -> object_class_library& = delete;
 
    /// @brief Update animations and classes with assets that have been loaded in the background.
-   void update(const float delta_time) noexcept;
+   /// @return True if the definition or model of any class changed.
+   auto update(const float delta_time) noexcept -> bool;
 
    /// @brief Clear the library. All handles become invalid after this and there is no need to call `free` for them.
    void clear() noexcept;
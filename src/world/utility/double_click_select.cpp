@@ -1,5 +1,6 @@
 #include "double_click_select.hpp"
 
+#include "entity_spatial_index.hpp"
 #include "intersects_frustum.hpp"
 #include "is_similar.hpp"
 #include "world_utilities.hpp"
@@ -10,11 +11,14 @@
 
 namespace we::world {
 
-void double_click_select(const interaction_target& hovered_entity, const world& world,
-                         const object_class_library& object_classes,
-                         const blocks_custom_mesh_bvh_library& bvh_library,
-                         const frustum& frustumWS, select_op op,
-                         selection& selection, const select_settings& settings) noexcept
+namespace {
+
+void double_click_select_impl(const interaction_target& hovered_entity, const world& world,
+                              const object_class_library& object_classes,
+                              const blocks_custom_mesh_bvh_library& bvh_library,
+                              const entity_spatial_index* index, const frustum& frustumWS,
+                              select_op op, selection& selection,
+                              const select_settings& settings) noexcept
 {
    if (hovered_entity.is<object_id>()) {
       const object* hovered_object =
@@ -22,9 +26,9 @@ void double_click_select(const interaction_target& hovered_entity, const world&
 
       if (not hovered_object) return;
 
-      for (const object& object : world.objects) {
-         if (object.hidden) continue;
-         if (not is_similar(object, *hovered_object)) continue;
+      for_each_candidate(world.objects, index, frustumWS, [&](const object& object) {
+         if (object.hidden) return;
+         if (not is_similar(object, *hovered_object)) return;
 
          if (intersects(frustumWS, object, object_classes)) {
             if (op == select_op::remove) {
@@ -34,7 +38,7 @@ void double_click_select(const interaction_target& hovered_entity, const world&
                selection.add(object.id);
             }
          }
-      }
+      });
    }
    else if (hovered_entity.is<light_id>()) {
       const light* hovered_light =
@@ -42,9 +46,9 @@ void double_click_select(const interaction_target& hovered_entity, const world&
 
       if (not hovered_light) return;
 
-      for (const light& light : world.lights) {
-         if (light.hidden) continue;
-         if (not is_similar(light, *hovered_light)) continue;
+      for_each_candidate(world.lights, index, frustumWS, [&](const light& light) {
+         if (light.hidden) return;
+         if (not is_similar(light, *hovered_light)) return;
 
          if (intersects(frustumWS, light)) {
             if (op == select_op::remove) {
@@ -54,7 +58,7 @@ void double_click_select(const interaction_target& hovered_entity, const world&
                selection.add(light.id);
             }
          }
-      }
+      });
    }
    else if (hovered_entity.is<path_id_node_mask>()) {
       const path* hovered_path =
@@ -80,9 +84,9 @@ void double_click_select(const interaction_target& hovered_entity, const world&
 
       if (not hovered_region) return;
 
-      for (const region& region : world.regions) {
-         if (region.hidden) continue;
-         if (not is_similar(region, *hovered_region)) continue;
+      for_each_candidate(world.regions, index, frustumWS, [&](const region& region) {
+         if (region.hidden) return;
+         if (not is_similar(region, *hovered_region)) return;
 
          if (intersects(frustumWS, region)) {
             if (op == select_op::remove) {
@@ -92,7 +96,7 @@ void double_click_select(const interaction_target& hovered_entity, const world&
                selection.add(region.id);
             }
          }
-      }
+      });
    }
    else if (hovered_entity.is<sector_id>()) {
       const sector* hovered_sector =
@@ -100,8 +104,8 @@ void double_click_select(const interaction_target& hovered_entity, const world&
 
       if (not hovered_sector) return;
 
-      for (const sector& sector : world.sectors) {
-         if (sector.hidden) continue;
+      for_each_candidate(world.sectors, index, frustumWS, [&](const sector& sector) {
+         if (sector.hidden) return;
 
          if (intersects(frustumWS, sector)) {
             if (op == select_op::remove) {
@@ -111,7 +115,7 @@ void double_click_select(const interaction_target& hovered_entity, const world&
                selection.add(sector.id);
             }
          }
-      }
+      });
    }
    else if (hovered_entity.is<portal_id>()) {
       const portal* hovered_portal =
@@ -119,9 +123,9 @@ void double_click_select(const interaction_target& hovered_entity, const world&
 
       if (not hovered_portal) return;
 
-      for (const portal& portal : world.portals) {
-         if (portal.hidden) continue;
-         if (not is_similar(portal, *hovered_portal)) continue;
+      for_each_candidate(world.portals, index, frustumWS, [&](const portal& portal) {
+         if (portal.hidden) return;
+         if (not is_similar(portal, *hovered_portal)) return;
 
          if (intersects(frustumWS, portal)) {
             if (op == select_op::remove) {
@@ -131,7 +135,7 @@ void double_click_select(const interaction_target& hovered_entity, const world&
                selection.add(portal.id);
             }
          }
-      }
+      });
    }
    else if (hovered_entity.is<barrier_id>()) {
       const barrier* hovered_barrier =
@@ -139,9 +143,9 @@ void double_click_select(const interaction_target& hovered_entity, const world&
 
       if (not hovered_barrier) return;
 
-      for (const barrier& barrier : world.barriers) {
-         if (barrier.hidden) continue;
-         if (not is_similar(barrier, *hovered_barrier)) continue;
+      for_each_candidate(world.barriers, index, frustumWS, [&](const barrier& barrier) {
+         if (barrier.hidden) return;
+         if (not is_similar(barrier, *hovered_barrier)) return;
 
          if (intersects(frustumWS, barrier, settings.barrier_visualizer_height)) {
             if (op == select_op::remove) {
@@ -151,7 +155,7 @@ void double_click_select(const interaction_target& hovered_entity, const world&
                selection.add(barrier.id);
             }
          }
-      }
+      });
    }
    else if (hovered_entity.is<hintnode_id>()) {
       const hintnode* hovered_hintnode =
@@ -159,9 +163,9 @@ void double_click_select(const interaction_target& hovered_entity, const world&
 
       if (not hovered_hintnode) return;
 
-      for (const hintnode& hintnode : world.hintnodes) {
-         if (hintnode.hidden) continue;
-         if (not is_similar(hintnode, *hovered_hintnode)) continue;
+      for_each_candidate(world.hintnodes, index, frustumWS, [&](const hintnode& hintnode) {
+         if (hintnode.hidden) return;
+         if (not is_similar(hintnode, *hovered_hintnode)) return;
 
          if (intersects(frustumWS, hintnode)) {
             if (op == select_op::remove) {
@@ -171,7 +175,7 @@ void double_click_select(const interaction_target& hovered_entity, const world&
                selection.add(hintnode.id);
             }
          }
-      }
+      });
    }
    else if (hovered_entity.is<planning_hub_id>()) {
       const planning_hub* hovered_boundary =
@@ -179,8 +183,8 @@ void double_click_select(const interaction_target& hovered_entity, const world&
 
       if (not hovered_boundary) return;
 
-      for (const planning_hub& planning_hub : world.planning_hubs) {
-         if (planning_hub.hidden) continue;
+      for_each_candidate(world.planning_hubs, index, frustumWS, [&](const planning_hub& planning_hub) {
+         if (planning_hub.hidden) return;
 
          if (intersects(frustumWS, planning_hub, settings.hub_visualizer_height)) {
             if (op == select_op::remove) {
@@ -190,7 +194,7 @@ void double_click_select(const interaction_target& hovered_entity, const world&
                selection.add(planning_hub.id);
             }
          }
-      }
+      });
    }
    else if (hovered_entity.is<planning_connection_id>()) {
       const planning_connection* hovered_connection =
@@ -220,8 +224,8 @@ void double_click_select(const interaction_target& hovered_entity, const world&
 
       if (not hovered_boundary) return;
 
-      for (const boundary& boundary : world.boundaries) {
-         if (boundary.hidden) continue;
+      for_each_candidate(world.boundaries, index, frustumWS, [&](const boundary& boundary) {
+         if (boundary.hidden) return;
 
          if (intersects(frustumWS, boundary, settings.boundary_visualizer_height)) {
             if (op == select_op::remove) {
@@ -231,7 +235,7 @@ void double_click_select(const interaction_target& hovered_entity, const world&
                selection.add(boundary.id);
             }
          }
-      }
+      });
    }
    else if (hovered_entity.is<measurement_id>()) {
       const measurement* hovered_measurement =
@@ -263,12 +267,43 @@ void double_click_select(const interaction_target& hovered_entity, const world&
                                             hovered_entity.get<block_id>().type(), *hovered_block)] =
             true;
 
-         drag_select(world.blocks, active_block_layer, bvh_library, frustumWS,
-                     op == select_op::add ? block_drag_select_op::add
-                                          : block_drag_select_op::remove,
-                     selection);
+         const block_drag_select_op block_op = op == select_op::add
+                                                  ? block_drag_select_op::add
+                                                  : block_drag_select_op::remove;
+
+         if (index) {
+            drag_select(world.blocks, active_block_layer, bvh_library, index->blocks(),
+                        frustumWS, block_op, selection);
+         }
+         else {
+            drag_select(world.blocks, active_block_layer, bvh_library, frustumWS, block_op,
+                        selection);
+         }
       }
    }
 }
 
-}
\ No newline at end of file
+}
+
+void double_click_select(const interaction_target& hovered_entity, const world& world,
+                         const object_class_library& object_classes,
+                         const blocks_custom_mesh_bvh_library& bvh_library,
+                         const frustum& frustumWS, select_op op,
+                         selection& selection, const select_settings& settings) noexcept
+{
+   double_click_select_impl(hovered_entity, world, object_classes, bvh_library, nullptr,
+                            frustumWS, op, selection, settings);
+}
+
+void double_click_select(const interaction_target& hovered_entity, const world& world,
+                         const object_class_library& object_classes,
+                         const blocks_custom_mesh_bvh_library& bvh_library,
+                         const entity_spatial_index& index, const frustum& frustumWS,
+                         select_op op, selection& selection,
+                         const select_settings& settings) noexcept
+{
+   double_click_select_impl(hovered_entity, world, object_classes, bvh_library, &index,
+                            frustumWS, op, selection, settings);
+}
+
+}
@@ -10,6 +10,7 @@
 namespace we::world {
 
 struct blocks_custom_mesh_bvh_library;
+struct entity_spatial_index;
 struct object_class_library;
 
 /// @brief Add (or remove) similar entities that intersect the frustum to (or from) the selection.
@@ -26,4 +27,14 @@ void double_click_select(const interaction_target& hovered_entity, const world&
                          const frustum& frustumWS, select_op op, selection& selection,
                          const select_settings& settings) noexcept;
 
+/// @brief Add (or remove) similar entities that intersect the frustum to (or from) the selection.
+/// Uses an entity_spatial_index to find the entities to test. The index must be up to date with
+/// the world.
+void double_click_select(const interaction_target& hovered_entity, const world& world,
+                         const object_class_library& object_classes,
+                         const blocks_custom_mesh_bvh_library& bvh_library,
+                         const entity_spatial_index& index, const frustum& frustumWS,
+                         select_op op, selection& selection,
+                         const select_settings& settings) noexcept;
+
 }
\ No newline at end of file
@@ -1,22 +1,26 @@
 #include "drag_select.hpp"
 
+#include "entity_spatial_index.hpp"
 #include "intersects_frustum.hpp"
 
 #include "../blocks/utility/drag_select.hpp"
 
 namespace we::world {
 
-void drag_select(const world& world, const active_entity_types active_entities,
-                 const active_layers active_layers,
-                 const object_class_library& object_classes,
-                 const blocks_custom_mesh_bvh_library& bvh_library,
-                 const frustum& frustumWS, select_op op, selection& selection,
-                 const select_settings& settings) noexcept
+namespace {
+
+void drag_select_impl(const world& world, const active_entity_types active_entities,
+                      const active_layers active_layers,
+                      const object_class_library& object_classes,
+                      const blocks_custom_mesh_bvh_library& bvh_library,
+                      const entity_spatial_index* index, const frustum& frustumWS,
+                      select_op op, selection& selection,
+                      const select_settings& settings) noexcept
 {
    if (active_entities.objects) {
-      for (const object& object : world.objects) {
+      for_each_candidate(world.objects, index, frustumWS, [&](const object& object) {
          if (not active_layers[object.layer] or object.hidden) {
-            continue;
+            return;
          }
 
          if (intersects(frustumWS, object, object_classes)) {
@@ -27,13 +31,13 @@ void drag_select(const world& world, const active_entity_types active_entities,
                selection.add(object.id);
             }
          }
-      }
+      });
    }
 
    if (active_entities.lights) {
-      for (const light& light : world.lights) {
+      for_each_candidate(world.lights, index, frustumWS, [&](const light& light) {
          if (not active_layers[light.layer] or light.hidden) {
-            continue;
+            return;
          }
 
          if (intersects(frustumWS, light)) {
@@ -44,13 +48,13 @@ void drag_select(const world& world, const active_entity_types active_entities,
                selection.add(light.id);
             }
          }
-      }
+      });
    }
 
    if (active_entities.paths) {
-      for (const path& path : world.paths) {
+      for_each_candidate(world.paths, index, frustumWS, [&](const path& path) {
          if (not active_layers[path.layer] or path.hidden) {
-            continue;
+            return;
          }
 
          for (uint32 i = 0; i < path.nodes.size(); ++i) {
@@ -63,13 +67,13 @@ void drag_select(const world& world, const active_entity_types active_entities,
                }
             }
          }
-      }
+      });
    }
 
    if (active_entities.regions) {
-      for (const region& region : world.regions) {
+      for_each_candidate(world.regions, index, frustumWS, [&](const region& region) {
          if (not active_layers[region.layer] or region.hidden) {
-            continue;
+            return;
          }
 
          if (intersects(frustumWS, region)) {
@@ -80,12 +84,12 @@ void drag_select(const world& world, const active_entity_types active_entities,
                selection.add(region.id);
             }
          }
-      }
+      });
    }
 
    if (active_entities.sectors) {
-      for (const sector& sector : world.sectors) {
-         if (sector.hidden) continue;
+      for_each_candidate(world.sectors, index, frustumWS, [&](const sector& sector) {
+         if (sector.hidden) return;
 
          if (intersects(frustumWS, sector)) {
             if (op == select_op::remove) {
@@ -95,12 +99,12 @@ void drag_select(const world& world, const active_entity_types active_entities,
                selection.add(sector.id);
             }
          }
-      }
+      });
    }
 
    if (active_entities.portals) {
-      for (const portal& portal : world.portals) {
-         if (portal.hidden) continue;
+      for_each_candidate(world.portals, index, frustumWS, [&](const portal& portal) {
+         if (portal.hidden) return;
 
          if (intersects(frustumWS, portal)) {
             if (op == select_op::remove) {
@@ -110,13 +114,13 @@ void drag_select(const world& world, const active_entity_types active_entities,
                selection.add(portal.id);
             }
          }
-      }
+      });
    }
 
    if (active_entities.hintnodes) {
-      for (const hintnode& hintnode : world.hintnodes) {
+      for_each_candidate(world.hintnodes, index, frustumWS, [&](const hintnode& hintnode) {
          if (not active_layers[hintnode.layer] or hintnode.hidden) {
-            continue;
+            return;
          }
 
          if (intersects(frustumWS, hintnode)) {
@@ -127,12 +131,12 @@ void drag_select(const world& world, const active_entity_types active_entities,
                selection.add(hintnode.id);
             }
          }
-      }
+      });
    }
 
    if (active_entities.barriers) {
-      for (const barrier& barrier : world.barriers) {
-         if (barrier.hidden) continue;
+      for_each_candidate(world.barriers, index, frustumWS, [&](const barrier& barrier) {
+         if (barrier.hidden) return;
 
          if (intersects(frustumWS, barrier, settings.barrier_visualizer_height)) {
             if (op == select_op::remove) {
@@ -142,12 +146,12 @@ void drag_select(const world& world, const active_entity_types active_entities,
                selection.add(barrier.id);
             }
          }
-      }
+      });
    }
 
    if (active_entities.planning_hubs) {
-      for (const planning_hub& hub : world.planning_hubs) {
-         if (hub.hidden) continue;
+      for_each_candidate(world.planning_hubs, index, frustumWS, [&](const planning_hub& hub) {
+         if (hub.hidden) return;
 
          if (intersects(frustumWS, hub, settings.hub_visualizer_height)) {
             if (op == select_op::remove) {
@@ -157,7 +161,7 @@ void drag_select(const world& world, const active_entity_types active_entities,
                selection.add(hub.id);
             }
          }
-      }
+      });
    }
 
    if (active_entities.planning_connections) {
@@ -177,8 +181,8 @@ void drag_select(const world& world, const active_entity_types active_entities,
    }
 
    if (active_entities.boundaries) {
-      for (const boundary& boundary : world.boundaries) {
-         if (boundary.hidden) continue;
+      for_each_candidate(world.boundaries, index, frustumWS, [&](const boundary& boundary) {
+         if (boundary.hidden) return;
 
          if (intersects(frustumWS, boundary, settings.barrier_visualizer_height)) {
             if (op == select_op::remove) {
@@ -188,7 +192,7 @@ void drag_select(const world& world, const active_entity_types active_entities,
                selection.add(boundary.id);
             }
          }
-      }
+      });
    }
 
    if (active_entities.measurements) {
@@ -207,11 +211,42 @@ void drag_select(const world& world, const active_entity_types active_entities,
    }
 
    if (active_entities.blocks) {
-      drag_select(world.blocks, active_layers, bvh_library, frustumWS,
-                  op == select_op::remove ? block_drag_select_op::remove
-                                          : block_drag_select_op::add,
-                  selection);
+      const block_drag_select_op block_op = op == select_op::remove
+                                               ? block_drag_select_op::remove
+                                               : block_drag_select_op::add;
+
+      if (index) {
+         drag_select(world.blocks, active_layers, bvh_library, index->blocks(), frustumWS,
+                     block_op, selection);
+      }
+      else {
+         drag_select(world.blocks, active_layers, bvh_library, frustumWS, block_op, selection);
+      }
    }
 }
 
-}
\ No newline at end of file
+}
+
+void drag_select(const world& world, const active_entity_types active_entities,
+                 const active_layers active_layers,
+                 const object_class_library& object_classes,
+                 const blocks_custom_mesh_bvh_library& bvh_library,
+                 const frustum& frustumWS, select_op op, selection& selection,
+                 const select_settings& settings) noexcept
+{
+   drag_select_impl(world, active_entities, active_layers, object_classes, bvh_library,
+                    nullptr, frustumWS, op, selection, settings);
+}
+
+void drag_select(const world& world, const active_entity_types active_entities,
+                 const active_layers active_layers,
+                 const object_class_library& object_classes,
+                 const blocks_custom_mesh_bvh_library& bvh_library,
+                 const entity_spatial_index& index, const frustum& frustumWS,
+                 select_op op, selection& selection, const select_settings& settings) noexcept
+{
+   drag_select_impl(world, active_entities, active_layers, object_classes, bvh_library,
+                    &index, frustumWS, op, selection, settings);
+}
+
+}
@@ -11,6 +11,7 @@
 namespace we::world {
 
 struct blocks_custom_mesh_bvh_library;
+struct entity_spatial_index;
 struct object_class_library;
 
 /// @brief Add (or remove) entities that intersect the frustum to (or from) the selection.
@@ -29,4 +30,14 @@ void drag_select(const world& world, const active_entity_types active_entities,
                  const frustum& frustumWS, select_op op, selection& selection,
                  const select_settings& settings) noexcept;
 
+/// @brief Add (or remove) entities that intersect the frustum to (or from) the selection. Uses
+/// an entity_spatial_index to find the entities to test. The index must be up to date with the
+/// world.
+void drag_select(const world& world, const active_entity_types active_entities,
+                 const active_layers active_layers,
+                 const object_class_library& object_classes,
+                 const blocks_custom_mesh_bvh_library& bvh_library,
+                 const entity_spatial_index& index, const frustum& frustumWS,
+                 select_op op, selection& selection, const select_settings& settings) noexcept;
+
 }
\ No newline at end of file
@@ -98,6 +98,20 @@ auto get_placed_entity_name_impl(std::string_view name, std::span<const T> world
    return name;
 }
 
+template<typename T>
+auto get_placed_entity_name_impl(std::string_view name, std::span<const T> world_entities,
+                                 const entity_name_index& group_names,
+                                 const uint32 group_base_index) noexcept -> std::string_view
+{
+   const std::optional<uint32> group_index = group_names.find(name);
+
+   if (not group_index) return name;
+   if (world_entities.size() < group_base_index) return name;
+   if (world_entities.size() - group_base_index <= *group_index) return name;
+
+   return world_entities[group_base_index + *group_index].name;
+}
+
 void fill_entity_group_block_materials(entity_group& group, const blocks& blocks) noexcept
 {
    group.blocks.materials.reserve(max_block_materials);
@@ -711,6 +725,29 @@ auto get_placed_entity_name(std::string_view name, std::span<const sector> world
                                       group_base_index);
 }
 
+auto get_placed_entity_name(std::string_view name, std::span<const object> world_objects,
+                            const entity_name_index& group_object_names,
+                            const uint32 group_base_index) noexcept -> std::string_view
+{
+   return get_placed_entity_name_impl(name, world_objects, group_object_names,
+                                      group_base_index);
+}
+
+auto get_placed_entity_name(std::string_view name, std::span<const path> world_paths,
+                            const entity_name_index& group_path_names,
+                            const uint32 group_base_index) noexcept -> std::string_view
+{
+   return get_placed_entity_name_impl(name, world_paths, group_path_names, group_base_index);
+}
+
+auto get_placed_entity_name(std::string_view name, std::span<const sector> world_sectors,
+                            const entity_name_index& group_sector_names,
+                            const uint32 group_base_index) noexcept -> std::string_view
+{
+   return get_placed_entity_name_impl(name, world_sectors, group_sector_names,
+                                      group_base_index);
+}
+
 auto make_entity_group_from_selection(const world& world,
                                       const selection& selection) noexcept -> entity_group
 {
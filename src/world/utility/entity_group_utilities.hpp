@@ -4,6 +4,7 @@
 #include "../interaction_context.hpp"
 #include "../object_class_library.hpp"
 #include "../world.hpp"
+#include "entity_name_index.hpp"
 #include "math/bounding_box.hpp"
 
 #include <span>
@@ -58,6 +59,39 @@ auto get_placed_entity_name(std::string_view name, std::span<const sector> world
                             const entity_group& group,
                             const uint32 group_base_index) noexcept -> std::string_view;
 
+/// @brief Returns the new name of an object after it is was placed into the world. Uses an index
+/// of the group's object names, for when the names of many objects in the group are needed.
+/// @param name The original name of the object in the entity group.
+/// @param world_objects The span of world objects.
+/// @param group_object_names An entity_name_index made from the entity group's objects.
+/// @param group_base_index The index of the first object inside world_objects.
+/// @return The name of the entity after it was placed or name on failure.
+auto get_placed_entity_name(std::string_view name, std::span<const object> world_objects,
+                            const entity_name_index& group_object_names,
+                            const uint32 group_base_index) noexcept -> std::string_view;
+
+/// @brief Returns the new name of an path after it is was placed into the world. Uses an index
+/// of the group's path names, for when the names of many paths in the group are needed.
+/// @param name The original name of the path in the entity group.
+/// @param world_paths The span of world paths.
+/// @param group_path_names An entity_name_index made from the entity group's paths.
+/// @param group_base_index The index of the first path inside world_paths.
+/// @return The name of the entity after it was placed or name on failure.
+auto get_placed_entity_name(std::string_view name, std::span<const path> world_paths,
+                            const entity_name_index& group_path_names,
+                            const uint32 group_base_index) noexcept -> std::string_view;
+
+/// @brief Returns the new name of an sector after it is was placed into the world. Uses an index
+/// of the group's sector names, for when the names of many sectors in the group are needed.
+/// @param name The original name of the sector in the entity group.
+/// @param world_sectors The span of world sectors.
+/// @param group_sector_names An entity_name_index made from the entity group's sectors.
+/// @param group_base_index The index of the first sector inside world_sectors.
+/// @return The name of the entity after it was placed or name on failure.
+auto get_placed_entity_name(std::string_view name, std::span<const sector> world_sectors,
+                            const entity_name_index& group_sector_names,
+                            const uint32 group_base_index) noexcept -> std::string_view;
+
 /// @brief Make an entity_group from a selection.
 /// @param world The world.
 /// @param selection The selection.
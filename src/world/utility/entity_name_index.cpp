@@ -0,0 +1,46 @@
+#include "entity_name_index.hpp"
+
+#include "utility/string_icompare.hpp"
+
+namespace we::world {
+
+auto entity_name_hash::operator()(const std::string_view name) const noexcept -> std::size_t
+{
+   // FNV-1a over the name with A-Z folded to a-z.
+   uint64 hash = 0xcbf29ce484222325ull;
+
+   for (char c : name) {
+      if (c >= 'A' and c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+
+      hash ^= static_cast<uint8>(c);
+      hash *= 0x100000001b3ull;
+   }
+
+   return static_cast<std::size_t>(hash);
+}
+
+bool entity_name_equal::operator()(const std::string_view left,
+                                   const std::string_view right) const noexcept
+{
+   return string::iequals(left, right);
+}
+
+auto entity_name_index::find(const std::string_view name) const noexcept
+   -> std::optional<uint32>
+{
+   if (auto it = _indices.find(name); it != _indices.end()) return it->second;
+
+   return std::nullopt;
+}
+
+void entity_name_index::insert(const std::string_view name, const uint32 index) noexcept
+{
+   _indices.try_emplace(name, index);
+}
+
+auto entity_name_index::size() const noexcept -> std::size_t
+{
+   return _indices.size();
+}
+
+}
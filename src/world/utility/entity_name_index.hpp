@@ -0,0 +1,69 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+
+namespace we::world {
+
+/// @brief Hashes entity names, ignoring simple casing the same way string::iequals does.
+struct entity_name_hash {
+   using is_transparent = void;
+
+   auto operator()(const std::string_view name) const noexcept -> std::size_t;
+};
+
+/// @brief Compares entity names with string::iequals.
+struct entity_name_equal {
+   using is_transparent = void;
+
+   bool operator()(const std::string_view left, const std::string_view right) const noexcept;
+};
+
+/// @brief A case-insensitive map from entity names to their index in a list of entities. Used to
+/// look up many names against the same list without scanning the list for each name.
+///
+/// The index is a snapshot, it is not updated when the list of entities changes. So it can only
+/// be made from a std::vector, like an entity group's entities, and not from the world's
+/// pinned_vectors which are edited. The loader indexes the world's entities itself, before
+/// anything can edit them.
+struct entity_name_index {
+   entity_name_index() = default;
+
+   /// @brief Index a list of entities. When several entities share a name the first is kept,
+   /// same as find_entity.
+   /// @param entities The entities.
+   template<typename T>
+   explicit entity_name_index(const std::vector<T>& entities) noexcept
+   {
+      _indices.reserve(entities.size());
+
+      for (uint32 i = 0; i < entities.size(); ++i) {
+         _indices.try_emplace(entities[i].name, i);
+      }
+   }
+
+   /// @brief Find the index of the entity with a name.
+   /// @param name The name of the entity.
+   /// @return The index of the entity or nullopt if no entity has the name.
+   [[nodiscard]] auto find(const std::string_view name) const noexcept
+      -> std::optional<uint32>;
+
+   /// @brief Add a name to the index. Does nothing if the name is already in the index.
+   /// @param name The name of the entity.
+   /// @param index The index of the entity.
+   void insert(const std::string_view name, const uint32 index) noexcept;
+
+   /// @brief Get the number of names in the index.
+   [[nodiscard]] auto size() const noexcept -> std::size_t;
+
+private:
+   absl::flat_hash_map<std::string, uint32, entity_name_hash, entity_name_equal> _indices;
+};
+
+}
@@ -0,0 +1,492 @@
+#include "entity_spatial_index.hpp"
+
+#include "../object_class.hpp"
+#include "../object_class_library.hpp"
+#include "../object_classes/billboard_patch_class.hpp"
+
+#include "math/quaternion_funcs.hpp"
+#include "math/vector_funcs.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <utility>
+
+namespace we::world {
+
+namespace {
+
+auto make_bbox(const float3& position, const float3& half_size) noexcept
+   -> math::bounding_box
+{
+   return {.min = position - half_size, .max = position + half_size};
+}
+
+auto make_bbox(const float3& position, const float radius) noexcept -> math::bounding_box
+{
+   return make_bbox(position, float3{radius, radius, radius});
+}
+
+/// @brief Get the bounds of a list of points or nullopt if the list is empty.
+template<typename Point, typename Get_point>
+auto points_bbox(std::span<const Point> points, const Get_point& get_point) noexcept
+   -> std::optional<math::bounding_box>
+{
+   if (points.empty()) return std::nullopt;
+
+   math::bounding_box bbox{.min = {FLT_MAX, FLT_MAX, FLT_MAX},
+                           .max = {-FLT_MAX, -FLT_MAX, -FLT_MAX}};
+
+   for (const Point& point : points) bbox = math::integrate(bbox, get_point(point));
+
+   return bbox;
+}
+
+}
+
+bool entity_spatial_index::object_key::operator==(const object_key& other) const noexcept
+{
+   return rotation == other.rotation and position == other.position and
+          local_bbox.min == other.local_bbox.min and local_bbox.max == other.local_bbox.max and
+          model == other.model and billboard == other.billboard;
+}
+
+template<typename Key>
+void entity_spatial_index::entity_tree<Key>::clear() noexcept
+{
+   tree.clear();
+   keys.clear();
+   leaves.clear();
+}
+
+template<typename Key>
+template<typename T, typename Get_key, typename Get_bbox>
+void entity_spatial_index::entity_tree<Key>::update(std::span<const T> entities,
+                                                    const Get_key& get_key,
+                                                    const Get_bbox& get_bbox) noexcept
+{
+   while (leaves.size() > entities.size()) {
+      if (leaves.back() != dynamic_aabb_tree::null_leaf) tree.remove(leaves.back());
+
+      leaves.pop_back();
+      keys.pop_back();
+   }
+
+   keys.reserve(entities.size());
+   leaves.reserve(entities.size());
+
+   for (std::size_t i = 0; i < entities.size(); ++i) {
+      const Key key = get_key(entities[i]);
+
+      if (i == keys.size()) {
+         const std::optional<math::bounding_box> bbox = get_bbox(key);
+
+         keys.push_back(key);
+         leaves.push_back(bbox ? tree.insert(*bbox, static_cast<uint32>(i))
+                               : dynamic_aabb_tree::null_leaf);
+
+         continue;
+      }
+
+      if (keys[i] == key) continue;
+
+      keys[i] = key;
+
+      const std::optional<math::bounding_box> bbox = get_bbox(key);
+
+      if (not bbox) {
+         if (leaves[i] != dynamic_aabb_tree::null_leaf) tree.remove(leaves[i]);
+
+         leaves[i] = dynamic_aabb_tree::null_leaf;
+      }
+      else if (leaves[i] == dynamic_aabb_tree::null_leaf) {
+         leaves[i] = tree.insert(*bbox, static_cast<uint32>(i));
+      }
+      else {
+         tree.move(leaves[i], *bbox);
+      }
+   }
+}
+
+void entity_spatial_index::update_objects(std::span<const object> objects,
+                                          const object_class_library& object_classes) noexcept
+{
+   while (_objects.size() > objects.size()) {
+      object_entry& entry = _objects.back();
+
+      _object_tree.remove(entry.leaf);
+
+      if (entry.billboard_patch_leaf != dynamic_aabb_tree::null_leaf) {
+         _billboard_patch_tree.remove(entry.billboard_patch_leaf);
+      }
+
+      remove_object_mesh_instances(entry);
+
+      _objects.pop_back();
+   }
+
+   _objects.reserve(objects.size());
+
+   for (uint32 i = 0; i < objects.size(); ++i) {
+      const object& object = objects[i];
+      const object_class& object_class = object_classes[object.class_handle];
+
+      object_key key;
+
+      if (object_class.flags.is_billboard_patch) [[unlikely]] {
+         key = {.rotation = y_flip(object.rotation),
+                .position = object.position,
+                .local_bbox =
+                   object_classes.get_billboard_patch_class(object.class_handle).bbox(),
+                .billboard = true};
+      }
+      else {
+         key = {.rotation = object.rotation,
+                .position = object.position,
+                .local_bbox = object_class.model->bounding_box,
+                .model = object_class.model.get()};
+      }
+
+      if (i == _objects.size()) {
+         _objects.emplace_back();
+      }
+      else if (_objects[i].key == key) {
+         continue;
+      }
+
+      object_entry& entry = _objects[i];
+
+      entry.key = key;
+
+      const math::bounding_box bbox = key.rotation * key.local_bbox + key.position;
+
+      if (entry.leaf == dynamic_aabb_tree::null_leaf) {
+         entry.leaf = _object_tree.insert(bbox, i);
+      }
+      else {
+         _object_tree.move(entry.leaf, bbox);
+      }
+
+      if (key.billboard) {
+         if (entry.billboard_patch_leaf == dynamic_aabb_tree::null_leaf) {
+            entry.billboard_patch_leaf = _billboard_patch_tree.insert(bbox, i);
+         }
+         else {
+            _billboard_patch_tree.move(entry.billboard_patch_leaf, bbox);
+         }
+      }
+      else if (entry.billboard_patch_leaf != dynamic_aabb_tree::null_leaf) {
+         _billboard_patch_tree.remove(entry.billboard_patch_leaf);
+
+         entry.billboard_patch_leaf = dynamic_aabb_tree::null_leaf;
+      }
+
+      const quaternion inverse_rotation = conjugate(key.rotation);
+
+      const top_level_bvh::instance instance{.inverse_rotation = inverse_rotation,
+                                             .inverse_position =
+                                                inverse_rotation * -key.position,
+                                             .rotation = key.rotation,
+                                             .position = key.position};
+
+      // The same model only needs it's instances moved, a different one needs new instances.
+      if (entry.model.get() == key.model) {
+         for (std::size_t mesh = 0; mesh < entry.mesh_instances.size(); ++mesh) {
+            top_level_bvh::instance mesh_instance = instance;
+
+            mesh_instance.bvh = &entry.model->bvh.get_child_bvhs()[mesh];
+
+            _object_meshes.update(entry.mesh_instances[mesh], mesh_instance);
+         }
+
+         continue;
+      }
+
+      remove_object_mesh_instances(entry);
+
+      if (not key.model) continue;
+
+      entry.model = object_class.model;
+
+      for (const bvh& bvh : entry.model->bvh.get_child_bvhs()) {
+         top_level_bvh::instance mesh_instance = instance;
+
+         mesh_instance.bvh = &bvh;
+
+         const dynamic_top_level_bvh::handle handle = _object_meshes.insert(mesh_instance);
+         const std::size_t handle_index = std::to_underlying(handle);
+
+         if (handle_index >= _object_mesh_owners.size()) {
+            _object_mesh_owners.resize(handle_index + 1);
+         }
+
+         _object_mesh_owners[handle_index] = i;
+         entry.mesh_instances.push_back(handle);
+      }
+   }
+}
+
+void entity_spatial_index::remove_object_mesh_instances(object_entry& entry) noexcept
+{
+   for (const dynamic_top_level_bvh::handle handle : entry.mesh_instances) {
+      _object_meshes.remove(handle);
+   }
+
+   entry.mesh_instances.clear();
+   entry.model = nullptr;
+}
+
+void entity_spatial_index::update(const world& world,
+                                  const object_class_library& object_classes,
+                                  const entity_spatial_index_config& config) noexcept
+{
+   // Entities are only compared against their keys for types that have been edited, on most frames
+   // nothing has been and comparing every key would cost as much as the rest of the frame in a
+   // large world. Changing the config rebuilds everything.
+   dirty_entity_types dirty = world.dirty_entities;
+
+   if (config != _config) {
+      clear();
+
+      _config = config;
+
+      dirty.mark_all();
+   }
+
+   // Entities made from a list of points use an inverted key when they have no points.
+   const auto get_bounds_bbox =
+      [](const bounds_key& key) -> std::optional<math::bounding_box> {
+      if (key.min.x > key.max.x) return std::nullopt;
+
+      return math::bounding_box{.min = key.min, .max = key.max};
+   };
+
+   if (dirty.objects) update_objects(world.objects, object_classes);
+
+   if (dirty.lights) {
+      _lights.update(
+         std::span{world.lights},
+         [](const light& light) {
+            return light_key{.rotation = light.rotation,
+                             .region_rotation = light.region_rotation,
+                             .position = light.position,
+                             .region_size = light.region_size,
+                             .range = light.range,
+                             .inner_cone_angle = light.inner_cone_angle,
+                             .outer_cone_angle = light.outer_cone_angle,
+                             .light_type = light.light_type};
+         },
+         [&](const light_key& key) -> std::optional<math::bounding_box> {
+            // Lights are picked with a proxy sphere but drag selected with their volume, their
+            // bounds cover both.
+            const math::bounding_box proxy_bbox =
+               make_bbox(key.position, config.light_proxy_radius);
+
+            switch (key.light_type) {
+            case light_type::directional:
+               return proxy_bbox;
+            case light_type::point:
+               return math::combine(proxy_bbox, make_bbox(key.position, key.range));
+            case light_type::spot: {
+               const float radius =
+                  key.range * std::max(std::abs(std::tan(key.outer_cone_angle * 0.5f)),
+                                       std::abs(std::tan(key.inner_cone_angle * 0.5f)));
+
+               const math::bounding_box cone_bbox{.min = {-radius, -radius, 0.0f},
+                                                  .max = {radius, radius, key.range}};
+
+               return math::combine(proxy_bbox, key.rotation * cone_bbox + key.position);
+            }
+            case light_type::directional_region_box: {
+               const math::bounding_box region_bbox{.min = -key.region_size,
+                                                    .max = key.region_size};
+
+               return key.region_rotation * region_bbox + key.position;
+            }
+            case light_type::directional_region_sphere:
+               return make_bbox(key.position, length(key.region_size));
+            case light_type::directional_region_cylinder: {
+               const float radius = length(float2{key.region_size.x, key.region_size.z});
+
+               const math::bounding_box region_bbox{.min = {-radius, -key.region_size.y, -radius},
+                                                    .max = {radius, key.region_size.y, radius}};
+
+               return key.region_rotation * region_bbox + key.position;
+            }
+            default:
+               return std::nullopt;
+            }
+         });
+   }
+
+   if (dirty.paths) {
+      _paths.update(
+         std::span{world.paths},
+         [&](const path& path) {
+            const std::optional<math::bounding_box> bbox =
+               points_bbox(std::span{path.nodes},
+                           [](const path::node& node) { return node.position; });
+
+            if (not bbox) return bounds_key{.min = {FLT_MAX, FLT_MAX, FLT_MAX}};
+
+            return bounds_key{.min = bbox->min - config.path_node_radius,
+                              .max = bbox->max + config.path_node_radius};
+         },
+         get_bounds_bbox);
+   }
+
+   if (dirty.regions) {
+      _regions.update(
+         std::span{world.regions},
+         [](const region& region) {
+            return region_key{.rotation = region.rotation,
+                              .position = region.position,
+                              .size = region.size,
+                              .shape = region.shape};
+         },
+         [](const region_key& key) -> std::optional<math::bounding_box> {
+            switch (key.shape) {
+            case region_shape::box: {
+               const math::bounding_box region_bbox{.min = -key.size, .max = key.size};
+
+               return key.rotation * region_bbox + key.position;
+            }
+            case region_shape::sphere:
+               return make_bbox(key.position, length(key.size));
+            case region_shape::cylinder: {
+               const float radius = length(float2{key.size.x, key.size.z});
+
+               const math::bounding_box region_bbox{.min = {-radius, -key.size.y, -radius},
+                                                    .max = {radius, key.size.y, radius}};
+
+               return key.rotation * region_bbox + key.position;
+            }
+            default:
+               return std::nullopt;
+            }
+         });
+   }
+
+   if (dirty.sectors) {
+      _sectors.update(
+         std::span{world.sectors},
+         [](const sector& sector) {
+            const std::optional<math::bounding_box> bbox =
+               points_bbox(std::span{sector.points}, [&](const float2& point) {
+                  return float3{point.x, sector.base, point.y};
+               });
+
+            if (not bbox) return bounds_key{.min = {FLT_MAX, FLT_MAX, FLT_MAX}};
+
+            const float top = sector.base + sector.height;
+
+            return bounds_key{.min = {bbox->min.x, std::min(sector.base, top), bbox->min.z},
+                              .max = {bbox->max.x, std::max(sector.base, top), bbox->max.z}};
+         },
+         get_bounds_bbox);
+   }
+
+   if (dirty.portals) {
+      _portals.update(
+         std::span{world.portals},
+         [](const portal& portal) {
+            return portal_key{.position = portal.position,
+                              .width = portal.width,
+                              .height = portal.height};
+         },
+         [](const portal_key& key) -> std::optional<math::bounding_box> {
+            return make_bbox(key.position, std::max(key.width, key.height));
+         });
+   }
+
+   if (dirty.hintnodes) {
+      // Hintnodes are always the same size, their key is just their position.
+      _hintnodes.update(
+         std::span{world.hintnodes}, [](const hintnode& hintnode) { return hintnode.position; },
+         [](const float3& position) -> std::optional<math::bounding_box> {
+            return make_bbox(position, 2.0f);
+         });
+   }
+
+   if (dirty.barriers) {
+      _barriers.update(
+         std::span{world.barriers},
+         [](const barrier& barrier) {
+            return barrier_key{.position = barrier.position, .size = barrier.size};
+         },
+         [&](const barrier_key& key) -> std::optional<math::bounding_box> {
+            const float radius = length(key.size);
+
+            return make_bbox(key.position, float3{radius, config.barrier_height, radius});
+         });
+   }
+
+   if (dirty.planning_hubs) {
+      _planning_hubs.update(
+         std::span{world.planning_hubs},
+         [](const planning_hub& hub) {
+            return hub_key{.position = hub.position, .radius = hub.radius};
+         },
+         [&](const hub_key& key) -> std::optional<math::bounding_box> {
+            return make_bbox(key.position, float3{key.radius, config.hub_height, key.radius});
+         });
+   }
+
+   if (dirty.boundaries) {
+      _boundaries.update(
+         std::span{world.boundaries},
+         [&](const boundary& boundary) {
+            const std::optional<math::bounding_box> bbox =
+               points_bbox(std::span{boundary.points}, [](const float3& point) { return point; });
+
+            if (not bbox) return bounds_key{.min = {FLT_MAX, FLT_MAX, FLT_MAX}};
+
+            return bounds_key{.min = bbox->min - float3{0.0f, config.boundary_height, 0.0f},
+                              .max = bbox->max + float3{0.0f, config.boundary_height, 0.0f}};
+         },
+         get_bounds_bbox);
+   }
+
+   _blocks.update(world.blocks);
+}
+
+auto entity_spatial_index::raycast_object_meshes(const float3& ray_origin,
+                                                 const float3& ray_direction,
+                                                 const float max_distance,
+                                                 function_ptr<bool(const uint32) noexcept> filter)
+   const noexcept -> std::optional<object_mesh_hit>
+{
+   const std::optional<dynamic_top_level_bvh::ray_hit> hit =
+      _object_meshes.raycast(ray_origin, ray_direction, max_distance,
+                             [&](const dynamic_top_level_bvh::handle handle) noexcept {
+                                return filter(_object_mesh_owners[std::to_underlying(handle)]);
+                             });
+
+   if (not hit) return std::nullopt;
+
+   return object_mesh_hit{.distance = hit->distance,
+                          .unnormalized_normalWS = hit->unnormalized_normalWS,
+                          .object_index =
+                             _object_mesh_owners[std::to_underlying(hit->instance)]};
+}
+
+void entity_spatial_index::clear() noexcept
+{
+   _objects.clear();
+   _object_tree.clear();
+   _billboard_patch_tree.clear();
+   _object_meshes.clear();
+   _object_mesh_owners.clear();
+   _lights.clear();
+   _paths.clear();
+   _regions.clear();
+   _sectors.clear();
+   _portals.clear();
+   _hintnodes.clear();
+   _barriers.clear();
+   _planning_hubs.clear();
+   _boundaries.clear();
+   _blocks.clear();
+}
+
+}
@@ -0,0 +1,301 @@
+#pragma once
+
+#include "../blocks/spatial_index.hpp"
+#include "../world.hpp"
+
+#include "assets/asset_ref.hpp"
+#include "math/bvh.hpp"
+#include "math/dynamic_aabb_tree.hpp"
+#include "math/frustum.hpp"
+#include "utility/function_ptr.hpp"
+
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace we::assets::msh {
+
+struct flat_model;
+
+}
+
+namespace we::world {
+
+struct object_class_library;
+
+/// @brief The sizes of the proxy shapes entities are picked and selected with. Each should be at
+/// least as large as the largest size passed to raycast or drag_select for it, entities are
+/// missed by queries otherwise.
+struct entity_spatial_index_config {
+   /// @brief Radius of the spheres directional, point and spot lights are picked with.
+   float light_proxy_radius = 1.0f;
+
+   /// @brief Radius of the spheres path nodes are picked and selected with.
+   float path_node_radius = 1.0f;
+
+   float barrier_height = 1.0f;
+   float hub_height = 1.0f;
+   float boundary_height = 1.0f;
+
+   bool operator==(const entity_spatial_index_config&) const noexcept = default;
+};
+
+/// @brief Bounding box trees over the entities in a world, one tree per entity type, used to
+/// find the entities a ray or frustum could touch without testing every entity.
+///
+/// The meshes of objects are also kept in a dynamic_top_level_bvh so rays can be traced against
+/// them without visiting each object's model in turn.
+///
+/// The trees are brought up to date by calling update, which only touches entities whose bounds
+/// have changed. Planning connections and measurements are not indexed. The world's blocks are
+/// indexed by a blocks_spatial_index owned by this index.
+struct entity_spatial_index {
+   struct object_mesh_hit {
+      float distance;
+      float3 unnormalized_normalWS;
+      uint32 object_index = 0;
+   };
+
+   /// @brief Bring the index up to date with the world. Must be called after the world has
+   /// changed and before the index is next queried. Like blocks_spatial_index::update it must be
+   /// called before the blocks' dirty ranges are cleared.
+   ///
+   /// Only the entity types marked in world.dirty_entities are checked for changes. Changes made
+   /// outside of edits must mark their types, including objects when object_classes reports a
+   /// class has changed.
+   void update(const world& world, const object_class_library& object_classes,
+               const entity_spatial_index_config& config) noexcept;
+
+   /// @brief Remove everything from the index.
+   void clear() noexcept;
+
+   /// @brief Visit the entities whose bounds a ray hits, nearest first.
+   /// @param visit Called as visit(entity_index, max_distance) for each entity. max_distance can
+   /// be lowered to cull further entities. Returns false to stop.
+   template<typename T, typename Visitor>
+   void raycast(const float3& ray_origin, const float3& ray_direction, const float max_distance,
+                const Visitor& visit) const noexcept
+   {
+      get_tree<T>().raycast(ray_origin, ray_direction, max_distance, visit);
+   }
+
+   /// @brief Find the closest object mesh a ray hits. Billboard patches have no mesh and are
+   /// found with raycast_billboard_patches instead.
+   /// @param filter Called with the index of each object the ray could hit. Returns false to
+   /// skip the object.
+   [[nodiscard]] auto raycast_object_meshes(const float3& ray_origin,
+                                            const float3& ray_direction,
+                                            const float max_distance,
+                                            function_ptr<bool(const uint32) noexcept> filter)
+      const noexcept -> std::optional<object_mesh_hit>;
+
+   /// @brief Visit the billboard patch objects whose bounds a ray hits, nearest first.
+   /// @param visit Called as visit(object_index, max_distance), like for raycast.
+   template<typename Visitor>
+   void raycast_billboard_patches(const float3& ray_origin, const float3& ray_direction,
+                                  const float max_distance, const Visitor& visit) const noexcept
+   {
+      _billboard_patch_tree.raycast(ray_origin, ray_direction, max_distance, visit);
+   }
+
+   /// @brief Visit the entities whose bounds intersect a frustum.
+   /// @param visit Called as visit(entity_index) for each entity.
+   template<typename T, typename Visitor>
+   void query(const frustum& frustumWS, const Visitor& visit) const noexcept
+   {
+      get_tree<T>().query(
+         [&](const math::bounding_box& bbox) { return intersects(frustumWS, bbox); }, visit);
+   }
+
+   template<typename T>
+   [[nodiscard]] auto get_debug_boxes() const noexcept -> std::vector<math::bounding_box>
+   {
+      return get_tree<T>().get_debug_boxes();
+   }
+
+   /// @brief Get the index for the world's blocks.
+   [[nodiscard]] auto blocks() const noexcept -> const blocks_spatial_index&
+   {
+      return _blocks;
+   }
+
+private:
+   /// @brief The values an entity's bounds are made from. An entity's bounds are only
+   /// recalculated when its key changes.
+   struct object_key {
+      quaternion rotation;
+      float3 position;
+      math::bounding_box local_bbox;
+      /// @brief The object's model or nullptr for billboard patches.
+      const assets::msh::flat_model* model = nullptr;
+      bool billboard = false;
+
+      bool operator==(const object_key& other) const noexcept;
+   };
+
+   struct light_key {
+      quaternion rotation;
+      quaternion region_rotation;
+      float3 position;
+      float3 region_size;
+      float range = 0.0f;
+      float inner_cone_angle = 0.0f;
+      float outer_cone_angle = 0.0f;
+      light_type light_type = light_type::point;
+
+      bool operator==(const light_key&) const noexcept = default;
+   };
+
+   struct region_key {
+      quaternion rotation;
+      float3 position;
+      float3 size;
+      region_shape shape = region_shape::box;
+
+      bool operator==(const region_key&) const noexcept = default;
+   };
+
+   struct portal_key {
+      float3 position;
+      float width = 0.0f;
+      float height = 0.0f;
+
+      bool operator==(const portal_key&) const noexcept = default;
+   };
+
+   struct barrier_key {
+      float3 position;
+      float2 size;
+
+      bool operator==(const barrier_key&) const noexcept = default;
+   };
+
+   struct hub_key {
+      float3 position;
+      float radius = 0.0f;
+
+      bool operator==(const hub_key&) const noexcept = default;
+   };
+
+   /// @brief Key for entities made from a list of points. It's the entity's bounds, which are
+   /// about as cheap to find as any other key would be.
+   struct bounds_key {
+      float3 min;
+      float3 max;
+
+      bool operator==(const bounds_key&) const noexcept = default;
+   };
+
+   template<typename Key>
+   struct entity_tree {
+      dynamic_aabb_tree tree;
+      std::vector<Key> keys;
+      std::vector<int32> leaves;
+
+      void clear() noexcept;
+
+      /// @brief Bring the tree up to date with a list of entities.
+      /// @param get_key Returns the key for an entity.
+      /// @param get_bbox Returns the bounds for a key or nullopt if the entity should not be in
+      /// the tree.
+      template<typename T, typename Get_key, typename Get_bbox>
+      void update(std::span<const T> entities, const Get_key& get_key,
+                  const Get_bbox& get_bbox) noexcept;
+   };
+
+   struct object_entry {
+      object_key key;
+      /// @brief Keeps the key's model, and so the BVHs of the object's mesh instances, alive
+      /// until the object is next updated.
+      assets::asset_data<assets::msh::flat_model> model;
+      int32 leaf = dynamic_aabb_tree::null_leaf;
+      int32 billboard_patch_leaf = dynamic_aabb_tree::null_leaf;
+      /// @brief The object's instances in _object_meshes, one for each of it's model's BVHs.
+      std::vector<dynamic_top_level_bvh::handle> mesh_instances;
+   };
+
+   entity_spatial_index_config _config;
+
+   std::vector<object_entry> _objects;
+   dynamic_aabb_tree _object_tree;
+   dynamic_aabb_tree _billboard_patch_tree;
+   dynamic_top_level_bvh _object_meshes;
+   /// @brief The index of the object each instance in _object_meshes belongs to, indexed by the
+   /// instance's handle.
+   std::vector<uint32> _object_mesh_owners;
+
+   entity_tree<light_key> _lights;
+   entity_tree<bounds_key> _paths;
+   entity_tree<region_key> _regions;
+   entity_tree<bounds_key> _sectors;
+   entity_tree<portal_key> _portals;
+   entity_tree<float3> _hintnodes;
+   entity_tree<barrier_key> _barriers;
+   entity_tree<hub_key> _planning_hubs;
+   entity_tree<bounds_key> _boundaries;
+
+   blocks_spatial_index _blocks;
+
+   void update_objects(std::span<const object> objects,
+                       const object_class_library& object_classes) noexcept;
+
+   void remove_object_mesh_instances(object_entry& entry) noexcept;
+
+   template<typename T>
+   auto get_tree() const noexcept -> const dynamic_aabb_tree&
+   {
+      if constexpr (std::is_same_v<T, object>) {
+         return _object_tree;
+      }
+      else if constexpr (std::is_same_v<T, light>) {
+         return _lights.tree;
+      }
+      else if constexpr (std::is_same_v<T, path>) {
+         return _paths.tree;
+      }
+      else if constexpr (std::is_same_v<T, region>) {
+         return _regions.tree;
+      }
+      else if constexpr (std::is_same_v<T, sector>) {
+         return _sectors.tree;
+      }
+      else if constexpr (std::is_same_v<T, portal>) {
+         return _portals.tree;
+      }
+      else if constexpr (std::is_same_v<T, hintnode>) {
+         return _hintnodes.tree;
+      }
+      else if constexpr (std::is_same_v<T, barrier>) {
+         return _barriers.tree;
+      }
+      else if constexpr (std::is_same_v<T, planning_hub>) {
+         return _planning_hubs.tree;
+      }
+      else if constexpr (std::is_same_v<T, boundary>) {
+         return _boundaries.tree;
+      }
+      else {
+         static_assert(not std::is_same_v<T, T>, "T is not an indexed entity type");
+      }
+   }
+};
+
+/// @brief Visit the entities that could intersect a frustum.
+/// @param index The index to find the entities with or nullptr to visit every entity.
+/// @param visit Called as visit(entity) for each entity.
+template<typename T, typename Visitor>
+void for_each_candidate(const pinned_vector<T>& entities, const entity_spatial_index* index,
+                        const frustum& frustumWS, const Visitor& visit) noexcept
+{
+   if (index) {
+      index->query<T>(frustumWS, [&](const uint32 entity_index) {
+         if (entity_index < entities.size()) visit(entities[entity_index]);
+      });
+   }
+   else {
+      for (const T& entity : entities) visit(entity);
+   }
+}
+
+}
@@ -1,7 +1,10 @@
 #include "grounding.hpp"
 #include "raycast.hpp"
 #include "raycast_terrain.hpp"
+#include "world_utilities.hpp"
 
+#include "../blocks/utility/find.hpp"
+#include "../blocks/utility/grounding.hpp"
 #include "../blocks/utility/raycast.hpp"
 #include "../object_class.hpp"
 #include "../object_classes/billboard_patch_class.hpp"
@@ -9,6 +12,11 @@
 #include "math/quaternion_funcs.hpp"
 #include "math/vector_funcs.hpp"
 
+#include "async/thread_pool.hpp"
+
+#include <algorithm>
+#include <cassert>
+
 namespace we::world {
 
 namespace {
@@ -119,6 +127,122 @@ auto ground_region_cylinder(const float3 size, const quaternion rotation,
                       world, object_classes, blocks_bvh_library, active_layers);
 }
 
+/// @brief An entity from a selection to ground. Path nodes are split into an item each.
+struct ground_selection_item {
+   selected_entity entity;
+   /// @brief The index of the entity in it's world container. The path's index for path nodes
+   /// and the index in the block type's descriptions for blocks.
+   uint32 index = 0;
+   uint32 node_index = 0;
+};
+
+/// @brief Get the index of an entity in a world container or nullopt if it is not in it.
+template<typename T>
+auto find_entity_index(const pinned_vector<T>& entities, const id<T> id) noexcept
+   -> std::optional<uint32>
+{
+   const T* entity = find_entity(entities, id);
+
+   if (not entity) return std::nullopt;
+
+   return static_cast<uint32>(entity - entities.data());
+}
+
+/// @brief Get the index of a selected entity for a ground_selection_item or nullopt if it is
+/// not in the world or can't be grounded.
+auto find_selected_index(const selected_entity& selected, const world& world) noexcept
+   -> std::optional<uint32>
+{
+   if (selected.is<object_id>()) {
+      return find_entity_index(world.objects, selected.get<object_id>());
+   }
+   else if (selected.is<path_id_node_mask>()) {
+      return find_entity_index(world.paths, selected.get<path_id_node_mask>().id);
+   }
+   else if (selected.is<light_id>()) {
+      return find_entity_index(world.lights, selected.get<light_id>());
+   }
+   else if (selected.is<region_id>()) {
+      return find_entity_index(world.regions, selected.get<region_id>());
+   }
+   else if (selected.is<sector_id>()) {
+      return find_entity_index(world.sectors, selected.get<sector_id>());
+   }
+   else if (selected.is<portal_id>()) {
+      return find_entity_index(world.portals, selected.get<portal_id>());
+   }
+   else if (selected.is<hintnode_id>()) {
+      return find_entity_index(world.hintnodes, selected.get<hintnode_id>());
+   }
+   else if (selected.is<barrier_id>()) {
+      return find_entity_index(world.barriers, selected.get<barrier_id>());
+   }
+   else if (selected.is<planning_hub_id>()) {
+      return find_entity_index(world.planning_hubs, selected.get<planning_hub_id>());
+   }
+   else if (selected.is<block_id>()) {
+      return find_block(world.blocks, selected.get<block_id>());
+   }
+
+   return std::nullopt;
+}
+
+auto ground_item(const ground_selection_item& item, const world& world,
+                 const object_class_library& object_classes,
+                 const blocks_custom_mesh_bvh_library& blocks_bvh_library,
+                 const active_layers active_layers) noexcept
+   -> std::optional<float3>
+{
+   const selected_entity& selected = item.entity;
+
+   if (selected.is<object_id>()) {
+      return ground_object(world.objects[item.index], world, object_classes,
+                           blocks_bvh_library, active_layers);
+   }
+   else if (selected.is<path_id_node_mask>()) {
+      return ground_point(world.paths[item.index].nodes[item.node_index].position, world,
+                          object_classes, blocks_bvh_library, active_layers);
+   }
+   else if (selected.is<light_id>()) {
+      return ground_light(world.lights[item.index], world, object_classes,
+                          blocks_bvh_library, active_layers);
+   }
+   else if (selected.is<region_id>()) {
+      return ground_region(world.regions[item.index], world, object_classes,
+                           blocks_bvh_library, active_layers);
+   }
+   else if (selected.is<sector_id>()) {
+      if (const std::optional<float> base =
+             ground_sector(world.sectors[item.index], world, object_classes,
+                           blocks_bvh_library, active_layers);
+          base) {
+         return float3{0.0f, *base, 0.0f};
+      }
+   }
+   else if (selected.is<portal_id>()) {
+      return ground_portal(world.portals[item.index], world, object_classes,
+                           blocks_bvh_library, active_layers);
+   }
+   else if (selected.is<hintnode_id>()) {
+      return ground_point(world.hintnodes[item.index].position, world, object_classes,
+                          blocks_bvh_library, active_layers);
+   }
+   else if (selected.is<barrier_id>()) {
+      return ground_point(world.barriers[item.index].position, world, object_classes,
+                          blocks_bvh_library, active_layers);
+   }
+   else if (selected.is<planning_hub_id>()) {
+      return ground_point(world.planning_hubs[item.index].position, world, object_classes,
+                          blocks_bvh_library, active_layers);
+   }
+   else if (selected.is<block_id>()) {
+      return ground_block(selected.get<block_id>(), item.index, world, object_classes,
+                          blocks_bvh_library, active_layers);
+   }
+
+   return std::nullopt;
+}
+
 }
 
 auto ground_object(const object& object, const world& world,
@@ -284,4 +408,75 @@ auto ground_point(const float3 point, const world& world,
    return std::nullopt;
 }
 
-}
\ No newline at end of file
+void ground_points(std::span<const float3> points,
+                   std::span<std::optional<float3>> out_positions, const world& world,
+                   const object_class_library& object_classes,
+                   const blocks_custom_mesh_bvh_library& blocks_bvh_library,
+                   const active_layers active_layers, async::thread_pool& thread_pool) noexcept
+{
+   assert(points.size() == out_positions.size());
+
+   thread_pool.for_each_n(async::task_priority::normal,
+                          std::min(points.size(), out_positions.size()),
+                          [&](const std::size_t i) noexcept {
+                             out_positions[i] = ground_point(points[i], world, object_classes,
+                                                             blocks_bvh_library, active_layers);
+                          });
+}
+
+auto ground_selection(std::span<const selected_entity> selection, const world& world,
+                      const object_class_library& object_classes,
+                      const blocks_custom_mesh_bvh_library& blocks_bvh_library,
+                      const active_layers active_layers,
+                      async::thread_pool& thread_pool) noexcept -> std::vector<grounded_entity>
+{
+   std::vector<ground_selection_item> items;
+   items.reserve(selection.size());
+
+   // Entities are looked up once here, grounding and the caller's edits then use their index.
+   for (const selected_entity& selected : selection) {
+      const std::optional<uint32> index = find_selected_index(selected, world);
+
+      if (not index) continue;
+
+      if (selected.is<path_id_node_mask>()) {
+         const auto& [id, node_mask] = selected.get<path_id_node_mask>();
+
+         const uint32 node_count =
+            static_cast<uint32>(std::min(world.paths[*index].nodes.size(), max_path_nodes));
+
+         for (uint32 node_index = 0; node_index < node_count; ++node_index) {
+            if (not node_mask[node_index]) continue;
+
+            items.push_back({.entity = make_path_id_node_mask(id, node_index),
+                             .index = *index,
+                             .node_index = node_index});
+         }
+      }
+      else {
+         items.push_back({.entity = selected, .index = *index});
+      }
+   }
+
+   std::vector<std::optional<float3>> positions(items.size());
+
+   thread_pool.for_each_n(async::task_priority::normal, items.size(),
+                          [&](const std::size_t i) noexcept {
+                             positions[i] = ground_item(items[i], world, object_classes,
+                                                        blocks_bvh_library, active_layers);
+                          });
+
+   std::vector<grounded_entity> grounded;
+   grounded.reserve(items.size());
+
+   for (std::size_t i = 0; i < items.size(); ++i) {
+      if (positions[i]) {
+         grounded.push_back(
+            {.entity = items[i].entity, .index = items[i].index, .position = *positions[i]});
+      }
+   }
+
+   return grounded;
+}
+
+}
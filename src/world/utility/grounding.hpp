@@ -1,10 +1,19 @@
 #pragma once
 
 #include "../active_elements.hpp"
+#include "../interaction_context.hpp"
 #include "../object_class_library.hpp"
 #include "../world.hpp"
 
 #include <optional>
+#include <span>
+#include <vector>
+
+namespace we::async {
+
+class thread_pool;
+
+}
 
 namespace we::world {
 
@@ -91,4 +100,44 @@ auto ground_point(const float3 point, const world& world,
                   const blocks_custom_mesh_bvh_library& blocks_bvh_library,
                   const active_layers active_layers) noexcept -> std::optional<float3>;
 
-}
\ No newline at end of file
+/// @brief Get the grounded positions of many points, spread over a thread_pool. Each result is the same as from ground_point.
+/// @param points The points to ground.
+/// @param out_positions Receives the grounded position of each point or nullopt. Must be the same size as points.
+/// @param world The world.
+/// @param object_classes The object classes to use.
+/// @param blocks_bvh_library The BVH library to use custom mesh blocks.
+/// @param active_layers The active layers to raycast against.
+/// @param thread_pool The thread_pool to ground the points on.
+void ground_points(std::span<const float3> points,
+                   std::span<std::optional<float3>> out_positions, const world& world,
+                   const object_class_library& object_classes,
+                   const blocks_custom_mesh_bvh_library& blocks_bvh_library,
+                   const active_layers active_layers, async::thread_pool& thread_pool) noexcept;
+
+/// @brief A selected entity that has been grounded by ground_selection.
+struct grounded_entity {
+   /// @brief The grounded entity. Path nodes are grounded individually, each with only its own node set in the mask.
+   selected_entity entity;
+   /// @brief The index of the entity in it's world container, valid until the world is next edited. For path nodes it is
+   /// the path's index and for blocks it is the index in the descriptions of the block's type.
+   uint32 index = 0;
+   /// @brief The grounded position of the entity. For sectors only y is used, it is the grounded base.
+   float3 position;
+};
+
+/// @brief Ground every entity in a selection, spread over a thread_pool. Each position is the same as from the entity's
+/// ground_* function.
+/// @param selection The selection to ground.
+/// @param world The world.
+/// @param object_classes The object classes to use.
+/// @param blocks_bvh_library The BVH library to use custom mesh blocks.
+/// @param active_layers The active layers to raycast against.
+/// @param thread_pool The thread_pool to ground the selection on.
+/// @return The entities that can be grounded and are not already, in selection order.
+auto ground_selection(std::span<const selected_entity> selection, const world& world,
+                      const object_class_library& object_classes,
+                      const blocks_custom_mesh_bvh_library& blocks_bvh_library,
+                      const active_layers active_layers,
+                      async::thread_pool& thread_pool) noexcept -> std::vector<grounded_entity>;
+
+}
@@ -13,25 +13,74 @@
 
 namespace we::world {
 
-auto raycast(const float3 ray_origin, const float3 ray_direction,
-             const active_layers active_layers, std::span<const object> objects,
-             const object_class_library& object_classes,
-             function_ptr<bool(const object&) noexcept> filter) noexcept
+namespace {
+
+/// @brief Find the closest entity a ray hits.
+/// @param index The index to find the entities to test with or nullptr to test every entity.
+/// @param raycast_entity Called as raycast_entity(entity, entity_index, min_distance).
+/// Returns the entity's hit if the ray hits it closer than min_distance.
+template<typename T, typename Raycast_entity>
+auto raycast_entities(const float3 ray_origin, const float3 ray_direction,
+                      std::span<const T> entities, const entity_spatial_index* index,
+                      const Raycast_entity& raycast_entity) noexcept
+   -> std::optional<raycast_result<T>>
+{
+   std::optional<raycast_result<T>> closest_hit;
+   float min_distance = std::numeric_limits<float>::max();
+
+   if (index) {
+      index->raycast<T>(ray_origin, ray_direction, min_distance,
+                        [&](const uint32 entity_index, float& max_distance) {
+                           if (entity_index >= entities.size()) return true;
+
+                           if (std::optional<raycast_result<T>> hit =
+                                  raycast_entity(entities[entity_index], entity_index,
+                                                 min_distance);
+                               hit) {
+                              closest_hit = hit;
+                              min_distance = hit->distance;
+                              max_distance = hit->distance;
+                           }
+
+                           return true;
+                        });
+   }
+   else {
+      for (std::size_t entity_index = 0; entity_index < entities.size(); ++entity_index) {
+         if (std::optional<raycast_result<T>> hit =
+                raycast_entity(entities[entity_index], static_cast<uint32>(entity_index),
+                               min_distance);
+             hit) {
+            closest_hit = hit;
+            min_distance = hit->distance;
+         }
+      }
+   }
+
+   return closest_hit;
+}
+
+auto raycast_objects(const float3 ray_origin, const float3 ray_direction,
+                     const active_layers active_layers, std::span<const object> objects,
+                     const object_class_library& object_classes,
+                     const entity_spatial_index* index,
+                     function_ptr<bool(const object&) noexcept> filter) noexcept
    -> std::optional<raycast_result<object>>
 {
    using namespace assets;
 
-   std::optional<object_id> hit;
-   uint32 hit_index = 0;
-   float min_distance = std::numeric_limits<float>::max();
-   float3 surface_normalWS;
+   const auto is_pickable = [&](const object& object) {
+      if (not active_layers[object.layer]) return false;
+      if (object.hidden) return false;
+      if (filter and not filter(object)) return false;
 
-   for (std::size_t object_index = 0; object_index < objects.size(); ++object_index) {
-      const object& object = objects[object_index];
+      return true;
+   };
 
-      if (not active_layers[object.layer]) continue;
-      if (object.hidden) continue;
-      if (filter and not filter(object)) continue;
+   const auto raycast_object = [&](const object& object, const uint32 object_index,
+                                   const float min_distance)
+      -> std::optional<raycast_result<we::world::object>> {
+      if (not is_pickable(object)) return std::nullopt;
 
       const object_class& object_class = object_classes[object.class_handle];
 
@@ -46,369 +95,558 @@ auto raycast(const float3 ray_origin, const float3 ray_direction,
          float3 ray_directionOS = normalize(object_from_world * ray_direction);
 
          if (float hit_distance = 0.0f;
-             intersect_aabb(ray_originOS, 1.0f / ray_directionOS, bbox,
-                            min_distance, hit_distance)) {
-            hit = object.id;
-            hit_index = static_cast<uint32>(object_index);
-            min_distance = hit_distance;
-            surface_normalWS =
-               normalize(y_flip(object.rotation) *
-                         (ray_originOS + ray_directionOS * hit_distance));
+             intersect_aabb(ray_originOS, 1.0f / ray_directionOS, bbox, min_distance,
+                            hit_distance)) {
+            return raycast_result<we::world::object>{
+               .distance = hit_distance,
+               .normalWS = normalize(y_flip(object.rotation) *
+                                     (ray_originOS + ray_directionOS * hit_distance)),
+               .id = object.id,
+               .index = object_index};
          }
+
+         return std::nullopt;
       }
-      else {
-         quaternion inverse_rotation = conjugate(object.rotation);
-         float3 inverse_position = inverse_rotation * -object.position;
 
-         float3 obj_ray_origin = inverse_rotation * ray_origin + inverse_position;
-         float3 obj_ray_direction = normalize(inverse_rotation * ray_direction);
+      quaternion inverse_rotation = conjugate(object.rotation);
+      float3 inverse_position = inverse_rotation * -object.position;
 
-         const msh::flat_model& model = *object_class.model;
+      float3 obj_ray_origin = inverse_rotation * ray_origin + inverse_position;
+      float3 obj_ray_direction = normalize(inverse_rotation * ray_direction);
 
-         float3 box_centre = (model.bounding_box.min + model.bounding_box.max) * 0.5f;
-         float3 box_size = (model.bounding_box.max - model.bounding_box.min) * 0.5f;
+      const msh::flat_model& model = *object_class.model;
 
-         const float box_intersection =
-            boxIntersection(obj_ray_origin - box_centre, obj_ray_direction, box_size);
+      float3 box_centre = (model.bounding_box.min + model.bounding_box.max) * 0.5f;
+      float3 box_size = (model.bounding_box.max - model.bounding_box.min) * 0.5f;
 
-         if (box_intersection < 0.0f) continue;
+      const float box_intersection =
+         boxIntersection(obj_ray_origin - box_centre, obj_ray_direction, box_size);
 
-         std::optional<msh::ray_hit> model_hit =
-            model.bvh.query(obj_ray_origin, obj_ray_direction);
+      if (box_intersection < 0.0f) return std::nullopt;
 
-         if (not model_hit) continue;
+      std::optional<msh::ray_hit> model_hit =
+         model.bvh.query(obj_ray_origin, obj_ray_direction);
 
-         if (model_hit->distance < min_distance) {
-            hit = object.id;
-            hit_index = static_cast<uint32>(object_index);
-            min_distance = model_hit->distance;
-            surface_normalWS =
-               normalize(object.rotation * model_hit->unnormalized_normal);
-         }
-      }
-   }
+      if (not model_hit) return std::nullopt;
 
-   if (not hit) return std::nullopt;
+      if (model_hit->distance >= min_distance) return std::nullopt;
 
-   return raycast_result<object>{.distance = min_distance,
-                                 .normalWS = surface_normalWS,
-                                 .id = *hit,
-                                 .index = hit_index};
-}
-
-auto raycast(const float3 ray_origin, const float3 ray_direction,
-             const active_layers active_layers, std::span<const light> lights,
-             const raycast_light_sizes& sizes,
-             function_ptr<bool(const light&) noexcept> filter) noexcept
-   -> std::optional<raycast_result<light>>
-{
-   std::optional<light_id> hit;
-   uint32 hit_index = 0;
-   float min_distance = std::numeric_limits<float>::max();
+      return raycast_result<we::world::object>{
+         .distance = model_hit->distance,
+         .normalWS = normalize(object.rotation * model_hit->unnormalized_normal),
+         .id = object.id,
+         .index = object_index};
+   };
 
-   for (std::size_t light_index = 0; light_index < lights.size(); ++light_index) {
-      const light& light = lights[light_index];
-
-      if (not active_layers[light.layer]) continue;
-      if (light.hidden) continue;
-      if (filter and not filter(light)) continue;
+   if (not index) {
+      return raycast_entities(ray_origin, ray_direction, objects, nullptr, raycast_object);
+   }
 
-      if (light.light_type == light_type::directional or
-          light.light_type == light_type::point or
-          light.light_type == light_type::spot) {
-         float proxy_radius = 0.0f;
+   // With an index billboard patches are tested against their bounds like above, but the meshes
+   // of every other object are traced through the index's top level BVH.
+   std::optional<raycast_result<object>> closest_hit;
+   float min_distance = std::numeric_limits<float>::max();
 
-         if (light.light_type == light_type::directional) {
-            proxy_radius = sizes.directional;
-         }
-         else if (light.light_type == light_type::point) {
-            proxy_radius = sizes.point;
-         }
-         else if (light.light_type == light_type::spot) {
-            proxy_radius = sizes.spot;
+   index->raycast_billboard_patches(
+      ray_origin, ray_direction, min_distance,
+      [&](const uint32 object_index, float& max_distance) {
+         if (object_index >= objects.size()) return true;
+
+         if (std::optional<raycast_result<object>> hit =
+                raycast_object(objects[object_index], object_index, min_distance);
+             hit) {
+            closest_hit = hit;
+            min_distance = hit->distance;
+            max_distance = hit->distance;
          }
 
-         const float intersection =
-            sphIntersect(ray_origin, ray_direction, light.position, proxy_radius);
+         return true;
+      });
+
+   if (const std::optional<entity_spatial_index::object_mesh_hit> hit =
+          index->raycast_object_meshes(ray_origin, ray_direction, min_distance,
+                                       [&](const uint32 object_index) noexcept {
+                                          return object_index < objects.size() and
+                                                 is_pickable(objects[object_index]);
+                                       });
+       hit) {
+      const object& object = objects[hit->object_index];
+
+      closest_hit = raycast_result<we::world::object>{
+         .distance = hit->distance,
+         .normalWS = normalize(hit->unnormalized_normalWS),
+         .id = object.id,
+         .index = hit->object_index};
+   }
 
-         if (intersection < 0.0f) continue;
+   return closest_hit;
+}
 
-         if (intersection < min_distance) {
-            hit = light.id;
-            hit_index = static_cast<uint32>(light_index);
-            min_distance = intersection;
+auto raycast_lights(const float3 ray_origin, const float3 ray_direction,
+                    const active_layers active_layers, std::span<const light> lights,
+                    const raycast_light_sizes& sizes, const entity_spatial_index* index,
+                    function_ptr<bool(const light&) noexcept> filter) noexcept
+   -> std::optional<raycast_result<light>>
+{
+   return raycast_entities(
+      ray_origin, ray_direction, lights, index,
+      [&](const light& light, const uint32 light_index,
+          const float min_distance) -> std::optional<raycast_result<we::world::light>> {
+         if (not active_layers[light.layer]) return std::nullopt;
+         if (light.hidden) return std::nullopt;
+         if (filter and not filter(light)) return std::nullopt;
+
+         float intersection = -1.0f;
+
+         if (light.light_type == light_type::directional or
+             light.light_type == light_type::point or
+             light.light_type == light_type::spot) {
+            float proxy_radius = 0.0f;
+
+            if (light.light_type == light_type::directional) {
+               proxy_radius = sizes.directional;
+            }
+            else if (light.light_type == light_type::point) {
+               proxy_radius = sizes.point;
+            }
+            else if (light.light_type == light_type::spot) {
+               proxy_radius = sizes.spot;
+            }
+
+            intersection =
+               sphIntersect(ray_origin, ray_direction, light.position, proxy_radius);
          }
-      }
-      else if (light.light_type == light_type::directional_region_box) {
-         quaternion inverse_rotation = conjugate(light.region_rotation);
-         float3 inverse_position = inverse_rotation * -light.position;
-
-         float3 box_ray_origin = inverse_rotation * ray_origin + inverse_position;
-         float3 box_ray_direction = normalize(inverse_rotation * ray_direction);
+         else if (light.light_type == light_type::directional_region_box) {
+            quaternion inverse_rotation = conjugate(light.region_rotation);
+            float3 inverse_position = inverse_rotation * -light.position;
 
-         const float intersection =
-            boxIntersection(box_ray_origin, box_ray_direction, light.region_size);
-
-         if (intersection < 0.0f) continue;
+            float3 box_ray_origin = inverse_rotation * ray_origin + inverse_position;
+            float3 box_ray_direction = normalize(inverse_rotation * ray_direction);
 
-         if (intersection < min_distance) {
-            hit = light.id;
-            hit_index = static_cast<uint32>(light_index);
-            min_distance = intersection;
+            intersection =
+               boxIntersection(box_ray_origin, box_ray_direction, light.region_size);
          }
-      }
-      else if (light.light_type == light_type::directional_region_sphere) {
-         const float intersection =
-            sphIntersect(ray_origin, ray_direction, light.position,
-                         length(light.region_size));
-
-         if (intersection < 0.0f) continue;
-
-         if (intersection < min_distance) {
-            hit = light.id;
-            hit_index = static_cast<uint32>(light_index);
-            min_distance = intersection;
+         else if (light.light_type == light_type::directional_region_sphere) {
+            intersection = sphIntersect(ray_origin, ray_direction, light.position,
+                                        length(light.region_size));
          }
-      }
-      else if (light.light_type == light_type::directional_region_cylinder) {
-         const float cylinder_radius =
-            length(float2{light.region_size.x, light.region_size.z});
-         const float3 region_direction =
-            normalize(light.region_rotation * float3{0.0f, 1.0f, 0.0f});
-
-         const float intersection =
-            iCylinder(ray_origin, ray_direction,
-                      light.position + region_direction * light.region_size.y,
-                      light.position + -region_direction * light.region_size.y,
-                      cylinder_radius)
-               .x;
-
-         if (intersection < 0.0f) continue;
-
-         if (intersection < min_distance) {
-            hit = light.id;
-            hit_index = static_cast<uint32>(light_index);
-            min_distance = intersection;
+         else if (light.light_type == light_type::directional_region_cylinder) {
+            const float cylinder_radius =
+               length(float2{light.region_size.x, light.region_size.z});
+            const float3 region_direction =
+               normalize(light.region_rotation * float3{0.0f, 1.0f, 0.0f});
+
+            intersection =
+               iCylinder(ray_origin, ray_direction,
+                         light.position + region_direction * light.region_size.y,
+                         light.position + -region_direction * light.region_size.y,
+                         cylinder_radius)
+                  .x;
          }
-      }
-   }
 
-   if (not hit) return std::nullopt;
+         if (intersection < 0.0f) return std::nullopt;
+         if (intersection >= min_distance) return std::nullopt;
 
-   return raycast_result<light>{.distance = min_distance, .id = *hit, .index = hit_index};
+         return raycast_result<we::world::light>{.distance = intersection,
+                                             .id = light.id,
+                                             .index = light_index};
+      });
 }
 
-auto raycast(const float3 ray_origin, const float3 ray_direction,
-             const active_layers active_layers, std::span<const path> paths,
-             const float node_size,
-             function_ptr<bool(const path&, uint32) noexcept> filter) noexcept
+auto raycast_paths(const float3 ray_origin, const float3 ray_direction,
+                   const active_layers active_layers, std::span<const path> paths,
+                   const float node_size, const entity_spatial_index* index,
+                   function_ptr<bool(const path&, uint32) noexcept> filter) noexcept
    -> std::optional<raycast_result<path>>
 {
-   std::optional<path_id> hit;
-   uint32 hit_index = 0;
-   uint32 hit_node = 0;
-   float min_distance = std::numeric_limits<float>::max();
+   return raycast_entities(
+      ray_origin, ray_direction, paths, index,
+      [&](const path& path, const uint32 path_index,
+          float min_distance) -> std::optional<raycast_result<we::world::path>> {
+         if (not active_layers[path.layer]) return std::nullopt;
+         if (path.hidden) return std::nullopt;
 
-   for (std::size_t path_index = 0; path_index < paths.size(); ++path_index) {
-      const path& path = paths[path_index];
+         std::optional<raycast_result<we::world::path>> hit;
 
-      if (not active_layers[path.layer]) continue;
-      if (path.hidden) continue;
+         for (uint32 i = 0; i < path.nodes.size(); ++i) {
+            if (filter and not filter(path, i)) continue;
 
-      for (uint32 i = 0; i < path.nodes.size(); ++i) {
-         if (filter and not filter(path, i)) continue;
+            const path::node& node = path.nodes[i];
 
-         const path::node& node = path.nodes[i];
+            const float intersection =
+               sphIntersect(ray_origin, ray_direction, node.position,
+                            0.707f * (node_size / 0.5f));
 
-         const float intersection =
-            sphIntersect(ray_origin, ray_direction, node.position,
-                         0.707f * (node_size / 0.5f));
-
-         if (intersection < 0.0f) continue;
+            if (intersection < 0.0f) continue;
 
-         if (intersection < min_distance) {
-            hit = path.id;
-            hit_index = static_cast<uint32>(path_index);
-            hit_node = i;
-            min_distance = intersection;
+            if (intersection < min_distance) {
+               hit = raycast_result<we::world::path>{.distance = intersection,
+                                                 .id = path.id,
+                                                 .index = path_index,
+                                                 .node_index = i};
+               min_distance = intersection;
+            }
          }
-      }
-   }
 
-   if (not hit) return std::nullopt;
-
-   return raycast_result<path>{.distance = min_distance,
-                               .id = *hit,
-                               .index = hit_index,
-                               .node_index = hit_node};
+         return hit;
+      });
 }
 
-auto raycast(const float3 ray_origin, const float3 ray_direction,
-             const active_layers active_layers, std::span<const region> regions,
-             function_ptr<bool(const region&) noexcept> filter) noexcept
+auto raycast_regions(const float3 ray_origin, const float3 ray_direction,
+                     const active_layers active_layers, std::span<const region> regions,
+                     const entity_spatial_index* index,
+                     function_ptr<bool(const region&) noexcept> filter) noexcept
    -> std::optional<raycast_result<region>>
 {
-   std::optional<region_id> hit;
-   uint32 hit_index = 0;
-   float min_distance = std::numeric_limits<float>::max();
+   return raycast_entities(
+      ray_origin, ray_direction, regions, index,
+      [&](const region& region, const uint32 region_index,
+          const float min_distance) -> std::optional<raycast_result<we::world::region>> {
+         if (not active_layers[region.layer]) return std::nullopt;
+         if (region.hidden) return std::nullopt;
+         if (filter and not filter(region)) return std::nullopt;
 
-   for (std::size_t region_index = 0; region_index < regions.size(); ++region_index) {
-      const region& region = regions[region_index];
+         float intersection = -1.0f;
 
-      if (not active_layers[region.layer]) continue;
-      if (region.hidden) continue;
-      if (filter and not filter(region)) continue;
+         if (region.shape == region_shape::box) {
+            quaternion inverse_rotation = conjugate(region.rotation);
+            float3 inverse_position = inverse_rotation * -region.position;
 
-      if (region.shape == region_shape::box) {
-         quaternion inverse_rotation = conjugate(region.rotation);
-         float3 inverse_position = inverse_rotation * -region.position;
+            float3 box_ray_origin = inverse_rotation * ray_origin + inverse_position;
+            float3 box_ray_direction = normalize(inverse_rotation * ray_direction);
 
-         float3 box_ray_origin = inverse_rotation * ray_origin + inverse_position;
-         float3 box_ray_direction = normalize(inverse_rotation * ray_direction);
+            intersection = boxIntersection(box_ray_origin, box_ray_direction, region.size);
+         }
+         else if (region.shape == region_shape::sphere) {
+            intersection = sphIntersect(ray_origin, ray_direction, region.position,
+                                        length(region.size));
+         }
+         else if (region.shape == region_shape::cylinder) {
+            const float cylinder_radius = length(float2{region.size.x, region.size.z});
+            const float3 region_direction =
+               normalize(region.rotation * float3{0.0f, 1.0f, 0.0f});
+
+            intersection = iCylinder(ray_origin, ray_direction,
+                                     region.position + region_direction * region.size.y,
+                                     region.position + -region_direction * region.size.y,
+                                     cylinder_radius)
+                              .x;
+         }
 
-         const float intersection =
-            boxIntersection(box_ray_origin, box_ray_direction, region.size);
+         if (intersection < 0.0f) return std::nullopt;
+         if (intersection >= min_distance) return std::nullopt;
 
-         if (intersection < 0.0f) continue;
+         return raycast_result<we::world::region>{.distance = intersection,
+                                              .id = region.id,
+                                              .index = region_index};
+      });
+}
 
-         if (intersection < min_distance) {
-            hit = region.id;
-            hit_index = static_cast<uint32>(region_index);
-            min_distance = intersection;
+auto raycast_sectors(const float3 ray_origin, const float3 ray_direction,
+                     std::span<const sector> sectors, const entity_spatial_index* index,
+                     function_ptr<bool(const sector&) noexcept> filter) noexcept
+   -> std::optional<raycast_result<sector>>
+{
+   return raycast_entities(
+      ray_origin, ray_direction, sectors, index,
+      [&](const sector& sector, const uint32 sector_index,
+          float min_distance) -> std::optional<raycast_result<we::world::sector>> {
+         if (sector.hidden) return std::nullopt;
+         if (filter and not filter(sector)) return std::nullopt;
+
+         std::optional<raycast_result<we::world::sector>> hit;
+
+         for (std::size_t i = 0; i < sector.points.size(); ++i) {
+            const float2 a = sector.points[i];
+            const float2 b = sector.points[(i + 1) % sector.points.size()];
+
+            const std::array quad = {float3{a.x, sector.base, a.y},
+                                     float3{b.x, sector.base, b.y},
+                                     float3{a.x, sector.base + sector.height, a.y},
+                                     float3{b.x, sector.base + sector.height, b.y}};
+
+            const float intersection = quadIntersect(ray_origin, ray_direction, quad[0],
+                                                     quad[1], quad[3], quad[2])
+                                          .x;
+
+            if (intersection < 0.0f) continue;
+
+            if (intersection < min_distance) {
+               hit = raycast_result<we::world::sector>{
+                  .distance = intersection,
+                  .normalWS = normalize(cross(quad[1] - quad[0], quad[2] - quad[0])),
+                  .id = sector.id,
+                  .index = sector_index};
+               min_distance = intersection;
+            }
          }
-      }
-      else if (region.shape == region_shape::sphere) {
-         const float intersection =
-            sphIntersect(ray_origin, ray_direction, region.position,
-                         length(region.size));
 
-         if (intersection < 0.0f) continue;
+         return hit;
+      });
+}
 
-         if (intersection < min_distance) {
-            hit = region.id;
-            hit_index = static_cast<uint32>(region_index);
-            min_distance = intersection;
+auto raycast_portals(const float3 ray_origin, const float3 ray_direction,
+                     std::span<const portal> portals, const entity_spatial_index* index,
+                     function_ptr<bool(const portal&) noexcept> filter) noexcept
+   -> std::optional<raycast_result<portal>>
+{
+   return raycast_entities(
+      ray_origin, ray_direction, portals, index,
+      [&](const portal& portal, const uint32 portal_index,
+          const float min_distance) -> std::optional<raycast_result<we::world::portal>> {
+         if (portal.hidden) return std::nullopt;
+         if (filter and not filter(portal)) return std::nullopt;
+
+         const float half_width = portal.width * 0.5f;
+         const float half_height = portal.height * 0.5f;
+
+         std::array quad = {float3{-half_width, -half_height, 0.0f},
+                            float3{half_width, -half_height, 0.0f},
+                            float3{-half_width, half_height, 0.0f},
+                            float3{half_width, half_height, 0.0f}};
+
+         for (auto& v : quad) {
+            v = portal.rotation * v;
+            v += portal.position;
          }
-      }
-      else if (region.shape == region_shape::cylinder) {
-         const float cylinder_radius = length(float2{region.size.x, region.size.z});
-         const float3 region_direction =
-            normalize(region.rotation * float3{0.0f, 1.0f, 0.0f});
 
-         const float intersection =
-            iCylinder(ray_origin, ray_direction,
-                      region.position + region_direction * region.size.y,
-                      region.position + -region_direction * region.size.y,
-                      cylinder_radius)
-               .x;
+         const float intersection = quadIntersect(ray_origin, ray_direction, quad[0],
+                                                  quad[1], quad[3], quad[2])
+                                       .x;
 
-         if (intersection < 0.0f) continue;
+         if (intersection < 0.0f) return std::nullopt;
+         if (intersection >= min_distance) return std::nullopt;
 
-         if (intersection < min_distance) {
-            hit = region.id;
-            hit_index = static_cast<uint32>(region_index);
-            min_distance = intersection;
-         }
-      }
-   }
+         return raycast_result<we::world::portal>{.distance = intersection,
+                                              .id = portal.id,
+                                              .index = portal_index};
+      });
+}
 
-   if (not hit) return std::nullopt;
+auto raycast_hintnodes(const float3 ray_origin, const float3 ray_direction,
+                       const active_layers active_layers,
+                       std::span<const hintnode> hintnodes,
+                       const entity_spatial_index* index,
+                       function_ptr<bool(const hintnode&) noexcept> filter) noexcept
+   -> std::optional<raycast_result<hintnode>>
+{
+   return raycast_entities(
+      ray_origin, ray_direction, hintnodes, index,
+      [&](const hintnode& hintnode, const uint32 hintnode_index,
+          float min_distance) -> std::optional<raycast_result<we::world::hintnode>> {
+         if (not active_layers[hintnode.layer]) return std::nullopt;
+         if (hintnode.hidden) return std::nullopt;
+         if (filter and not filter(hintnode)) return std::nullopt;
+
+         const float bounding_intersection =
+            sphIntersect(ray_origin, ray_direction, hintnode.position, 2.0f);
+
+         if (bounding_intersection < 0.0f) return std::nullopt;
+
+         constexpr static std::array<float3, 8> hexahedron_vertices{
+            {{0.000000f, 1.000000f, 1.000000f},
+             {-0.866025f, 1.000000f, -0.500000f},
+             {0.866025f, 1.000000f, -0.500000f},
+             {0.000000f, 2.000000f, 0.000000f},
+             {0.000000f, 1.000000f, 1.000000f},
+             {0.866025f, 1.000000f, -0.500000f},
+             {-0.866026f, 1.000000f, -0.500000f},
+             {0.000000f, 0.000000f, -0.000000f}}};
+
+         constexpr static std::array<std::array<uint16, 3>, 6> hexahedron_indices{
+            {{0, 3, 1}, {1, 3, 2}, {2, 3, 0}, {4, 7, 5}, {5, 7, 6}, {6, 7, 4}}};
+
+         quaternion inverse_rotation = conjugate(hintnode.rotation);
+         float3 inverse_position = inverse_rotation * -hintnode.position;
+
+         const float3 node_ray_origin = inverse_rotation * ray_origin + inverse_position;
+         const float3 node_ray_direction = normalize(inverse_rotation * ray_direction);
+
+         std::optional<raycast_result<we::world::hintnode>> hit;
+
+         for (const auto& [i0, i1, i2] : hexahedron_indices) {
+            const float intersection =
+               triIntersect(node_ray_origin, node_ray_direction, hexahedron_vertices[i0],
+                            hexahedron_vertices[i1], hexahedron_vertices[i2])
+                  .x;
+
+            if (intersection < 0.0f) continue;
+
+            if (intersection < min_distance) {
+               hit = raycast_result<we::world::hintnode>{.distance = intersection,
+                                                     .id = hintnode.id,
+                                                     .index = hintnode_index};
+               min_distance = intersection;
+            }
+         }
 
-   return raycast_result<region>{.distance = min_distance, .id = *hit, .index = hit_index};
+         return hit;
+      });
 }
 
-auto raycast(const float3 ray_origin, const float3 ray_direction,
-             std::span<const sector> sectors,
-             function_ptr<bool(const sector&) noexcept> filter) noexcept
-   -> std::optional<raycast_result<sector>>
+auto raycast_barriers(const float3 ray_origin, const float3 ray_direction,
+                      std::span<const barrier> barriers, const float barrier_height,
+                      const entity_spatial_index* index,
+                      function_ptr<bool(const barrier&) noexcept> filter) noexcept
+   -> std::optional<raycast_result<barrier>>
 {
-   std::optional<sector_id> hit;
-   uint32 hit_index = 0;
-   float min_distance = std::numeric_limits<float>::max();
-   float3 normalWS;
+   return raycast_entities(
+      ray_origin, ray_direction, barriers, index,
+      [&](const barrier& barrier, const uint32 barrier_index,
+          const float min_distance) -> std::optional<raycast_result<we::world::barrier>> {
+         if (barrier.hidden) return std::nullopt;
+         if (filter and not filter(barrier)) return std::nullopt;
+
+         float4x4 world_to_box = transpose(
+            make_rotation_matrix_from_euler({0.0f, barrier.rotation_angle, 0.0f}));
+         world_to_box[3] = {world_to_box * -barrier.position, 1.0f};
 
-   for (std::size_t sector_index = 0; sector_index < sectors.size(); ++sector_index) {
-      const sector& sector = sectors[sector_index];
+         float3 box_ray_origin = world_to_box * ray_origin;
+         float3 box_ray_direction = normalize(float3x3{world_to_box} * ray_direction);
 
-      if (sector.hidden) continue;
-      if (filter and not filter(sector)) continue;
+         const float intersection =
+            boxIntersection(box_ray_origin, box_ray_direction,
+                            {barrier.size.x, barrier_height, barrier.size.y});
 
-      for (std::size_t i = 0; i < sector.points.size(); ++i) {
-         const float2 a = sector.points[i];
-         const float2 b = sector.points[(i + 1) % sector.points.size()];
+         if (intersection < 0.0f) return std::nullopt;
+         if (intersection >= min_distance) return std::nullopt;
 
-         const std::array quad = {float3{a.x, sector.base, a.y},
-                                  float3{b.x, sector.base, b.y},
-                                  float3{a.x, sector.base + sector.height, a.y},
-                                  float3{b.x, sector.base + sector.height, b.y}};
+         return raycast_result<we::world::barrier>{.distance = intersection,
+                                               .id = barrier.id,
+                                               .index = barrier_index};
+      });
+}
 
-         const float intersection = quadIntersect(ray_origin, ray_direction,
-                                                  quad[0], quad[1], quad[3], quad[2])
+auto raycast_hubs(const float3 ray_origin, const float3 ray_direction,
+                  std::span<const planning_hub> hubs, const float hub_height,
+                  const entity_spatial_index* index,
+                  function_ptr<bool(const planning_hub&) noexcept> filter) noexcept
+   -> std::optional<raycast_result<planning_hub>>
+{
+   return raycast_entities(
+      ray_origin, ray_direction, hubs, index,
+      [&](const planning_hub& hub, const uint32 hub_index,
+          const float min_distance) -> std::optional<raycast_result<planning_hub>> {
+         if (hub.hidden) return std::nullopt;
+         if (filter and not filter(hub)) return std::nullopt;
+
+         const float3 top_position = hub.position + float3{0.0f, hub_height, 0.0f};
+         const float3 bottom_position = hub.position + float3{0.0f, -hub_height, 0.0f};
+
+         const float intersection = iCylinder(ray_origin, ray_direction, top_position,
+                                              bottom_position, hub.radius)
                                        .x;
 
-         if (intersection < 0.0f) continue;
+         if (intersection < 0.0f) return std::nullopt;
+         if (intersection >= min_distance) return std::nullopt;
 
-         if (intersection < min_distance) {
-            hit = sector.id;
-            hit_index = static_cast<uint32>(sector_index);
-            min_distance = intersection;
-            normalWS = normalize(cross(quad[1] - quad[0], quad[2] - quad[0]));
+         return raycast_result<planning_hub>{.distance = intersection,
+                                             .id = hub.id,
+                                             .index = hub_index};
+      });
+}
+
+auto raycast_boundaries(const float3 ray_origin, const float3 ray_direction,
+                        std::span<const boundary> boundaries, const float boundary_height,
+                        const entity_spatial_index* index,
+                        function_ptr<bool(const boundary&) noexcept> filter) noexcept
+   -> std::optional<raycast_result<boundary>>
+{
+   return raycast_entities(
+      ray_origin, ray_direction, boundaries, index,
+      [&](const boundary& boundary, const uint32 boundary_index,
+          float min_distance) -> std::optional<raycast_result<we::world::boundary>> {
+         if (boundary.hidden) return std::nullopt;
+         if (filter and not filter(boundary)) return std::nullopt;
+
+         const std::span<const float3> nodes = boundary.points;
+
+         std::optional<raycast_result<we::world::boundary>> hit;
+
+         for (std::size_t i = 0; i < nodes.size(); ++i) {
+            const float3 a = nodes[i];
+            const float3 b = nodes[(i + 1) % nodes.size()];
+
+            const std::array quad = {
+               float3{a.x, a.y - boundary_height, a.z},
+               float3{a.x, a.y + boundary_height, a.z},
+               float3{b.x, b.y + boundary_height, b.z},
+               float3{b.x, b.y - boundary_height, b.z},
+            };
+
+            const float intersection = quadIntersect(ray_origin, ray_direction, quad[0],
+                                                     quad[1], quad[2], quad[3])
+                                          .x;
+
+            if (intersection < 0.0f) continue;
+
+            if (intersection < min_distance) {
+               hit = raycast_result<we::world::boundary>{.distance = intersection,
+                                                     .id = boundary.id,
+                                                     .index = boundary_index};
+               min_distance = intersection;
+            }
          }
-      }
-   }
 
-   if (not hit) return std::nullopt;
+         return hit;
+      });
+}
 
-   return raycast_result<sector>{.distance = min_distance,
-                                 .normalWS = normalWS,
-                                 .id = *hit,
-                                 .index = hit_index};
 }
 
 auto raycast(const float3 ray_origin, const float3 ray_direction,
-             std::span<const portal> portals,
-             function_ptr<bool(const portal&) noexcept> filter) noexcept
-   -> std::optional<raycast_result<portal>>
+             const active_layers active_layers, std::span<const object> objects,
+             const object_class_library& object_classes,
+             function_ptr<bool(const object&) noexcept> filter) noexcept
+   -> std::optional<raycast_result<object>>
 {
-   std::optional<portal_id> hit;
-   uint32 hit_index = 0;
-   float min_distance = std::numeric_limits<float>::max();
-
-   for (std::size_t portal_index = 0; portal_index < portals.size(); ++portal_index) {
-      const portal& portal = portals[portal_index];
-
-      if (portal.hidden) continue;
-      if (filter and not filter(portal)) continue;
-
-      const float half_width = portal.width * 0.5f;
-      const float half_height = portal.height * 0.5f;
-
-      std::array quad = {float3{-half_width, -half_height, 0.0f},
-                         float3{half_width, -half_height, 0.0f},
-                         float3{-half_width, half_height, 0.0f},
-                         float3{half_width, half_height, 0.0f}};
-
-      for (auto& v : quad) {
-         v = portal.rotation * v;
-         v += portal.position;
-      }
+   return raycast_objects(ray_origin, ray_direction, active_layers, objects, object_classes,
+                          nullptr, filter);
+}
 
-      const float intersection = quadIntersect(ray_origin, ray_direction,
-                                               quad[0], quad[1], quad[3], quad[2])
-                                    .x;
+auto raycast(const float3 ray_origin, const float3 ray_direction,
+             const active_layers active_layers, std::span<const light> lights,
+             const raycast_light_sizes& sizes,
+             function_ptr<bool(const light&) noexcept> filter) noexcept
+   -> std::optional<raycast_result<light>>
+{
+   return raycast_lights(ray_origin, ray_direction, active_layers, lights, sizes, nullptr,
+                         filter);
+}
 
-      if (intersection < 0.0f) continue;
+auto raycast(const float3 ray_origin, const float3 ray_direction,
+             const active_layers active_layers, std::span<const path> paths,
+             const float node_size,
+             function_ptr<bool(const path&, uint32) noexcept> filter) noexcept
+   -> std::optional<raycast_result<path>>
+{
+   return raycast_paths(ray_origin, ray_direction, active_layers, paths, node_size, nullptr,
+                        filter);
+}
 
-      if (intersection < min_distance) {
-         hit = portal.id;
-         hit_index = static_cast<uint32>(portal_index);
-         min_distance = intersection;
-      }
-   }
+auto raycast(const float3 ray_origin, const float3 ray_direction,
+             const active_layers active_layers, std::span<const region> regions,
+             function_ptr<bool(const region&) noexcept> filter) noexcept
+   -> std::optional<raycast_result<region>>
+{
+   return raycast_regions(ray_origin, ray_direction, active_layers, regions, nullptr,
+                          filter);
+}
 
-   if (not hit) return std::nullopt;
+auto raycast(const float3 ray_origin, const float3 ray_direction,
+             std::span<const sector> sectors,
+             function_ptr<bool(const sector&) noexcept> filter) noexcept
+   -> std::optional<raycast_result<sector>>
+{
+   return raycast_sectors(ray_origin, ray_direction, sectors, nullptr, filter);
+}
 
-   return raycast_result<portal>{.distance = min_distance, .id = *hit, .index = hit_index};
+auto raycast(const float3 ray_origin, const float3 ray_direction,
+             std::span<const portal> portals,
+             function_ptr<bool(const portal&) noexcept> filter) noexcept
+   -> std::optional<raycast_result<portal>>
+{
+   return raycast_portals(ray_origin, ray_direction, portals, nullptr, filter);
 }
 
 auto raycast(const float3 ray_origin, const float3 ray_direction,
@@ -416,61 +654,8 @@ auto raycast(const float3 ray_origin, const float3 ray_direction,
              function_ptr<bool(const hintnode&) noexcept> filter) noexcept
    -> std::optional<raycast_result<hintnode>>
 {
-   std::optional<hintnode_id> hit;
-   uint32 hit_index = 0;
-   float min_distance = std::numeric_limits<float>::max();
-
-   for (std::size_t hintnode_index = 0; hintnode_index < hintnodes.size();
-        ++hintnode_index) {
-      const hintnode& hintnode = hintnodes[hintnode_index];
-
-      if (not active_layers[hintnode.layer]) continue;
-      if (hintnode.hidden) continue;
-      if (filter and not filter(hintnode)) continue;
-
-      const float bounding_intersection =
-         sphIntersect(ray_origin, ray_direction, hintnode.position, 2.0f);
-
-      if (bounding_intersection < 0.0f) continue;
-
-      constexpr static std::array<float3, 8> hexahedron_vertices{
-         {{0.000000f, 1.000000f, 1.000000f},
-          {-0.866025f, 1.000000f, -0.500000f},
-          {0.866025f, 1.000000f, -0.500000f},
-          {0.000000f, 2.000000f, 0.000000f},
-          {0.000000f, 1.000000f, 1.000000f},
-          {0.866025f, 1.000000f, -0.500000f},
-          {-0.866026f, 1.000000f, -0.500000f},
-          {0.000000f, 0.000000f, -0.000000f}}};
-
-      constexpr static std::array<std::array<uint16, 3>, 6> hexahedron_indices{
-         {{0, 3, 1}, {1, 3, 2}, {2, 3, 0}, {4, 7, 5}, {5, 7, 6}, {6, 7, 4}}};
-
-      quaternion inverse_rotation = conjugate(hintnode.rotation);
-      float3 inverse_position = inverse_rotation * -hintnode.position;
-
-      const float3 node_ray_origin = inverse_rotation * ray_origin + inverse_position;
-      const float3 node_ray_direction = normalize(inverse_rotation * ray_direction);
-
-      for (const auto& [i0, i1, i2] : hexahedron_indices) {
-         const float intersection =
-            triIntersect(node_ray_origin, node_ray_direction, hexahedron_vertices[i0],
-                         hexahedron_vertices[i1], hexahedron_vertices[i2])
-               .x;
-
-         if (intersection < 0.0f) continue;
-
-         if (intersection < min_distance) {
-            hit = hintnode.id;
-            hit_index = static_cast<uint32>(hintnode_index);
-            min_distance = intersection;
-         }
-      }
-   }
-
-   if (not hit) return std::nullopt;
-
-   return raycast_result<hintnode>{.distance = min_distance, .id = *hit, .index = hit_index};
+   return raycast_hintnodes(ray_origin, ray_direction, active_layers, hintnodes, nullptr,
+                            filter);
 }
 
 auto raycast(const float3 ray_origin, const float3 ray_direction,
@@ -478,39 +663,8 @@ auto raycast(const float3 ray_origin, const float3 ray_direction,
              function_ptr<bool(const barrier&) noexcept> filter) noexcept
    -> std::optional<raycast_result<barrier>>
 {
-   std::optional<barrier_id> hit;
-   uint32 hit_index = 0;
-   float min_distance = std::numeric_limits<float>::max();
-
-   for (std::size_t barrier_index = 0; barrier_index < barriers.size(); ++barrier_index) {
-      const barrier& barrier = barriers[barrier_index];
-
-      if (barrier.hidden) continue;
-      if (filter and not filter(barrier)) continue;
-
-      float4x4 world_to_box = transpose(
-         make_rotation_matrix_from_euler({0.0f, barrier.rotation_angle, 0.0f}));
-      world_to_box[3] = {world_to_box * -barrier.position, 1.0f};
-
-      float3 box_ray_origin = world_to_box * ray_origin;
-      float3 box_ray_direction = normalize(float3x3{world_to_box} * ray_direction);
-
-      const float intersection =
-         boxIntersection(box_ray_origin, box_ray_direction,
-                         {barrier.size.x, barrier_height, barrier.size.y});
-
-      if (intersection < 0.0f) continue;
-
-      if (intersection < min_distance) {
-         hit = barrier.id;
-         hit_index = static_cast<uint32>(barrier_index);
-         min_distance = intersection;
-      }
-   }
-
-   if (not hit) return std::nullopt;
-
-   return raycast_result<barrier>{.distance = min_distance, .id = *hit, .index = hit_index};
+   return raycast_barriers(ray_origin, ray_direction, barriers, barrier_height, nullptr,
+                           filter);
 }
 
 auto raycast(const float3 ray_origin, const float3 ray_direction,
@@ -518,37 +672,7 @@ auto raycast(const float3 ray_origin, const float3 ray_direction,
              function_ptr<bool(const planning_hub&) noexcept> filter) noexcept
    -> std::optional<raycast_result<planning_hub>>
 {
-   std::optional<planning_hub_id> hit;
-   uint32 hit_index = 0;
-   float min_distance = std::numeric_limits<float>::max();
-
-   for (std::size_t hub_index = 0; hub_index < hubs.size(); ++hub_index) {
-      const planning_hub& hub = hubs[hub_index];
-
-      if (hub.hidden) continue;
-      if (filter and not filter(hub)) continue;
-
-      const float3 top_position = hub.position + float3{0.0f, hub_height, 0.0f};
-      const float3 bottom_position = hub.position + float3{0.0f, -hub_height, 0.0f};
-
-      const float intersection = iCylinder(ray_origin, ray_direction, top_position,
-                                           bottom_position, hub.radius)
-                                    .x;
-
-      if (intersection < 0.0f) continue;
-
-      if (intersection < min_distance) {
-         hit = hub.id;
-         hit_index = static_cast<uint32>(hub_index);
-         min_distance = intersection;
-      }
-   }
-
-   if (not hit) return std::nullopt;
-
-   return raycast_result<planning_hub>{.distance = min_distance,
-                                       .id = *hit,
-                                       .index = hit_index};
+   return raycast_hubs(ray_origin, ray_direction, hubs, hub_height, nullptr, filter);
 }
 
 auto raycast(const float3 ray_origin, const float3 ray_direction,
@@ -661,46 +785,107 @@ auto raycast(const float3 ray_origin, const float3 ray_direction,
              function_ptr<bool(const boundary&) noexcept> filter) noexcept
    -> std::optional<raycast_result<boundary>>
 {
-   std::optional<boundary_id> hit;
-   uint32 hit_index = 0;
-   float min_distance = std::numeric_limits<float>::max();
+   return raycast_boundaries(ray_origin, ray_direction, boundaries, boundary_height, nullptr,
+                             filter);
+}
+
+auto raycast(const float3 ray_origin, const float3 ray_direction,
+             const active_layers active_layers, std::span<const object> objects,
+             const object_class_library& object_classes,
+             const entity_spatial_index& index,
+             function_ptr<bool(const object&) noexcept> filter) noexcept
+   -> std::optional<raycast_result<object>>
+{
+   return raycast_objects(ray_origin, ray_direction, active_layers, objects, object_classes,
+                          &index, filter);
+}
 
-   for (std::size_t boundary_index = 0; boundary_index < boundaries.size();
-        ++boundary_index) {
-      const boundary& boundary = boundaries[boundary_index];
+auto raycast(const float3 ray_origin, const float3 ray_direction,
+             const active_layers active_layers, std::span<const light> lights,
+             const raycast_light_sizes& sizes,
+             const entity_spatial_index& index,
+             function_ptr<bool(const light&) noexcept> filter) noexcept
+   -> std::optional<raycast_result<light>>
+{
+   return raycast_lights(ray_origin, ray_direction, active_layers, lights, sizes, &index,
+                         filter);
+}
 
-      if (boundary.hidden) continue;
-      if (filter and not filter(boundary)) continue;
+auto raycast(const float3 ray_origin, const float3 ray_direction,
+             const active_layers active_layers, std::span<const path> paths,
+             const float node_size,
+             const entity_spatial_index& index,
+             function_ptr<bool(const path&, uint32) noexcept> filter) noexcept
+   -> std::optional<raycast_result<path>>
+{
+   return raycast_paths(ray_origin, ray_direction, active_layers, paths, node_size, &index,
+                        filter);
+}
 
-      const std::span<const float3> nodes = boundary.points;
+auto raycast(const float3 ray_origin, const float3 ray_direction,
+             const active_layers active_layers, std::span<const region> regions,
+             const entity_spatial_index& index,
+             function_ptr<bool(const region&) noexcept> filter) noexcept
+   -> std::optional<raycast_result<region>>
+{
+   return raycast_regions(ray_origin, ray_direction, active_layers, regions, &index, filter);
+}
 
-      for (std::size_t i = 0; i < nodes.size(); ++i) {
-         const float3 a = nodes[i];
-         const float3 b = nodes[(i + 1) % nodes.size()];
+auto raycast(const float3 ray_origin, const float3 ray_direction,
+             std::span<const sector> sectors,
+             const entity_spatial_index& index,
+             function_ptr<bool(const sector&) noexcept> filter) noexcept
+   -> std::optional<raycast_result<sector>>
+{
+   return raycast_sectors(ray_origin, ray_direction, sectors, &index, filter);
+}
 
-         const std::array quad = {
-            float3{a.x, a.y - boundary_height, a.z},
-            float3{a.x, a.y + boundary_height, a.z},
-            float3{b.x, b.y + boundary_height, b.z},
-            float3{b.x, b.y - boundary_height, b.z},
-         };
+auto raycast(const float3 ray_origin, const float3 ray_direction,
+             std::span<const portal> portals,
+             const entity_spatial_index& index,
+             function_ptr<bool(const portal&) noexcept> filter) noexcept
+   -> std::optional<raycast_result<portal>>
+{
+   return raycast_portals(ray_origin, ray_direction, portals, &index, filter);
+}
 
-         const float intersection = quadIntersect(ray_origin, ray_direction,
-                                                  quad[0], quad[1], quad[2], quad[3])
-                                       .x;
+auto raycast(const float3 ray_origin, const float3 ray_direction,
+             const active_layers active_layers, std::span<const hintnode> hintnodes,
+             const entity_spatial_index& index,
+             function_ptr<bool(const hintnode&) noexcept> filter) noexcept
+   -> std::optional<raycast_result<hintnode>>
+{
+   return raycast_hintnodes(ray_origin, ray_direction, active_layers, hintnodes, &index,
+                            filter);
+}
 
-         if (intersection < 0.0f) continue;
+auto raycast(const float3 ray_origin, const float3 ray_direction,
+             std::span<const barrier> barriers, const float barrier_height,
+             const entity_spatial_index& index,
+             function_ptr<bool(const barrier&) noexcept> filter) noexcept
+   -> std::optional<raycast_result<barrier>>
+{
+   return raycast_barriers(ray_origin, ray_direction, barriers, barrier_height, &index,
+                           filter);
+}
 
-         if (intersection < min_distance) {
-            hit = boundary.id;
-            hit_index = static_cast<uint32>(boundary_index);
-            min_distance = intersection;
-         }
-      }
-   }
+auto raycast(const float3 ray_origin, const float3 ray_direction,
+             std::span<const planning_hub> hubs, const float hub_height,
+             const entity_spatial_index& index,
+             function_ptr<bool(const planning_hub&) noexcept> filter) noexcept
+   -> std::optional<raycast_result<planning_hub>>
+{
+   return raycast_hubs(ray_origin, ray_direction, hubs, hub_height, &index, filter);
+}
 
-   if (not hit) return std::nullopt;
+auto raycast(const float3 ray_origin, const float3 ray_direction,
+             std::span<const boundary> boundaries, const float boundary_height,
+             const entity_spatial_index& index,
+             function_ptr<bool(const boundary&) noexcept> filter) noexcept
+   -> std::optional<raycast_result<boundary>>
+{
+   return raycast_boundaries(ray_origin, ray_direction, boundaries, boundary_height, &index,
+                             filter);
+}
 
-   return raycast_result<boundary>{.distance = min_distance, .id = *hit, .index = hit_index};
 }
-}
\ No newline at end of file
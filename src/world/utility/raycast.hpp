@@ -3,6 +3,7 @@
 #include "../active_elements.hpp"
 #include "../object_class_library.hpp"
 #include "../world.hpp"
+#include "entity_spatial_index.hpp"
 #include "utility/function_ptr.hpp"
 
 #include <optional>
@@ -106,4 +107,66 @@ auto raycast(const float3 ray_origin, const float3 ray_direction,
              function_ptr<bool(const boundary&) noexcept> filter = nullptr) noexcept
    -> std::optional<raycast_result<boundary>>;
 
+// The overloads below find the entities to test with an entity_spatial_index instead of testing
+// every entity. The index must be up to date with the entities passed in and its config must
+// cover the sizes passed in.
+
+auto raycast(const float3 ray_origin, const float3 ray_direction,
+             const active_layers active_layers, std::span<const object> objects,
+             const object_class_library& object_classes, const entity_spatial_index& index,
+             function_ptr<bool(const object&) noexcept> filter = nullptr) noexcept
+   -> std::optional<raycast_result<object>>;
+
+auto raycast(const float3 ray_origin, const float3 ray_direction,
+             const active_layers active_layers, std::span<const light> lights,
+             const raycast_light_sizes& sizes, const entity_spatial_index& index,
+             function_ptr<bool(const light&) noexcept> filter = nullptr) noexcept
+   -> std::optional<raycast_result<light>>;
+
+auto raycast(const float3 ray_origin, const float3 ray_direction,
+             const active_layers active_layers, std::span<const path> paths,
+             const float node_size, const entity_spatial_index& index,
+             function_ptr<bool(const path&, uint32) noexcept> filter = nullptr) noexcept
+   -> std::optional<raycast_result<path>>;
+
+auto raycast(const float3 ray_origin, const float3 ray_direction,
+             const active_layers active_layers, std::span<const region> regions,
+             const entity_spatial_index& index,
+             function_ptr<bool(const region&) noexcept> filter = nullptr) noexcept
+   -> std::optional<raycast_result<region>>;
+
+auto raycast(const float3 ray_origin, const float3 ray_direction,
+             std::span<const sector> sectors, const entity_spatial_index& index,
+             function_ptr<bool(const sector&) noexcept> filter = nullptr) noexcept
+   -> std::optional<raycast_result<sector>>;
+
+auto raycast(const float3 ray_origin, const float3 ray_direction,
+             std::span<const portal> portals, const entity_spatial_index& index,
+             function_ptr<bool(const portal&) noexcept> filter = nullptr) noexcept
+   -> std::optional<raycast_result<portal>>;
+
+auto raycast(const float3 ray_origin, const float3 ray_direction,
+             const active_layers active_layers, std::span<const hintnode> hintnodes,
+             const entity_spatial_index& index,
+             function_ptr<bool(const hintnode&) noexcept> filter = nullptr) noexcept
+   -> std::optional<raycast_result<hintnode>>;
+
+auto raycast(const float3 ray_origin, const float3 ray_direction,
+             std::span<const barrier> barriers, const float barrier_height,
+             const entity_spatial_index& index,
+             function_ptr<bool(const barrier&) noexcept> filter = nullptr) noexcept
+   -> std::optional<raycast_result<barrier>>;
+
+auto raycast(const float3 ray_origin, const float3 ray_direction,
+             std::span<const planning_hub> hubs, const float hub_height,
+             const entity_spatial_index& index,
+             function_ptr<bool(const planning_hub&) noexcept> filter = nullptr) noexcept
+   -> std::optional<raycast_result<planning_hub>>;
+
+auto raycast(const float3 ray_origin, const float3 ray_direction,
+             std::span<const boundary> boundaries, const float boundary_height,
+             const entity_spatial_index& index,
+             function_ptr<bool(const boundary&) noexcept> filter = nullptr) noexcept
+   -> std::optional<raycast_result<boundary>>;
+
 }
\ No newline at end of file
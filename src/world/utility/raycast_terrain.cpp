@@ -1,10 +1,14 @@
 #include "raycast_terrain.hpp"
+#include "terrain_height_pyramid.hpp"
+
 #include "math/iq_intersectors.hpp"
 #include "math/vector_funcs.hpp"
 
 #include <algorithm>
 #include <array>
 #include <cmath>
+#include <limits>
+#include <optional>
 #include <utility>
 
 namespace we::world {
@@ -88,10 +92,130 @@ auto make_ray_start(const float3 ray_origin, const float3 ray_direction,
 
    return ray_origin;
 }
+
+/// @brief A cell of a terrain_height_pyramid the ray's march can step through without testing
+/// any quads.
+struct skip_cell {
+   int32 shift = 0;
+   int32 x = 0;
+   int32 y = 0;
+   /// @brief The most steps that can be skipped, the ray is only known to miss the quads tested
+   /// in this many steps.
+   int32 max_steps = 0;
+
+   bool contains(const float2 point, const terrain& terrain) const noexcept
+   {
+      const int32 terrain_half_length = terrain.length / 2;
+
+      const int32 height_x = std::clamp(static_cast<int32>(std::round(point.x)) +
+                                           terrain_half_length,
+                                        0, terrain.length - 1);
+      const int32 height_y = std::clamp(static_cast<int32>(std::round(point.y)) +
+                                           terrain_half_length,
+                                        0, terrain.length - 1);
+
+      return (height_x >> shift) == x and (height_y >> shift) == y;
+   }
+};
+
+/// @brief Find the largest cell around the march's current point that the ray passes
+/// entirely above or below.
+///
+/// Each level's cells contain the cells of the level below and the ray is tested over at least
+/// as many steps, so once the ray overlaps a cell's heights it overlaps those of every level
+/// above it and the search can stop.
+///
+/// The quads tested at a step have their heights within 2 of the step's rounded point, so each
+/// cell is tested along with the cells around it. Those quads are within 2 grid units of the
+/// step's point along the march's major axis, which moves one grid unit per step, so the ray's
+/// height is taken over a few more steps than will be skipped.
+auto find_skip_cell(const float2 point, const float2 increment, const float steps_left,
+                    const float ray_start_height, const float step, const float height_per_step,
+                    const terrain& terrain,
+                    const terrain_height_pyramid& height_pyramid) noexcept
+   -> std::optional<skip_cell>
+{
+   const int32 terrain_half_length = terrain.length / 2;
+
+   const int32 height_x =
+      std::clamp(static_cast<int32>(std::round(point.x)) + terrain_half_length, 0,
+                 terrain.length - 1);
+   const int32 height_y =
+      std::clamp(static_cast<int32>(std::round(point.y)) + terrain_half_length, 0,
+                 terrain.length - 1);
+
+   const auto steps_to_exit = [&](const float position, const float position_increment,
+                                  const int32 cell, const int32 shift,
+                                  const int32 level_length) {
+      const float cell_begin =
+         cell == 0 ? -std::numeric_limits<float>::infinity()
+                   : static_cast<float>((cell << shift) - terrain_half_length) - 0.5f;
+      const float cell_end =
+         cell == level_length - 1
+            ? std::numeric_limits<float>::infinity()
+            : static_cast<float>(((cell + 1) << shift) - terrain_half_length) - 0.5f;
+
+      if (position_increment > 0.0f) return (cell_end - position) / position_increment;
+      if (position_increment < 0.0f) return (position - cell_begin) / -position_increment;
+
+      return std::numeric_limits<float>::infinity();
+   };
+
+   std::optional<skip_cell> skip;
+
+   for (int32 level = 0; level < height_pyramid.level_count(); ++level) {
+      const int32 shift = level + 1;
+      const int32 level_length = height_pyramid.level_length(level);
+      const int32 cell_x = height_x >> shift;
+      const int32 cell_y = height_y >> shift;
+
+      const float exit_steps =
+         std::min({steps_to_exit(point.x, increment.x, cell_x, shift, level_length),
+                   steps_to_exit(point.y, increment.y, cell_y, shift, level_length),
+                   steps_left});
+
+      // Skipping a single step is no cheaper than testing it.
+      if (exit_steps < 2.0f) continue;
+
+      const int32 max_steps = static_cast<int32>(std::ceil(exit_steps)) + 1;
+
+      int16 min_height = INT16_MAX;
+      int16 max_height = INT16_MIN;
+
+      for (int32 y = cell_y - 1; y <= cell_y + 1; ++y) {
+         for (int32 x = cell_x - 1; x <= cell_x + 1; ++x) {
+            const terrain_height_pyramid::height_range range =
+               height_pyramid.cell_range(level, x, y);
+
+            min_height = std::min(min_height, range.min);
+            max_height = std::max(max_height, range.max);
+         }
+      }
+
+      const float first_height = ray_start_height + height_per_step * (step - 3.0f);
+      const float last_height =
+         ray_start_height + height_per_step * (step + static_cast<float>(max_steps) + 3.0f);
+
+      const float ray_min_height = std::min(first_height, last_height);
+      const float ray_max_height = std::max(first_height, last_height);
+
+      const float terrain_min_height = std::min(min_height * terrain.height_scale,
+                                                max_height * terrain.height_scale);
+      const float terrain_max_height = std::max(min_height * terrain.height_scale,
+                                                max_height * terrain.height_scale);
+
+      if (ray_min_height <= terrain_max_height and ray_max_height >= terrain_min_height) {
+         break;
+      }
+
+      skip = skip_cell{.shift = shift, .x = cell_x, .y = cell_y, .max_steps = max_steps};
+   }
+
+   return skip;
 }
 
-auto raycast(const float3 ray_origin, const float3 ray_direction,
-             const terrain& terrain) noexcept -> std::optional<float>
+auto raycast_impl(const float3 ray_origin, const float3 ray_direction, const terrain& terrain,
+                  const terrain_height_pyramid* height_pyramid) noexcept -> std::optional<float>
 {
    if (not terrain.active_flags.terrain) return std::nullopt;
 
@@ -123,12 +247,51 @@ auto raycast(const float3 ray_origin, const float3 ray_direction,
 
    const float terrain_bounds = (terrain.length / 2.0f);
 
+   if (height_pyramid and height_pyramid->terrain_length() != terrain.length) {
+      height_pyramid = nullptr;
+   }
+
+   const float height_per_step =
+      ray_direction.y * terrain.grid_scale /
+      std::max(std::abs(ray_direction.x), std::abs(ray_direction.z));
+
+   // When a ray is close to the terrain looking for a cell to skip each step costs more than
+   // it saves, so back off from looking after each step where no cell was found.
+   float next_skip_search_step = 0.0f;
+   float skip_search_backoff = 1.0f;
+
    for (float step = 0.0f; step < step_count; ++step) {
       if (point.x > terrain_bounds or point.x < -terrain_bounds or
           point.y > terrain_bounds or point.y < -terrain_bounds) {
          return std::nullopt;
       }
 
+      if (height_pyramid and step >= next_skip_search_step) {
+         const std::optional<skip_cell> skip =
+            find_skip_cell(point, increment, step_count - step, ray_start.y, step,
+                           height_per_step, terrain, *height_pyramid);
+
+         if (not skip) {
+            next_skip_search_step = step + skip_search_backoff;
+            skip_search_backoff = std::min(skip_search_backoff * 2.0f, 16.0f);
+         }
+         else {
+            skip_search_backoff = 1.0f;
+
+            // Step the same way as below so the steps after the cell match an unskipped march.
+            for (int32 i = 1; i < skip->max_steps and step + 1.0f < step_count and
+                              skip->contains(point + increment, terrain);
+                 ++i) {
+               point += increment;
+               step += 1.0f;
+            }
+
+            point += increment;
+
+            continue;
+         }
+      }
+
       const float2 rounded_point = round(point);
 
       if (const float intersection =
@@ -161,4 +324,18 @@ auto raycast(const float3 ray_origin, const float3 ray_direction,
    return std::nullopt;
 }
 
-}
\ No newline at end of file
+}
+
+auto raycast(const float3 ray_origin, const float3 ray_direction,
+             const terrain& terrain) noexcept -> std::optional<float>
+{
+   return raycast_impl(ray_origin, ray_direction, terrain, nullptr);
+}
+
+auto raycast(const float3 ray_origin, const float3 ray_direction, const terrain& terrain,
+             const terrain_height_pyramid& height_pyramid) noexcept -> std::optional<float>
+{
+   return raycast_impl(ray_origin, ray_direction, terrain, &height_pyramid);
+}
+
+}
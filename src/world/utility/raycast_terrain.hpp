@@ -7,7 +7,20 @@
 
 namespace we::world {
 
+struct terrain_height_pyramid;
+
 auto raycast(const float3 ray_origin, const float3 ray_direction,
              const terrain& terrain) noexcept -> std::optional<float>;
 
+/// @brief Raycast against the terrain, using a height pyramid to skip over the parts of the
+/// terrain the ray passes above or below. Returns the same hit as raycast without a pyramid.
+/// @param ray_origin The origin of the ray.
+/// @param ray_direction The direction of the ray.
+/// @param terrain The terrain.
+/// @param height_pyramid The height pyramid for the terrain. If it is out of date with the
+/// terrain's length it is ignored.
+/// @return The distance to the hit.
+auto raycast(const float3 ray_origin, const float3 ray_direction, const terrain& terrain,
+             const terrain_height_pyramid& height_pyramid) noexcept -> std::optional<float>;
+
 }
@@ -0,0 +1,128 @@
+#include "terrain_height_pyramid.hpp"
+
+#include <algorithm>
+
+namespace we::world {
+
+void terrain_height_pyramid::update(const terrain& terrain) noexcept
+{
+   const uint32 terrain_length = static_cast<uint32>(terrain.length);
+
+   if (_terrain_length != terrain.length or _levels.empty()) {
+      _levels.clear();
+      _terrain_length = terrain.length;
+
+      for (int32 length = (terrain.length + 1) / 2; length >= 1; length = (length + 1) / 2) {
+         _levels.push_back(
+            {.length = length,
+             .ranges = std::vector<height_range>(static_cast<std::size_t>(length) * length)});
+
+         if (length == 1) break;
+      }
+
+      for (int32 level_index = 0; level_index < level_count(); ++level_index) {
+         update_level(level_index, {0, 0, terrain_length, terrain_length}, terrain);
+      }
+
+      return;
+   }
+
+   for (const dirty_rect& dirty : terrain.height_map_dirty) {
+      const dirty_rect clamped{.left = std::min(dirty.left, terrain_length),
+                               .top = std::min(dirty.top, terrain_length),
+                               .right = std::min(dirty.right, terrain_length),
+                               .bottom = std::min(dirty.bottom, terrain_length)};
+
+      for (int32 level_index = 0; level_index < level_count(); ++level_index) {
+         update_level(level_index, clamped, terrain);
+      }
+   }
+}
+
+void terrain_height_pyramid::clear() noexcept
+{
+   _levels.clear();
+   _terrain_length = 0;
+}
+
+auto terrain_height_pyramid::terrain_length() const noexcept -> int32
+{
+   return _terrain_length;
+}
+
+auto terrain_height_pyramid::level_count() const noexcept -> int32
+{
+   return static_cast<int32>(_levels.size());
+}
+
+auto terrain_height_pyramid::level_length(const int32 level) const noexcept -> int32
+{
+   return _levels[level].length;
+}
+
+auto terrain_height_pyramid::cell_range(const int32 level, const int32 x,
+                                        const int32 y) const noexcept -> height_range
+{
+   const terrain_height_pyramid::level& pyramid_level = _levels[level];
+
+   const int32 clamped_x = std::clamp(x, 0, pyramid_level.length - 1);
+   const int32 clamped_y = std::clamp(y, 0, pyramid_level.length - 1);
+
+   return pyramid_level.ranges[clamped_y * pyramid_level.length + clamped_x];
+}
+
+/// @brief Recalculate the cells of a level that cover a rect of the height map. Level 0 is
+/// made from the height map and every other level from the level before it.
+void terrain_height_pyramid::update_level(const int32 level_index, const dirty_rect& rect,
+                                          const terrain& terrain) noexcept
+{
+   level& level = _levels[level_index];
+
+   const int32 shift = level_index + 1;
+   const int32 cell_size = 1 << shift;
+
+   const int32 begin_x = static_cast<int32>(rect.left) >> shift;
+   const int32 begin_y = static_cast<int32>(rect.top) >> shift;
+   const int32 end_x = std::min((static_cast<int32>(rect.right) + cell_size - 1) >> shift,
+                                level.length);
+   const int32 end_y = std::min((static_cast<int32>(rect.bottom) + cell_size - 1) >> shift,
+                                level.length);
+
+   for (int32 y = begin_y; y < end_y; ++y) {
+      for (int32 x = begin_x; x < end_x; ++x) {
+         height_range range{.min = INT16_MAX, .max = INT16_MIN};
+
+         if (level_index == 0) {
+            for (int32 height_y = y * 2; height_y < std::min(y * 2 + 2, terrain.length);
+                 ++height_y) {
+               for (int32 height_x = x * 2; height_x < std::min(x * 2 + 2, terrain.length);
+                    ++height_x) {
+                  const int16 height = terrain.height_map[{height_x, height_y}];
+
+                  range.min = std::min(range.min, height);
+                  range.max = std::max(range.max, height);
+               }
+            }
+         }
+         else {
+            const terrain_height_pyramid::level& child_level = _levels[level_index - 1];
+
+            for (int32 child_y = y * 2; child_y < std::min(y * 2 + 2, child_level.length);
+                 ++child_y) {
+               for (int32 child_x = x * 2; child_x < std::min(x * 2 + 2, child_level.length);
+                    ++child_x) {
+                  const height_range child_range =
+                     child_level.ranges[child_y * child_level.length + child_x];
+
+                  range.min = std::min(range.min, child_range.min);
+                  range.max = std::max(range.max, child_range.max);
+               }
+            }
+         }
+
+         level.ranges[y * level.length + x] = range;
+      }
+   }
+}
+
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "../terrain.hpp"
+#include "types.hpp"
+
+#include <vector>
+
+namespace we::world {
+
+/// @brief The min and max heights of square cells of a terrain's height map. Each level halves
+/// the resolution of the one before it, level 0's cells cover 2x2 heights. Used to skip over
+/// the parts of the terrain a ray can't touch.
+struct terrain_height_pyramid {
+   struct height_range {
+      int16 min = 0;
+      int16 max = 0;
+   };
+
+   /// @brief Update the pyramid from the terrain's height_map_dirty rects. The pyramid is
+   /// rebuilt if the terrain's length has changed. The dirty rects mustn't have been cleared
+   /// since the last call to update.
+   /// @param terrain The terrain.
+   void update(const terrain& terrain) noexcept;
+
+   /// @brief Remove all levels from the pyramid.
+   void clear() noexcept;
+
+   /// @brief Get the length of the terrain the pyramid was last updated from.
+   [[nodiscard]] auto terrain_length() const noexcept -> int32;
+
+   /// @brief Get the number of levels in the pyramid.
+   [[nodiscard]] auto level_count() const noexcept -> int32;
+
+   /// @brief Get the number of cells along each side of a level.
+   [[nodiscard]] auto level_length(const int32 level) const noexcept -> int32;
+
+   /// @brief Get the height range of a cell. The cell's coordinates are clamped to the level.
+   [[nodiscard]] auto cell_range(const int32 level, const int32 x, const int32 y) const noexcept
+      -> height_range;
+
+private:
+   struct level {
+      int32 length = 0;
+      std::vector<height_range> ranges;
+   };
+
+   void update_level(const int32 level_index, const dirty_rect& rect,
+                     const terrain& terrain) noexcept;
+
+   int32 _terrain_length = 0;
+   std::vector<level> _levels;
+};
+
+}
@@ -12,7 +12,8 @@
 #include "assets/msh/flat_model.hpp"
 
 #include "async/thread_pool.hpp"
-#include "async/wait_all.hpp"
+#include "async/then.hpp"
+#include "async/when_all.hpp"
 
 #include "math/bvh.hpp"
 #include "math/intersectors.hpp"
@@ -26,6 +27,7 @@
 #include <algorithm>
 #include <bit>
 #include <new>
+#include <stop_token>
 
 namespace we::world {
 
@@ -443,7 +445,7 @@ struct scene {
          _bvh_instances.push_back(top_level_bvh::instance{.bvh = &bvh});
       }
 
-      _bvh = top_level_bvh{_bvh_instances};
+      _bvh = top_level_bvh{_bvh_instances, thread_pool, async::task_priority::low};
    }
 
    bool raycast_shadow(const float3& ray_directionWS, const float3& ray_originWS) const noexcept
@@ -454,6 +456,13 @@ struct scene {
          .has_value();
    }
 
+   void raycast_shadow_batch(std::span<const bvh::ray> raysWS,
+                             std::span<std::optional<float>> out_hits) const noexcept
+   {
+      _bvh.raycast_batch(raysWS, out_hits,
+                         {.allow_backface_cull = false, .accept_first_hit = true});
+   }
+
    auto raycast(const float3& ray_directionWS, const float3& ray_originWS,
                 float max_distance) const noexcept -> std::optional<float>
    {
@@ -772,12 +781,19 @@ struct detail::terrain_light_map_baker_impl {
 
       _height_map = world.terrain.height_map;
 
-      _task = thread_pool.exec(async::task_priority::low, [this, &thread_pool] {
-         prepare_bake(thread_pool);
-         start_bake(thread_pool);
-      });
+      prepare_bake(thread_pool);
+   }
+
+   /// @brief Abandoning a bake stops it at the next triangle instead of waiting for it to run to completion.
+   ~terrain_light_map_baker_impl()
+   {
+      _stop_source.request_stop();
    }
 
+   terrain_light_map_baker_impl(const terrain_light_map_baker_impl&) = delete;
+   auto operator=(const terrain_light_map_baker_impl&)
+      -> terrain_light_map_baker_impl& = delete;
+
    bool ready() const noexcept
    {
       return _task.ready();
@@ -851,31 +867,20 @@ private:
    // Prepared on the main thread and then moved into and used by _scene in the background.
    scene_input _scene_input;
 
+   // Declared before the tasks so it outlives them.
+   std::stop_source _stop_source;
+
+   // Kept so that destroying the baker cancels or waits on every task in the graph, tasks are
+   // destroyed in reverse order so the continuations are cancelled before their antecedents.
+   async::task<void> _build_samples_task;
+   async::task<void> _build_terrain_data_task;
+   async::task<void> _build_scene_task;
    async::task<void> _task;
 
+   /// @brief Schedule the preparation tasks with the bake itself continuing on from them, no thread waits on the preparation.
    void prepare_bake(async::thread_pool& thread_pool) noexcept
    {
-      async::task<void> build_terrain_data_task =
-         thread_pool.exec(async::task_priority::low, [this] {
-            const terrain_view terrain{.length = _terrain_length,
-                                       .grid_scale = _terrain_grid_scale,
-                                       .height_scale = _terrain_height_scale,
-                                       .height_map = _height_map};
-
-            _normal_map = build_normal_map(terrain);
-            _bake_triangles = build_triangles(terrain, _normal_map);
-
-            _bake_triangle_sample_storage.resize(_bake_triangles.size() *
-                                                 _triangle_sample_coords.size());
-
-            for (std::size_t i = 0; i < _bake_triangles.size(); ++i) {
-               _bake_triangles[i].samples =
-                  std::span{_bake_triangle_sample_storage}
-                     .subspan(i * _triangle_sample_coords.size(),
-                              _triangle_sample_coords.size());
-            }
-         });
-      async::task<void> build_samples_task =
+      _build_samples_task =
          thread_pool.exec(async::task_priority::low, [this] {
             _triangle_sample_coords.resize(_config.triangle_samples);
 
@@ -904,16 +909,45 @@ private:
             }
          });
 
-      _scene = {std::move(_scene_input), thread_pool};
+      // The triangles are sized by the sample count so they're built after the samples.
+      _build_terrain_data_task =
+         async::then(thread_pool, async::task_priority::low,
+                     async::when_all(_build_samples_task), [this] {
+            const terrain_view terrain{.length = _terrain_length,
+                                       .grid_scale = _terrain_grid_scale,
+                                       .height_scale = _terrain_height_scale,
+                                       .height_map = _height_map};
+
+            _normal_map = build_normal_map(terrain);
+            _bake_triangles = build_triangles(terrain, _normal_map);
+
+            _bake_triangle_sample_storage.resize(_bake_triangles.size() *
+                                                 _triangle_sample_coords.size());
 
-      build_terrain_data_task.wait();
-      build_samples_task.wait();
+            for (std::size_t i = 0; i < _bake_triangles.size(); ++i) {
+               _bake_triangles[i].samples =
+                  std::span{_bake_triangle_sample_storage}
+                     .subspan(i * _triangle_sample_coords.size(),
+                              _triangle_sample_coords.size());
+            }
+         });
 
-      wait_all(build_terrain_data_task, build_samples_task);
+      _build_scene_task =
+         thread_pool.exec(async::task_priority::low, [this, &thread_pool] {
+            _scene = {std::move(_scene_input), thread_pool};
+         });
+
+      _task = async::then(thread_pool, async::task_priority::low,
+                          async::when_all(_build_terrain_data_task, _build_scene_task),
+                          [this, &thread_pool] { start_bake(thread_pool); });
    }
 
    void start_bake(async::thread_pool& thread_pool) noexcept
    {
+      const std::stop_token stop_token = _stop_source.get_token();
+
+      if (stop_token.stop_requested()) return;
+
       std::vector<async::task<void>> tasks;
       tasks.reserve(thread_pool.thread_count(async::task_priority::low) - 1);
 
@@ -930,7 +964,8 @@ private:
                if (my_z >= _terrain_length_quads) return;
 
                bake_row(std::span{_bake_triangles}.subspan(my_z * _terrain_length_tris,
-                                                           _terrain_length_tris));
+                                                           _terrain_length_tris),
+                        stop_token);
             }
          }));
       }
@@ -941,11 +976,14 @@ private:
          if (my_z >= _terrain_length_quads) break;
 
          bake_row(std::span{_bake_triangles}.subspan(my_z * _terrain_length_tris,
-                                                     _terrain_length_tris));
+                                                     _terrain_length_tris),
+                  stop_token);
       }
 
       tasks.clear();
 
+      if (stop_token.stop_requested()) return;
+
       _status.store(terrain_light_map_baker_status::filtering, std::memory_order_relaxed);
 
       _light_map = pack_light_map(build_filtered_light_map(_terrain_length,
@@ -969,7 +1007,8 @@ private:
 
                   bake_row_dynamic(
                      std::span{_bake_triangles}.subspan(my_z * _terrain_length_tris,
-                                                        _terrain_length_tris));
+                                                        _terrain_length_tris),
+                     stop_token);
                }
             }));
          }
@@ -981,11 +1020,14 @@ private:
 
             bake_row_dynamic(
                std::span{_bake_triangles}.subspan(my_z * _terrain_length_tris,
-                                                  _terrain_length_tris));
+                                                  _terrain_length_tris),
+               stop_token);
          }
 
          tasks.clear();
 
+         if (stop_token.stop_requested()) return;
+
          _status.store(terrain_light_map_baker_status::filtering_ps2,
                        std::memory_order_relaxed);
 
@@ -996,9 +1038,17 @@ private:
       }
    }
 
-   void bake_row(std::span<bake_triangle> row) noexcept
+   void bake_row(std::span<bake_triangle> row, const std::stop_token& stop_token) noexcept
    {
+      std::vector<bvh::ray> ao_raysWS;
+      std::vector<std::optional<float>> ao_hits;
+
+      ao_raysWS.resize(_ao_sample_count);
+      ao_hits.resize(_ao_sample_count);
+
       for (bake_triangle& tri : row) {
+         if (stop_token.stop_requested()) return;
+
          assert(tri.samples.size() == _triangle_sample_coords.size());
 
          for (int32 sample_index = 0;
@@ -1027,10 +1077,14 @@ private:
                      world_from_basis *
                      _ao_sample_directions[_ao_sample_count * sample_index + i];
 
-                  if (_scene.raycast_shadow(positionWS + directionWS * 0.001f,
-                                            directionWS)) {
-                     ambient_visibility -= 1.0f;
-                  }
+                  ao_raysWS[i] = {.origin = positionWS + directionWS * 0.001f,
+                                  .direction = directionWS};
+               }
+
+               _scene.raycast_shadow_batch(ao_raysWS, ao_hits);
+
+               for (const std::optional<float>& hit : ao_hits) {
+                  if (hit) ambient_visibility -= 1.0f;
                }
 
                ambient_visibility *= _inv_ao_sample_count_flt;
@@ -1117,9 +1171,12 @@ private:
       }
    }
 
-   void bake_row_dynamic(std::span<bake_triangle> row) noexcept
+   void bake_row_dynamic(std::span<bake_triangle> row,
+                         const std::stop_token& stop_token) noexcept
    {
       for (bake_triangle& tri : row) {
+         if (stop_token.stop_requested()) return;
+
          assert(tri.samples.size() == _triangle_sample_coords.size());
 
          for (int32 sample_index = 0;
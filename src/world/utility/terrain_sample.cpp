@@ -3,7 +3,10 @@
 #include "math/iq_intersectors.hpp"
 #include "math/vector_funcs.hpp"
 
+#include "async/thread_pool.hpp"
+
 #include <algorithm>
+#include <cassert>
 
 namespace we::world {
 
@@ -66,4 +69,18 @@ auto sample_terrain_normal(const terrain& terrain, const float3& positionWS) noe
    }
 }
 
-}
\ No newline at end of file
+void sample_terrain_normals(const terrain& terrain, std::span<const float3> positionsWS,
+                            std::span<float3> out_normalsWS,
+                            async::thread_pool& thread_pool) noexcept
+{
+   assert(positionsWS.size() == out_normalsWS.size());
+
+   // Each sample is only a few loads and a triangle test, so hand them out in large batches.
+   thread_pool.for_each_n(async::task_priority::normal,
+                          std::min(positionsWS.size(), out_normalsWS.size()),
+                          {.grain_size = 1024}, [&](const std::size_t i) noexcept {
+                             out_normalsWS[i] = sample_terrain_normal(terrain, positionsWS[i]);
+                          });
+}
+
+}
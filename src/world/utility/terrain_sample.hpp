@@ -2,9 +2,27 @@
 
 #include "../terrain.hpp"
 
+#include <span>
+
+namespace we::async {
+
+class thread_pool;
+
+}
+
 namespace we::world {
 
 auto sample_terrain_normal(const terrain& terrain, const float3& positionWS) noexcept
    -> float3;
 
+/// @brief Sample the terrain's normal at many positions, spread over a thread_pool. Each normal is the same as from
+/// sample_terrain_normal.
+/// @param terrain The terrain.
+/// @param positionsWS The world space positions to sample the terrain at.
+/// @param out_normalsWS Receives the normal at each position. Must be the same size as positionsWS.
+/// @param thread_pool The thread_pool to sample the terrain on.
+void sample_terrain_normals(const terrain& terrain, std::span<const float3> positionsWS,
+                            std::span<float3> out_normalsWS,
+                            async::thread_pool& thread_pool) noexcept;
+
 }
@@ -340,6 +340,144 @@ auto create_unique_light_region_name(const std::span<const light> lights,
    return fmt::format("{}{}", base_name, max_index + 1);
 }
 
+template<typename T>
+void unique_name_registry::add_entities(const std::span<const T> entities) noexcept
+{
+   _names.reserve(entities.size());
+
+   for (const T& entity : entities) add(entity.name);
+}
+
+unique_name_registry::unique_name_registry(const std::span<const object> entities) noexcept
+   : _missing_name_base{missing_name_base<object>()}
+{
+   add_entities(entities);
+}
+
+unique_name_registry::unique_name_registry(const std::span<const light> entities) noexcept
+   : _missing_name_base{missing_name_base<light>()}
+{
+   add_entities(entities);
+}
+
+unique_name_registry::unique_name_registry(const std::span<const path> entities) noexcept
+   : _missing_name_base{missing_name_base<path>()}
+{
+   add_entities(entities);
+}
+
+unique_name_registry::unique_name_registry(const std::span<const sector> entities) noexcept
+   : _missing_name_base{missing_name_base<sector>()}
+{
+   add_entities(entities);
+}
+
+unique_name_registry::unique_name_registry(const std::span<const portal> entities) noexcept
+   : _missing_name_base{missing_name_base<portal>()}
+{
+   add_entities(entities);
+}
+
+unique_name_registry::unique_name_registry(const std::span<const hintnode> entities) noexcept
+   : _missing_name_base{missing_name_base<hintnode>()}
+{
+   add_entities(entities);
+}
+
+unique_name_registry::unique_name_registry(const std::span<const barrier> entities) noexcept
+   : _missing_name_base{missing_name_base<barrier>()}
+{
+   add_entities(entities);
+}
+
+unique_name_registry::unique_name_registry(
+   const std::span<const planning_hub> entities) noexcept
+   : _missing_name_base{missing_name_base<planning_hub>()}
+{
+   add_entities(entities);
+}
+
+unique_name_registry::unique_name_registry(
+   const std::span<const planning_connection> entities) noexcept
+   : _missing_name_base{missing_name_base<planning_connection>()}
+{
+   add_entities(entities);
+}
+
+unique_name_registry::unique_name_registry(const std::span<const boundary> entities) noexcept
+   : _missing_name_base{missing_name_base<boundary>()}
+{
+   add_entities(entities);
+}
+
+unique_name_registry::unique_name_registry(const std::span<const animation> entities) noexcept
+   : _missing_name_base{missing_name_base<animation>()}
+{
+   add_entities(entities);
+}
+
+unique_name_registry::unique_name_registry(
+   const std::span<const animation_group> entities) noexcept
+   : _missing_name_base{missing_name_base<animation_group>()}
+{
+   add_entities(entities);
+}
+
+auto unique_name_registry::create_unique_name(const std::string_view reference_name) noexcept
+   -> std::string
+{
+   if (reference_name.empty()) return "";
+
+   if (not contains(reference_name)) {
+      add(reference_name);
+
+      return std::string{reference_name};
+   }
+
+   std::string_view base_name = string::trim_trailing_digits(reference_name);
+
+   if (base_name.empty()) base_name = _missing_name_base;
+
+   uint64 max_index = 0;
+
+   if (auto it = _max_indices.find(base_name); it != _max_indices.end()) {
+      max_index = it->second;
+   }
+
+   std::string name = fmt::format("{}{}", base_name, max_index + 1);
+
+   add(name);
+
+   return name;
+}
+
+/// @brief Base names never end in a digit so each name only counts towards one base name, the
+/// name with its trailing digits removed.
+void unique_name_registry::add(const std::string_view name) noexcept
+{
+   _names.emplace(name);
+
+   const std::string_view base_name = string::trim_trailing_digits(name);
+   const std::string_view name_index = name.substr(base_name.size());
+
+   if (name_index.empty()) return;
+
+   uint64 index = 0;
+
+   if (std::from_chars_result result =
+          std::from_chars(name_index.data(), name_index.data() + name_index.size(), index);
+       result.ec == std::errc{} and result.ptr == name_index.data() + name_index.size()) {
+      uint64& max_index = _max_indices.try_emplace(base_name, 0).first->second;
+
+      max_index = std::max(max_index, index);
+   }
+}
+
+bool unique_name_registry::contains(const std::string_view name) const noexcept
+{
+   return _names.contains(name);
+}
+
 bool is_directional_light(const light& light) noexcept
 {
    switch (light.light_type) {
@@ -1,12 +1,16 @@
 #pragma once
 
 #include "../world.hpp"
+#include "entity_name_index.hpp"
 #include "utility/string_icompare.hpp"
 
 #include <span>
 #include <string>
 #include <string_view>
 
+#include <absl/container/flat_hash_map.h>
+#include <absl/container/flat_hash_set.h>
+
 namespace we::world {
 
 template<typename Type>
@@ -62,6 +66,9 @@ inline auto find_entity(world& world, const id<std::type_identity_t<Type>> id)
    return find_entity(select_entities<Type>(world), id);
 }
 
+// Finding an entity by name is a linear scan. Entities are renamed through plain set_value edits
+// on their names, so there is no edit to keep a name index of the world in sync from. The loader
+// indexes the names itself with entity_name_index before anything can edit them.
 template<typename Type>
 inline auto find_entity(const pinned_vector<Type>& entities,
                         const std::string_view name) -> const Type*
@@ -160,6 +167,60 @@ auto create_unique_light_region_name(const std::span<const light> lights,
                                      const std::string_view reference_name,
                                      light_id ignored_id = max_id) -> std::string;
 
+/// @brief Tracks the names used by a list of entities and the largest number suffix used with
+/// each base name. Makes the same names as create_unique_name without scanning the entities,
+/// for naming many new entities at once (pasting an entity group for instance).
+///
+/// Names made by the registry are added to it. It is not updated when the entities change.
+struct unique_name_registry {
+   explicit unique_name_registry(const std::span<const object> entities) noexcept;
+
+   explicit unique_name_registry(const std::span<const light> entities) noexcept;
+
+   explicit unique_name_registry(const std::span<const path> entities) noexcept;
+
+   explicit unique_name_registry(const std::span<const sector> entities) noexcept;
+
+   explicit unique_name_registry(const std::span<const portal> entities) noexcept;
+
+   explicit unique_name_registry(const std::span<const hintnode> entities) noexcept;
+
+   explicit unique_name_registry(const std::span<const barrier> entities) noexcept;
+
+   explicit unique_name_registry(const std::span<const planning_hub> entities) noexcept;
+
+   explicit unique_name_registry(const std::span<const planning_connection> entities) noexcept;
+
+   explicit unique_name_registry(const std::span<const boundary> entities) noexcept;
+
+   explicit unique_name_registry(const std::span<const animation> entities) noexcept;
+
+   explicit unique_name_registry(const std::span<const animation_group> entities) noexcept;
+
+   /// @brief Create a unique name and add it to the registry.
+   /// @param reference_name The name to base the new name off.
+   /// @return The new name, same as create_unique_name would return if an entity with each
+   /// previously created name had been added to the entities.
+   [[nodiscard]] auto create_unique_name(const std::string_view reference_name) noexcept
+      -> std::string;
+
+   /// @brief Add a name to the registry.
+   void add(const std::string_view name) noexcept;
+
+   /// @brief Check if a name is in the registry.
+   [[nodiscard]] bool contains(const std::string_view name) const noexcept;
+
+private:
+   template<typename T>
+   void add_entities(const std::span<const T> entities) noexcept;
+
+   /// @brief The base name to use for names that are only a number.
+   std::string_view _missing_name_base;
+
+   absl::flat_hash_set<std::string, entity_name_hash, entity_name_equal> _names;
+   absl::flat_hash_map<std::string, uint64, entity_name_hash, entity_name_equal> _max_indices;
+};
+
 /// @brief Check if a light is directional. (It's type is directional or one of the directional_region_* types)
 /// @param light
 /// @return
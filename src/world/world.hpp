@@ -5,6 +5,7 @@
 #include "blocks.hpp"
 #include "boundary.hpp"
 #include "configuration.hpp"
+#include "dirty_files.hpp"
 #include "effects.hpp"
 #include "game_mode_description.hpp"
 #include "global_lights.hpp"
@@ -38,6 +39,38 @@ constexpr std::size_t max_animations = 16'384;
 constexpr std::size_t max_animation_groups = 16'384;
 constexpr std::size_t max_animation_hierarchies = 16'384;
 
+/// @brief Tracks which entity types have been edited since they were last cleared. Lets per-frame
+/// consumers, like entity_spatial_index, skip the entities of types that haven't changed.
+///
+/// Every type starts out dirty, a world that has just been made or loaded has not been seen by any
+/// consumer yet.
+struct dirty_entity_types {
+   unsigned short objects : 1 = true;
+   unsigned short lights : 1 = true;
+   unsigned short paths : 1 = true;
+   unsigned short regions : 1 = true;
+   unsigned short sectors : 1 = true;
+   unsigned short portals : 1 = true;
+   unsigned short hintnodes : 1 = true;
+   unsigned short barriers : 1 = true;
+   unsigned short planning_hubs : 1 = true;
+   unsigned short boundaries : 1 = true;
+
+   /// @brief Mark every entity type as dirty.
+   void mark_all() noexcept
+   {
+      *this = {};
+   }
+
+   /// @brief Clear every entity type. Like blocks::untracked_clear_dirty_ranges this should only
+   /// be called once every consumer has seen the edits.
+   void untracked_clear() noexcept
+   {
+      objects = lights = paths = regions = sectors = portals = hintnodes = barriers =
+         planning_hubs = boundaries = false;
+   }
+};
+
 struct world {
    std::string name;
 
@@ -103,6 +136,13 @@ struct world {
       id_generator<animation_hierarchy> animation_hierarchies;
       id_generator<tree_line> tree_lines;
    } next_id;
+
+   /// @brief Tracks the files that are out of date with the world and need to be rewritten when it is saved.
+   dirty_files dirty_files;
+
+   /// @brief Tracks the entity types that have been edited since the app last updated it's
+   /// spatial index.
+   dirty_entity_types dirty_entities;
 };
 
 }
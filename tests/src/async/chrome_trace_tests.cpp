@@ -0,0 +1,50 @@
+#include "pch.h"
+
+#include "async/chrome_trace.hpp"
+
+#include <array>
+#include <string>
+
+using namespace std::literals;
+
+namespace we::async::tests {
+
+TEST_CASE("async make_chrome_trace", "[Async][ThreadPool]")
+{
+   const std::chrono::steady_clock::time_point start;
+
+   const std::array events{
+      task_trace_event{.priority = task_priority::normal,
+                       .worker_index = 1,
+                       .queued_time = start + 1ms,
+                       .start_time = start + 2ms,
+                       .end_time = start + 5ms},
+      task_trace_event{.priority = task_priority::low,
+                       .worker_index = 0,
+                       .start_time = start + 3ms,
+                       .end_time = start + 4ms},
+      task_trace_event{.priority = task_priority::normal,
+                       .worker_index = 1,
+                       .queued_time = start + 5ms,
+                       .start_time = start + 5ms,
+                       .end_time = start + 6ms},
+   };
+
+   const std::string trace = make_chrome_trace(events);
+
+   REQUIRE(
+      trace ==
+      R"({"displayTimeUnit":"ms","traceEvents":[)"
+      R"({"name":"thread_name","ph":"M","pid":0,"tid":1,"args":{"name":"Normal Priority Worker #1"}},)"
+      R"({"name":"thread_sort_index","ph":"M","pid":0,"tid":1,"args":{"sort_index":1}},)"
+      R"({"name":"Task","cat":"normal","ph":"X","pid":0,"tid":1,"ts":0.000,"dur":3000.000,"args":{"queued_us":1000.000}},)"
+      R"({"name":"thread_name","ph":"M","pid":0,"tid":1000,"args":{"name":"Low Priority Worker #0"}},)"
+      R"({"name":"thread_sort_index","ph":"M","pid":0,"tid":1000,"args":{"sort_index":1000}},)"
+      R"({"name":"Task","cat":"low","ph":"X","pid":0,"tid":1000,"ts":1000.000,"dur":1000.000},)"
+      R"({"name":"Task","cat":"normal","ph":"X","pid":0,"tid":1,"ts":3000.000,"dur":1000.000,"args":{"queued_us":0.000}})"
+      R"(]})"sv);
+
+   REQUIRE(make_chrome_trace({}) == R"({"displayTimeUnit":"ms","traceEvents":[]})"sv);
+}
+
+}
@@ -0,0 +1,179 @@
+#include "pch.h"
+
+#include "async/coroutine.hpp"
+
+#include <atomic>
+#include <latch>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::literals;
+
+namespace we::async::tests {
+
+namespace {
+
+auto add_one(thread_pool& thread_pool, int value) -> task<int>
+{
+   int result = co_await thread_pool.exec([value] { return value + 1; });
+
+   co_return result;
+}
+
+auto stringify(thread_pool& thread_pool, const task_priority, int value)
+   -> task<std::string>
+{
+   const int first = co_await add_one(thread_pool, value);
+   const int second = co_await add_one(thread_pool, first);
+
+   co_return std::to_string(second);
+}
+
+auto throws(thread_pool&) -> task<int>
+{
+   co_await std::suspend_never{};
+
+   throw std::runtime_error{"Oops!"};
+}
+
+auto rethrows(thread_pool& thread_pool) -> task<void>
+{
+   (void)co_await throws(thread_pool);
+}
+
+}
+
+TEST_CASE("async coroutine", "[Async][ThreadPool]")
+{
+   auto thread_pool =
+      thread_pool::make({.thread_count = 2, .low_priority_thread_count = 1});
+
+   REQUIRE(add_one(*thread_pool, 1).get() == 2);
+}
+
+TEST_CASE("async coroutine nested", "[Async][ThreadPool]")
+{
+   auto thread_pool =
+      thread_pool::make({.thread_count = 2, .low_priority_thread_count = 1});
+
+   REQUIRE(stringify(*thread_pool, task_priority::low, 1).get() == "3"s);
+}
+
+TEST_CASE("async coroutine exception", "[Async][ThreadPool]")
+{
+   auto thread_pool =
+      thread_pool::make({.thread_count = 2, .low_priority_thread_count = 1});
+
+   REQUIRE_THROWS_AS(rethrows(*thread_pool).get(), std::runtime_error);
+}
+
+TEST_CASE("async coroutine does not block", "[Async][ThreadPool]")
+{
+   auto thread_pool =
+      thread_pool::make({.thread_count = 2, .low_priority_thread_count = 1});
+
+   std::latch release{1};
+
+   task<int> blocked = thread_pool->exec([&] {
+      release.wait();
+
+      return 1;
+   });
+
+   // One worker is stuck in blocked, a coroutine waiting on it must not hold the
+   // other worker while it's suspended.
+   task<int> waiting = [](async::thread_pool&, task<int>& blocked) -> task<int> {
+      co_return co_await blocked + 1;
+   }(*thread_pool, blocked);
+
+   task<int> independent = thread_pool->exec([] { return 5; });
+
+   independent.wait_no_execute();
+
+   REQUIRE(not waiting.ready());
+
+   release.count_down();
+
+   REQUIRE(waiting.get() == 2);
+}
+
+TEST_CASE("async coroutine resume_on", "[Async][ThreadPool]")
+{
+   auto thread_pool =
+      thread_pool::make({.thread_count = 1, .low_priority_thread_count = 1});
+
+   std::vector<std::thread::id> thread_ids;
+
+   task<void> task = [](async::thread_pool& pool,
+                        std::vector<std::thread::id>& thread_ids) -> async::task<void> {
+      thread_ids.push_back(std::this_thread::get_id());
+
+      co_await resume_on(pool, task_priority::low);
+
+      thread_ids.push_back(std::this_thread::get_id());
+   }(*thread_pool, thread_ids);
+
+   task.get();
+
+   REQUIRE(thread_ids.size() == 2);
+   REQUIRE(thread_ids[0] != std::this_thread::get_id());
+   REQUIRE(thread_ids[1] != std::this_thread::get_id());
+   REQUIRE(thread_ids[0] != thread_ids[1]);
+}
+
+TEST_CASE("async coroutine resumed on thread_pool destruction", "[Async][ThreadPool]")
+{
+   auto thread_pool =
+      thread_pool::make({.thread_count = 1, .low_priority_thread_count = 1});
+
+   std::latch started{1};
+   std::latch release{1};
+
+   task<void> blocked = thread_pool->exec([&] {
+      started.count_down();
+      release.wait();
+   });
+
+   started.wait();
+
+   struct frame_tracker {
+      std::atomic_int& destroyed;
+
+      ~frame_tracker()
+      {
+         destroyed += 1;
+      }
+   };
+
+   std::atomic_int frames_destroyed = 0;
+   bool ran = false;
+
+   // The only normal priority worker is stuck in blocked, so the coroutine is still waiting to start when the
+   // thread_pool is destroyed.
+   task<void> queued = [](async::thread_pool&, std::atomic_int& frames_destroyed,
+                          bool& ran) -> task<void> {
+      frame_tracker tracker{frames_destroyed};
+
+      ran = true;
+
+      co_return;
+   }(*thread_pool, frames_destroyed, ran);
+
+   std::thread releaser{[&] {
+      std::this_thread::sleep_for(50ms);
+
+      release.count_down();
+   }};
+
+   thread_pool.reset();
+
+   releaser.join();
+
+   REQUIRE(ran);
+   REQUIRE(frames_destroyed == 1);
+   REQUIRE(queued.ready());
+}
+
+}
@@ -0,0 +1,72 @@
+#include "pch.h"
+
+#include "async/detail/injection_queue.hpp"
+
+#include <algorithm>
+#include <array>
+#include <thread>
+#include <vector>
+
+namespace we::async::detail::tests {
+
+TEST_CASE("async detail injection_queue push pop", "[Async][ThreadPool]")
+{
+   injection_queue<int> queue{2};
+
+   std::array<int, 4> values{0, 1, 2, 3};
+
+   REQUIRE(queue.pop() == nullptr);
+
+   // The first two fit in the ring, the rest go to the overflow queue.
+   queue.push(&values[0]);
+   queue.push(&values[1]);
+   queue.push(&values[2]);
+   queue.push(&values[3]);
+
+   REQUIRE(queue.pop() == &values[0]);
+   REQUIRE(queue.pop() == &values[1]);
+   REQUIRE(queue.pop() == &values[2]);
+   REQUIRE(queue.pop() == &values[3]);
+   REQUIRE(queue.pop() == nullptr);
+}
+
+TEST_CASE("async detail injection_queue concurrent", "[Async][ThreadPool]")
+{
+   constexpr std::size_t producer_count = 2;
+   constexpr std::size_t consumer_count = 2;
+   constexpr std::size_t items_per_producer = 50'000;
+
+   injection_queue<std::atomic_int> queue{64};
+
+   std::vector<std::atomic_int> items(producer_count * items_per_producer);
+   std::atomic_size_t consumed = 0;
+
+   {
+      std::vector<std::jthread> threads;
+
+      for (std::size_t producer = 0; producer < producer_count; ++producer) {
+         threads.emplace_back([&, producer] {
+            for (std::size_t i = 0; i < items_per_producer; ++i) {
+               queue.push(&items[producer * items_per_producer + i]);
+            }
+         });
+      }
+
+      for (std::size_t consumer = 0; consumer < consumer_count; ++consumer) {
+         threads.emplace_back([&] {
+            while (consumed.load() < items.size()) {
+               if (std::atomic_int* item = queue.pop(); item) {
+                  item->fetch_add(1);
+                  consumed.fetch_add(1);
+               }
+            }
+         });
+      }
+   }
+
+   REQUIRE(std::ranges::all_of(items, [](const std::atomic_int& value) {
+      return value.load() == 1;
+   }));
+}
+
+}
@@ -0,0 +1,51 @@
+#include "pch.h"
+
+#include "async/detail/recycling_allocator.hpp"
+
+#include <cstring>
+#include <thread>
+
+namespace we::async::detail::tests {
+
+namespace {
+
+void* block_allocated_after_cache_destroyed = nullptr;
+
+/// @brief Allocates a block from its destructor. Constructed before the thread's cache so it is
+/// destroyed after it.
+struct allocate_on_thread_exit {
+   ~allocate_on_thread_exit()
+   {
+      block_allocated_after_cache_destroyed = recycling_allocate(65, alignof(int));
+   }
+};
+
+thread_local allocate_on_thread_exit allocate_on_exit;
+
+}
+
+TEST_CASE("async detail recycling_allocator block allocated after thread cache destroyed",
+          "[Async][ThreadPool]")
+{
+   std::thread{[] {
+      [[maybe_unused]] const allocate_on_thread_exit& touch = allocate_on_exit;
+
+      recycling_deallocate(recycling_allocate(65, alignof(int)), 65, alignof(int));
+   }}.join();
+
+   REQUIRE(block_allocated_after_cache_destroyed);
+
+   // The block is freed into this thread's cache and handed out again for the largest size in
+   // its class. It must be class sized for this not to write past its end.
+   recycling_deallocate(block_allocated_after_cache_destroyed, 65, alignof(int));
+
+   void* const block = recycling_allocate(128, alignof(int));
+
+   CHECK(block == block_allocated_after_cache_destroyed);
+
+   std::memset(block, 0xff, 128);
+
+   recycling_deallocate(block, 128, alignof(int));
+}
+
+}
@@ -0,0 +1,80 @@
+#include "pch.h"
+
+#include "async/detail/task_function.hpp"
+
+#include <array>
+#include <memory>
+
+namespace we::async::detail::tests {
+
+TEST_CASE("async detail task_function inline", "[Async][ThreadPool]")
+{
+   int invoked = 0;
+
+   task_function function = [&invoked] { invoked += 1; };
+
+   REQUIRE(function);
+
+   function();
+
+   REQUIRE(invoked == 1);
+
+   task_function moved_function = std::move(function);
+
+   REQUIRE(not function);
+   REQUIRE(moved_function);
+
+   moved_function();
+
+   REQUIRE(invoked == 2);
+}
+
+TEST_CASE("async detail task_function heap", "[Async][ThreadPool]")
+{
+   std::array<int, 64> values{};
+   values[63] = 5;
+
+   int result = 0;
+
+   task_function function = [&result, values] { result = values[63]; };
+
+   task_function moved_function;
+
+   moved_function = std::move(function);
+
+   REQUIRE(not function);
+
+   moved_function();
+
+   REQUIRE(result == 5);
+}
+
+TEST_CASE("async detail task_function destroys callable", "[Async][ThreadPool]")
+{
+   std::shared_ptr<int> value = std::make_shared<int>(1);
+
+   {
+      task_function function = [value] {};
+
+      REQUIRE(value.use_count() == 2);
+
+      task_function moved_function = std::move(function);
+
+      REQUIRE(value.use_count() == 2);
+   }
+
+   REQUIRE(value.use_count() == 1);
+}
+
+TEST_CASE("async detail task_function discards result", "[Async][ThreadPool]")
+{
+   int invoked = 0;
+
+   task_function function = [&invoked] { return invoked += 1; };
+
+   function();
+
+   REQUIRE(invoked == 1);
+}
+
+}
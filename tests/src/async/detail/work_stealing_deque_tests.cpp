@@ -0,0 +1,87 @@
+#include "pch.h"
+
+#include "async/detail/work_stealing_deque.hpp"
+
+#include <algorithm>
+#include <array>
+#include <thread>
+#include <vector>
+
+namespace we::async::detail::tests {
+
+TEST_CASE("async detail work_stealing_deque push pop", "[Async][ThreadPool]")
+{
+   work_stealing_deque<int> deque{4};
+
+   std::array<int, 5> values{0, 1, 2, 3, 4};
+
+   REQUIRE(deque.pop() == nullptr);
+   REQUIRE(deque.steal() == nullptr);
+
+   REQUIRE(deque.push(&values[0]));
+   REQUIRE(deque.push(&values[1]));
+   REQUIRE(deque.push(&values[2]));
+   REQUIRE(deque.push(&values[3]));
+   REQUIRE(not deque.push(&values[4]));
+
+   REQUIRE(deque.size() == 4);
+
+   // Owner pops are LIFO, steals are FIFO.
+   REQUIRE(deque.pop() == &values[3]);
+   REQUIRE(deque.steal() == &values[0]);
+   REQUIRE(deque.pop() == &values[2]);
+   REQUIRE(deque.steal() == &values[1]);
+
+   REQUIRE(deque.pop() == nullptr);
+   REQUIRE(deque.steal() == nullptr);
+   REQUIRE(deque.size() == 0);
+
+   // Wrap around the ring.
+   REQUIRE(deque.push(&values[4]));
+   REQUIRE(deque.pop() == &values[4]);
+}
+
+TEST_CASE("async detail work_stealing_deque concurrent steal",
+          "[Async][ThreadPool]")
+{
+   constexpr std::size_t item_count = 100'000;
+   constexpr std::size_t thief_count = 3;
+
+   work_stealing_deque<std::atomic_int> deque{256};
+
+   std::vector<std::atomic_int> items(item_count);
+   std::atomic_bool done = false;
+
+   std::vector<std::jthread> thieves;
+
+   for (std::size_t i = 0; i < thief_count; ++i) {
+      thieves.emplace_back([&] {
+         while (not done.load()) {
+            if (std::atomic_int* item = deque.steal(); item) {
+               item->fetch_add(1);
+            }
+         }
+      });
+   }
+
+   for (std::size_t i = 0; i < item_count; ++i) {
+      while (not deque.push(&items[i])) {
+         if (std::atomic_int* item = deque.pop(); item) item->fetch_add(1);
+      }
+
+      if (i % 3 == 0) {
+         if (std::atomic_int* item = deque.pop(); item) item->fetch_add(1);
+      }
+   }
+
+   while (std::atomic_int* item = deque.pop()) item->fetch_add(1);
+
+   done.store(true);
+   thieves.clear();
+
+   REQUIRE(std::ranges::all_of(items, [](const std::atomic_int& value) {
+      return value.load() == 1;
+   }));
+}
+
+}
@@ -25,4 +25,23 @@ TEST_CASE("async for_each", "[Async][ThreadPool]")
    REQUIRE(std::ranges::all_of(arr, [](int v) { return v == 1; }));
 }
 
+TEST_CASE("async for_each options", "[Async][ThreadPool]")
+{
+
+   auto thread_pool =
+      thread_pool::make({.thread_count = 2, .low_priority_thread_count = 0});
+
+   std::array<int, 16> arr{};
+
+   for_each(*thread_pool, async::task_priority::normal, arr,
+            {.schedule = for_each_schedule::static_split},
+            [&](int& v) noexcept { v += 1; });
+
+   for_each(*thread_pool, async::task_priority::normal, arr,
+            {.schedule = for_each_schedule::guided, .grain_size = 4},
+            [&](int& v) noexcept { v += 1; });
+
+   REQUIRE(std::ranges::all_of(arr, [](int v) { return v == 2; }));
+}
+
 }
@@ -0,0 +1,53 @@
+#include "pch.h"
+
+#include "async/inclusive_scan.hpp"
+
+#include <numeric>
+#include <vector>
+
+namespace we::async::tests {
+
+TEST_CASE("async parallel_inclusive_scan", "[Async][ThreadPool]")
+{
+   auto thread_pool =
+      thread_pool::make({.thread_count = 3, .low_priority_thread_count = 1});
+
+   for (const std::size_t size : {0, 1, 100, 1024, 4097, 100'000}) {
+      std::vector<std::size_t> values(size);
+
+      for (std::size_t i = 0; i < size; ++i) values[i] = i % 13;
+
+      std::vector<std::size_t> expected(size);
+      std::vector<std::size_t> scanned(size);
+
+      std::inclusive_scan(values.begin(), values.end(), expected.begin());
+
+      parallel_inclusive_scan(*thread_pool, task_priority::normal, values, scanned);
+
+      REQUIRE(scanned == expected);
+   }
+}
+
+TEST_CASE("async parallel_inclusive_scan in place", "[Async][ThreadPool]")
+{
+   auto thread_pool =
+      thread_pool::make({.thread_count = 3, .low_priority_thread_count = 1});
+
+   std::vector<int> values(50'000);
+
+   for (int i = 0; i < std::ssize(values); ++i) values[i] = (i * 31) % 17 - 8;
+
+   std::vector<int> expected(values.size());
+
+   std::inclusive_scan(values.begin(), values.end(), expected.begin(),
+                       [](const int left, const int right) { return std::max(left, right); });
+
+   parallel_inclusive_scan(*thread_pool, task_priority::normal, values, values,
+                           [](const int left, const int right) noexcept {
+                              return std::max(left, right);
+                           });
+
+   REQUIRE(values == expected);
+}
+
+}
@@ -0,0 +1,113 @@
+#include "pch.h"
+
+#include "async/inclusive_scan.hpp"
+#include "async/reduce.hpp"
+#include "async/sort.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace we::async::tests {
+
+namespace {
+
+constexpr std::size_t benchmark_thread_count = 8;
+constexpr std::size_t benchmark_item_count = 1024 * 1024;
+
+auto make_benchmark_values() -> std::vector<float>
+{
+   std::mt19937 random{1337};
+   std::uniform_real_distribution<float> distribution{-1000.0f, 1000.0f};
+
+   std::vector<float> values(benchmark_item_count);
+
+   for (float& value : values) value = distribution(random);
+
+   return values;
+}
+
+}
+
+TEST_CASE("async parallel_reduce benchmark", "[Async][ThreadPool][Benchmark][.]")
+{
+   auto thread_pool = thread_pool::make({.thread_count = benchmark_thread_count,
+                                         .low_priority_thread_count = 1});
+
+   const std::vector<float> values = make_benchmark_values();
+
+   BENCHMARK("std::reduce")
+   {
+      return std::reduce(values.begin(), values.end(), 0.0f);
+   };
+
+   BENCHMARK("parallel_reduce")
+   {
+      return parallel_reduce(*thread_pool, task_priority::normal, values, 0.0f,
+                             std::plus<float>{});
+   };
+
+   const auto max_op = [](const float left, const float right) noexcept {
+      return std::max(left, right);
+   };
+   const auto abs_op = [](const float value) noexcept { return std::abs(value); };
+
+   BENCHMARK("std::transform_reduce")
+   {
+      return std::transform_reduce(values.begin(), values.end(), 0.0f, max_op, abs_op);
+   };
+
+   BENCHMARK("parallel_transform_reduce")
+   {
+      return parallel_transform_reduce(*thread_pool, task_priority::normal, values,
+                                       0.0f, max_op, abs_op);
+   };
+}
+
+TEST_CASE("async parallel_inclusive_scan benchmark", "[Async][ThreadPool][Benchmark][.]")
+{
+   auto thread_pool = thread_pool::make({.thread_count = benchmark_thread_count,
+                                         .low_priority_thread_count = 1});
+
+   const std::vector<float> values = make_benchmark_values();
+   std::vector<float> output(values.size());
+
+   BENCHMARK("std::inclusive_scan")
+   {
+      std::inclusive_scan(values.begin(), values.end(), output.begin());
+
+      return output.back();
+   };
+
+   BENCHMARK("parallel_inclusive_scan")
+   {
+      parallel_inclusive_scan(*thread_pool, task_priority::normal, values, output);
+
+      return output.back();
+   };
+}
+
+TEST_CASE("async parallel_sort benchmark", "[Async][ThreadPool][Benchmark][.]")
+{
+   auto thread_pool = thread_pool::make({.thread_count = benchmark_thread_count,
+                                         .low_priority_thread_count = 1});
+
+   const std::vector<float> values = make_benchmark_values();
+
+   BENCHMARK_ADVANCED("std::sort")(Catch::Benchmark::Chronometer meter)
+   {
+      std::vector<float> sorted = values;
+
+      meter.measure([&] { std::sort(sorted.begin(), sorted.end()); });
+   };
+
+   BENCHMARK_ADVANCED("parallel_sort")(Catch::Benchmark::Chronometer meter)
+   {
+      std::vector<float> sorted = values;
+
+      meter.measure([&] { parallel_sort(*thread_pool, task_priority::normal, sorted); });
+   };
+}
+
+}
@@ -0,0 +1,71 @@
+#include "pch.h"
+
+#include "async/reduce.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace we::async::tests {
+
+TEST_CASE("async parallel_reduce", "[Async][ThreadPool]")
+{
+   auto thread_pool =
+      thread_pool::make({.thread_count = 3, .low_priority_thread_count = 1});
+
+   for (const std::size_t size : {0, 1, 100, 1024, 4097, 100'000}) {
+      std::vector<std::size_t> values(size);
+
+      std::iota(values.begin(), values.end(), std::size_t{0});
+
+      REQUIRE(parallel_reduce(*thread_pool, task_priority::normal, values,
+                              std::size_t{7}, std::plus<std::size_t>{}) ==
+              std::reduce(values.begin(), values.end(), std::size_t{7}));
+   }
+}
+
+TEST_CASE("async parallel_reduce keeps order", "[Async][ThreadPool]")
+{
+   auto thread_pool =
+      thread_pool::make({.thread_count = 3, .low_priority_thread_count = 1});
+
+   std::vector<char> letters(20'000);
+
+   for (std::size_t i = 0; i < letters.size(); ++i) {
+      letters[i] = static_cast<char>('a' + i % 26);
+   }
+
+   const std::string expected{letters.begin(), letters.end()};
+
+   REQUIRE(parallel_transform_reduce(
+              *thread_pool, task_priority::normal, letters, std::string{},
+              [](std::string left, std::string right) noexcept {
+                 return std::move(left) + right;
+              },
+              [](const char c) noexcept { return std::string(1, c); }) == expected);
+}
+
+TEST_CASE("async parallel_transform_reduce", "[Async][ThreadPool]")
+{
+   auto thread_pool =
+      thread_pool::make({.thread_count = 3, .low_priority_thread_count = 1});
+
+   std::vector<int> values(50'000);
+
+   for (int i = 0; i < std::ssize(values); ++i) values[i] = (i * 7919) % 10007 - 5000;
+
+   const int max_square = parallel_transform_reduce(
+      *thread_pool, task_priority::low, values, 0,
+      [](const int left, const int right) noexcept { return std::max(left, right); },
+      [](const int value) noexcept { return value * value; });
+
+   REQUIRE(max_square == std::transform_reduce(
+                            values.begin(), values.end(), 0,
+                            [](const int left, const int right) {
+                               return std::max(left, right);
+                            },
+                            [](const int value) { return value * value; }));
+}
+
+}
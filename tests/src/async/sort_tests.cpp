@@ -0,0 +1,50 @@
+#include "pch.h"
+
+#include "async/sort.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <vector>
+
+namespace we::async::tests {
+
+TEST_CASE("async parallel_sort", "[Async][ThreadPool]")
+{
+   auto thread_pool =
+      thread_pool::make({.thread_count = 3, .low_priority_thread_count = 1});
+
+   std::mt19937 random{42};
+
+   for (const std::size_t size : {0, 1, 100, 1024, 4097, 100'000}) {
+      std::vector<int> values(size);
+
+      for (int& value : values) value = static_cast<int>(random() % 1000);
+
+      std::vector<int> expected = values;
+
+      std::sort(expected.begin(), expected.end());
+
+      parallel_sort(*thread_pool, task_priority::normal, values);
+
+      REQUIRE(values == expected);
+   }
+}
+
+TEST_CASE("async parallel_sort compare", "[Async][ThreadPool]")
+{
+   auto thread_pool =
+      thread_pool::make({.thread_count = 3, .low_priority_thread_count = 1});
+
+   std::vector<int> values(30'000);
+
+   for (int i = 0; i < std::ssize(values); ++i) values[i] = i;
+
+   parallel_sort(*thread_pool, task_priority::low, values, std::greater<int>{});
+
+   REQUIRE(std::is_sorted(values.begin(), values.end(), std::greater<int>{}));
+   REQUIRE(values.front() == 29'999);
+   REQUIRE(values.back() == 0);
+}
+
+}
@@ -0,0 +1,123 @@
+#include "pch.h"
+
+#include "async/then.hpp"
+
+#include <atomic>
+#include <latch>
+#include <stdexcept>
+#include <string>
+
+using namespace std::literals;
+
+namespace we::async::tests {
+
+TEST_CASE("async then", "[Async][ThreadPool]")
+{
+   auto thread_pool =
+      thread_pool::make({.thread_count = 2, .low_priority_thread_count = 1});
+
+   task<int> task = then(*thread_pool, task_priority::normal,
+                         thread_pool->exec(task_priority::normal, [] { return 2; }),
+                         [](int value) { return value * 21; });
+
+   REQUIRE(task.get() == 42);
+}
+
+TEST_CASE("async then void", "[Async][ThreadPool]")
+{
+   auto thread_pool =
+      thread_pool::make({.thread_count = 2, .low_priority_thread_count = 1});
+
+   std::atomic_int order = 0;
+   int first = -1;
+   int second = -1;
+
+   task<void> task = then(*thread_pool, task_priority::normal,
+                          thread_pool->exec(task_priority::normal,
+                                            [&] { first = order.fetch_add(1); }),
+                          [&] { second = order.fetch_add(1); });
+
+   task.get();
+
+   REQUIRE(first == 0);
+   REQUIRE(second == 1);
+}
+
+TEST_CASE("async then chain", "[Async][ThreadPool]")
+{
+   auto thread_pool =
+      thread_pool::make({.thread_count = 2, .low_priority_thread_count = 1});
+
+   task<std::string> task =
+      then(*thread_pool, task_priority::low,
+           then(*thread_pool, task_priority::normal,
+                thread_pool->exec(task_priority::normal, [] { return 1; }),
+                [](int value) { return value + 1; }),
+           [](int value) { return std::to_string(value); });
+
+   REQUIRE(task.get() == "2"s);
+}
+
+TEST_CASE("async then does not block", "[Async][ThreadPool]")
+{
+   auto thread_pool =
+      thread_pool::make({.thread_count = 1, .low_priority_thread_count = 1});
+
+   std::latch release{1};
+
+   task<int> blocked = thread_pool->exec(task_priority::normal, [&] {
+      release.wait();
+
+      return 1;
+   });
+
+   // With only a single worker a continuation that blocked a thread while
+   // waiting would deadlock here.
+   task<int> continuation = then(*thread_pool, task_priority::normal,
+                                 std::move(blocked), [](int value) { return value + 1; });
+
+   REQUIRE(not continuation.ready());
+
+   release.count_down();
+
+   REQUIRE(continuation.get() == 2);
+}
+
+TEST_CASE("async then exception", "[Async][ThreadPool]")
+{
+   auto thread_pool =
+      thread_pool::make({.thread_count = 2, .low_priority_thread_count = 1});
+
+   bool called = false;
+
+   task<int> task = then(*thread_pool, task_priority::normal,
+                         thread_pool->exec(task_priority::normal,
+                                           []() -> int {
+                                              throw std::runtime_error{"Oops!"};
+                                           }),
+                         [&](int value) {
+                            called = true;
+
+                            return value;
+                         });
+
+   REQUIRE_THROWS_AS(task.get(), std::runtime_error);
+   REQUIRE(not called);
+}
+
+TEST_CASE("async then already ready", "[Async][ThreadPool]")
+{
+   auto thread_pool =
+      thread_pool::make({.thread_count = 2, .low_priority_thread_count = 1});
+
+   task<int> antecedent = thread_pool->exec(task_priority::normal, [] { return 1; });
+
+   antecedent.wait();
+
+   task<int> task = then(*thread_pool, task_priority::normal, std::move(antecedent),
+                         [](int value) { return value + 1; });
+
+   REQUIRE(task.get() == 2);
+}
+
+}
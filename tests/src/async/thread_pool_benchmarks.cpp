@@ -0,0 +1,257 @@
+#include "pch.h"
+
+#include "async/detail/injection_queue.hpp"
+#include "async/detail/work_stealing_deque.hpp"
+#include "async/thread_pool.hpp"
+
+#include <memory>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+namespace we::async::tests {
+
+namespace {
+
+constexpr std::size_t benchmark_thread_count = 8;
+constexpr std::size_t benchmark_item_count = 64 * 1024;
+
+/// @brief The single mutex queue thread_pool used before work stealing, kept for comparison.
+struct locked_queue {
+   void push(std::shared_ptr<int> item)
+   {
+      std::scoped_lock lock{mutex};
+
+      items.emplace_back(std::move(item));
+   }
+
+   auto pop() -> std::shared_ptr<int>
+   {
+      std::scoped_lock lock{mutex};
+
+      if (items.empty()) return nullptr;
+
+      std::shared_ptr<int> item = std::move(items.front());
+      items.erase(items.begin());
+
+      return item;
+   }
+
+   std::shared_mutex mutex;
+   std::vector<std::shared_ptr<int>> items;
+};
+
+}
+
+TEST_CASE("async thread_pool queue contention benchmark",
+          "[Async][ThreadPool][Benchmark][.]")
+{
+   std::vector<int> items(benchmark_item_count);
+
+   BENCHMARK("locked_queue")
+   {
+      locked_queue queue;
+      std::atomic_size_t consumed = 0;
+
+      {
+         std::vector<std::jthread> threads;
+
+         for (std::size_t thread = 0; thread < benchmark_thread_count; ++thread) {
+            threads.emplace_back([&, thread] {
+               for (std::size_t i = thread; i < items.size();
+                    i += benchmark_thread_count) {
+                  queue.push(std::shared_ptr<int>{std::shared_ptr<int>{}, &items[i]});
+
+                  if (auto item = queue.pop(); item) consumed.fetch_add(1);
+               }
+
+               while (consumed.load() < items.size()) {
+                  if (auto item = queue.pop(); item) consumed.fetch_add(1);
+               }
+            });
+         }
+      }
+
+      return consumed.load();
+   };
+
+   BENCHMARK("work_stealing_deque + injection_queue")
+   {
+      detail::injection_queue<int> injected{4096};
+      std::vector<std::unique_ptr<detail::work_stealing_deque<int>>> deques;
+      std::atomic_size_t consumed = 0;
+
+      for (std::size_t thread = 0; thread < benchmark_thread_count; ++thread) {
+         deques.emplace_back(std::make_unique<detail::work_stealing_deque<int>>(1024));
+      }
+
+      {
+         std::vector<std::jthread> threads;
+
+         for (std::size_t thread = 0; thread < benchmark_thread_count; ++thread) {
+            threads.emplace_back([&, thread] {
+               const auto pop = [&]() -> int* {
+                  if (int* item = deques[thread]->pop(); item) return item;
+                  if (int* item = injected.pop(); item) return item;
+
+                  for (std::size_t i = 1; i < benchmark_thread_count; ++i) {
+                     if (int* item = deques[(thread + i) % benchmark_thread_count]->steal();
+                         item) {
+                        return item;
+                     }
+                  }
+
+                  return nullptr;
+               };
+
+               for (std::size_t i = thread; i < items.size();
+                    i += benchmark_thread_count) {
+                  if (not deques[thread]->push(&items[i])) injected.push(&items[i]);
+
+                  if (pop()) consumed.fetch_add(1);
+               }
+
+               while (consumed.load() < items.size()) {
+                  if (pop()) consumed.fetch_add(1);
+               }
+            });
+         }
+      }
+
+      return consumed.load();
+   };
+}
+
+TEST_CASE("async thread_pool exec benchmark", "[Async][ThreadPool][Benchmark][.]")
+{
+   auto thread_pool =
+      thread_pool::make({.thread_count = benchmark_thread_count,
+                         .low_priority_thread_count = 1});
+
+   BENCHMARK("exec from main thread")
+   {
+      std::vector<task<std::size_t>> tasks;
+
+      tasks.reserve(benchmark_item_count / 16);
+
+      for (std::size_t i = 0; i < benchmark_item_count / 16; ++i) {
+         tasks.push_back(thread_pool->exec([i] { return i; }));
+      }
+
+      std::size_t sum = 0;
+
+      for (auto& task : tasks) sum += task.get();
+
+      return sum;
+   };
+
+   BENCHMARK("exec from workers")
+   {
+      std::vector<task<std::size_t>> tasks;
+
+      tasks.reserve(benchmark_thread_count);
+
+      for (std::size_t i = 0; i < benchmark_thread_count; ++i) {
+         tasks.push_back(thread_pool->exec([&thread_pool] {
+            std::vector<task<std::size_t>> children;
+
+            children.reserve(benchmark_item_count / 128);
+
+            for (std::size_t j = 0; j < benchmark_item_count / 128; ++j) {
+               children.push_back(thread_pool->exec([j] { return j; }));
+            }
+
+            std::size_t sum = 0;
+
+            for (auto& child : children) sum += child.get();
+
+            return sum;
+         }));
+      }
+
+      std::size_t sum = 0;
+
+      for (auto& task : tasks) sum += task.get();
+
+      return sum;
+   };
+}
+
+TEST_CASE("async thread_pool task allocations", "[Async][ThreadPool][Benchmark][.]")
+{
+   auto thread_pool =
+      thread_pool::make({.thread_count = benchmark_thread_count,
+                         .low_priority_thread_count = 1});
+
+   const task_allocation_stats start_stats = get_task_allocation_stats();
+
+   BENCHMARK("exec and get")
+   {
+      std::vector<task<std::size_t>> tasks;
+
+      tasks.reserve(benchmark_item_count / 16);
+
+      for (std::size_t i = 0; i < benchmark_item_count / 16; ++i) {
+         tasks.push_back(thread_pool->exec([i] { return i; }));
+      }
+
+      std::size_t sum = 0;
+
+      for (auto& task : tasks) sum += task.get();
+
+      return sum;
+   };
+
+   const task_allocation_stats end_stats = get_task_allocation_stats();
+
+   const double submitted_tasks =
+      static_cast<double>(end_stats.submitted_tasks - start_stats.submitted_tasks);
+
+   WARN("Heap allocations per submitted task: "
+        << static_cast<double>(end_stats.heap_allocations - start_stats.heap_allocations) /
+              submitted_tasks);
+   WARN("Recycled allocations per submitted task: "
+        << static_cast<double>(end_stats.recycled_allocations -
+                               start_stats.recycled_allocations) /
+              submitted_tasks);
+}
+
+TEST_CASE("async thread_pool for_each_n schedule benchmark",
+          "[Async][ThreadPool][Benchmark][.]")
+{
+   auto thread_pool =
+      thread_pool::make({.thread_count = benchmark_thread_count,
+                         .low_priority_thread_count = 1});
+
+   // Every 8th index in the first eighth of the range costs ~100x more than the rest.
+   const auto skewed_work = [](const std::size_t i) noexcept {
+      const std::size_t iterations =
+         (i < benchmark_item_count / 8 and i % 8 == 0) ? 2000 : 20;
+
+      volatile std::size_t value = i;
+
+      for (std::size_t j = 0; j < iterations; ++j) value = value * 31 + j;
+   };
+
+   BENCHMARK("static_split")
+   {
+      thread_pool->for_each_n(task_priority::normal, benchmark_item_count,
+                              {.schedule = for_each_schedule::static_split},
+                              skewed_work);
+   };
+
+   BENCHMARK("guided")
+   {
+      thread_pool->for_each_n(task_priority::normal, benchmark_item_count,
+                              {.schedule = for_each_schedule::guided}, skewed_work);
+   };
+
+   BENCHMARK("guided grain_size 64")
+   {
+      thread_pool->for_each_n(task_priority::normal, benchmark_item_count,
+                              {.schedule = for_each_schedule::guided, .grain_size = 64},
+                              skewed_work);
+   };
+}
+
+}
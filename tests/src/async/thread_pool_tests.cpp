@@ -3,6 +3,8 @@
 #include "async/thread_pool.hpp"
 
 #include <array>
+#include <latch>
+#include <stop_token>
 #include <thread>
 
 using namespace std::literals;
@@ -56,7 +58,6 @@ TEST_CASE("async task typed", "[Async][ThreadPool]")
       context->result = 5;
       context->executed_latch.count_down();
    };
-   context->owning_thread_pool = {}; // we have no thread_pool to assign here so cancel can not be tested here
 
    task<int> task{context};
 
@@ -86,7 +87,6 @@ TEST_CASE("async task typed exception", "[Async][ThreadPool]")
          std::make_exception_ptr(std::runtime_error{"exception"});
       context->executed_latch.count_down();
    };
-   context->owning_thread_pool = {}; // we have no thread_pool to assign here so cancel can not be tested here
 
    task<int> task{context};
 
@@ -119,7 +119,6 @@ TEST_CASE("async task typed wait", "[Async][ThreadPool]")
 
       return 0;
    };
-   context->owning_thread_pool = {}; // we have no thread_pool to assign here so cancel can not be tested here
 
    task<int> task{context};
 
@@ -148,7 +147,6 @@ TEST_CASE("async task typed wait_no_execute", "[Async][ThreadPool]")
 
       return 0;
    };
-   context->owning_thread_pool = {}; // we have no thread_pool to assign here so cancel can not be tested here
 
    task<int> task{context};
 
@@ -177,7 +175,6 @@ TEST_CASE("async task void", "[Async][ThreadPool]")
       task_invoked = true;
       context->executed_latch.count_down();
    };
-   context->owning_thread_pool = {}; // we have no thread_pool to assign here so cancel can not be tested here
 
    task<void> task{context};
 
@@ -212,7 +209,6 @@ TEST_CASE("async task void exception", "[Async][ThreadPool]")
          std::make_exception_ptr(std::runtime_error{"exception"});
       context->executed_latch.count_down();
    };
-   context->owning_thread_pool = {}; // we have no thread_pool to assign here so cancel can not be tested here
 
    task<void> task{context};
 
@@ -245,7 +241,6 @@ TEST_CASE("async task void wait", "[Async][ThreadPool]")
 
       return 0;
    };
-   context->owning_thread_pool = {}; // we have no thread_pool to assign here so cancel can not be tested here
 
    task<void> task{context};
 
@@ -301,6 +296,184 @@ TEST_CASE("async thread_pool", "[Async][ThreadPool]")
    REQUIRE_THROWS(void_task_exception.get());
 }
 
+TEST_CASE("async thread_pool nested exec", "[Async][ThreadPool]")
+{
+   auto thread_pool =
+      thread_pool::make({.thread_count = 4, .low_priority_thread_count = 1});
+
+   // Tasks submitted from workers go onto the worker's own deque and get stolen by the others.
+   std::vector<task<int>> tasks;
+
+   for (int i = 0; i < 64; ++i) {
+      tasks.push_back(thread_pool->exec(task_priority::normal, [&thread_pool, i] {
+         std::vector<task<int>> children;
+
+         for (int j = 0; j < 64; ++j) {
+            children.push_back(
+               thread_pool->exec(task_priority::normal, [j] { return j; }));
+         }
+
+         int sum = i;
+
+         for (auto& child : children) sum += child.get();
+
+         return sum;
+      }));
+   }
+
+   for (int i = 0; i < 64; ++i) {
+      REQUIRE(tasks[i].get() == i + (63 * 64) / 2);
+   }
+}
+
+TEST_CASE("async thread_pool cancel queued", "[Async][ThreadPool]")
+{
+   auto thread_pool =
+      thread_pool::make({.thread_count = 1, .low_priority_thread_count = 1});
+
+   std::atomic_bool release_worker = false;
+   std::atomic_bool canceled_task_invoked = false;
+
+   task<void> blocking_task = thread_pool->exec(task_priority::normal, [&] {
+      while (not release_worker.load()) std::this_thread::yield();
+   });
+
+   task<void> canceled_task =
+      thread_pool->exec(task_priority::normal,
+                        [&] { canceled_task_invoked.store(true); });
+
+   canceled_task.cancel();
+
+   REQUIRE(not canceled_task.valid());
+
+   release_worker.store(true);
+   blocking_task.wait();
+
+   // Give the worker a chance to pop (and discard) the canceled task.
+   thread_pool->exec(task_priority::normal, [] {}).wait_no_execute();
+
+   REQUIRE(not canceled_task_invoked.load());
+}
+
+TEST_CASE("async thread_pool queued task outliving thread_pool", "[Async][ThreadPool]")
+{
+   auto thread_pool = thread_pool::make({.thread_count = 1, .low_priority_thread_count = 1});
+
+   std::latch started{1};
+   std::atomic_bool release_worker = false;
+   std::atomic_bool queued_task_invoked = false;
+
+   task<void> blocking_task = thread_pool->exec(task_priority::normal, [&] {
+      started.count_down();
+
+      while (not release_worker.load()) std::this_thread::yield();
+   });
+
+   task<void> queued_task =
+      thread_pool->exec(task_priority::normal, [&] { queued_task_invoked.store(true); });
+
+   started.wait();
+
+   std::jthread releaser{[&] {
+      std::this_thread::sleep_for(50ms);
+
+      release_worker.store(true);
+   }};
+
+   thread_pool.reset();
+
+   REQUIRE(blocking_task.ready());
+   REQUIRE(queued_task.ready());
+   REQUIRE_THROWS_AS(queued_task.get(), canceled_task_error);
+   REQUIRE(not queued_task_invoked.load());
+}
+
+TEST_CASE("async thread_pool cancel running stop_token", "[Async][ThreadPool]")
+{
+   auto thread_pool =
+      thread_pool::make({.thread_count = 1, .low_priority_thread_count = 1});
+
+   std::atomic_bool started = false;
+   std::atomic_bool stopped = false;
+
+   task<void> task =
+      thread_pool->exec(task_priority::normal, [&](const std::stop_token stop_token) {
+         started.store(true);
+
+         while (not stop_token.stop_requested()) std::this_thread::yield();
+
+         stopped.store(true);
+      });
+
+   while (not started.load()) std::this_thread::yield();
+
+   task.cancel();
+
+   REQUIRE(not task.valid());
+   REQUIRE(stopped.load());
+}
+
+TEST_CASE("async thread_pool task request_stop", "[Async][ThreadPool]")
+{
+   auto thread_pool =
+      thread_pool::make({.thread_count = 1, .low_priority_thread_count = 1});
+
+   std::atomic_bool started = false;
+
+   task<int> task = thread_pool->exec([&](const std::stop_token stop_token) {
+      started.store(true);
+
+      int iterations = 0;
+
+      while (not stop_token.stop_requested()) {
+         iterations += 1;
+
+         std::this_thread::yield();
+      }
+
+      return iterations > 0 ? 1 : 0;
+   });
+
+   while (not started.load()) std::this_thread::yield();
+
+   task.request_stop();
+
+   REQUIRE(task.valid());
+   REQUIRE(task.get() == 1);
+
+   thread_pool->exec([](const std::stop_token) {}).request_stop();
+}
+
+TEST_CASE("async thread_pool for_each_n stop_token", "[Async][ThreadPool]")
+{
+   auto thread_pool =
+      thread_pool::make({.thread_count = 3, .low_priority_thread_count = 1});
+
+   std::stop_source stop_source;
+   std::atomic_size_t processed_count = 0;
+
+   for (const for_each_schedule schedule :
+        {for_each_schedule::static_split, for_each_schedule::guided}) {
+      processed_count.store(0);
+      stop_source = std::stop_source{};
+
+      thread_pool->for_each_n(task_priority::normal, 100'000, {.schedule = schedule},
+                              stop_source.get_token(), [&](const std::size_t) noexcept {
+                                 if (processed_count.fetch_add(1) == 100) {
+                                    stop_source.request_stop();
+                                 }
+                              });
+
+      REQUIRE(processed_count.load() >= 101);
+      REQUIRE(processed_count.load() < 100'000);
+   }
+
+   stop_source.request_stop();
+
+   thread_pool->for_each_n(task_priority::normal, 100, stop_source.get_token(),
+                           [](const std::size_t) noexcept { std::terminate(); });
+}
+
 TEST_CASE("async thread_pool for_each_n", "[Async][ThreadPool]")
 {
    auto thread_pool =
@@ -365,4 +538,204 @@ TEST_CASE("async thread_pool for_each_n singlethreaded mode",
                                [](const int value) { return value == 1; }));
 }
 
+TEST_CASE("async thread_pool for_each_n static_split", "[Async][ThreadPool]")
+{
+   auto thread_pool =
+      thread_pool::make({.thread_count = 3, .low_priority_thread_count = 1});
+
+   std::vector<int> processed_counts;
+
+   processed_counts.resize(100'003);
+
+   thread_pool->for_each_n(task_priority::normal, processed_counts.size(),
+                           {.schedule = for_each_schedule::static_split},
+                           [&](const std::size_t i) noexcept {
+                              if (i >= processed_counts.size()) {
+                                 std::terminate();
+                              }
+
+                              std::atomic_ref<int>{processed_counts[i]}.fetch_add(1);
+                           });
+
+   REQUIRE(std::ranges::all_of(processed_counts,
+                               [](const int value) { return value == 1; }));
+}
+
+TEST_CASE("async thread_pool for_each_n guided", "[Async][ThreadPool]")
+{
+   auto thread_pool =
+      thread_pool::make({.thread_count = 3, .low_priority_thread_count = 1});
+
+   std::vector<int> processed_counts;
+
+   processed_counts.resize(10'007);
+
+   // Make a small part of the range much more expensive than the rest.
+   thread_pool->for_each_n(task_priority::normal, processed_counts.size(),
+                           {.schedule = for_each_schedule::guided},
+                           [&](const std::size_t i) noexcept {
+                              if (i >= processed_counts.size()) {
+                                 std::terminate();
+                              }
+
+                              if (i < 16) {
+                                 std::this_thread::sleep_for(1ms);
+                              }
+
+                              std::atomic_ref<int>{processed_counts[i]}.fetch_add(1);
+                           });
+
+   REQUIRE(std::ranges::all_of(processed_counts,
+                               [](const int value) { return value == 1; }));
+}
+
+TEST_CASE("async thread_pool for_each_n guided grain_size", "[Async][ThreadPool]")
+{
+   auto thread_pool =
+      thread_pool::make({.thread_count = 7, .low_priority_thread_count = 1});
+
+   for (const std::size_t grain_size : {0, 1, 3, 64, 1000}) {
+      std::array<int, 130> processed_counts{};
+
+      thread_pool->for_each_n(task_priority::normal, processed_counts.size(),
+                              {.schedule = for_each_schedule::guided,
+                               .grain_size = grain_size},
+                              [&](const std::size_t i) noexcept {
+                                 if (i >= processed_counts.size()) {
+                                    std::terminate();
+                                 }
+
+                                 std::atomic_ref<int>{processed_counts[i]}.fetch_add(1);
+                              });
+
+      REQUIRE(std::ranges::all_of(processed_counts,
+                                  [](const int value) { return value == 1; }));
+   }
+
+   thread_pool->for_each_n(task_priority::normal, 0, {.grain_size = 4},
+                           [&](const std::size_t) noexcept { std::terminate(); });
+}
+
+TEST_CASE("async thread_pool recycled task allocations", "[Async][ThreadPool]")
+{
+   auto thread_pool =
+      thread_pool::make({.thread_count = 1, .low_priority_thread_count = 1});
+
+   // Tasks are only released once a worker has popped them, wait_no_execute
+   // makes sure the worker has gotten to each task before we move on.
+   const auto exec_and_get = [&](const int i) {
+      task<int> task = thread_pool->exec(task_priority::normal, [i] { return i; });
+
+      task.wait_no_execute();
+
+      return task.get();
+   };
+
+   // Warm up the thread caches.
+   for (int i = 0; i < 256; ++i) exec_and_get(i);
+
+   const task_allocation_stats start_stats = get_task_allocation_stats();
+
+   for (int i = 0; i < 256; ++i) REQUIRE(exec_and_get(i) == i);
+
+   const task_allocation_stats end_stats = get_task_allocation_stats();
+
+   const std::size_t submitted_tasks =
+      end_stats.submitted_tasks - start_stats.submitted_tasks;
+   const std::size_t heap_allocations =
+      end_stats.heap_allocations - start_stats.heap_allocations;
+
+   REQUIRE(submitted_tasks >= 256);
+   REQUIRE(heap_allocations < submitted_tasks / 2);
+}
+
+TEST_CASE("async thread_pool stats", "[Async][ThreadPool]")
+{
+   auto thread_pool =
+      thread_pool::make({.thread_count = 1, .low_priority_thread_count = 1});
+
+   std::atomic_bool started = false;
+   std::atomic_bool release_worker = false;
+
+   task<void> blocking_task = thread_pool->exec(task_priority::normal, [&] {
+      started.store(true);
+
+      while (not release_worker.load()) std::this_thread::yield();
+   });
+
+   while (not started.load()) std::this_thread::yield();
+
+   task<int> queued_task = thread_pool->exec(task_priority::normal, [] { return 1; });
+
+   // The worker is busy, waiting on the queued task executes it directly.
+   REQUIRE(queued_task.get() == 1);
+   REQUIRE(thread_pool->stats(task_priority::normal).direct_executions == 1);
+   REQUIRE(thread_pool->stats(task_priority::low).direct_executions == 0);
+
+   release_worker.store(true);
+   blocking_task.wait();
+
+   thread_pool->set_timing_enabled(true);
+
+   for (int i = 0; i < 16; ++i) {
+      thread_pool->exec(task_priority::normal, [] {}).wait_no_execute();
+   }
+
+   thread_pool->set_timing_enabled(false);
+
+   // Workers update their counters after a task completes, the worker starting
+   // another task means it has finished with the previous one.
+   thread_pool->exec(task_priority::normal, [] {}).wait_no_execute();
+
+   const thread_pool_stats stats = thread_pool->stats(task_priority::normal);
+
+   REQUIRE(stats.thread_count == 1);
+   REQUIRE(stats.queued_tasks == 0);
+   REQUIRE(stats.executed_tasks == 18);
+   REQUIRE(stats.skipped_tasks == 1);
+   REQUIRE(stats.stolen_tasks == 0);
+   REQUIRE(stats.timed_tasks == 16);
+   REQUIRE(stats.timed_duration > 0ns);
+
+   REQUIRE(thread_pool->stats(task_priority::low).executed_tasks == 0);
+}
+
+TEST_CASE("async thread_pool trace", "[Async][ThreadPool]")
+{
+   auto thread_pool =
+      thread_pool::make({.thread_count = 1, .low_priority_thread_count = 1});
+
+   REQUIRE(thread_pool->end_trace().empty());
+
+   thread_pool->begin_trace();
+
+   thread_pool->exec(task_priority::low, [] {}).wait_no_execute();
+
+   for (int i = 0; i < 8; ++i) {
+      thread_pool->exec(task_priority::normal, [] {}).wait_no_execute();
+   }
+
+   // Workers record a task after it completes, the worker starting another task
+   // means the previous one has been recorded.
+   thread_pool->exec(task_priority::low, [] {}).wait_no_execute();
+   thread_pool->exec(task_priority::normal, [] {}).wait_no_execute();
+
+   const std::vector<task_trace_event> trace = thread_pool->end_trace();
+
+   REQUIRE(trace.size() >= 9);
+   REQUIRE(trace.size() <= 11);
+   REQUIRE(std::ranges::count(trace, task_priority::low, &task_trace_event::priority) >= 1);
+   REQUIRE(std::ranges::is_sorted(trace, {}, &task_trace_event::start_time));
+
+   for (const task_trace_event& event : trace) {
+      REQUIRE(event.queued_time <= event.start_time);
+      REQUIRE(event.start_time <= event.end_time);
+      REQUIRE(event.worker_index == 0);
+   }
+
+   thread_pool->exec(task_priority::normal, [] {}).wait_no_execute();
+
+   REQUIRE(thread_pool->end_trace().empty());
+}
+
 }
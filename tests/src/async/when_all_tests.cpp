@@ -0,0 +1,109 @@
+#include "pch.h"
+
+#include "async/when_all.hpp"
+
+#include <array>
+#include <latch>
+#include <vector>
+
+namespace we::async::tests {
+
+TEST_CASE("async when_all", "[Async][ThreadPool]")
+{
+   auto thread_pool =
+      thread_pool::make({.thread_count = 2, .low_priority_thread_count = 1});
+
+   task<int> task0 = thread_pool->exec(task_priority::normal, [] { return 1; });
+   task<int> task1 = thread_pool->exec(task_priority::normal, [] { return 2; });
+   task<void> task2 = thread_pool->exec(task_priority::normal, [] {});
+
+   task<void> all = when_all(task0, task1, task2);
+
+   all.get();
+
+   REQUIRE(task0.ready());
+   REQUIRE(task1.ready());
+   REQUIRE(task2.ready());
+
+   REQUIRE(task0.get() == 1);
+   REQUIRE(task1.get() == 2);
+   task2.get();
+}
+
+TEST_CASE("async when_all waits for every task", "[Async][ThreadPool]")
+{
+   auto thread_pool =
+      thread_pool::make({.thread_count = 2, .low_priority_thread_count = 1});
+
+   std::latch release{1};
+
+   task<int> fast = thread_pool->exec(task_priority::normal, [] { return 1; });
+   task<int> slow = thread_pool->exec(task_priority::normal, [&] {
+      release.wait();
+
+      return 2;
+   });
+
+   fast.wait();
+
+   task<void> all = when_all(fast, slow);
+
+   REQUIRE(not all.ready());
+
+   release.count_down();
+
+   all.wait();
+
+   REQUIRE(slow.get() == 2);
+   REQUIRE(fast.get() == 1);
+}
+
+TEST_CASE("async when_all range", "[Async][ThreadPool]")
+{
+   auto thread_pool =
+      thread_pool::make({.thread_count = 2, .low_priority_thread_count = 1});
+
+   std::vector<task<int>> tasks;
+
+   for (int i = 0; i < 32; ++i) {
+      tasks.emplace_back(thread_pool->exec(task_priority::normal, [i] { return i; }));
+   }
+
+   when_all(tasks).wait();
+
+   for (int i = 0; i < 32; ++i) {
+      REQUIRE(tasks[i].ready());
+      REQUIRE(tasks[i].get() == i);
+   }
+}
+
+TEST_CASE("async when_all empty range", "[Async][ThreadPool]")
+{
+   std::vector<task<int>> tasks;
+
+   REQUIRE(when_all(tasks).ready());
+}
+
+TEST_CASE("async when_all canceled", "[Async][ThreadPool]")
+{
+   auto thread_pool =
+      thread_pool::make({.thread_count = 1, .low_priority_thread_count = 1});
+
+   std::latch release{1};
+
+   task<void> blocker =
+      thread_pool->exec(task_priority::normal, [&] { release.wait(); });
+   task<int> canceled = thread_pool->exec(task_priority::normal, [] { return 1; });
+
+   task<void> all = when_all(blocker, canceled);
+
+   canceled.cancel();
+
+   release.count_down();
+
+   all.get();
+
+   REQUIRE(blocker.ready());
+}
+
+}
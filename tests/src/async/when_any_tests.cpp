@@ -0,0 +1,70 @@
+#include "pch.h"
+
+#include "async/when_any.hpp"
+
+#include <latch>
+#include <vector>
+
+namespace we::async::tests {
+
+TEST_CASE("async when_any", "[Async][ThreadPool]")
+{
+   auto thread_pool =
+      thread_pool::make({.thread_count = 2, .low_priority_thread_count = 1});
+
+   std::latch release{1};
+
+   task<int> slow = thread_pool->exec(task_priority::normal, [&] {
+      release.wait();
+
+      return 1;
+   });
+   task<int> fast = thread_pool->exec(task_priority::normal, [] { return 2; });
+
+   task<std::size_t> any = when_any(slow, fast);
+
+   REQUIRE(any.get() == 1);
+   REQUIRE(fast.get() == 2);
+   REQUIRE(not slow.ready());
+
+   release.count_down();
+
+   REQUIRE(slow.get() == 1);
+}
+
+TEST_CASE("async when_any range", "[Async][ThreadPool]")
+{
+   auto thread_pool =
+      thread_pool::make({.thread_count = 2, .low_priority_thread_count = 1});
+
+   std::latch release{1};
+
+   std::vector<task<int>> tasks;
+
+   tasks.emplace_back(thread_pool->exec(task_priority::normal, [&] {
+      release.wait();
+
+      return 0;
+   }));
+   tasks.emplace_back(thread_pool->exec(task_priority::normal, [] { return 1; }));
+
+   task<std::size_t> any = when_any(tasks);
+
+   REQUIRE(any.get() == 1);
+
+   release.count_down();
+
+   REQUIRE(tasks[0].get() == 0);
+}
+
+TEST_CASE("async when_any empty range", "[Async][ThreadPool]")
+{
+   std::vector<task<int>> tasks;
+
+   task<std::size_t> any = when_any(tasks);
+
+   REQUIRE(any.ready());
+   REQUIRE(any.get() == 0);
+}
+
+}
@@ -249,6 +249,40 @@ TEST_CASE("edits set_creation_path_node_location", "[Edits]")
    REQUIRE(edit_context.euler_rotation == float3{0.0f, 0.0f, 0.0f});
 }
 
+TEST_CASE("edits set_value dirty files", "[Edits]")
+{
+   world::world world = test_world;
+   world::interaction_targets interaction_targets;
+   world::edit_context edit_context{world, interaction_targets.creation_entity};
+
+   world.dirty_files.mark_saved("temp/world/test.wld", {});
+
+   auto edit = make_set_value(&world.objects[0].layer, int8{1});
+
+   edit->apply(edit_context);
+
+   CHECK(world.dirty_files.is_dirty(world::layer_file::objects, 0));
+   CHECK(world.dirty_files.is_dirty(world::layer_file::objects, 1));
+   CHECK(not world.dirty_files.is_dirty(world::layer_file::objects, 2));
+   CHECK(not world.dirty_files.is_dirty(world::layer_file::lights, 0));
+   CHECK(not world.dirty_files.is_dirty(world::world_file::terrain));
+
+   world.dirty_files.mark_saved("temp/world/test.wld", {});
+
+   edit->revert(edit_context);
+
+   CHECK(world.dirty_files.is_dirty(world::layer_file::objects, 0));
+   CHECK(world.dirty_files.is_dirty(world::layer_file::objects, 1));
+
+   world.dirty_files.mark_saved("temp/world/test.wld", {});
+
+   make_set_path_node_property_value(&world.paths[0].nodes, 0, 0, "NewValue")
+      ->apply(edit_context);
+
+   CHECK(world.dirty_files.is_dirty(world::layer_file::paths, 0));
+   CHECK(not world.dirty_files.is_dirty(world::layer_file::objects, 0));
+}
+
 TEST_CASE("edits set_memory_value coalesce", "[Edits]")
 {
    world::world world = test_world;
@@ -0,0 +1,332 @@
+#include "pch.h"
+
+#include "async/thread_pool.hpp"
+#include "math/bvh.hpp"
+#include "math/vector_funcs.hpp"
+
+#include <cmath>
+#include <numbers>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace we::math::tests {
+
+namespace {
+
+constexpr std::size_t benchmark_thread_count = 8;
+constexpr int32 benchmark_grid_size = 128;
+constexpr int32 benchmark_build_grid_size = 256;
+constexpr int32 benchmark_instance_grid_size = 96;
+constexpr int32 benchmark_sample_points = 4096;
+constexpr int32 benchmark_ao_sample_count = 32;
+
+struct benchmark_mesh {
+   std::vector<std::array<uint16, 3>> indices;
+   std::vector<float3> positions;
+};
+
+auto get_height(const float x, const float z) noexcept -> float
+{
+   return std::sin(x * 0.2f) * std::cos(z * 0.15f) * 6.0f + std::sin(z * 0.7f);
+}
+
+auto make_benchmark_heightfield(const int32 grid_size = benchmark_grid_size)
+   -> benchmark_mesh
+{
+   benchmark_mesh mesh;
+
+   for (int32 z = 0; z < grid_size; ++z) {
+      for (int32 x = 0; x < grid_size; ++x) {
+         mesh.positions.push_back({static_cast<float>(x),
+                                   get_height(static_cast<float>(x),
+                                              static_cast<float>(z)),
+                                   static_cast<float>(z)});
+      }
+   }
+
+   for (int32 z = 0; z < grid_size - 1; ++z) {
+      for (int32 x = 0; x < grid_size - 1; ++x) {
+         const uint16 i0 = static_cast<uint16>(z * grid_size + x);
+         const uint16 i1 = static_cast<uint16>(i0 + 1);
+         const uint16 i2 = static_cast<uint16>(i0 + grid_size);
+         const uint16 i3 = static_cast<uint16>(i2 + 1);
+
+         mesh.indices.push_back({i0, i2, i1});
+         mesh.indices.push_back({i1, i2, i3});
+      }
+   }
+
+   return mesh;
+}
+
+/// @brief Make the ambient occlusion rays the terrain light map baker would trace, a
+/// cosine weighted hemisphere of rays above sample points on the terrain.
+auto make_ao_rays() -> std::vector<bvh::ray>
+{
+   std::mt19937 random{1337};
+   std::uniform_real_distribution<float> position_distribution{
+      0.0f, static_cast<float>(benchmark_grid_size - 1)};
+   std::uniform_real_distribution<float> unorm_distribution{0.0f, 1.0f};
+
+   std::vector<bvh::ray> rays;
+   rays.reserve(benchmark_sample_points * benchmark_ao_sample_count);
+
+   for (int32 point = 0; point < benchmark_sample_points; ++point) {
+      const float x = position_distribution(random);
+      const float z = position_distribution(random);
+      const float3 positionWS = {x, get_height(x, z), z};
+
+      for (int32 i = 0; i < benchmark_ao_sample_count; ++i) {
+         const float radius = std::sqrt(unorm_distribution(random));
+         const float theta = 2.0f * std::numbers::pi_v<float> * unorm_distribution(random);
+
+         const float3 directionWS =
+            normalize(float3{radius * std::cos(theta),
+                             std::sqrt(std::max(1.0f - radius * radius, 0.0f)),
+                             radius * std::sin(theta)});
+
+         rays.push_back({.origin = positionWS + directionWS * 0.001f,
+                         .direction = directionWS});
+      }
+   }
+
+   return rays;
+}
+
+}
+
+TEST_CASE("bvh ambient occlusion raycast benchmark", "[Math][BVH][Benchmark][.]")
+{
+   const benchmark_mesh mesh = make_benchmark_heightfield();
+   const bvh bvh{mesh.indices, mesh.positions, {.backface_cull = false}};
+
+   const std::array<top_level_bvh::instance, 1> instances = {
+      top_level_bvh::instance{.bvh = &bvh},
+   };
+
+   const top_level_bvh top_level_bvh{instances};
+
+   const std::vector<bvh::ray> rays = make_ao_rays();
+   std::vector<std::optional<float>> hits(rays.size());
+
+   const bvh_ray_flags flags = {.allow_backface_cull = false, .accept_first_hit = true};
+
+   BENCHMARK("raycast")
+   {
+      int32 occluded = 0;
+
+      for (const bvh::ray& ray : rays) {
+         if (top_level_bvh.raycast(ray.origin, ray.direction, ray.max_distance, flags)) {
+            occluded += 1;
+         }
+      }
+
+      return occluded;
+   };
+
+   BENCHMARK("raycast_batch")
+   {
+      top_level_bvh.raycast_batch(rays, hits, flags);
+
+      int32 occluded = 0;
+
+      for (const std::optional<float>& hit : hits) {
+         if (hit) occluded += 1;
+      }
+
+      return occluded;
+   };
+}
+
+TEST_CASE("bvh compressed nodes benchmark", "[Math][BVH][Benchmark][.]")
+{
+   const benchmark_mesh mesh = make_benchmark_heightfield();
+   const bvh uncompressed_bvh{mesh.indices, mesh.positions,
+                              {.backface_cull = false, .compressed = false}};
+   const bvh compressed_bvh{mesh.indices, mesh.positions,
+                            {.backface_cull = false, .compressed = true}};
+
+   WARN("uncompressed memory usage: " << uncompressed_bvh.memory_usage() << " bytes");
+   WARN("compressed memory usage: " << compressed_bvh.memory_usage() << " bytes");
+
+   const std::vector<bvh::ray> rays = make_ao_rays();
+   std::vector<std::optional<bvh::ray_hit>> hits(rays.size());
+
+   const bvh_ray_flags flags = {.allow_backface_cull = false, .accept_first_hit = true};
+
+   for (const auto& [name, tested_bvh] : {std::pair{"uncompressed", &uncompressed_bvh},
+                                         std::pair{"compressed", &compressed_bvh}}) {
+      BENCHMARK(std::string{name} + " raycast")
+      {
+         int32 occluded = 0;
+
+         for (const bvh::ray& ray : rays) {
+            if (tested_bvh->raycast(ray.origin, ray.direction, ray.max_distance, flags)) {
+               occluded += 1;
+            }
+         }
+
+         return occluded;
+      };
+
+      BENCHMARK(std::string{name} + " raycast_batch")
+      {
+         tested_bvh->raycast_batch(rays, hits, flags);
+
+         int32 occluded = 0;
+
+         for (const std::optional<bvh::ray_hit>& hit : hits) {
+            if (hit) occluded += 1;
+         }
+
+         return occluded;
+      };
+   }
+}
+
+TEST_CASE("bvh build benchmark", "[Math][BVH][Benchmark][.]")
+{
+   auto thread_pool = async::thread_pool::make({.thread_count = benchmark_thread_count,
+                                                .low_priority_thread_count = 1});
+
+   const benchmark_mesh mesh = make_benchmark_heightfield(benchmark_build_grid_size);
+
+   BENCHMARK("bvh serial")
+   {
+      return bvh{mesh.indices, mesh.positions, {}};
+   };
+
+   BENCHMARK("bvh parallel")
+   {
+      return bvh{mesh.indices, mesh.positions, {}, *thread_pool,
+                 async::task_priority::normal};
+   };
+
+   const benchmark_mesh instance_mesh = make_benchmark_heightfield(16);
+   const bvh instance_bvh{instance_mesh.indices, instance_mesh.positions, {}};
+
+   std::vector<top_level_bvh::instance> instances;
+   instances.reserve(benchmark_instance_grid_size * benchmark_instance_grid_size);
+
+   for (int32 z = 0; z < benchmark_instance_grid_size; ++z) {
+      for (int32 x = 0; x < benchmark_instance_grid_size; ++x) {
+         const float3 position = {x * 20.0f, 0.0f, z * 20.0f};
+
+         instances.push_back({.inverse_position = -position,
+                              .bvh = &instance_bvh,
+                              .position = position});
+      }
+   }
+
+   BENCHMARK("top_level_bvh serial")
+   {
+      return top_level_bvh{instances};
+   };
+
+   BENCHMARK("top_level_bvh parallel")
+   {
+      return top_level_bvh{instances, *thread_pool, async::task_priority::normal};
+   };
+}
+
+TEST_CASE("dynamic_top_level_bvh benchmark", "[Math][BVH][Benchmark][.]")
+{
+   const benchmark_mesh instance_mesh = make_benchmark_heightfield(16);
+   const bvh instance_bvh{instance_mesh.indices, instance_mesh.positions, {}};
+
+   std::vector<top_level_bvh::instance> instances;
+   instances.reserve(benchmark_instance_grid_size * benchmark_instance_grid_size);
+
+   for (int32 z = 0; z < benchmark_instance_grid_size; ++z) {
+      for (int32 x = 0; x < benchmark_instance_grid_size; ++x) {
+         const float3 position = {x * 20.0f, 0.0f, z * 20.0f};
+
+         instances.push_back({.inverse_position = -position,
+                              .bvh = &instance_bvh,
+                              .position = position});
+      }
+   }
+
+   dynamic_top_level_bvh dynamic_bvh;
+
+   std::vector<dynamic_top_level_bvh::handle> handles;
+   handles.reserve(instances.size());
+
+   for (const top_level_bvh::instance& instance : instances) {
+      handles.push_back(dynamic_bvh.insert(instance));
+   }
+
+   // A frame of editing, a handful of objects being dragged across the world.
+   int32 frame = 0;
+
+   const auto move_instances = [&] {
+      frame += 1;
+
+      for (std::size_t i = 0; i < 16; ++i) {
+         const std::size_t index = (i * 577) % instances.size();
+
+         instances[index].position.x += frame % 2 == 0 ? 25.0f : -25.0f;
+         instances[index].inverse_position = -instances[index].position;
+      }
+   };
+
+   BENCHMARK("top_level_bvh rebuild")
+   {
+      move_instances();
+
+      return top_level_bvh{instances};
+   };
+
+   BENCHMARK("dynamic_top_level_bvh update")
+   {
+      move_instances();
+
+      for (std::size_t i = 0; i < 16; ++i) {
+         const std::size_t index = (i * 577) % instances.size();
+
+         dynamic_bvh.update(handles[index], instances[index]);
+      }
+
+      return dynamic_bvh.size();
+   };
+
+   const top_level_bvh static_bvh{instances};
+
+   std::mt19937 random{1337};
+   std::uniform_real_distribution<float> position_distribution{
+      0.0f, benchmark_instance_grid_size * 20.0f};
+
+   std::vector<bvh::ray> rays;
+
+   for (int32 i = 0; i < benchmark_sample_points; ++i) {
+      rays.push_back({.origin = {position_distribution(random), 32.0f,
+                                 position_distribution(random)},
+                      .direction = normalize(float3{0.2f, -1.0f, 0.1f})});
+   }
+
+   BENCHMARK("top_level_bvh raycast")
+   {
+      int32 hits = 0;
+
+      for (const bvh::ray& ray : rays) {
+         if (static_bvh.raycast(ray.origin, ray.direction, ray.max_distance)) hits += 1;
+      }
+
+      return hits;
+   };
+
+   BENCHMARK("dynamic_top_level_bvh raycast")
+   {
+      int32 hits = 0;
+
+      for (const bvh::ray& ray : rays) {
+         if (dynamic_bvh.raycast(ray.origin, ray.direction, ray.max_distance)) hits += 1;
+      }
+
+      return hits;
+   };
+}
+
+}
@@ -0,0 +1,744 @@
+#include "pch.h"
+
+#include "async/thread_pool.hpp"
+#include "math/bvh.hpp"
+#include "math/intersectors.hpp"
+#include "math/quaternion_funcs.hpp"
+#include "math/vector_funcs.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <tuple>
+#include <vector>
+
+namespace we::math::tests {
+
+namespace {
+
+constexpr int32 test_grid_size = 32;
+
+struct test_mesh {
+   std::vector<std::array<uint16, 3>> indices;
+   std::vector<float3> positions;
+};
+
+auto make_test_heightfield(const int32 grid_size = test_grid_size) -> test_mesh
+{
+   test_mesh mesh;
+
+   for (int32 z = 0; z < grid_size; ++z) {
+      for (int32 x = 0; x < grid_size; ++x) {
+         mesh.positions.push_back({static_cast<float>(x),
+                                   std::sin(x * 0.5f) * std::cos(z * 0.3f) * 4.0f,
+                                   static_cast<float>(z)});
+      }
+   }
+
+   for (int32 z = 0; z < grid_size - 1; ++z) {
+      for (int32 x = 0; x < grid_size - 1; ++x) {
+         const uint16 i0 = static_cast<uint16>(z * grid_size + x);
+         const uint16 i1 = static_cast<uint16>(i0 + 1);
+         const uint16 i2 = static_cast<uint16>(i0 + grid_size);
+         const uint16 i3 = static_cast<uint16>(i2 + 1);
+
+         mesh.indices.push_back({i0, i2, i1});
+         mesh.indices.push_back({i1, i2, i3});
+      }
+   }
+
+   return mesh;
+}
+
+auto make_test_rays(const std::size_t count, const float extent = test_grid_size)
+   -> std::vector<bvh::ray>
+{
+   std::mt19937 random{1337};
+   std::uniform_real_distribution<float> position_distribution{-4.0f, extent + 4.0f};
+   std::uniform_real_distribution<float> direction_distribution{-1.0f, 1.0f};
+
+   std::vector<bvh::ray> rays;
+   rays.reserve(count);
+
+   for (std::size_t i = 0; i < count; ++i) {
+      const float3 origin = {position_distribution(random),
+                             direction_distribution(random) * 8.0f,
+                             position_distribution(random)};
+      float3 direction = {direction_distribution(random), direction_distribution(random),
+                          direction_distribution(random)};
+
+      if (direction == float3{}) direction = {0.0f, -1.0f, 0.0f};
+
+      rays.push_back({.origin = origin,
+                      .direction = normalize(direction),
+                      .max_distance = i % 3 == 0 ? 16.0f : FLT_MAX});
+   }
+
+   return rays;
+}
+
+/// @brief Check two lists of boxes hold the same boxes, ignoring order.
+bool same_boxes(std::vector<math::bounding_box> left,
+                std::vector<math::bounding_box> right)
+{
+   const auto less = [](const math::bounding_box& l, const math::bounding_box& r) {
+      return std::tie(l.min.x, l.min.y, l.min.z, l.max.x, l.max.y, l.max.z) <
+             std::tie(r.min.x, r.min.y, r.min.z, r.max.x, r.max.y, r.max.z);
+   };
+
+   std::ranges::sort(left, less);
+   std::ranges::sort(right, less);
+
+   return std::ranges::equal(left, right,
+                             [](const math::bounding_box& l, const math::bounding_box& r) {
+                                return l.min == r.min and l.max == r.max;
+                             });
+}
+
+auto make_test_points(const std::size_t count) -> std::vector<float3>
+{
+   std::mt19937 random{1337};
+   std::uniform_real_distribution<float> position_distribution{-4.0f, test_grid_size + 4.0f};
+   std::uniform_real_distribution<float> height_distribution{-8.0f, 8.0f};
+
+   std::vector<float3> points;
+   points.reserve(count);
+
+   for (std::size_t i = 0; i < count; ++i) {
+      points.push_back({position_distribution(random), height_distribution(random),
+                        position_distribution(random)});
+   }
+
+   return points;
+}
+
+auto closest_point_brute_force(const test_mesh& mesh, const float3& point) -> float
+{
+   float closest_distance = FLT_MAX;
+
+   for (const auto& [i0, i1, i2] : mesh.indices) {
+      closest_distance =
+         std::min(closest_distance,
+                  distance(point, closest_point_on_tri(point, mesh.positions[i0],
+                                                       mesh.positions[i1],
+                                                       mesh.positions[i2])));
+   }
+
+   return closest_distance;
+}
+
+}
+
+TEST_CASE("bvh raycast_batch matches raycast", "[Math][BVH]")
+{
+   const test_mesh mesh = make_test_heightfield();
+   const bvh bvh{mesh.indices, mesh.positions, {.backface_cull = true}};
+
+   // An odd count so the last packet is partially filled.
+   const std::vector<bvh::ray> rays = make_test_rays(1001);
+
+   for (const bvh_ray_flags flags :
+        {bvh_ray_flags{}, bvh_ray_flags{.allow_backface_cull = false},
+         bvh_ray_flags{.allow_backface_cull = false, .accept_first_hit = true}}) {
+      std::vector<std::optional<bvh::ray_hit>> hits(rays.size());
+
+      bvh.raycast_batch(rays, hits, flags);
+
+      for (std::size_t i = 0; i < rays.size(); ++i) {
+         const std::optional<bvh::ray_hit> expected_hit =
+            bvh.raycast(rays[i].origin, rays[i].direction, rays[i].max_distance, flags);
+
+         REQUIRE(hits[i].has_value() == expected_hit.has_value());
+
+         // With accept_first_hit any hit is fine so only closest hits are compared.
+         if (expected_hit and not flags.accept_first_hit) {
+            REQUIRE(hits[i]->distance == expected_hit->distance);
+            REQUIRE(hits[i]->tri_index == expected_hit->tri_index);
+            REQUIRE(hits[i]->unnormalized_normal == expected_hit->unnormalized_normal);
+         }
+      }
+   }
+}
+
+TEST_CASE("top_level_bvh raycast_batch matches raycast", "[Math][BVH]")
+{
+   const test_mesh mesh = make_test_heightfield();
+   const bvh bvh{mesh.indices, mesh.positions, {.backface_cull = false}};
+
+   const float half_angle = 0.35f;
+   const quaternion rotation = {std::cos(half_angle), 0.0f, std::sin(half_angle), 0.0f};
+   const quaternion inverse_rotation = {std::cos(half_angle), 0.0f,
+                                        -std::sin(half_angle), 0.0f};
+   const float3 position = {8.0f, 2.0f, -6.0f};
+
+   const std::array<top_level_bvh::instance, 2> instances = {
+      top_level_bvh::instance{.bvh = &bvh},
+      top_level_bvh::instance{.inverse_rotation = inverse_rotation,
+                              .inverse_position = -(inverse_rotation * position),
+                              .bvh = &bvh,
+                              .rotation = rotation,
+                              .position = position},
+   };
+
+   const top_level_bvh top_level_bvh{instances};
+
+   const std::vector<bvh::ray> rays = make_test_rays(1001);
+
+   for (const bvh_ray_flags flags :
+        {bvh_ray_flags{}, bvh_ray_flags{.accept_first_hit = true}}) {
+      std::vector<std::optional<float>> hits(rays.size());
+
+      top_level_bvh.raycast_batch(rays, hits, flags);
+
+      for (std::size_t i = 0; i < rays.size(); ++i) {
+         const std::optional<float> expected_hit =
+            top_level_bvh.raycast(rays[i].origin, rays[i].direction,
+                                  rays[i].max_distance, flags);
+
+         REQUIRE(hits[i].has_value() == expected_hit.has_value());
+
+         if (expected_hit and not flags.accept_first_hit) {
+            REQUIRE(*hits[i] == *expected_hit);
+         }
+      }
+   }
+}
+
+TEST_CASE("bvh raycast_batch empty", "[Math][BVH]")
+{
+   const std::vector<bvh::ray> rays = make_test_rays(5);
+
+   std::vector<std::optional<bvh::ray_hit>> hits(rays.size(), bvh::ray_hit{});
+   std::vector<std::optional<float>> top_level_hits(rays.size(), 1.0f);
+
+   bvh{}.raycast_batch(rays, hits);
+   top_level_bvh{}.raycast_batch(rays, top_level_hits);
+
+   for (std::size_t i = 0; i < rays.size(); ++i) {
+      REQUIRE(not hits[i]);
+      REQUIRE(not top_level_hits[i]);
+   }
+}
+
+TEST_CASE("bvh parallel build matches serial build", "[Math][BVH]")
+{
+   auto thread_pool = async::thread_pool::make({.thread_count = 4,
+                                                .low_priority_thread_count = 1});
+
+   const int32 grid_size = 128;
+
+   const test_mesh mesh = make_test_heightfield(grid_size);
+   const bvh serial_bvh{mesh.indices, mesh.positions, {.backface_cull = true}};
+   const bvh parallel_bvh{mesh.indices, mesh.positions, {.backface_cull = true},
+                          *thread_pool, async::task_priority::normal};
+
+   REQUIRE(same_boxes(parallel_bvh.get_debug_boxes(), serial_bvh.get_debug_boxes()));
+
+   for (const bvh::ray& ray : make_test_rays(1000, grid_size)) {
+      const std::optional<bvh::ray_hit> serial_hit =
+         serial_bvh.raycast(ray.origin, ray.direction, ray.max_distance);
+      const std::optional<bvh::ray_hit> parallel_hit =
+         parallel_bvh.raycast(ray.origin, ray.direction, ray.max_distance);
+
+      REQUIRE(parallel_hit.has_value() == serial_hit.has_value());
+
+      if (serial_hit) {
+         REQUIRE(parallel_hit->distance == serial_hit->distance);
+         REQUIRE(parallel_hit->tri_index == serial_hit->tri_index);
+      }
+   }
+}
+
+TEST_CASE("top_level_bvh parallel build matches serial build", "[Math][BVH]")
+{
+   auto thread_pool = async::thread_pool::make({.thread_count = 4,
+                                                .low_priority_thread_count = 1});
+
+   const test_mesh mesh = make_test_heightfield(8);
+   const bvh bvh{mesh.indices, mesh.positions, {.backface_cull = false}};
+
+   const int32 instance_grid_size = 48;
+
+   std::vector<top_level_bvh::instance> instances;
+
+   for (int32 z = 0; z < instance_grid_size; ++z) {
+      for (int32 x = 0; x < instance_grid_size; ++x) {
+         const float half_angle = static_cast<float>(x * z) * 0.1f;
+         const quaternion rotation = {std::cos(half_angle), 0.0f,
+                                      std::sin(half_angle), 0.0f};
+         const quaternion inverse_rotation = {std::cos(half_angle), 0.0f,
+                                              -std::sin(half_angle), 0.0f};
+         const float3 position = {x * 10.0f, static_cast<float>((x + z) % 5),
+                                  z * 10.0f};
+
+         instances.push_back({.inverse_rotation = inverse_rotation,
+                              .inverse_position = -(inverse_rotation * position),
+                              .bvh = &bvh,
+                              .rotation = rotation,
+                              .position = position});
+      }
+   }
+
+   const top_level_bvh serial_bvh{instances};
+   const top_level_bvh parallel_bvh{instances, *thread_pool,
+                                    async::task_priority::normal};
+
+   REQUIRE(same_boxes(parallel_bvh.get_debug_boxes(), serial_bvh.get_debug_boxes()));
+
+   for (const bvh::ray& ray : make_test_rays(1000, instance_grid_size * 10.0f)) {
+      REQUIRE(parallel_bvh.raycast(ray.origin, ray.direction, ray.max_distance) ==
+              serial_bvh.raycast(ray.origin, ray.direction, ray.max_distance));
+   }
+}
+
+TEST_CASE("bvh serialize round trip", "[Math][BVH]")
+{
+   const test_mesh mesh = make_test_heightfield();
+
+   for (const bool compressed : {true, false}) {
+      const bvh original_bvh{mesh.indices, mesh.positions,
+                             {.backface_cull = true, .compressed = compressed}};
+
+      std::vector<std::byte> bytes(original_bvh.serialized_size());
+
+      original_bvh.serialize(bytes);
+
+      std::optional<bvh> loaded_bvh =
+         bvh::deserialize(bytes, mesh.indices, mesh.positions, {.backface_cull = true});
+
+      REQUIRE(loaded_bvh);
+      REQUIRE(loaded_bvh->memory_usage() == original_bvh.memory_usage());
+      REQUIRE(same_boxes(loaded_bvh->get_debug_boxes(), original_bvh.get_debug_boxes()));
+
+      for (const bvh::ray& ray : make_test_rays(1000)) {
+         const std::optional<bvh::ray_hit> expected_hit =
+            original_bvh.raycast(ray.origin, ray.direction, ray.max_distance);
+         const std::optional<bvh::ray_hit> hit =
+            loaded_bvh->raycast(ray.origin, ray.direction, ray.max_distance);
+
+         REQUIRE(hit.has_value() == expected_hit.has_value());
+
+         if (expected_hit) {
+            REQUIRE(hit->distance == expected_hit->distance);
+            REQUIRE(hit->tri_index == expected_hit->tri_index);
+         }
+      }
+   }
+}
+
+TEST_CASE("bvh deserialize rejects invalid input", "[Math][BVH]")
+{
+   const test_mesh mesh = make_test_heightfield();
+   const bvh original_bvh{mesh.indices, mesh.positions, {.backface_cull = true}};
+
+   std::vector<std::byte> bytes(original_bvh.serialized_size());
+
+   original_bvh.serialize(bytes);
+
+   // Truncated bytes.
+   REQUIRE(not bvh::deserialize(std::span{bytes}.first(bytes.size() - 1), mesh.indices,
+                                mesh.positions, {}));
+   REQUIRE(not bvh::deserialize({}, mesh.indices, mesh.positions, {}));
+
+   // Serialized for a different mesh.
+   REQUIRE(not bvh::deserialize(bytes, std::span{mesh.indices}.first(mesh.indices.size() - 1),
+                                mesh.positions, {}));
+
+   // Unknown version.
+   std::vector<std::byte> bad_version_bytes = bytes;
+   bad_version_bytes[0] = std::byte{0xff};
+
+   REQUIRE(not bvh::deserialize(bad_version_bytes, mesh.indices, mesh.positions, {}));
+}
+
+TEST_CASE("bvh serialize empty", "[Math][BVH]")
+{
+   const bvh empty_bvh;
+
+   std::vector<std::byte> bytes(empty_bvh.serialized_size());
+
+   empty_bvh.serialize(bytes);
+
+   std::optional<bvh> loaded_bvh = bvh::deserialize(bytes, {}, {}, {});
+
+   REQUIRE(loaded_bvh);
+   REQUIRE(not loaded_bvh->raycast({0.0f, 1.0f, 0.0f}, {0.0f, -1.0f, 0.0f}, FLT_MAX));
+}
+
+TEST_CASE("bvh refit matches rebuild", "[Math][BVH]")
+{
+   const test_mesh mesh = make_test_heightfield();
+   bvh refit_bvh{mesh.indices, mesh.positions, {.backface_cull = true}};
+
+   // Stretch the heightfield vertically, moving every vertex but keeping the triangles.
+   std::vector<float3> moved_positions = mesh.positions;
+
+   for (float3& position : moved_positions) position.y *= 1.5f;
+
+   REQUIRE(refit_bvh.refit(moved_positions));
+
+   const bvh rebuilt_bvh{mesh.indices, moved_positions, {.backface_cull = true}};
+
+   for (const bvh::ray& ray : make_test_rays(1000)) {
+      const std::optional<bvh::ray_hit> expected_hit =
+         rebuilt_bvh.raycast(ray.origin, ray.direction, ray.max_distance);
+      const std::optional<bvh::ray_hit> hit =
+         refit_bvh.raycast(ray.origin, ray.direction, ray.max_distance);
+
+      REQUIRE(hit.has_value() == expected_hit.has_value());
+
+      if (expected_hit) {
+         REQUIRE(hit->distance == expected_hit->distance);
+         REQUIRE(hit->tri_index == expected_hit->tri_index);
+      }
+   }
+}
+
+TEST_CASE("bvh refit reports degraded quality", "[Math][BVH]")
+{
+   const test_mesh mesh = make_test_heightfield();
+   bvh bvh{mesh.indices, mesh.positions, {.backface_cull = true}};
+
+   // Scatter the vertices so the triangles in each leaf are no longer near each other.
+   std::vector<float3> scattered_positions = mesh.positions;
+
+   std::mt19937 random{1337};
+   std::shuffle(scattered_positions.begin(), scattered_positions.end(), random);
+
+   REQUIRE(not bvh.refit(scattered_positions));
+}
+
+TEST_CASE("bvh copy", "[Math][BVH]")
+{
+   const test_mesh mesh = make_test_heightfield();
+   const bvh original_bvh{mesh.indices, mesh.positions, {.backface_cull = true}};
+
+   const test_mesh mesh_copy = mesh;
+   const bvh copied_bvh = original_bvh.copy(mesh_copy.indices, mesh_copy.positions);
+
+   REQUIRE(same_boxes(copied_bvh.get_debug_boxes(), original_bvh.get_debug_boxes()));
+
+   for (const bvh::ray& ray : make_test_rays(100)) {
+      const std::optional<bvh::ray_hit> expected_hit =
+         original_bvh.raycast(ray.origin, ray.direction, ray.max_distance);
+      const std::optional<bvh::ray_hit> hit =
+         copied_bvh.raycast(ray.origin, ray.direction, ray.max_distance);
+
+      REQUIRE(hit.has_value() == expected_hit.has_value());
+
+      if (expected_hit) REQUIRE(hit->distance == expected_hit->distance);
+   }
+}
+
+TEST_CASE("bvh compressed matches uncompressed", "[Math][BVH]")
+{
+   const test_mesh mesh = make_test_heightfield();
+   const bvh compressed_bvh{mesh.indices, mesh.positions,
+                            {.backface_cull = true, .compressed = true}};
+   const bvh uncompressed_bvh{mesh.indices, mesh.positions,
+                              {.backface_cull = true, .compressed = false}};
+
+   REQUIRE(compressed_bvh.memory_usage() < uncompressed_bvh.memory_usage());
+
+   for (const bvh::ray& ray : make_test_rays(1000)) {
+      const std::optional<bvh::ray_hit> expected_hit =
+         uncompressed_bvh.raycast(ray.origin, ray.direction, ray.max_distance);
+      const std::optional<bvh::ray_hit> hit =
+         compressed_bvh.raycast(ray.origin, ray.direction, ray.max_distance);
+
+      REQUIRE(hit.has_value() == expected_hit.has_value());
+
+      // Triangles sharing an edge can both be hit at the same distance so only the distance is
+      // compared.
+      if (expected_hit) REQUIRE(hit->distance == expected_hit->distance);
+   }
+}
+
+TEST_CASE("bvh closest_point matches brute force", "[Math][BVH]")
+{
+   const test_mesh mesh = make_test_heightfield();
+
+   for (const bool compressed : {false, true}) {
+      const bvh bvh{mesh.indices, mesh.positions, {.compressed = compressed}};
+
+      for (const float3& point : make_test_points(500)) {
+         const float expected_distance = closest_point_brute_force(mesh, point);
+
+         const std::optional<bvh::point_hit> hit = bvh.closest_point(point);
+
+         REQUIRE(hit);
+         REQUIRE(hit->distance == Approx(expected_distance).margin(1e-4f));
+         REQUIRE(distance(hit->point, point) == Approx(hit->distance).margin(1e-4f));
+
+         const auto& [i0, i1, i2] = mesh.indices[hit->tri_index];
+
+         REQUIRE(distance(closest_point_on_tri(point, mesh.positions[i0],
+                                               mesh.positions[i1], mesh.positions[i2]),
+                          point) == Approx(hit->distance).margin(1e-4f));
+
+         const std::optional<bvh::point_hit> limited_hit =
+            bvh.closest_point(point, expected_distance * 0.5f);
+
+         if (expected_distance > 1e-3f) REQUIRE(not limited_hit);
+      }
+   }
+
+   REQUIRE(not bvh{}.closest_point({}));
+}
+
+TEST_CASE("bvh overlaps matches brute force", "[Math][BVH]")
+{
+   const test_mesh mesh = make_test_heightfield();
+
+   const quaternion rotation =
+      normalize(quaternion{std::cos(0.4f), std::sin(0.4f) * 0.3f, std::sin(0.4f), 0.0f});
+
+   for (const bool compressed : {false, true}) {
+      const bvh bvh{mesh.indices, mesh.positions, {.compressed = compressed}};
+
+      for (const float3& point : make_test_points(200)) {
+         const bvh::sphere sphere{.position = point, .radius = 2.5f};
+         const bvh::oriented_box box{.rotation = rotation,
+                                     .position = point,
+                                     .bbox = {.min = {-3.0f, -1.0f, -2.0f},
+                                              .max = {3.0f, 1.0f, 2.0f}}};
+         const quaternion inverse_rotation = conjugate(rotation);
+
+         std::vector<uint32> expected_sphere_tris;
+         std::vector<uint32> expected_box_tris;
+
+         for (uint32 tri_index = 0; tri_index < mesh.indices.size(); ++tri_index) {
+            const auto& [i0, i1, i2] = mesh.indices[tri_index];
+            const float3 v0 = mesh.positions[i0];
+            const float3 v1 = mesh.positions[i1];
+            const float3 v2 = mesh.positions[i2];
+
+            if (distance(closest_point_on_tri(point, v0, v1, v2), point) <= sphere.radius) {
+               expected_sphere_tris.push_back(tri_index);
+            }
+
+            if (intersects_aabb_tri(box.bbox, inverse_rotation * (v0 - box.position),
+                                    inverse_rotation * (v1 - box.position),
+                                    inverse_rotation * (v2 - box.position))) {
+               expected_box_tris.push_back(tri_index);
+            }
+         }
+
+         std::vector<uint32> sphere_tris = bvh.overlaps(sphere);
+         std::vector<uint32> box_tris = bvh.overlaps(box);
+
+         std::ranges::sort(sphere_tris);
+         std::ranges::sort(box_tris);
+
+         REQUIRE(sphere_tris == expected_sphere_tris);
+         REQUIRE(box_tris == expected_box_tris);
+      }
+   }
+}
+
+TEST_CASE("intersects_aabb_tri", "[Math][BVH]")
+{
+   const math::bounding_box bbox{.min = {-1.0f, -1.0f, -1.0f}, .max = {1.0f, 1.0f, 1.0f}};
+
+   // Inside, crossing a face and covering the box with a large triangle.
+   REQUIRE(intersects_aabb_tri(bbox, {0.0f, 0.0f, 0.0f}, {0.5f, 0.0f, 0.0f},
+                               {0.0f, 0.5f, 0.0f}));
+   REQUIRE(intersects_aabb_tri(bbox, {0.0f, 0.0f, 0.0f}, {4.0f, 0.0f, 0.0f},
+                               {0.0f, 4.0f, 0.0f}));
+   REQUIRE(intersects_aabb_tri(bbox, {-10.0f, 0.0f, -10.0f}, {10.0f, 0.0f, -10.0f},
+                               {0.0f, 0.0f, 10.0f}));
+
+   // Outside on one axis and outside only along the triangle's normal.
+   REQUIRE(not intersects_aabb_tri(bbox, {2.0f, 0.0f, 0.0f}, {3.0f, 0.0f, 0.0f},
+                                   {2.0f, 1.0f, 0.0f}));
+   REQUIRE(not intersects_aabb_tri(bbox, {3.5f, 0.0f, 0.0f}, {0.0f, 3.5f, 0.0f},
+                                   {0.0f, 0.0f, 3.5f}));
+}
+
+TEST_CASE("top_level_bvh closest_point and overlaps", "[Math][BVH]")
+{
+   const test_mesh mesh = make_test_heightfield();
+   const bvh bvh{mesh.indices, mesh.positions, {}};
+
+   const float half_angle = 0.35f;
+   const quaternion rotation = {std::cos(half_angle), 0.0f, std::sin(half_angle), 0.0f};
+   const quaternion inverse_rotation = {std::cos(half_angle), 0.0f,
+                                        -std::sin(half_angle), 0.0f};
+   const float3 position = {8.0f, 2.0f, -6.0f};
+
+   const std::array<top_level_bvh::instance, 2> instances = {
+      top_level_bvh::instance{.bvh = &bvh},
+      top_level_bvh::instance{.inverse_rotation = inverse_rotation,
+                              .inverse_position = -(inverse_rotation * position),
+                              .bvh = &bvh,
+                              .rotation = rotation,
+                              .position = position},
+   };
+
+   const top_level_bvh top_level_bvh{instances};
+
+   for (const float3& pointWS : make_test_points(200)) {
+      float expected_distance = FLT_MAX;
+      std::size_t expected_sphere_tris = 0;
+
+      const bvh::sphere sphereWS{.position = pointWS, .radius = 2.5f};
+
+      for (const top_level_bvh::instance& instance : instances) {
+         const float3 pointIS = instance.inverse_rotation * pointWS + instance.inverse_position;
+
+         expected_distance =
+            std::min(expected_distance, closest_point_brute_force(mesh, pointIS));
+         expected_sphere_tris +=
+            bvh.overlaps(bvh::sphere{.position = pointIS, .radius = sphereWS.radius})
+               .size();
+      }
+
+      const std::optional<top_level_bvh::point_hit> hit =
+         top_level_bvh.closest_point(pointWS);
+
+      REQUIRE(hit);
+      REQUIRE(hit->distance == Approx(expected_distance).margin(1e-4f));
+      REQUIRE(distance(hit->pointWS, pointWS) == Approx(hit->distance).margin(1e-3f));
+
+      REQUIRE(top_level_bvh.overlaps(sphereWS).size() == expected_sphere_tris);
+   }
+
+   REQUIRE(not we::top_level_bvh{}.closest_point({}));
+}
+
+TEST_CASE("dynamic_top_level_bvh matches top_level_bvh", "[Math][BVH]")
+{
+   const test_mesh mesh = make_test_heightfield(8);
+   const bvh bvh{mesh.indices, mesh.positions, {.backface_cull = false}};
+   const we::bvh empty_bvh;
+
+   std::mt19937 random{1337};
+   std::uniform_real_distribution<float> position_distribution{-64.0f, 64.0f};
+   std::uniform_real_distribution<float> angle_distribution{-3.14f, 3.14f};
+
+   const auto make_instance = [&] {
+      const float half_angle = angle_distribution(random) * 0.5f;
+      const quaternion rotation = {std::cos(half_angle), 0.0f, std::sin(half_angle), 0.0f};
+      const quaternion inverse_rotation = conjugate(rotation);
+      const float3 position = {position_distribution(random),
+                               position_distribution(random) * 0.1f,
+                               position_distribution(random)};
+
+      return top_level_bvh::instance{.inverse_rotation = inverse_rotation,
+                                     .inverse_position = -(inverse_rotation * position),
+                                     .bvh = &bvh,
+                                     .rotation = rotation,
+                                     .position = position};
+   };
+
+   dynamic_top_level_bvh dynamic_bvh;
+
+   std::vector<std::pair<dynamic_top_level_bvh::handle, top_level_bvh::instance>> live;
+
+   for (int32 i = 0; i < 256; ++i) {
+      const top_level_bvh::instance instance = make_instance();
+
+      live.emplace_back(dynamic_bvh.insert(instance), instance);
+   }
+
+   const auto empty_handle = dynamic_bvh.insert({.bvh = &empty_bvh});
+
+   // Shuffle the tree around with a mix of removes, moves and inserts.
+   for (int32 i = 0; i < 512; ++i) {
+      const std::size_t index = random() % live.size();
+
+      switch (i % 3) {
+      case 0: {
+         dynamic_bvh.remove(live[index].first);
+
+         live.erase(live.begin() + index);
+      } break;
+      case 1: {
+         // Alternate between small moves that stay in the instance's enlarged bounds and large
+         // moves that don't.
+         top_level_bvh::instance instance = live[index].second;
+
+         if (i % 2 == 0) {
+            instance.position += float3{0.01f, 0.0f, 0.01f};
+            instance.inverse_position = -(instance.inverse_rotation * instance.position);
+         }
+         else {
+            instance = make_instance();
+         }
+
+         dynamic_bvh.update(live[index].first, instance);
+
+         live[index].second = instance;
+      } break;
+      case 2: {
+         const top_level_bvh::instance instance = make_instance();
+
+         live.emplace_back(dynamic_bvh.insert(instance), instance);
+      } break;
+      }
+   }
+
+   REQUIRE(dynamic_bvh.size() == live.size() + 1);
+   REQUIRE(dynamic_bvh.get_debug_boxes().size() == live.size() * 2 - 1);
+
+   std::vector<top_level_bvh::instance> instances;
+
+   for (const auto& [handle, instance] : live) instances.push_back(instance);
+
+   const top_level_bvh static_bvh{instances};
+
+   for (const bvh::ray& ray : make_test_rays(1000, 64.0f)) {
+      const std::optional<float> expected_hit =
+         static_bvh.raycast(ray.origin, ray.direction, ray.max_distance);
+      const std::optional<dynamic_top_level_bvh::ray_hit> hit =
+         dynamic_bvh.raycast(ray.origin, ray.direction, ray.max_distance);
+
+      REQUIRE(hit.has_value() == expected_hit.has_value());
+
+      if (hit) {
+         REQUIRE(hit->distance == *expected_hit);
+         REQUIRE(hit->instance != empty_handle);
+
+         const std::optional<dynamic_top_level_bvh::ray_hit> filtered_hit =
+            dynamic_bvh.raycast(ray.origin, ray.direction, ray.max_distance,
+                                [&](const dynamic_top_level_bvh::handle handle) noexcept {
+                                   return handle != hit->instance;
+                                });
+
+         if (filtered_hit) {
+            REQUIRE(filtered_hit->instance != hit->instance);
+            REQUIRE(filtered_hit->distance >= hit->distance);
+         }
+      }
+
+      REQUIRE(not dynamic_bvh.raycast(ray.origin, ray.direction, ray.max_distance,
+                                      [](const dynamic_top_level_bvh::handle) noexcept {
+                                         return false;
+                                      }));
+   }
+
+   for (const float3& pointWS : make_test_points(200)) {
+      const std::optional<top_level_bvh::point_hit> expected_hit =
+         static_bvh.closest_point(pointWS);
+      const std::optional<dynamic_top_level_bvh::point_hit> hit =
+         dynamic_bvh.closest_point(pointWS);
+
+      REQUIRE(hit.has_value() == expected_hit.has_value());
+
+      if (hit) REQUIRE(hit->distance == Approx(expected_hit->distance));
+
+      const bvh::sphere sphereWS{.position = pointWS, .radius = 4.0f};
+
+      REQUIRE(dynamic_bvh.overlaps(sphereWS).size() == static_bvh.overlaps(sphereWS).size());
+   }
+
+   for (const auto& [handle, instance] : live) dynamic_bvh.remove(handle);
+
+   dynamic_bvh.remove(empty_handle);
+
+   REQUIRE(dynamic_bvh.size() == 0);
+   REQUIRE(dynamic_bvh.get_debug_boxes().empty());
+   REQUIRE(not dynamic_bvh.raycast({0.0f, 8.0f, 0.0f}, {0.0f, -1.0f, 0.0f}, FLT_MAX));
+}
+
+}
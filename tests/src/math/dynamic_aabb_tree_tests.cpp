@@ -0,0 +1,187 @@
+#include "pch.h"
+
+#include "math/dynamic_aabb_tree.hpp"
+#include "math/intersectors.hpp"
+#include "math/vector_funcs.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <optional>
+#include <random>
+#include <tuple>
+#include <vector>
+
+namespace we::tests {
+
+namespace {
+
+auto make_random_box(std::mt19937& random) -> math::bounding_box
+{
+   std::uniform_real_distribution<float> position_dist{-64.0f, 64.0f};
+   std::uniform_real_distribution<float> size_dist{0.25f, 4.0f};
+
+   const float3 position{position_dist(random), position_dist(random),
+                         position_dist(random)};
+   const float3 size{size_dist(random), size_dist(random), size_dist(random)};
+
+   return {.min = position - size, .max = position + size};
+}
+
+bool overlaps(const math::bounding_box& a, const math::bounding_box& b) noexcept
+{
+   return a.min.x <= b.max.x and a.max.x >= b.min.x and a.min.y <= b.max.y and
+          a.max.y >= b.min.y and a.min.z <= b.max.z and a.max.z >= b.min.z;
+}
+
+auto brute_force_raycast(const std::vector<math::bounding_box>& boxes,
+                         const std::vector<bool>& live, const float3& ray_origin,
+                         const float3& ray_direction) -> std::optional<uint32>
+{
+   std::optional<uint32> closest;
+   float closest_distance = std::numeric_limits<float>::max();
+
+   for (uint32 i = 0; i < boxes.size(); ++i) {
+      if (not live[i]) continue;
+
+      if (float distance = 0.0f;
+          intersect_aabb(ray_origin, 1.0f / ray_direction, boxes[i], closest_distance,
+                         distance) and
+          distance < closest_distance) {
+         closest = i;
+         closest_distance = distance;
+      }
+   }
+
+   return closest;
+}
+
+}
+
+TEST_CASE("dynamic_aabb_tree insert, move and remove", "[Math][DynamicAABBTree]")
+{
+   std::mt19937 random{0x5eed};
+
+   dynamic_aabb_tree tree;
+
+   std::vector<math::bounding_box> boxes;
+   std::vector<int32> leaves;
+   std::vector<bool> live;
+
+   for (uint32 i = 0; i < 512; ++i) {
+      boxes.push_back(make_random_box(random));
+      leaves.push_back(tree.insert(boxes.back(), i));
+      live.push_back(true);
+   }
+
+   REQUIRE(tree.size() == 512);
+
+   for (uint32 i = 0; i < 512; i += 3) {
+      tree.remove(leaves[i]);
+      live[i] = false;
+   }
+
+   for (uint32 i = 1; i < 512; i += 3) {
+      boxes[i] = make_random_box(random);
+
+      tree.move(leaves[i], boxes[i]);
+   }
+
+   REQUIRE(tree.size() == 512 - 171);
+
+   // Enlarged boxes may be visited for boxes that are only close to the query, the query
+   // results are checked against the real boxes.
+   const math::bounding_box query_box{.min = {-16.0f, -16.0f, -16.0f},
+                                      .max = {16.0f, 16.0f, 16.0f}};
+
+   std::vector<uint32> expected;
+
+   for (uint32 i = 0; i < boxes.size(); ++i) {
+      if (live[i] and overlaps(boxes[i], query_box)) expected.push_back(i);
+   }
+
+   std::vector<uint32> found;
+
+   tree.query([&](const math::bounding_box& bbox) { return overlaps(bbox, query_box); },
+              [&](const uint32 value) {
+                 if (overlaps(boxes[value], query_box)) found.push_back(value);
+              });
+
+   std::ranges::sort(found);
+
+   CHECK(found == expected);
+
+   std::uniform_real_distribution<float> direction_dist{-1.0f, 1.0f};
+
+   for (int32 i = 0; i < 64; ++i) {
+      const float3 ray_origin{0.0f, 0.0f, 0.0f};
+      const float3 ray_direction = normalize(
+         float3{direction_dist(random), direction_dist(random), direction_dist(random)});
+
+      std::optional<uint32> closest;
+
+      tree.raycast(ray_origin, ray_direction, std::numeric_limits<float>::max(),
+                   [&](const uint32 value, float& max_distance) {
+                      if (float distance = 0.0f;
+                          intersect_aabb(ray_origin, 1.0f / ray_direction, boxes[value],
+                                         max_distance, distance) and
+                          distance < max_distance) {
+                         closest = value;
+                         max_distance = distance;
+                      }
+
+                      return true;
+                   });
+
+      CHECK(closest == brute_force_raycast(boxes, live, ray_origin, ray_direction));
+   }
+
+   tree.clear();
+
+   CHECK(tree.size() == 0);
+}
+
+TEST_CASE("dynamic_aabb_tree closest", "[Math][DynamicAABBTree]")
+{
+   std::mt19937 random{0xc105e};
+
+   dynamic_aabb_tree tree;
+   std::vector<math::bounding_box> boxes;
+
+   for (uint32 i = 0; i < 256; ++i) {
+      boxes.push_back(make_random_box(random));
+
+      std::ignore = tree.insert(boxes.back(), i);
+   }
+
+   const auto distance_to = [](const math::bounding_box& bbox, const float3& point) {
+      const float3 distance = max(max(bbox.min - point, point - bbox.max), float3{});
+
+      return length(distance);
+   };
+
+   const float3 point{3.0f, -7.0f, 11.0f};
+
+   float expected_distance = std::numeric_limits<float>::max();
+
+   for (const math::bounding_box& bbox : boxes) {
+      expected_distance = std::min(expected_distance, distance_to(bbox, point));
+   }
+
+   float closest_distance = std::numeric_limits<float>::max();
+
+   tree.closest(point, std::numeric_limits<float>::max(),
+                [&](const uint32 value, float& max_distance) {
+                   const float distance = distance_to(boxes[value], point);
+
+                   if (distance < closest_distance) {
+                      closest_distance = distance;
+                      max_distance = distance;
+                   }
+
+                   return true;
+                });
+
+   CHECK(closest_distance == expected_distance);
+}
+
+}
@@ -0,0 +1,333 @@
+#include "pch.h"
+
+#include "math/frustum.hpp"
+#include "math/simd_intersectors.hpp"
+#include "math/vector_funcs.hpp"
+
+#include <array>
+#include <bit>
+#include <limits>
+#include <optional>
+#include <random>
+#include <vector>
+
+namespace we::math::simd::tests {
+
+namespace {
+
+constexpr std::size_t box_count = 64;
+
+struct boxes {
+   alignas(32) std::array<float, box_count> min_x;
+   alignas(32) std::array<float, box_count> min_y;
+   alignas(32) std::array<float, box_count> min_z;
+   alignas(32) std::array<float, box_count> max_x;
+   alignas(32) std::array<float, box_count> max_y;
+   alignas(32) std::array<float, box_count> max_z;
+};
+
+auto make_boxes(std::mt19937& random) -> boxes
+{
+   std::uniform_real_distribution<float> position_dist{-8.0f, 8.0f};
+   std::uniform_real_distribution<float> size_dist{0.0f, 4.0f};
+
+   boxes boxes;
+
+   for (std::size_t i = 0; i < box_count; ++i) {
+      boxes.min_x[i] = position_dist(random);
+      boxes.min_y[i] = position_dist(random);
+      boxes.min_z[i] = position_dist(random);
+      boxes.max_x[i] = boxes.min_x[i] + size_dist(random);
+      boxes.max_y[i] = boxes.min_y[i] + size_dist(random);
+      boxes.max_z[i] = boxes.min_z[i] + size_dist(random);
+   }
+
+   return boxes;
+}
+
+auto make_test_frustum() -> frustum
+{
+   // Maps NDC to a truncated pyramid along +Z.
+   float4x4 world_from_projection;
+
+   world_from_projection[0] = {4.0f, 0.0f, 0.0f, 0.0f};
+   world_from_projection[1] = {0.0f, 4.0f, 0.0f, 0.0f};
+   world_from_projection[2] = {0.0f, 0.0f, 0.0f, -0.9f};
+   world_from_projection[3] = {0.0f, 0.0f, 1.0f, 1.0f};
+
+   return frustum{world_from_projection};
+}
+
+/// @brief Bit patterns of every op's results, so results can be compared exactly (including NaNs).
+template<typename V>
+auto run_ops(const float* a_values, const float* b_values) -> std::vector<uint32>
+{
+   const V a = V::load(a_values);
+   const V b = V::load(b_values);
+
+   std::vector<uint32> results;
+
+   for (const V& v : {add(a, b), sub(a, b), mul(a, b), min(a, b), max(a, b),
+                      cmp_lt(a, b), cmp_le(a, b), cmp_gt(a, b), cmp_ge(a, b),
+                      mask_and(cmp_lt(a, b), cmp_le(a, b)),
+                      mask_or(cmp_gt(a, b), cmp_lt(a, b)), V::zero(), V::all_true(),
+                      V::broadcast(a_values[1])}) {
+      alignas(32) std::array<float, V::width> lanes;
+
+      store(lanes.data(), v);
+
+      for (const float lane : lanes) results.push_back(std::bit_cast<uint32>(lane));
+
+      results.push_back(static_cast<uint32>(movemask(v)));
+      results.push_back(std::bit_cast<uint32>(first_lane(v)));
+   }
+
+   return results;
+}
+
+/// @brief Entry distance (as bits) for each box the ray hits.
+template<typename V>
+auto ray_hits(const float3& ray_origin, const float3& ray_direction,
+              const float t_limit, const boxes& boxes) -> std::vector<std::optional<uint32>>
+{
+   const float3 inv_ray_direction = 1.0f / ray_direction;
+
+   std::vector<std::optional<uint32>> hits;
+
+   for (std::size_t i = 0; i < box_count; i += V::width) {
+      V t;
+
+      const int mask =
+         intersect_aabb(V::broadcast(ray_origin.x), V::broadcast(ray_origin.y),
+                        V::broadcast(ray_origin.z), V::broadcast(inv_ray_direction.x),
+                        V::broadcast(inv_ray_direction.y),
+                        V::broadcast(inv_ray_direction.z), V::load(&boxes.min_x[i]),
+                        V::load(&boxes.min_y[i]), V::load(&boxes.min_z[i]),
+                        V::load(&boxes.max_x[i]), V::load(&boxes.max_y[i]),
+                        V::load(&boxes.max_z[i]), V::broadcast(t_limit), t);
+
+      alignas(32) std::array<float, V::width> t_lanes;
+
+      store(t_lanes.data(), t);
+
+      for (int lane = 0; lane < V::width; ++lane) {
+         if (mask & (1 << lane)) {
+            hits.push_back(std::bit_cast<uint32>(t_lanes[lane]));
+         }
+         else {
+            hits.push_back(std::nullopt);
+         }
+      }
+   }
+
+   return hits;
+}
+
+template<typename V>
+auto frustum_hits(const frustum& frustum, const boxes& boxes,
+                  const bool shadow_cascade) -> std::vector<bool>
+{
+   std::vector<bool> hits;
+
+   for (std::size_t i = 0; i < box_count; i += V::width) {
+      const V min_x = V::load(&boxes.min_x[i]);
+      const V min_y = V::load(&boxes.min_y[i]);
+      const V min_z = V::load(&boxes.min_z[i]);
+      const V max_x = V::load(&boxes.max_x[i]);
+      const V max_y = V::load(&boxes.max_y[i]);
+      const V max_z = V::load(&boxes.max_z[i]);
+
+      const int mask =
+         shadow_cascade
+            ? intersects_frustum_shadow_cascade(frustum, min_x, min_y, min_z,
+                                                max_x, max_y, max_z)
+            : intersects_frustum(frustum, min_x, min_y, min_z, max_x, max_y, max_z);
+
+      for (int lane = 0; lane < V::width; ++lane) {
+         hits.push_back((mask & (1 << lane)) != 0);
+      }
+   }
+
+   return hits;
+}
+
+}
+
+TEST_CASE("simd ops match scalar", "[Math][SIMD]")
+{
+   const float inf = std::numeric_limits<float>::infinity();
+   const float nan = std::numeric_limits<float>::quiet_NaN();
+
+   alignas(32) const std::array<float, 8> a = {1.0f, -2.0f, 0.0f, -0.0f,
+                                               inf,  nan,   3.5f, -inf};
+   alignas(32) const std::array<float, 8> b = {2.0f, -2.0f, -0.0f, 0.0f,
+                                               1.0f, 1.0f,  nan,   -inf};
+
+   for (std::size_t offset : {0, 4}) {
+      REQUIRE(run_ops<native_float4>(&a[offset], &b[offset]) ==
+              run_ops<scalar_float<4>>(&a[offset], &b[offset]));
+   }
+
+   REQUIRE(run_ops<native_float>(a.data(), b.data()) ==
+           run_ops<scalar_float<native_float::width>>(a.data(), b.data()));
+
+#ifdef WE_SIMD_SSE2
+   REQUIRE(run_ops<sse_float4>(a.data(), b.data()) ==
+           run_ops<scalar_float<4>>(a.data(), b.data()));
+#endif
+
+#ifdef WE_SIMD_AVX
+   REQUIRE(run_ops<avx_float8>(a.data(), b.data()) ==
+           run_ops<scalar_float<8>>(a.data(), b.data()));
+#endif
+}
+
+TEST_CASE("simd load_uint8 matches scalar", "[Math][SIMD]")
+{
+   const std::array<uint8, 8> values = {0, 1, 127, 128, 200, 254, 255, 42};
+
+   const auto get_lanes = [&]<typename V>(const V v) {
+      alignas(32) std::array<float, V::width> lanes;
+
+      store(lanes.data(), v);
+
+      return std::vector<float>{lanes.begin(), lanes.end()};
+   };
+
+   for (std::size_t offset : {0, 4}) {
+      REQUIRE(get_lanes(native_float4::load_uint8(&values[offset])) ==
+              get_lanes(scalar_float<4>::load_uint8(&values[offset])));
+   }
+
+   REQUIRE(get_lanes(native_float::load_uint8(values.data())) ==
+           get_lanes(scalar_float<native_float::width>::load_uint8(values.data())));
+   REQUIRE(get_lanes(scalar_float<8>::load_uint8(values.data())) ==
+           std::vector<float>{0.0f, 1.0f, 127.0f, 128.0f, 200.0f, 254.0f, 255.0f, 42.0f});
+}
+
+TEST_CASE("simd intersect_aabb", "[Math][SIMD]")
+{
+   alignas(16) const std::array<float, 4> min_x = {-1.0f, 4.0f, -1.0f, -1.0f};
+   alignas(16) const std::array<float, 4> min_y = {-1.0f, -1.0f, 3.0f, -1.0f};
+   alignas(16) const std::array<float, 4> min_z = {-1.0f, -1.0f, -1.0f, 9.0f};
+   alignas(16) const std::array<float, 4> max_x = {1.0f, 5.0f, 1.0f, 1.0f};
+   alignas(16) const std::array<float, 4> max_y = {1.0f, 1.0f, 4.0f, 1.0f};
+   alignas(16) const std::array<float, 4> max_z = {1.0f, 1.0f, 1.0f, 11.0f};
+
+   const float3 inv_ray_direction = 1.0f / float3{0.0f, 0.0f, 1.0f};
+
+   native_float4 t;
+
+   const int mask = intersect_aabb(
+      native_float4::broadcast(0.0f), native_float4::broadcast(0.0f),
+      native_float4::broadcast(-5.0f), native_float4::broadcast(inv_ray_direction.x),
+      native_float4::broadcast(inv_ray_direction.y),
+      native_float4::broadcast(inv_ray_direction.z), native_float4::load(min_x.data()),
+      native_float4::load(min_y.data()), native_float4::load(min_z.data()),
+      native_float4::load(max_x.data()), native_float4::load(max_y.data()),
+      native_float4::load(max_z.data()), native_float4::broadcast(10.0f), t);
+
+   REQUIRE(mask == 0b0001);
+   REQUIRE(first_lane(t) == 4.0f);
+}
+
+TEST_CASE("simd intersect_aabb paths match", "[Math][SIMD]")
+{
+   std::mt19937 random{0x5eed};
+   std::uniform_real_distribution<float> origin_dist{-12.0f, 12.0f};
+   std::uniform_real_distribution<float> direction_dist{-1.0f, 1.0f};
+
+   for (int i = 0; i < 64; ++i) {
+      const boxes boxes = make_boxes(random);
+      const float3 ray_origin = {origin_dist(random), origin_dist(random),
+                                 origin_dist(random)};
+      const float3 ray_direction = {direction_dist(random), direction_dist(random),
+                                    direction_dist(random)};
+      const float t_limit = i % 2 == 0 ? 8.0f : std::numeric_limits<float>::max();
+
+      const std::vector<std::optional<uint32>> expected =
+         ray_hits<scalar_float<1>>(ray_origin, ray_direction, t_limit, boxes);
+
+      REQUIRE(ray_hits<scalar_float<4>>(ray_origin, ray_direction, t_limit, boxes) ==
+              expected);
+      REQUIRE(ray_hits<native_float4>(ray_origin, ray_direction, t_limit, boxes) ==
+              expected);
+      REQUIRE(ray_hits<native_float>(ray_origin, ray_direction, t_limit, boxes) ==
+              expected);
+
+#ifdef WE_SIMD_SSE2
+      REQUIRE(ray_hits<sse_float4>(ray_origin, ray_direction, t_limit, boxes) ==
+              expected);
+#endif
+
+#ifdef WE_SIMD_AVX
+      REQUIRE(ray_hits<avx_float8>(ray_origin, ray_direction, t_limit, boxes) ==
+              expected);
+#endif
+   }
+}
+
+TEST_CASE("simd intersects_frustum", "[Math][SIMD]")
+{
+   const frustum frustum = make_test_frustum();
+
+   alignas(16) const std::array<float, 4> min_x = {-1.0f, 50.0f, -1.0f, 9.0f};
+   alignas(16) const std::array<float, 4> min_y = {-1.0f, -1.0f, -1.0f, -1.0f};
+   alignas(16) const std::array<float, 4> min_z = {2.0f, 2.0f, -4.0f, 1.5f};
+   alignas(16) const std::array<float, 4> max_x = {1.0f, 51.0f, 1.0f, 10.0f};
+   alignas(16) const std::array<float, 4> max_y = {1.0f, 1.0f, 1.0f, 1.0f};
+   alignas(16) const std::array<float, 4> max_z = {3.0f, 3.0f, -3.0f, 2.0f};
+
+   const int mask =
+      intersects_frustum(frustum, native_float4::load(min_x.data()),
+                         native_float4::load(min_y.data()),
+                         native_float4::load(min_z.data()),
+                         native_float4::load(max_x.data()),
+                         native_float4::load(max_y.data()),
+                         native_float4::load(max_z.data()));
+
+   REQUIRE(mask == 0b0001);
+
+   for (int i = 0; i < 4; ++i) {
+      CHECK(((mask & (1 << i)) != 0) ==
+            intersects(frustum, {.min = {min_x[i], min_y[i], min_z[i]},
+                                 .max = {max_x[i], max_y[i], max_z[i]}}));
+   }
+}
+
+TEST_CASE("simd intersects_frustum paths match", "[Math][SIMD]")
+{
+   const frustum frustum = make_test_frustum();
+
+   std::mt19937 random{0xf00d};
+
+   for (int i = 0; i < 64; ++i) {
+      const boxes boxes = make_boxes(random);
+
+      for (const bool shadow_cascade : {false, true}) {
+         const std::vector<bool> expected =
+            frustum_hits<scalar_float<1>>(frustum, boxes, shadow_cascade);
+
+         REQUIRE(frustum_hits<scalar_float<4>>(frustum, boxes, shadow_cascade) ==
+                 expected);
+         REQUIRE(frustum_hits<scalar_float<8>>(frustum, boxes, shadow_cascade) ==
+                 expected);
+         REQUIRE(frustum_hits<native_float4>(frustum, boxes, shadow_cascade) ==
+                 expected);
+         REQUIRE(frustum_hits<native_float>(frustum, boxes, shadow_cascade) ==
+                 expected);
+
+#ifdef WE_SIMD_SSE2
+         REQUIRE(frustum_hits<sse_float4>(frustum, boxes, shadow_cascade) ==
+                 expected);
+#endif
+
+#ifdef WE_SIMD_AVX
+         REQUIRE(frustum_hits<avx_float8>(frustum, boxes, shadow_cascade) ==
+                 expected);
+#endif
+      }
+   }
+}
+
+}
@@ -0,0 +1,147 @@
+#include "pch.h"
+
+#include "world/blocks.hpp"
+#include "world/blocks/spatial_index.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace we::world::tests {
+
+namespace {
+
+void push_box(blocks_boxes& boxes, const float3& position, const float size) noexcept
+{
+   const uint32 index = static_cast<uint32>(boxes.size());
+
+   boxes.bbox.min_x.push_back(position.x - size);
+   boxes.bbox.min_y.push_back(position.y - size);
+   boxes.bbox.min_z.push_back(position.z - size);
+   boxes.bbox.max_x.push_back(position.x + size);
+   boxes.bbox.max_y.push_back(position.y + size);
+   boxes.bbox.max_z.push_back(position.z + size);
+   boxes.hidden.push_back(false);
+   boxes.layer.push_back(0);
+   boxes.description.push_back({.position = position, .size = {size, size, size}});
+   boxes.ids.push_back(block_box_id{});
+
+   boxes.dirty.add({index, index + 1});
+}
+
+void erase_box(blocks_boxes& boxes, const uint32 index) noexcept
+{
+   boxes.bbox.min_x.erase(boxes.bbox.min_x.begin() + index);
+   boxes.bbox.min_y.erase(boxes.bbox.min_y.begin() + index);
+   boxes.bbox.min_z.erase(boxes.bbox.min_z.begin() + index);
+   boxes.bbox.max_x.erase(boxes.bbox.max_x.begin() + index);
+   boxes.bbox.max_y.erase(boxes.bbox.max_y.begin() + index);
+   boxes.bbox.max_z.erase(boxes.bbox.max_z.begin() + index);
+   boxes.hidden.erase(boxes.hidden.begin() + index);
+   boxes.layer.erase(boxes.layer.begin() + index);
+   boxes.description.erase(boxes.description.begin() + index);
+   boxes.ids.erase(boxes.ids.begin() + index);
+
+   boxes.dirty.remove_index(index);
+   boxes.dirty.add({index, static_cast<uint32>(boxes.size())});
+}
+
+auto query_boxes(const blocks_spatial_index& index, const blocks_boxes& boxes,
+                 const float3& min, const float3& max) -> std::vector<uint32>
+{
+   std::vector<uint32> found;
+
+   index.query(
+      block_type::box,
+      [&](const math::bounding_box& bbox) {
+         return bbox.min.x <= max.x and bbox.max.x >= min.x and bbox.min.y <= max.y and
+                bbox.max.y >= min.y and bbox.min.z <= max.z and bbox.max.z >= min.z;
+      },
+      [&](const uint32 block_index) {
+         if (block_index >= boxes.size()) return;
+
+         if (boxes.bbox.min_x[block_index] <= max.x and
+             boxes.bbox.max_x[block_index] >= min.x) {
+            found.push_back(block_index);
+         }
+      });
+
+   std::ranges::sort(found);
+
+   return found;
+}
+
+}
+
+TEST_CASE("world blocks_spatial_index update", "[World][BlocksSpatialIndex]")
+{
+   blocks blocks;
+   blocks_spatial_index index;
+
+   for (int32 i = 0; i < 8; ++i) {
+      push_box(blocks.boxes, {i * 10.0f, 0.0f, 0.0f}, 1.0f);
+   }
+
+   index.update(blocks);
+   blocks.boxes.dirty.clear();
+
+   CHECK(query_boxes(index, blocks.boxes, {-2.0f, -2.0f, -2.0f}, {2.0f, 2.0f, 2.0f}) ==
+         std::vector<uint32>{0});
+   CHECK(query_boxes(index, blocks.boxes, {48.0f, -2.0f, -2.0f}, {72.0f, 2.0f, 2.0f}) ==
+         std::vector<uint32>{5, 6, 7});
+
+   // Move a box.
+   blocks.boxes.bbox.min_x[2] = 100.0f;
+   blocks.boxes.bbox.max_x[2] = 102.0f;
+   blocks.boxes.dirty.add({2, 3});
+
+   index.update(blocks);
+   blocks.boxes.dirty.clear();
+
+   CHECK(query_boxes(index, blocks.boxes, {18.0f, -2.0f, -2.0f}, {22.0f, 2.0f, 2.0f}).empty());
+   CHECK(query_boxes(index, blocks.boxes, {99.0f, -2.0f, -2.0f}, {103.0f, 2.0f, 2.0f}) ==
+         std::vector<uint32>{2});
+
+   // Delete a box, shifting the boxes after it down.
+   erase_box(blocks.boxes, 0);
+
+   index.update(blocks);
+   blocks.boxes.dirty.clear();
+
+   CHECK(query_boxes(index, blocks.boxes, {-2.0f, -2.0f, -2.0f}, {2.0f, 2.0f, 2.0f}).empty());
+   CHECK(query_boxes(index, blocks.boxes, {48.0f, -2.0f, -2.0f}, {72.0f, 2.0f, 2.0f}) ==
+         std::vector<uint32>{4, 5, 6});
+   CHECK(query_boxes(index, blocks.boxes, {99.0f, -2.0f, -2.0f}, {103.0f, 2.0f, 2.0f}) ==
+         std::vector<uint32>{1});
+
+   CHECK(index.get_debug_boxes(block_type::ramp).empty());
+
+   index.clear();
+
+   CHECK(query_boxes(index, blocks.boxes, {-200.0f, -2.0f, -2.0f}, {200.0f, 2.0f, 2.0f})
+            .empty());
+}
+
+TEST_CASE("world blocks_spatial_index raycast", "[World][BlocksSpatialIndex]")
+{
+   blocks blocks;
+   blocks_spatial_index index;
+
+   for (int32 i = 0; i < 16; ++i) {
+      push_box(blocks.boxes, {0.0f, 0.0f, i * 4.0f}, 1.0f);
+   }
+
+   index.update(blocks);
+
+   std::vector<uint32> visited;
+
+   index.raycast(block_type::box, {0.0f, 0.0f, -10.0f}, {0.0f, 0.0f, 1.0f}, 1000.0f,
+                 [&](const uint32 block_index, float&) {
+                    visited.push_back(block_index);
+
+                    return visited.size() < 3;
+                 });
+
+   CHECK(visited == std::vector<uint32>{0, 1, 2});
+}
+
+}
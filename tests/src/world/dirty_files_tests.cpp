@@ -0,0 +1,84 @@
+#include "pch.h"
+
+#include "world/dirty_files.hpp"
+#include "world/layer_description.hpp"
+
+#include <vector>
+
+namespace we::world::tests {
+
+TEST_CASE("world dirty_files starts dirty", "[World]")
+{
+   const dirty_files dirty_files;
+
+   CHECK(dirty_files.is_dirty(world_file::layer_index));
+   CHECK(dirty_files.is_dirty(world_file::terrain));
+   CHECK(dirty_files.is_dirty(world_file::configuration));
+   CHECK(dirty_files.is_dirty(layer_file::objects, 0));
+   CHECK(dirty_files.is_dirty(layer_file::hintnodes, max_layers - 1));
+   CHECK(not dirty_files.is_saved_to("temp/world/test.wld"));
+}
+
+TEST_CASE("world dirty_files mark", "[World]")
+{
+   dirty_files dirty_files;
+
+   dirty_files.mark_saved("temp/world/test.wld", {});
+
+   CHECK(dirty_files.is_saved_to("temp/world/test.wld"));
+   CHECK(not dirty_files.is_saved_to("temp/world/other.wld"));
+   CHECK(not dirty_files.is_dirty(world_file::terrain));
+   CHECK(not dirty_files.is_dirty(layer_file::objects, 0));
+
+   dirty_files.mark(world_file::blocks);
+
+   CHECK(dirty_files.is_dirty(world_file::blocks));
+   CHECK(not dirty_files.is_dirty(world_file::requirements));
+
+   dirty_files.mark(layer_file::lights, 2);
+
+   CHECK(dirty_files.is_dirty(layer_file::lights, 2));
+   CHECK(not dirty_files.is_dirty(layer_file::lights, 1));
+   CHECK(not dirty_files.is_dirty(layer_file::objects, 2));
+
+   dirty_files.mark_all_layers(layer_file::paths);
+
+   CHECK(dirty_files.is_dirty(layer_file::paths, 0));
+   CHECK(dirty_files.is_dirty(layer_file::paths, max_layers - 1));
+
+   dirty_files.mark(layer_file::regions, -1);
+
+   CHECK(dirty_files.is_dirty(layer_file::regions, 0));
+   CHECK(dirty_files.is_dirty(layer_file::regions, max_layers - 1));
+
+   dirty_files.mark_saved("temp/world/test.wld", {});
+
+   CHECK(not dirty_files.is_dirty(world_file::blocks));
+   CHECK(not dirty_files.is_dirty(layer_file::lights, 2));
+
+   dirty_files.mark_all();
+
+   CHECK(dirty_files.is_dirty(world_file::effects));
+   CHECK(dirty_files.is_dirty(layer_file::hintnodes, 4));
+}
+
+TEST_CASE("world dirty_files terrain cuts", "[World]")
+{
+   std::vector<terrain_cut> terrain_cuts{
+      {.bbox = {.min = {-1.0f, -1.0f, -1.0f}, .max = {1.0f, 1.0f, 1.0f}},
+       .planes = {{1.0f, 0.0f, 0.0f, 1.0f}, {-1.0f, 0.0f, 0.0f, 1.0f}}},
+   };
+
+   dirty_files dirty_files;
+
+   dirty_files.mark_saved("temp/world/test.wld", terrain_cuts);
+
+   CHECK(not dirty_files.is_dirty(terrain_cuts));
+   CHECK(dirty_files.is_dirty(std::span<const terrain_cut>{}));
+
+   terrain_cuts[0].planes[1].w = 2.0f;
+
+   CHECK(dirty_files.is_dirty(terrain_cuts));
+}
+
+}
@@ -363,4 +363,140 @@ TEST_CASE("world path_id_node_mask node_mask operator&", "[World][ID]")
 
    CHECK(mask == make_test_node_mask(false, true, false, false));
 }
+
+TEST_CASE("world edit_context mark_dirty", "[World]")
+{
+   world world{
+      .name = "Test",
+
+      .layer_descriptions = {{.name = "[Base]"}, {.name = "conquest"}},
+
+      .objects = {entities_init, std::initializer_list{object{.layer = 0},
+                                                       object{.layer = 1}}},
+      .lights = {entities_init, std::initializer_list{light{.layer = 0},
+                                                      light{.layer = 1}}},
+      .regions = {entities_init, std::initializer_list{region{.layer = 1}}},
+   };
+   creation_entity creation_entity;
+   edit_context context{world, creation_entity};
+
+   const auto reset = [&] { world.dirty_files.mark_saved("temp/world/test.wld", {}); };
+
+   reset();
+   context.mark_dirty(&world.objects[1].position);
+
+   CHECK(world.dirty_files.is_dirty(layer_file::objects, 1));
+   CHECK(not world.dirty_files.is_dirty(layer_file::objects, 0));
+   CHECK(not world.dirty_files.is_dirty(layer_file::hintnodes, 1));
+   CHECK(not world.dirty_files.is_dirty(world_file::portals_sectors));
+
+   reset();
+   context.mark_dirty(&world.objects[0].name);
+
+   CHECK(world.dirty_files.is_dirty(layer_file::objects, 0));
+   CHECK(world.dirty_files.is_dirty(layer_file::hintnodes, 1));
+   CHECK(world.dirty_files.is_dirty(world_file::portals_sectors));
+   CHECK(world.dirty_files.is_dirty(world_file::animations));
+
+   reset();
+   context.mark_dirty(&world.objects);
+
+   CHECK(world.dirty_files.is_dirty(layer_file::objects, 0));
+   CHECK(world.dirty_files.is_dirty(layer_file::objects, 1));
+   CHECK(world.dirty_files.is_dirty(world_file::blocks));
+   CHECK(not world.dirty_files.is_dirty(layer_file::lights, 0));
+
+   reset();
+   context.mark_dirty(&world.lights[1].color);
+
+   CHECK(world.dirty_files.is_dirty(layer_file::lights, 1));
+   CHECK(world.dirty_files.is_dirty(layer_file::regions, 1));
+   CHECK(not world.dirty_files.is_dirty(layer_file::lights, 0));
+
+   reset();
+   context.mark_dirty(&world.lights[0].layer);
+
+   CHECK(world.dirty_files.is_dirty(layer_file::lights, 0));
+   CHECK(world.dirty_files.is_dirty(layer_file::lights, 1));
+
+   reset();
+   context.mark_dirty(&world.regions[0].size);
+
+   CHECK(world.dirty_files.is_dirty(layer_file::regions, 1));
+   CHECK(not world.dirty_files.is_dirty(layer_file::regions, 0));
+
+   reset();
+   context.mark_dirty(&world.terrain);
+
+   CHECK(world.dirty_files.is_dirty(world_file::terrain));
+   CHECK(not world.dirty_files.is_dirty(world_file::layer_index));
+
+   reset();
+   context.mark_dirty(&world.game_modes);
+
+   CHECK(world.dirty_files.is_dirty(world_file::layer_index));
+   CHECK(world.dirty_files.is_dirty(world_file::requirements));
+   CHECK(not world.dirty_files.is_dirty(world_file::terrain));
+
+   reset();
+   context.mark_dirty(&world.deleted_layers);
+   context.mark_dirty(&context.euler_rotation);
+
+   CHECK(not world.dirty_files.is_dirty(world_file::layer_index));
+   CHECK(not world.dirty_files.is_dirty(layer_file::objects, 0));
+
+   reset();
+   context.mark_dirty(&world.configuration.save_effects);
+
+   CHECK(world.dirty_files.is_dirty(world_file::configuration));
+   CHECK(world.dirty_files.is_dirty(layer_file::objects, 0));
+
+   reset();
+
+   const float unknown = 0.0f;
+
+   context.mark_dirty(&unknown);
+
+   CHECK(world.dirty_files.is_dirty(world_file::terrain));
+   CHECK(world.dirty_files.is_dirty(layer_file::hintnodes, 1));
+}
+
+TEST_CASE("world edit_context mark_dirty entity types", "[World]")
+{
+   world world{
+      .objects = {entities_init, std::initializer_list{object{}}},
+      .lights = {entities_init, std::initializer_list{light{}}},
+      .paths = {entities_init, std::initializer_list{path{.nodes = {{}, {}}}}},
+   };
+   creation_entity creation_entity;
+   edit_context context{world, creation_entity};
+
+   CHECK(world.dirty_entities.objects);
+   CHECK(world.dirty_entities.boundaries);
+
+   world.dirty_entities.untracked_clear();
+   context.mark_dirty(&world.objects[0].position);
+
+   CHECK(world.dirty_entities.objects);
+   CHECK(not world.dirty_entities.lights);
+
+   world.dirty_entities.untracked_clear();
+   context.mark_dirty(&world.lights);
+
+   CHECK(world.dirty_entities.lights);
+   CHECK(not world.dirty_entities.objects);
+
+   world.dirty_entities.untracked_clear();
+   context.mark_dirty(&world.terrain);
+   context.mark_dirty(&context.euler_rotation);
+
+   CHECK(not world.dirty_entities.objects);
+   CHECK(not world.dirty_entities.lights);
+   CHECK(not world.dirty_entities.paths);
+
+   world.dirty_entities.untracked_clear();
+   context.mark_dirty(&world.paths[0].nodes[1].position);
+
+   CHECK(world.dirty_entities.paths);
+}
 }
@@ -0,0 +1,45 @@
+#include "pch.h"
+
+#include "world/object.hpp"
+#include "world/utility/entity_name_index.hpp"
+
+#include <string_view>
+#include <vector>
+
+using namespace std::literals;
+
+namespace we::world::tests {
+
+TEST_CASE("world entity_name_index find", "[World][Utilities]")
+{
+   const std::vector<object> objects{
+      object{.name = "com_bldg_controlzone"s},
+      object{.name = "Door0"s},
+      object{.name = "door0"s},
+      object{.name = "Door1"s},
+   };
+
+   const entity_name_index index{objects};
+
+   CHECK(index.size() == 3);
+
+   CHECK(index.find("com_bldg_controlzone"sv) == 0);
+   CHECK(index.find("COM_BLDG_CONTROLZONE"sv) == 0);
+   CHECK(index.find("door0"sv) == 1);
+   CHECK(index.find("DOOR1"sv) == 3);
+   CHECK(index.find("Door2"sv) == std::nullopt);
+   CHECK(index.find(""sv) == std::nullopt);
+}
+
+TEST_CASE("world entity_name_index insert", "[World][Utilities]")
+{
+   entity_name_index index;
+
+   index.insert("Light0"sv, 4);
+   index.insert("LIGHT0"sv, 5);
+
+   CHECK(index.size() == 1);
+   CHECK(index.find("light0"sv) == 4);
+}
+
+}
@@ -0,0 +1,216 @@
+#include "pch.h"
+
+#include "assets/asset_libraries.hpp"
+#include "async/thread_pool.hpp"
+#include "math/vector_funcs.hpp"
+#include "output_stream.hpp"
+#include "world/object_class_library.hpp"
+#include "world/utility/entity_spatial_index.hpp"
+#include "world/utility/raycast.hpp"
+
+#include <cmath>
+#include <optional>
+#include <random>
+#include <vector>
+
+using namespace std::literals;
+
+namespace we::world::tests {
+
+namespace {
+
+constexpr int32 benchmark_object_count = 20000;
+constexpr int32 benchmark_entity_count = 1000;
+constexpr int32 benchmark_ray_count = 256;
+
+struct benchmark_ray {
+   float3 origin;
+   float3 direction;
+};
+
+/// @brief Make a world with as many objects as a large map and a smaller number of every other
+/// indexed entity type.
+auto make_benchmark_world() -> world
+{
+   std::mt19937 random{0x1dec5};
+   std::uniform_real_distribution<float> position_dist{-1000.0f, 1000.0f};
+   std::uniform_real_distribution<float> height_dist{0.0f, 40.0f};
+   std::uniform_real_distribution<float> size_dist{1.0f, 8.0f};
+
+   const auto random_position = [&] {
+      return float3{position_dist(random), height_dist(random), position_dist(random)};
+   };
+
+   world world;
+
+   for (int32 i = 0; i < benchmark_object_count; ++i) {
+      world.objects.push_back({.name = "object"s,
+                               .position = random_position(),
+                               .id = world.next_id.objects.aquire()});
+   }
+
+   for (int32 i = 0; i < benchmark_entity_count; ++i) {
+      world.lights.push_back({.name = "light"s,
+                              .position = random_position(),
+                              .range = size_dist(random),
+                              .id = world.next_id.lights.aquire()});
+
+      world.paths.push_back({.name = "path"s,
+                             .nodes = {{.position = random_position()},
+                                       {.position = random_position()}},
+                             .id = world.next_id.paths.aquire()});
+
+      world.regions.push_back({.name = "region"s,
+                               .position = random_position(),
+                               .size = {size_dist(random), size_dist(random), size_dist(random)},
+                               .id = world.next_id.regions.aquire()});
+
+      const float3 sector_position = random_position();
+
+      world.sectors.push_back(
+         {.name = "sector"s,
+          .base = sector_position.y,
+          .height = size_dist(random),
+          .points = {{sector_position.x, sector_position.z},
+                     {sector_position.x + size_dist(random), sector_position.z},
+                     {sector_position.x, sector_position.z + size_dist(random)}},
+          .id = world.next_id.sectors.aquire()});
+
+      world.portals.push_back({.name = "portal"s,
+                               .position = random_position(),
+                               .id = world.next_id.portals.aquire()});
+
+      world.hintnodes.push_back({.name = "hintnode"s,
+                                 .position = random_position(),
+                                 .id = world.next_id.hintnodes.aquire()});
+
+      world.barriers.push_back({.name = "barrier"s,
+                                .position = random_position(),
+                                .id = world.next_id.barriers.aquire()});
+
+      world.planning_hubs.push_back({.name = "hub"s,
+                                     .position = random_position(),
+                                     .id = world.next_id.planning_hubs.aquire()});
+
+      world.boundaries.push_back(
+         {.name = "boundary"s,
+          .points = {random_position(), random_position(), random_position()},
+          .id = world.next_id.boundaries.aquire()});
+   }
+
+   return world;
+}
+
+/// @brief Make rays like hover picking would, from a camera above the world looking down at it.
+auto make_benchmark_rays() -> std::vector<benchmark_ray>
+{
+   std::mt19937 random{0x4a7e};
+   std::uniform_real_distribution<float> position_dist{-1000.0f, 1000.0f};
+   std::uniform_real_distribution<float> horizontal_dist{-1.0f, 1.0f};
+   std::uniform_real_distribution<float> vertical_dist{-1.0f, -0.1f};
+
+   std::vector<benchmark_ray> rays;
+   rays.reserve(benchmark_ray_count);
+
+   for (int32 i = 0; i < benchmark_ray_count; ++i) {
+      rays.push_back({.origin = {position_dist(random), 60.0f, position_dist(random)},
+                      .direction = normalize(float3{horizontal_dist(random),
+                                                    vertical_dist(random),
+                                                    horizontal_dist(random)})});
+   }
+
+   return rays;
+}
+
+}
+
+TEST_CASE("world entity_spatial_index benchmark",
+          "[World][EntitySpatialIndex][Benchmark][.]")
+{
+   null_output_stream output;
+   std::shared_ptr<async::thread_pool> thread_pool =
+      async::thread_pool::make({.thread_count = 1, .low_priority_thread_count = 1});
+   assets::libraries_manager assets_libraries{output, thread_pool};
+
+   const object_class_library object_classes{assets_libraries};
+
+   world world = make_benchmark_world();
+
+   entity_spatial_index index;
+
+   BENCHMARK("build")
+   {
+      index.clear();
+      index.update(world, object_classes, {});
+   };
+
+   // This is the cost of update on a frame where nothing has been edited, which is most frames.
+   BENCHMARK("update unchanged")
+   {
+      world.dirty_entities.untracked_clear();
+
+      index.update(world, object_classes, {});
+   };
+
+   // This is the cost of update on a frame where every entity type has been edited but no
+   // entity's bounds have changed, every entity's key is compared.
+   BENCHMARK("update unchanged all dirty")
+   {
+      world.dirty_entities.mark_all();
+
+      index.update(world, object_classes, {});
+   };
+
+   BENCHMARK("update one object moved")
+   {
+      world.objects[benchmark_object_count / 2].position.x += 1.0f;
+
+      world.dirty_entities.untracked_clear();
+      world.dirty_entities.objects = true;
+
+      index.update(world, object_classes, {});
+   };
+
+   const std::vector<benchmark_ray> rays = make_benchmark_rays();
+
+   active_layers layers;
+
+   layers.set(0);
+
+   const auto count_hits = [&](const entity_spatial_index* index) {
+      int32 hits = 0;
+
+      for (const benchmark_ray& ray : rays) {
+         const std::optional<raycast_result<object>> object_hit =
+            index ? raycast(ray.origin, ray.direction, layers, world.objects, object_classes,
+                            *index)
+                  : raycast(ray.origin, ray.direction, layers, world.objects, object_classes);
+         const std::optional<raycast_result<light>> light_hit =
+            index ? raycast(ray.origin, ray.direction, layers, world.lights, {}, *index)
+                  : raycast(ray.origin, ray.direction, layers, world.lights, {});
+         const std::optional<raycast_result<hintnode>> hintnode_hit =
+            index ? raycast(ray.origin, ray.direction, layers, world.hintnodes, *index)
+                  : raycast(ray.origin, ray.direction, layers, world.hintnodes);
+
+         if (object_hit) hits += 1;
+         if (light_hit) hits += 1;
+         if (hintnode_hit) hits += 1;
+      }
+
+      return hits;
+   };
+
+   REQUIRE(count_hits(nullptr) == count_hits(&index));
+
+   BENCHMARK("raycast")
+   {
+      return count_hits(nullptr);
+   };
+
+   BENCHMARK("raycast indexed")
+   {
+      return count_hits(&index);
+   };
+}
+
+}
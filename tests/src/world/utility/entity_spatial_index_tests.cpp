@@ -0,0 +1,501 @@
+#include "pch.h"
+
+#include "assets/asset_libraries.hpp"
+#include "async/thread_pool.hpp"
+#include "math/quaternion_funcs.hpp"
+#include "math/vector_funcs.hpp"
+#include "output_stream.hpp"
+#include "world/blocks/custom_mesh_bvh_library.hpp"
+#include "world/object_class_library.hpp"
+#include "world/utility/double_click_select.hpp"
+#include "world/utility/drag_select.hpp"
+#include "world/utility/entity_spatial_index.hpp"
+#include "world/utility/raycast.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace std::literals;
+
+namespace we::world::tests {
+
+namespace {
+
+constexpr float path_node_size = 0.5f;
+constexpr float barrier_height = 2.0f;
+constexpr float hub_height = 3.0f;
+constexpr float boundary_height = 4.0f;
+
+const raycast_light_sizes light_sizes{.directional = 1.0f, .point = 1.5f, .spot = 2.0f};
+
+const entity_spatial_index_config index_config{
+   .light_proxy_radius = 2.0f,
+   .path_node_radius = 0.707f * (path_node_size / 0.5f),
+   .barrier_height = barrier_height,
+   .hub_height = hub_height,
+   .boundary_height = boundary_height,
+};
+
+const select_settings settings{
+   .path_node_radius = 0.707f * (path_node_size / 0.5f),
+   .barrier_visualizer_height = barrier_height,
+   .hub_visualizer_height = hub_height,
+   .boundary_visualizer_height = boundary_height,
+};
+
+struct test_random {
+   std::mt19937 engine{0x5e1ec7};
+   std::uniform_real_distribution<float> position_dist{-64.0f, 64.0f};
+   std::uniform_real_distribution<float> size_dist{0.5f, 4.0f};
+   std::uniform_real_distribution<float> angle_dist{-3.14f, 3.14f};
+
+   auto position() noexcept -> float3
+   {
+      return {position_dist(engine), position_dist(engine) * 0.25f, position_dist(engine)};
+   }
+
+   auto size() noexcept -> float
+   {
+      return size_dist(engine);
+   }
+
+   auto rotation() noexcept -> quaternion
+   {
+      const float half_angle = angle_dist(engine) * 0.5f;
+
+      return {std::cos(half_angle), 0.0f, std::sin(half_angle), 0.0f};
+   }
+};
+
+constexpr light_type light_types[] = {light_type::directional,
+                                      light_type::point,
+                                      light_type::spot,
+                                      light_type::directional_region_box,
+                                      light_type::directional_region_sphere,
+                                      light_type::directional_region_cylinder};
+
+constexpr region_shape region_shapes[] = {region_shape::box, region_shape::sphere,
+                                          region_shape::cylinder};
+
+void add_test_entities(world& world, test_random& random, const int32 count) noexcept
+{
+   for (int32 i = 0; i < count; ++i) {
+      // Every eighth entity is hidden or on an inactive layer to exercise the filters.
+      const int8 layer = i % 8 == 7 ? 2 : static_cast<int8>(i % 2);
+      const bool hidden = i % 8 == 3;
+
+      world.objects.push_back({.name = "object"s,
+                               .layer = layer,
+                               .hidden = hidden,
+                               .rotation = random.rotation(),
+                               .position = random.position(),
+                               .class_name = lowercase_string{i % 3 == 0 ? "a"sv : "b"sv},
+                               .id = world.next_id.objects.aquire()});
+
+      world.lights.push_back(
+         {.name = "light"s,
+          .layer = layer,
+          .hidden = hidden,
+          .rotation = random.rotation(),
+          .position = random.position(),
+          .light_type = light_types[i % std::size(light_types)],
+          .range = random.size() * 2.0f,
+          .region_size = {random.size(), random.size(), random.size()},
+          .region_rotation = random.rotation(),
+          .id = world.next_id.lights.aquire()});
+
+      path path{.name = "path"s,
+                .layer = layer,
+                .hidden = hidden,
+                .id = world.next_id.paths.aquire()};
+
+      for (int32 node = 0; node < 3; ++node) {
+         path.nodes.push_back({.position = random.position()});
+      }
+
+      world.paths.push_back(std::move(path));
+
+      world.regions.push_back({.name = "region"s,
+                               .layer = layer,
+                               .hidden = hidden,
+                               .rotation = random.rotation(),
+                               .position = random.position(),
+                               .size = {random.size(), random.size(), random.size()},
+                               .shape = region_shapes[i % std::size(region_shapes)],
+                               .id = world.next_id.regions.aquire()});
+
+      const float3 sector_centre = random.position();
+
+      world.sectors.push_back({.name = "sector"s,
+                               .hidden = hidden,
+                               .base = sector_centre.y,
+                               .height = random.size(),
+                               .points = {{sector_centre.x, sector_centre.z},
+                                          {sector_centre.x + random.size(), sector_centre.z},
+                                          {sector_centre.x, sector_centre.z + random.size()}},
+                               .id = world.next_id.sectors.aquire()});
+
+      world.portals.push_back({.name = "portal"s,
+                               .hidden = hidden,
+                               .rotation = random.rotation(),
+                               .position = random.position(),
+                               .width = random.size(),
+                               .height = random.size(),
+                               .id = world.next_id.portals.aquire()});
+
+      world.hintnodes.push_back({.name = "hintnode"s,
+                                 .layer = layer,
+                                 .hidden = hidden,
+                                 .rotation = random.rotation(),
+                                 .position = random.position(),
+                                 .id = world.next_id.hintnodes.aquire()});
+
+      world.barriers.push_back({.name = "barrier"s,
+                                .hidden = hidden,
+                                .position = random.position(),
+                                .size = {random.size(), random.size()},
+                                .rotation_angle = random.angle_dist(random.engine),
+                                .id = world.next_id.barriers.aquire()});
+
+      world.planning_hubs.push_back({.name = "hub"s,
+                                     .hidden = hidden,
+                                     .position = random.position(),
+                                     .radius = random.size(),
+                                     .id = world.next_id.planning_hubs.aquire()});
+
+      world.boundaries.push_back({.name = "boundary"s,
+                                  .hidden = hidden,
+                                  .points = {random.position(), random.position(),
+                                             random.position()},
+                                  .id = world.next_id.boundaries.aquire()});
+   }
+}
+
+/// @brief Move every third entity of each type somewhere else.
+void move_test_entities(world& world, test_random& random) noexcept
+{
+   for (std::size_t i = 0; i < world.objects.size(); i += 3) {
+      world.objects[i].position = random.position();
+      world.objects[i].rotation = random.rotation();
+   }
+
+   for (std::size_t i = 0; i < world.lights.size(); i += 3) {
+      world.lights[i].position = random.position();
+      world.lights[i].range = random.size() * 2.0f;
+   }
+
+   for (std::size_t i = 0; i < world.paths.size(); i += 3) {
+      world.paths[i].nodes[1].position = random.position();
+   }
+
+   for (std::size_t i = 0; i < world.regions.size(); i += 3) {
+      world.regions[i].position = random.position();
+      world.regions[i].size = {random.size(), random.size(), random.size()};
+   }
+
+   for (std::size_t i = 0; i < world.sectors.size(); i += 3) {
+      world.sectors[i].points[0] += float2{random.size(), -random.size()};
+      world.sectors[i].base = random.position().y;
+   }
+
+   for (std::size_t i = 0; i < world.portals.size(); i += 3) {
+      world.portals[i].position = random.position();
+   }
+
+   for (std::size_t i = 0; i < world.hintnodes.size(); i += 3) {
+      world.hintnodes[i].position = random.position();
+   }
+
+   for (std::size_t i = 0; i < world.barriers.size(); i += 3) {
+      world.barriers[i].position = random.position();
+   }
+
+   for (std::size_t i = 0; i < world.planning_hubs.size(); i += 3) {
+      world.planning_hubs[i].position = random.position();
+   }
+
+   for (std::size_t i = 0; i < world.boundaries.size(); i += 3) {
+      world.boundaries[i].points[2] = random.position();
+   }
+}
+
+/// @brief Delete the entity in the middle of each type's list.
+void delete_middle_test_entities(world& world) noexcept
+{
+   const auto erase_middle = [](auto& entities) {
+      entities.erase(entities.begin() + entities.size() / 2);
+   };
+
+   erase_middle(world.objects);
+   erase_middle(world.lights);
+   erase_middle(world.paths);
+   erase_middle(world.regions);
+   erase_middle(world.sectors);
+   erase_middle(world.portals);
+   erase_middle(world.hintnodes);
+   erase_middle(world.barriers);
+   erase_middle(world.planning_hubs);
+   erase_middle(world.boundaries);
+}
+
+/// @brief Check two raycast results match.
+/// @param hit_count Incremented if the linear raycast hit anything.
+template<typename T>
+void check_same_hit(const std::optional<raycast_result<T>>& linear_hit,
+                    const std::optional<raycast_result<T>>& indexed_hit, int32& hit_count)
+{
+   REQUIRE(indexed_hit.has_value() == linear_hit.has_value());
+
+   if (not linear_hit) return;
+
+   CHECK(indexed_hit->id == linear_hit->id);
+   CHECK(indexed_hit->index == linear_hit->index);
+   CHECK(indexed_hit->distance == Approx(linear_hit->distance).margin(1e-3f));
+
+   hit_count += 1;
+}
+
+/// @brief Check two selections hold the same entities.
+/// @param selected_count Incremented if the linear selection is not empty.
+void check_same_selection(const selection& linear_selection,
+                          const selection& indexed_selection, int32& selected_count)
+{
+   REQUIRE(indexed_selection.size() == linear_selection.size());
+
+   if (not linear_selection.empty()) selected_count += 1;
+
+   for (const selected_entity& entity : linear_selection) {
+      CHECK(std::ranges::find(indexed_selection, entity) != indexed_selection.end());
+   }
+}
+
+/// @brief Make a frustum that covers an axis aligned box.
+auto make_box_frustum(const float3& centre, const float3& half_size) -> frustum
+{
+   float4x4 world_from_projection;
+
+   world_from_projection[0] = {1.0f, 0.0f, 0.0f, 0.0f};
+   world_from_projection[1] = {0.0f, 1.0f, 0.0f, 0.0f};
+   world_from_projection[2] = {0.0f, 0.0f, 1.0f, 0.0f};
+   world_from_projection[3] = {0.0f, 0.0f, 0.0f, 1.0f};
+
+   return frustum{world_from_projection, centre - half_size, centre + half_size};
+}
+
+/// @brief Check raycast, drag_select and double_click_select give the same results with the
+/// index as without.
+void check_index_matches_linear(const world& world, const object_class_library& object_classes,
+                                const blocks_custom_mesh_bvh_library& blocks_bvh_library,
+                                const entity_spatial_index& index, test_random& random)
+{
+   active_layers layers;
+
+   layers.set(0);
+   layers.set(1);
+
+   // Count the hits and selections so the checks can't pass by never finding anything.
+   std::array<int32, 10> hit_counts{};
+
+   for (int32 i = 0; i < 512; ++i) {
+      const float3 ray_origin = random.position() * 1.5f + float3{0.0f, 32.0f, 0.0f};
+      const float3 ray_direction = normalize(random.position() - ray_origin);
+
+      check_same_hit(raycast(ray_origin, ray_direction, layers, world.objects, object_classes),
+                     raycast(ray_origin, ray_direction, layers, world.objects, object_classes,
+                             index),
+                     hit_counts[0]);
+      check_same_hit(raycast(ray_origin, ray_direction, layers, world.lights, light_sizes),
+                     raycast(ray_origin, ray_direction, layers, world.lights, light_sizes,
+                             index),
+                     hit_counts[1]);
+      check_same_hit(raycast(ray_origin, ray_direction, layers, world.paths, path_node_size),
+                     raycast(ray_origin, ray_direction, layers, world.paths, path_node_size,
+                             index),
+                     hit_counts[2]);
+      check_same_hit(raycast(ray_origin, ray_direction, layers, world.regions),
+                     raycast(ray_origin, ray_direction, layers, world.regions, index),
+                     hit_counts[3]);
+      check_same_hit(raycast(ray_origin, ray_direction, world.sectors),
+                     raycast(ray_origin, ray_direction, world.sectors, index),
+                     hit_counts[4]);
+      check_same_hit(raycast(ray_origin, ray_direction, world.portals),
+                     raycast(ray_origin, ray_direction, world.portals, index),
+                     hit_counts[5]);
+      check_same_hit(raycast(ray_origin, ray_direction, layers, world.hintnodes),
+                     raycast(ray_origin, ray_direction, layers, world.hintnodes, index),
+                     hit_counts[6]);
+      check_same_hit(raycast(ray_origin, ray_direction, world.barriers, barrier_height),
+                     raycast(ray_origin, ray_direction, world.barriers, barrier_height,
+                             index),
+                     hit_counts[7]);
+      check_same_hit(raycast(ray_origin, ray_direction, world.planning_hubs, hub_height),
+                     raycast(ray_origin, ray_direction, world.planning_hubs, hub_height,
+                             index),
+                     hit_counts[8]);
+      check_same_hit(raycast(ray_origin, ray_direction, world.boundaries, boundary_height),
+                     raycast(ray_origin, ray_direction, world.boundaries, boundary_height,
+                             index),
+                     hit_counts[9]);
+   }
+
+   for (const int32 hit_count : hit_counts) CHECK(hit_count > 0);
+
+   const active_entity_types active_entities{.objects = true,
+                                             .lights = true,
+                                             .paths = true,
+                                             .regions = true,
+                                             .sectors = true,
+                                             .portals = true,
+                                             .hintnodes = true,
+                                             .barriers = true,
+                                             .planning_hubs = true,
+                                             .boundaries = true};
+
+   const interaction_target hovered_entities[] = {
+      world.objects[0].id,
+      world.lights[0].id,
+      make_path_id_node_mask(world.paths[0].id, 0),
+      world.regions[0].id,
+      world.sectors[0].id,
+      world.portals[0].id,
+      world.hintnodes[0].id,
+      world.barriers[0].id,
+      world.planning_hubs[0].id,
+      world.boundaries[0].id,
+   };
+
+   int32 drag_selected_count = 0;
+   int32 double_click_selected_count = 0;
+
+   for (int32 i = 0; i < 32; ++i) {
+      const frustum frustumWS =
+         make_box_frustum(random.position(), float3{random.size(), random.size(),
+                                                    random.size()} *
+                                                8.0f);
+
+      selection linear_selection;
+      selection indexed_selection;
+
+      drag_select(world, active_entities, layers, object_classes, blocks_bvh_library,
+                  frustumWS, select_op::add, linear_selection, settings);
+      drag_select(world, active_entities, layers, object_classes, blocks_bvh_library, index,
+                  frustumWS, select_op::add, indexed_selection, settings);
+
+      check_same_selection(linear_selection, indexed_selection, drag_selected_count);
+
+      for (const interaction_target& hovered_entity : hovered_entities) {
+         linear_selection.clear();
+         indexed_selection.clear();
+
+         double_click_select(hovered_entity, world, object_classes, blocks_bvh_library,
+                             frustumWS, select_op::add, linear_selection, settings);
+         double_click_select(hovered_entity, world, object_classes, blocks_bvh_library, index,
+                             frustumWS, select_op::add, indexed_selection, settings);
+
+         check_same_selection(linear_selection, indexed_selection,
+                              double_click_selected_count);
+      }
+   }
+
+   CHECK(drag_selected_count > 0);
+   CHECK(double_click_selected_count > 0);
+}
+
+}
+
+TEST_CASE("world entity_spatial_index matches linear queries", "[World][EntitySpatialIndex]")
+{
+   null_output_stream output;
+   std::shared_ptr<async::thread_pool> thread_pool =
+      async::thread_pool::make({.thread_count = 1, .low_priority_thread_count = 1});
+   assets::libraries_manager assets_libraries{output, thread_pool};
+
+   const object_class_library object_classes{assets_libraries};
+   const blocks_custom_mesh_bvh_library blocks_bvh_library;
+
+   test_random random;
+   world world;
+
+   add_test_entities(world, random, 96);
+
+   entity_spatial_index index;
+
+   index.update(world, object_classes, index_config);
+
+   world.dirty_entities.untracked_clear();
+
+   check_index_matches_linear(world, object_classes, blocks_bvh_library, index, random);
+
+   SECTION("after moving entities")
+   {
+      move_test_entities(world, random);
+
+      world.dirty_entities.mark_all();
+
+      index.update(world, object_classes, index_config);
+
+      check_index_matches_linear(world, object_classes, blocks_bvh_library, index, random);
+   }
+
+   SECTION("after deleting entities from the middle")
+   {
+      delete_middle_test_entities(world);
+
+      world.dirty_entities.mark_all();
+
+      index.update(world, object_classes, index_config);
+
+      check_index_matches_linear(world, object_classes, blocks_bvh_library, index, random);
+   }
+}
+
+TEST_CASE("world entity_spatial_index only checks dirty entity types",
+          "[World][EntitySpatialIndex]")
+{
+   null_output_stream output;
+   std::shared_ptr<async::thread_pool> thread_pool =
+      async::thread_pool::make({.thread_count = 1, .low_priority_thread_count = 1});
+   assets::libraries_manager assets_libraries{output, thread_pool};
+
+   const object_class_library object_classes{assets_libraries};
+
+   world world{
+      .hintnodes = {entities_init, std::initializer_list{hintnode{}}},
+   };
+
+   entity_spatial_index index;
+
+   index.update(world, object_classes, index_config);
+
+   world.dirty_entities.untracked_clear();
+
+   active_layers layers;
+
+   layers.set(0);
+
+   const float3 ray_origin{64.0f, 8.0f, 0.0f};
+   const float3 ray_direction{0.0f, -1.0f, 0.0f};
+
+   world.hintnodes[0].position = {64.0f, 0.0f, 0.0f};
+
+   index.update(world, object_classes, index_config);
+
+   CHECK(not raycast(ray_origin, ray_direction, layers, world.hintnodes, index));
+
+   world.dirty_entities.hintnodes = true;
+
+   index.update(world, object_classes, index_config);
+
+   CHECK(raycast(ray_origin, ray_direction, layers, world.hintnodes, index));
+
+   world.dirty_entities.untracked_clear();
+
+   index.update(world, object_classes, {.light_proxy_radius = 4.0f});
+
+   CHECK(raycast(ray_origin, ray_direction, layers, world.hintnodes, index));
+}
+
+}
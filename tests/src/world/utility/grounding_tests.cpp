@@ -0,0 +1,226 @@
+#include "pch.h"
+
+#include "assets/asset_libraries.hpp"
+#include "async/thread_pool.hpp"
+#include "output_stream.hpp"
+#include "world/blocks/custom_mesh_bvh_library.hpp"
+#include "world/blocks/utility/grounding.hpp"
+#include "world/object_class_library.hpp"
+#include "world/utility/grounding.hpp"
+#include "world/utility/terrain_sample.hpp"
+
+#include <cmath>
+#include <optional>
+#include <random>
+#include <vector>
+
+namespace we::world::tests {
+
+namespace {
+
+void init_test_terrain(terrain& terrain) noexcept
+{
+   terrain.length = 64;
+   terrain.height_map = {terrain.length, terrain.length};
+
+   for (int32 y = 0; y < terrain.length; ++y) {
+      for (int32 x = 0; x < terrain.length; ++x) {
+         terrain.height_map[{x, y}] =
+            static_cast<int16>(std::sin(x * 0.2f) * std::cos(y * 0.3f) * 400.0f);
+      }
+   }
+}
+
+void push_box(blocks_boxes& boxes, const block_box_id id, const float3& position,
+              const float size) noexcept
+{
+   const uint32 index = static_cast<uint32>(boxes.size());
+
+   boxes.bbox.min_x.push_back(position.x - size);
+   boxes.bbox.min_y.push_back(position.y - size);
+   boxes.bbox.min_z.push_back(position.z - size);
+   boxes.bbox.max_x.push_back(position.x + size);
+   boxes.bbox.max_y.push_back(position.y + size);
+   boxes.bbox.max_z.push_back(position.z + size);
+   boxes.hidden.push_back(false);
+   boxes.layer.push_back(0);
+   boxes.description.push_back({.position = position, .size = {size, size, size}});
+   boxes.ids.push_back(id);
+
+   boxes.dirty.add({index, index + 1});
+}
+
+}
+
+TEST_CASE("world grounding sample_terrain_normals", "[World][Grounding]")
+{
+   std::shared_ptr<async::thread_pool> thread_pool =
+      async::thread_pool::make({.thread_count = 4, .low_priority_thread_count = 1});
+
+   terrain terrain;
+
+   init_test_terrain(terrain);
+
+   std::mt19937 random{0x51a3};
+   std::uniform_real_distribution<float> position_dist{-300.0f, 300.0f};
+
+   std::vector<float3> positions;
+
+   for (int32 i = 0; i < 5000; ++i) {
+      positions.push_back({position_dist(random), 0.0f, position_dist(random)});
+   }
+
+   std::vector<float3> normals(positions.size());
+
+   sample_terrain_normals(terrain, positions, normals, *thread_pool);
+
+   for (std::size_t i = 0; i < positions.size(); ++i) {
+      const float3 normal = sample_terrain_normal(terrain, positions[i]);
+
+      CHECK(normals[i].x == normal.x);
+      CHECK(normals[i].y == normal.y);
+      CHECK(normals[i].z == normal.z);
+   }
+}
+
+TEST_CASE("world grounding ground_points", "[World][Grounding]")
+{
+   null_output_stream output;
+   std::shared_ptr<async::thread_pool> thread_pool =
+      async::thread_pool::make({.thread_count = 4, .low_priority_thread_count = 1});
+   assets::libraries_manager assets_libraries{output, thread_pool};
+
+   const object_class_library object_classes{assets_libraries};
+   const blocks_custom_mesh_bvh_library blocks_bvh_library;
+   active_layers active_layers;
+   active_layers.set(0);
+
+   world world;
+
+   init_test_terrain(world.terrain);
+
+   push_box(world.blocks.boxes, world.blocks.next_id.boxes.aquire(), {16.0f, 2.0f, 16.0f},
+            12.0f);
+
+   std::mt19937 random{0x9d02};
+   std::uniform_real_distribution<float> position_dist{-100.0f, 100.0f};
+   std::uniform_real_distribution<float> height_dist{-2.0f, 30.0f};
+
+   std::vector<float3> points;
+
+   for (int32 i = 0; i < 2000; ++i) {
+      points.push_back({position_dist(random), height_dist(random), position_dist(random)});
+   }
+
+   std::vector<std::optional<float3>> grounded_points(points.size());
+
+   ground_points(points, grounded_points, world, object_classes, blocks_bvh_library,
+                 active_layers, *thread_pool);
+
+   for (std::size_t i = 0; i < points.size(); ++i) {
+      CHECK(grounded_points[i] == ground_point(points[i], world, object_classes,
+                                               blocks_bvh_library, active_layers));
+   }
+}
+
+TEST_CASE("world grounding ground_selection", "[World][Grounding]")
+{
+   null_output_stream output;
+   std::shared_ptr<async::thread_pool> thread_pool =
+      async::thread_pool::make({.thread_count = 4, .low_priority_thread_count = 1});
+   assets::libraries_manager assets_libraries{output, thread_pool};
+
+   const object_class_library object_classes{assets_libraries};
+   const blocks_custom_mesh_bvh_library blocks_bvh_library;
+   active_layers active_layers;
+   active_layers.set(0);
+
+   world world;
+
+   init_test_terrain(world.terrain);
+
+   const block_box_id box_id = world.blocks.next_id.boxes.aquire();
+
+   push_box(world.blocks.boxes, box_id, {-40.0f, 20.0f, 24.0f}, 2.0f);
+   push_box(world.blocks.boxes, world.blocks.next_id.boxes.aquire(), {40.0f, 0.0f, 40.0f},
+            16.0f);
+
+   world.lights.push_back({.position = {-20.0f, 15.0f, 8.0f}, .id = light_id{0}});
+   world.lights.push_back({.position = {40.0f, 40.0f, 40.0f}, .id = light_id{1}});
+   world.hintnodes.push_back({.position = {12.0f, 9.0f, -30.0f}, .id = hintnode_id{0}});
+   world.sectors.push_back({.base = 25.0f,
+                            .height = 10.0f,
+                            .points = {{-8.0f, -8.0f}, {8.0f, -8.0f}, {0.0f, 8.0f}},
+                            .id = sector_id{0}});
+   world.barriers.push_back({.position = {60.0f, 14.0f, 60.0f}, .id = barrier_id{0}});
+   world.barriers.push_back({.position = {-12.0f, 14.0f, 6.0f}, .id = barrier_id{1}});
+   world.planning_hubs.push_back({.position = {18.0f, 11.0f, -4.0f}, .id = planning_hub_id{0}});
+   world.paths.push_back({.nodes = {{.position = {0.0f, 10.0f, 0.0f}},
+                                    {.position = {30.0f, 12.0f, -20.0f}},
+                                    {.position = {-30.0f, 8.0f, 20.0f}}},
+                          .id = path_id{0}});
+
+   path_id_node_mask path_nodes{path_id{0}};
+   path_nodes.nodes.set(0);
+   path_nodes.nodes.set(2);
+
+   const std::vector<selected_entity> selection{
+      light_id{1}, path_nodes, block_id{box_id}, sector_id{0}, hintnode_id{0}, light_id{0},
+      light_id{7}, barrier_id{1}, planning_hub_id{0}};
+
+   const std::vector<grounded_entity> grounded =
+      ground_selection(selection, world, object_classes, blocks_bvh_library, active_layers,
+                       *thread_pool);
+
+   std::vector<grounded_entity> expected;
+
+   const auto expect = [&](const selected_entity entity, const uint32 index,
+                           const std::optional<float3> position) {
+      if (position) {
+         expected.push_back({.entity = entity, .index = index, .position = *position});
+      }
+   };
+
+   expect(light_id{1}, 1,
+          ground_light(world.lights[1], world, object_classes, blocks_bvh_library,
+                       active_layers));
+   expect(make_path_id_node_mask(path_id{0}, 0), 0,
+          ground_point(world.paths[0].nodes[0].position, world, object_classes,
+                       blocks_bvh_library, active_layers));
+   expect(make_path_id_node_mask(path_id{0}, 2), 0,
+          ground_point(world.paths[0].nodes[2].position, world, object_classes,
+                       blocks_bvh_library, active_layers));
+   expect(block_id{box_id}, 0,
+          ground_block(box_id, 0, world, object_classes, blocks_bvh_library, active_layers));
+
+   if (const std::optional<float> base = ground_sector(world.sectors[0], world, object_classes,
+                                                       blocks_bvh_library, active_layers);
+       base) {
+      expect(sector_id{0}, 0, float3{0.0f, *base, 0.0f});
+   }
+
+   expect(hintnode_id{0}, 0,
+          ground_point(world.hintnodes[0].position, world, object_classes,
+                       blocks_bvh_library, active_layers));
+   expect(light_id{0}, 0,
+          ground_light(world.lights[0], world, object_classes, blocks_bvh_library,
+                       active_layers));
+
+   expect(barrier_id{1}, 1,
+          ground_point(world.barriers[1].position, world, object_classes,
+                       blocks_bvh_library, active_layers));
+   expect(planning_hub_id{0}, 0,
+          ground_point(world.planning_hubs[0].position, world, object_classes,
+                       blocks_bvh_library, active_layers));
+
+   REQUIRE(expected.size() == 9);
+   REQUIRE(grounded.size() == expected.size());
+
+   for (std::size_t i = 0; i < grounded.size(); ++i) {
+      CHECK(grounded[i].entity == expected[i].entity);
+      CHECK(grounded[i].index == expected[i].index);
+      CHECK(grounded[i].position == expected[i].position);
+   }
+}
+
+}
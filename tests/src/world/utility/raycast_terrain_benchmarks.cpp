@@ -0,0 +1,147 @@
+#include "pch.h"
+
+#include "world/utility/raycast_terrain.hpp"
+#include "world/utility/terrain_height_pyramid.hpp"
+
+#include "math/vector_funcs.hpp"
+
+#include <cmath>
+#include <optional>
+#include <random>
+#include <vector>
+
+namespace we::world::tests {
+
+namespace {
+
+constexpr int32 benchmark_terrain_length = 1024;
+constexpr int32 benchmark_ray_count = 1024;
+
+struct benchmark_ray {
+   float3 origin;
+   float3 direction;
+};
+
+auto make_benchmark_terrain() -> terrain
+{
+   terrain terrain;
+
+   terrain.length = benchmark_terrain_length;
+   terrain.height_map = {benchmark_terrain_length, benchmark_terrain_length};
+
+   for (int32 y = 0; y < benchmark_terrain_length; ++y) {
+      for (int32 x = 0; x < benchmark_terrain_length; ++x) {
+         const float height = std::sin(x * 0.01f) * std::cos(y * 0.013f) * 3000.0f +
+                              std::sin(x * 0.2f) * std::sin(y * 0.17f) * 150.0f;
+
+         terrain.height_map[{x, y}] = static_cast<int16>(height);
+      }
+   }
+
+   return terrain;
+}
+
+/// @brief Make rays like hover picking would, from a camera above the terrain looking down at
+/// it at a random angle.
+auto make_random_rays() -> std::vector<benchmark_ray>
+{
+   std::mt19937 random{0xbe4c};
+   std::uniform_real_distribution<float> position_dist{-3500.0f, 3500.0f};
+   std::uniform_real_distribution<float> height_dist{40.0f, 120.0f};
+   std::uniform_real_distribution<float> horizontal_dist{-1.0f, 1.0f};
+   std::uniform_real_distribution<float> vertical_dist{-1.0f, -0.1f};
+
+   std::vector<benchmark_ray> rays;
+   rays.reserve(benchmark_ray_count);
+
+   for (int32 i = 0; i < benchmark_ray_count; ++i) {
+      rays.push_back({.origin = {position_dist(random), height_dist(random),
+                                 position_dist(random)},
+                      .direction = normalize(float3{horizontal_dist(random),
+                                                    vertical_dist(random),
+                                                    horizontal_dist(random)})});
+   }
+
+   return rays;
+}
+
+/// @brief Make rays from a camera close to the terrain looking towards the horizon.
+auto make_grazing_rays() -> std::vector<benchmark_ray>
+{
+   std::mt19937 random{0x94a2};
+   std::uniform_real_distribution<float> position_dist{-3500.0f, 3500.0f};
+   std::uniform_real_distribution<float> horizontal_dist{-1.0f, 1.0f};
+   std::uniform_real_distribution<float> vertical_dist{-0.02f, 0.0f};
+
+   std::vector<benchmark_ray> rays;
+   rays.reserve(benchmark_ray_count);
+
+   for (int32 i = 0; i < benchmark_ray_count; ++i) {
+      rays.push_back({.origin = {position_dist(random), 35.0f, position_dist(random)},
+                      .direction = normalize(float3{horizontal_dist(random),
+                                                    vertical_dist(random),
+                                                    horizontal_dist(random)})});
+   }
+
+   return rays;
+}
+
+}
+
+TEST_CASE("world raycast terrain benchmark", "[World][Terrain][Benchmark][.]")
+{
+   const terrain terrain = make_benchmark_terrain();
+
+   terrain_height_pyramid height_pyramid;
+
+   BENCHMARK("height pyramid build")
+   {
+      height_pyramid.clear();
+      height_pyramid.update(terrain);
+
+      return height_pyramid.level_count();
+   };
+
+   const std::vector<benchmark_ray> random_rays = make_random_rays();
+   const std::vector<benchmark_ray> grazing_rays = make_grazing_rays();
+
+   const auto count_hits = [&](const std::vector<benchmark_ray>& rays,
+                               const terrain_height_pyramid* height_pyramid) {
+      int32 hits = 0;
+
+      for (const benchmark_ray& ray : rays) {
+         const std::optional<float> hit =
+            height_pyramid ? raycast(ray.origin, ray.direction, terrain, *height_pyramid)
+                           : raycast(ray.origin, ray.direction, terrain);
+
+         if (hit) hits += 1;
+      }
+
+      return hits;
+   };
+
+   REQUIRE(count_hits(random_rays, nullptr) == count_hits(random_rays, &height_pyramid));
+   REQUIRE(count_hits(grazing_rays, nullptr) == count_hits(grazing_rays, &height_pyramid));
+
+   BENCHMARK("random rays")
+   {
+      return count_hits(random_rays, nullptr);
+   };
+
+   BENCHMARK("random rays height pyramid")
+   {
+      return count_hits(random_rays, &height_pyramid);
+   };
+
+   BENCHMARK("grazing rays")
+   {
+      return count_hits(grazing_rays, nullptr);
+   };
+
+   BENCHMARK("grazing rays height pyramid")
+   {
+      return count_hits(grazing_rays, &height_pyramid);
+   };
+}
+
+}
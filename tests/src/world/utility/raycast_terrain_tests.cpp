@@ -0,0 +1,117 @@
+#include "pch.h"
+
+#include "world/utility/raycast_terrain.hpp"
+#include "world/utility/terrain_height_pyramid.hpp"
+
+#include "math/vector_funcs.hpp"
+
+#include <cmath>
+#include <random>
+
+namespace we::world::tests {
+
+namespace {
+
+constexpr int32 test_terrain_length = 256;
+
+auto make_test_terrain() -> terrain
+{
+   terrain terrain;
+
+   terrain.length = test_terrain_length;
+   terrain.height_map = {test_terrain_length, test_terrain_length};
+
+   for (int32 y = 0; y < test_terrain_length; ++y) {
+      for (int32 x = 0; x < test_terrain_length; ++x) {
+         const float height = std::sin(x * 0.05f) * std::cos(y * 0.07f) * 2000.0f +
+                              std::sin(y * 0.5f) * 100.0f;
+
+         terrain.height_map[{x, y}] = static_cast<int16>(height);
+      }
+   }
+
+   // A few spikes so some columns stand well above their neighbours.
+   terrain.height_map[{40, 200}] = 12000;
+   terrain.height_map[{128, 128}] = 9000;
+   terrain.height_map[{255, 0}] = -9000;
+
+   return terrain;
+}
+
+auto random_direction(std::mt19937& random, const float min_y, const float max_y) -> float3
+{
+   std::uniform_real_distribution<float> horizontal_dist{-1.0f, 1.0f};
+   std::uniform_real_distribution<float> vertical_dist{min_y, max_y};
+
+   return normalize(
+      float3{horizontal_dist(random), vertical_dist(random), horizontal_dist(random)});
+}
+
+}
+
+TEST_CASE("world raycast terrain with height pyramid", "[World][Terrain]")
+{
+   const terrain terrain = make_test_terrain();
+
+   terrain_height_pyramid height_pyramid;
+   height_pyramid.update(terrain);
+
+   REQUIRE(height_pyramid.terrain_length() == test_terrain_length);
+   REQUIRE(height_pyramid.level_count() == 8);
+
+   std::mt19937 random{0x7e44a1};
+   std::uniform_real_distribution<float> position_dist{-1200.0f, 1200.0f};
+   std::uniform_real_distribution<float> height_dist{-40.0f, 200.0f};
+
+   for (int32 i = 0; i < 2048; ++i) {
+      const float3 ray_origin{position_dist(random), height_dist(random),
+                              position_dist(random)};
+      const float3 ray_direction = i % 2 == 0 ? random_direction(random, -1.0f, 1.0f)
+                                              : random_direction(random, -0.05f, 0.05f);
+
+      CHECK(raycast(ray_origin, ray_direction, terrain, height_pyramid) ==
+            raycast(ray_origin, ray_direction, terrain));
+   }
+}
+
+TEST_CASE("world raycast terrain height pyramid update", "[World][Terrain]")
+{
+   terrain terrain = make_test_terrain();
+
+   terrain_height_pyramid height_pyramid;
+   height_pyramid.update(terrain);
+
+   terrain.height_map_dirty.clear();
+
+   for (int32 y = 100; y < 120; ++y) {
+      for (int32 x = 60; x < 90; ++x) terrain.height_map[{x, y}] = 15000;
+   }
+
+   terrain.height_map_dirty.add({60, 100, 90, 120});
+
+   height_pyramid.update(terrain);
+
+   const float3 ray_origin{-53.0f * terrain.grid_scale, 140.0f, 0.0f};
+   const float3 ray_direction{0.0f, 0.0f, -1.0f};
+
+   const std::optional<float> hit = raycast(ray_origin, ray_direction, terrain, height_pyramid);
+
+   REQUIRE(hit);
+   CHECK(hit == raycast(ray_origin, ray_direction, terrain));
+
+   terrain_height_pyramid rebuilt_height_pyramid;
+   rebuilt_height_pyramid.update(terrain);
+
+   for (int32 level = 0; level < height_pyramid.level_count(); ++level) {
+      for (int32 y = 0; y < height_pyramid.level_length(level); ++y) {
+         for (int32 x = 0; x < height_pyramid.level_length(level); ++x) {
+            CHECK(height_pyramid.cell_range(level, x, y).min ==
+                  rebuilt_height_pyramid.cell_range(level, x, y).min);
+            CHECK(height_pyramid.cell_range(level, x, y).max ==
+                  rebuilt_height_pyramid.cell_range(level, x, y).max);
+         }
+      }
+   }
+}
+
+}
@@ -1,7 +1,10 @@
 #include "pch.h"
 
 #include "approx_test_helpers.hpp"
+#include "async/thread_pool.hpp"
+#include "io/path.hpp"
 #include "world/io/load.hpp"
+#include "world/io/world_cache.hpp"
 
 #include <span>
 
@@ -31,6 +34,18 @@ bool is_unique_id(std::size_t index, const auto& entities)
    return true;
 }
 
+class string_output_stream final : public output_stream {
+public:
+   using output_stream::write;
+
+   void write(std::string string) noexcept override
+   {
+      text += string;
+   }
+
+   std::string text;
+};
+
 }
 
 TEST_CASE("world loading", "[World][IO]")
@@ -1080,4 +1095,194 @@ TEST_CASE("world loading light broken links", "[World][IO]")
    }
 }
 
-}
\ No newline at end of file
+TEST_CASE("world loading layer global lights", "[World][IO]")
+{
+   null_output_stream out;
+   std::shared_ptr<async::thread_pool> thread_pool =
+      async::thread_pool::make({.thread_count = 4, .low_priority_thread_count = 1});
+
+   const world serial_world = load_world("data/world_layer_global_lights/test.wld"sv, {}, out);
+   const world parallel_world =
+      load_world("data/world_layer_global_lights/test.wld"sv, {}, out, *thread_pool);
+
+   for (const world* world : {&serial_world, &parallel_world}) {
+      REQUIRE(world->layer_descriptions.size() == 3);
+
+      // The last layer's block wins, except for the env map which it doesn't set.
+      CHECK(world->global_lights.global_light_1.name() == "sun5");
+      CHECK(world->global_lights.global_light_2.name() == "");
+      CHECK(approx_equals(world->global_lights.ambient_sky_color, {0.0f, 0.0f, 1.0f}));
+      CHECK(approx_equals(world->global_lights.ambient_ground_color, {1.0f, 1.0f, 1.0f}));
+      CHECK(world->global_lights.env_map_texture == "design_env");
+   }
+}
+
+TEST_CASE("world loading parallel", "[World][IO]")
+{
+   null_output_stream out;
+   std::shared_ptr<async::thread_pool> thread_pool =
+      async::thread_pool::make({.thread_count = 4, .low_priority_thread_count = 1});
+
+   for (const std::string_view path :
+        {"data/world/test.wld"sv, "data/world_blocks/test.wld"sv,
+         "data/world_foliage_props/test.wld"sv}) {
+      world serial_world = load_world(path, {}, out);
+      world parallel_world = load_world(path, {}, out, *thread_pool);
+
+      CHECK(parallel_world.requirements == serial_world.requirements);
+      CHECK(parallel_world.layer_descriptions == serial_world.layer_descriptions);
+      CHECK(parallel_world.game_modes == serial_world.game_modes);
+      CHECK(parallel_world.objects == serial_world.objects);
+      CHECK(parallel_world.lights == serial_world.lights);
+      CHECK(parallel_world.paths == serial_world.paths);
+      CHECK(parallel_world.regions == serial_world.regions);
+      CHECK(parallel_world.sectors == serial_world.sectors);
+      CHECK(parallel_world.portals == serial_world.portals);
+      CHECK(parallel_world.hintnodes == serial_world.hintnodes);
+      CHECK(parallel_world.barriers == serial_world.barriers);
+      CHECK(parallel_world.planning_hubs == serial_world.planning_hubs);
+      CHECK(parallel_world.planning_connections == serial_world.planning_connections);
+      CHECK(parallel_world.boundaries == serial_world.boundaries);
+      CHECK(parallel_world.measurements == serial_world.measurements);
+      CHECK(parallel_world.animations.size() == serial_world.animations.size());
+      CHECK(parallel_world.animation_groups.size() == serial_world.animation_groups.size());
+      CHECK(parallel_world.animation_hierarchies.size() ==
+            serial_world.animation_hierarchies.size());
+      CHECK(parallel_world.tree_lines.size() == serial_world.tree_lines.size());
+      CHECK(parallel_world.terrain.length == serial_world.terrain.length);
+      CHECK(parallel_world.blocks.boxes.description ==
+            serial_world.blocks.boxes.description);
+
+      CHECK(parallel_world.next_id.objects.aquire() == serial_world.next_id.objects.aquire());
+      CHECK(parallel_world.next_id.lights.aquire() == serial_world.next_id.lights.aquire());
+      CHECK(parallel_world.next_id.paths.aquire() == serial_world.next_id.paths.aquire());
+      CHECK(parallel_world.next_id.regions.aquire() == serial_world.next_id.regions.aquire());
+      CHECK(parallel_world.next_id.hintnodes.aquire() ==
+            serial_world.next_id.hintnodes.aquire());
+   }
+}
+
+TEST_CASE("world loading cache", "[World][IO]")
+{
+   REQUIRE(io::create_directories("temp/world_cache"));
+
+   for (const std::string_view file_name :
+        {"test.BAR"sv, "test.BND"sv, "test.HNT"sv, "test.LDX"sv, "test.LGT"sv, "test.PLN"sv,
+         "test.PTH"sv, "test.PVS"sv, "test.RGN"sv, "test.TER"sv, "test.anm"sv, "test.msr"sv,
+         "test.req"sv, "test.wld"sv, "test_conquest.mrq"sv, "test_design.HNT"sv,
+         "test_design.LGT"sv, "test_design.PTH"sv, "test_design.RGN"sv,
+         "test_design.lyr"sv}) {
+      REQUIRE(io::copy_file(io::compose_path("data/world", file_name),
+                            io::compose_path("temp/world_cache", file_name)));
+   }
+
+   const io::path world_path = "temp/world_cache/test.wld";
+
+   (void)io::remove(get_world_cache_path(world_path));
+
+   const auto check_equal = [](const world& cached_world, const world& file_world) {
+      CHECK(cached_world.requirements == file_world.requirements);
+      CHECK(cached_world.layer_descriptions == file_world.layer_descriptions);
+      CHECK(cached_world.game_modes == file_world.game_modes);
+      CHECK(cached_world.common_layers == file_world.common_layers);
+      CHECK(cached_world.global_lights == file_world.global_lights);
+      CHECK(cached_world.objects == file_world.objects);
+      CHECK(cached_world.lights == file_world.lights);
+      CHECK(cached_world.paths == file_world.paths);
+      CHECK(cached_world.regions == file_world.regions);
+      CHECK(cached_world.sectors == file_world.sectors);
+      CHECK(cached_world.portals == file_world.portals);
+      CHECK(cached_world.hintnodes == file_world.hintnodes);
+      CHECK(cached_world.barriers == file_world.barriers);
+      CHECK(cached_world.planning_hubs == file_world.planning_hubs);
+      CHECK(cached_world.planning_connections == file_world.planning_connections);
+      CHECK(cached_world.boundaries == file_world.boundaries);
+      CHECK(cached_world.measurements == file_world.measurements);
+      CHECK(cached_world.animations.size() == file_world.animations.size());
+      CHECK(cached_world.animation_groups.size() == file_world.animation_groups.size());
+      CHECK(cached_world.animation_hierarchies.size() ==
+            file_world.animation_hierarchies.size());
+      CHECK(cached_world.terrain.length == file_world.terrain.length);
+
+      for (std::size_t i = 0; i < std::min(cached_world.animations.size(),
+                                           file_world.animations.size());
+           ++i) {
+         CHECK(cached_world.animations[i].name == file_world.animations[i].name);
+         CHECK(cached_world.animations[i].position_keys.size() ==
+               file_world.animations[i].position_keys.size());
+         CHECK(cached_world.animations[i].rotation_keys.size() ==
+               file_world.animations[i].rotation_keys.size());
+      }
+
+      CHECK(cached_world.next_id.objects.aquired_count() ==
+            file_world.next_id.objects.aquired_count());
+      CHECK(cached_world.next_id.paths.aquired_count() ==
+            file_world.next_id.paths.aquired_count());
+      CHECK(cached_world.next_id.regions.aquired_count() ==
+            file_world.next_id.regions.aquired_count());
+      CHECK(cached_world.next_id.animations.aquired_count() ==
+            file_world.next_id.animations.aquired_count());
+   };
+
+   null_output_stream out;
+
+   {
+      const world file_world = load_world(world_path, {}, out);
+
+      string_output_stream writing_out;
+      const world writing_world =
+         load_world(world_path, {}, writing_out, {.use_cache = true});
+
+      REQUIRE(io::exists(get_world_cache_path(world_path)));
+      CHECK(writing_out.text.find(".wecache") == std::string::npos);
+
+      check_equal(writing_world, file_world);
+
+      string_output_stream cached_out;
+      const world cached_world = load_world(world_path, {}, cached_out, {.use_cache = true});
+
+      CHECK(cached_out.text.find("Loaded world layers from test.wecache") !=
+            std::string::npos);
+      CHECK(cached_out.text.find("Found world layer 'design' in .ldx file") !=
+            std::string::npos);
+
+      check_equal(cached_world, file_world);
+   }
+
+   // Writing to a layer file without changing it leaves the cache up to date.
+   io::update_last_write_time("temp/world_cache/test.wld");
+
+   {
+      string_output_stream cached_out;
+      (void)load_world(world_path, {}, cached_out, {.use_cache = true});
+
+      CHECK(cached_out.text.find("Loaded world layers from test.wecache") !=
+            std::string::npos);
+   }
+
+   // Removing a layer file makes the cache out of date.
+   REQUIRE(io::remove("temp/world_cache/test.anm"));
+
+   {
+      const world file_world = load_world(world_path, {}, out);
+
+      REQUIRE(file_world.animations.empty());
+
+      string_output_stream stale_out;
+      const world stale_world = load_world(world_path, {}, stale_out, {.use_cache = true});
+
+      CHECK(stale_out.text.find(".wecache") == std::string::npos);
+
+      check_equal(stale_world, file_world);
+
+      string_output_stream cached_out;
+      const world cached_world = load_world(world_path, {}, cached_out, {.use_cache = true});
+
+      CHECK(cached_out.text.find("Loaded world layers from test.wecache") !=
+            std::string::npos);
+
+      check_equal(cached_world, file_world);
+   }
+}
+
+}
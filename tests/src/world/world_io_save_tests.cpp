@@ -2919,4 +2919,55 @@ TEST_CASE("world saving light broken links", "[World][IO]")
    CHECK(written_lgt == expected_broken_lgt);
 }
 
+TEST_CASE("world saving incremental", "[World][IO]")
+{
+   (void)io::create_directory("temp/world_incremental");
+   (void)io::create_directory("temp/world_incremental_full");
+
+   world world{
+      .name = "test",
+
+      .layer_descriptions = {{.name = "[Base]"}, {.name = "conquest"}},
+
+      .common_layers = {0},
+
+      .objects = {entities_init,
+                  std::initializer_list{
+                     object{.name = "base_object",
+                            .layer = 0,
+                            .class_name = lowercase_string{"bldg_base"sv}},
+                     object{.name = "conquest_object",
+                            .layer = 1,
+                            .class_name = lowercase_string{"bldg_conquest"sv}}}},
+   };
+
+   save_world("temp/world_incremental/test.wld", world, {});
+
+   world.dirty_files.mark_saved("temp/world_incremental/test.wld", {});
+
+   REQUIRE(io::remove("temp/world_incremental/test.wld"));
+   REQUIRE(io::remove("temp/world_incremental/test.ter"));
+
+   world.objects[1].position = {1.0f, 2.0f, 3.0f};
+   world.dirty_files.mark(layer_file::objects, 1);
+
+   save_world("temp/world_incremental/test.wld", world, {});
+
+   CHECK(not io::exists("temp/world_incremental/test.wld"));
+   CHECK(not io::exists("temp/world_incremental/test.ter"));
+
+   save_world("temp/world_incremental_full/test.wld", world, {});
+
+   CHECK(io::read_file_to_string("temp/world_incremental/test_conquest.lyr") ==
+         io::read_file_to_string("temp/world_incremental_full/test_conquest.lyr"));
+   CHECK(io::read_file_to_string("temp/world_incremental/test.ldx") ==
+         io::read_file_to_string("temp/world_incremental_full/test.ldx"));
+
+   save_world("temp/world_incremental/test.wld", world, {}, {.force_full_save = true});
+
+   CHECK(io::exists("temp/world_incremental/test.ter"));
+   CHECK(io::read_file_to_string("temp/world_incremental/test.wld") ==
+         io::read_file_to_string("temp/world_incremental_full/test.wld"));
+}
+
 }
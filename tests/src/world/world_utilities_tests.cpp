@@ -3,7 +3,9 @@
 #include "world/utility/world_utilities.hpp"
 #include "world/world.hpp"
 
+#include <array>
 #include <string_view>
+#include <vector>
 
 using namespace std::literals;
 
@@ -91,6 +93,48 @@ TEST_CASE("world utilities create_unique_name", "[World][Utilities]")
    REQUIRE(create_unique_name(world.objects, "") == "");
 }
 
+TEST_CASE("world utilities unique_name_registry", "[World][Utilities]")
+{
+   world world{.objects = {entities_init,
+                           std::initializer_list{object{.name = "Amazing Object 32"s},
+                                                 object{.name = "62"s},
+                                                 object{.name = "Door007"s}}}};
+
+   unique_name_registry registry{world.objects};
+
+   CHECK(registry.contains("amazing object 32"));
+   CHECK(not registry.contains("Amazing Object 33"));
+
+   CHECK(registry.create_unique_name("Amazing Object 32") == "Amazing Object 33");
+   CHECK(registry.create_unique_name("Amazing Object 32") == "Amazing Object 34");
+   CHECK(registry.create_unique_name("Amazing Object") == "Amazing Object");
+   CHECK(registry.create_unique_name("Amazing Object") == "Amazing Object1");
+   CHECK(registry.create_unique_name("62") == "Object1");
+   CHECK(registry.create_unique_name("63") == "63");
+   CHECK(registry.create_unique_name("DOOR7") == "DOOR7");
+   CHECK(registry.create_unique_name("Door7") == "Door8");
+   CHECK(registry.create_unique_name("") == "");
+}
+
+TEST_CASE("world utilities unique_name_registry matches create_unique_name",
+          "[World][Utilities]")
+{
+   world world;
+
+   const std::array reference_names{"Light"sv, "Light1"sv, "light1"sv, "Light10"sv,
+                                    "Light"sv, "12"sv,     "Light2"sv, "Sun"sv};
+
+   unique_name_registry registry{world.lights};
+
+   for (const std::string_view reference_name : reference_names) {
+      const std::string name = create_unique_name(world.lights, reference_name);
+
+      CHECK(registry.create_unique_name(reference_name) == name);
+
+      world.lights.push_back(light{.name = name});
+   }
+}
+
 TEST_CASE("world utilities create_unique_light_region_name",
           "[World][Utilities]")
 {